@@ -0,0 +1,143 @@
+/*
+Spin-then-yield-then-park waiting (header-only, just #include it).
+Used by thread_pool.hpp, ../137_Barriers/thread_team.hpp,
+../157_jthread/jthread.cpp, ../157_jthread/adaptive_wait_benchmark.cpp and
+../114_Atomics/lock_free_stack.cpp.
+
+A condition_variable wait costs a futex sleep + wake round trip, often tens of
+microseconds. When work arrives in bursts the next item is usually only a few
+hundred nanoseconds away, so it is cheaper to watch for it for a moment first:
+
+    1. spin   - re-check ready() with a pause instruction between checks
+    2. yield  - give the core away a few times, still re-checking
+    3. park   - give up and call the caller's blocking wait
+
+The spin budget tunes itself from how long recent waits actually took:
+- Work that shows up while spinning pulls the budget toward a few times the
+  typical arrival gap.
+- Work that shows up only during the yield phase was just missed, so the
+  budget doubles.
+- Parking means spinning was wasted CPU, so the budget halves.
+
+ready() must be cheap and lock-free (an atomic load). It only decides when to
+stop spinning. The caller's park step still does the authoritative check under
+its lock, so a ready() that fires early or late costs time, never correctness.
+*/
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Tells the core we are busy-waiting: frees pipeline resources for the sibling
+// hyperthread and avoids the memory-order mis-speculation penalty on exit.
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// One instance per waiting thread; the budget is that thread's own history.
+class alignas(64) AdaptiveWaiter {
+public:
+    struct Config {
+        uint32_t initial_spins = 256;
+        uint32_t min_spins = 16;      // floor once parking dominates
+        uint32_t max_spins = 8192;    // ceiling when work arrives quickly
+        uint32_t yields = 4;          // yield rounds between spinning and parking
+        bool adaptive = true;         // false: always spin initial_spins
+
+        // Straight to the blocking wait, the behaviour before this header existed
+        static Config park_only() { return Config{0, 0, 0, 0, false}; }
+    };
+
+    struct Stats {
+        uint64_t spin_hits = 0;    // ready() became true while spinning
+        uint64_t yield_hits = 0;   // ... while yielding
+        uint64_t parks = 0;        // neither; the caller had to block
+    };
+
+    AdaptiveWaiter() : AdaptiveWaiter(Config{}) {}
+
+    explicit AdaptiveWaiter(Config config)
+        : config_(config),
+          budget_(config.initial_spins),
+          typical_spins_x8_(config.initial_spins * 2u) {}
+
+    // Returns true if ready() turned true before the park phase. On false the
+    // caller should perform its blocking wait (which re-checks under its lock).
+    template<typename Ready>
+    bool spin(Ready&& ready) {
+        const uint32_t budget = budget_.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < budget; ++i) {
+            if (ready()) {
+                on_spin_hit(i);
+                return true;
+            }
+            cpu_relax();
+        }
+        for (uint32_t y = 0; y < config_.yields; ++y) {
+            std::this_thread::yield();
+            if (ready()) {
+                bump(yield_hits_);
+                adjust(std::min(config_.max_spins, std::max(budget, 1u) * 2));
+                return true;
+            }
+        }
+        bump(parks_);
+        adjust(std::max(config_.min_spins, budget / 2));
+        return false;
+    }
+
+    template<typename Ready, typename Park>
+    void wait(Ready&& ready, Park&& park) {
+        if (!spin(ready)) {
+            park();
+        }
+    }
+
+    uint32_t spin_budget() const noexcept { return budget_.load(std::memory_order_relaxed); }
+
+    // Safe to call from any thread while the owner keeps waiting
+    Stats stats() const noexcept {
+        return Stats{spin_hits_.load(std::memory_order_relaxed),
+                     yield_hits_.load(std::memory_order_relaxed),
+                     parks_.load(std::memory_order_relaxed)};
+    }
+
+private:
+    // Single writer (the owning thread), so no locked RMW is needed
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void adjust(uint32_t budget) {
+        if (config_.adaptive) {
+            budget_.store(budget, std::memory_order_relaxed);
+        }
+    }
+
+    // Exponential moving average (1/8 weight) of the spins a hit needed, kept
+    // scaled by 8 to stay in integers; the budget tracks 4x that average.
+    void on_spin_hit(uint32_t spins) {
+        bump(spin_hits_);
+        typical_spins_x8_ = typical_spins_x8_ - typical_spins_x8_ / 8 + spins;
+        const uint32_t target = typical_spins_x8_ / 2;   // 4 * (x8 / 8)
+        adjust(std::clamp(target, config_.min_spins, config_.max_spins));
+    }
+
+    Config config_;
+    std::atomic<uint32_t> budget_;
+    uint32_t typical_spins_x8_;
+    std::atomic<uint64_t> spin_hits_{0};
+    std::atomic<uint64_t> yield_hits_{0};
+    std::atomic<uint64_t> parks_{0};
+};
@@ -0,0 +1,162 @@
+/*
+Structured fork-join on a ThreadPoolRAII (header-only, just #include it).
+Used by 229_Thread_Creation_Patterns/thread_creation.cpp.
+
+A std::thread per job costs tens of microseconds to create and join, which
+dominates jobs of a few microseconds. A TaskGroup runs its children on an
+existing pool and ends at wait(): every child started through the group has
+finished (or was skipped after a failure) when wait() returns.
+
+    TaskGroup<int> group(pool);
+    for (int i = 0; i < 3; ++i) {
+        group.run([i] { return calculate_sum(i * 10, (i + 1) * 10); });
+    }
+    std::vector<int> sums = group.wait();   // in run() order; rethrows the first exception
+
+Children wait in the group's own queue; run() also enqueues a small runner
+task on the pool that takes the next waiting child, whichever that is by
+then. wait() does not just block: the waiting thread takes waiting children
+itself and runs them inline, and only blocks for children already running
+elsewhere. So a child that creates its own group and waits on it - nested
+parallelism on a pool worker - makes progress even when every worker is
+busy waiting, instead of deadlocking on tasks queued behind it.
+
+If a child throws, children that have not started yet are skipped, the
+others finish, and wait() rethrows the first exception. TaskGroup<void>
+collects no results. A group can be reused after wait(); destroying it
+waits for its children (discarding any exception).
+*/
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+template<typename T = void>
+class TaskGroup {
+    using Slot = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    struct Child {
+        Task body;
+        std::optional<Slot> result;
+    };
+
+    // Shared with the runner tasks, which may still sit in the pool queue
+    // after the group has been waited on (or destroyed)
+    struct State {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::deque<Child> children;         // stable addresses while growing
+        size_t next = 0;                    // first child not yet started
+        size_t finished = 0;
+        std::exception_ptr error;
+
+        // Runs the next waiting child on this thread; false if there is none
+        bool run_one() {
+            Child* child;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (next == children.size()) {
+                    return false;
+                }
+                child = &children[next++];
+                if (error) {
+                    // Skipped: an earlier child failed
+                    child->body.reset();
+                    ++finished;
+                    return true;
+                }
+            }
+            std::exception_ptr failure;
+            try {
+                child->body();
+            } catch (...) {
+                failure = std::current_exception();
+            }
+            child->body.reset();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (failure && !error) {
+                error = failure;
+            }
+            if (++finished == children.size()) {
+                done.notify_all();
+            }
+            return true;
+        }
+    };
+
+public:
+    explicit TaskGroup(ThreadPoolRAII& pool) : m_pool(pool), m_state(std::make_shared<State>()) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup() {
+        try {
+            wait();
+        } catch (...) {
+        }
+    }
+
+    template<typename F>
+    void run(F&& f) {
+        static_assert(std::is_convertible_v<std::invoke_result_t<std::decay_t<F>&>, T> || std::is_void_v<T>,
+                      "child must return the group's result type");
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            Child& child = m_state->children.emplace_back();
+            if constexpr (std::is_void_v<T>) {
+                child.body = Task(std::forward<F>(f));
+            } else {
+                child.body = Task([fn = std::forward<F>(f), slot = &child.result]() mutable { slot->emplace(fn()); });
+            }
+        }
+        m_pool.enqueue(Task([state = m_state] { state->run_one(); }));
+    }
+
+    /**
+     * Runs waiting children inline, then blocks until the rest have finished.
+     * @return the children's results in run() order (nothing for TaskGroup<void>)
+     * @throws the first exception a child threw
+     */
+    auto wait() {
+        State& state = *m_state;
+        while (state.run_one()) {
+        }
+        std::deque<Child> children;
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.done.wait(lock, [&] { return state.finished == state.children.size(); });
+            children.swap(state.children);
+            state.next = 0;
+            state.finished = 0;
+            error = std::exchange(state.error, nullptr);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if constexpr (!std::is_void_v<T>) {
+            std::vector<T> results;
+            results.reserve(children.size());
+            for (Child& child : children) {
+                results.push_back(std::move(*child.result));
+            }
+            return results;
+        }
+    }
+
+private:
+    ThreadPoolRAII& m_pool;
+    std::shared_ptr<State> m_state;
+};
@@ -0,0 +1,1101 @@
+/*
+ThreadPoolRAII and its building blocks (header-only, just #include it):
+the inline Task (built on ../inplace_function.hpp), Completion, worker
+statistics (exportable to ../metrics.hpp), CPU topology / affinity options
+and the pool itself; safe_print goes through ../async_logger.hpp.
+BasicThreadPool<QueueMutex> takes the type of its queue mutex, so
+BasicThreadPool<ProfiledMutex> reports its contention; ThreadPoolRAII is
+BasicThreadPool<std::mutex>.
+Used by thread_pool_with_work_queue.cpp, timer_wheel.hpp, task_group.hpp, 40_Coroutines/executor.cpp, 40_Coroutines/channel.hpp,
+24_Ranges/parallel_pipeline.hpp, parallel_stl.cpp, radix_sort.hpp, span_expr.hpp and
+profiled_mutex_demo.cpp.
+*/
+#pragma once
+
+#include <thread>
+#include <queue>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <latch>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <future>
+#include <optional>
+#include <tuple>
+#include <memory>
+#include <array>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <ranges>
+#include <concepts>
+#include <cmath>
+#include <bit>
+#include <cstdint>
+#include <iomanip>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <limits>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "adaptive_waiter.hpp"
+#include "../inplace_function.hpp"
+#include "../25_Chrono/trace.hpp"
+#include "../metrics.hpp"
+#include "../async_logger.hpp"
+#include "../profiled_mutex.hpp"
+
+// Move-only replacement for std::function<void()>, on top of
+// inplace_function (inplace_function.hpp).
+// Callables up to Capacity bytes that are nothrow-movable are constructed in
+// place, so submitting them never touches the heap (libstdc++'s std::function
+// only keeps 16 bytes inline). Larger callables fall back to a single new:
+// the buffer then holds a HeapCallable, one owning pointer.
+// An inplace_function<void(), N> itself is such a callable - it fits as
+// long as N + 8 <= Capacity, and then moves through the queue without a
+// heap allocation either.
+template<size_t Capacity>
+class BasicTask {
+private:
+    template<typename F>
+    struct HeapCallable {
+        std::unique_ptr<F> f;
+        void operator()() { (*f)(); }
+    };
+
+    template<typename F>
+    static constexpr bool fits_inline = sizeof(F) <= Capacity &&
+                                        alignof(F) <= alignof(std::max_align_t) &&
+                                        std::is_nothrow_move_constructible_v<F>;
+
+    using Function = inplace_function<void(), Capacity>;
+
+    // Returned as a prvalue, so it initializes fn_ directly: the callable
+    // is constructed once, in its final place
+    template<typename F>
+    static Function wrap(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (fits_inline<Fn>) {
+            return Function(std::forward<F>(f));
+        } else {
+            return Function(HeapCallable<Fn>{std::make_unique<Fn>(std::forward<F>(f))});
+        }
+    }
+
+    Function fn_;
+
+public:
+    static constexpr size_t inline_capacity = Capacity;
+
+    BasicTask() noexcept = default;
+
+    template<typename F>
+        requires (!std::is_same_v<std::remove_cvref_t<F>, BasicTask> &&
+                  std::is_invocable_v<std::decay_t<F>&>)
+    BasicTask(F&& f) : fn_(wrap(std::forward<F>(f))) {}
+
+    BasicTask(BasicTask&&) noexcept = default;
+    BasicTask& operator=(BasicTask&&) noexcept = default;
+
+    void reset() noexcept { fn_.reset(); }
+
+    explicit operator bool() const noexcept { return static_cast<bool>(fn_); }
+
+    void operator()() { fn_(); }
+};
+
+// 48 inline bytes + vtable pointer: one cache line per queued task
+using Task = BasicTask<48>;
+static_assert(sizeof(Task) == 64);
+
+// Lighter alternative to std::future: the caller owns the result slot (usually
+// on its stack), so submit_into() needs no shared state and no allocation.
+// The Completion must outlive the task; wait() or get() before it goes away.
+template<typename R>
+class Completion {
+private:
+    using Slot = std::conditional_t<std::is_void_v<R>, std::monostate, R>;
+
+    std::optional<Slot> value_;
+    std::exception_ptr error_;
+    std::atomic<bool> ready_{false};
+
+    template<typename QueueMutex>
+    friend class BasicThreadPool;
+
+    template<typename F>
+    void run(F&& f) noexcept {
+        try {
+            if constexpr (std::is_void_v<R>) {
+                std::forward<F>(f)();
+                value_.emplace();
+            } else {
+                value_.emplace(std::forward<F>(f)());
+            }
+        } catch (...) {
+            error_ = std::current_exception();
+        }
+        ready_.store(true, std::memory_order_release);
+        ready_.notify_all();
+    }
+
+public:
+    Completion() = default;
+    Completion(const Completion&) = delete;
+    Completion& operator=(const Completion&) = delete;
+
+    bool ready() const noexcept { return ready_.load(std::memory_order_acquire); }
+
+    void wait() const noexcept { ready_.wait(false, std::memory_order_acquire); }
+
+    R get() {
+        wait();
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        if constexpr (!std::is_void_v<R>) {
+            return std::move(*value_);
+        }
+    }
+};
+
+using Clock = std::chrono::steady_clock;
+
+// A queued task plus the moment it was submitted, for enqueue-to-start latency
+struct QueuedTask {
+    Task task;
+    Clock::time_point enqueued;
+};
+
+// Queue-wait histogram with power-of-two buckets: bucket 0 holds 0 ns waits,
+// bucket b holds waits in [2^(b-1), 2^b) ns. 40 buckets reach ~9 minutes.
+constexpr size_t kLatencyBuckets = 40;
+
+// Plain-value copy of one worker's counters, taken by ThreadPoolRAII::stats()
+struct WorkerStatsSnapshot {
+    uint64_t tasks_executed = 0;
+    uint64_t busy_ns = 0;            // time spent inside tasks
+    uint64_t idle_ns = 0;            // time between tasks (searching or parked)
+    uint64_t local_queue_high_water = 0;   // deepest own deque (work stealing)
+    std::array<uint64_t, kLatencyBuckets> queue_wait_histogram{};
+
+    // Upper bound of the bucket holding the q-th quantile (0 < q <= 1)
+    uint64_t queue_wait_percentile_ns(double q) const {
+        uint64_t total = 0;
+        for (uint64_t n : queue_wait_histogram) {
+            total += n;
+        }
+        if (total == 0) {
+            return 0;
+        }
+        const uint64_t target = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+        uint64_t seen = 0;
+        for (size_t b = 0; b < kLatencyBuckets; ++b) {
+            seen += queue_wait_histogram[b];
+            if (seen >= target) {
+                return b == 0 ? 0 : (uint64_t{1} << b);
+            }
+        }
+        return uint64_t{1} << (kLatencyBuckets - 1);
+    }
+};
+
+struct PoolStatsSnapshot {
+    std::vector<WorkerStatsSnapshot> workers;
+    uint64_t shared_queue_high_water = 0;
+
+    // Histogram and counters of all workers merged together
+    WorkerStatsSnapshot total() const {
+        WorkerStatsSnapshot sum;
+        for (const auto& w : workers) {
+            sum.tasks_executed += w.tasks_executed;
+            sum.busy_ns += w.busy_ns;
+            sum.idle_ns += w.idle_ns;
+            sum.local_queue_high_water = std::max(sum.local_queue_high_water, w.local_queue_high_water);
+            for (size_t b = 0; b < kLatencyBuckets; ++b) {
+                sum.queue_wait_histogram[b] += w.queue_wait_histogram[b];
+            }
+        }
+        return sum;
+    }
+};
+
+// CPUs grouped by NUMA node, read from /sys/devices/system/node on Linux.
+// Only CPUs in the process's affinity mask are listed, so a pool started under
+// taskset or a container cpuset never tries to pin outside its allowance.
+// Elsewhere (or without sysfs) everything collapses to one node.
+struct CpuTopology {
+    std::vector<std::vector<unsigned>> node_cpus;
+    unsigned hardware_threads = 0;
+
+    size_t num_nodes() const { return node_cpus.size(); }
+
+    size_t node_of(unsigned cpu) const {
+        for (size_t n = 0; n < node_cpus.size(); ++n) {
+            if (std::find(node_cpus[n].begin(), node_cpus[n].end(), cpu) != node_cpus[n].end()) {
+                return n;
+            }
+        }
+        return 0;
+    }
+
+    // Parses sysfs cpulist syntax such as "0-3,8-11"
+    static std::vector<unsigned> parse_cpu_list(const std::string& text) {
+        std::vector<unsigned> cpus;
+        std::stringstream input(text);
+        std::string range;
+        while (std::getline(input, range, ',')) {
+            if (range.empty() || range == "\n") {
+                continue;
+            }
+            const size_t dash = range.find('-');
+            const unsigned first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+            const unsigned last = dash == std::string::npos
+                                      ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+            for (unsigned cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    static CpuTopology detect() {
+        CpuTopology topology;
+        topology.hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+
+        std::vector<unsigned> allowed;
+#if defined(__linux__)
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+            for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &mask)) {
+                    allowed.push_back(cpu);
+                }
+            }
+        }
+
+        // Node directories can be sparse (node0, node2), so list them by name
+        std::vector<std::pair<unsigned, std::vector<unsigned>>> nodes;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+                name.find_first_not_of("0123456789", 4) != std::string::npos) {
+                continue;
+            }
+            std::ifstream cpulist(entry.path() / "cpulist");
+            std::string text;
+            std::getline(cpulist, text);
+            std::vector<unsigned> cpus;
+            for (unsigned cpu : parse_cpu_list(text)) {
+                if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+                    cpus.push_back(cpu);
+                }
+            }
+            if (!cpus.empty()) {
+                nodes.emplace_back(static_cast<unsigned>(std::stoul(name.substr(4))), std::move(cpus));
+            }
+        }
+        std::sort(nodes.begin(), nodes.end());
+        for (auto& node : nodes) {
+            topology.node_cpus.push_back(std::move(node.second));
+        }
+#endif
+        if (topology.node_cpus.empty()) {
+            if (allowed.empty()) {
+                for (unsigned cpu = 0; cpu < topology.hardware_threads; ++cpu) {
+                    allowed.push_back(cpu);
+                }
+            }
+            topology.node_cpus.push_back(std::move(allowed));
+        }
+        return topology;
+    }
+};
+
+// Where the pool's workers are allowed to run.
+enum class AffinityPolicy {
+    None,          // the OS may migrate workers freely (default)
+    PinToCores,    // worker i is pinned to cores[i % cores.size()]
+    PinToNode,     // every worker stays on numa_node, one core each, round-robin
+    SpreadNodes    // workers are dealt round-robin across nodes, pinned within them
+};
+
+struct AffinityOptions {
+    AffinityPolicy policy = AffinityPolicy::None;
+    std::vector<unsigned> cores;   // PinToCores
+    size_t numa_node = 0;          // PinToNode
+};
+
+// How the pool hands tasks to its workers.
+enum class SchedulingMode {
+    SharedQueue,   // every worker pops from one queue behind queue_mutex_
+    WorkStealing   // every worker owns a deque, idle workers steal from the others
+};
+
+// QueueMutex guards the shared and per-node queues (queue_mutex_); pass
+// ProfiledMutex (../profiled_mutex.hpp) to see how contended they are.
+template<typename QueueMutex = std::mutex>
+class BasicThreadPool {
+private:
+    // std::condition_variable only waits on a std::mutex
+    using QueueCondition = std::conditional_t<std::is_same_v<QueueMutex, std::mutex>, std::condition_variable,
+                                              std::condition_variable_any>;
+
+    // One deque per worker (work-stealing mode only). The owner pushes and pops
+    // at the back (LIFO keeps freshly spawned work cache-warm), thieves take from
+    // the front (FIFO steals the oldest, usually largest, piece of work).
+    // alignas(64) keeps neighbouring deques off each other's cache line.
+    struct alignas(64) WorkerQueue {
+        std::mutex mtx;
+        std::deque<QueuedTask> tasks;
+    };
+
+    // Per-worker counters, updated with a relaxed load + store (no locked
+    // RMW); stats() may read them at any time and sees slightly stale but
+    // never torn values. That is only safe with one writer at a time:
+    //   - tasks_executed, busy_ns, idle_ns, queue_wait_histogram: written by
+    //     the owning worker only
+    //   - local_queue_high_water: also raised by enqueue_on_node() from the
+    //     submitting thread, but every writer holds the worker's deque mutex
+    //     (WorkerQueue::mtx) while raising it, which serializes them
+    struct alignas(64) WorkerStats {
+        std::atomic<uint64_t> tasks_executed{0};
+        std::atomic<uint64_t> busy_ns{0};
+        std::atomic<uint64_t> idle_ns{0};
+        std::atomic<uint64_t> local_queue_high_water{0};
+        std::array<std::atomic<uint64_t>, kLatencyBuckets> queue_wait_histogram{};
+    };
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t by) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    // Not an atomic max: callers hold the lock of the deque being measured
+    static void raise_high_water(std::atomic<uint64_t>& mark, uint64_t depth) {
+        if (depth > mark.load(std::memory_order_relaxed)) {
+            mark.store(depth, std::memory_order_relaxed);
+        }
+    }
+
+    static uint64_t to_ns(Clock::duration d) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+
+    SchedulingMode mode_;
+    std::vector<std::jthread> workers_;
+    std::queue<QueuedTask> tasks_;   // shared queue / external injection queue
+    std::vector<WorkerQueue> local_queues_;     // empty in SharedQueue mode
+    std::vector<WorkerStats> stats_;            // one per worker
+
+    // NUMA placement. Every worker belongs to one node (node 0 when unpinned).
+    // In SharedQueue mode each node has its own submission queue and condition
+    // variable, both guarded by queue_mutex_; in WorkStealing mode node-targeted
+    // tasks go straight into a deque owned by one of that node's workers.
+    CpuTopology topology_;
+    std::vector<int> worker_cpu_;               // -1 = not pinned
+    std::vector<size_t> worker_node_;
+    std::vector<bool> pinned_;                  // pin result, set by each worker
+    std::vector<std::vector<size_t>> node_workers_;
+    std::vector<std::queue<QueuedTask>> node_tasks_;
+    std::vector<QueueCondition> node_cv_;
+    std::vector<size_t> node_sleepers_;         // guarded by queue_mutex_
+    size_t wake_cursor_ = 0;                    // guarded by queue_mutex_
+    std::atomic<size_t> node_cursor_{0};
+    std::atomic<uint64_t> shared_queue_high_water_{0};  // written under queue_mutex_
+    QueueMutex queue_mutex_ = mutex_profile::make_mutex<QueueMutex>("ThreadPool queue");
+    std::mutex cout_mutex_;  // Separate mutex for console output
+    std::atomic<bool> printed_{false};  // safe_print used: flush the logger on shutdown
+    QueueCondition cv_;
+    bool shutdown_ = false;  // Manual shutdown flag
+
+    // pending_ counts queued-but-not-started tasks across all queues, so a
+    // worker can tell without a lock whether going to sleep is safe (work
+    // stealing) or whether spinning is still worth it (both modes).
+    // sleeping_ lets a local push skip queue_mutex_ entirely while everyone is busy.
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> sleeping_{0};
+    std::atomic<bool> stopping_{false};   // lock-free mirror of shutdown_ for spinners
+
+    // Each worker spins briefly before parking on its condition variable
+    std::deque<AdaptiveWaiter> waiters_;   // deque: grows without moving the atomics
+
+    bool work_or_shutdown() const {
+        return pending_.load(std::memory_order_relaxed) > 0 || stopping_.load(std::memory_order_relaxed);
+    }
+
+    // Identifies the pool and the deque of the calling thread, so enqueue()
+    // from inside a task lands on the submitting worker's own deque.
+    static inline thread_local BasicThreadPool* current_pool_ = nullptr;
+    static inline thread_local size_t current_index_ = 0;
+    
+    // Runs one task and charges its idle gap, queue wait and run time to the
+    // worker. idle_since is the end of the worker's previous task.
+    void run_task(size_t index, QueuedTask& queued, Clock::time_point& idle_since) {
+        WorkerStats& stats = stats_[index];
+        const Clock::time_point start = Clock::now();
+        bump(stats.idle_ns, to_ns(start - idle_since));
+        const uint64_t wait_ns = to_ns(start - queued.enqueued);
+        const size_t bucket = std::min<size_t>(std::bit_width(wait_ns), kLatencyBuckets - 1);
+        bump(stats.queue_wait_histogram[bucket], 1);
+
+        {
+            TRACE_SCOPE_CAT("task", "pool");
+            queued.task();
+        }
+
+        const Clock::time_point end = Clock::now();
+        bump(stats.busy_ns, to_ns(end - start));
+        bump(stats.tasks_executed, 1);
+        idle_since = end;
+    }
+
+    // Runs on the worker itself, before its first task, so there is no window
+    // where the thread executes on the wrong core.
+    void apply_affinity(size_t index) {
+#if defined(__linux__)
+        if (worker_cpu_[index] >= 0) {
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            CPU_SET(static_cast<unsigned>(worker_cpu_[index]), &mask);
+            const bool ok = pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+            std::lock_guard<QueueMutex> lock(queue_mutex_);
+            pinned_[index] = ok;
+        }
+#else
+        static_cast<void>(index);
+#endif
+    }
+
+    // Picks a node with a parked worker for a task any node may run.
+    // Called with queue_mutex_ held; returns npos when every worker is busy.
+    size_t pick_node_to_wake() {
+        const size_t nodes = node_cv_.size();
+        for (size_t k = 0; k < nodes; ++k) {
+            const size_t node = (wake_cursor_ + k) % nodes;
+            if (node_sleepers_[node] > 0) {
+                wake_cursor_ = node + 1;
+                return node;
+            }
+        }
+        return std::numeric_limits<size_t>::max();
+    }
+
+    void notify_all_workers() {
+        cv_.notify_all();
+        for (auto& node_cv : node_cv_) {
+            node_cv.notify_all();
+        }
+    }
+
+    // Wakes one worker for a node-agnostic task (node from pick_node_to_wake)
+    void wake_one(size_t node) {
+        if (mode_ == SchedulingMode::WorkStealing) {
+            cv_.notify_one();
+        } else if (node < node_cv_.size()) {
+            node_cv_[node].notify_one();
+        }
+    }
+
+    void worker_thread(std::stop_token stop_token, size_t index) {
+        apply_affinity(index);
+        TRACE_THREAD_NAME("pool worker " + std::to_string(index));
+        const size_t node = worker_node_[index];
+        std::queue<QueuedTask>& node_queue = node_tasks_[node];
+        Clock::time_point idle_since = Clock::now();
+        while (true) {
+            QueuedTask task;
+            
+            {
+                std::unique_lock<QueueMutex> lock(queue_mutex_);
+                if (node_queue.empty() && tasks_.empty() && !shutdown_) {
+                    // Nothing to do: watch pending_ without the lock for a while
+                    // before paying for a futex sleep. A hit on a task queued for
+                    // another node just ends the spin early; the wait below
+                    // still re-checks our own queues under the lock.
+                    lock.unlock();
+                    waiters_[index].spin([this] { return work_or_shutdown(); });
+                    lock.lock();
+                }
+                ++node_sleepers_[node];
+                node_cv_[node].wait(lock, [this, &node_queue, &stop_token] {
+                    return !node_queue.empty() || !tasks_.empty() || shutdown_ || stop_token.stop_requested();
+                });
+                --node_sleepers_[node];
+                
+                // Process remaining tasks even after shutdown or stop request
+                // Note: jthread's destructor automatically calls request_stop(), which triggers the immediate exit 
+                // before all tasks complete. 
+                // We need to check the stop_token only after ensuring the queue is empty:
+                if (node_queue.empty() && tasks_.empty()) {
+                    // Only exit if queue is truly empty
+                    if (shutdown_ || stop_token.stop_requested()) {
+                        return;
+                    }
+                }
+                
+                // Node-local work first, then anything submitted without a node
+                if (!node_queue.empty()) {
+                    task = std::move(node_queue.front());
+                    node_queue.pop();
+                    pending_.fetch_sub(1);
+                } else if (!tasks_.empty()) {
+                    task = std::move(tasks_.front());
+                    tasks_.pop();
+                    pending_.fetch_sub(1);
+                }
+            }
+            
+            if (task.task) {
+                run_task(index, task, idle_since);
+            }
+        }
+    }
+
+    bool try_pop_local(size_t index, QueuedTask& task) {
+        WorkerQueue& own = local_queues_[index];
+        std::lock_guard<std::mutex> lock(own.mtx);
+        if (own.tasks.empty()) {
+            return false;
+        }
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        return true;
+    }
+
+    bool try_pop_shared(QueuedTask& task) {
+        std::lock_guard<QueueMutex> lock(queue_mutex_);
+        if (tasks_.empty()) {
+            return false;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop();
+        return true;
+    }
+
+    // Victims on the thief's own NUMA node are tried before remote ones, so
+    // node-local tasks only cross the interconnect when their node is saturated.
+    bool try_steal(size_t thief, QueuedTask& task) {
+        const size_t n = local_queues_.size();
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t k = 1; k < n; ++k) {
+                const size_t v = (thief + k) % n;
+                if ((worker_node_[v] == worker_node_[thief]) != (pass == 0)) {
+                    continue;
+                }
+                WorkerQueue& victim = local_queues_[v];
+                // try_to_lock: never queue up behind a busy owner, just move on
+                std::unique_lock<std::mutex> lock(victim.mtx, std::try_to_lock);
+                if (!lock.owns_lock() || victim.tasks.empty()) {
+                    continue;
+                }
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void push_local(size_t index, Task task) {
+        {
+            WorkerQueue& own = local_queues_[index];
+            std::lock_guard<std::mutex> lock(own.mtx);
+            own.tasks.push_back({std::move(task), Clock::now()});
+            raise_high_water(stats_[index].local_queue_high_water, own.tasks.size());
+        }
+        publish_local(1);
+    }
+
+    template<typename Range>
+    void push_local_bulk(size_t index, Range&& tasks) {
+        size_t count = 0;
+        {
+            WorkerQueue& own = local_queues_[index];
+            std::lock_guard<std::mutex> lock(own.mtx);
+            const Clock::time_point now = Clock::now();
+            for (auto&& task : tasks) {
+                own.tasks.push_back({Task(std::move(task)), now});
+                ++count;
+            }
+            raise_high_water(stats_[index].local_queue_high_water, own.tasks.size());
+        }
+        publish_local(count);
+    }
+
+    void publish_local(size_t count) {
+        if (count == 0) {
+            return;
+        }
+        pending_.fetch_add(count);
+        // Only pay for the condition variable when somebody is actually asleep.
+        // The seq_cst pair (pending_ here, sleeping_ in the worker) guarantees
+        // that either we see the sleeper or the sleeper sees our task.
+        if (sleeping_.load() > 0) {
+            { std::lock_guard<QueueMutex> lock(queue_mutex_); }
+            if (count == 1) {
+                cv_.notify_one();
+            } else {
+                cv_.notify_all();
+            }
+        }
+    }
+
+    void stealing_worker_thread(std::stop_token stop_token, size_t index) {
+        apply_affinity(index);
+        TRACE_THREAD_NAME("pool worker " + std::to_string(index));
+        current_pool_ = this;
+        current_index_ = index;
+        Clock::time_point idle_since = Clock::now();
+
+        while (true) {
+            QueuedTask task;
+
+            // Own deque first, then external submissions, then the other workers
+            if (try_pop_local(index, task) || try_pop_shared(task) || try_steal(index, task)) {
+                pending_.fetch_sub(1);
+                run_task(index, task, idle_since);
+                continue;
+            }
+
+            if (waiters_[index].spin([this] { return work_or_shutdown(); }) && !stopping_.load()) {
+                continue;
+            }
+
+            std::unique_lock<QueueMutex> lock(queue_mutex_);
+            if (pending_.load() > 0) {
+                // A task exists but its deque was momentarily locked by someone else
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+
+            sleeping_.fetch_add(1);
+            cv_.wait(lock, [this, &stop_token] {
+                return pending_.load() > 0 || shutdown_ || stop_token.stop_requested();
+            });
+            sleeping_.fetch_sub(1);
+
+            // Same drain-on-destruction rule as the shared queue: leave only once
+            // no task is queued anywhere. Tasks still running on other workers may
+            // push more work, but those workers will drain their own deques.
+            if (pending_.load() == 0 && (shutdown_ || stop_token.stop_requested())) {
+                return;
+            }
+        }
+    }
+    
+public:
+    explicit BasicThreadPool(size_t num_threads, SchedulingMode mode = SchedulingMode::SharedQueue)
+        : BasicThreadPool(num_threads, mode, AffinityOptions{}) {}
+
+    // waiting controls how idle workers wait for work: the default spins
+    // adaptively before parking, AdaptiveWaiter::Config::park_only() parks at once.
+    BasicThreadPool(size_t num_threads, SchedulingMode mode, const AffinityOptions& affinity,
+                    const AdaptiveWaiter::Config& waiting = {})
+        : mode_(mode),
+          local_queues_(mode == SchedulingMode::WorkStealing ? num_threads : 0),
+          stats_(num_threads),
+          topology_(CpuTopology::detect()),
+          worker_cpu_(num_threads, -1),
+          worker_node_(num_threads, 0),
+          pinned_(num_threads, false),
+          node_workers_(topology_.num_nodes()),
+          node_tasks_(topology_.num_nodes()),
+          node_cv_(topology_.num_nodes()),
+          node_sleepers_(topology_.num_nodes(), 0) {
+        for (size_t i = 0; i < num_threads; ++i) {
+            waiters_.emplace_back(waiting);
+        }
+        // Decide every worker's core and node up front; the workers pin
+        // themselves as their first action.
+        const auto& nodes = topology_.node_cpus;
+        for (size_t i = 0; i < num_threads; ++i) {
+            switch (affinity.policy) {
+            case AffinityPolicy::None:
+                break;
+            case AffinityPolicy::PinToCores:
+                if (!affinity.cores.empty()) {
+                    const unsigned cpu = affinity.cores[i % affinity.cores.size()];
+                    worker_cpu_[i] = static_cast<int>(cpu);
+                    worker_node_[i] = topology_.node_of(cpu);
+                }
+                break;
+            case AffinityPolicy::PinToNode: {
+                const size_t node = std::min(affinity.numa_node, nodes.size() - 1);
+                worker_cpu_[i] = static_cast<int>(nodes[node][i % nodes[node].size()]);
+                worker_node_[i] = node;
+                break;
+            }
+            case AffinityPolicy::SpreadNodes: {
+                const size_t node = i % nodes.size();
+                const size_t slot = i / nodes.size();
+                worker_cpu_[i] = static_cast<int>(nodes[node][slot % nodes[node].size()]);
+                worker_node_[i] = node;
+                break;
+            }
+            }
+            node_workers_[worker_node_[i]].push_back(i);
+        }
+
+        workers_.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i) {
+            if (mode_ == SchedulingMode::WorkStealing) {
+                workers_.emplace_back([this, i](std::stop_token st) {
+                    stealing_worker_thread(st, i);
+                });
+            } else {
+                workers_.emplace_back([this, i](std::stop_token st) {
+                    worker_thread(st, i);
+                });
+            }
+        }
+    }
+    
+    void enqueue(Task task) {
+        // Submitted from one of our own workers: keep it on that worker's deque.
+        // Allowed during shutdown too, so tasks that spawn children still drain.
+        if (mode_ == SchedulingMode::WorkStealing && current_pool_ == this) {
+            push_local(current_index_, std::move(task));
+            return;
+        }
+
+        size_t wake = 0;
+        {
+            std::lock_guard<QueueMutex> lock(queue_mutex_);
+            if (shutdown_) {
+                throw std::runtime_error("Cannot enqueue on shutdown pool");
+            }
+            tasks_.push({std::move(task), Clock::now()});
+            raise_high_water(shared_queue_high_water_, tasks_.size());
+            pending_.fetch_add(1);
+            if (mode_ == SchedulingMode::SharedQueue) {
+                wake = pick_node_to_wake();
+            }
+        }
+        wake_one(wake);
+    }
+
+    // Queues a task for the workers of one NUMA node, e.g. because it touches
+    // memory first-touched on that node. Nodes without workers (an unpinned
+    // pool, or a pool confined to another node) fall back to plain enqueue().
+    // In work-stealing mode the task lands on a deque of that node; remote
+    // workers only take it once the whole node is busy.
+    void enqueue_on_node(size_t node, Task task) {
+        if (node >= node_workers_.size() || node_workers_[node].empty()) {
+            enqueue(std::move(task));
+            return;
+        }
+
+        if (mode_ == SchedulingMode::WorkStealing) {
+            const std::vector<size_t>& candidates = node_workers_[node];
+            const size_t target = candidates[node_cursor_.fetch_add(1, std::memory_order_relaxed) % candidates.size()];
+            {
+                // queue_mutex_ orders the push against the destructor's shutdown
+                // flag, exactly like the external path of enqueue()
+                std::lock_guard<QueueMutex> lock(queue_mutex_);
+                if (shutdown_) {
+                    throw std::runtime_error("Cannot enqueue on shutdown pool");
+                }
+                WorkerQueue& queue = local_queues_[target];
+                std::lock_guard<std::mutex> queue_lock(queue.mtx);
+                queue.tasks.push_back({std::move(task), Clock::now()});
+                raise_high_water(stats_[target].local_queue_high_water, queue.tasks.size());
+                pending_.fetch_add(1);
+            }
+            cv_.notify_one();
+            return;
+        }
+
+        {
+            std::lock_guard<QueueMutex> lock(queue_mutex_);
+            if (shutdown_) {
+                throw std::runtime_error("Cannot enqueue on shutdown pool");
+            }
+            node_tasks_[node].push({std::move(task), Clock::now()});
+            raise_high_water(shared_queue_high_water_, node_tasks_[node].size());
+            pending_.fetch_add(1);
+        }
+        node_cv_[node].notify_one();
+    }
+
+    // NUMA node a worker belongs to (0 when the pool is not pinned)
+    size_t worker_node(size_t index) const { return worker_node_[index]; }
+
+    size_t numa_nodes() const { return topology_.num_nodes(); }
+
+    // Prints what the pool detected and where each worker runs
+    void print_topology() {
+        std::lock_guard<std::mutex> cout_lock(cout_mutex_);
+        std::cout << "Hardware supports " << topology_.hardware_threads << " concurrent threads" << std::endl;
+        std::cout << "Detected " << topology_.num_nodes() << " NUMA node(s)" << std::endl;
+        for (size_t n = 0; n < topology_.num_nodes(); ++n) {
+            std::cout << "  node " << n << ": CPUs";
+            for (unsigned cpu : topology_.node_cpus[n]) {
+                std::cout << ' ' << cpu;
+            }
+            std::cout << std::endl;
+        }
+        std::lock_guard<QueueMutex> lock(queue_mutex_);
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            std::cout << "  worker " << i << " thread ID " << workers_[i].get_id() << ": ";
+            if (worker_cpu_[i] < 0) {
+                std::cout << "unpinned";
+            } else {
+                std::cout << "CPU " << worker_cpu_[i] << (pinned_[i] ? "" : " (pinning failed)");
+            }
+            std::cout << ", node " << worker_node_[i] << std::endl;
+        }
+    }
+
+    // Runs f(args...) on the pool and hands back a std::future for the result.
+    // The callable and the promise travel inside one Task, so the only heap
+    // allocation is the future's shared state. Exceptions propagate to get().
+    template<typename F, typename... Args>
+    auto submit(F&& f, Args&&... args)
+        -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> {
+        using R = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+
+        std::promise<R> promise;
+        std::future<R> future = promise.get_future();
+        enqueue([promise = std::move(promise),
+                 fn = std::forward<F>(f),
+                 bound = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    std::apply(std::move(fn), std::move(bound));
+                    promise.set_value();
+                } else {
+                    promise.set_value(std::apply(std::move(fn), std::move(bound)));
+                }
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        });
+        return future;
+    }
+
+    // Zero-allocation variant of submit(): the result lands in a caller-owned
+    // Completion, which only needs to stay alive until wait()/get() returns.
+    template<typename R, typename F, typename... Args>
+    void submit_into(Completion<R>& done, F&& f, Args&&... args) {
+        enqueue([&done, fn = std::forward<F>(f),
+                 bound = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            done.run([&] { return std::apply(std::move(fn), std::move(bound)); });
+        });
+    }
+
+    // Moves every task out of the range under one lock acquisition and wakes
+    // the workers with one notification, instead of one lock + notify_one per
+    // task. Elements must be convertible to Task; the range is left moved-from.
+    template<std::ranges::input_range Range>
+    void enqueue_bulk(Range&& tasks) {
+        if (mode_ == SchedulingMode::WorkStealing && current_pool_ == this) {
+            push_local_bulk(current_index_, tasks);
+            return;
+        }
+
+        size_t count = 0;
+        {
+            std::lock_guard<QueueMutex> lock(queue_mutex_);
+            if (shutdown_) {
+                throw std::runtime_error("Cannot enqueue on shutdown pool");
+            }
+            const Clock::time_point now = Clock::now();
+            for (auto&& task : tasks) {
+                tasks_.push({Task(std::move(task)), now});
+                ++count;
+            }
+            raise_high_water(shared_queue_high_water_, tasks_.size());
+            pending_.fetch_add(count);
+        }
+        if (count == 1 && mode_ == SchedulingMode::WorkStealing) {
+            cv_.notify_one();
+        } else if (count > 0) {
+            notify_all_workers();
+        }
+    }
+
+    // Splits [begin, end) into chunks of at least `grain` indices, about four
+    // per worker so uneven chunks still balance, and blocks until all are done.
+    // fn is called either as fn(i) for every index or, if it accepts two
+    // arguments, as fn(chunk_begin, chunk_end) once per chunk.
+    // The calling thread claims chunks too, so calling parallel_for from inside
+    // a task cannot deadlock even if every other worker is busy. The first
+    // exception thrown by fn is rethrown here once all claimed chunks finish.
+    template<std::integral Index, typename Fn>
+    void parallel_for(Index begin, Index end, Index grain, Fn fn) {
+        if (end <= begin) {
+            return;
+        }
+        const size_t total = static_cast<size_t>(end - begin);
+        const size_t workers = std::max<size_t>(workers_.size(), 1);
+        const size_t chunk = std::max<size_t>({static_cast<size_t>(grain), 1,
+                                               (total + workers * 4 - 1) / (workers * 4)});
+        const size_t num_chunks = (total + chunk - 1) / chunk;
+
+        // Shared state outlives this call: helpers that start after the last
+        // chunk was claimed just find nothing left and drop their reference.
+        struct Region {
+            std::atomic<size_t> next{0};
+            std::atomic<size_t> done{0};
+            std::mutex error_mutex;
+            std::exception_ptr error;
+        };
+        auto region = std::make_shared<Region>();
+
+        auto run_chunks = [region, begin, total, chunk, num_chunks, fn]() {
+            for (size_t c; (c = region->next.fetch_add(1)) < num_chunks; ) {
+                const Index lo = static_cast<Index>(begin + c * chunk);
+                const Index hi = static_cast<Index>(begin + std::min(c * chunk + chunk, total));
+                try {
+                    if constexpr (std::is_invocable_v<const Fn&, Index, Index>) {
+                        fn(lo, hi);
+                    } else {
+                        for (Index i = lo; i < hi; ++i) {
+                            fn(i);
+                        }
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(region->error_mutex);
+                    if (!region->error) {
+                        region->error = std::current_exception();
+                    }
+                }
+                if (region->done.fetch_add(1) + 1 == num_chunks) {
+                    region->done.notify_all();
+                }
+            }
+        };
+
+        // One helper per worker at most (the caller is the extra participant)
+        const size_t helpers = std::min(workers, num_chunks - 1);
+        std::vector<Task> batch;
+        batch.reserve(helpers);
+        for (size_t h = 0; h < helpers; ++h) {
+            batch.emplace_back(run_chunks);
+        }
+        enqueue_bulk(batch);
+
+        run_chunks();
+        for (size_t d = region->done.load(); d < num_chunks; d = region->done.load()) {
+            region->done.wait(d);
+        }
+        if (region->error) {
+            std::rethrow_exception(region->error);
+        }
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    // Spin/yield/park outcome counts of one worker's waiter
+    AdaptiveWaiter::Stats wait_stats(size_t index) const { return waiters_[index].stats(); }
+
+    // Copies every worker's counters without taking any lock; safe to call
+    // while the pool runs. A worker's idle time is charged when its next task
+    // starts, so a currently parked worker's idle stretch is not yet included.
+    PoolStatsSnapshot stats() const {
+        PoolStatsSnapshot snapshot;
+        snapshot.workers.reserve(stats_.size());
+        for (const WorkerStats& w : stats_) {
+            WorkerStatsSnapshot copy;
+            copy.tasks_executed = w.tasks_executed.load(std::memory_order_relaxed);
+            copy.busy_ns = w.busy_ns.load(std::memory_order_relaxed);
+            copy.idle_ns = w.idle_ns.load(std::memory_order_relaxed);
+            copy.local_queue_high_water = w.local_queue_high_water.load(std::memory_order_relaxed);
+            for (size_t b = 0; b < kLatencyBuckets; ++b) {
+                copy.queue_wait_histogram[b] = w.queue_wait_histogram[b].load(std::memory_order_relaxed);
+            }
+            snapshot.workers.push_back(copy);
+        }
+        snapshot.shared_queue_high_water = shared_queue_high_water_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    // Publishes stats() to a metrics registry on every scrape, labelled
+    // pool="<name>". Keep the Registration no longer than the pool.
+    metrics::Registration register_metrics(metrics::Registry& registry, std::string name = "pool") const {
+        return registry.add_collector([this, name = std::move(name)](metrics::Exposition& out) {
+            const PoolStatsSnapshot snapshot = stats();
+            const std::string pool = "pool=\"" + name + "\"";
+            for (size_t i = 0; i < snapshot.workers.size(); ++i) {
+                const WorkerStatsSnapshot& w = snapshot.workers[i];
+                const std::string labels = pool + ",worker=\"" + std::to_string(i) + "\"";
+                out.counter("pool_tasks_executed_total", "Tasks run by a worker", labels,
+                            static_cast<double>(w.tasks_executed));
+                out.counter("pool_busy_seconds_total", "Time a worker spent inside tasks", labels,
+                            static_cast<double>(w.busy_ns) * 1e-9);
+                out.counter("pool_idle_seconds_total", "Time a worker spent between tasks", labels,
+                            static_cast<double>(w.idle_ns) * 1e-9);
+            }
+            const WorkerStatsSnapshot total = snapshot.total();
+            std::vector<std::pair<double, uint64_t>> buckets;
+            uint64_t count = 0;
+            double sum = 0;
+            for (size_t b = 0; b < kLatencyBuckets; ++b) {
+                // Bucket b holds [2^(b-1), 2^b) ns, so its inclusive le bound is
+                // 2^b - 1; the last bucket also holds everything above. The sum
+                // is estimated from bucket midpoints
+                const double end = b == 0 ? 1.0 : static_cast<double>(uint64_t{1} << b);
+                const double upper = b == kLatencyBuckets - 1 ? std::numeric_limits<double>::infinity() : end - 1.0;
+                buckets.emplace_back(upper, total.queue_wait_histogram[b]);
+                count += total.queue_wait_histogram[b];
+                sum += (b == 0 ? 0.0 : 0.75 * end) * static_cast<double>(total.queue_wait_histogram[b]);
+            }
+            out.histogram("pool_queue_wait_seconds", "Time tasks waited in a queue", pool, buckets, sum, count, 1e-9);
+            out.gauge("pool_shared_queue_high_water", "Deepest the shared queue has been", pool,
+                      static_cast<double>(snapshot.shared_queue_high_water));
+            out.gauge("pool_workers", "Worker threads", pool, static_cast<double>(snapshot.workers.size()));
+        });
+    }
+
+    SchedulingMode mode() const { return mode_; }
+    
+    // Thread-safe console output: formatted on the calling thread and
+    // written in batches by the AsyncLogger (../async_logger.hpp), so tasks
+    // that print no longer queue up on a console mutex
+    template<typename... Args>
+    void safe_print(Args&&... args) {
+        printed_.store(true, std::memory_order_relaxed);
+        AsyncLogger::global().log(args...);
+    }
+    
+    ~BasicThreadPool() {
+        // Signal shutdown and wake all threads
+        {
+            std::lock_guard<QueueMutex> lock(queue_mutex_);
+            shutdown_ = true;
+            stopping_.store(true);
+        }
+        notify_all_workers();
+        
+        // jthreads automatically join here (blocking until all workers finish)
+        workers_.clear();  // Explicit join by clearing the vector
+
+        // Task output first, then the shutdown message
+        if (printed_.load(std::memory_order_relaxed)) {
+            AsyncLogger::global().flush();
+        }
+        {
+            std::lock_guard<std::mutex> lock(cout_mutex_);
+            std::cout << "ThreadPool shutting down...\n";
+        }
+    }
+};
+
+using ThreadPoolRAII = BasicThreadPool<>;
@@ -3,99 +3,193 @@ g++ -pthread --std=c++20 thread_pool_with_work_queue.cpp -o app
 */
 #include <thread>
 #include <queue>
+#include <deque>
 #include <functional>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <latch>
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
+#include <future>
+#include <optional>
+#include <tuple>
+#include <memory>
+#include <array>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <ranges>
+#include <concepts>
+#include <cmath>
+#include <bit>
+#include <cstdint>
+#include <iomanip>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <limits>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
-class ThreadPoolRAII {
-private:
-    std::vector<std::jthread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex queue_mutex_;
-    std::mutex cout_mutex_;  // Separate mutex for console output
-    std::condition_variable cv_;
-    bool shutdown_ = false;  // Manual shutdown flag
-    
-    void worker_thread(std::stop_token stop_token) {
-        while (true) {
-            std::function<void()> task;
-            
-            {
-                std::unique_lock<std::mutex> lock(queue_mutex_);
-                cv_.wait(lock, [this, &stop_token] {
-                    return !tasks_.empty() || shutdown_ || stop_token.stop_requested();
-                });
-                
-                // Process remaining tasks even after shutdown or stop request
-                // Note: jthread's destructor automatically calls request_stop(), which triggers the immediate exit 
-                // before all tasks complete. 
-                // We need to check the stop_token only after ensuring the queue is empty:
-                if (tasks_.empty()) {
-                    // Only exit if queue is truly empty
-                    if (shutdown_ || stop_token.stop_requested()) {
-                        return;
-                    }
-                }
-                
-                if (!tasks_.empty()) {
-                    task = std::move(tasks_.front());
-                    tasks_.pop();
-                }
-            }
-            
-            if (task) {
-                task();
-            }
-        }
+#include "thread_pool.hpp"
+
+// Counts every global allocation so main() can compare submission paths.
+// Every replaceable form (array, sized, aligned, nothrow) goes through the
+// same pair of functions, so nothing allocated here is freed by the
+// library's operator delete or the other way round. They stay out of line:
+// once free() is inlined into a delete that GCC pairs with operator new,
+// it warns about a mismatch (-Wmismatched-new-delete).
+std::atomic<size_t> g_allocations{0};
+
+[[gnu::noinline]] void* counted_alloc(std::size_t size, std::size_t alignment) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    size = size ? size : 1;
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(size);
     }
-    
-public:
-    explicit ThreadPoolRAII(size_t num_threads) {
-        workers_.reserve(num_threads);
-        for (size_t i = 0; i < num_threads; ++i) {
-            workers_.emplace_back([this](std::stop_token st) {
-                worker_thread(st);
-            });
-        }
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+[[gnu::noinline]] void counted_free(void* p) noexcept { std::free(p); }
+
+void* operator new(std::size_t size) {
+    if (void* p = counted_alloc(size, 0)) {
+        return p;
     }
-    
-    void enqueue(std::function<void()> task) {
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            if (shutdown_) {
-                throw std::runtime_error("Cannot enqueue on shutdown pool");
-            }
-            tasks_.push(std::move(task));
-        }
-        cv_.notify_one();
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* p = counted_alloc(size, static_cast<std::size_t>(alignment))) {
+        return p;
     }
-    
-    // Provide thread-safe console output
-    template<typename... Args>
-    void safe_print(Args&&... args) {
-        std::lock_guard<std::mutex> lock(cout_mutex_);
-        (std::cout << ... << args);
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, 0); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p); }
+
+// Recursive fan-out: every task spawns children from inside the pool, which is
+// exactly the case work stealing targets (children land on the local deque).
+void spawn_tree(ThreadPoolRAII& pool, std::latch& leaves, int depth) {
+    if (depth == 0) {
+        leaves.count_down();
+        return;
     }
-    
-    ~ThreadPoolRAII() {
-        // Signal shutdown and wake all threads
-        {
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            shutdown_ = true;
-        }
-        cv_.notify_all();
-        
-        // jthreads automatically join here (blocking until all workers finish)
-        workers_.clear();  // Explicit join by clearing the vector
-        
-        {
-            std::lock_guard<std::mutex> lock(cout_mutex_);
-            std::cout << "ThreadPool shutting down...\n";
+    for (int child = 0; child < 2; ++child) {
+        pool.enqueue([&pool, &leaves, depth] {
+            spawn_tree(pool, leaves, depth - 1);
+        });
+    }
+}
+
+double run_tree(SchedulingMode mode, size_t num_threads, int depth) {
+    std::latch leaves(std::ptrdiff_t{1} << depth);
+    ThreadPoolRAII pool(num_threads, mode);
+
+    auto start = std::chrono::steady_clock::now();
+    pool.enqueue([&pool, &leaves, depth] { spawn_tree(pool, leaves, depth); });
+    // Wait for the leaves rather than the destructor: the shared-queue pool
+    // refuses enqueue() once shutdown has begun, and inner nodes still spawn.
+    leaves.wait();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Allocations per task for one submission path; the capture (pointer + 40 bytes
+// of payload) overflows std::function's small buffer but fits Task inline.
+template<typename Submit>
+double allocations_per_task(Submit submit, int num_tasks) {
+    ThreadPoolRAII pool(1);
+    std::latch done(num_tasks);
+    std::array<int, 10> payload{};
+
+    size_t before = g_allocations.load();
+    for (int i = 0; i < num_tasks; ++i) {
+        payload[0] = i;
+        submit(pool, [&done, payload] {
+            static_cast<void>(payload);
+            done.count_down();
+        });
+    }
+    done.wait();
+    size_t after = g_allocations.load();
+    return static_cast<double>(after - before) / num_tasks;
+}
+
+// Three dependent phases over one array, the shape of the barrier-based
+// parallel_matrix_calculation.cpp, with parallel_for doing the chunking.
+// Each parallel_for returns only when its phase is complete, so it doubles
+// as the barrier between phases.
+double matrix_phases(ThreadPoolRAII& pool, std::vector<double>& data) {
+    const size_t size = data.size();
+
+    pool.parallel_for(size_t{0}, size, size_t{1024}, [&data](size_t i) {
+        data[i] = static_cast<double>(i);
+    });
+
+    std::atomic<double> total{0.0};
+    pool.parallel_for(size_t{0}, size, size_t{1024}, [&data, &total](size_t lo, size_t hi) {
+        double sum = 0.0;
+        for (size_t i = lo; i < hi; ++i) {
+            sum += std::sqrt(data[i]);
         }
+        total.fetch_add(sum);
+    });
+
+    const double divisor = total.load() + 1.0;
+    pool.parallel_for(size_t{0}, size, size_t{1024}, [&data, divisor](size_t i) {
+        data[i] /= divisor;
+    });
+    return divisor - 1.0;
+}
+
+void print_stats(const PoolStatsSnapshot& snapshot) {
+    std::cout << "  worker  tasks      busy(ms)   idle(ms)   local-hw  wait-p50(ns)  wait-p99(ns)\n";
+    for (size_t i = 0; i < snapshot.workers.size(); ++i) {
+        const WorkerStatsSnapshot& w = snapshot.workers[i];
+        std::cout << "  " << std::setw(6) << i
+                  << "  " << std::setw(9) << w.tasks_executed
+                  << "  " << std::setw(9) << w.busy_ns / 1e6
+                  << "  " << std::setw(9) << w.idle_ns / 1e6
+                  << "  " << std::setw(8) << w.local_queue_high_water
+                  << "  " << std::setw(12) << w.queue_wait_percentile_ns(0.50)
+                  << "  " << std::setw(12) << w.queue_wait_percentile_ns(0.99) << "\n";
     }
-};
+    const WorkerStatsSnapshot all = snapshot.total();
+    std::cout << "  total tasks " << all.tasks_executed
+              << ", shared queue high-water " << snapshot.shared_queue_high_water
+              << ", wait p99.9 " << all.queue_wait_percentile_ns(0.999) << " ns\n";
+}
 
 int main() {
     {
@@ -109,10 +203,206 @@ int main() {
             });
         }
         
-        std::cout << "All tasks enqueued\n";
+        // Tasks are printing through the AsyncLogger right now: a direct
+        // std::cout write would land in the middle of their lines
+        pool.safe_print("All tasks enqueued\n");
         
     } // Pool destructor waits for all tasks to complete, then joins threads
     
     std::cout << "All work completed\n";
+
+    // Same drain-on-destruction contract in work-stealing mode
+    {
+        ThreadPoolRAII pool(3, SchedulingMode::WorkStealing);
+
+        for (int i = 0; i < 6; ++i) {
+            pool.enqueue([i, &pool]() {
+                pool.safe_print("Stealing-mode task ", i, " executing on thread ",
+                               std::this_thread::get_id(), "\n");
+            });
+        }
+    }
+
+    // Many tiny tasks spawned from inside the pool: shared queue vs work stealing
+    const size_t num_threads = std::max(2u, std::thread::hardware_concurrency());
+    const int depth = 16;  // 2^16 leaves, ~131k tasks in total
+    double shared_ms = run_tree(SchedulingMode::SharedQueue, num_threads, depth);
+    double stealing_ms = run_tree(SchedulingMode::WorkStealing, num_threads, depth);
+
+    std::cout << "Fan-out of " << (1 << depth) << " leaves on " << num_threads << " threads\n";
+    std::cout << "  shared queue : " << shared_ms << " ms\n";
+    std::cout << "  work stealing: " << stealing_ms << " ms\n";
+
+    // Move-only callables, futures and caller-owned completions
+    {
+        ThreadPoolRAII pool(2);
+
+        auto owned = std::make_unique<int>(42);
+        pool.enqueue([owned = std::move(owned), &pool] {  // std::function cannot hold this
+            pool.safe_print("Move-only task sees ", *owned, "\n");
+        });
+
+        std::future<int> answer = pool.submit([](int a, int b) { return a * b; }, 6, 7);
+        std::future<void> failing = pool.submit([] { throw std::runtime_error("task failed"); });
+
+        Completion<long> sum;
+        pool.submit_into(sum, [](long n) { return n * (n + 1) / 2; }, 1000L);
+
+        // Same logger as the move-only task, which may still be printing
+        pool.safe_print("submit() result: ", answer.get(), "\n");
+        try {
+            failing.get();
+        } catch (const std::exception& e) {
+            pool.safe_print("submit() exception: ", e.what(), "\n");
+        }
+        pool.safe_print("submit_into() result: ", sum.get(), "\n");
+    }
+
+    // Allocation count: std::function path vs Task path. Both numbers include the
+    // queue's own node allocations, so the difference is pure type-erasure cost.
+    const int num_tasks = 10000;
+    double function_allocs = allocations_per_task([](ThreadPoolRAII& pool, auto&& fn) {
+        pool.enqueue(std::function<void()>(fn));
+    }, num_tasks);
+    double task_allocs = allocations_per_task([](ThreadPoolRAII& pool, auto&& fn) {
+        pool.enqueue(fn);
+    }, num_tasks);
+
+    double future_allocs = 0.0;
+    double completion_allocs = 0.0;
+    {
+        ThreadPoolRAII pool(1);
+        std::vector<std::future<int>> futures;
+        futures.reserve(num_tasks);
+        std::vector<Completion<int>> slots(num_tasks);
+
+        size_t before = g_allocations.load();
+        for (int i = 0; i < num_tasks; ++i) {
+            futures.push_back(pool.submit([i] { return i; }));
+        }
+        for (auto& f : futures) {
+            f.get();
+        }
+        future_allocs = static_cast<double>(g_allocations.load() - before) / num_tasks;
+
+        before = g_allocations.load();
+        for (int i = 0; i < num_tasks; ++i) {
+            pool.submit_into(slots[i], [i] { return i; });
+        }
+        for (auto& slot : slots) {
+            slot.get();
+        }
+        completion_allocs = static_cast<double>(g_allocations.load() - before) / num_tasks;
+    }
+
+    // An inplace_function (../inplace_function.hpp) is a callable like any
+    // other: inplace_function<void(), 32> is 40 bytes and moves into Task's
+    // buffer inline - here holding a move-only capture, which
+    // std::function<void()> cannot hold at all
+    double inplace_allocs = 0.0;
+    {
+        ThreadPoolRAII pool(1);
+        std::latch done(num_tasks);
+        std::atomic<long long> sum{0};
+        std::vector<std::unique_ptr<int>> boxes;
+        for (int i = 0; i < num_tasks; ++i) {
+            boxes.push_back(std::make_unique<int>(i));
+        }
+
+        size_t before = g_allocations.load();
+        for (auto& box : boxes) {
+            inplace_function<void(), 32> fn = [&done, &sum, box = std::move(box)] {
+                sum.fetch_add(*box, std::memory_order_relaxed);
+                done.count_down();
+            };
+            pool.enqueue(std::move(fn));
+        }
+        done.wait();
+        inplace_allocs = static_cast<double>(g_allocations.load() - before) / num_tasks;
+    }
+
+    std::cout << "Allocations per task (" << num_tasks << " tasks, 48-byte capture)\n";
+    std::cout << "  enqueue(std::function) : " << function_allocs << "\n";
+    std::cout << "  enqueue(Task)          : " << task_allocs << "\n";
+    std::cout << "  enqueue(inplace_function, move-only capture): " << inplace_allocs << "\n";
+    std::cout << "  submit() -> future     : " << future_allocs << "\n";
+    std::cout << "  submit_into(Completion): " << completion_allocs << "\n";
+
+    // Per-task enqueue vs one enqueue_bulk call for many tiny tasks
+    const int tiny_tasks = 100000;
+    auto time_submission = [&](bool bulk) {
+        ThreadPoolRAII pool(num_threads);
+        std::latch done(tiny_tasks);
+        auto start = std::chrono::steady_clock::now();
+        if (bulk) {
+            std::vector<Task> batch;
+            batch.reserve(tiny_tasks);
+            for (int i = 0; i < tiny_tasks; ++i) {
+                batch.emplace_back([&done] { done.count_down(); });
+            }
+            pool.enqueue_bulk(batch);
+        } else {
+            for (int i = 0; i < tiny_tasks; ++i) {
+                pool.enqueue([&done] { done.count_down(); });
+            }
+        }
+        done.wait();
+        auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(stop - start).count();
+    };
+    double loop_ms = time_submission(false);
+    double bulk_ms = time_submission(true);
+    std::cout << tiny_tasks << " tiny tasks: enqueue loop " << loop_ms
+              << " ms, enqueue_bulk " << bulk_ms << " ms\n";
+
+    {
+        ThreadPoolRAII pool(num_threads);
+        std::vector<double> data(1 << 20);
+        double sum = matrix_phases(pool, data);
+        std::cout << "parallel_for phases: sum of roots " << sum
+                  << ", data[last] = " << data.back() << "\n";
+    }
+
+    // Topology report and node-targeted submission with pinned workers
+    {
+        AffinityOptions spread;
+        spread.policy = AffinityPolicy::SpreadNodes;
+        ThreadPoolRAII pool(num_threads, SchedulingMode::SharedQueue, spread);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));  // let workers pin
+        pool.print_topology();
+
+        std::latch done(static_cast<std::ptrdiff_t>(pool.numa_nodes()));
+        for (size_t node = 0; node < pool.numa_nodes(); ++node) {
+            pool.enqueue_on_node(node, [&pool, &done, node] {
+#if defined(__linux__)
+                pool.safe_print("Task for node ", node, " ran on CPU ", sched_getcpu(), "\n");
+#else
+                pool.safe_print("Task for node ", node, " ran\n");
+#endif
+                done.count_down();
+            });
+        }
+        done.wait();
+    }
+
+    // Live snapshot while tasks are still queued, then the final numbers
+    {
+        ThreadPoolRAII pool(num_threads, SchedulingMode::WorkStealing);
+        std::latch done(2000);
+        for (int i = 0; i < 2000; ++i) {
+            pool.enqueue([&done, i] {
+                // Every 100th task is slow, which shows up as head-of-line wait
+                std::this_thread::sleep_for(std::chrono::microseconds(i % 100 == 0 ? 2000 : 20));
+                done.count_down();
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::cout << "Pool stats while running:\n";
+        print_stats(pool.stats());
+
+        done.wait();
+        std::cout << "Pool stats after completion:\n";
+        print_stats(pool.stats());
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,273 @@
+/*
+Hierarchical timing wheel (header-only, just #include it): O(1) schedule and
+cancel for large numbers of timeouts, expiry callbacks run on a ThreadPoolRAII.
+Used by timer_wheel_demo.cpp and 40_Coroutines/executor.cpp
+(co_await coro::sleep_for(wheel, d)).
+
+A heap or an ordered map pays O(log n) per schedule and per cancel, and most
+timeouts are cancelled (the reply arrived). A thread per timer does not scale
+past a few thousand. Here time is cut into ticks (1 ms by default) and timers
+hang in the slots of four wheels of 256 slots each:
+
+    level 0   deadline within 256 ticks        slot = deadline        & 255
+    level 1   within 2^16 ticks                slot = deadline >>  8  & 255
+    level 2   within 2^24 ticks                slot = deadline >> 16  & 255
+    level 3   beyond                           slot = deadline >> 24  & 255
+
+Scheduling computes the level from the distance to the deadline and links
+the timer into its slot; cancelling unlinks it. Both are O(1) (a mutex held
+for a few pointer writes). Every tick the driver thread fires the level-0
+slot of that tick; every 256 ticks it first moves ("cascades") the next
+level-1 slot down into level 0, and so on up. A timer is cascaded at most
+three times. With 1 ms ticks level 3 reaches 49 days; a timer further out
+is parked in level 3 and re-filed there until its time comes.
+
+Timers fire at the first tick boundary at or after their deadline - never
+early, at most one tick (plus scheduling noise) late. All callbacks due on
+the same tick go to the pool in one enqueue_bulk() call.
+
+    TimerWheel wheel(pool);                          // 1 ms ticks
+    auto id = wheel.schedule_after(250ms, [] { on_timeout(); });
+    wheel.cancel(id);                                // false if it already fired
+
+Timer storage is a slab of nodes addressed by index; a TimerId carries the
+node's generation, so cancelling a timer that fired (and whose node was
+reused) is a harmless no-op. Timers still pending when the wheel is
+destroyed are dropped without running.
+*/
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct TimerId {
+        uint32_t index = kNone;
+        uint32_t generation = 0;
+    };
+
+    static constexpr size_t kLevels = 4;
+    static constexpr size_t kSlotBits = 8;
+    static constexpr size_t kSlots = size_t{1} << kSlotBits;
+
+    explicit TimerWheel(ThreadPoolRAII& pool, Clock::duration tick = std::chrono::milliseconds(1))
+        : m_pool(pool), m_tick(tick), m_origin(Clock::now()) {
+        m_heads.fill(kNone);
+        m_driver = std::jthread([this](std::stop_token stop) { drive(stop); });
+    }
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    ~TimerWheel() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_driver.request_stop();
+        }
+        m_cv.notify_one();
+    }
+
+    TimerId schedule_at(Clock::time_point deadline, Task callback) {
+        // Round up: a timer never fires before its deadline
+        const auto sinceOrigin = std::max(deadline - m_origin, Clock::duration::zero());
+        const uint64_t tick = static_cast<uint64_t>((sinceOrigin + m_tick - Clock::duration(1)) / m_tick);
+
+        bool wake = false;
+        TimerId id;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_pending == 0) {
+                // Nothing to fire in between: skip the idle ticks instead of walking them
+                m_now = std::max(m_now, current_tick());
+                wake = true;
+            }
+            const uint32_t index = allocate();
+            Node& node = m_nodes[index];
+            node.deadline = tick;
+            node.callback = std::move(callback);
+            link(index, m_now + 1);
+            ++m_pending;
+            id = {index, node.generation};
+        }
+        if (wake) {
+            m_cv.notify_one();
+        }
+        return id;
+    }
+
+    TimerId schedule_after(Clock::duration delay, Task callback) {
+        return schedule_at(Clock::now() + delay, std::move(callback));
+    }
+
+    /// True if the timer was pending and will not run
+    bool cancel(TimerId id) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (id.index >= m_nodes.size() || m_nodes[id.index].generation != id.generation ||
+            m_nodes[id.index].slot == kNone) {
+            return false;
+        }
+        unlink(id.index);
+        m_nodes[id.index].callback = Task();
+        release(id.index);
+        --m_pending;
+        return true;
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pending;
+    }
+
+    Clock::duration tick() const { return m_tick; }
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFF;
+
+    struct Node {
+        Task callback;
+        uint64_t deadline = 0;          // in ticks since m_origin
+        uint32_t prev = kNone;
+        uint32_t next = kNone;          // also the free-list link
+        uint32_t slot = kNone;          // level * kSlots + slot while linked
+        uint32_t generation = 0;
+    };
+
+    uint64_t current_tick() const {
+        return static_cast<uint64_t>((Clock::now() - m_origin) / m_tick);
+    }
+
+    uint32_t allocate() {
+        if (m_free != kNone) {
+            const uint32_t index = m_free;
+            m_free = m_nodes[index].next;
+            return index;
+        }
+        m_nodes.emplace_back();
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    void release(uint32_t index) {
+        Node& node = m_nodes[index];
+        ++node.generation;
+        node.slot = kNone;
+        node.next = m_free;
+        m_free = index;
+    }
+
+    // Files the node under its deadline, relative to `next`, the next tick to process
+    void link(uint32_t index, uint64_t next) {
+        Node& node = m_nodes[index];
+        const uint64_t deadline = std::max(node.deadline, next);
+        const uint64_t delta = deadline - next;
+        size_t level = 0;
+        while (level + 1 < kLevels && delta >= (uint64_t{1} << (kSlotBits * (level + 1)))) {
+            ++level;
+        }
+        // Past the last level's reach: park at its far end and re-file on cascade
+        const uint64_t reach = uint64_t{1} << (kSlotBits * kLevels);
+        const uint64_t filed = delta < reach ? deadline : next + reach - 1;
+        const uint32_t slot = static_cast<uint32_t>(level * kSlots + ((filed >> (kSlotBits * level)) & (kSlots - 1)));
+
+        node.slot = slot;
+        node.prev = kNone;
+        node.next = m_heads[slot];
+        if (node.next != kNone) {
+            m_nodes[node.next].prev = index;
+        }
+        m_heads[slot] = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = m_nodes[index];
+        if (node.prev != kNone) {
+            m_nodes[node.prev].next = node.next;
+        } else {
+            m_heads[node.slot] = node.next;
+        }
+        if (node.next != kNone) {
+            m_nodes[node.next].prev = node.prev;
+        }
+    }
+
+    // Detaches a slot's list and re-files every node relative to tick
+    void cascade(uint32_t slot, uint64_t tick) {
+        uint32_t index = std::exchange(m_heads[slot], kNone);
+        while (index != kNone) {
+            const uint32_t next = m_nodes[index].next;
+            link(index, tick);
+            index = next;
+        }
+    }
+
+    // Processes tick m_now + 1, moving its callbacks to `due`
+    void advance(std::vector<Task>& due) {
+        const uint64_t tick = m_now + 1;
+        // On a multiple of 256 (65536, ...) the next slot of level 1 (2, ...)
+        // moves down; timers due at `tick` itself land in the slot fired below
+        for (size_t level = 1; level < kLevels; ++level) {
+            if ((tick & ((uint64_t{1} << (kSlotBits * level)) - 1)) != 0) {
+                break;
+            }
+            cascade(static_cast<uint32_t>(level * kSlots + ((tick >> (kSlotBits * level)) & (kSlots - 1))), tick);
+        }
+        m_now = tick;
+        uint32_t index = std::exchange(m_heads[tick & (kSlots - 1)], kNone);
+        while (index != kNone) {
+            Node& node = m_nodes[index];
+            const uint32_t next = node.next;
+            due.push_back(std::move(node.callback));
+            node.callback = Task();
+            release(index);
+            --m_pending;
+            index = next;
+        }
+    }
+
+    void drive(std::stop_token stop) {
+        std::vector<Task> due;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!stop.stop_requested()) {
+            if (m_pending == 0) {
+                m_cv.wait(lock, [&] { return m_pending > 0 || stop.stop_requested(); });
+                continue;
+            }
+            const uint64_t target = current_tick();
+            while (m_now < target && m_pending > 0) {
+                advance(due);
+            }
+            if (!due.empty()) {
+                lock.unlock();
+                m_pool.enqueue_bulk(due);
+                due.clear();
+                lock.lock();
+                continue;
+            }
+            m_cv.wait_until(lock, m_origin + (m_now + 1) * m_tick);
+        }
+    }
+
+    ThreadPoolRAII& m_pool;
+    const Clock::duration m_tick;
+    const Clock::time_point m_origin;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::array<uint32_t, kLevels * kSlots> m_heads;
+    std::vector<Node> m_nodes;
+    uint32_t m_free = kNone;
+    uint64_t m_now = 0;                 // last tick processed
+    size_t m_pending = 0;
+
+    std::jthread m_driver;              // last: stopped and joined first
+};
@@ -0,0 +1,174 @@
+// g++ -std=c++20 -O2 -pthread timer_wheel_demo.cpp -o app
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "timer_wheel.hpp"
+
+using Clock = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+// ============================================================================
+// Baseline: timers in an ordered set under a mutex, O(log n) schedule/cancel
+// ============================================================================
+class OrderedTimers {
+public:
+    using Key = std::pair<Clock::time_point, uint64_t>;
+
+    Key schedule_after(Clock::duration delay) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Key key{Clock::now() + delay, m_next++};
+        m_timers.insert(key);
+        return key;
+    }
+
+    bool cancel(const Key& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_timers.erase(key) > 0;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::set<Key> m_timers;
+    uint64_t m_next = 0;
+};
+
+double ns_since(Clock::time_point start, size_t ops) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(ops);
+}
+
+// ============================================================================
+// 1. EXPIRY: 100k timers over one second, half of them cancelled
+// ============================================================================
+void demonstrateExpiry(ThreadPoolRAII& pool) {
+    std::cout << "\n=== 100k TIMERS, 1..1000 ms, HALF CANCELLED ===\n";
+    constexpr int kTimers = 100'000;
+    TimerWheel wheel(pool);
+
+    std::vector<Clock::time_point> deadlines(kTimers);
+    std::vector<int64_t> lateness_us(kTimers, -1);
+    std::vector<TimerWheel::TimerId> ids(kTimers);
+    std::atomic<int> fired{0};
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> delay_ms(1, 1000);
+
+    for (int i = 0; i < kTimers; ++i) {
+        deadlines[i] = Clock::now() + std::chrono::milliseconds(delay_ms(rng));
+        ids[i] = wheel.schedule_at(deadlines[i], [i, &deadlines, &lateness_us, &fired] {
+            lateness_us[i] = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - deadlines[i]).count();
+            fired.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    // Cancel every even timer; the shortest may have fired already
+    std::vector<bool> cancelled_ok(kTimers, false);
+    int cancelled = 0;
+    for (int i = 0; i < kTimers; i += 2) {
+        cancelled_ok[i] = wheel.cancel(ids[i]);
+        cancelled += cancelled_ok[i];
+    }
+    std::cout << "scheduled " << kTimers << ", cancelled " << cancelled << ", pending " << wheel.pending() << "\n";
+
+    while (wheel.pending() > 0) {
+        std::this_thread::sleep_for(10ms);
+    }
+    std::this_thread::sleep_for(20ms);       // let the last batch run on the pool
+
+    std::vector<int64_t> late;
+    int early = 0;
+    int wrongly_fired = 0;
+    for (int i = 0; i < kTimers; ++i) {
+        if (cancelled_ok[i]) {
+            wrongly_fired += lateness_us[i] >= 0;
+        } else if (lateness_us[i] < 0) {
+            ++early;
+        } else {
+            late.push_back(lateness_us[i]);
+        }
+    }
+    std::sort(late.begin(), late.end());
+    std::cout << "fired " << fired << " (after a successful cancel: " << wrongly_fired
+              << ", early or never: " << early << ")\n";
+    if (!late.empty()) {
+        std::cout << "lateness: median " << late[late.size() / 2] << " us, p99 " << late[late.size() * 99 / 100]
+                  << " us, max " << late.back() << " us (tick 1 ms)\n";
+    }
+}
+
+// ============================================================================
+// 2. SCHEDULE / CANCEL COST WITH 500k TIMERS OUTSTANDING
+// ============================================================================
+void benchmarkScheduleCancel(ThreadPoolRAII& pool) {
+    std::cout << "\n=== SCHEDULE + CANCEL, 500k OUTSTANDING ===\n";
+    constexpr size_t kLive = 500'000;
+    constexpr size_t kChurn = 1'000'000;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> delay_ms(1'000, 60'000);   // request timeouts: 1 s .. 1 min
+
+    {
+        TimerWheel wheel(pool);
+        std::vector<TimerWheel::TimerId> live(kLive);
+        auto start = Clock::now();
+        for (auto& id : live) {
+            id = wheel.schedule_after(std::chrono::milliseconds(delay_ms(rng)), [] {});
+        }
+        const double schedule_ns = ns_since(start, kLive);
+
+        // Steady state: a reply arrives (cancel), a new request goes out (schedule)
+        start = Clock::now();
+        for (size_t i = 0; i < kChurn; ++i) {
+            auto& id = live[i % kLive];
+            wheel.cancel(id);
+            id = wheel.schedule_after(std::chrono::milliseconds(delay_ms(rng)), [] {});
+        }
+        const double churn_ns = ns_since(start, kChurn);
+        std::cout << "TimerWheel:     schedule " << schedule_ns << " ns, cancel + schedule " << churn_ns << " ns\n";
+    }
+    {
+        OrderedTimers timers;
+        std::vector<OrderedTimers::Key> live(kLive);
+        auto start = Clock::now();
+        for (auto& key : live) {
+            key = timers.schedule_after(std::chrono::milliseconds(delay_ms(rng)));
+        }
+        const double schedule_ns = ns_since(start, kLive);
+
+        start = Clock::now();
+        for (size_t i = 0; i < kChurn; ++i) {
+            auto& key = live[i % kLive];
+            timers.cancel(key);
+            key = timers.schedule_after(std::chrono::milliseconds(delay_ms(rng)));
+        }
+        const double churn_ns = ns_since(start, kChurn);
+        std::cout << "std::set+mutex: schedule " << schedule_ns << " ns, cancel + schedule " << churn_ns << " ns\n";
+    }
+}
+
+// ============================================================================
+// 3. FAR DEADLINES AND STALE IDS
+// ============================================================================
+void demonstrateEdgeCases(ThreadPoolRAII& pool) {
+    std::cout << "\n=== FAR DEADLINES, STALE IDS ===\n";
+    TimerWheel wheel(pool, 100us);          // 100 us ticks: levels reach 2^32 * 100 us = 5 days
+    auto far = wheel.schedule_after(std::chrono::hours(24 * 365), [] { std::cout << "never\n"; });
+    std::cout << "one-year timer pending: " << wheel.pending() << ", cancel: " << std::boolalpha
+              << wheel.cancel(far) << ", cancel again: " << wheel.cancel(far) << "\n";
+
+    std::atomic<bool> ran{false};
+    auto soon = wheel.schedule_after(2ms, [&ran] { ran = true; });
+    std::this_thread::sleep_for(20ms);
+    std::cout << "2 ms timer ran: " << ran << ", cancel after it fired: " << wheel.cancel(soon) << "\n";
+}
+
+int main() {
+    ThreadPoolRAII pool(4);
+    demonstrateExpiry(pool);
+    benchmarkScheduleCancel(pool);
+    demonstrateEdgeCases(pool);
+    return 0;
+}
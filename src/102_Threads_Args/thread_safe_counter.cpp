@@ -9,24 +9,151 @@ g++ -pthread thread_safe_counter.cpp -o app
 #include <vector>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <cstdint>
 
-class ThreadSafeCounter {
+#include "../profiled_mutex.hpp"
+
+// Mutex is std::mutex, or ProfiledMutex (../profiled_mutex.hpp) to see
+// how contended the counter is
+template<typename Mutex = std::mutex>
+class BasicThreadSafeCounter {
     int value;
-    std::mutex mtx;
+    Mutex mtx = mutex_profile::make_mutex<Mutex>("ThreadSafeCounter");
 public:
-    ThreadSafeCounter(int initial = 0) : value(initial) {}
+    BasicThreadSafeCounter(int initial = 0) : value(initial) {}
     
     void increment(int amount) {
-        std::lock_guard<std::mutex> lock(mtx);
+        std::lock_guard<Mutex> lock(mtx);
         value += amount;
     }
     
     int get() {
-        std::lock_guard<std::mutex> lock(mtx);
+        std::lock_guard<Mutex> lock(mtx);
         return value;
     }
 };
 
+using ThreadSafeCounter = BasicThreadSafeCounter<>;
+
+// Single shared atomic: no lock, but every increment still pulls the same
+// cache line into the incrementing core exclusively, so cores take turns
+class AtomicCounter {
+    std::atomic<int64_t> value;
+public:
+    AtomicCounter(int64_t initial = 0) : value(initial) {}
+    
+    void increment(int amount) {
+        value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    
+    int64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+// Sharded counter for hot paths (request counters hit millions of times a
+// second). Each thread increments its own cache-line-sized shard, so
+// increments on different cores never touch the same line; get() pays
+// instead, summing every shard.
+//
+// Threads are assigned shards round robin on first use. With at least as
+// many shards as cores, threads that run at the same time rarely share one,
+// and when they do the relaxed fetch_add keeps the count exact.
+class ShardedCounter {
+    struct alignas(64) Shard {
+        std::atomic<int64_t> value{0};
+    };
+    
+    std::unique_ptr<Shard[]> shards;
+    size_t mask;
+    
+    // Approximate reads: last sum and when it was taken (steady_clock ns)
+    alignas(64) std::atomic<int64_t> cached_sum{0};
+    std::atomic<int64_t> cached_at{INT64_MIN / 2};
+    
+    static size_t round_up_pow2(size_t n) {
+        size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+    
+    static size_t thread_index() {
+        static std::atomic<size_t> next{0};
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+    
+public:
+    // Shard count is rounded up to a power of two; the default gives one
+    // per hardware thread
+    explicit ShardedCounter(int64_t initial = 0, size_t shard_count = std::thread::hardware_concurrency())
+        : shards(new Shard[round_up_pow2(shard_count ? shard_count : 1)]),
+          mask(round_up_pow2(shard_count ? shard_count : 1) - 1) {
+        shards[0].value.store(initial, std::memory_order_relaxed);
+    }
+    
+    void increment(int amount) {
+        shards[thread_index() & mask].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+    
+    // Exact once writers have stopped (e.g. after join); while they run, a
+    // sum of relaxed loads that may miss increments still in flight
+    int64_t get() const {
+        int64_t sum = 0;
+        for (size_t i = 0; i <= mask; ++i) {
+            sum += shards[i].value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+    
+    // For dashboards that tolerate staleness: returns a sum at most
+    // max_staleness old. Only one caller per interval walks the shards (and
+    // pulls their cache lines away from the writers); the rest read the cache.
+    int64_t get_approx(std::chrono::nanoseconds max_staleness = std::chrono::milliseconds(1)) {
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t taken = cached_at.load(std::memory_order_acquire);
+        if (now - taken >= max_staleness.count() &&
+            cached_at.compare_exchange_strong(taken, now, std::memory_order_acq_rel)) {
+            const int64_t sum = get();
+            cached_sum.store(sum, std::memory_order_release);
+            return sum;
+        }
+        return cached_sum.load(std::memory_order_acquire);
+    }
+    
+    size_t shard_count() const { return mask + 1; }
+};
+
+// Scaling benchmark: n threads hammering increment(1), millions of
+// increments per second across all threads
+template<typename Counter>
+double increments_mops(int n, int per_thread) {
+    Counter counter(0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; ++i) {
+        threads.emplace_back([&counter, per_thread] {
+            for (int j = 0; j < per_thread; ++j) {
+                counter.increment(1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (counter.get() != static_cast<int64_t>(n) * per_thread) {
+        std::cout << "count mismatch!" << std::endl;
+    }
+    return n * static_cast<double>(per_thread) / seconds / 1e6;
+}
+
 // Pass by value - receives a copy
 void worker_copy(int id, std::string name) {
     std::cout << "Worker " << id << " (" << name << ") starting" << std::endl;
@@ -71,5 +198,50 @@ int main() {
     std::thread t2(worker_move, 2, std::move(vec));
     t2.join();
     
+    // Example 4: Sharded counter with a stale-tolerant reader
+    ShardedCounter requests;
+    std::atomic<bool> done{false};
+    std::thread dashboard([&requests, &done] {
+        int refreshes = 0;
+        while (!done.load()) {
+            requests.get_approx(std::chrono::milliseconds(5));
+            ++refreshes;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::cout << "Dashboard polled " << refreshes << " times" << std::endl;
+    });
+    threads.clear();
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&requests] {
+            for (int j = 0; j < 1000000; ++j) {
+                requests.increment(1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    done = true;
+    dashboard.join();
+    std::cout << "Sharded counter (" << requests.shard_count() << " shards): " << requests.get() << std::endl;
+    
+    // Scaling: mutex vs single atomic vs sharded
+    std::cout << "\nincrements (M/s)\n" << std::setw(8) << "threads" << std::setw(10) << "mutex"
+              << std::setw(10) << "atomic" << std::setw(10) << "sharded" << "\n";
+    for (int n : {1, 2, 4, 8}) {
+        const int per_thread = 2000000;
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(1)
+                  << std::setw(10) << increments_mops<ThreadSafeCounter>(n, per_thread)
+                  << std::setw(10) << increments_mops<AtomicCounter>(n, per_thread)
+                  << std::setw(10) << increments_mops<ShardedCounter>(n, per_thread) << "\n";
+    }
+
+    // Where the mutex version loses its time: the same run on a ProfiledMutex
+    mutex_profile::set_enabled(true);
+    const double profiled = increments_mops<BasicThreadSafeCounter<ProfiledMutex>>(4, 2000000);
+    mutex_profile::set_enabled(false);
+    std::cout << "\n4 threads on a ProfiledMutex: " << profiled << " M/s\n";
+    mutex_profile::collect().print(std::cout, 3);
+    
     return 0;
 }
\ No newline at end of file
@@ -8,21 +8,34 @@ g++ -pthread --std=c++20 thread_safe_queue.cpp -o app
 #include <thread>
 #include <chrono>
 #include <optional>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <vector>
+#include <iomanip>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <stop_token>
 
-template<typename T>
+#include "../profiled_mutex.hpp"
+
+// Mutex is std::mutex, or ProfiledMutex (../profiled_mutex.hpp) to see
+// how contended the queue is
+template<typename T, typename Mutex = std::mutex>
 class ThreadSafeQueue {
 private:
     std::queue<T> queue;
-    mutable std::mutex mtx;
+    mutable Mutex mtx = mutex_profile::make_mutex<Mutex>("ThreadSafeQueue");
 
 public:
     void push(T value) {
-        std::lock_guard<std::mutex> lock(mtx);
+        std::lock_guard<Mutex> lock(mtx);
         queue.push(std::move(value));
     }
     
     std::optional<T> pop() {
-        std::lock_guard<std::mutex> lock(mtx);
+        std::lock_guard<Mutex> lock(mtx);
         if (queue.empty()) {
             return std::nullopt;
         }
@@ -30,18 +43,437 @@ public:
         queue.pop();
         return value;
     }
+
+    // Takes everything queued in one lock acquisition: the underlying
+    // container is swapped out, so the critical section is O(1) regardless
+    // of how many items are waiting. The caller processes them lock-free.
+    std::queue<T> pop_all() {
+        std::queue<T> drained;
+        std::lock_guard<Mutex> lock(mtx);
+        drained.swap(queue);
+        return drained;
+    }
+
+    // Moves up to n items into the caller's buffer (any output iterator,
+    // e.g. a T* or std::back_inserter) under one lock acquisition.
+    // Returns how many were written; 0 means the queue was empty.
+    template<typename OutputIt>
+    size_t pop_n(OutputIt out, size_t n) {
+        std::lock_guard<Mutex> lock(mtx);
+        size_t count = 0;
+        while (count < n && !queue.empty()) {
+            *out++ = std::move(queue.front());
+            queue.pop();
+            ++count;
+        }
+        return count;
+    }
     
     bool empty() const {
-        std::lock_guard<std::mutex> lock(mtx);
+        std::lock_guard<Mutex> lock(mtx);
         return queue.empty();
     }
     
     size_t size() const {
-        std::lock_guard<std::mutex> lock(mtx);
+        std::lock_guard<Mutex> lock(mtx);
         return queue.size();
     }
 };
 
+// Bounded lock-free multi-producer / multi-consumer ring buffer.
+//
+// Every slot carries a "turn" counter. Producers and consumers take tickets
+// from head_ / tail_, and ticket i maps to slot i % capacity in lap
+// i / capacity:
+//   - a producer may write the slot once turn == 2 * lap
+//   - a consumer may read it once turn == 2 * lap + 1
+// Each side bumps turn to hand the slot over, so no two threads ever touch
+// the same slot at the same time and no lock is taken. head_, tail_ and
+// every slot sit on separate cache lines, so producers and consumers do not
+// invalidate each other's lines except on the slot they actually exchange.
+//
+// push() / wait_pop() block (spin briefly, then futex-wait on the slot's turn
+// via C++20 atomic wait); try_push() / pop() never block, so callers can
+// apply their own back-pressure policy.
+template<typename T>
+class MPMCRingQueue {
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    struct alignas(kCacheLine) Slot {
+        std::atomic<size_t> turn{0};
+        std::atomic<uint32_t> waiters{0};   // threads parked on turn
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    size_t capacity_;
+    size_t shift_;                          // log2(capacity_)
+    std::unique_ptr<Slot[]> slots_;
+    alignas(kCacheLine) std::atomic<size_t> head_{0};   // next ticket for producers
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};   // next ticket for consumers
+
+    Slot& slot(size_t ticket) { return slots_[ticket & (capacity_ - 1)]; }
+    size_t lap(size_t ticket) const { return ticket >> shift_; }
+
+    // Spin, then yield, then park. The waiters count lets publish() skip the
+    // notify syscall in the common case where nobody is parked; both sides
+    // use seq_cst so either the waiter sees the new turn or publish() sees
+    // the waiter.
+    static void wait_for_turn(Slot& s, size_t wanted) {
+        for (int spin = 0; spin < 64; ++spin) {
+            if (s.turn.load(std::memory_order_acquire) == wanted) {
+                return;
+            }
+        }
+        for (int round = 0; round < 16; ++round) {
+            std::this_thread::yield();
+            if (s.turn.load(std::memory_order_acquire) == wanted) {
+                return;
+            }
+        }
+        s.waiters.fetch_add(1);
+        for (size_t seen = s.turn.load(); seen != wanted; seen = s.turn.load()) {
+            s.turn.wait(seen);
+        }
+        s.waiters.fetch_sub(1);
+    }
+
+    static void publish(Slot& s, size_t turn) {
+        s.turn.store(turn);
+        if (s.waiters.load() > 0) {
+            s.turn.notify_all();
+        }
+    }
+
+public:
+    // Capacity is rounded up to a power of two so slot lookup is a mask
+    explicit MPMCRingQueue(size_t capacity)
+        : capacity_(std::bit_ceil(std::max<size_t>(capacity, 2))),
+          shift_(static_cast<size_t>(std::countr_zero(capacity_))),
+          slots_(new Slot[capacity_]) {}
+
+    MPMCRingQueue(const MPMCRingQueue&) = delete;
+    MPMCRingQueue& operator=(const MPMCRingQueue&) = delete;
+
+    ~MPMCRingQueue() {
+        while (pop()) {
+        }
+    }
+
+    // Blocks while the queue is full
+    void push(T value) {
+        const size_t ticket = head_.fetch_add(1, std::memory_order_acq_rel);
+        Slot& s = slot(ticket);
+        wait_for_turn(s, 2 * lap(ticket));
+        ::new (static_cast<void*>(s.storage)) T(std::move(value));
+        publish(s, 2 * lap(ticket) + 1);
+    }
+
+    // Returns false instead of blocking when the queue is full
+    bool try_push(T value) {
+        size_t ticket = head_.load(std::memory_order_acquire);
+        while (true) {
+            Slot& s = slot(ticket);
+            if (s.turn.load(std::memory_order_acquire) == 2 * lap(ticket)) {
+                if (head_.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acq_rel)) {
+                    ::new (static_cast<void*>(s.storage)) T(std::move(value));
+                    publish(s, 2 * lap(ticket) + 1);
+                    return true;
+                }
+                // CAS failure reloaded ticket; retry with it
+            } else {
+                const size_t previous = ticket;
+                ticket = head_.load(std::memory_order_acquire);
+                if (ticket == previous) {
+                    return false;   // slot still occupied from the last lap: full
+                }
+            }
+        }
+    }
+
+    // Same surface as ThreadSafeQueue::pop(): never blocks
+    std::optional<T> pop() {
+        size_t ticket = tail_.load(std::memory_order_acquire);
+        while (true) {
+            Slot& s = slot(ticket);
+            if (s.turn.load(std::memory_order_acquire) == 2 * lap(ticket) + 1) {
+                if (tail_.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acq_rel)) {
+                    std::optional<T> result(std::move(*s.value()));
+                    s.value()->~T();
+                    publish(s, 2 * lap(ticket) + 2);
+                    return result;
+                }
+            } else {
+                const size_t previous = ticket;
+                ticket = tail_.load(std::memory_order_acquire);
+                if (ticket == previous) {
+                    return std::nullopt;   // nothing published yet: empty
+                }
+            }
+        }
+    }
+
+    // Blocks until an item is available
+    T wait_pop() {
+        const size_t ticket = tail_.fetch_add(1, std::memory_order_acq_rel);
+        Slot& s = slot(ticket);
+        wait_for_turn(s, 2 * lap(ticket) + 1);
+        T result(std::move(*s.value()));
+        s.value()->~T();
+        publish(s, 2 * lap(ticket) + 2);
+        return result;
+    }
+
+    // Approximate while other threads are active; negative while consumers
+    // are blocked in wait_pop() ahead of producers, which is reported as 0
+    size_t size() const {
+        const auto head = static_cast<std::ptrdiff_t>(head_.load(std::memory_order_relaxed));
+        const auto tail = static_cast<std::ptrdiff_t>(tail_.load(std::memory_order_relaxed));
+        return head > tail ? static_cast<size_t>(head - tail) : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    size_t capacity() const { return capacity_; }
+};
+
+// Fixed-capacity single-producer / single-consumer ring.
+//
+// With exactly one thread on each side no CAS is needed: the producer alone
+// writes head_, the consumer alone writes tail_, so try_push / try_pop finish
+// in a bounded number of steps (wait-free). Each side also keeps a private
+// copy of the other side's index and only re-reads the shared one when that
+// copy says the ring looks full (producer) or empty (consumer), so in steady
+// state each operation touches only its own cache line.
+//
+// Slots hold live T objects (T must be default-constructible), which allows
+// the zero-copy API: reserve() hands out the next free slot, the producer
+// fills it in place, commit() publishes it; front() / release() mirror that
+// on the consumer side.
+//
+// wait_push / wait_pop block with a stop_token, so the ring drops straight
+// into the jthread consumer pattern of 157_jthread/jthread.cpp.
+template<typename T>
+class SpscRing {
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    // Producer-owned line
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+    std::atomic<uint32_t> producer_epoch_{0};
+    std::atomic<bool> producer_parked_{false};
+
+    // Consumer-owned line
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+    std::atomic<uint32_t> consumer_epoch_{0};
+    std::atomic<bool> consumer_parked_{false};
+
+    alignas(kCacheLine) size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    // Wakes the other side only if it announced that it is about to sleep.
+    // The fence orders the caller's index store (release only) before the
+    // parked load; it pairs with the fence in park_until()
+    static void wake(std::atomic<uint32_t>& epoch, std::atomic<bool>& parked) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load()) {
+            epoch.fetch_add(1);
+            epoch.notify_one();
+        }
+    }
+
+    // Spins, then publishes "parked" and sleeps on the epoch until the other
+    // side (or a stop request) bumps it. Each side stores (parked / its
+    // index), issues a seq_cst fence, then loads the other's variable - so
+    // either we see the new index or they see us parked. The fences are
+    // needed: ready() and the index stores are only acquire / release, and
+    // a store followed by a load of another variable may be reordered.
+    template<typename Ready>
+    static bool park_until(Ready ready, std::atomic<uint32_t>& epoch, std::atomic<bool>& parked,
+                           std::stop_token& st) {
+        for (int spin = 0; spin < 128; ++spin) {
+            if (ready()) {
+                return true;
+            }
+        }
+        for (int round = 0; round < 16; ++round) {
+            std::this_thread::yield();
+            if (ready()) {
+                return true;
+            }
+        }
+        std::stop_callback on_stop(st, [&epoch] {
+            epoch.fetch_add(1);
+            epoch.notify_one();
+        });
+        while (!ready()) {
+            if (st.stop_requested()) {
+                return false;
+            }
+            const uint32_t seen = epoch.load();
+            parked.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!ready() && !st.stop_requested()) {
+                epoch.wait(seen);
+            }
+            parked.store(false);
+        }
+        return true;
+    }
+
+    bool has_space() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ <= mask_) {
+            return true;
+        }
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        return head - cached_tail_ <= mask_;
+    }
+
+    bool has_item() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail != cached_head_) {
+            return true;
+        }
+        cached_head_ = head_.load(std::memory_order_acquire);
+        return tail != cached_head_;
+    }
+
+public:
+    explicit SpscRing(size_t capacity)
+        : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+          slots_(new T[mask_ + 1]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // ---- producer side ----
+
+    // Next free slot to fill in place, or nullptr when full
+    T* reserve() {
+        if (!has_space()) {
+            return nullptr;
+        }
+        return &slots_[head_.load(std::memory_order_relaxed) & mask_];
+    }
+
+    // Publishes the slot returned by the last reserve()
+    void commit() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1);
+        wake(consumer_epoch_, consumer_parked_);
+    }
+
+    bool try_push(T value) {
+        T* slot = reserve();
+        if (!slot) {
+            return false;
+        }
+        *slot = std::move(value);
+        commit();
+        return true;
+    }
+
+    // Blocks while full; returns false if stop was requested first
+    bool wait_push(T value, std::stop_token st = {}) {
+        if (!park_until([this] { return has_space(); }, producer_epoch_, producer_parked_, st)) {
+            return false;
+        }
+        return try_push(std::move(value));
+    }
+
+    // ---- consumer side ----
+
+    // Oldest committed item, read in place, or nullptr when empty
+    T* front() {
+        if (!has_item()) {
+            return nullptr;
+        }
+        return &slots_[tail_.load(std::memory_order_relaxed) & mask_];
+    }
+
+    // Hands the slot returned by front() back to the producer
+    void release() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1);
+        wake(producer_epoch_, producer_parked_);
+    }
+
+    std::optional<T> try_pop() {
+        T* slot = front();
+        if (!slot) {
+            return std::nullopt;
+        }
+        std::optional<T> value(std::move(*slot));
+        release();
+        return value;
+    }
+
+    // Blocks while empty. Items already committed are still returned after a
+    // stop request; nullopt means "stopped and drained".
+    std::optional<T> wait_pop(std::stop_token st = {}) {
+        if (!park_until([this] { return has_item(); }, consumer_epoch_, consumer_parked_, st)) {
+            return std::nullopt;
+        }
+        return try_pop();
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+};
+
+// Items per second through a queue with `pairs` producers and `pairs`
+// consumers. The mutex queue has no blocking pop, so its consumers poll and
+// yield on empty, which is how the example in main() uses it.
+template<typename Queue, typename Pop>
+double pairs_throughput(Queue& queue, int pairs, int items_per_producer, Pop pop) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < pairs; ++p) {
+        threads.emplace_back([&queue, items_per_producer] {
+            for (int i = 0; i < items_per_producer; ++i) {
+                queue.push(i);
+            }
+        });
+        threads.emplace_back([&queue, items_per_producer, pop] {
+            for (int i = 0; i < items_per_producer; ++i) {
+                pop(queue);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(stop - start).count();
+    return pairs * static_cast<double>(items_per_producer) / seconds;
+}
+
+// std::mutex that counts its acquisitions, so the drain comparison in main()
+// reports measured lock counts. One counter for all instances; read it
+// while a single thread uses the queue.
+class CountingMutex {
+public:
+    void lock() {
+        m_.lock();
+        ++acquisitions;
+    }
+    bool try_lock() {
+        if (!m_.try_lock()) {
+            return false;
+        }
+        ++acquisitions;
+        return true;
+    }
+    void unlock() { m_.unlock(); }
+
+    static inline size_t acquisitions = 0;
+
+private:
+    std::mutex m_;
+};
+
 int main() {
     ThreadSafeQueue<int> queue;
     
@@ -70,6 +502,134 @@ int main() {
     
     producer.join();
     consumer.join();
+
+    // Batch draining: 10'000 queued log lines, counted in lock acquisitions
+    {
+        const int lines = 10000;
+        ThreadSafeQueue<int, CountingMutex> log_queue;
+        auto locks_to_drain = [&](auto drain) {
+            for (int i = 0; i < lines; ++i) {
+                log_queue.push(i);
+            }
+            const size_t before = CountingMutex::acquisitions;
+            drain();
+            return CountingMutex::acquisitions - before;
+        };
+
+        const size_t locks_pop = locks_to_drain([&] {
+            while (log_queue.pop()) {
+            }
+        });
+        const size_t locks_pop_n = locks_to_drain([&] {
+            int buffer[256];
+            while (log_queue.pop_n(buffer, std::size(buffer)) > 0) {
+            }
+        });
+        size_t got = 0;
+        const size_t locks_pop_all = locks_to_drain([&] { got = log_queue.pop_all().size(); });
+        std::cout << "Draining " << lines << " items: pop() takes " << locks_pop
+                  << " locks, pop_n(256) takes " << locks_pop_n << ", pop_all() takes " << locks_pop_all
+                  << " (got " << got << ")\n";
+    }
+
+    // Back-pressure with the bounded ring: try_push fails once 4 items wait
+    MPMCRingQueue<int> ring(4);
+    int accepted = 0;
+    for (int i = 0; i < 6; ++i) {
+        accepted += ring.try_push(i) ? 1 : 0;
+    }
+    std::cout << "Ring of capacity " << ring.capacity() << " accepted " << accepted << " of 6 items\n";
+    std::thread ring_consumer([&ring] {
+        for (int i = 0; i < 4; ++i) {
+            std::cout << "wait_pop: " << ring.wait_pop() << std::endl;
+        }
+    });
+    ring_consumer.join();
+
+    // SPSC ring in the jthread consumer pattern: the producer builds readings
+    // in place with reserve()/commit(), the consumer drains until stopped
+    {
+        struct Reading {
+            int sensor = 0;
+            double values[4] = {};
+        };
+        SpscRing<Reading> readings(8);
+        std::jthread sink([&readings](std::stop_token st) {
+            double total = 0.0;
+            int count = 0;
+            while (auto r = readings.wait_pop(st)) {
+                total += r->values[0];
+                ++count;
+            }
+            std::cout << "SPSC consumer drained " << count << " readings, sum " << total << std::endl;
+        });
+
+        for (int i = 0; i < 100; ++i) {
+            Reading* slot;
+            while ((slot = readings.reserve()) == nullptr) {
+                std::this_thread::yield();   // full: back off
+            }
+            slot->sensor = i % 4;
+            slot->values[0] = i;
+            readings.commit();
+        }
+        sink.request_stop();   // items already committed are still drained
+    }
+
+    // One producer, one consumer: the three queues side by side
+    {
+        const int items = 1000000;
+        SpscRing<int> spsc(1024);
+        auto start = std::chrono::steady_clock::now();
+        std::jthread consumer([&spsc, items] {
+            for (int i = 0; i < items; ++i) {
+                spsc.wait_pop();
+            }
+        });
+        for (int i = 0; i < items; ++i) {
+            spsc.wait_push(i);
+        }
+        consumer.join();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "\nSPSC ring, 1 producer / 1 consumer: " << std::fixed << std::setprecision(2)
+                  << items / seconds / 1e6 << " million items/s\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+
+    // Throughput: ThreadSafeQueue (one mutex) vs MPMCRingQueue
+    const int items_per_producer = 50000;
+    std::cout << "\nThroughput (million items/s), " << items_per_producer << " items per producer\n";
+    std::cout << std::setw(8) << "pairs" << std::setw(14) << "mutex queue" << std::setw(14) << "mpmc ring" << "\n";
+    for (int pairs : {1, 2, 4, 8, 16}) {
+        ThreadSafeQueue<int> locked;
+        double locked_rate = pairs_throughput(locked, pairs, items_per_producer, [](ThreadSafeQueue<int>& q) {
+            while (!q.pop()) {
+                std::this_thread::yield();
+            }
+        });
+
+        MPMCRingQueue<int> lock_free(1024);
+        double ring_rate = pairs_throughput(lock_free, pairs, items_per_producer, [](MPMCRingQueue<int>& q) {
+            q.wait_pop();
+        });
+
+        std::cout << std::setw(8) << pairs << std::fixed << std::setprecision(2)
+                  << std::setw(14) << locked_rate / 1e6
+                  << std::setw(14) << ring_rate / 1e6 << "\n";
+    }
+
+    // The mutex queue again, 4 pairs, on a ProfiledMutex: how often push and
+    // pop find the queue locked, and for how long
+    mutex_profile::set_enabled(true);
+    ThreadSafeQueue<int, ProfiledMutex> profiled;
+    pairs_throughput(profiled, 4, items_per_producer, [](ThreadSafeQueue<int, ProfiledMutex>& q) {
+        while (!q.pop()) {
+            std::this_thread::yield();
+        }
+    });
+    mutex_profile::set_enabled(false);
+    std::cout << "\n";
+    mutex_profile::collect().print(std::cout, 4);
     
     return 0;
 }
\ No newline at end of file
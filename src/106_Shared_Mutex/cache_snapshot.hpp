@@ -0,0 +1,254 @@
+/*
+Binary snapshot of a string -> string cache, looked up in place from a
+memory-mapped file (header-only, just #include it; POSIX).
+Used by reader_writer_pattern.cpp (BasicThreadSafeCache::save() / load()).
+
+A restarted cache is empty and refills at the speed of its backends.
+Reading a saved copy back entry by entry (parse, allocate, insert) still
+costs seconds for millions of entries. A snapshot is laid out so that
+it needs no parsing at all: map the file and look keys up in it straight
+away, the OS faulting in only the pages that are actually touched.
+
+    cache_snapshot::Writer w;
+    w.add("key", "value");                       // any number of entries
+    w.write("cache.snap");                       // via cache.snap.tmp + rename
+
+    cache_snapshot::Mapped snap("cache.snap");   // mmap + header checks only
+    std::optional<std::string_view> v = snap.find("key");
+
+File layout (host byte order; the header records it, and a file written
+on a machine with the other byte order is rejected):
+
+    header   magic "TSCSNAP1", version, byte-order mark, entry count,
+             bucket count, index offset, file size          (48 bytes)
+    records  [u32 key length][u32 value length][key][value], back to back
+    index    bucket count (a power of two, >= 2 x entries) slots of
+             {u64 FNV-1a hash of the key, u64 record offset}; offset 0 is
+             an empty slot. Linear probing.
+
+FNV-1a rather than std::hash: the index must hash the same way in the
+process that reads it as in the one that wrote it. Every record access is
+bounds-checked against the index offset, so a corrupt file can yield wrong
+values but never a read outside the mapping.
+*/
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "../mapped_file.hpp"
+
+namespace cache_snapshot {
+
+inline constexpr char kMagic[8] = {'T', 'S', 'C', 'S', 'N', 'A', 'P', '1'};
+inline constexpr uint32_t kVersion = 1;
+inline constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t entries;
+    uint64_t buckets;
+    uint64_t index_offset;
+    uint64_t file_size;
+};
+static_assert(sizeof(Header) == 48);
+
+struct Bucket {
+    uint64_t hash;
+    uint64_t offset;    // of the record; 0 = empty
+};
+
+inline uint64_t hash_key(std::string_view key) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (unsigned char c : key) {
+        h = (h ^ c) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+// Collects entries in memory; write() lays them out and builds the index
+class Writer {
+public:
+    Writer() { m_records.resize(sizeof(Header)); }
+
+    void add(std::string_view key, std::string_view value) {
+        if (key.size() > UINT32_MAX || value.size() > UINT32_MAX) {
+            throw std::length_error("cache_snapshot: key or value over 4 GiB");
+        }
+        m_offsets.push_back(m_records.size());
+        const uint32_t lengths[2] = {static_cast<uint32_t>(key.size()), static_cast<uint32_t>(value.size())};
+        m_records.append(reinterpret_cast<const char*>(lengths), sizeof(lengths));
+        m_records.append(key);
+        m_records.append(value);
+    }
+
+    size_t size() const { return m_offsets.size(); }
+
+    // Writes path + ".tmp" and renames it over path, so a reader (or a
+    // crash) never sees a half-written snapshot. Returns the file size.
+    size_t write(const std::string& path) {
+        const uint64_t buckets = std::bit_ceil(std::max<uint64_t>(2 * m_offsets.size(), 16));
+        std::vector<Bucket> index(buckets, Bucket{0, 0});
+        for (uint64_t offset : m_offsets) {
+            uint32_t key_length;
+            std::memcpy(&key_length, m_records.data() + offset, sizeof(key_length));
+            const uint64_t h = hash_key({m_records.data() + offset + 8, key_length});
+            uint64_t slot = h & (buckets - 1);
+            while (index[slot].offset != 0) {
+                slot = (slot + 1) & (buckets - 1);
+            }
+            index[slot] = Bucket{h, offset};
+        }
+
+        // The index starts 8-aligned, so the mapped Buckets can be read in place
+        const uint64_t index_offset = (m_records.size() + 7) / 8 * 8;
+        Header header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.byte_order = kByteOrderMark;
+        header.entries = m_offsets.size();
+        header.buckets = buckets;
+        header.index_offset = index_offset;
+        header.file_size = index_offset + buckets * sizeof(Bucket);
+        std::memcpy(m_records.data(), &header, sizeof(header));
+        m_records.resize(index_offset, '\0');
+
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            out.write(m_records.data(), static_cast<std::streamsize>(m_records.size()));
+            out.write(reinterpret_cast<const char*>(index.data()),
+                      static_cast<std::streamsize>(index.size() * sizeof(Bucket)));
+            if (!out.flush()) {
+                throw std::runtime_error("cache_snapshot: cannot write " + tmp);
+            }
+        }
+        if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+            throw std::system_error(errno, std::generic_category(), "rename " + tmp);
+        }
+        return header.file_size;
+    }
+
+private:
+    std::string m_records;              // header placeholder, then the records
+    std::vector<uint64_t> m_offsets;
+};
+
+// Lookups over snapshot bytes (a mapping, or any buffer that outlives it)
+class View {
+public:
+    explicit View(std::span<const std::byte> bytes) : m_data(reinterpret_cast<const char*>(bytes.data())) {
+        if (bytes.size() < sizeof(Header)) {
+            throw std::runtime_error("cache_snapshot: file too short");
+        }
+        std::memcpy(&m_header, m_data, sizeof(Header));
+        if (std::memcmp(m_header.magic, kMagic, sizeof(kMagic)) != 0) {
+            throw std::runtime_error("cache_snapshot: not a snapshot file");
+        }
+        if (m_header.version != kVersion || m_header.byte_order != kByteOrderMark) {
+            throw std::runtime_error("cache_snapshot: unsupported version or byte order");
+        }
+        if (m_header.file_size != bytes.size() || !std::has_single_bit(m_header.buckets) ||
+            m_header.index_offset % 8 != 0 || m_header.index_offset < sizeof(Header) ||
+            m_header.index_offset > bytes.size() ||
+            (bytes.size() - m_header.index_offset) / sizeof(Bucket) != m_header.buckets ||
+            m_header.entries > m_header.buckets) {
+            throw std::runtime_error("cache_snapshot: truncated or inconsistent file");
+        }
+        m_index = reinterpret_cast<const Bucket*>(m_data + m_header.index_offset);
+    }
+
+    size_t size() const { return m_header.entries; }
+
+    std::optional<std::string_view> find(std::string_view key) const {
+        const uint64_t h = hash_key(key);
+        const uint64_t mask = m_header.buckets - 1;
+        for (uint64_t slot = h & mask, probes = 0; probes < m_header.buckets; slot = (slot + 1) & mask, ++probes) {
+            const Bucket& b = m_index[slot];
+            if (b.offset == 0) {
+                return std::nullopt;
+            }
+            if (b.hash == h) {
+                const auto [k, v] = record(b.offset);
+                if (k == key) {
+                    return v;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Calls fn(key, value) for up to `limit` records in file order, starting
+    // at position `from` (0: the first); returns the position to resume
+    // from, or 0 after the last record
+    template<typename F>
+    size_t for_each(F&& fn, size_t from = 0, size_t limit = SIZE_MAX) const {
+        size_t offset = from == 0 ? sizeof(Header) : from;
+        for (size_t n = 0; n < limit; ++n) {
+            if (offset + 8 > m_header.index_offset) {
+                return 0;
+            }
+            const auto [k, v] = record(offset);
+            fn(k, v);
+            offset += 8 + k.size() + v.size();
+        }
+        return offset + 8 > m_header.index_offset ? 0 : offset;
+    }
+
+private:
+    std::pair<std::string_view, std::string_view> record(uint64_t offset) const {
+        const uint64_t end = m_header.index_offset;
+        if (offset < sizeof(Header) || offset + 8 > end) {
+            throw std::runtime_error("cache_snapshot: record offset out of range");
+        }
+        uint32_t lengths[2];
+        std::memcpy(lengths, m_data + offset, sizeof(lengths));
+        if (uint64_t{lengths[0]} + lengths[1] > end - offset - 8) {
+            throw std::runtime_error("cache_snapshot: record overruns the file");
+        }
+        const char* key = m_data + offset + 8;
+        return {{key, lengths[0]}, {key + lengths[0], lengths[1]}};
+    }
+
+    const char* m_data;
+    Header m_header;
+    const Bucket* m_index = nullptr;
+};
+
+// A snapshot file, mapped for random access
+class Mapped {
+public:
+    explicit Mapped(const std::string& path)
+        : m_file(path, MappedFile::Advice::Random), m_view(m_file.bytes()) {}
+
+    size_t size() const { return m_view.size(); }
+    size_t file_size() const { return m_file.size(); }
+    std::optional<std::string_view> find(std::string_view key) const { return m_view.find(key); }
+
+    template<typename F>
+    size_t for_each(F&& fn, size_t from = 0, size_t limit = SIZE_MAX) const {
+        return m_view.for_each(std::forward<F>(fn), from, limit);
+    }
+
+private:
+    MappedFile m_file;
+    View m_view;
+};
+
+} // namespace cache_snapshot
@@ -0,0 +1,131 @@
+/*
+Reader-biased distributed reader-writer lock (header-only, just #include it).
+Used by reader_writer_pattern.cpp (BasicThreadSafeCache<DistributedSharedMutex<>>).
+
+std::shared_mutex keeps its reader count in one word, so every lock_shared()
+and unlock_shared() is an atomic read-modify-write on the same cache line:
+with readers on many cores that line bounces between them on every read,
+and read-only throughput stops growing after a few cores.
+
+DistributedSharedMutex<Slots> splits the reader count over Slots counters,
+one per cache line. Each thread is given a slot on first use (round robin,
+the same slot in every instance), so readers on different threads touch
+different lines and never contend with each other:
+
+    lock_shared():   ++my_slot; if no writer is active, done;
+                     otherwise --my_slot, wait for the writer, retry
+    lock():          take the writer mutex, raise the writer flag, then
+                     wait until every slot has drained to zero
+
+The increment and the flag check on one side, the flag store and the slot
+scan on the other, are sequentially consistent, so either the reader sees
+the flag or the writer sees the reader. A raised flag turns new readers
+away, so a writer cannot be starved by a stream of readers.
+
+Reads get cheaper, writes get dearer: a write scans all Slots lines and
+waits for the readers already inside. Use it for read-mostly data; it
+meets the SharedMutex requirements (lock/try_lock/unlock and the _shared
+versions), so std::shared_lock and std::unique_lock work with it. More
+threads than Slots share counters, which stays correct but brings back some
+contention. Each instance takes Slots * 64 bytes.
+*/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace distributed_shared_mutex_detail {
+
+// Round-robin slot per thread, shared by all instances
+inline size_t thread_slot() {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+} // namespace distributed_shared_mutex_detail
+
+template<size_t Slots = 64>
+class DistributedSharedMutex {
+    static_assert(Slots > 0 && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+
+public:
+    DistributedSharedMutex() = default;
+    DistributedSharedMutex(const DistributedSharedMutex&) = delete;
+    DistributedSharedMutex& operator=(const DistributedSharedMutex&) = delete;
+
+    void lock_shared() {
+        std::atomic<uint32_t>& readers = my_slot();
+        for (;;) {
+            readers.fetch_add(1, std::memory_order_seq_cst);
+            if (!writer_.load(std::memory_order_seq_cst)) {
+                return;
+            }
+            readers.fetch_sub(1, std::memory_order_release);
+            writer_.wait(true, std::memory_order_acquire);
+        }
+    }
+
+    bool try_lock_shared() {
+        std::atomic<uint32_t>& readers = my_slot();
+        readers.fetch_add(1, std::memory_order_seq_cst);
+        if (!writer_.load(std::memory_order_seq_cst)) {
+            return true;
+        }
+        readers.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    void unlock_shared() { my_slot().fetch_sub(1, std::memory_order_release); }
+
+    void lock() {
+        writer_mutex_.lock();
+        writer_.store(true, std::memory_order_seq_cst);
+        for (Slot& slot : slots_) {
+            while (slot.readers.load(std::memory_order_seq_cst) != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool try_lock() {
+        if (!writer_mutex_.try_lock()) {
+            return false;
+        }
+        writer_.store(true, std::memory_order_seq_cst);
+        for (Slot& slot : slots_) {
+            if (slot.readers.load(std::memory_order_seq_cst) != 0) {
+                release_writer();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void unlock() { release_writer(); }
+
+    static constexpr size_t slot_count() { return Slots; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> readers{0};
+    };
+
+    std::atomic<uint32_t>& my_slot() {
+        return slots_[distributed_shared_mutex_detail::thread_slot() & (Slots - 1)].readers;
+    }
+
+    void release_writer() {
+        writer_.store(false, std::memory_order_release);
+        writer_.notify_all();
+        writer_mutex_.unlock();
+    }
+
+    std::array<Slot, Slots> slots_{};
+    alignas(64) std::atomic<bool> writer_{false};
+    std::mutex writer_mutex_;
+};
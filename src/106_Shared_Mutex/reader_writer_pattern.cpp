@@ -6,6 +6,11 @@
  * - Multiple concurrent readers with shared_lock
  * - Exclusive writer access with unique_lock
  * - Thread-safe cache implementation
+ * - Sharded (lock-striped) cache and a read/write-ratio benchmark
+ * - Lock-free snapshot (RCU) cache for read-mostly data, string_view lookup
+ * - Bounded cache with CLOCK eviction, TTL and hit/miss/eviction stats
+ * - Distributed (per-thread slot) reader-writer lock as the cache's mutex
+ * - Warm start from a memory-mapped binary snapshot (save() / load())
  */
 
 #include <iostream>
@@ -15,6 +20,26 @@
 #include <string>
 #include <mutex>
 #include <unordered_map>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <iomanip>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <optional>
+#include <future>
+#include <filesystem>
+#include <stdexcept>
+
+// EpochReclamation: deferred freeing of replaced snapshots
+#include "../114_Atomics/reclamation.hpp"
+// DistributedSharedMutex: reader counts spread over per-thread cache lines
+#include "distributed_shared_mutex.hpp"
+// metrics::Registry: BoundedThreadSafeCache publishes its CacheStats there
+#include "../metrics.hpp"
+// cache_snapshot: the file format behind ThreadSafeCache::save() / load()
+#include "cache_snapshot.hpp"
 
 /**
  * Thread-safe cache using the Reader-Writer pattern
@@ -22,14 +47,50 @@
  * Uses std::shared_mutex to allow:
  * - Multiple simultaneous readers (shared access)
  * - Exclusive writer access (blocks all readers and other writers)
+ *
+ * SharedMutex can be any type meeting the SharedMutex requirements, e.g.
+ * DistributedSharedMutex<> for read-mostly use on many cores
  */
-class ThreadSafeCache {
+template<typename SharedMutex = std::shared_mutex>
+class BasicThreadSafeCache {
 private:
     // Mutable allows locking in const methods (read operations)
-    mutable std::shared_mutex mutex_;
+    mutable SharedMutex mutex_;
     
-    // Underlying data structure protected by mutex
-    std::unordered_map<std::string, std::string> cache_;
+    // Underlying data structure protected by mutex. Mutable because read()
+    // moves entries it finds in the snapshot into it
+    mutable std::unordered_map<std::string, std::string> cache_;
+
+    // Entries loaded by load() and not yet moved into cache_, looked up in
+    // the mapped file; both protected by mutex. shadowed_ counts the
+    // snapshot keys that cache_ already holds (moved, or written since)
+    mutable std::unique_ptr<cache_snapshot::Mapped> snapshot_;
+    mutable size_t shadowed_ = 0;
+
+    // Called with mutex_ held exclusively after a snapshot key was added to
+    // cache_; unmaps the file once cache_ holds all of it
+    void note_shadowed() const {
+        if (++shadowed_ == snapshot_->size()) {
+            snapshot_.reset();
+            shadowed_ = 0;
+        }
+    }
+
+    // Copies a value read from snapshot `source` into cache_ - unless that
+    // would make the reader wait for the lock: then a later read() does it.
+    // Between the two locks load() may have swapped in another file (even
+    // one mapped at the same address), so the value is only kept if the
+    // current snapshot still holds it
+    void materialize(const std::string& key, const std::string& value,
+                     const cache_snapshot::Mapped* source) const {
+        std::unique_lock<SharedMutex> lock(mutex_, std::try_to_lock);
+        if (!lock.owns_lock() || snapshot_.get() != source || snapshot_->find(key) != value) {
+            return;
+        }
+        if (cache_.try_emplace(key, value).second) {
+            note_shadowed();
+        }
+    }
 
 public:
     /**
@@ -42,13 +103,28 @@ public:
      * @return The value if found, otherwise "Not found"
      */
     std::string read(const std::string& key) const {
-        // Shared lock - multiple readers can acquire this simultaneously
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        
-        auto it = cache_.find(key);
-        return (it != cache_.end()) ? it->second : "Not found";
-        
-        // Lock automatically released when 'lock' goes out of scope (RAII)
+        std::string value;
+        const cache_snapshot::Mapped* source = nullptr;
+        {
+            // Shared lock - multiple readers can acquire this simultaneously
+            std::shared_lock<SharedMutex> lock(mutex_);
+
+            auto it = cache_.find(key);
+            if (it != cache_.end()) {
+                return it->second;
+            }
+            // After load(): not materialized yet, served from the mapped file
+            std::optional<std::string_view> cold = snapshot_ ? snapshot_->find(key) : std::nullopt;
+            if (!cold) {
+                return "Not found";
+            }
+            value = *cold;
+            source = snapshot_.get();
+
+            // Lock automatically released when 'lock' goes out of scope (RAII)
+        }
+        materialize(key, value, source);
+        return value;
     }
 
     /**
@@ -62,9 +138,11 @@ public:
      */
     void write(const std::string& key, const std::string& value) {
         // Unique lock - exclusive access, blocks all other threads
-        std::unique_lock<std::shared_mutex> lock(mutex_);
+        std::unique_lock<SharedMutex> lock(mutex_);
         
-        cache_[key] = value;
+        if (cache_.insert_or_assign(key, value).second && snapshot_ && snapshot_->find(key)) {
+            note_shadowed();   // the snapshot's older value is hidden now
+        }
         
         // Lock automatically released when 'lock' goes out of scope (RAII)
     }
@@ -76,11 +154,665 @@ public:
      */
     size_t size() const {
         // Shared lock - can be called concurrently with other reads
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        return cache_.size();
+        std::shared_lock<SharedMutex> lock(mutex_);
+        return cache_.size() + (snapshot_ ? snapshot_->size() - shadowed_ : 0);
+    }
+
+    /**
+     * Writes every entry to a snapshot file (cache_snapshot.hpp)
+     *
+     * The entries are serialized into memory under a shared lock, so
+     * readers carry on and writers wait only for that copy; the file is
+     * written after the lock is released. The file is replaced atomically.
+     *
+     * @param path Snapshot file to (over)write
+     * @return Number of entries saved
+     */
+    size_t save(const std::string& path) const {
+        cache_snapshot::Writer writer;
+        {
+            std::shared_lock<SharedMutex> lock(mutex_);
+            for (const auto& [key, value] : cache_) {
+                writer.add(key, value);
+            }
+            if (snapshot_) {
+                snapshot_->for_each([&](std::string_view key, std::string_view value) {
+                    if (cache_.find(std::string(key)) == cache_.end()) {
+                        writer.add(key, value);
+                    }
+                });
+            }
+        }
+        writer.write(path);
+        return writer.size();
+    }
+
+    /**
+     * save() on a background thread; the cache must outlive the future
+     */
+    std::future<size_t> save_async(std::string path) const {
+        return std::async(std::launch::async, [this, path = std::move(path)] { return save(path); });
+    }
+
+    /**
+     * Warm start: serves the entries of a snapshot file without reading it
+     *
+     * Only the header is checked; lookups go straight to the mapped file,
+     * and each entry is copied into the map the first time read() finds it
+     * there. Entries already in the cache are newer and win over the file.
+     *
+     * @param path Snapshot written by save()
+     * @throws std::runtime_error / std::system_error if it cannot be used
+     */
+    void load(const std::string& path) {
+        auto snapshot = std::make_unique<cache_snapshot::Mapped>(path);
+        std::unique_lock<SharedMutex> lock(mutex_);
+        shadowed_ = 0;
+        for (const auto& entry : cache_) {
+            if (snapshot->find(entry.first)) {
+                ++shadowed_;
+            }
+        }
+        snapshot_ = std::move(snapshot);
+        if (shadowed_ == snapshot_->size()) {
+            snapshot_.reset();
+            shadowed_ = 0;
+        }
+    }
+
+    /**
+     * Copies every remaining snapshot entry into the map and unmaps the
+     * file, batch_size entries per exclusive lock so readers get in between
+     *
+     * @return Number of entries copied
+     */
+    size_t materialize_all(size_t batch_size = 4096) {
+        size_t copied = 0;
+        size_t position = 0;
+        const cache_snapshot::Mapped* source = nullptr;
+        for (;;) {
+            std::unique_lock<SharedMutex> lock(mutex_);
+            if (!snapshot_) {
+                return copied;
+            }
+            if (snapshot_.get() != source) {
+                source = snapshot_.get();   // load() swapped files: start over
+                position = 0;
+            }
+            position = snapshot_->for_each([&](std::string_view key, std::string_view value) {
+                if (cache_.try_emplace(std::string(key), value).second) {
+                    ++copied;
+                    ++shadowed_;   // as note_shadowed(), minus unmapping mid-batch
+                }
+            }, position, batch_size);
+            if (position == 0 || shadowed_ == snapshot_->size()) {
+                snapshot_.reset();
+                shadowed_ = 0;
+                return copied;
+            }
+        }
+    }
+
+    /**
+     * True while some entries are still served from the snapshot file
+     */
+    bool has_snapshot() const {
+        std::shared_lock<SharedMutex> lock(mutex_);
+        return snapshot_ != nullptr;
     }
 };
 
+using ThreadSafeCache = BasicThreadSafeCache<>;
+
+/**
+ * Transparent hash: lets unordered_map::find take a std::string_view (or a
+ * string literal) without building a temporary std::string key
+ */
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+template<typename Value>
+using StringMap = std::unordered_map<std::string, Value, StringHash, std::equal_to<>>;
+
+/**
+ * Sharded (lock-striped) variant of ThreadSafeCache
+ *
+ * With one shared_mutex, every reader still does an atomic RMW on the same
+ * lock word, so the mutex's cache line bounces between reader cores, and
+ * every write stalls all reads. Here the key's hash picks one of N shards,
+ * each with its own shared_mutex and map, so operations on different shards
+ * never touch the same lock, and a write only blocks readers of its shard.
+ *
+ * Same interface as ThreadSafeCache, so the two are interchangeable.
+ */
+class ShardedThreadSafeCache {
+private:
+    // One shard per cache line: neighbouring locks must not false-share
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        StringMap<std::string> map;
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_bits_;
+
+    static size_t log2_ceil(size_t n) {
+        size_t bits = 0;
+        while ((size_t{1} << bits) < n) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    /**
+     * Picks the shard from the top bits of a multiplicative hash.
+     * The low bits of std::hash also pick the bucket inside each shard's
+     * map; using the same bits for both would leave most buckets unused.
+     */
+    Shard& shard_for(std::string_view key) const {
+        if (shard_bits_ == 0) {
+            return shards_[0];
+        }
+        const uint64_t h = static_cast<uint64_t>(StringHash{}(key)) * 0x9E3779B97F4A7C15ull;
+        return shards_[h >> (64 - shard_bits_)];
+    }
+
+public:
+    /**
+     * @param shard_count Number of shards, rounded up to a power of two
+     */
+    explicit ShardedThreadSafeCache(size_t shard_count = 16)
+        : shards_(new Shard[size_t{1} << log2_ceil(shard_count ? shard_count : 1)]),
+          shard_bits_(log2_ceil(shard_count ? shard_count : 1)) {}
+
+    /**
+     * Read operation - shared lock on the key's shard only
+     *
+     * @param key The key to look up
+     * @return The value if found, otherwise "Not found"
+     */
+    std::string read(std::string_view key) const {
+        const Shard& shard = shard_for(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+        auto it = shard.map.find(key);
+        return (it != shard.map.end()) ? it->second : "Not found";
+    }
+
+    /**
+     * Write operation - exclusive lock on the key's shard only;
+     * readers and writers of the other shards carry on
+     *
+     * @param key The key to insert/update
+     * @param value The value to store
+     */
+    void write(const std::string& key, const std::string& value) {
+        Shard& shard = shard_for(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        shard.map[key] = value;
+    }
+
+    /**
+     * Size query - locks each shard in turn, so it is a sum of per-shard
+     * snapshots rather than one atomic snapshot of the whole cache
+     *
+     * @return Number of entries across all shards
+     */
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < shard_count(); ++i) {
+            std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+            total += shards_[i].map.size();
+        }
+        return total;
+    }
+
+    size_t shard_count() const { return size_t{1} << shard_bits_; }
+};
+
+/**
+ * Read-mostly cache with a lock-free read path (RCU-style snapshots)
+ *
+ * The whole map is an immutable snapshot behind one atomic pointer. Readers
+ * load the pointer and search it without taking any lock; the only memory
+ * they write is their own per-thread epoch announcement (reclamation.hpp),
+ * so concurrent readers never bounce a shared cache line.
+ *
+ * A write copies the current snapshot, modifies the copy and publishes it
+ * with one atomic exchange. The replaced snapshot is retired to
+ * EpochReclamation and freed once every reader that might still be inside
+ * it has left. Values are shared_ptr<const std::string>, so a copy only
+ * duplicates pointers, and old and new snapshots share unchanged strings.
+ *
+ * Writes cost O(entries), which suits configuration-style data (rare
+ * updates, constant reads), not a write-heavy cache. write_batch()
+ * amortizes the copy over many updates.
+ */
+class SnapshotCache {
+private:
+    using Map = StringMap<std::shared_ptr<const std::string>>;
+    using Epochs = EpochReclamation<>;
+
+    std::atomic<const Map*> current_;
+    std::mutex write_mutex_;   // writers copy-modify-publish one at a time
+
+    void publish(Map* next) {
+        const Map* old = current_.exchange(next, std::memory_order_acq_rel);
+        Epochs::retire(const_cast<Map*>(old));
+    }
+
+public:
+    SnapshotCache() : current_(new Map()) {}
+    SnapshotCache(const SnapshotCache&) = delete;
+    SnapshotCache& operator=(const SnapshotCache&) = delete;
+
+    ~SnapshotCache() {
+        delete current_.load(std::memory_order_acquire);
+        Epochs::drain();
+    }
+
+    /**
+     * Zero-copy read: calls f(std::string_view value) if the key exists
+     *
+     * The view is only valid inside f - the snapshot it points into may be
+     * freed once f returns. Never takes a lock and never allocates.
+     *
+     * @return true if the key was found (and f was called)
+     */
+    template<typename F>
+    bool visit(std::string_view key, F&& f) const {
+        Epochs::Guard guard;
+        const Map* map = current_.load(std::memory_order_acquire);
+        auto it = map->find(key);
+        if (it == map->end()) {
+            return false;
+        }
+        f(std::string_view(*it->second));
+        return true;
+    }
+
+    /**
+     * Ref-counted handle: the string stays valid for as long as the caller
+     * keeps the pointer, independent of later writes
+     * (costs one refcount increment on the value)
+     *
+     * @return The value, or nullptr if not found
+     */
+    std::shared_ptr<const std::string> lookup(std::string_view key) const {
+        Epochs::Guard guard;
+        const Map* map = current_.load(std::memory_order_acquire);
+        auto it = map->find(key);
+        return it != map->end() ? it->second : nullptr;
+    }
+
+    /**
+     * ThreadSafeCache-compatible read (copies the value)
+     */
+    std::string read(std::string_view key) const {
+        std::string result = "Not found";
+        visit(key, [&result](std::string_view v) { result.assign(v); });
+        return result;
+    }
+
+    void write(const std::string& key, const std::string& value) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        Map* next = new Map(*current_.load(std::memory_order_relaxed));
+        (*next)[key] = std::make_shared<const std::string>(value);
+        publish(next);
+    }
+
+    /**
+     * Many updates, one snapshot copy
+     */
+    void write_batch(const std::vector<std::pair<std::string, std::string>>& entries) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        Map* next = new Map(*current_.load(std::memory_order_relaxed));
+        for (const auto& [key, value] : entries) {
+            (*next)[key] = std::make_shared<const std::string>(value);
+        }
+        publish(next);
+    }
+
+    size_t size() const {
+        Epochs::Guard guard;
+        return current_.load(std::memory_order_acquire)->size();
+    }
+};
+
+/**
+ * Hit/miss/eviction counters, per shard or summed over all shards
+ */
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;        // includes reads that found an expired entry
+    uint64_t evictions = 0;     // live entries pushed out to make room
+    uint64_t expirations = 0;   // expired entries reclaimed by a write
+
+    double hit_rate() const {
+        const uint64_t total = hits + misses;
+        return total ? static_cast<double>(hits) / static_cast<double>(total) : 0.0;
+    }
+
+    CacheStats& operator+=(const CacheStats& other) {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        expirations += other.expirations;
+        return *this;
+    }
+};
+
+/**
+ * Sharded cache with a capacity bound, CLOCK eviction and optional TTLs
+ *
+ * Unbounded caches eventually get long-running processes OOM-killed. This
+ * one holds at most `capacity` entries (split across the shards) in
+ * a fixed array of slots per shard, so memory stays flat.
+ *
+ * Why CLOCK and not LRU: exact LRU moves an entry to the front of a list on
+ * every hit, which is a write - so reads would need the exclusive lock. With
+ * CLOCK a hit only sets the slot's "referenced" bit (a relaxed atomic store,
+ * skipped if it is already set), which is fine under the shared lock, so
+ * readers never serialize on bookkeeping. When a write needs a slot, the
+ * clock hand sweeps the array: referenced slots lose their bit and get a
+ * second chance, the first unreferenced (or expired) slot is replaced.
+ * Every slot is passed at most twice, so eviction is O(1) amortized.
+ *
+ * Expired entries read as misses. They are not erased on read (that would
+ * need the exclusive lock); the sweep reuses their slots first.
+ */
+class BoundedThreadSafeCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    struct Slot {
+        std::string key;
+        std::string value;
+        Clock::time_point expires = Clock::time_point::max();   // max = no TTL
+        mutable std::atomic<bool> referenced{false};
+    };
+
+    // Every get() counts a hit or a miss, so those are metrics::Counters: a
+    // thread adds to its own padded cell instead of a line that all readers
+    // of the shard write. Writes already hold the exclusive lock, so plain
+    // relaxed atomics do for evictions and expirations
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        StringMap<size_t> index;            // key -> slot
+        std::unique_ptr<Slot[]> slots;
+        size_t capacity = 0;
+        size_t hand = 0;                    // CLOCK hand
+        size_t used = 0;
+        mutable metrics::Counter hits;
+        mutable metrics::Counter misses;
+        std::atomic<uint64_t> evictions{0};
+        std::atomic<uint64_t> expirations{0};
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_bits_;
+    size_t capacity_;
+
+    static size_t log2_ceil(size_t n) {
+        size_t bits = 0;
+        while ((size_t{1} << bits) < n) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    // shard_count rounded up to a power of two, then halved until every
+    // shard gets at least one slot
+    static size_t shard_bits_for(size_t capacity, size_t shard_count) {
+        if (capacity == 0) {
+            throw std::invalid_argument("BoundedThreadSafeCache: capacity must be at least 1");
+        }
+        size_t bits = log2_ceil(shard_count ? shard_count : 1);
+        while (bits > 0 && (size_t{1} << bits) > capacity) {
+            --bits;
+        }
+        return bits;
+    }
+
+    Shard& shard_for(std::string_view key) const {
+        if (shard_bits_ == 0) {
+            return shards_[0];
+        }
+        const uint64_t h = static_cast<uint64_t>(StringHash{}(key)) * 0x9E3779B97F4A7C15ull;
+        return shards_[h >> (64 - shard_bits_)];
+    }
+
+    /**
+     * Find a slot for a new key (exclusive lock held): a free one while the
+     * shard is filling up, otherwise run the clock hand
+     */
+    static size_t claim_slot(Shard& shard, Clock::time_point now) {
+        if (shard.used < shard.capacity) {
+            return shard.used++;
+        }
+        while (true) {
+            const size_t i = shard.hand;
+            shard.hand = (shard.hand + 1) % shard.capacity;
+            Slot& slot = shard.slots[i];
+            if (slot.expires <= now) {
+                shard.expirations.fetch_add(1, std::memory_order_relaxed);
+            } else if (slot.referenced.exchange(false, std::memory_order_relaxed)) {
+                continue;   // second chance
+            } else {
+                shard.evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+            shard.index.erase(slot.key);
+            return i;
+        }
+    }
+
+public:
+    /**
+     * @param capacity Maximum number of entries across all shards (>= 1)
+     * @param shard_count Number of shards, rounded up to a power of two;
+     *        fewer if capacity would leave some shard without a slot
+     * @throws std::invalid_argument if capacity is 0
+     */
+    explicit BoundedThreadSafeCache(size_t capacity, size_t shard_count = 16)
+        : shard_bits_(shard_bits_for(capacity, shard_count)), capacity_(capacity) {
+        shards_.reset(new Shard[this->shard_count()]);
+        // The first capacity % shards shards take one extra slot, so the
+        // shard capacities add up to exactly `capacity`
+        const size_t base = capacity / this->shard_count();
+        const size_t extra = capacity % this->shard_count();
+        for (size_t i = 0; i < this->shard_count(); ++i) {
+            const size_t slots = base + (i < extra ? 1 : 0);
+            shards_[i].capacity = slots;
+            shards_[i].slots.reset(new Slot[slots]);
+            shards_[i].index.reserve(slots);
+        }
+    }
+
+    /**
+     * Read operation - shared lock on the key's shard; a hit only sets the
+     * slot's referenced bit
+     *
+     * @param key The key to look up
+     * @return The value, or std::nullopt if missing or expired
+     */
+    std::optional<std::string> get(std::string_view key) const {
+        const Shard& shard = shard_for(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            shard.misses.inc();
+            return std::nullopt;
+        }
+        const Slot& slot = shard.slots[it->second];
+        if (slot.expires <= Clock::now()) {
+            shard.misses.inc();
+            return std::nullopt;
+        }
+        // Test before setting: a hot entry's bit is usually already set,
+        // and skipping the store keeps the slot's line shared across readers
+        if (!slot.referenced.load(std::memory_order_relaxed)) {
+            slot.referenced.store(true, std::memory_order_relaxed);
+        }
+        shard.hits.inc();
+        return slot.value;
+    }
+
+    /**
+     * ThreadSafeCache-compatible read
+     *
+     * @return The value if found, otherwise "Not found"
+     */
+    std::string read(std::string_view key) const {
+        return get(key).value_or("Not found");
+    }
+
+    /**
+     * Insert/update; may evict another entry of the same shard
+     *
+     * @param key The key to insert/update
+     * @param value The value to store
+     * @param ttl Time to live; zero means the entry never expires
+     */
+    void write(const std::string& key, const std::string& value,
+               std::chrono::milliseconds ttl = std::chrono::milliseconds::zero()) {
+        Shard& shard = shard_for(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+        const Clock::time_point now = Clock::now();
+        size_t i;
+        auto it = shard.index.find(key);
+        const bool existed = it != shard.index.end();
+        if (existed) {
+            i = it->second;
+        } else {
+            i = claim_slot(shard, now);
+            shard.index.emplace(key, i);
+            shard.slots[i].key = key;
+        }
+        Slot& slot = shard.slots[i];
+        slot.value = value;
+        slot.expires = ttl.count() > 0 ? now + ttl : Clock::time_point::max();
+        // A new entry starts unreferenced: it has to earn its second chance
+        slot.referenced.store(existed, std::memory_order_relaxed);
+    }
+
+    /**
+     * Entries currently held, expired-but-not-yet-reclaimed ones included
+     */
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < shard_count(); ++i) {
+            std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+            total += shards_[i].index.size();
+        }
+        return total;
+    }
+
+    size_t capacity() const { return capacity_; }
+    size_t shard_count() const { return size_t{1} << shard_bits_; }
+
+    CacheStats shard_stats(size_t i) const {
+        const Shard& shard = shards_[i];
+        return CacheStats{shard.hits.value(),
+                          shard.misses.value(),
+                          shard.evictions.load(std::memory_order_relaxed),
+                          shard.expirations.load(std::memory_order_relaxed)};
+    }
+
+    CacheStats stats() const {
+        CacheStats total;
+        for (size_t i = 0; i < shard_count(); ++i) {
+            total += shard_stats(i);
+        }
+        return total;
+    }
+
+    /**
+     * Publishes per-shard stats on every scrape, labelled cache="<name>"
+     * (counters only: reading them takes no lock). Keep the Registration
+     * no longer than the cache.
+     */
+    metrics::Registration register_metrics(metrics::Registry& registry, std::string name) const {
+        return registry.add_collector([this, name = std::move(name)](metrics::Exposition& out) {
+            for (size_t i = 0; i < shard_count(); ++i) {
+                const CacheStats s = shard_stats(i);
+                const std::string labels = "cache=\"" + name + "\",shard=\"" + std::to_string(i) + "\"";
+                out.counter("cache_hits_total", "Reads that found a live entry", labels, static_cast<double>(s.hits));
+                out.counter("cache_misses_total", "Reads that found no live entry", labels,
+                            static_cast<double>(s.misses));
+                out.counter("cache_evictions_total", "Live entries pushed out to make room", labels,
+                            static_cast<double>(s.evictions));
+                out.counter("cache_expirations_total", "Expired entries reclaimed by a write", labels,
+                            static_cast<double>(s.expirations));
+            }
+            out.gauge("cache_capacity", "Maximum number of entries", "cache=\"" + name + "\"",
+                      static_cast<double>(capacity()));
+        });
+    }
+};
+
+/**
+ * Benchmark: n threads issue a mix of reads and writes over a fixed key set
+ *
+ * @param read_percent Share of operations that are reads (99, 90, 50, ...)
+ * @return Million operations per second across all threads
+ */
+template<typename Cache>
+double mixed_mops(Cache& cache, int threads, int read_percent, int ops_per_thread) {
+    // Keys are built up front so the loop measures the cache, not std::string
+    const int key_count = 1024;
+    std::vector<std::string> keys;
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (int i = 0; i < key_count; ++i) {
+        keys.push_back("key" + std::to_string(i));
+        entries.emplace_back(keys.back(), "value" + std::to_string(i));
+    }
+    if constexpr (requires { cache.write_batch(entries); }) {
+        cache.write_batch(entries);
+    } else {
+        for (const auto& [key, value] : entries) {
+            cache.write(key, value);
+        }
+    }
+    const std::string new_value = "updated";
+
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            uint32_t rng = 0x9E3779B9u * static_cast<uint32_t>(t + 1);
+            size_t sink = 0;
+            for (int i = 0; i < ops_per_thread; ++i) {
+                rng ^= rng << 13;
+                rng ^= rng >> 17;
+                rng ^= rng << 5;
+                const std::string& key = keys[rng % key_count];
+                if (static_cast<int>((rng >> 16) % 100) < read_percent) {
+                    // Caches with a zero-copy path are read through it
+                    if constexpr (requires { cache.visit(key, [](std::string_view) {}); }) {
+                        cache.visit(key, [&sink](std::string_view v) { sink += v.size(); });
+                    } else {
+                        sink += cache.read(key).size();
+                    }
+                } else {
+                    cache.write(key, new_value);
+                }
+            }
+            static_cast<void>(sink);
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return threads * static_cast<double>(ops_per_thread) / seconds / 1e6;
+}
+
 // Separate mutex to protect std::cout from interleaved output
 // (std::cout is not thread-safe for concurrent writes)
 std::mutex cout_mutex;
@@ -142,6 +874,220 @@ int main() {
     for (auto& reader : readers) {
         reader.join();
     }
+
+    /**
+     * Snapshot cache: string_view probes, zero-copy visit and a handle
+     * that outlives later writes
+     */
+    SnapshotCache config;
+    config.write_batch({{"log.level", "info"}, {"pool.size", "8"}});
+    std::shared_ptr<const std::string> level = config.lookup("log.level");
+    config.write("log.level", "debug");
+    config.visit(std::string_view("log.level"), [](std::string_view v) {
+        std::cout << "\nlog.level now: " << v << "\n";
+    });
+    std::cout << "handle taken before the write still reads: " << *level << "\n";
+
+    /**
+     * Bounded cache: 10000 distinct keys through a 1000-entry cache, with
+     * 80% of reads going to 100 hot keys. CLOCK keeps the hot set resident:
+     * the hit rate stays high while size() never exceeds the capacity.
+     */
+    BoundedThreadSafeCache bounded(1000, 8);
+    metrics::Registration bounded_metrics = bounded.register_metrics(metrics::Registry::global(), "bounded");
+    {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&bounded, t]() {
+                uint32_t rng = 0x2545F491u * static_cast<uint32_t>(t + 1);
+                for (int i = 0; i < 50000; ++i) {
+                    rng ^= rng << 13;
+                    rng ^= rng >> 17;
+                    rng ^= rng << 5;
+                    const bool hot = rng % 100 < 80;
+                    const std::string key = "k" + std::to_string(hot ? rng % 100 : rng % 10000);
+                    if (!bounded.get(key)) {
+                        bounded.write(key, "v");   // miss: load and insert
+                    }
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+    CacheStats stats = bounded.stats();
+    std::cout << "\nbounded cache: size " << bounded.size() << " / capacity " << bounded.capacity()
+              << ", hit rate " << std::fixed << std::setprecision(1) << 100.0 * stats.hit_rate() << "%"
+              << ", " << stats.evictions << " evictions\n";
+    for (size_t i = 0; i < bounded.shard_count(); ++i) {
+        const CacheStats s = bounded.shard_stats(i);
+        std::cout << "  shard " << i << ": " << s.hits << " hits, " << s.misses << " misses, "
+                  << s.evictions << " evictions\n";
+    }
+
+    // Capacity below the shard count, and not a multiple of it: 16 shards
+    // become 8, two of them with a second slot - never more than 10 entries
+    {
+        BoundedThreadSafeCache tiny(10, 16);
+        for (int i = 0; i < 1000; ++i) {
+            tiny.write("k" + std::to_string(i), "v");
+        }
+        std::cout << "tiny cache: " << tiny.shard_count() << " shards, size " << tiny.size() << " / capacity "
+                  << tiny.capacity() << "\n";
+    }
+
+    // The same numbers in Prometheus text format, as a scrape would see them
+    {
+        const std::string scrape = metrics::Registry::global().scrape();
+        std::cout << "scrape (first lines):\n";
+        size_t pos = 0;
+        for (int line = 0; line < 6 && pos < scrape.size(); ++line) {
+            const size_t end = scrape.find('\n', pos);
+            std::cout << "  " << scrape.substr(pos, end - pos) << "\n";
+            pos = end + 1;
+        }
+    }
+
+    // TTL: the entry reads as a miss once expired, and its slot is the
+    // first one reused
+    bounded.write("session", "token", std::chrono::milliseconds(20));
+    std::cout << "session before expiry: " << bounded.read("session") << "\n";
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    std::cout << "session after expiry:  " << bounded.read("session") << "\n";
+
+    /**
+     * Warm start: save 200000 entries, "restart", and serve them again
+     * from the mapped snapshot. Refilling by writes stands in for the
+     * backends here, so it is a lower bound on a real refill
+     */
+    {
+        using Clock = std::chrono::steady_clock;
+        auto ms_since = [](Clock::time_point t0) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        };
+        const int entries = 200000;
+        const std::string path = (std::filesystem::temp_directory_path() / "thread_safe_cache.snap").string();
+        auto value_of = [](int i) { return "profile:" + std::to_string(i) + std::string(80, 'p'); };
+
+        ThreadSafeCache before;
+        auto t0 = Clock::now();
+        for (int i = 0; i < entries; ++i) {
+            before.write("user:" + std::to_string(i), value_of(i));
+        }
+        const double refill_ms = ms_since(t0);
+
+        // Readers keep going while the snapshot is taken in the background
+        std::atomic<bool> saving{true};
+        std::atomic<long> reads_during_save{0};
+        std::vector<std::thread> readers_during_save;
+        for (int t = 0; t < 2; ++t) {
+            readers_during_save.emplace_back([&, t] {
+                for (int i = t; saving.load(); i += 7) {
+                    before.read("user:" + std::to_string(i % entries));
+                    reads_during_save.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        t0 = Clock::now();
+        std::future<size_t> saved = before.save_async(path);
+        const size_t saved_entries = saved.get();
+        const double save_ms = ms_since(t0);
+        saving = false;
+        for (auto& r : readers_during_save) {
+            r.join();
+        }
+
+        ThreadSafeCache after;
+        t0 = Clock::now();
+        after.load(path);
+        const double load_ms = ms_since(t0);
+
+        t0 = Clock::now();
+        bool same = after.size() == before.size();
+        for (int i = 0; i < entries; i += 97) {
+            same = same && after.read("user:" + std::to_string(i)) == value_of(i);
+        }
+        const double probe_ms = ms_since(t0);
+        after.write("user:1", "rewritten after the restart");
+        same = same && after.size() == before.size() && after.read("user:1") == "rewritten after the restart";
+
+        // size() must not move while entries go from the file to the map
+        std::atomic<bool> materializing{true};
+        std::atomic<bool> size_steady{true};
+        std::thread size_checker([&] {
+            while (materializing.load()) {
+                if (after.size() != before.size()) {
+                    size_steady = false;
+                }
+            }
+        });
+        t0 = Clock::now();
+        const size_t copied = after.materialize_all(1024);
+        const double materialize_ms = ms_since(t0);
+        materializing = false;
+        size_checker.join();
+        same = same && size_steady.load() && after.size() == before.size() && !after.has_snapshot() &&
+               after.read("user:2") == value_of(2) && after.read("user:1") == "rewritten after the restart";
+
+        std::cout << std::fixed << std::setprecision(1) << "\nwarm start, " << entries << " entries ("
+                  << std::filesystem::file_size(path) / 1024 << " KiB snapshot):\n"
+                  << "  refill by writes " << refill_ms << " ms; save_async (" << saved_entries << " entries) " << save_ms
+                  << " ms, with "
+                  << reads_during_save.load() << " reads served meanwhile\n"
+                  << "  load " << std::setprecision(3) << load_ms << " ms, then " << (entries + 96) / 97
+                  << " first reads " << std::setprecision(1) << probe_ms << " ms, materialize_all (" << copied
+                  << " entries) " << materialize_ms << " ms; contents " << (same ? "identical" : "DIFFER")
+                  << "\n";
+        std::filesystem::remove(path);
+    }
+
+    /**
+     * Single lock vs 16 shards, across read/write ratios and thread counts
+     * Sharding pays off only with real parallelism: on a single core the
+     * threads take turns anyway and the extra hash just costs a little
+     */
+    std::cout << "\nMops/s (hardware threads: " << std::thread::hardware_concurrency() << ")\n"
+              << std::setw(8) << "reads" << std::setw(9) << "threads"
+              << std::setw(14) << "one lock" << std::setw(14) << "16 shards" << std::setw(14) << "snapshot" << "\n";
+    for (int read_percent : {100, 99, 90, 50}) {
+        for (int threads : {1, 2, 4, 8}) {
+            const int ops = 200000;
+            ThreadSafeCache single;
+            ShardedThreadSafeCache sharded(16);
+            SnapshotCache snapshot;
+            // Every snapshot write copies all 1024 entries - it is built for
+            // the 100% row (config reloads are far rarer than 1 in 100), and
+            // the write-heavy rows run fewer operations
+            const int snapshot_ops = read_percent >= 99 ? ops : ops / 20;
+            std::cout << std::setw(7) << read_percent << "%" << std::setw(9) << threads
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(14) << mixed_mops(single, threads, read_percent, ops)
+                      << std::setw(14) << mixed_mops(sharded, threads, read_percent, ops)
+                      << std::setw(14) << mixed_mops(snapshot, threads, read_percent, snapshot_ops) << "\n";
+        }
+    }
+    
+    /**
+     * Read scaling of the single-lock cache: std::shared_mutex vs the
+     * distributed lock, 100% and 99% reads, 1..64 threads. The distributed
+     * lock's readers only write their own slot's cache line; on a machine
+     * with fewer cores than threads both are limited by time slicing
+     */
+    std::cout << "\nMops/s, one lock (hardware threads: " << std::thread::hardware_concurrency() << ")\n"
+              << std::setw(8) << "reads" << std::setw(9) << "threads"
+              << std::setw(16) << "shared_mutex" << std::setw(16) << "distributed" << "\n";
+    for (int read_percent : {100, 99}) {
+        for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+            const int ops = 100000;
+            ThreadSafeCache standard;
+            BasicThreadSafeCache<DistributedSharedMutex<>> distributed;
+            std::cout << std::setw(7) << read_percent << "%" << std::setw(9) << threads
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(16) << mixed_mops(standard, threads, read_percent, ops)
+                      << std::setw(16) << mixed_mops(distributed, threads, read_percent, ops) << "\n";
+        }
+    }
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,384 @@
+// Lock-free unbounded FIFO queue (Michael & Scott, 1996) with safe memory reclamation
+// Same building blocks as lock_free_stack.cpp: tagged pointers against ABA
+// (tagged_pointer.hpp) and hazard pointers or epochs (reclamation.hpp)
+
+/*
+
+g++ -pthread --std=c++20 lock_free_queue.cpp -o app -latomic
+
+*/
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <queue>
+#include <optional>
+#include <chrono>
+#include <iomanip>
+#include <utility>
+
+#include "reclamation.hpp"
+#include "tagged_pointer.hpp"
+
+// Reclaimer: HazardPointers<2> - a dequeue protects both the dummy head and
+// its successor, whose value it moves out - or EpochReclamation<>
+template<typename T, typename Reclaimer = HazardPointers<2>>
+class LockFreeQueue {
+private:
+    // Queue node structure
+    // The queue always holds one dummy node at the front: head points to it,
+    // and the first real value lives in head->next. A dequeue moves that
+    // value out and makes its node the new dummy.
+    struct Node;
+    using NodePointer = TaggedPointer<Node>;
+    static_assert(std::atomic<NodePointer>::is_always_lock_free,
+                  "LockFreeQueue links would fall back to a libatomic lock");
+
+    struct Node {
+        std::optional<T> data;              // empty for the dummy node
+        std::atomic<NodePointer> next;      // tagged: re-linking a node bumps the tag
+
+        Node() : next(NodePointer(nullptr, 0)) {}
+        template<typename U>
+        explicit Node(U&& value) : data(std::forward<U>(value)), next(NodePointer(nullptr, 0)) {}
+    };
+
+    static Node* ptr_of(const NodePointer& p) { return p.ptr(); }
+
+    // Consumers only touch head, producers only touch tail (except when the
+    // queue is nearly empty), so each gets its own cache line
+    alignas(64) std::atomic<NodePointer> head;
+    alignas(64) std::atomic<NodePointer> tail;
+
+    template<typename U>
+    void enqueue_node(U&& value) {
+        Node* node = new Node(std::forward<U>(value));
+        typename Reclaimer::Guard guard;
+
+        do {
+            // Protect tail: we are about to read tail->next
+            NodePointer last = guard.protect(0, tail, &ptr_of);
+            NodePointer next = last.ptr()->next.load(std::memory_order_acquire);
+
+            // Consistency check: tail didn't move while we read next
+            if (!(last == tail.load(std::memory_order_acquire))) {
+                continue;
+            }
+
+            if (next.ptr() == nullptr) {
+                // tail really is the last node - try to link the new node after it
+                // release: node->data must be visible to the dequeuer
+                if (last.ptr()->next.compare_exchange_weak(next, next.next(node),
+                                                           std::memory_order_release,
+                                                           std::memory_order_relaxed)) {
+                    // Linked. Swing tail to the new node; if this fails,
+                    // someone already helped us
+                    tail.compare_exchange_strong(last, last.next(node),
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed);
+                    return;
+                }
+            } else {
+                // tail is lagging behind (another enqueue linked but hasn't
+                // swung tail yet) - help it along, then retry
+                tail.compare_exchange_strong(last, last.next(next.ptr()),
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed);
+            }
+        } while (true);
+    }
+
+public:
+    // Constructor - the queue starts with just the dummy node
+    LockFreeQueue() {
+        Node* dummy = new Node();
+        head.store(NodePointer(dummy, 0));
+        tail.store(NodePointer(dummy, 0));
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    // ===== ENQUEUE =====
+    void enqueue(const T& value) { enqueue_node(value); }
+    void enqueue(T&& value) { enqueue_node(std::move(value)); }
+
+    // ===== DEQUEUE =====
+    // Returns true and sets result if a value was dequeued, false if the
+    // queue was empty
+    bool dequeue(T& result) {
+        typename Reclaimer::Guard guard;
+
+        do {
+            // Hazard 0: the current dummy node
+            NodePointer first = guard.protect(0, head, &ptr_of);
+            NodePointer last = tail.load(std::memory_order_acquire);
+
+            // Hazard 1: its successor, which holds the value we want. The
+            // protect loop checks first->next didn't change under us ...
+            NodePointer next = guard.protect(1, first.ptr()->next, &ptr_of);
+
+            // ... and this check that first is still the head, so next
+            // cannot have been retired before hazard 1 was published
+            if (!(first == head.load(std::memory_order_acquire))) {
+                continue;
+            }
+
+            if (next.ptr() == nullptr) {
+                return false;   // only the dummy left: empty
+            }
+
+            if (first.ptr() == last.ptr()) {
+                // Queue is not empty but tail still points at the dummy -
+                // help the lagging enqueue before moving head past tail
+                tail.compare_exchange_strong(last, last.next(next.ptr()),
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed);
+                continue;
+            }
+
+            if (head.compare_exchange_weak(first, first.next(next.ptr()),
+                                           std::memory_order_acquire,
+                                           std::memory_order_relaxed)) {
+                // next is the new dummy. Only the CAS winner ever touches its
+                // data, and hazard 1 keeps it alive, so moving out is safe
+                result = std::move(*next.ptr()->data);
+                next.ptr()->data.reset();
+
+                guard.clear(0);
+                guard.clear(1);
+
+                // The old dummy is unreachable now - retire it
+                Reclaimer::retire(first.ptr());
+                return true;
+            }
+        } while (true);
+    }
+
+    // Racy snapshot - only exact while no other thread is active
+    bool empty() const {
+        return head.load(std::memory_order_acquire).ptr()->next.load(std::memory_order_acquire).ptr() == nullptr;
+    }
+
+    // ===== DESTRUCTOR =====
+    ~LockFreeQueue() {
+        // No other thread can be using the queue anymore: delete the chain
+        // directly, starting at the dummy
+        Node* node = head.load(std::memory_order_acquire).ptr();
+        while (node) {
+            Node* next = node->next.load(std::memory_order_relaxed).ptr();
+            delete node;
+            node = next;
+        }
+        Reclaimer::drain();
+    }
+};
+
+// The mutex-based queue from ../105_Lock_Guards/thread_safe_queue.cpp
+// (push/pop only), as the baseline
+template<typename T>
+class ThreadSafeQueue {
+private:
+    std::queue<T> queue;
+    mutable std::mutex mtx;
+
+public:
+    void push(T value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        queue.push(std::move(value));
+    }
+
+    std::optional<T> pop() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (queue.empty()) {
+            return std::nullopt;
+        }
+        T value = std::move(queue.front());
+        queue.pop();
+        return value;
+    }
+};
+
+// ===== BENCHMARK =====
+// Minimal common interface so one driver runs every queue
+template<typename Reclaimer>
+struct MSQueueAdapter {
+    LockFreeQueue<int, Reclaimer> q;
+    void push(int v) { q.enqueue(v); }
+    bool pop(int& v) { return q.dequeue(v); }
+};
+
+struct MutexQueueAdapter {
+    ThreadSafeQueue<int> q;
+    void push(int v) { q.push(v); }
+    bool pop(int& v) {
+        if (auto item = q.pop()) {
+            v = *item;
+            return true;
+        }
+        return false;
+    }
+};
+
+// Each thread alternates enqueue and dequeue, like push_pop_mops in
+// lock_free_stack.cpp; million operations per second
+template<typename Queue>
+double pairs_mops(int threads, int ops_per_thread) {
+    Queue queue;
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&queue, ops_per_thread]() {
+            int v;
+            for (int j = 0; j < ops_per_thread; ++j) {
+                queue.push(j);
+                queue.pop(v);
+            }
+        });
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return 2.0 * threads * ops_per_thread / seconds / 1e6;
+}
+
+// Dedicated producers and consumers; items moved end to end per second (millions)
+template<typename Queue>
+double split_mops(int producers, int consumers, int items_per_producer) {
+    Queue queue;
+    std::vector<std::thread> workers;
+    const long total = static_cast<long>(producers) * items_per_producer;
+    std::atomic<long> consumed{0};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < producers; ++i) {
+        workers.emplace_back([&queue, items_per_producer]() {
+            for (int j = 0; j < items_per_producer; ++j) {
+                queue.push(j);
+            }
+        });
+    }
+    for (int i = 0; i < consumers; ++i) {
+        workers.emplace_back([&queue, &consumed, total]() {
+            int v;
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                if (queue.pop(v)) {
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return total / seconds / 1e6;
+}
+
+// ===== TEST PROGRAM =====
+int main() {
+    LockFreeQueue<int> queue;
+    std::vector<std::thread> threads;
+
+    std::cout << "Starting concurrent enqueue operations..." << std::endl;
+
+    // ===== TEST 1: Concurrent Enqueues =====
+    // 5 producer threads, each enqueueing 10 values (0-9, 10-19, ... 40-49)
+    for (int i = 0; i < 5; ++i) {
+        threads.emplace_back([&queue, i]() {
+            for (int j = 0; j < 10; ++j) {
+                queue.enqueue(i * 10 + j);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    threads.clear();
+
+    std::cout << "Enqueue operations completed." << std::endl;
+    std::cout << "Starting concurrent dequeue operations..." << std::endl;
+
+    // ===== TEST 2: Concurrent Dequeues =====
+    // 3 consumers drain the queue. FIFO means each producer's values come out
+    // in the order it enqueued them; each consumer checks that for what it sees
+    std::atomic<int> dequeue_count{0};
+    std::atomic<bool> order_ok{true};
+    for (int i = 0; i < 3; ++i) {
+        threads.emplace_back([&queue, &dequeue_count, &order_ok]() {
+            int last_seen[5] = {-1, -1, -1, -1, -1};
+            int value;
+            while (queue.dequeue(value)) {
+                int& last = last_seen[value / 10];
+                if (value <= last) {
+                    order_ok = false;
+                }
+                last = value;
+                dequeue_count++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::cout << "Successfully dequeued " << dequeue_count.load() << " elements, per-producer order "
+              << (order_ok ? "preserved." : "VIOLATED!") << std::endl;
+
+    // ===== VERIFICATION =====
+    int value;
+    if (!queue.dequeue(value) && queue.empty()) {
+        std::cout << "Queue is now empty (as expected)." << std::endl;
+    }
+
+    // ===== TEST 3: Slot recycling =====
+    // 1000 short-lived threads, far more than the 128 hazard slots
+    for (int round = 0; round < 50; ++round) {
+        threads.clear();
+        for (int i = 0; i < 20; ++i) {
+            threads.emplace_back([&queue, i]() {
+                queue.enqueue(i);
+                int v;
+                queue.dequeue(v);
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    std::cout << "1000 short-lived threads done, " << HazardPointers<2>::registered_threads()
+              << " slot(s) still registered." << std::endl;
+
+    // ===== TEST 4: Throughput vs ThreadSafeQueue =====
+    // Lock-freedom buys progress under preemption and scaling across cores,
+    // not single-thread speed: an uncontended mutex is one atomic RMW each way,
+    // while a lock-free enqueue needs two CASes plus hazard publishing. With
+    // fewer cores than threads the mutex is rarely contended and wins.
+    std::cout << "\nenqueue/dequeue pairs per thread (Mops/s)\n"
+              << std::setw(8) << "threads" << std::setw(12) << "MS + HP" << std::setw(12) << "MS + EBR"
+              << std::setw(14) << "mutex queue" << "\n";
+    for (int n : {1, 2, 4, 8}) {
+        const int ops = 200000;
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(1)
+                  << std::setw(12) << pairs_mops<MSQueueAdapter<HazardPointers<2>>>(n, ops)
+                  << std::setw(12) << pairs_mops<MSQueueAdapter<EpochReclamation<>>>(n, ops)
+                  << std::setw(14) << pairs_mops<MutexQueueAdapter>(n, ops) << "\n";
+    }
+
+    std::cout << "\nproducers -> consumers (M items/s)\n"
+              << std::setw(8) << "p x c" << std::setw(12) << "MS + HP" << std::setw(12) << "MS + EBR"
+              << std::setw(14) << "mutex queue" << "\n";
+    for (int n : {1, 2, 4}) {
+        const int items = 200000;
+        std::cout << std::setw(6) << n << "x" << n << std::fixed << std::setprecision(1)
+                  << std::setw(12) << split_mops<MSQueueAdapter<HazardPointers<2>>>(n, n, items)
+                  << std::setw(12) << split_mops<MSQueueAdapter<EpochReclamation<>>>(n, n, items)
+                  << std::setw(14) << split_mops<MutexQueueAdapter>(n, n, items) << "\n";
+    }
+
+    return 0;
+}
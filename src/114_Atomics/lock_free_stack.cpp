@@ -1,5 +1,7 @@
 // Lock-free stack implementation with safe memory reclamation
 // Solves ABA problem and prevents use-after-free bugs in concurrent access
+// Memory reclamation lives in reclamation.hpp (hazard pointers or epochs),
+// the ABA-safe head layout in tagged_pointer.hpp
 
 /*
 
@@ -13,8 +15,35 @@ g++ -pthread --std=c++20 lock_free_stack.cpp -o app -latomic
 #include <vector>
 #include <array>
 #include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <string>
+#include <iterator>
+#include <new>
+#include <cstdlib>
+#include <utility>
 
-template<typename T>
+#include "reclamation.hpp"
+#include "tagged_pointer.hpp"
+#include "../101_Threads_RAII/adaptive_waiter.hpp"   // cpu_relax()
+
+// Counts every global operator new, to show node pooling taking the
+// allocator off the push path
+std::atomic<size_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Reclaimer: HazardPointers<1> (one protected node per thread is all pop
+// needs) or EpochReclamation<>, see reclamation.hpp
+template<typename T, typename Reclaimer = HazardPointers<1>>
 class LockFreeStack {
 private:
     // Stack node structure
@@ -22,295 +51,367 @@ private:
     struct Node {
         T data;                      // User data stored in this node
         Node* next;                  // Pointer to next node (towards bottom of stack)
-        std::atomic<int> ref_count;  // Reference counter (currently unused, kept for future extensions)
         
-        Node(const T& value) : data(value), next(nullptr), ref_count(0) {}
+        template<typename U>
+        explicit Node(U&& value) : data(std::forward<U>(value)), next(nullptr) {}
     };
     
-    // ===== HAZARD POINTER SYSTEM =====
-    // Hazard pointers prevent premature deletion of nodes that other threads might be accessing
-    // Each thread can "claim" a node by storing its address in a hazard pointer slot
-    // A node can only be deleted when no hazard pointer references it
+    // ===== NODE POOL =====
+    // Every push used to new a Node and every reclaimed pop deleted one,
+    // putting the global allocator (and its locks) on the hot path. Instead,
+    // reclaimed nodes are destroyed in place and their memory goes onto a
+    // per-thread free list; push takes memory from there first.
+    //
+    // The free list is fed by the reclamation path, i.e. by whichever thread
+    // runs the reclaim pass - usually the thread that popped. A thread that
+    // only pushes therefore still allocates; kNodeCacheLimit keeps a thread
+    // that only pops from hoarding memory.
+    static constexpr size_t kNodeCacheLimit = 1024;
     
-    static constexpr size_t MAX_THREADS = 128;         // Maximum concurrent threads supported
-    static constexpr size_t HAZARDS_PER_THREAD = 1;    // Number of hazard pointers per thread
-    
-    // Hazard pointer structure - one slot to protect one node at a time
-    struct HazardPointer {
-        std::atomic<Node*> pointer;  // Atomic pointer to the node being protected
-        HazardPointer() : pointer(nullptr) {}
+    struct FreeBlock {
+        FreeBlock* next;
     };
+    static_assert(sizeof(Node) >= sizeof(FreeBlock));
     
-    // Global array of hazard pointers shared by all threads
-    // Each thread gets HAZARDS_PER_THREAD consecutive slots
-    static std::array<HazardPointer, MAX_THREADS * HAZARDS_PER_THREAD> hazard_pointers;
-    
-    // ===== RETIRED NODES LIST =====
-    // Nodes that have been popped but can't be deleted yet (might still be accessed)
-    // These are stored in a thread-local list and deleted when safe
+    // Trivially destructible on purpose: the reclaimer's thread-exit hook may
+    // recycle nodes after this thread's other thread_locals are gone, and a
+    // closed cache then just frees them
+    struct NodeCache {
+        FreeBlock* head;
+        size_t count;
+        bool registered;   // CacheCloser set up for this thread
+        bool closed;       // thread is exiting: stop caching
+    };
+    static inline thread_local NodeCache cache_{};
     
-    struct RetiredNode {
-        Node* node;           // Pointer to the retired node
-        RetiredNode* next;    // Next retired node in the list
-        RetiredNode(Node* n) : node(n), next(nullptr) {}
+    struct CacheCloser {
+        ~CacheCloser() {
+            while (FreeBlock* block = cache_.head) {
+                cache_.head = block->next;
+                ::operator delete(block);
+            }
+            cache_.count = 0;
+            cache_.closed = true;
+        }
     };
     
-    // Thread-local storage for retired nodes (each thread maintains its own list)
-    thread_local static RetiredNode* retired_list;   // Head of retired nodes list
-    thread_local static size_t retired_count;        // Count of retired nodes
+    template<typename U>
+    static Node* make_node(U&& value) {
+        void* memory;
+        if (FreeBlock* block = cache_.head) {
+            cache_.head = block->next;
+            --cache_.count;
+            memory = block;
+        } else {
+            memory = ::operator new(sizeof(Node));
+        }
+        return new (memory) Node(std::forward<U>(value));
+    }
     
-    // When retired list reaches this threshold, trigger garbage collection
-    static constexpr size_t RETIRED_THRESHOLD = 10;
+    static void recycle_node(Node* node) {
+        node->~Node();
+        if (!cache_.registered) {
+            cache_.registered = true;
+            static thread_local CacheCloser closer;
+        }
+        if (cache_.closed || cache_.count >= kNodeCacheLimit) {
+            ::operator delete(static_cast<void*>(node));
+            return;
+        }
+        FreeBlock* block = new (static_cast<void*>(node)) FreeBlock{cache_.head};
+        cache_.head = block;
+        ++cache_.count;
+    }
+    
+    // Deleter handed to the reclaimer
+    static void recycle_retired(void* p) {
+        recycle_node(static_cast<Node*>(p));
+    }
     
     // ===== TAGGED POINTER FOR ABA PREVENTION =====
     // Combines a pointer with a version tag to prevent the ABA problem
-    // ABA Problem: Thread T1 reads A, gets suspended. Thread T2 changes A→B→A.
-    // T1 resumes and CAS succeeds thinking nothing changed, but A is different now.
-    // Solution: Increment tag on every change, so A(tag=1) != A(tag=2)
-    
-    struct TaggedPointer {
-        Node* ptr;        // Actual pointer to the top node
-        uintptr_t tag;    // Version counter, incremented on each modification
-        
-        TaggedPointer() : ptr(nullptr), tag(0) {}
-        TaggedPointer(Node* p, uintptr_t t) : ptr(p), tag(t) {}
-        
-        // Two tagged pointers are equal only if both pointer AND tag match
-        bool operator==(const TaggedPointer& other) const {
-            return ptr == other.ptr && tag == other.tag;
-        }
-    };
+    // (see tagged_pointer.hpp). The layout is whichever one has a lock-free
+    // std::atomic on this target: {ptr, tag} with a double-width CAS, or
+    // 48-bit pointer + 16-bit tag packed into one word.
+    using HeadPointer = TaggedPointer<Node>;
+    static_assert(std::atomic<HeadPointer>::is_always_lock_free,
+                  "LockFreeStack head would fall back to a libatomic lock");
     
     // Atomic head pointer with tag - the core of the lock-free stack
-    std::atomic<TaggedPointer> head;
-    
-    // ===== HELPER FUNCTIONS =====
+    // On its own cache line: every operation hammers it
+    alignas(64) std::atomic<HeadPointer> head;
     
-    // Assign and retrieve a hazard pointer slot for the current thread
-    // Each thread gets a unique slot to claim nodes it's accessing
-    HazardPointer* get_hazard_pointer() {
-        // Thread-local variables to cache thread ID (avoids repeated atomic operations)
-        static thread_local size_t thread_id = 0;
-        static thread_local bool initialized = false;
-        
-        if (!initialized) {
-            // First time this thread calls - assign it a unique ID
-            thread_id = next_thread_id.fetch_add(1);
-            initialized = true;
-        }
-        
-        // Return pointer to this thread's hazard pointer slot
-        return &hazard_pointers[thread_id * HAZARDS_PER_THREAD];
-    }
+    // ===== ELIMINATION BACKOFF =====
+    // Under high contention most head CASes fail, and the stack stops
+    // scaling. But a push and a pop that collide cancel out: the pop can take
+    // the pushed value directly and neither has to touch head.
+    //
+    // After a failed CAS, a push offers its node in a random slot and waits
+    // briefly; a pop whose CAS failed checks a random slot and takes any
+    // offered node. The slot value is itself tagged: every take or withdrawal
+    // bumps the tag, so a pusher can't mistake a new offer of a recycled
+    // address for its own still-waiting one.
+    static constexpr size_t kEliminationSlots = 8;
+    static constexpr int kEliminationSpins = 64;
     
-    // Atomic counter for assigning unique thread IDs
-    static std::atomic<size_t> next_thread_id;
+    struct alignas(64) EliminationSlot {
+        std::atomic<HeadPointer> offer;
+    };
+    std::array<EliminationSlot, kEliminationSlots> elimination_{};
+    bool elimination_enabled_;
+    alignas(64) std::atomic<uint64_t> eliminated_{0};
     
-    // Check if any thread is currently protecting this node via a hazard pointer
-    // Returns true if node is "hazardous" (unsafe to delete)
-    bool is_hazardous(Node* node) {
-        // Scan all hazard pointer slots across all threads
-        for (size_t i = 0; i < MAX_THREADS * HAZARDS_PER_THREAD; ++i) {
-            if (hazard_pointers[i].pointer.load() == node) {
-                return true;  // At least one thread is accessing this node
-            }
-        }
-        return false;  // No thread is protecting this node - safe to delete
+    static size_t random_slot() {
+        // xorshift32, one state per thread
+        thread_local uint32_t state = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state)) | 1u;
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state % kEliminationSlots;
     }
     
-    // Add a popped node to the retired list for later deletion
-    // We can't delete immediately because another thread might still be accessing it
-    void retire_node(Node* node) {
-        // Create a retired node wrapper
-        RetiredNode* retired = new RetiredNode(node);
-        
-        // Add to front of thread-local retired list
-        retired->next = retired_list;
-        retired_list = retired;
-        retired_count++;
-        
-        // Periodically clean up retired nodes to prevent unbounded memory growth
-        if (retired_count >= RETIRED_THRESHOLD) {
-            scan_and_delete();
+    // Push side: offer node, wait for a pop to take it, withdraw on timeout.
+    // Returns true if a pop took it (the push is complete).
+    bool try_eliminate_push(Node* node) {
+        std::atomic<HeadPointer>& slot = elimination_[random_slot()].offer;
+        HeadPointer empty = slot.load(std::memory_order_relaxed);
+        if (empty.ptr()) {
+            return false;   // someone else is waiting here
         }
-    }
-    
-    // Scan the retired list and delete nodes that are no longer protected
-    // This is the garbage collection mechanism for our lock-free structure
-    void scan_and_delete() {
-        RetiredNode* current = retired_list;
-        RetiredNode* prev = nullptr;
-        
-        // Walk through the retired list
-        while (current) {
-            // Check if this node is still being accessed by any thread
-            if (!is_hazardous(current->node)) {
-                // Safe to delete - no thread has a hazard pointer to it
-                Node* to_delete = current->node;
-                RetiredNode* to_free = current;
-                
-                // Remove from retired list
-                if (prev) {
-                    prev->next = current->next;
-                    current = current->next;
-                } else {
-                    retired_list = current->next;
-                    current = retired_list;
-                }
-                
-                // Actually free the memory
-                delete to_delete;      // Delete the stack node
-                delete to_free;        // Delete the retired node wrapper
-                retired_count--;
-            } else {
-                // Still hazardous - keep in retired list and try again later
-                prev = current;
-                current = current->next;
+        HeadPointer offered = empty.next(node);
+        // release: node->data must be visible to the pop that takes it
+        if (!slot.compare_exchange_strong(empty, offered, std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+        for (int i = 0; i < kEliminationSpins; ++i) {
+            if (!(slot.load(std::memory_order_relaxed) == offered)) {
+                break;
             }
+            cpu_relax();
         }
+        // Withdraw - if that fails, a pop took the node in the meantime
+        if (slot.compare_exchange_strong(offered, offered.next(nullptr), std::memory_order_relaxed)) {
+            return false;
+        }
+        eliminated_.fetch_add(1, std::memory_order_relaxed);
+        return true;
     }
     
-public:
-    // Constructor - initialize with empty stack
-    LockFreeStack() {
-        head.store(TaggedPointer(nullptr, 0));
+    // Pop side: take an offered node if there is one. The pusher never touches
+    // the node again once taken, so it can be deleted right away.
+    bool try_eliminate_pop(T& result) {
+        std::atomic<HeadPointer>& slot = elimination_[random_slot()].offer;
+        HeadPointer offered = slot.load(std::memory_order_acquire);
+        if (!offered.ptr() ||
+            !slot.compare_exchange_strong(offered, offered.next(nullptr), std::memory_order_acquire,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+        Node* node = offered.ptr();
+        result = std::move(node->data);
+        recycle_node(node);
+        return true;
     }
     
-    // ===== PUSH OPERATION =====
-    // Thread-safe push operation using compare-and-swap (CAS) with ABA protection
-    // Multiple threads can push concurrently without locks
-    void push(const T& value) {
-        // Allocate new node on heap
-        Node* new_node = new Node(value);
-        
+    // Link the chain top -> ... -> bottom in front of the current head with
+    // one CAS. A single node may also back off into the elimination array.
+    void push_chain(Node* top, Node* bottom) {
         // Load current head with acquire semantics
         // acquire ensures we see all previous writes to nodes in the stack
-        TaggedPointer old_head = head.load(std::memory_order_acquire);
+        HeadPointer old_head = head.load(std::memory_order_acquire);
         
         // Retry loop - keep trying until we successfully update head
         do {
-            // Make new node point to current top of stack
-            new_node->next = old_head.ptr;
+            // Make the chain point to current top of stack
+            bottom->next = old_head.ptr();
             
             // Create new head with incremented tag to prevent ABA problem
             // Even if we pop this node and push it again, the tag will be different
-            TaggedPointer new_head(new_node, old_head.tag + 1);
+            HeadPointer new_head = old_head.next(top);
             
             // Attempt atomic compare-and-swap:
             // - If head still equals old_head, update to new_head and return
             // - If head changed, old_head is updated with current value, retry
-            // release ensures all writes to new_node are visible before head is updated
+            // release ensures all writes to the chain are visible before head is updated
             if (head.compare_exchange_weak(old_head, new_head,
                                           std::memory_order_release,
                                           std::memory_order_acquire)) {
-                return;  // Success! Node is now on the stack
+                return;  // Success! Chain is now on the stack
             }
-            // CAS failed - another thread modified head, old_head is updated, loop again
+            // CAS failed - another thread modified head. Back off into the
+            // elimination array; if no pop shows up, reload head and retry
+            if (elimination_enabled_ && top == bottom && try_eliminate_push(top)) {
+                return;
+            }
+            old_head = head.load(std::memory_order_acquire);
         } while (true);
     }
     
+public:
+    // Constructor - initialize with empty stack
+    // elimination = false makes every operation go through the head CAS
+    explicit LockFreeStack(bool elimination = true) : elimination_enabled_(elimination) {
+        head.store(HeadPointer(nullptr, 0));
+    }
+    
+    // ===== PUSH OPERATION =====
+    // Thread-safe push operation using compare-and-swap (CAS) with ABA protection
+    // Multiple threads can push concurrently without locks
+    void push(const T& value) {
+        Node* node = make_node(value);
+        push_chain(node, node);
+    }
+    
+    // Moves the value into the node instead of copying it
+    void push(T&& value) {
+        Node* node = make_node(std::move(value));
+        push_chain(node, node);
+    }
+    
+    // Push every element of range as if by push() in order (the last element
+    // ends up on top), but publish them with a single CAS on head
+    template<typename Range>
+    void push_bulk(Range&& range) {
+        Node* top = nullptr;
+        Node* bottom = nullptr;
+        for (auto&& value : range) {
+            Node* node = make_node(std::forward<decltype(value)>(value));
+            node->next = top;
+            top = node;
+            if (!bottom) {
+                bottom = node;
+            }
+        }
+        if (top) {
+            push_chain(top, bottom);
+        }
+    }
+    
     // ===== POP OPERATION =====
-    // Thread-safe pop with hazard pointers for safe memory reclamation
+    // Thread-safe pop with deferred reclamation for memory safety
     // Returns true and sets result if pop succeeded, false if stack was empty
     bool pop(T& result) {
-        // Get this thread's hazard pointer slot
-        HazardPointer* hp = get_hazard_pointer();
-        TaggedPointer old_head;
+        // Enter a critical section: with hazard pointers this claims the
+        // thread's slot, with epochs it pins the current epoch
+        typename Reclaimer::Guard guard;
         
         // Retry loop until we successfully pop or determine stack is empty
         do {
-            // Load current head with acquire semantics
-            old_head = head.load(std::memory_order_acquire);
+            // CRITICAL: Protect the top node BEFORE accessing it
+            // This tells other threads "don't delete this node, I'm using it"
+            // (the hazard pointer backend publishes it and re-checks head
+            // until the published pointer is confirmed current)
+            HeadPointer old_head = guard.protect(0, head, [](const HeadPointer& t) { return t.ptr(); });
             
             // Check if stack is empty
-            if (!old_head.ptr) {
-                // Clear any previous hazard pointer and return false
-                hp->pointer.store(nullptr, std::memory_order_release);
+            if (!old_head.ptr()) {
                 return false;
             }
             
-            // CRITICAL: Protect the node with hazard pointer BEFORE accessing it
-            // This tells other threads "don't delete this node, I'm using it"
-            hp->pointer.store(old_head.ptr, std::memory_order_release);
-            
-            // Double-check that head wasn't changed while we set the hazard pointer
-            // This handles the race: T1 loads head, T2 pops and deletes it, T1 sets hazard
-            // Without this check, T1 would protect an already-deleted node
-            TaggedPointer current_head = head.load(std::memory_order_acquire);
-            if (current_head.ptr != old_head.ptr) {
-                // Head changed between load and hazard pointer set - retry
-                continue;
-            }
-            
             // Node is now safely protected - we can access it
-            Node* next = old_head.ptr->next;
+            Node* next = old_head.ptr()->next;
             
             // Create new head pointing to next node, with incremented tag
-            TaggedPointer new_head(next, old_head.tag + 1);
+            HeadPointer new_head = old_head.next(next);
             
             // Attempt to atomically update head to remove top node
             if (head.compare_exchange_weak(old_head, new_head,
                                           std::memory_order_release,
                                           std::memory_order_acquire)) {
                 // Successfully popped! Copy data from node (still protected)
-                result = old_head.ptr->data;
+                // Only the CAS winner touches data, so it can be moved out
+                result = std::move(old_head.ptr()->data);
                 
-                // Clear our hazard pointer - we're done accessing this node
-                hp->pointer.store(nullptr, std::memory_order_release);
+                // We're done accessing this node
+                guard.clear(0);
                 
                 // Retire the node for deferred deletion
-                // Can't delete immediately - other threads might still have hazard pointers to it
-                retire_node(old_head.ptr);
+                // Can't delete immediately - other threads might still be reading it
+                Reclaimer::retire(static_cast<void*>(old_head.ptr()), &recycle_retired);
+                return true;
+            }
+            // CAS failed - another thread modified head. A push may be
+            // backing off right now: take its node instead of retrying
+            if (elimination_enabled_ && try_eliminate_pop(result)) {
                 return true;
             }
-            // CAS failed - another thread modified head, retry
         } while (true);
         
         return false;  // Unreachable, but keeps compiler happy
     }
     
+    // ===== POP ALL =====
+    // Detach the whole stack with one CAS and return its values top first.
+    // Other threads may still be reading nodes they protected before the
+    // detach, so the nodes go through the reclaimer like single pops do.
+    std::vector<T> pop_all() {
+        HeadPointer old_head = head.load(std::memory_order_acquire);
+        while (!head.compare_exchange_weak(old_head, old_head.next(nullptr),
+                                           std::memory_order_acquire,
+                                           std::memory_order_acquire)) {
+        }
+        std::vector<T> values;
+        for (Node* node = old_head.ptr(); node;) {
+            Node* next = node->next;
+            values.push_back(std::move(node->data));
+            Reclaimer::retire(static_cast<void*>(node), &recycle_retired);
+            node = next;
+        }
+        return values;
+    }
+    
     // ===== DESTRUCTOR =====
     // Clean up all remaining nodes in stack and retired lists
     ~LockFreeStack() {
-        // Pop and discard all remaining elements from the stack
-        T dummy;
-        while (pop(dummy)) {}
-        
-        // Attempt to clean up retired nodes normally
-        scan_and_delete();
-        
-        // Force delete any remaining retired nodes
-        // At this point no other threads should be accessing the stack
-        RetiredNode* current = retired_list;
-        while (current) {
-            RetiredNode* next = current->next;
-            delete current->node;      // Delete the stack node
-            delete current;            // Delete the retired node wrapper
-            current = next;
+        // No other thread can be using the stack anymore, so the remaining
+        // nodes can be deleted directly instead of going through retire()
+        Node* node = head.load(std::memory_order_acquire).ptr();
+        while (node) {
+            Node* next = node->next;
+            recycle_node(node);
+            node = next;
         }
+        
+        // Free this thread's retired nodes that nothing protects anymore;
+        // the rest are freed by later passes or when their threads exit
+        Reclaimer::drain();
+    }
+    
+    // Pushes that were matched with a pop in the elimination array
+    uint64_t eliminated() const {
+        return eliminated_.load(std::memory_order_relaxed);
+    }
+    
+    // 16: {ptr, tag} with a double-width CAS, 8: packed 48-bit ptr + 16-bit tag
+    static constexpr size_t head_bytes() {
+        return sizeof(HeadPointer);
     }
 };
 
-// ===== STATIC MEMBER INITIALIZATION =====
-// These must be defined outside the class template
-
-// Global hazard pointer array - shared across all threads
-template<typename T>
-std::array<typename LockFreeStack<T>::HazardPointer, 
-           LockFreeStack<T>::MAX_THREADS * LockFreeStack<T>::HAZARDS_PER_THREAD> 
-LockFreeStack<T>::hazard_pointers;
-
-// Atomic counter for assigning thread IDs
-template<typename T>
-std::atomic<size_t> LockFreeStack<T>::next_thread_id{0};
-
-// Thread-local retired list head - each thread maintains its own
-template<typename T>
-thread_local typename LockFreeStack<T>::RetiredNode* LockFreeStack<T>::retired_list = nullptr;
-
-// Thread-local count of retired nodes
-template<typename T>
-thread_local size_t LockFreeStack<T>::retired_count = 0;
+// ===== BENCHMARK =====
+// push/pop throughput of one backend: each thread alternates push and pop,
+// so every pop retires a node and reclamation runs constantly
+template<typename Reclaimer>
+double push_pop_mops(int threads, int ops_per_thread, bool elimination = true) {
+    LockFreeStack<int, Reclaimer> stack(elimination);
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([&stack, ops_per_thread]() {
+            int v;
+            for (int j = 0; j < ops_per_thread; ++j) {
+                stack.push(j);
+                stack.pop(v);
+            }
+        });
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return 2.0 * threads * ops_per_thread / seconds / 1e6;
+}
 
 // ===== TEST PROGRAM =====
 int main() {
@@ -369,6 +470,117 @@ int main() {
         std::cout << "Stack is now empty (as expected)." << std::endl;
     }
     
+    // ===== TEST 3: Slot recycling =====
+    // 1000 short-lived threads, far more than MAX_THREADS = 128. Each exiting
+    // thread returns its hazard slot, so this never exhausts the slot table.
+    for (int round = 0; round < 50; ++round) {
+        threads.clear();
+        for (int i = 0; i < 20; ++i) {
+            threads.emplace_back([&stack, i]() {
+                stack.push(i);
+                int v;
+                stack.pop(v);
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    std::cout << "1000 short-lived threads done, " << HazardPointers<1>::registered_threads()
+              << " slot(s) still registered." << std::endl;
+    
+    // ===== TEST 4: Reclamation backends =====
+    // Same stack, hazard pointers vs epoch-based reclamation, in million
+    // operations per second (push and pop each count as one)
+    // Epochs skip the per-pop seq_cst publish, but with more threads than
+    // cores a reader preempted inside its critical section holds the epoch
+    // back and garbage piles up until it is rescheduled
+    // The last column turns elimination backoff off (hazard pointers)
+    std::cout << "\nhead: " << LockFreeStack<int>::head_bytes() << "-byte tagged pointer, lock-free\n";
+    std::cout << "push/pop throughput (Mops/s)\n"
+              << std::setw(8) << "threads" << std::setw(18) << HazardPointers<1>::name
+              << std::setw(14) << EpochReclamation<>::name << std::setw(14) << "no elim" << "\n";
+    for (int n : {1, 2, 4, 8}) {
+        const int ops = 200000;
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(1)
+                  << std::setw(18) << push_pop_mops<HazardPointers<1>>(n, ops)
+                  << std::setw(14) << push_pop_mops<EpochReclamation<>>(n, ops)
+                  << std::setw(14) << push_pop_mops<HazardPointers<1>>(n, ops, false) << "\n";
+    }
+    
+    // ===== TEST 5: Elimination under contention =====
+    // Half the threads only push, half only pop: colliding pairs meet in the
+    // elimination array instead of fighting over head
+    // (needs real parallelism: on a single core a backing-off push is
+    // practically never overlapped by a pop, so the count stays near zero)
+    {
+        LockFreeStack<int> contended;
+        const int pairs = 4;
+        const int ops = 100000;
+        threads.clear();
+        for (int i = 0; i < pairs; ++i) {
+            threads.emplace_back([&contended]() {
+                for (int j = 0; j < ops; ++j) {
+                    contended.push(j);
+                }
+            });
+            threads.emplace_back([&contended]() {
+                int v;
+                for (int j = 0; j < ops; ++j) {
+                    while (!contended.pop(v)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        std::cout << pairs * ops << " push/pop pairs across " << 2 * pairs << " threads, "
+                  << contended.eliminated() << " eliminated without touching head" << std::endl;
+    }
+    
+    // ===== TEST 6: Bulk operations and node pooling =====
+    {
+        LockFreeStack<std::string> strings;
+        strings.push_bulk(std::vector<std::string>{"a", "b", "c", "d"});
+        strings.push(std::string("e"));   // moved in, not copied
+        std::cout << "pop_all():";
+        for (const std::string& v : strings.pop_all()) {
+            std::cout << " " << v;
+        }
+        std::cout << " (top first)" << std::endl;
+        
+        // Once the per-thread free lists are warm, push/pop pairs reuse
+        // reclaimed nodes instead of calling operator new
+        LockFreeStack<int> pooled;
+        const int workers = 4;
+        const int ops = 100000;
+        threads.clear();
+        std::atomic<size_t> allocations{0};
+        for (int i = 0; i < workers; ++i) {
+            threads.emplace_back([&pooled, &allocations]() {
+                int v;
+                for (int j = 0; j < 1000; ++j) {   // warm-up
+                    pooled.push(j);
+                    pooled.pop(v);
+                }
+                const size_t before = g_allocations.load();
+                for (int j = 0; j < ops; ++j) {
+                    pooled.push(j);
+                    pooled.pop(v);
+                }
+                allocations += g_allocations.load() - before;
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        std::cout << "steady-state push/pop: " << std::setprecision(4)
+                  << static_cast<double>(allocations.load()) / (workers * ops)
+                  << " allocations per push" << std::endl;
+    }
+    
     // When main() exits, ~LockFreeStack() will clean up any remaining memory
     return 0;
 }
\ No newline at end of file
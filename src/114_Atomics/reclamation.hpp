@@ -0,0 +1,417 @@
+/*
+Safe memory reclamation for lock-free containers (header-only, just #include it).
+Used by lock_free_stack.cpp and lock_free_queue.cpp; any container that
+unlinks nodes with a CAS and must not free them while another thread may
+still be reading them can use it.
+
+Two interchangeable backends, chosen by template parameter:
+
+    HazardPointers<K>   each thread publishes up to K pointers it is about to
+                        dereference; a retired node is freed once no slot
+                        holds it. Bounded garbage, but every protected load
+                        costs a seq_cst store plus a re-check.
+
+    EpochReclamation<>  each thread announces the global epoch while inside a
+                        critical section; a node retired in epoch e is freed
+                        once the epoch has moved to e + 2, i.e. every thread
+                        that could have seen it has left. Reads are plain
+                        loads, so it is much cheaper on read-mostly
+                        structures - but one stalled reader holds back all
+                        reclamation.
+
+Both expose the same interface:
+
+    typename R::Guard guard;                        // enter a critical section
+    auto v = guard.protect(i, atomic_src, get_ptr); // load + protect slot i
+    guard.clear(i);                                 // drop slot i early
+    R::retire(node);                                // free when safe (delete)
+    R::retire(ptr, deleter);                        // ... with a custom deleter
+
+Only one Guard per thread may be alive at a time for HazardPointers (slots
+are per thread); EpochReclamation guards nest.
+
+Thread slots are claimed on first use and returned when the thread exits, so
+programs that keep starting short-lived threads never exhaust MaxThreads.
+Whatever an exiting thread could not free yet is handed to an orphan list
+adopted by the next reclaim pass of some other thread.
+*/
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// One deferred free: the object plus how to destroy it. epoch is only used
+// by EpochReclamation.
+struct RetiredPtr {
+    void* ptr;
+    void (*deleter)(void*);
+    uint64_t epoch;
+
+    void reclaim() const { deleter(ptr); }
+};
+
+template<typename T>
+void default_delete_retired(void* p) {
+    delete static_cast<T*>(p);
+}
+
+// Slot IDs shared out to threads; released IDs are reused by later threads.
+template<size_t MaxThreads>
+class ThreadSlotTable {
+public:
+    size_t acquire() {
+        for (size_t id = 0; id < MaxThreads; ++id) {
+            bool expected = false;
+            if (!in_use_[id].load(std::memory_order_relaxed) &&
+                in_use_[id].compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                // Raise the high-water mark so scans include this slot
+                size_t high = high_water_.load(std::memory_order_relaxed);
+                while (high < id + 1 &&
+                       !high_water_.compare_exchange_weak(high, id + 1, std::memory_order_acq_rel)) {
+                }
+                active_.fetch_add(1, std::memory_order_relaxed);
+                return id;
+            }
+        }
+        throw std::runtime_error("reclamation: more than MaxThreads threads alive at once");
+    }
+
+    void release(size_t id) {
+        in_use_[id].store(false, std::memory_order_release);
+        active_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // One past the highest slot ever claimed: scans never look beyond it
+    size_t high_water() const { return high_water_.load(std::memory_order_acquire); }
+
+    // Threads currently holding a slot
+    size_t active() const { return active_.load(std::memory_order_relaxed); }
+
+private:
+    std::array<std::atomic<bool>, MaxThreads> in_use_{};
+    std::atomic<size_t> high_water_{0};
+    std::atomic<size_t> active_{0};
+};
+
+// Retired objects left behind by exited threads. Only touched on thread exit
+// and when count() says there is work, so the mutex is never on a hot path.
+class OrphanList {
+public:
+    void give(std::vector<RetiredPtr>& retired) {
+        if (retired.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        orphans_.insert(orphans_.end(), retired.begin(), retired.end());
+        retired.clear();
+        count_.store(orphans_.size(), std::memory_order_release);
+    }
+
+    void adopt(std::vector<RetiredPtr>& retired) {
+        if (count_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        retired.insert(retired.end(), orphans_.begin(), orphans_.end());
+        orphans_.clear();
+        count_.store(0, std::memory_order_release);
+    }
+
+    // Static destruction: every thread_local record is gone, nothing can be
+    // reading these anymore
+    ~OrphanList() {
+        for (const RetiredPtr& r : orphans_) {
+            r.reclaim();
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<RetiredPtr> orphans_;
+    std::atomic<size_t> count_{0};
+};
+
+// ===== HAZARD POINTERS =====
+template<size_t HazardsPerThread = 1, size_t MaxThreads = 128>
+class HazardPointers {
+    struct alignas(64) ThreadHazards {
+        std::array<std::atomic<void*>, HazardsPerThread> slot{};
+    };
+
+    // Per-thread record: slot ID, retired objects, scratch for scan snapshots.
+    // The destructor runs when the thread exits.
+    struct ThreadRecord {
+        size_t id = MaxThreads;   // MaxThreads = no slot yet
+        std::vector<RetiredPtr> retired;
+        std::vector<void*> snapshot;
+
+        ~ThreadRecord() {
+            if (id == MaxThreads) {
+                return;
+            }
+            for (auto& s : hazards_[id].slot) {
+                s.store(nullptr, std::memory_order_release);
+            }
+            scan(*this);
+            orphans_.give(retired);
+            slots_.release(id);
+        }
+    };
+
+    static ThreadRecord& record() {
+        static thread_local ThreadRecord rec;
+        if (rec.id == MaxThreads) {
+            rec.id = slots_.acquire();
+        }
+        return rec;
+    }
+
+    // Lower bound for the reclamation threshold; the real threshold is twice
+    // the hazard slots in use, so each scan (O(H log H)) is paid for by at
+    // least 2H retirements.
+    static constexpr size_t kMinRetired = 10;
+
+    static size_t threshold() {
+        return std::max(kMinRetired, 2 * slots_.active() * HazardsPerThread);
+    }
+
+    // Snapshot the non-null hazard slots once, sort, then binary-search it for
+    // each retired object: O(H log H + R log H) instead of O(R x H) loads.
+    static void scan(ThreadRecord& rec) {
+        orphans_.adopt(rec.retired);
+
+        std::vector<void*>& snapshot = rec.snapshot;
+        snapshot.clear();
+        const size_t threads = slots_.high_water();
+        for (size_t t = 0; t < threads; ++t) {
+            for (auto& s : hazards_[t].slot) {
+                if (void* p = s.load(std::memory_order_seq_cst)) {
+                    snapshot.push_back(p);
+                }
+            }
+        }
+        std::sort(snapshot.begin(), snapshot.end());
+
+        auto still_hazardous = [&snapshot](const RetiredPtr& r) {
+            return std::binary_search(snapshot.begin(), snapshot.end(), r.ptr);
+        };
+        auto keep_end = std::partition(rec.retired.begin(), rec.retired.end(), still_hazardous);
+        for (auto it = keep_end; it != rec.retired.end(); ++it) {
+            it->reclaim();
+        }
+        rec.retired.erase(keep_end, rec.retired.end());
+    }
+
+    static inline std::array<ThreadHazards, MaxThreads> hazards_{};
+    static inline ThreadSlotTable<MaxThreads> slots_;
+    static inline OrphanList orphans_;
+
+public:
+    static constexpr size_t hazards_per_thread = HazardsPerThread;
+    static constexpr const char* name = "hazard pointers";
+
+    class Guard {
+    public:
+        Guard() : slots_(hazards_[record().id].slot) {}
+        ~Guard() {
+            for (auto& s : slots_) {
+                s.store(nullptr, std::memory_order_release);
+            }
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        // Load src and publish get(value) in slot i until the published
+        // pointer is confirmed to still be current. seq_cst: the slot store
+        // must be ordered before the re-load (StoreLoad), which
+        // release/acquire alone does not give.
+        template<typename Atomic, typename GetPtr>
+        auto protect(size_t i, const Atomic& src, GetPtr get) {
+            auto value = src.load(std::memory_order_acquire);
+            for (;;) {
+                slots_[i].store(static_cast<void*>(get(value)), std::memory_order_seq_cst);
+                auto current = src.load(std::memory_order_seq_cst);
+                if (get(current) == get(value)) {
+                    return current;
+                }
+                value = current;
+            }
+        }
+
+        template<typename P>
+        P* protect(size_t i, const std::atomic<P*>& src) {
+            return protect(i, src, [](P* p) { return p; });
+        }
+
+        void clear(size_t i) { slots_[i].store(nullptr, std::memory_order_release); }
+
+    private:
+        std::array<std::atomic<void*>, HazardsPerThread>& slots_;
+    };
+
+    static void retire(void* p, void (*deleter)(void*)) {
+        ThreadRecord& rec = record();
+        rec.retired.push_back(RetiredPtr{p, deleter, 0});
+        if (rec.retired.size() >= threshold()) {
+            scan(rec);
+        }
+    }
+
+    template<typename T>
+    static void retire(T* p) {
+        retire(p, &default_delete_retired<T>);
+    }
+
+    // Free whatever the calling thread can free right now
+    static void drain() { scan(record()); }
+
+    static size_t registered_threads() { return slots_.active(); }
+};
+
+// ===== EPOCH-BASED RECLAMATION =====
+template<size_t MaxThreads = 128>
+class EpochReclamation {
+    // Announced state: (epoch << 1) | 1 while inside a critical section, 0 outside
+    struct alignas(64) Announcement {
+        std::atomic<uint64_t> state{0};
+    };
+
+    struct ThreadRecord {
+        size_t id = MaxThreads;
+        unsigned depth = 0;   // guard nesting
+        size_t since_attempt = 0;   // retirements since the last advance attempt
+        std::vector<RetiredPtr> retired;
+
+        ~ThreadRecord() {
+            if (id == MaxThreads) {
+                return;
+            }
+            announce_[id].state.store(0, std::memory_order_release);
+            // Two advances free everything retired so far if no one else is
+            // inside a critical section
+            for (int i = 0; i < 2; ++i) {
+                try_advance();
+            }
+            reclaim(*this);
+            orphans_.give(retired);
+            slots_.release(id);
+        }
+    };
+
+    static ThreadRecord& record() {
+        static thread_local ThreadRecord rec;
+        if (rec.id == MaxThreads) {
+            rec.id = slots_.acquire();
+        }
+        return rec;
+    }
+
+    // Retirements between advance attempts; an attempt reads every
+    // announcement, so it scales with the threads in use like the HP scan
+    static constexpr size_t kMinRetired = 64;
+
+    static size_t threshold() {
+        return std::max(kMinRetired, 2 * slots_.active());
+    }
+
+    // The epoch can move on only when every thread inside a critical section
+    // has announced the current one
+    static void try_advance() {
+        uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+        const size_t threads = slots_.high_water();
+        for (size_t t = 0; t < threads; ++t) {
+            const uint64_t s = announce_[t].state.load(std::memory_order_seq_cst);
+            if ((s & 1) && (s >> 1) != epoch) {
+                return;
+            }
+        }
+        global_epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+    }
+
+    // Retired in epoch e => unreachable to anyone who entered in e + 1 or
+    // later; once the global epoch is e + 2 no one from e can still be inside
+    static void reclaim(ThreadRecord& rec) {
+        orphans_.adopt(rec.retired);
+        const uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+        auto keep_end = std::partition(rec.retired.begin(), rec.retired.end(),
+                                       [epoch](const RetiredPtr& r) { return r.epoch + 2 > epoch; });
+        for (auto it = keep_end; it != rec.retired.end(); ++it) {
+            it->reclaim();
+        }
+        rec.retired.erase(keep_end, rec.retired.end());
+    }
+
+    static inline std::array<Announcement, MaxThreads> announce_{};
+    alignas(64) static inline std::atomic<uint64_t> global_epoch_{0};
+    static inline ThreadSlotTable<MaxThreads> slots_;
+    static inline OrphanList orphans_;
+
+public:
+    static constexpr const char* name = "epoch-based";
+
+    class Guard {
+    public:
+        Guard() : rec_(record()) {
+            if (rec_.depth++ == 0) {
+                // seq_cst store, then every pointer load of the critical
+                // section comes after it in the single total order
+                const uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+                announce_[rec_.id].state.store((epoch << 1) | 1, std::memory_order_seq_cst);
+            }
+        }
+        ~Guard() {
+            if (--rec_.depth == 0) {
+                announce_[rec_.id].state.store(0, std::memory_order_release);
+            }
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        // The pinned epoch already protects everything reachable: plain load
+        template<typename Atomic, typename GetPtr>
+        auto protect(size_t, const Atomic& src, GetPtr) {
+            return src.load(std::memory_order_acquire);
+        }
+
+        template<typename P>
+        P* protect(size_t, const std::atomic<P*>& src) {
+            return src.load(std::memory_order_acquire);
+        }
+
+        void clear(size_t) {}
+
+    private:
+        ThreadRecord& rec_;
+    };
+
+    static void retire(void* p, void (*deleter)(void*)) {
+        ThreadRecord& rec = record();
+        rec.retired.push_back(RetiredPtr{p, deleter, global_epoch_.load(std::memory_order_seq_cst)});
+        // Count retirements rather than testing the list size: while a
+        // preempted reader holds the epoch back the list only grows, and
+        // re-partitioning it on every retire would go quadratic
+        if (++rec.since_attempt >= threshold()) {
+            rec.since_attempt = 0;
+            try_advance();
+            reclaim(rec);
+        }
+    }
+
+    template<typename T>
+    static void retire(T* p) {
+        retire(p, &default_delete_retired<T>);
+    }
+
+    static void drain() {
+        try_advance();
+        reclaim(record());
+    }
+
+    static size_t registered_threads() { return slots_.active(); }
+};
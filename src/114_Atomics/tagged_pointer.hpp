@@ -0,0 +1,91 @@
+/*
+Pointer + version tag for ABA-safe CAS (header-only, just #include it).
+Used by lock_free_stack.cpp and lock_free_queue.cpp.
+
+ABA Problem: Thread T1 reads A, gets suspended. Thread T2 changes A -> B -> A.
+T1 resumes and its CAS succeeds thinking nothing changed, but A is different
+now. Bumping a tag on every change makes A(tag=1) != A(tag=2).
+
+Two layouts:
+
+    WideTaggedPointer<P>    { P* ptr; uintptr_t tag; } - 16 bytes on 64-bit
+                            targets. std::atomic of it is lock-free only if the
+                            compiler emits cmpxchg16b (x86-64 with -mcx16) or
+                            casp (AArch64 LSE); otherwise libatomic silently
+                            falls back to a global lock table. GCC always
+                            routes 16-byte atomics through libatomic, even
+                            with -mcx16, so it never reports them as
+                            always-lock-free.
+
+    PackedTaggedPointer<P>  one uint64_t: 48-bit pointer, 16-bit tag. A plain
+                            8-byte CAS, lock-free everywhere we ship.
+                            x86-64 and AArch64 user-space addresses fit in 48
+                            bits (47 with 4-level paging). The tag wraps after
+                            65536 changes, so it narrows the ABA window rather
+                            than closing it; pair it with hazard pointers or
+                            epochs, which stop a node from being reused while
+                            someone still holds it.
+
+TaggedPointer<P> picks the wide layout when it is lock-free on this target
+and the packed one otherwise, and static_asserts that the result is.
+*/
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+template<typename P>
+struct WideTaggedPointer {
+    P* p = nullptr;
+    uintptr_t t = 0;
+
+    WideTaggedPointer() = default;
+    WideTaggedPointer(P* ptr, uintptr_t tag) : p(ptr), t(tag) {}
+
+    P* ptr() const { return p; }
+    uintptr_t tag() const { return t; }
+
+    // Same tagged pointer moved on to a new target
+    WideTaggedPointer next(P* ptr) const { return WideTaggedPointer(ptr, t + 1); }
+
+    // Two tagged pointers are equal only if both pointer AND tag match
+    bool operator==(const WideTaggedPointer& other) const {
+        return p == other.p && t == other.t;
+    }
+};
+
+template<typename P>
+class PackedTaggedPointer {
+public:
+    static constexpr unsigned kPointerBits = 48;
+    static constexpr uint64_t kPointerMask = (uint64_t{1} << kPointerBits) - 1;
+
+    PackedTaggedPointer() = default;
+    PackedTaggedPointer(P* ptr, uint64_t tag)
+        : bits_((static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr)) & kPointerMask) |
+                (tag << kPointerBits)) {
+        assert((static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr)) & ~kPointerMask) == 0 &&
+               "pointer does not fit in 48 bits");
+    }
+
+    P* ptr() const { return reinterpret_cast<P*>(static_cast<uintptr_t>(bits_ & kPointerMask)); }
+    uint64_t tag() const { return bits_ >> kPointerBits; }
+
+    // The tag wraps modulo 2^16 by shifting out of the top of the word
+    PackedTaggedPointer next(P* ptr) const { return PackedTaggedPointer(ptr, tag() + 1); }
+
+    bool operator==(const PackedTaggedPointer& other) const { return bits_ == other.bits_; }
+
+private:
+    uint64_t bits_ = 0;
+};
+
+template<typename P>
+using TaggedPointer = std::conditional_t<std::atomic<WideTaggedPointer<P>>::is_always_lock_free,
+                                         WideTaggedPointer<P>,
+                                         PackedTaggedPointer<P>>;
+
+static_assert(std::atomic<TaggedPointer<void>>::is_always_lock_free,
+              "no lock-free tagged pointer layout on this target");
@@ -2,6 +2,10 @@
 g++ -pthread --std=c++20 arrive_and_wait_separately.cpp -o app
 */
 
+// Part 2 uses the PhaseTeam helper from split_phase.hpp: the same
+// arrive / work / wait split in a solver loop, plus arrive_and_drop for
+// workers that converge early.
+
 #include <iostream>
 #include <thread>
 #include <barrier>
@@ -9,6 +13,8 @@ g++ -pthread --std=c++20 arrive_and_wait_separately.cpp -o app
 #include <chrono>
 #include <mutex>
 
+#include "split_phase.hpp"
+
 std::mutex cout_mutex;
 
 void worker_with_async_arrival(int id, std::barrier<>& bar) {
@@ -49,6 +55,25 @@ void worker_with_async_arrival(int id, std::barrier<>& bar) {
     }    
 }
 
+// Solver worker: boundary work, arrive, interior work, wait - and leave the
+// team once its region has converged, so the rest keep going without it
+void solver_worker(int id, int converges_after, PhaseTeam<>& team) {
+    PhaseTeam<>::Member member(team);
+    
+    for (int iter = 0; ; ++iter) {
+        if (iter == converges_after) {
+            member.leave();
+            std::lock_guard<std::mutex> lock(cout_mutex);
+            std::cout << "Solver " << id << " converged after " << iter << " iterations, dropped out\n";
+            return;
+        }
+        member.step(
+            [&] { std::this_thread::sleep_for(std::chrono::milliseconds(5)); },        // boundary
+            [&] { std::this_thread::sleep_for(std::chrono::milliseconds(10 + 5 * id)); } // interior
+        );
+    }
+}
+
 int main() {
     const int num_threads = 3;
     std::barrier bar(num_threads);
@@ -62,5 +87,18 @@ int main() {
         t.join();
     }
     
+    // ===== Split-phase solver loop with dynamic membership =====
+    std::cout << "\n";
+    const int solvers = 4;
+    PhaseTeam<> team(solvers);
+    threads.clear();
+    for (int i = 0; i < solvers; ++i) {
+        threads.emplace_back(solver_worker, i, 3 + 2 * i, std::ref(team));
+    }
+    
+    for (auto& t : threads) {
+        t.join();
+    }
+    
     return 0;
 }
\ No newline at end of file
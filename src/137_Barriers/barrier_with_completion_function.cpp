@@ -1,5 +1,5 @@
 /*
-g++ -pthread --std=c++20 barrier_with_completion_function.cpp -o app
+g++ -pthread --std=c++20 -O3 barrier_with_completion_function.cpp -o app
 */
 
 #include <iostream>
@@ -8,12 +8,19 @@ g++ -pthread --std=c++20 barrier_with_completion_function.cpp -o app
 #include <barrier>
 #include <atomic>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "split_phase.hpp"
+#include "thread_team.hpp"
 
 class IterativeSimulation {
 private:
     std::atomic<int> iteration{0};
     std::vector<double> current_state;
     std::vector<double> next_state;
+    bool verbose = true;
     
     // Completion function runs once when all threads arrive
     auto make_completion_function() {
@@ -21,14 +28,79 @@ private:
             // Swap buffers
             current_state.swap(next_state);
             iteration++;
-            std::cout << "=== Iteration " << iteration << " completed ===\n";
+            if (verbose) {
+                std::cout << "=== Iteration " << iteration << " completed ===\n";
+            }
         };
     }
     
+    // One time step of the stencil on a contiguous scratch buffer, cells
+    // [lo, hi). No bounds checks in the loop, so it vectorizes; the
+    // evaluation order matches run_simulation exactly.
+    static void stencil_step(const double* __restrict in, double* __restrict out, ptrdiff_t lo, ptrdiff_t hi) {
+        for (ptrdiff_t j = lo; j < hi; ++j) {
+            out[j] = in[j] * 0.9 + in[j - 1] * 0.05 + in[j + 1] * 0.05;
+        }
+    }
+    
+    // Advance one tile [tile_start, tile_end) by `steps` time steps in
+    // thread-local scratch (a, b), reading current_state and writing the
+    // result to next_state.
+    //
+    // Overlapping halos: the tile is loaded with `steps` extra cells on each
+    // side. Each step the valid region shrinks by one cell per side, so after
+    // `steps` steps exactly the tile itself is correct - without exchanging
+    // data with the neighbouring tiles in between. The price is recomputing
+    // 2 * steps halo cells per step, small next to the tile size.
+    //
+    // Outside the array the original treats neighbours as 0; here those
+    // cells are zero-padded and re-zeroed after every step.
+    void advance_tile(size_t tile_start, size_t tile_end, int steps,
+                      std::vector<double>& a, std::vector<double>& b) {
+        const ptrdiff_t n = static_cast<ptrdiff_t>(current_state.size());
+        const ptrdiff_t lo = static_cast<ptrdiff_t>(tile_start) - steps;
+        const ptrdiff_t width = static_cast<ptrdiff_t>(tile_end - tile_start) + 2 * steps;
+        // Scratch cells [pad_lo, pad_hi) map to real array cells
+        const ptrdiff_t pad_lo = std::max<ptrdiff_t>(0, -lo);
+        const ptrdiff_t pad_hi = std::min(width, n - lo);
+        
+        std::fill(a.begin(), a.begin() + pad_lo, 0.0);
+        std::copy(current_state.begin() + (lo + pad_lo), current_state.begin() + (lo + pad_hi), a.begin() + pad_lo);
+        std::fill(a.begin() + pad_hi, a.begin() + width, 0.0);
+        
+        double* in = a.data();
+        double* out = b.data();
+        for (int s = 0; s < steps; ++s) {
+            const ptrdiff_t from = 1 + s;
+            const ptrdiff_t to = width - 1 - s;
+            stencil_step(in, out, from, to);
+            // Padding outside the array stays 0
+            for (ptrdiff_t j = from; j < std::min(to, pad_lo); ++j) {
+                out[j] = 0.0;
+            }
+            for (ptrdiff_t j = std::max(from, pad_hi); j < to; ++j) {
+                out[j] = 0.0;
+            }
+            std::swap(in, out);
+        }
+        std::copy(in + steps, in + steps + static_cast<ptrdiff_t>(tile_end - tile_start),
+                  next_state.begin() + static_cast<ptrdiff_t>(tile_start));
+    }
+    
 public:
     IterativeSimulation(size_t size) 
         : current_state(size, 0.0), next_state(size, 0.0) {}
     
+    // Start over from the given state (must have the simulation's size)
+    void reset(const std::vector<double>& initial) {
+        current_state = initial;
+        iteration = 0;
+    }
+    
+    void set_verbose(bool on) { verbose = on; }
+    const std::vector<double>& state() const { return current_state; }
+    int iterations_done() const { return iteration.load(); }
+    
     void run_simulation(int num_threads, int max_iterations) {
         // Barrier with completion function
         std::barrier sync_point(num_threads, make_completion_function());
@@ -62,11 +134,265 @@ public:
             t.join();
         }
     }
+    
+    // Same computation on a persistent ThreadTeam: no threads are started
+    // and no barrier is built per call, which dominates when the solver
+    // runs many short simulations. team.sync() takes the completion the
+    // std::barrier above was built with.
+    void run_simulation(ThreadTeam& team, int max_iterations) {
+        auto completion = make_completion_function();
+        team.run([&](int tid, int num_threads) {
+            const size_t chunk_size = current_state.size() / num_threads;
+            const size_t start = tid * chunk_size;
+            const size_t end = (tid == num_threads - 1)
+                ? current_state.size()
+                : start + chunk_size;
+            
+            for (int iter = 0; iter < max_iterations; ++iter) {
+                for (size_t i = start; i < end; ++i) {
+                    next_state[i] = current_state[i] * 0.9 + 
+                                   (i > 0 ? current_state[i-1] * 0.05 : 0) +
+                                   (i < current_state.size()-1 ? current_state[i+1] * 0.05 : 0);
+                }
+                team.sync(completion);
+            }
+        });
+    }
+    
+    // Cache-blocked, temporally tiled engine - same results as
+    // run_simulation, bit for bit.
+    //
+    // run_simulation streams the whole array through memory once per step
+    // and synchronizes all threads every step. Here each thread walks its
+    // chunk in cache-sized tiles and advances each tile by steps_per_tile
+    // steps while it is hot in L1/L2 (see advance_tile), so for arrays much
+    // bigger than the caches memory traffic drops by about steps_per_tile x.
+    // The barrier runs once per band of steps_per_tile steps instead of once
+    // per step.
+    void run_simulation_tiled(int num_threads, int max_iterations,
+                              int steps_per_tile = 8, size_t tile_size = 4096) {
+        // The completion function swaps once per band and counts its steps
+        int band_steps = 0;
+        auto completion = [this, &band_steps]() noexcept {
+            current_state.swap(next_state);
+            iteration += band_steps;
+            if (verbose) {
+                std::cout << "=== Iteration " << iteration << " completed ===\n";
+            }
+        };
+        std::barrier sync_point(num_threads, completion);
+        
+        std::vector<std::thread> threads;
+        const size_t chunk_size = current_state.size() / num_threads;
+        
+        for (int tid = 0; tid < num_threads; ++tid) {
+            threads.emplace_back([this, tid, num_threads, chunk_size, max_iterations,
+                                  steps_per_tile, tile_size, &band_steps, &sync_point]() {
+                const size_t start = tid * chunk_size;
+                const size_t end = (tid == num_threads - 1) 
+                    ? current_state.size() 
+                    : start + chunk_size;
+                std::vector<double> a(tile_size + 2 * steps_per_tile);
+                std::vector<double> b(a.size());
+                
+                for (int done = 0; done < max_iterations;) {
+                    const int steps = std::min(steps_per_tile, max_iterations - done);
+                    for (size_t t = start; t < end; t += tile_size) {
+                        advance_tile(t, std::min(end, t + tile_size), steps, a, b);
+                    }
+                    if (tid == 0) {
+                        band_steps = steps;   // read by the completion, after every thread arrived
+                    }
+                    sync_point.arrive_and_wait();
+                    done += steps;
+                }
+            });
+        }
+        
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    
+    // Split-phase engine (split_phase.hpp) - same results as run_simulation,
+    // bit for bit.
+    //
+    // The neighbouring chunks only ever read a thread's two edge cells. So
+    // each step a thread computes those first, arrives, computes its
+    // interior while the slower threads catch up and only then waits: the
+    // barrier stall overlaps with interior work. With split = false the
+    // same code does the whole chunk and then arrives and waits, as
+    // run_simulation does - the baseline for the stall time.
+    //
+    // The completion function runs while other threads may still be writing
+    // their interiors, so it must not swap the buffers; step s reads buffer
+    // s % 2 and writes the other one instead.
+    //
+    // Returns the time all threads together spent blocked in the barrier.
+    std::chrono::nanoseconds run_simulation_split_phase(int num_threads, int max_iterations,
+                                                        bool split = true) {
+        auto completion = [this]() noexcept {
+            iteration++;
+            if (verbose) {
+                std::cout << "=== Iteration " << iteration << " completed ===\n";
+            }
+        };
+        PhaseTeam<decltype(completion)> team(num_threads, completion);
+        std::vector<std::chrono::nanoseconds> stalls(num_threads);
+        
+        std::vector<std::thread> threads;
+        const size_t n = current_state.size();
+        const size_t chunk_size = n / num_threads;
+        std::vector<double>* buffers[2] = {&current_state, &next_state};
+        
+        for (int tid = 0; tid < num_threads; ++tid) {
+            threads.emplace_back([&, tid]() {
+                const size_t start = tid * chunk_size;
+                const size_t end = (tid == num_threads - 1) ? n : start + chunk_size;
+                decltype(team)::Member member(team);
+                
+                for (int iter = 0; iter < max_iterations; ++iter) {
+                    const std::vector<double>& in = *buffers[iter % 2];
+                    std::vector<double>& out = *buffers[(iter + 1) % 2];
+                    auto cell = [&](size_t i) {
+                        out[i] = in[i] * 0.9 +
+                                 (i > 0 ? in[i-1] * 0.05 : 0) +
+                                 (i < n - 1 ? in[i+1] * 0.05 : 0);
+                    };
+                    auto boundary = [&] {
+                        cell(start);
+                        if (end - 1 > start) {
+                            cell(end - 1);
+                        }
+                    };
+                    auto interior = [&] {
+                        for (size_t i = start + 1; i + 1 < end; ++i) {
+                            cell(i);
+                        }
+                    };
+                    
+                    if (split) {
+                        member.step(boundary, interior);
+                    } else {
+                        boundary();
+                        interior();
+                        member.arrive();
+                        member.wait();
+                    }
+                }
+                stalls[tid] = member.stall_time();
+            });
+        }
+        
+        for (auto& t : threads) {
+            t.join();
+        }
+        // After an odd number of steps the newest state is in next_state
+        if (max_iterations % 2 != 0) {
+            current_state.swap(next_state);
+        }
+        
+        std::chrono::nanoseconds total{0};
+        for (auto s : stalls) {
+            total += s;
+        }
+        return total;
+    }
 };
 
 int main() {
     IterativeSimulation sim(1000);
     sim.run_simulation(4, 5);
     std::cout << "Simulation complete\n";
+    
+    // ===== Many short simulations: fresh threads vs a persistent team =====
+    {
+        const int runs = 2000;
+        IterativeSimulation small(1000);
+        small.set_verbose(false);
+        std::vector<double> small_initial(1000, 1.0);
+        small_initial[500] = 100.0;
+        auto time_runs = [&](auto&& run) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int r = 0; r < runs; ++r) {
+                small.reset(small_initial);
+                run();
+            }
+            return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / runs;
+        };
+        const double fresh = time_runs([&] { small.run_simulation(4, 5); });
+        const std::vector<double> fresh_state = small.state();
+        ThreadTeam team(4);
+        const double persistent = time_runs([&] { small.run_simulation(team, 5); });
+        std::cout << "\n" << runs << " runs of 1000 cells x 5 steps, 4 threads: new threads "
+                  << fresh << " us per run, ThreadTeam " << persistent << " us per run ("
+                  << fresh / persistent << "x" << (small.state() == fresh_state ? "" : ", MISMATCH") << ")\n";
+    }
+    
+    // ===== Per-step barrier vs temporal tiling =====
+    // 4M cells (2 x 32 MiB buffers) - far bigger than L2
+    const size_t cells = size_t{4} << 20;
+    const int steps = 64;
+    const int threads = 4;
+    std::vector<double> initial(cells);
+    for (size_t i = 0; i < cells; ++i) {
+        initial[i] = std::sin(static_cast<double>(i) * 0.001) + 1.0;
+    }
+    
+    IterativeSimulation big(cells);
+    big.set_verbose(false);
+    
+    auto time_run = [&](auto&& run) {
+        big.reset(initial);
+        auto t0 = std::chrono::steady_clock::now();
+        run();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    };
+    
+    const double per_step = time_run([&] { big.run_simulation(threads, steps); });
+    const std::vector<double> reference = big.state();
+    std::cout << "\n" << cells << " cells, " << steps << " steps, " << threads << " threads\n";
+    std::cout << "  per-step barrier   " << steps / per_step << " steps/s\n";
+    
+    for (int k : {4, 8, 16}) {
+        const double tiled = time_run([&] { big.run_simulation_tiled(threads, steps, k); });
+        double max_diff = 0.0;
+        for (size_t i = 0; i < cells; ++i) {
+            max_diff = std::max(max_diff, std::abs(big.state()[i] - reference[i]));
+        }
+        std::cout << "  tiled, " << k << " steps/tile" << (k < 10 ? " " : "") << "  " << steps / tiled
+                  << " steps/s (" << per_step / tiled << "x, max diff " << max_diff << ", "
+                  << big.iterations_done() << " iterations)\n";
+    }
+    
+    // ===== Barrier stall: arrive_and_wait vs split-phase =====
+    // Smaller steps, so the per-step stall is a noticeable share of the work.
+    // The overlap needs a core per thread: with fewer cores than threads the
+    // "stall" is mostly waiting for a time slice and both modes look alike.
+    IterativeSimulation medium(size_t{1} << 16);
+    medium.set_verbose(false);
+    std::vector<double> medium_initial(medium.state().size());
+    for (size_t i = 0; i < medium_initial.size(); ++i) {
+        medium_initial[i] = std::sin(static_cast<double>(i) * 0.01) + 1.0;
+    }
+    const int medium_steps = 2000;
+    
+    medium.reset(medium_initial);
+    medium.run_simulation(threads, medium_steps);
+    const std::vector<double> medium_reference = medium.state();
+    
+    std::cout << "\n" << medium_initial.size() << " cells, " << medium_steps << " steps, "
+              << threads << " threads (" << std::thread::hardware_concurrency() << " hardware threads)\n";
+    for (bool split : {false, true}) {
+        medium.reset(medium_initial);
+        auto t0 = std::chrono::steady_clock::now();
+        const auto stall = medium.run_simulation_split_phase(threads, medium_steps, split);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        const bool same = medium.state() == medium_reference;
+        std::cout << "  " << (split ? "split-phase      " : "arrive_and_wait  ")
+                  << medium_steps / seconds << " steps/s, stall "
+                  << std::chrono::duration<double, std::milli>(stall).count() / threads
+                  << " ms per thread" << (same ? "" : " (MISMATCH)") << "\n";
+    }
     return 0;
 }
\ No newline at end of file
@@ -7,6 +7,17 @@ g++ -pthread --std=c++20 multi_stage_pipeline_processing.cpp -o app
 #include <thread>
 #include <barrier>
 #include <array>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <optional>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <string>
+#include <stdexcept>
+
+#include "thread_team.hpp"
 
 struct DataBatch {
     std::vector<int> values;
@@ -62,6 +73,263 @@ void pipeline_worker(int stage, int thread_id,
     }
 }
 
+// ===== Streaming pipeline mode =====
+// pipeline_worker above runs the stages in lockstep: every batch must finish
+// stage N before any batch starts stage N+1, so the stages never overlap
+// and each batch's values have gone cold in cache by the time the next
+// stage touches them.
+//
+// Here the stages run concurrently, connected by bounded queues of batch
+// handles (indices into the batch vector). A batch flows through all three
+// stages while still warm. When a downstream stage falls behind, its input
+// queue fills and push() blocks, so backpressure propagates upstream
+// instead of letting queues grow without bound.
+
+// Bounded blocking queue with occupancy statistics
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+    
+    // Blocks while full (backpressure)
+    void push(T value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (items_.size() >= capacity_) {
+            ++full_waits_;
+            not_full_.wait(lock, [this] { return items_.size() < capacity_; });
+        }
+        items_.push_back(std::move(value));
+        occupancy_sum_ += items_.size();
+        max_occupancy_ = std::max(max_occupancy_, items_.size());
+        ++pushes_;
+        not_empty_.notify_one();
+    }
+    
+    // Blocks while empty; nullopt once closed and drained
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (items_.empty() && !closed_) {
+            ++empty_waits_;
+            not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        }
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        T value = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return value;
+    }
+    
+    // No more pushes; wakes every consumer once the queue is drained
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+    }
+    
+    struct Stats {
+        size_t capacity;
+        double mean_occupancy;   // queue length right after each push
+        size_t max_occupancy;
+        size_t full_waits;       // producer blocked: downstream is the bottleneck
+        size_t empty_waits;      // consumer starved: upstream is the bottleneck
+    };
+    
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return Stats{capacity_, pushes_ ? static_cast<double>(occupancy_sum_) / pushes_ : 0.0,
+                     max_occupancy_, full_waits_, empty_waits_};
+    }
+    
+private:
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    size_t pushes_ = 0;
+    size_t occupancy_sum_ = 0;
+    size_t max_occupancy_ = 0;
+    size_t full_waits_ = 0;
+    size_t empty_waits_ = 0;
+};
+
+struct StageStats {
+    std::atomic<size_t> batches{0};
+    std::atomic<long long> busy_ns{0};   // time spent on batches, all threads of the stage
+};
+
+struct PipelineConfig {
+    std::array<int, 3> threads_per_stage{1, 1, 1};   // generate, transform, validate
+    size_t queue_capacity = 8;
+};
+
+// Same per-batch work as pipeline_worker, one function per stage
+void generate_batch(DataBatch& batch, int index) {
+    batch.values.resize(100);
+    for (auto& v : batch.values) {
+        v = index * 100;
+    }
+}
+
+void transform_batch(DataBatch& batch) {
+    for (auto& v : batch.values) {
+        v = v * 2 + 1;
+    }
+}
+
+void validate_batch(DataBatch& batch) {
+    bool valid = true;
+    for (const auto& v : batch.values) {
+        if (v < 0) valid = false;
+    }
+    batch.processed = valid;
+}
+
+// ===== Lockstep stages on a persistent team =====
+// The lockstep mode again, quiet, one stage after the other with a barrier
+// in between. For a handful of small batches starting the threads costs
+// more than the stages, so a caller that runs the pipeline over and over
+// keeps a ThreadTeam instead.
+void lockstep_stages(int thread_id, int num_threads, std::vector<DataBatch>& batches, auto&& sync) {
+    const size_t n = batches.size();
+    const size_t start = n * thread_id / num_threads;
+    const size_t end = n * (thread_id + 1) / num_threads;
+    for (size_t i = start; i < end; ++i) {
+        generate_batch(batches[i], static_cast<int>(i));
+    }
+    sync();
+    for (size_t i = start; i < end; ++i) {
+        transform_batch(batches[i]);
+    }
+    sync();
+    for (size_t i = start; i < end; ++i) {
+        validate_batch(batches[i]);
+    }
+}
+
+void run_lockstep(std::vector<DataBatch>& batches, int num_threads) {
+    std::barrier<> stage_barrier(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            lockstep_stages(t, num_threads, batches, [&] { stage_barrier.arrive_and_wait(); });
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+void run_lockstep(ThreadTeam& team, std::vector<DataBatch>& batches) {
+    team.run([&](int t, int num_threads) { lockstep_stages(t, num_threads, batches, [&] { team.sync(); }); });
+}
+
+// Runs the three stages concurrently; returns the wall time in seconds and
+// prints per-stage throughput and queue occupancy.
+// Throws std::invalid_argument for a stage without threads or a zero queue
+// capacity: either would leave the stages around it blocked forever
+double run_streaming_pipeline(std::vector<DataBatch>& batches, const PipelineConfig& config, bool report = true) {
+    for (int threads : config.threads_per_stage) {
+        if (threads < 1) {
+            throw std::invalid_argument("run_streaming_pipeline: every stage needs at least one thread");
+        }
+    }
+    if (config.queue_capacity == 0) {
+        throw std::invalid_argument("run_streaming_pipeline: queue capacity must be at least 1");
+    }
+    using Clock = std::chrono::steady_clock;
+    BoundedQueue<size_t> generated(config.queue_capacity);
+    BoundedQueue<size_t> transformed(config.queue_capacity);
+    std::array<StageStats, 3> stats;
+    std::array<std::atomic<int>, 3> running;
+    for (int s = 0; s < 3; ++s) {
+        running[s] = config.threads_per_stage[s];
+    }
+    std::atomic<size_t> next_batch{0};
+    
+    // Times one batch of work into the stage's stats
+    auto timed = [&stats](int stage, auto&& work) {
+        const auto t0 = Clock::now();
+        work();
+        stats[stage].busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+        ++stats[stage].batches;
+    };
+    
+    const auto start = Clock::now();
+    std::vector<std::thread> threads;
+    
+    // Stage 0: claim batch indices, generate, hand downstream
+    for (int t = 0; t < config.threads_per_stage[0]; ++t) {
+        threads.emplace_back([&] {
+            for (size_t i; (i = next_batch.fetch_add(1)) < batches.size();) {
+                timed(0, [&] { generate_batch(batches[i], static_cast<int>(i)); });
+                generated.push(i);
+            }
+            if (--running[0] == 0) {
+                generated.close();   // last generator out closes the queue
+            }
+        });
+    }
+    // Stage 1: transform
+    for (int t = 0; t < config.threads_per_stage[1]; ++t) {
+        threads.emplace_back([&] {
+            while (auto i = generated.pop()) {
+                timed(1, [&] { transform_batch(batches[*i]); });
+                transformed.push(*i);
+            }
+            if (--running[1] == 0) {
+                transformed.close();
+            }
+        });
+    }
+    // Stage 2: validate
+    for (int t = 0; t < config.threads_per_stage[2]; ++t) {
+        threads.emplace_back([&] {
+            while (auto i = transformed.pop()) {
+                timed(2, [&] { validate_batch(batches[*i]); });
+            }
+        });
+    }
+    
+    for (auto& t : threads) {
+        t.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    
+    if (report) {
+        const char* names[3] = {"generate", "transform", "validate"};
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  " << std::left << std::setw(10) << "stage" << std::right << std::setw(8) << "threads"
+                  << std::setw(14) << "batches/s" << std::setw(10) << "busy" << "\n";
+        for (int s = 0; s < 3; ++s) {
+            const double busy_s = stats[s].busy_ns.load() / 1e9;
+            // Throughput the stage could sustain on its own: batches per
+            // second of busy time, times its thread count. The lowest is
+            // the bottleneck.
+            const double capacity = busy_s > 0 ? stats[s].batches.load() / busy_s : 0.0;
+            std::cout << "  " << std::left << std::setw(10) << names[s] << std::right
+                      << std::setw(8) << config.threads_per_stage[s]
+                      << std::setw(14) << capacity * config.threads_per_stage[s]
+                      << std::setw(9) << 100.0 * busy_s / (seconds * config.threads_per_stage[s]) << "%\n";
+        }
+        const char* queue_names[2] = {"gen->xform", "xform->val"};
+        const BoundedQueue<size_t>* queues[2] = {&generated, &transformed};
+        std::cout << "  " << std::left << std::setw(12) << "queue" << std::right << std::setw(10) << "mean/cap"
+                  << std::setw(6) << "max" << std::setw(8) << "full" << std::setw(8) << "empty" << "\n";
+        for (int q = 0; q < 2; ++q) {
+            const auto st = queues[q]->stats();
+            std::cout << "  " << std::left << std::setw(12) << queue_names[q] << std::right
+                      << std::setw(6) << st.mean_occupancy << "/" << std::setw(3) << st.capacity
+                      << std::setw(6) << st.max_occupancy << std::setw(8) << st.full_waits
+                      << std::setw(8) << st.empty_waits << "\n";
+        }
+    }
+    return seconds;
+}
+
 int main() {
     const int num_threads = 4;
     const int num_stages = 3;
@@ -92,5 +360,56 @@ int main() {
     std::cout << "Successfully processed: " << processed_count 
              << "/" << num_batches << " batches\n";
     
+    // Streaming mode: stages overlap, queues of 8 handles between them
+    std::vector<DataBatch> stream(num_batches);
+    PipelineConfig config;
+    config.threads_per_stage = {1, 2, 1};
+    std::cout << "\nStreaming pipeline, " << num_batches << " batches:\n";
+    run_streaming_pipeline(stream, config);
+    processed_count = 0;
+    for (const auto& batch : stream) {
+        if (batch.processed) processed_count++;
+    }
+    std::cout << "Successfully processed: " << processed_count << "/" << num_batches << " batches\n";
+
+    // A stage without threads would never drain its input queue
+    PipelineConfig broken;
+    broken.threads_per_stage = {1, 0, 1};
+    try {
+        run_streaming_pipeline(stream, broken, false);
+    } catch (const std::invalid_argument& e) {
+        std::cout << "Rejected: " << e.what() << "\n";
+    }
+    
+    // Lockstep, many times over: fresh threads each time vs one team
+    {
+        const int runs = 2000;
+        using Clock = std::chrono::steady_clock;
+        std::vector<DataBatch> fresh(num_batches);
+        auto t0 = Clock::now();
+        for (int r = 0; r < runs; ++r) {
+            run_lockstep(fresh, num_threads);
+        }
+        const double fresh_us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / runs;
+        
+        ThreadTeam team(num_threads);
+        std::vector<DataBatch> reused(num_batches);
+        t0 = Clock::now();
+        for (int r = 0; r < runs; ++r) {
+            run_lockstep(team, reused);
+        }
+        const double team_us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / runs;
+        std::cout << "\nLockstep, " << num_batches << " batches x " << runs << " runs: new threads " << fresh_us
+                  << " us per run, ThreadTeam " << team_us << " us per run\n";
+    }
+    
+    // Larger run: full queues ahead of a stage mean it is the bottleneck,
+    // empty waits mean it is starved by the stage before it
+    const int many = 200000;
+    std::vector<DataBatch> lots(many);
+    std::cout << "\nStreaming pipeline, " << many << " batches:\n";
+    const double seconds = run_streaming_pipeline(lots, config);
+    std::cout << "  total " << many / seconds << " batches/s\n";
+    
     return 0;
 }
\ No newline at end of file
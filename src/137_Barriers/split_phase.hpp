@@ -0,0 +1,102 @@
+/*
+Split-phase barrier helper for iterative solvers (header-only, just #include it).
+Used by barrier_with_completion_function.cpp and arrive_and_wait_separately.cpp.
+
+With arrive_and_wait() every worker stalls at the end of each step until the
+slowest one is done. But in a stencil or halo-exchange solver the neighbours
+only need a worker's boundary cells, not its interior. So a step can be split:
+
+    boundary()   compute the cells the neighbours will read
+    arrive()     publish them: "my part of this phase is ready"
+    interior()   compute the rest while the others catch up
+    wait()       block only now, right before the next step needs the
+                 neighbours' boundary cells
+
+The barrier wait overlaps with interior work, so an imbalance smaller than the
+interior's cost costs no stall time at all.
+
+Each thread owns one PhaseTeam::Member. leave() drops the member out of
+the team for good (arrive_and_drop, as in arrive_and_drop.cpp), so workers
+can finish - converge - at different times without deadlocking the rest.
+
+The completion function runs when the last member *arrives*, while others may
+still be in interior(). It must not touch data the interiors are working on
+(e.g. swap the buffers); index buffers by step parity instead.
+*/
+#pragma once
+
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+struct NoCompletion {
+    void operator()() noexcept {}
+};
+
+template<typename CompletionFunction = NoCompletion>
+class PhaseTeam {
+public:
+    using Barrier = std::barrier<CompletionFunction>;
+
+    explicit PhaseTeam(std::ptrdiff_t members, CompletionFunction completion = CompletionFunction())
+        : barrier_(members, std::move(completion)) {}
+
+    class Member {
+    public:
+        explicit Member(PhaseTeam& team) : team_(team) {}
+        Member(const Member&) = delete;
+        Member& operator=(const Member&) = delete;
+
+        // A phase still in flight is finished, so the team is never left
+        // waiting for an arrival that has already happened
+        ~Member() { wait(); }
+
+        // Boundary data for this phase is ready
+        void arrive() { token_.emplace(team_.barrier_.arrive()); }
+
+        // Block until every member has arrived in this phase (no-op if this
+        // member has not arrived yet)
+        void wait() {
+            if (!token_) {
+                return;
+            }
+            const auto t0 = std::chrono::steady_clock::now();
+            team_.barrier_.wait(std::move(*token_));
+            stall_ += std::chrono::steady_clock::now() - t0;
+            token_.reset();
+        }
+
+        // One full split-phase step
+        template<typename Boundary, typename Interior>
+        void step(Boundary&& boundary, Interior&& interior) {
+            boundary();
+            arrive();
+            interior();
+            wait();
+        }
+
+        // Leave the team for good. The current phase is completed first:
+        // arriving twice in one phase is undefined behaviour
+        void leave() {
+            wait();
+            team_.barrier_.arrive_and_drop();
+            left_ = true;
+        }
+
+        bool has_left() const { return left_; }
+
+        // Total time this member spent blocked in wait()
+        std::chrono::nanoseconds stall_time() const { return stall_; }
+
+    private:
+        PhaseTeam& team_;
+        std::optional<typename Barrier::arrival_token> token_;
+        std::chrono::nanoseconds stall_{0};
+        bool left_ = false;
+    };
+
+private:
+    Barrier barrier_;
+};
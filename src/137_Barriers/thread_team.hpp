@@ -0,0 +1,263 @@
+/*
+Persistent fork-join thread team (header-only, just #include it).
+Used by thread_team_demo.cpp, barrier_with_completion_function.cpp,
+parallel_matrix_calculation.cpp and multi_stage_pipeline_processing.cpp.
+
+Starting N std::threads and a std::barrier for every parallel region, then
+joining them, costs tens of microseconds per thread before any work is
+done. A solver that enters a region thousands of times per second spends
+most of its time there. A ThreadTeam starts its threads once and parks
+them between regions:
+
+    ThreadTeam team(4);                      // 3 workers + the calling thread
+    team.run([&](int tid, int nthreads) {    // returns when every tid is done
+        work(chunk(tid, nthreads));
+        team.sync();                         // barrier inside the region
+        more_work(chunk(tid, nthreads));
+        team.sync([&]() noexcept { swap(a, b); });   // + completion, run once
+    });
+
+- run() executes fn on every member at once: tid 0 is the calling thread,
+  1..N-1 are the team's workers. It rethrows the first exception fn threw,
+  once all members are done. As with std::barrier, a member that throws
+  before a sync() the others are waiting in leaves them waiting.
+- sync(completion) is a barrier for the members of the current region; the
+  last member to arrive runs completion before anyone is released.
+- Waiting (for a region, for a sync, for the end of run) spins on an atomic
+  first, with the self-tuning budget of ../101_Threads_RAII/adaptive_waiter.hpp,
+  then parks in atomic::wait. A team with more members than hardware
+  threads parks right away unless given a wait config explicitly.
+- Nested regions: run() called from inside a region of the same team runs fn
+  inline as fn(0, 1), like OpenMP without nested parallelism; sync() in it
+  only runs the completion. A region may use a *different* team (one inner
+  team per outer member, say), which runs in parallel as usual.
+- Regions started from different outside threads take turns.
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../101_Threads_RAII/adaptive_waiter.hpp"
+
+class ThreadTeam {
+    struct NoCompletion {
+        void operator()() noexcept {}
+    };
+
+    // The region the current thread is executing, innermost first
+    struct Frame {
+        const ThreadTeam* team;
+        int tid;
+        int nthreads;
+        Frame* outer;
+    };
+
+    static Frame*& current_frame() {
+        thread_local Frame* frame = nullptr;
+        return frame;
+    }
+
+    // Pushes a frame for the lifetime of the scope
+    class FrameScope {
+    public:
+        FrameScope(const ThreadTeam* team, int tid, int nthreads)
+            : m_frame{team, tid, nthreads, current_frame()} {
+            current_frame() = &m_frame;
+        }
+        ~FrameScope() { current_frame() = m_frame.outer; }
+        FrameScope(const FrameScope&) = delete;
+        FrameScope& operator=(const FrameScope&) = delete;
+
+    private:
+        Frame m_frame;
+    };
+
+public:
+    struct Stats {
+        uint64_t regions = 0;           // run() calls dispatched to the team
+        uint64_t inline_regions = 0;    // nested run() calls executed inline
+        uint64_t syncs = 0;             // completed sync() phases
+        AdaptiveWaiter::Stats waits;    // summed over every member's waiter
+    };
+
+    // Without a wait config, members spin only if each one has a hardware
+    // thread to itself; an oversubscribed spinner burns the time slice of
+    // the very member it waits for
+    explicit ThreadTeam(int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency())),
+                        std::optional<AdaptiveWaiter::Config> wait = std::nullopt)
+        : m_size(threads) {
+        if (threads < 1) {
+            throw std::invalid_argument("ThreadTeam needs at least one thread");
+        }
+        if (!wait) {
+            const bool oversubscribed = static_cast<unsigned>(threads) > std::thread::hardware_concurrency();
+            wait = oversubscribed ? AdaptiveWaiter::Config::park_only() : AdaptiveWaiter::Config{};
+        }
+        for (int tid = 0; tid < threads; ++tid) {
+            m_waiters.emplace_back(*wait);
+        }
+        m_workers.reserve(static_cast<size_t>(threads - 1));
+        for (int tid = 1; tid < threads; ++tid) {
+            m_workers.emplace_back([this, tid] { worker(tid); });
+        }
+    }
+
+    ~ThreadTeam() {
+        m_stop.store(true, std::memory_order_relaxed);
+        m_epoch.fetch_add(1, std::memory_order_release);
+        m_epoch.notify_all();
+        for (auto& w : m_workers) {
+            w.join();
+        }
+    }
+
+    ThreadTeam(const ThreadTeam&) = delete;
+    ThreadTeam& operator=(const ThreadTeam&) = delete;
+
+    int size() const { return m_size; }
+
+    template<typename Fn>
+    void run(Fn&& fn) {
+        static_assert(std::is_invocable_v<Fn&, int, int>, "a region is called as fn(tid, nthreads)");
+        for (const Frame* f = current_frame(); f; f = f->outer) {
+            if (f->team == this) {
+                m_inline_regions.fetch_add(1, std::memory_order_relaxed);
+                FrameScope scope(this, 0, 1);
+                fn(0, 1);
+                return;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_run_mutex);
+        m_regions.fetch_add(1, std::memory_order_relaxed);
+        m_region = const_cast<void*>(static_cast<const void*>(std::addressof(fn)));
+        m_invoke = [](void* region, int tid, int nthreads) {
+            (*static_cast<std::remove_reference_t<Fn>*>(region))(tid, nthreads);
+        };
+        m_pending.store(m_size - 1, std::memory_order_relaxed);
+        m_epoch.fetch_add(1, std::memory_order_release);
+        if (m_size > 1) {
+            m_epoch.notify_all();
+        }
+
+        execute(0);
+        await(m_waiters[0], m_pending, [](int pending) { return pending == 0; });
+
+        m_region = nullptr;
+        if (m_error) {
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+    }
+
+    // Barrier among the members of the current region; call it from inside
+    // run() only, the same number of times on every member
+    template<typename Completion = NoCompletion>
+    void sync(Completion&& completion = Completion{}) {
+        const Frame* frame = current_frame();
+        if (!frame || frame->team != this) {
+            throw std::logic_error("ThreadTeam::sync() outside a region of this team");
+        }
+        if (frame->nthreads == 1) {
+            completion();
+            return;
+        }
+        const uint64_t phase = m_phase.load(std::memory_order_acquire);
+        if (m_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == frame->nthreads) {
+            m_arrived.store(0, std::memory_order_relaxed);
+            completion();
+            m_syncs.fetch_add(1, std::memory_order_relaxed);
+            m_phase.fetch_add(1, std::memory_order_release);
+            m_phase.notify_all();
+            return;
+        }
+        await(m_waiters[frame->tid], m_phase, [phase](uint64_t now) { return now != phase; });
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.regions = m_regions.load(std::memory_order_relaxed);
+        s.inline_regions = m_inline_regions.load(std::memory_order_relaxed);
+        s.syncs = m_syncs.load(std::memory_order_relaxed);
+        for (int tid = 0; tid < m_size; ++tid) {
+            const AdaptiveWaiter::Stats w = m_waiters[tid].stats();
+            s.waits.spin_hits += w.spin_hits;
+            s.waits.yield_hits += w.yield_hits;
+            s.waits.parks += w.parks;
+        }
+        return s;
+    }
+
+private:
+    // Spin (adaptively), then park on the atomic until done(value)
+    template<typename T, typename Done>
+    static void await(AdaptiveWaiter& waiter, const std::atomic<T>& value, Done done) {
+        waiter.wait([&] { return done(value.load(std::memory_order_acquire)); },
+                    [&] {
+                        for (T v = value.load(std::memory_order_acquire); !done(v);
+                             v = value.load(std::memory_order_acquire)) {
+                            value.wait(v, std::memory_order_acquire);
+                        }
+                    });
+    }
+
+    void execute(int tid) {
+        FrameScope scope(this, tid, m_size);
+        try {
+            m_invoke(m_region, tid, m_size);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_error_mutex);
+            if (!m_error) {
+                m_error = std::current_exception();
+            }
+        }
+    }
+
+    void worker(int tid) {
+        uint64_t seen = 0;
+        for (;;) {
+            await(m_waiters[tid], m_epoch, [seen](uint64_t epoch) { return epoch != seen; });
+            seen = m_epoch.load(std::memory_order_acquire);
+            if (m_stop.load(std::memory_order_relaxed)) {
+                return;
+            }
+            execute(tid);
+            if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                m_pending.notify_one();
+            }
+        }
+    }
+
+    const int m_size;
+    std::deque<AdaptiveWaiter> m_waiters;    // one per member, tid-indexed; never moved
+    std::vector<std::thread> m_workers;
+    std::mutex m_run_mutex;
+
+    // Region dispatch: written by run() before the epoch bump, read by the
+    // workers after they see it
+    void* m_region = nullptr;
+    void (*m_invoke)(void*, int, int) = nullptr;
+    std::mutex m_error_mutex;
+    std::exception_ptr m_error;
+
+    alignas(64) std::atomic<uint64_t> m_epoch{0};   // bumped once per region
+    std::atomic<bool> m_stop{false};
+    alignas(64) std::atomic<int> m_pending{0};      // workers still in the region
+    alignas(64) std::atomic<int> m_arrived{0};      // sync() arrivals this phase
+    alignas(64) std::atomic<uint64_t> m_phase{0};   // completed sync() phases
+
+    alignas(64) std::atomic<uint64_t> m_regions{0};
+    std::atomic<uint64_t> m_inline_regions{0};
+    std::atomic<uint64_t> m_syncs{0};
+};
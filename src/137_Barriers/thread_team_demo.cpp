@@ -0,0 +1,177 @@
+/*
+g++ -pthread --std=c++20 -O2 thread_team_demo.cpp -o app
+*/
+
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "thread_team.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+template<typename Region>
+double us_per_region(int regions, Region&& region) {
+    const auto t0 = Clock::now();
+    for (int r = 0; r < regions; ++r) {
+        region();
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / regions;
+}
+
+// The pattern the barrier examples use: fresh threads and a fresh barrier
+// for every region
+template<typename Body>
+void fresh_threads(int nthreads, Body&& body) {
+    std::barrier<> sync_point(nthreads);
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < nthreads; ++tid) {
+        threads.emplace_back([&, tid] { body(tid, nthreads, sync_point); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+void print_waits(const ThreadTeam& team) {
+    const ThreadTeam::Stats s = team.stats();
+    std::cout << " (waits: " << s.waits.spin_hits << " spin, " << s.waits.yield_hits << " yield, " << s.waits.parks
+              << " parked)";
+}
+
+// ============================================================================
+// 1. REGION-ENTRY OVERHEAD: an empty region
+// ============================================================================
+void benchmarkEntry() {
+    std::cout << "\n=== us PER EMPTY REGION (" << std::thread::hardware_concurrency() << " hardware threads) ===\n";
+    for (int n : {1, 2, 4, 8}) {
+        const double spawn = us_per_region(500, [&] { fresh_threads(n, [](int, int, std::barrier<>&) {}); });
+        ThreadTeam team(n);
+        const double default_wait = us_per_region(5000, [&] { team.run([](int, int) {}); });
+        ThreadTeam parked(n, AdaptiveWaiter::Config::park_only());
+        const double park_only = us_per_region(5000, [&] { parked.run([](int, int) {}); });
+        ThreadTeam spinning(n, AdaptiveWaiter::Config{});
+        const double spin = us_per_region(500, [&] { spinning.run([](int, int) {}); });
+        std::cout << n << " thread(s): new std::threads " << spawn << ", team: default " << default_wait
+                  << ", park only " << park_only << ", always spin first " << spin;
+        print_waits(spinning);
+        std::cout << "\n";
+    }
+    std::cout << "(a spinning member only helps if the member it waits for is running on another core)\n";
+}
+
+// ============================================================================
+// 2. A SMALL SOLVER: many short regions, each with several barrier phases
+// ============================================================================
+void benchmarkSolver() {
+    constexpr int kThreads = 4;
+    constexpr int kRegions = 2000;
+    constexpr int kPhases = 4;
+    constexpr size_t kCells = 4096;
+    std::cout << "\n=== " << kRegions << " REGIONS x " << kPhases << " PHASES, " << kCells << " CELLS, "
+              << kThreads << " THREADS ===\n";
+    std::vector<double> cells(kCells, 1.0);
+
+    auto phase_work = [&](int tid, int nthreads) {
+        const size_t chunk = kCells / static_cast<size_t>(nthreads);
+        for (size_t i = chunk * static_cast<size_t>(tid); i < chunk * static_cast<size_t>(tid + 1); ++i) {
+            cells[i] = cells[i] * 0.5 + 0.5;
+        }
+    };
+
+    const double spawn = us_per_region(kRegions, [&] {
+        fresh_threads(kThreads, [&](int tid, int nthreads, std::barrier<>& sync_point) {
+            for (int p = 0; p < kPhases; ++p) {
+                phase_work(tid, nthreads);
+                sync_point.arrive_and_wait();
+            }
+        });
+    });
+
+    ThreadTeam team(kThreads);
+    const double persistent = us_per_region(kRegions, [&] {
+        team.run([&](int tid, int nthreads) {
+            for (int p = 0; p < kPhases; ++p) {
+                phase_work(tid, nthreads);
+                team.sync();
+            }
+        });
+    });
+    std::cout << "new threads + std::barrier " << spawn << " us per region, ThreadTeam " << persistent
+              << " us per region (" << spawn / persistent << "x)";
+    print_waits(team);
+    std::cout << "\n";
+}
+
+// ============================================================================
+// 3. SYNC WITH A COMPLETION, NESTED REGIONS, EXCEPTIONS
+// ============================================================================
+void demonstrateSemantics() {
+    std::cout << "\n=== SEMANTICS ===\n";
+    ThreadTeam team(4);
+
+    // The completion runs once per phase, before anyone continues
+    std::vector<int> slots(team.size());
+    int rounds = 0;
+    std::vector<int> totals;
+    team.run([&](int tid, int) {
+        for (int round = 1; round <= 3; ++round) {
+            slots[tid] = tid * round;
+            team.sync([&]() noexcept {
+                totals.push_back(std::accumulate(slots.begin(), slots.end(), 0));
+                ++rounds;
+            });
+        }
+    });
+    std::cout << "sync completion ran " << rounds << " times, totals";
+    for (int t : totals) std::cout << " " << t;
+    std::cout << "\n";
+
+    // Nested on the same team: inline, one thread
+    std::atomic<int> inner_calls{0};
+    team.run([&](int, int) {
+        team.run([&](int tid, int nthreads) {
+            if (tid == 0 && nthreads == 1) {
+                ++inner_calls;
+            }
+            team.sync();    // a one-member phase: returns at once
+        });
+    });
+    std::cout << "nested run() on the same team: " << inner_calls << " inline calls of fn(0, 1), "
+              << team.stats().inline_regions << " inline regions counted\n";
+
+    // Nested on another team: each outer member drives an inner team of 2
+    ThreadTeam inner_a(2);
+    ThreadTeam inner_b(2);
+    std::atomic<int> inner_members{0};
+    ThreadTeam outer(2);
+    outer.run([&](int tid, int) {
+        ThreadTeam& inner = tid == 0 ? inner_a : inner_b;
+        inner.run([&](int, int) { ++inner_members; });
+    });
+    std::cout << "2 outer members x inner teams of 2: " << inner_members << " inner members ran\n";
+
+    try {
+        team.run([](int tid, int) {
+            if (tid == 2) {
+                throw std::runtime_error("member 2 failed");
+            }
+        });
+    } catch (const std::exception& ex) {
+        std::cout << "run() rethrew: " << ex.what() << "\n";
+    }
+    team.run([](int, int) {});
+    std::cout << "the team still runs regions afterwards: " << team.stats().regions << " regions in all\n";
+}
+
+int main() {
+    benchmarkEntry();
+    benchmarkSolver();
+    demonstrateSemantics();
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*
+g++ -pthread --std=c++20 -O2 adaptive_wait_benchmark.cpp -o app
+*/
+
+// Latency vs CPU burn of the spin-then-park waiter (adaptive_waiter.hpp)
+// against a plain condition_variable wait, under bursty traffic:
+// bursts of items a few microseconds apart, separated by long idle gaps.
+//
+// For each waiting strategy the consumer reports:
+//   - enqueue-to-dequeue latency (mean / p50 / p99)
+//   - consumer CPU time as a percentage of wall time (the price of spinning)
+//
+// Spinning only pays when the consumer has a core to itself; on a machine with
+// fewer cores than threads the producer and consumer fight for the same CPU.
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <ctime>
+
+#include "../101_Threads_RAII/adaptive_waiter.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct Channel {
+    std::mutex mtx;
+    std::condition_variable_any cv;
+    std::queue<Clock::time_point> items;   // each item is its enqueue time
+    std::atomic<size_t> count{0};          // lock-free mirror of items.size()
+};
+
+// CPU time consumed by the calling thread only
+double thread_cpu_ms() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+struct Result {
+    std::vector<double> latencies_ns;
+    double cpu_ms = 0.0;
+    double wall_ms = 0.0;
+    AdaptiveWaiter::Stats stats;
+};
+
+Result run(const AdaptiveWaiter::Config& config, int bursts, int burst_size,
+           std::chrono::microseconds item_gap, std::chrono::microseconds burst_gap) {
+    Channel channel;
+    Result result;
+    result.latencies_ns.reserve(static_cast<size_t>(bursts * burst_size));
+    const size_t total = static_cast<size_t>(bursts * burst_size);
+
+    auto start = Clock::now();
+    std::jthread consumer([&](std::stop_token st) {
+        AdaptiveWaiter waiter(config);
+        const double cpu_start = thread_cpu_ms();
+        std::unique_lock lock(channel.mtx);
+
+        while (result.latencies_ns.size() < total) {
+            if (channel.items.empty()) {
+                lock.unlock();
+                waiter.spin([&] { return channel.count.load(std::memory_order_relaxed) > 0; });
+                lock.lock();
+            }
+            if (!channel.cv.wait(lock, st, [&] { return !channel.items.empty(); })) {
+                break;
+            }
+            const auto now = Clock::now();
+            result.latencies_ns.push_back(
+                std::chrono::duration<double, std::nano>(now - channel.items.front()).count());
+            channel.items.pop();
+            channel.count.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        result.cpu_ms = thread_cpu_ms() - cpu_start;
+        result.stats = waiter.stats();
+    });
+
+    for (int b = 0; b < bursts; ++b) {
+        for (int i = 0; i < burst_size; ++i) {
+            {
+                std::lock_guard g(channel.mtx);
+                channel.items.push(Clock::now());
+                channel.count.fetch_add(1, std::memory_order_relaxed);
+            }
+            channel.cv.notify_one();
+
+            // Busy-wait the short intra-burst gap; sleep_for cannot do microseconds
+            const auto next = Clock::now() + item_gap;
+            while (Clock::now() < next) {
+                cpu_relax();
+            }
+        }
+        std::this_thread::sleep_for(burst_gap);
+    }
+    consumer.join();
+    result.wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return result;
+}
+
+void report(const std::string& name, Result result) {
+    auto& lat = result.latencies_ns;
+    std::sort(lat.begin(), lat.end());
+    double mean = 0.0;
+    for (double v : lat) {
+        mean += v;
+    }
+    mean /= static_cast<double>(lat.size());
+    const double p50 = lat[lat.size() / 2];
+    const double p99 = lat[std::min(lat.size() - 1, lat.size() * 99 / 100)];
+
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(10) << mean
+              << std::setw(10) << p50
+              << std::setw(10) << p99
+              << std::setprecision(1)
+              << std::setw(9) << 100.0 * result.cpu_ms / result.wall_ms << "%"
+              << std::setw(9) << result.stats.spin_hits
+              << std::setw(8) << result.stats.yield_hits
+              << std::setw(8) << result.stats.parks << "\n";
+}
+
+int main() {
+    const int bursts = 200;
+    const int burst_size = 16;
+    const auto item_gap = std::chrono::microseconds(2);
+    const auto burst_gap = std::chrono::microseconds(500);
+
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n";
+    std::cout << bursts << " bursts x " << burst_size << " items, " << item_gap.count()
+              << " us apart, " << burst_gap.count() << " us between bursts\n\n";
+    std::cout << std::left << std::setw(22) << "strategy" << std::right
+              << std::setw(10) << "mean(ns)" << std::setw(10) << "p50(ns)" << std::setw(10) << "p99(ns)"
+              << std::setw(10) << "cpu" << std::setw(9) << "spin" << std::setw(8) << "yield"
+              << std::setw(8) << "park" << "\n";
+
+    report("park only (cv)", run(AdaptiveWaiter::Config::park_only(), bursts, burst_size, item_gap, burst_gap));
+
+    AdaptiveWaiter::Config fixed_small{256, 256, 256, 0, false};
+    report("fixed spin 256", run(fixed_small, bursts, burst_size, item_gap, burst_gap));
+
+    AdaptiveWaiter::Config fixed_large{65536, 65536, 65536, 0, false};
+    report("fixed spin 65536", run(fixed_large, bursts, burst_size, item_gap, burst_gap));
+
+    report("adaptive (default)", run(AdaptiveWaiter::Config{}, bursts, burst_size, item_gap, burst_gap));
+
+    AdaptiveWaiter::Config adaptive_wide;
+    adaptive_wide.max_spins = 1 << 16;
+    report("adaptive (max 65536)", run(adaptive_wide, bursts, burst_size, item_gap, burst_gap));
+    return 0;
+}
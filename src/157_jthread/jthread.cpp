@@ -8,6 +8,10 @@ g++ -pthread --std=c++20 jthread.cpp -o app
 #include <condition_variable>
 #include <queue>
 #include <iostream>
+#include <atomic>
+
+// Spin-then-yield-then-park helper, shared with the thread pool example
+#include "../101_Threads_RAII/adaptive_waiter.hpp"
 
 // Protects all accesses to 'items'. Any thread that reads or writes
 // the queue must hold this mutex to prevent data races.
@@ -70,6 +74,88 @@ void consumer(std::stop_token st)
 }
 // 'lock' destructor fires here — mutex released.
 
+// Lock-free mirror of items.size(). Written by whoever holds mtx, read without
+// the lock by the adaptive consumer's spin phase.
+std::atomic<size_t> item_count{0};
+
+// Same protocol as consumer(), but instead of going straight into cv.wait()
+// when the queue is empty it first watches item_count for a short, self-tuning
+// number of iterations (see adaptive_waiter.hpp). Under bursty load the next
+// item usually arrives during that window, skipping a futex sleep and wake.
+void adaptive_consumer(std::stop_token st)
+{
+    AdaptiveWaiter waiter;
+    std::unique_lock lock(mtx);
+
+    while (!st.stop_requested())
+    {
+        if (items.empty())
+        {
+            // The spin phase must not hold the mutex, or the producer could
+            // never push the item we are waiting for.
+            lock.unlock();
+            waiter.spin([&st] { return item_count.load(std::memory_order_relaxed) > 0 || st.stop_requested(); });
+            lock.lock();
+        }
+
+        // Authoritative check under the lock; returns at once if the spin
+        // phase already saw an item, otherwise parks as before.
+        cv.wait(lock, st, []{ return !items.empty(); });
+
+        if (st.stop_requested())
+        {
+            break;
+        }
+
+        std::cout << "adaptive consumed: " << items.front() << std::endl;
+        items.pop();
+        item_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    AdaptiveWaiter::Stats stats = waiter.stats();
+    std::cout << "adaptive consumer: done (spin hits " << stats.spin_hits
+              << ", yield hits " << stats.yield_hits
+              << ", parks " << stats.parks << ")" << std::endl;
+}
+
+// Batch variant: one lock acquisition per wake-up instead of one per item.
+// After the wait, the whole queue is swapped into a local one (O(1) under the
+// lock), the mutex is released, and the batch is processed without holding
+// it, so the producer never waits behind per-item processing (here cout).
+void batch_consumer(std::stop_token st)
+{
+    size_t batches = 0;
+    size_t consumed = 0;
+
+    while (true)
+    {
+        std::queue<int> batch;
+        {
+            std::unique_lock lock(mtx);
+            cv.wait(lock, st, []{ return !items.empty(); });
+
+            // Unlike consumer(), drain what is already queued before leaving,
+            // a swap makes that free.
+            if (items.empty() && st.stop_requested())
+            {
+                break;
+            }
+            batch.swap(items);
+            item_count.store(0, std::memory_order_relaxed);
+        } // mutex released before any item is touched
+
+        ++batches;
+        for (; !batch.empty(); batch.pop())
+        {
+            ++consumed;
+        }
+        std::cout << "batch consumed: " << consumed << " items so far" << std::endl;
+    }
+
+    std::cout << "batch consumer: done (" << consumed << " items in "
+              << batches << " batches)" << std::endl;
+}
+
 int main()
 {
     using namespace std::chrono_literals;   // enables the 80ms / 50ms literals
@@ -114,8 +200,49 @@ int main()
     //      is empty and it would otherwise wait indefinitely.
     t.request_stop();
 
+    // Join explicitly here (instead of at end of scope) because the second
+    // demo below reuses the same mtx / cv / items.
+    t.join();
+
+    // Same producer sequence against the spin-then-park consumer. The 80 ms
+    // gaps are far longer than any spin budget, so every wait ends up parked;
+    // see adaptive_wait_benchmark.cpp for bursty traffic where spinning pays.
+    std::jthread adaptive(adaptive_consumer);
+    for (int i : {40, 50, 60})
+    {
+        std::this_thread::sleep_for(80ms);
+        {
+            std::lock_guard g(mtx);
+            items.push(i);
+            item_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        cv.notify_one();
+    }
+    std::this_thread::sleep_for(50ms);
+    adaptive.request_stop();
+    adaptive.join();
+
+    // Bursts of 1000 items per notify: the batch consumer swaps each burst
+    // out in a single lock acquisition.
+    std::jthread batched(batch_consumer);
+    for (int burst = 0; burst < 3; ++burst)
+    {
+        std::this_thread::sleep_for(20ms);
+        {
+            std::lock_guard g(mtx);
+            for (int i = 0; i < 1000; ++i)
+            {
+                items.push(i);
+            }
+            item_count.fetch_add(1000, std::memory_order_relaxed);
+        }
+        cv.notify_one();
+    }
+    std::this_thread::sleep_for(20ms);
+    batched.request_stop();
+
     // jthread destructor is called here. It calls join(), blocking main
-    // until the consumer thread has returned from consumer(). This guarantees
+    // until the consumer thread has returned from batch_consumer(). This guarantees
     // no thread is still running when the program exits. With std::thread
     // this would require an explicit t.join(); forgetting it causes
     // std::terminate(). jthread makes it automatic (RAII).
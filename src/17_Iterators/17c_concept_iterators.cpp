@@ -1,4 +1,4 @@
- // c++ -std=c++20 17c_concept_iterators.cpp 
+ // c++ -std=c++20 -O2 17c_concept_iterators.cpp 
 
 /*
 ================================================================================
@@ -17,6 +17,7 @@ TABLE OF CONTENTS:
 8. Practical Examples
 9. Migration from Iterator Tags
 10. Custom Iterators with Concepts
+11. Concept-Dispatched Algorithms (copy, fill, find, count, equal, ...)
 
 ================================================================================
 1. INTRODUCTION TO CONCEPTS
@@ -39,10 +40,25 @@ Syntax:
 #include <vector>
 #include <list>
 #include <forward_list>
+#include <deque>
 #include <concepts>
 #include <iterator>
 #include <ranges>
 #include <type_traits>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <random>
+#include <tuple>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /*
 ================================================================================
@@ -691,6 +707,711 @@ void custom_iterator_example() {
     std::cout << "\n";
 }
 
+/*
+================================================================================
+11. CONCEPT-DISPATCHED ALGORITHMS
+================================================================================
+
+Section 7 picks an overload by iterator strength to print a message; the
+same mechanism builds real algorithms. Every algorithm in namespace fast
+(copy, fill, find, count, equal, lexicographical_compare) has three
+overloads:
+
+  generic      std::input_iterator         the plain loop, one element per
+                                           trip (list, forward_list, streams)
+  unrolled     std::random_access_iterator the length is known up front, so
+                                           each trip does 4 elements behind
+                                           one bounds check (deque, ...)
+  contiguous   std::contiguous_iterator    the elements are raw bytes in one
+               + a bytewise condition      block: memmove / memset / memchr /
+                                           memcmp or an SSE2 kernel
+
+The constraints of each overload contain those of the one above it, so
+overload resolution picks the most constrained one that applies. No tags,
+no if constexpr - and a type that fails the bytewise condition simply falls
+back to the unrolled overload.
+
+The bytewise paths are only taken where they give the same answer as the
+element loop:
+  copy      same trivially copyable value type on both sides     memmove
+  fill      scalar (or padding-free) type; memset when all bytes of the
+            value are equal (any char, 0, -1), else 16-byte SSE2 stores
+  find      1- or 4-byte integers                   memchr / SSE2 compare
+  count     1- or 4-byte integers                   SSE2 compare + add
+  equal     types whose bytes are their value
+            (has_unique_object_representations: not double, where
+            -0.0 == 0.0 and NaN != NaN, nor structs with padding)   memcmp
+  lexicographical_compare
+            unsigned bytes only - memcmp compares as unsigned char  memcmp
+
+libstdc++ already does some of this itself (std::copy of trivial types is a
+memmove, std::fill of bytes a memset, std::find on random access is
+unrolled), so concept_algorithms_benchmark() shows where each tier beats
+std:: and where it only matches it. Build with -O2 for meaningful numbers.
+One x86-64 run, 2^18 elements, GCC 12 -O2:
+
+  contiguous  find u8 19x (memchr), count u8 7.8x / int 1.9x, find int 2x,
+              fill int 3.7x (GCC keeps std::fill's loop scalar at -O2);
+              copy, byte fill, equal, u8 compare 1.0x - already mem* calls
+  unrolled    through vector::rbegin(): count 1.5-4x, u8 compare 2x,
+              fill int 4x, copy 1.4x; fill u8 0.1x - std's plain loop
+              vectorizes, the indexed one does not
+  generic     list: 1.0x everywhere - both are the same pointer chase
+
+deque is the counterexample: libstdc++ overloads copy/fill/equal/compare for
+deque iterators to work a segment at a time (memmove/memcmp per block), so
+the unrolled tier runs 0.01-0.9x of std:: there. Subsumption only sees the
+iterator concept; a container-specific overload still wins.
+*/
+
+namespace fast {
+namespace detail {
+
+// 1- and 4-byte integers: the lane widths the SSE2 kernels handle
+template<typename T>
+concept simd_lane = std::integral<T> && !std::same_as<T, bool> && (sizeof(T) == 1 || sizeof(T) == 4);
+
+template<typename T>
+concept unsigned_byte = std::same_as<T, std::byte> ||
+                        (std::unsigned_integral<T> && !std::same_as<T, bool> && sizeof(T) == 1);
+
+// Both sides are contiguous blocks of the same trivially copyable type
+template<typename I1, typename I2>
+concept same_bytes = std::contiguous_iterator<I1> && std::contiguous_iterator<I2> &&
+                     std::same_as<std::iter_value_t<I1>, std::iter_value_t<I2>> &&
+                     std::is_trivially_copyable_v<std::iter_value_t<I1>>;
+
+// `value` converted to T still compares equal to `value`; if not, no element
+// of type T can compare equal to it either
+template<typename T, typename V>
+bool representable(const V& value) {
+    return static_cast<V>(static_cast<T>(value)) == value;
+}
+
+#if defined(__SSE2__)
+template<simd_lane T>
+__m128i broadcast(T value) {
+    if constexpr (sizeof(T) == 1) {
+        return _mm_set1_epi8(static_cast<char>(value));
+    } else {
+        return _mm_set1_epi32(static_cast<int>(value));
+    }
+}
+
+// 16 bytes from p compared lane by lane: all ones where a lane equals needle
+template<simd_lane T>
+__m128i equal_lanes(const T* p, __m128i needle) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    if constexpr (sizeof(T) == 1) {
+        return _mm_cmpeq_epi8(block, needle);
+    } else {
+        return _mm_cmpeq_epi32(block, needle);
+    }
+}
+
+// Sum of the lane counters built up by count_lanes
+template<simd_lane T>
+size_t sum_lanes(__m128i counters) {
+    if constexpr (sizeof(T) == 1) {
+        // Two 64-bit sums of 8 bytes each
+        const __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+        return static_cast<size_t>(_mm_cvtsi128_si32(sums)) +
+               static_cast<size_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+    } else {
+        counters = _mm_add_epi32(counters, _mm_srli_si128(counters, 8));
+        counters = _mm_add_epi32(counters, _mm_srli_si128(counters, 4));
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(counters));
+    }
+}
+#endif
+
+template<simd_lane T>
+const T* find_lanes(const T* first, const T* last, T value) {
+#if defined(__SSE2__)
+    constexpr std::ptrdiff_t kLanes = 16 / sizeof(T);
+    const __m128i needle = broadcast(value);
+    for (; last - first >= kLanes; first += kLanes) {
+        // One mask bit per byte, so a 4-byte lane sets 4 bits
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(equal_lanes(first, needle)));
+        if (mask != 0) {
+            return first + std::countr_zero(mask) / sizeof(T);
+        }
+    }
+#endif
+    for (; first != last; ++first) {
+        if (*first == value) {
+            return first;
+        }
+    }
+    return last;
+}
+
+template<simd_lane T>
+size_t count_lanes(const T* first, const T* last, T value) {
+    size_t n = 0;
+#if defined(__SSE2__)
+    constexpr std::ptrdiff_t kLanes = 16 / sizeof(T);
+    const __m128i needle = broadcast(value);
+    // A matching lane compares to all ones (-1), so subtracting the
+    // comparison adds 1 to that lane's counter. Byte counters would wrap
+    // after 255 blocks, so the counters are flushed into n that often
+    while (last - first >= kLanes) {
+        __m128i counters = _mm_setzero_si128();
+        for (int block = 0; block < 255 && last - first >= kLanes; ++block, first += kLanes) {
+            const __m128i eq = equal_lanes(first, needle);
+            counters = sizeof(T) == 1 ? _mm_sub_epi8(counters, eq) : _mm_sub_epi32(counters, eq);
+        }
+        n += sum_lanes<T>(counters);
+    }
+#endif
+    for (; first != last; ++first) {
+        n += *first == value;
+    }
+    return n;
+}
+
+// Stores v into [first, last). When v tiles 16 bytes, 16 bytes at a time:
+// at -O2 GCC leaves the plain loop scalar, one element per store
+template<typename T>
+void fill_pattern(T* first, T* last, const T& v) {
+#if defined(__SSE2__)
+    if constexpr (16 % sizeof(T) == 0) {
+        constexpr std::ptrdiff_t kPerBlock = 16 / sizeof(T);
+        unsigned char pattern[16];
+        for (std::ptrdiff_t i = 0; i < kPerBlock; ++i) {
+            std::memcpy(pattern + i * sizeof(T), &v, sizeof(T));
+        }
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern));
+        for (; last - first >= kPerBlock; first += kPerBlock) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(first), block);
+        }
+    }
+#endif
+    for (; first != last; ++first) {
+        *first = v;
+    }
+}
+
+}  // namespace detail
+
+// ---------------------------------------------------------------- copy
+
+template<std::input_iterator I, std::weakly_incrementable O>
+    requires std::indirectly_copyable<I, O>
+O copy(I first, I last, O out) {
+    for (; first != last; ++first, ++out) {
+        *out = *first;
+    }
+    return out;
+}
+
+template<std::random_access_iterator I, std::weakly_incrementable O>
+    requires std::indirectly_copyable<I, O>
+O copy(I first, I last, O out) {
+    auto n = last - first;
+    for (; n >= 4; n -= 4, first += 4) {
+        *out = first[0]; ++out;
+        *out = first[1]; ++out;
+        *out = first[2]; ++out;
+        *out = first[3]; ++out;
+    }
+    for (; n > 0; --n, ++first, ++out) {
+        *out = *first;
+    }
+    return out;
+}
+
+template<std::contiguous_iterator I, std::contiguous_iterator O>
+    requires std::indirectly_copyable<I, O> && detail::same_bytes<I, O>
+O copy(I first, I last, O out) {
+    const auto n = last - first;
+    if (n > 0) {
+        // memmove, not memcpy: copying left within one buffer is allowed
+        std::memmove(std::to_address(out), std::to_address(first), n * sizeof(std::iter_value_t<I>));
+    }
+    return out + n;
+}
+
+// ---------------------------------------------------------------- fill
+
+template<std::input_or_output_iterator O, typename T>
+    requires std::indirectly_writable<O, const T&>
+O fill(O first, O last, const T& value) {
+    for (; first != last; ++first) {
+        *first = value;
+    }
+    return first;
+}
+
+template<std::random_access_iterator O, typename T>
+    requires std::indirectly_writable<O, const T&>
+O fill(O first, O last, const T& value) {
+    auto n = last - first;
+    for (; n >= 4; n -= 4, first += 4) {
+        first[0] = value;
+        first[1] = value;
+        first[2] = value;
+        first[3] = value;
+    }
+    for (; n > 0; --n, ++first) {
+        *first = value;
+    }
+    return first;
+}
+
+template<std::contiguous_iterator O, typename T>
+    requires std::indirectly_writable<O, const T&> &&
+             (std::is_scalar_v<std::iter_value_t<O>> ||
+              std::has_unique_object_representations_v<std::iter_value_t<O>>) &&
+             std::convertible_to<const T&, std::iter_value_t<O>>
+O fill(O first, O last, const T& value) {
+    using E = std::iter_value_t<O>;
+    const auto n = last - first;
+    E* p = std::to_address(first);
+    const E v = value;
+
+    unsigned char bytes[sizeof(E)];
+    std::memcpy(bytes, &v, sizeof(E));
+    if (std::all_of(bytes, bytes + sizeof(E), [&](unsigned char b) { return b == bytes[0]; })) {
+        if (n > 0) {
+            std::memset(p, bytes[0], n * sizeof(E));
+        }
+    } else {
+        detail::fill_pattern(p, p + n, v);
+    }
+    return first + n;
+}
+
+// ---------------------------------------------------------------- find
+
+template<std::input_iterator I, typename T>
+    requires std::indirect_binary_predicate<std::ranges::equal_to, I, const T*>
+I find(I first, I last, const T& value) {
+    for (; first != last; ++first) {
+        if (*first == value) {
+            return first;
+        }
+    }
+    return last;
+}
+
+template<std::random_access_iterator I, typename T>
+    requires std::indirect_binary_predicate<std::ranges::equal_to, I, const T*>
+I find(I first, I last, const T& value) {
+    auto n = last - first;
+    for (; n >= 4; n -= 4, first += 4) {
+        if (first[0] == value) return first;
+        if (first[1] == value) return first + 1;
+        if (first[2] == value) return first + 2;
+        if (first[3] == value) return first + 3;
+    }
+    for (; n > 0; --n, ++first) {
+        if (*first == value) {
+            return first;
+        }
+    }
+    return last;
+}
+
+template<std::contiguous_iterator I, typename T>
+    requires std::indirect_binary_predicate<std::ranges::equal_to, I, const T*> &&
+             detail::simd_lane<std::iter_value_t<I>> && std::integral<T>
+I find(I first, I last, const T& value) {
+    using E = std::iter_value_t<I>;
+    if (!detail::representable<E>(value)) {
+        return last;
+    }
+    const E* p = std::to_address(first);
+    const E* end = p + (last - first);
+    const E* hit;
+    if constexpr (sizeof(E) == 1) {
+        hit = static_cast<const E*>(std::memchr(p, static_cast<unsigned char>(value), end - p));
+        if (hit == nullptr) {
+            return last;
+        }
+    } else {
+        hit = detail::find_lanes(p, end, static_cast<E>(value));
+    }
+    return first + (hit - p);
+}
+
+// ---------------------------------------------------------------- count
+
+template<std::input_iterator I, typename T>
+    requires std::indirect_binary_predicate<std::ranges::equal_to, I, const T*>
+std::iter_difference_t<I> count(I first, I last, const T& value) {
+    std::iter_difference_t<I> n = 0;
+    for (; first != last; ++first) {
+        if (*first == value) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+template<std::random_access_iterator I, typename T>
+    requires std::indirect_binary_predicate<std::ranges::equal_to, I, const T*>
+std::iter_difference_t<I> count(I first, I last, const T& value) {
+    // Four independent counters, so the adds do not wait on each other
+    std::iter_difference_t<I> c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    auto n = last - first;
+    for (; n >= 4; n -= 4, first += 4) {
+        c0 += first[0] == value;
+        c1 += first[1] == value;
+        c2 += first[2] == value;
+        c3 += first[3] == value;
+    }
+    for (; n > 0; --n, ++first) {
+        c0 += *first == value;
+    }
+    return c0 + c1 + c2 + c3;
+}
+
+template<std::contiguous_iterator I, typename T>
+    requires std::indirect_binary_predicate<std::ranges::equal_to, I, const T*> &&
+             detail::simd_lane<std::iter_value_t<I>> && std::integral<T>
+std::iter_difference_t<I> count(I first, I last, const T& value) {
+    using E = std::iter_value_t<I>;
+    if (!detail::representable<E>(value)) {
+        return 0;
+    }
+    const E* p = std::to_address(first);
+    return static_cast<std::iter_difference_t<I>>(
+        detail::count_lanes(p, p + (last - first), static_cast<E>(value)));
+}
+
+// ---------------------------------------------------------------- equal
+
+template<std::input_iterator I1, std::input_iterator I2>
+    requires std::indirectly_comparable<I1, I2, std::ranges::equal_to>
+bool equal(I1 first1, I1 last1, I2 first2) {
+    for (; first1 != last1; ++first1, ++first2) {
+        if (!(*first1 == *first2)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<std::random_access_iterator I1, std::random_access_iterator I2>
+    requires std::indirectly_comparable<I1, I2, std::ranges::equal_to>
+bool equal(I1 first1, I1 last1, I2 first2) {
+    auto n = last1 - first1;
+    for (; n >= 4; n -= 4, first1 += 4, first2 += 4) {
+        // & rather than &&: four independent compares, one branch
+        if (!((first1[0] == first2[0]) & (first1[1] == first2[1]) &
+              (first1[2] == first2[2]) & (first1[3] == first2[3]))) {
+            return false;
+        }
+    }
+    for (; n > 0; --n, ++first1, ++first2) {
+        if (!(*first1 == *first2)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<std::contiguous_iterator I1, std::contiguous_iterator I2>
+    requires std::indirectly_comparable<I1, I2, std::ranges::equal_to> && detail::same_bytes<I1, I2> &&
+             std::has_unique_object_representations_v<std::iter_value_t<I1>>
+bool equal(I1 first1, I1 last1, I2 first2) {
+    const auto n = last1 - first1;
+    return n == 0 ||
+           std::memcmp(std::to_address(first1), std::to_address(first2), n * sizeof(std::iter_value_t<I1>)) == 0;
+}
+
+// ---------------------------------------------------------------- lexicographical_compare
+
+template<std::input_iterator I1, std::input_iterator I2>
+    requires std::indirectly_comparable<I1, I2, std::ranges::less>
+bool lexicographical_compare(I1 first1, I1 last1, I2 first2, I2 last2) {
+    for (; first1 != last1 && first2 != last2; ++first1, ++first2) {
+        if (*first1 < *first2) return true;
+        if (*first2 < *first1) return false;
+    }
+    return first1 == last1 && first2 != last2;
+}
+
+template<std::random_access_iterator I1, std::random_access_iterator I2>
+    requires std::indirectly_comparable<I1, I2, std::ranges::less>
+bool lexicographical_compare(I1 first1, I1 last1, I2 first2, I2 last2) {
+    const auto n1 = last1 - first1;
+    const auto n2 = last2 - first2;
+    const auto n = std::min<std::common_type_t<decltype(n1), decltype(n2)>>(n1, n2);
+    auto differs = [&](auto i) { return (first1[i] < first2[i]) | (first2[i] < first1[i]); };
+
+    // Skip equal blocks of 4, then find the first difference one at a time
+    std::remove_const_t<decltype(n)> i = 0;
+    for (; i + 4 <= n; i += 4) {
+        if (differs(i) | differs(i + 1) | differs(i + 2) | differs(i + 3)) {
+            break;
+        }
+    }
+    for (; i < n; ++i) {
+        if (differs(i)) {
+            return first1[i] < first2[i];
+        }
+    }
+    return n1 < n2;
+}
+
+template<std::contiguous_iterator I1, std::contiguous_iterator I2>
+    requires std::indirectly_comparable<I1, I2, std::ranges::less> && detail::same_bytes<I1, I2> &&
+             detail::unsigned_byte<std::iter_value_t<I1>>
+bool lexicographical_compare(I1 first1, I1 last1, I2 first2, I2 last2) {
+    const auto n1 = last1 - first1;
+    const auto n2 = last2 - first2;
+    const auto n = std::min<std::common_type_t<decltype(n1), decltype(n2)>>(n1, n2);
+    const int order = n == 0 ? 0 : std::memcmp(std::to_address(first1), std::to_address(first2), n);
+    return order < 0 || (order == 0 && n1 < n2);
+}
+
+}  // namespace fast
+
+// Every fast:: algorithm against its std:: twin on inputs chosen to hit the
+// edges of each path: empty ranges, lengths that leave a tail after the
+// unrolled/SIMD blocks, values the element type cannot hold, signed bytes
+// (memcmp would order them wrongly) and -0.0 (memcmp would call it unequal)
+template<typename Container>
+int check_against_std(Container a, Container b) {
+    int failures = 0;
+    auto expect = [&failures](bool ok) { failures += !ok; };
+    using T = typename Container::value_type;
+
+    for (size_t len = 0; len <= a.size(); ++len) {
+        auto first = a.begin();
+        auto last = std::next(first, len);
+        auto first2 = b.begin();
+        auto last2 = std::next(first2, std::min(len, b.size()));
+
+        for (int probe : {0, 3, 7, -1, 255, 256, 1 << 20}) {
+            expect(fast::find(first, last, probe) == std::find(first, last, probe));
+            expect(fast::count(first, last, probe) == std::count(first, last, probe));
+        }
+        expect(fast::equal(first, last, first2) == std::equal(first, last, first2));
+        expect(fast::lexicographical_compare(first, last, first2, last2) ==
+               std::lexicographical_compare(first, last, first2, last2));
+        expect(fast::lexicographical_compare(first2, last2, first, last) ==
+               std::lexicographical_compare(first2, last2, first, last));
+
+        Container copied(a.size()), expected(a.size());
+        auto end = fast::copy(first, last, copied.begin());
+        std::copy(first, last, expected.begin());
+        expect(std::distance(copied.begin(), end) == static_cast<std::ptrdiff_t>(len) && copied == expected);
+        for (T value : {T(0), T(7), T(-1)}) {
+            fast::fill(copied.begin(), std::next(copied.begin(), len), value);
+            std::fill(expected.begin(), std::next(expected.begin(), len), value);
+            expect(copied == expected);
+        }
+    }
+    return failures;
+}
+
+// a and b share a prefix and differ near the end, past the first SIMD
+// block; for floating point, b's zeros are -0.0
+template<typename Container>
+std::pair<Container, Container> make_pair_differing_late(const std::vector<int>& pattern) {
+    using T = typename Container::value_type;
+    Container a(pattern.begin(), pattern.end());
+    Container b = a;
+    if constexpr (std::is_floating_point_v<T>) {
+        std::replace(b.begin(), b.end(), T(0), T(-0.0));
+    }
+    *std::prev(b.end(), 2) = static_cast<T>(-1);
+    return {a, b};
+}
+
+void concept_algorithms_example() {
+    std::cout << "\n=== CONCEPT-DISPATCHED ALGORITHMS ===\n";
+
+    // Contiguous and trivially copyable: each call below takes the bytewise path
+    std::vector<unsigned char> bytes = {'c', 'o', 'n', 'c', 'e', 'p', 't', 's'};
+    std::vector<unsigned char> other(bytes.size());
+    fast::copy(bytes.begin(), bytes.end(), other.begin());           // memmove
+    std::cout << "find 'p' at index "
+              << fast::find(bytes.begin(), bytes.end(), 'p') - bytes.begin() << "\n";  // memchr
+    std::cout << "count 'c': " << fast::count(bytes.begin(), bytes.end(), 'c') << "\n";  // SSE2
+    std::cout << std::boolalpha << "equal after copy: "
+              << fast::equal(bytes.begin(), bytes.end(), other.begin()) << "\n";  // memcmp
+    fast::fill(other.begin() + 4, other.end(), 'z');                 // memset
+    std::cout << "\"concepts\" < \"conczzzz\": "
+              << fast::lexicographical_compare(bytes.begin(), bytes.end(), other.begin(), other.end()) << "\n";
+
+    // double fails the bytewise condition for equal (-0.0 == 0.0 but the
+    // bytes differ), so this resolves to the unrolled overload
+    std::vector<double> zeros = {0.0, 0.0}, negative_zeros = {-0.0, -0.0};
+    std::cout << "{0.0, 0.0} == {-0.0, -0.0}: "
+              << fast::equal(zeros.begin(), zeros.end(), negative_zeros.begin()) << "\n";
+
+    // Lengths up to 41 cover empty input, the unrolled tails and more than
+    // one 16-byte SIMD block for both lane widths
+    std::vector<int> pattern;
+    for (int i = 0; i < 41; ++i) {
+        pattern.push_back(i * 37 % 11 - (i % 5 == 0 ? 200 : 0));
+    }
+    int failures = 0;
+    failures += std::apply(check_against_std<std::vector<int>>, make_pair_differing_late<std::vector<int>>(pattern));
+    failures += std::apply(check_against_std<std::vector<unsigned char>>,
+                           make_pair_differing_late<std::vector<unsigned char>>(pattern));
+    failures += std::apply(check_against_std<std::vector<signed char>>,
+                           make_pair_differing_late<std::vector<signed char>>(pattern));
+    failures += std::apply(check_against_std<std::vector<double>>,
+                           make_pair_differing_late<std::vector<double>>(pattern));
+    failures += std::apply(check_against_std<std::deque<int>>, make_pair_differing_late<std::deque<int>>(pattern));
+    failures += std::apply(check_against_std<std::list<int>>, make_pair_differing_late<std::list<int>>(pattern));
+    std::cout << "fast:: vs std:: on vector/deque/list: " << (failures == 0 ? "all agree" : "MISMATCH")
+              << " (" << failures << " failures)\n";
+}
+
+// Benchmark: each tier against the std:: algorithm on the same container.
+// vector takes the contiguous overloads, deque the unrolled ones, list the
+// generic ones. Best of several runs, in ns per element.
+
+volatile long long concept_bench_sink;
+
+template<typename Fn>
+double ns_per_element(size_t n, Fn&& fn, long long& result) {
+    using Clock = std::chrono::steady_clock;
+    double best = 1e300;
+    double total = 0.0;
+    for (int run = 0; run < 3 || total < 20e6; ++run) {
+        const auto start = Clock::now();
+        result = fn();
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        best = std::min(best, ns);
+        total += ns;
+    }
+    concept_bench_sink = result;
+    return best / static_cast<double>(n);
+}
+
+template<typename StdFn, typename FastFn>
+void bench_row(const char* algorithm, const char* container, size_t n, StdFn&& std_fn, FastFn&& fast_fn) {
+    long long std_result = 0, fast_result = 0;
+    const double std_ns = ns_per_element(n, std_fn, std_result);
+    const double fast_ns = ns_per_element(n, fast_fn, fast_result);
+    std::cout << std::left << std::setw(24) << algorithm << std::setw(26) << container << std::right << std::fixed
+              << std::setprecision(3) << std::setw(10) << std_ns << std::setw(10) << fast_ns << std::setw(8)
+              << std::setprecision(2) << std_ns / fast_ns << "x" << (std_result == fast_result ? "" : "  MISMATCH")
+              << "\n";
+}
+
+// Cheap fingerprint of a copied/filled container: both ends
+template<typename Container>
+long long ends_of(const Container& c) {
+    return static_cast<long long>(c.front()) * 31 + static_cast<long long>(c.back());
+}
+
+constexpr size_t kBenchElements = 1 << 18;
+
+// The containers are filled so that traversal visits `values` in order; when
+// Reversed they are walked through rbegin()/rend() - random access but not
+// contiguous, and unlike deque without std:: overloads of its own
+template<typename Container, bool Reversed, typename T>
+Container in_order(const std::vector<T>& values) {
+    return Reversed ? Container(values.rbegin(), values.rend()) : Container(values.begin(), values.end());
+}
+
+// copy, fill, find, count and equal on int; the element searched for is
+// only at the very end, so find scans everything
+template<typename Container, bool Reversed = false>
+void bench_int_algorithms(const char* name) {
+    constexpr size_t n = kBenchElements;
+    std::mt19937 gen(17);
+    std::vector<int> values(n);
+    for (int& v : values) {
+        v = static_cast<int>(gen() % 1000);
+    }
+    values.back() = 1000;
+    const Container src = in_order<Container, Reversed>(values);
+    const Container same = src;
+    Container dst(n);
+    auto first = [](auto& c) {
+        if constexpr (Reversed) return c.rbegin(); else return c.begin();
+    };
+    auto last = [](auto& c) {
+        if constexpr (Reversed) return c.rend(); else return c.end();
+    };
+
+    bench_row("copy", name, n,
+              [&] { std::copy(first(src), last(src), first(dst)); return ends_of(dst); },
+              [&] { fast::copy(first(src), last(src), first(dst)); return ends_of(dst); });
+    bench_row("fill (7)", name, n,
+              [&] { std::fill(first(dst), last(dst), 7); return ends_of(dst); },
+              [&] { fast::fill(first(dst), last(dst), 7); return ends_of(dst); });
+    bench_row("find", name, n,
+              [&] { return static_cast<long long>(*std::find(first(src), last(src), 1000)); },
+              [&] { return static_cast<long long>(*fast::find(first(src), last(src), 1000)); });
+    bench_row("count", name, n,
+              [&] { return static_cast<long long>(std::count(first(src), last(src), 7)); },
+              [&] { return static_cast<long long>(fast::count(first(src), last(src), 7)); });
+    bench_row("equal", name, n,
+              [&] { return static_cast<long long>(std::equal(first(src), last(src), first(same))); },
+              [&] { return static_cast<long long>(fast::equal(first(src), last(src), first(same))); });
+}
+
+// find, count, fill and lexicographical_compare on unsigned char, where the
+// contiguous tier has memchr / memset / memcmp; the two ranges for the
+// compare only differ in their last byte
+template<typename Container, bool Reversed = false>
+void bench_byte_algorithms(const char* name) {
+    constexpr size_t n = kBenchElements;
+    std::mt19937 gen(23);
+    std::vector<unsigned char> values(n);
+    for (unsigned char& v : values) {
+        v = static_cast<unsigned char>(gen() % 255);
+    }
+    values.back() = 255;
+    const Container src = in_order<Container, Reversed>(values);
+    values.back() = 254;
+    const Container smaller = in_order<Container, Reversed>(values);
+    Container dst(n);
+    auto first = [](auto& c) {
+        if constexpr (Reversed) return c.rbegin(); else return c.begin();
+    };
+    auto last = [](auto& c) {
+        if constexpr (Reversed) return c.rend(); else return c.end();
+    };
+    const unsigned char target = 255, seven = 7, x = 'x';
+
+    bench_row("fill ('x')", name, n,
+              [&] { std::fill(first(dst), last(dst), x); return ends_of(dst); },
+              [&] { fast::fill(first(dst), last(dst), x); return ends_of(dst); });
+    bench_row("find", name, n,
+              [&] { return static_cast<long long>(*std::find(first(src), last(src), target)); },
+              [&] { return static_cast<long long>(*fast::find(first(src), last(src), target)); });
+    bench_row("count", name, n,
+              [&] { return static_cast<long long>(std::count(first(src), last(src), seven)); },
+              [&] { return static_cast<long long>(fast::count(first(src), last(src), seven)); });
+    bench_row("lexicographical_compare", name, n,
+              [&] {
+                  return static_cast<long long>(
+                      std::lexicographical_compare(first(smaller), last(smaller), first(src), last(src)));
+              },
+              [&] {
+                  return static_cast<long long>(
+                      fast::lexicographical_compare(first(smaller), last(smaller), first(src), last(src)));
+              });
+}
+
+void concept_algorithms_benchmark() {
+    std::cout << "\n=== CONCEPT-DISPATCHED ALGORITHMS: BENCHMARK (" << kBenchElements
+              << " elements, ns/element) ===\n";
+    std::cout << std::left << std::setw(24) << "algorithm" << std::setw(26) << "container (tier)" << std::right
+              << std::setw(10) << "std::" << std::setw(10) << "fast::" << std::setw(9) << "speedup" << "\n";
+
+    bench_int_algorithms<std::vector<int>>("vector<int> (contig)");
+    bench_int_algorithms<std::deque<int>>("deque<int> (unroll)");
+    bench_int_algorithms<std::vector<int>, true>("vector<int> rev (unroll)");
+    bench_int_algorithms<std::list<int>>("list<int> (generic)");
+    bench_byte_algorithms<std::vector<unsigned char>>("vector<u8> (contig)");
+    bench_byte_algorithms<std::deque<unsigned char>>("deque<u8> (unroll)");
+    bench_byte_algorithms<std::vector<unsigned char>, true>("vector<u8> rev (unroll)");
+    bench_byte_algorithms<std::list<unsigned char>>("list<u8> (generic)");
+    std::cout.unsetf(std::ios::floatfield);
+}
+
 /*
 ================================================================================
 COMPARISON: ITERATOR TAGS vs CONCEPTS
@@ -761,6 +1482,8 @@ int main() {
     practical_example();
     migration_example();
     custom_iterator_example();
+    concept_algorithms_example();
+    concept_algorithms_benchmark();
     
     return 0;
 }
@@ -0,0 +1,437 @@
+/*
+FlatStringMap: a sorted, contiguous string -> V map (header-only, just
+#include it). Used by std_map.cpp and ordered_map_benchmarks.cpp;
+StringArena also by 22_String_View/string_interner.hpp.
+
+std::map<std::string, V> is a red-black tree: one heap node per entry, plus
+another heap block for every key longer than the SSO buffer. A lookup
+follows ~log2(n) pointers to nodes scattered over the heap, and a scan
+from lower_bound() follows one more per element. Past a few thousand
+entries nearly every step is a cache miss.
+
+FlatStringMap keeps the same sorted-map interface (operator[], insert,
+try_emplace, insert_or_assign, find, at, erase, lower_bound, upper_bound,
+equal_range, sorted iteration) on different storage:
+
+  - keys and values in two sorted vectors, so a range scan walks memory
+    in order and the prefetcher keeps up
+  - key text copied into a StringArena (64 KiB blocks, no per-key
+    allocation); the sorted vector holds a string_view plus the key's
+    first 8 bytes as a big-endian integer, so most comparisons during a
+    binary search are one integer compare that touches no key text
+
+The price is insertion: a single insert shifts the tail of both vectors,
+O(n). Build or grow a map in bulk instead:
+
+    map.insert_batch(pairs);   // sort the batch, one linear merge
+
+Erased keys leave their bytes in the arena until the map is destroyed or
+cleared. Iterators are invalidated by every insert and erase (like
+std::vector). Dereferencing yields pair<string_view, V&> by value, so
+`for (const auto& [name, score] : map)` and it->first / it->second work
+as with std::map.
+*/
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Owns copies of strings; views into it stay valid until clear() or
+// destruction, because blocks never move
+class StringArena {
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    StringArena() = default;
+    StringArena(StringArena&&) noexcept = default;
+    StringArena& operator=(StringArena&&) noexcept = default;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    std::string_view store(std::string_view s) {
+        if (s.empty()) {
+            return {};
+        }
+        if (s.size() > left_) {
+            // A long string gets a block of its own, keeping the current one
+            if (s.size() > kBlockSize / 4) {
+                blocks_.push_back(std::make_unique<char[]>(s.size()));
+                std::memcpy(blocks_.back().get(), s.data(), s.size());
+                bytes_ += s.size();
+                return {blocks_.back().get(), s.size()};
+            }
+            blocks_.push_back(std::make_unique<char[]>(kBlockSize));
+            cur_ = blocks_.back().get();
+            left_ = kBlockSize;
+        }
+        char* p = cur_;
+        std::memcpy(p, s.data(), s.size());
+        cur_ += s.size();
+        left_ -= s.size();
+        bytes_ += s.size();
+        return {p, s.size()};
+    }
+
+    void clear() {
+        blocks_.clear();
+        cur_ = nullptr;
+        left_ = 0;
+        bytes_ = 0;
+    }
+
+    size_t bytes_used() const { return bytes_; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cur_ = nullptr;
+    size_t left_ = 0;
+    size_t bytes_ = 0;
+};
+
+template<typename V>
+class FlatStringMap {
+    // A key as the sorted vector sees it
+    struct Key {
+        uint64_t prefix;
+        std::string_view text;
+    };
+
+    // The first 8 bytes, zero-padded, compared as an unsigned big-endian
+    // integer: orders like the bytes themselves (char_traits<char>
+    // compares as unsigned char)
+    static uint64_t prefix_of(std::string_view s) {
+        unsigned char bytes[8] = {};
+        if (!s.empty()) {
+            std::memcpy(bytes, s.data(), std::min<size_t>(s.size(), 8));
+        }
+        uint64_t v = 0;
+        for (unsigned char b : bytes) {
+            v = (v << 8) | b;
+        }
+        return v;
+    }
+
+    // Equal prefixes only say the first 8 bytes match (or that one key is
+    // a zero-padded prefix of the other): the full compare settles it
+    static bool less(const Key& a, const Key& b) {
+        if (a.prefix != b.prefix) {
+            return a.prefix < b.prefix;
+        }
+        return a.text < b.text;
+    }
+
+    static bool equal(const Key& a, const Key& b) {
+        return a.prefix == b.prefix && a.text == b.text;
+    }
+
+    static Key probe(std::string_view s) { return Key{prefix_of(s), s}; }
+
+public:
+    using key_type = std::string_view;
+    using mapped_type = V;
+    using size_type = size_t;
+
+    template<bool Const>
+    class basic_iterator {
+        using Map = std::conditional_t<Const, const FlatStringMap, FlatStringMap>;
+        using ValueRef = std::conditional_t<Const, const V&, V&>;
+
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;     // proxy reference
+        using value_type = std::pair<std::string_view, V>;
+        using reference = std::pair<std::string_view, ValueRef>;
+        using difference_type = std::ptrdiff_t;
+
+        // it->first / it->second on a reference that is a temporary
+        struct pointer {
+            reference ref;
+            const reference* operator->() const { return &ref; }
+        };
+
+        basic_iterator() = default;
+        basic_iterator(Map* map, size_t index) : map_(map), index_(index) {}
+        // iterator -> const_iterator
+        template<bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) : map_(other.map_), index_(other.index_) {}
+
+        reference operator*() const { return {map_->keys_[index_].text, map_->values_[index_]}; }
+        pointer operator->() const { return pointer{**this}; }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        basic_iterator& operator++() { ++index_; return *this; }
+        basic_iterator operator++(int) { basic_iterator old = *this; ++index_; return old; }
+        basic_iterator& operator--() { --index_; return *this; }
+        basic_iterator operator--(int) { basic_iterator old = *this; --index_; return old; }
+        basic_iterator& operator+=(difference_type n) { index_ += n; return *this; }
+        basic_iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+        friend basic_iterator operator+(basic_iterator it, difference_type n) { return it += n; }
+        friend basic_iterator operator+(difference_type n, basic_iterator it) { return it += n; }
+        friend basic_iterator operator-(basic_iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const basic_iterator& a, const basic_iterator& b) {
+            return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+        }
+        bool operator==(const basic_iterator& other) const { return index_ == other.index_; }
+        auto operator<=>(const basic_iterator& other) const { return index_ <=> other.index_; }
+
+        size_t index() const { return index_; }
+
+    private:
+        template<bool> friend class basic_iterator;
+        friend class FlatStringMap;
+
+        Map* map_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    FlatStringMap() = default;
+    FlatStringMap(FlatStringMap&&) noexcept = default;
+    FlatStringMap& operator=(FlatStringMap&&) noexcept = default;
+
+    // The copy needs views into its own arena
+    FlatStringMap(const FlatStringMap& other) : values_(other.values_) {
+        keys_.reserve(other.keys_.size());
+        for (const Key& k : other.keys_) {
+            keys_.push_back(Key{k.prefix, arena_.store(k.text)});
+        }
+    }
+
+    FlatStringMap& operator=(const FlatStringMap& other) {
+        if (this != &other) {
+            FlatStringMap copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    // Bulk load: any range of (key, value) pairs, in any order. For
+    // duplicate keys the first one wins, as with repeated insert()
+    template<std::ranges::input_range R>
+    explicit FlatStringMap(R&& items) {
+        insert_batch(std::forward<R>(items));
+    }
+
+    // ---- Iteration and size ----
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, keys_.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, keys_.size()); }
+
+    size_t size() const { return keys_.size(); }
+    bool empty() const { return keys_.empty(); }
+
+    void reserve(size_t n) {
+        keys_.reserve(n);
+        values_.reserve(n);
+    }
+
+    void clear() {
+        keys_.clear();
+        values_.clear();
+        arena_.clear();
+    }
+
+    // Bytes of key text held by the arena, including erased keys
+    size_t key_bytes() const { return arena_.bytes_used(); }
+
+    // ---- Lookup ----
+
+    iterator lower_bound(std::string_view key) { return iterator(this, lower_index(key)); }
+    const_iterator lower_bound(std::string_view key) const { return const_iterator(this, lower_index(key)); }
+
+    iterator upper_bound(std::string_view key) { return iterator(this, upper_index(key)); }
+    const_iterator upper_bound(std::string_view key) const { return const_iterator(this, upper_index(key)); }
+
+    std::pair<iterator, iterator> equal_range(std::string_view key) {
+        const size_t i = lower_index(key);
+        return {iterator(this, i), iterator(this, i + is_at(i, key))};
+    }
+    std::pair<const_iterator, const_iterator> equal_range(std::string_view key) const {
+        const size_t i = lower_index(key);
+        return {const_iterator(this, i), const_iterator(this, i + is_at(i, key))};
+    }
+
+    iterator find(std::string_view key) {
+        const size_t i = lower_index(key);
+        return iterator(this, is_at(i, key) ? i : keys_.size());
+    }
+    const_iterator find(std::string_view key) const {
+        const size_t i = lower_index(key);
+        return const_iterator(this, is_at(i, key) ? i : keys_.size());
+    }
+
+    bool contains(std::string_view key) const { return is_at(lower_index(key), key); }
+    size_t count(std::string_view key) const { return contains(key) ? 1 : 0; }
+
+    V& at(std::string_view key) {
+        const size_t i = lower_index(key);
+        if (!is_at(i, key)) {
+            throw std::out_of_range("FlatStringMap::at: no such key");
+        }
+        return values_[i];
+    }
+    const V& at(std::string_view key) const { return const_cast<FlatStringMap*>(this)->at(key); }
+
+    // ---- Single-element modification: O(n) each, see insert_batch ----
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(std::string_view key, Args&&... args) {
+        const size_t i = lower_index(key);
+        if (is_at(i, key)) {
+            return {iterator(this, i), false};
+        }
+        values_.emplace(values_.begin() + i, std::forward<Args>(args)...);
+        keys_.insert(keys_.begin() + i, Key{prefix_of(key), arena_.store(key)});
+        return {iterator(this, i), true};
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(std::string_view key, Args&&... args) {
+        return try_emplace(key, std::forward<Args>(args)...);
+    }
+
+    std::pair<iterator, bool> insert(std::pair<std::string_view, V> kv) {
+        return try_emplace(kv.first, std::move(kv.second));
+    }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(std::string_view key, M&& value) {
+        auto [it, inserted] = try_emplace(key, std::forward<M>(value));
+        if (!inserted) {
+            values_[it.index_] = std::forward<M>(value);
+        }
+        return {it, inserted};
+    }
+
+    V& operator[](std::string_view key) { return values_[try_emplace(key).first.index_]; }
+
+    size_t erase(std::string_view key) {
+        const size_t i = lower_index(key);
+        if (!is_at(i, key)) {
+            return 0;
+        }
+        erase_at(i);
+        return 1;
+    }
+
+    iterator erase(const_iterator pos) {
+        erase_at(pos.index_);
+        return iterator(this, pos.index_);
+    }
+
+    // ---- Batched insert ----
+
+    // Inserts every (key, value) pair of `items` whose key is not present yet:
+    // sorts the batch, then merges it with the map in one linear pass. For m
+    // new items that is O(m log m + n) instead of m shifts of O(n).
+    template<std::ranges::input_range R>
+    void insert_batch(R&& items) {
+        struct Pending {
+            Key key;
+            size_t order;       // position in the batch: first occurrence wins
+        };
+        std::vector<Pending> pending;
+        std::vector<V> pending_values;
+        if constexpr (std::ranges::sized_range<R>) {
+            pending.reserve(std::ranges::size(items));
+            pending_values.reserve(std::ranges::size(items));
+        }
+        // Elements that are temporaries (a transform_view making strings)
+        // are gone by the merge: their keys are parked here until then
+        StringArena scratch;
+        constexpr bool items_are_lvalues = std::is_lvalue_reference_v<std::ranges::range_reference_t<R>>;
+        for (auto&& item : items) {
+            auto&& [k, v] = item;
+            std::string_view key(k);
+            if constexpr (!items_are_lvalues) {
+                key = scratch.store(key);
+            }
+            pending.push_back(Pending{probe(key), pending.size()});
+            if constexpr (items_are_lvalues) {
+                pending_values.push_back(v);
+            } else {
+                pending_values.push_back(std::move(v));
+            }
+        }
+        if (pending.empty()) {
+            return;
+        }
+
+        std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+            return less(a.key, b.key) || (equal(a.key, b.key) && a.order < b.order);
+        });
+
+        std::vector<Key> keys;
+        std::vector<V> values;
+        keys.reserve(keys_.size() + pending.size());
+        values.reserve(keys_.size() + pending.size());
+
+        size_t i = 0;
+        for (size_t p = 0; p < pending.size(); ++p) {
+            const Key& key = pending[p].key;
+            if (p > 0 && equal(pending[p - 1].key, key)) {
+                continue;       // a later duplicate within the batch
+            }
+            while (i < keys_.size() && less(keys_[i], key)) {
+                keys.push_back(keys_[i]);
+                values.push_back(std::move(values_[i]));
+                ++i;
+            }
+            if (i < keys_.size() && equal(keys_[i], key)) {
+                continue;       // already in the map: keep the old value
+            }
+            keys.push_back(Key{key.prefix, arena_.store(key.text)});
+            values.push_back(std::move(pending_values[pending[p].order]));
+        }
+        for (; i < keys_.size(); ++i) {
+            keys.push_back(keys_[i]);
+            values.push_back(std::move(values_[i]));
+        }
+        keys_ = std::move(keys);
+        values_ = std::move(values);
+    }
+
+private:
+    size_t lower_index(std::string_view key) const {
+        const Key k = probe(key);
+        return static_cast<size_t>(std::partition_point(keys_.begin(), keys_.end(),
+                                                        [&](const Key& e) { return less(e, k); }) -
+                                   keys_.begin());
+    }
+
+    size_t upper_index(std::string_view key) const {
+        const Key k = probe(key);
+        return static_cast<size_t>(std::partition_point(keys_.begin(), keys_.end(),
+                                                        [&](const Key& e) { return !less(k, e); }) -
+                                   keys_.begin());
+    }
+
+    bool is_at(size_t i, std::string_view key) const {
+        return i < keys_.size() && keys_[i].text == key;
+    }
+
+    void erase_at(size_t i) {
+        keys_.erase(keys_.begin() + i);
+        values_.erase(values_.begin() + i);
+    }
+
+    StringArena arena_;
+    std::vector<Key> keys_;       // sorted
+    std::vector<V> values_;       // values_[i] belongs to keys_[i]
+};
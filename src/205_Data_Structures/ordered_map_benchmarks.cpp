@@ -0,0 +1,235 @@
+/*
+g++ -std=c++20 -O2 ordered_map_benchmarks.cpp -o app
+./app            # 10^3 .. 10^7 entries (needs ~2 GiB at 10^7)
+./app --quick    # 10^3 .. 10^5
+*/
+
+// std::map<std::string, int> against FlatStringMap<int> (flat_string_map.hpp)
+// on the operations std_map.cpp shows, from 10^3 (fits in L1/L2) to 10^7
+// entries (far beyond L3).
+//
+// Keys look like "user:0123456789ab" - 17 bytes, past the 15-byte SSO
+// buffer, so every std::string key is its own heap block, as in real maps
+// of ids. They share a 5-byte prefix, so FlatStringMap's 8-byte integer
+// prefix only separates them by 3 hex digits and has to fall back on full
+// compares near the end of every search.
+//
+// Workloads (ns per operation, lower is better):
+//   build        n inserts in random order; FlatStringMap bulk-loads them
+//                with one insert_batch
+//   lookup       find() of random present keys
+//   range scan   lower_bound() at a random key, then sum the next 100
+//                values; ns per element visited
+//   mixed        rounds of 10% inserts / 90% lookups. std::map inserts one
+//                at a time; FlatStringMap collects each round's inserts
+//                and merges them with insert_batch (batch = n / 64, at least
+//                1000), which is how it is meant to absorb writes
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flat_string_map.hpp"
+
+// Keeps results observable so the optimizer cannot drop the work
+volatile long long g_sink;
+
+// A bijection on 64-bit integers (splitmix64 finalizer): distinct ids give
+// distinct, well-spread keys
+uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+std::string makeKey(uint64_t id) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "user:%012llx",
+                  static_cast<unsigned long long>(mix(id) & 0xFFFFFFFFFFFFULL));
+    return buf;
+}
+
+template<typename Fn>
+double nsPerOp(size_t ops, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(ops);
+}
+
+struct Timings {
+    double build, lookup, scan, mixed;
+};
+
+constexpr size_t kLookups = 200'000;
+constexpr size_t kScans = 2'000;
+constexpr size_t kScanLength = 100;
+constexpr int kMixedRounds = 4;
+
+// Both maps get exactly the same key sequences
+struct Workload {
+    std::vector<std::string> keys;           // the first n are loaded
+    std::vector<uint32_t> lookups;           // indexes into the loaded keys
+    std::vector<uint32_t> scans;
+    size_t n;
+    size_t batch;
+
+    explicit Workload(size_t n_) : n(n_), batch(std::max<size_t>(1000, n_ / 64)) {
+        const size_t total = n + batch * kMixedRounds;
+        keys.reserve(total);
+        for (size_t i = 0; i < total; ++i) {
+            keys.push_back(makeKey(i));
+        }
+        std::mt19937 gen(99);
+        lookups.resize(kLookups);
+        for (auto& l : lookups) l = static_cast<uint32_t>(gen() % n);
+        scans.resize(kScans);
+        for (auto& s : scans) s = static_cast<uint32_t>(gen() % n);
+    }
+
+    // Key looked up at step j of a mixed round; includes keys inserted in
+    // earlier rounds
+    const std::string& mixedKey(size_t live, size_t j) const {
+        return keys[mix(j + live) % live];
+    }
+};
+
+Timings runStdMap(const Workload& w) {
+    Timings t{};
+    std::map<std::string, int> map;
+
+    t.build = nsPerOp(w.n, [&] {
+        for (size_t i = 0; i < w.n; ++i) {
+            map.emplace(w.keys[i], static_cast<int>(i));
+        }
+    });
+
+    t.lookup = nsPerOp(kLookups, [&] {
+        long long sum = 0;
+        for (uint32_t l : w.lookups) {
+            sum += map.find(w.keys[l])->second;
+        }
+        g_sink = sum;
+    });
+
+    t.scan = nsPerOp(kScans * kScanLength, [&] {
+        long long sum = 0;
+        for (uint32_t s : w.scans) {
+            auto it = map.lower_bound(w.keys[s]);
+            for (size_t k = 0; k < kScanLength && it != map.end(); ++k, ++it) {
+                sum += it->second;
+            }
+        }
+        g_sink = sum;
+    });
+
+    const size_t lookups_per_round = w.batch * 9;
+    t.mixed = nsPerOp(kMixedRounds * (w.batch + lookups_per_round), [&] {
+        long long sum = 0;
+        size_t live = w.n;
+        for (int round = 0; round < kMixedRounds; ++round) {
+            for (size_t i = 0; i < w.batch; ++i) {
+                map.emplace(w.keys[live + i], static_cast<int>(live + i));
+            }
+            live += w.batch;
+            for (size_t j = 0; j < lookups_per_round; ++j) {
+                sum += map.find(w.mixedKey(live, j))->second;
+            }
+        }
+        g_sink = sum;
+    });
+    return t;
+}
+
+Timings runFlatMap(const Workload& w) {
+    Timings t{};
+    FlatStringMap<int> map;
+
+    t.build = nsPerOp(w.n, [&] {
+        std::vector<std::pair<std::string_view, int>> items;
+        items.reserve(w.n);
+        for (size_t i = 0; i < w.n; ++i) {
+            items.emplace_back(w.keys[i], static_cast<int>(i));
+        }
+        map.insert_batch(items);
+    });
+
+    t.lookup = nsPerOp(kLookups, [&] {
+        long long sum = 0;
+        for (uint32_t l : w.lookups) {
+            sum += map.find(w.keys[l])->second;
+        }
+        g_sink = sum;
+    });
+
+    t.scan = nsPerOp(kScans * kScanLength, [&] {
+        long long sum = 0;
+        for (uint32_t s : w.scans) {
+            auto it = map.lower_bound(w.keys[s]);
+            for (size_t k = 0; k < kScanLength && it != map.end(); ++k, ++it) {
+                sum += it->second;
+            }
+        }
+        g_sink = sum;
+    });
+
+    const size_t lookups_per_round = w.batch * 9;
+    t.mixed = nsPerOp(kMixedRounds * (w.batch + lookups_per_round), [&] {
+        long long sum = 0;
+        size_t live = w.n;
+        std::vector<std::pair<std::string_view, int>> pending;
+        for (int round = 0; round < kMixedRounds; ++round) {
+            pending.clear();
+            for (size_t i = 0; i < w.batch; ++i) {
+                pending.emplace_back(w.keys[live + i], static_cast<int>(live + i));
+            }
+            map.insert_batch(pending);
+            live += w.batch;
+            for (size_t j = 0; j < lookups_per_round; ++j) {
+                sum += map.find(w.mixedKey(live, j))->second;
+            }
+        }
+        g_sink = sum;
+    });
+    return t;
+}
+
+int main(int argc, char** argv) {
+    const bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+    std::vector<size_t> sizes = {1'000, 10'000, 100'000};
+    if (!quick) {
+        sizes.push_back(1'000'000);
+        sizes.push_back(10'000'000);
+    }
+
+    std::cout << std::left << std::setw(11) << "entries" << std::setw(12) << "workload" << std::right
+              << std::setw(14) << "std::map ns" << std::setw(14) << "flat ns" << std::setw(10) << "speedup"
+              << "\n";
+    for (size_t n : sizes) {
+        Workload w(n);
+        const Timings tree = runStdMap(w);
+        const Timings flat = runFlatMap(w);
+
+        auto row = [n](const char* name, double a, double b) {
+            std::cout << std::left << std::setw(11) << n << std::setw(12) << name << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(14) << a << std::setw(14) << b << std::setw(9)
+                      << std::setprecision(2) << a / b << "x\n";
+        };
+        row("build", tree.build, flat.build);
+        row("lookup", tree.lookup, flat.lookup);
+        row("range scan", tree.scan, flat.scan);
+        row("mixed", tree.mixed, flat.mixed);
+        std::cout << std::flush;
+    }
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+SlotMap: objects of one type in a contiguous array, referred to by
+generational 32-bit handles (header-only, just #include it).
+Used by smart_pointers.cpp (section 12).
+
+An object graph of shared_ptr edges and weak_ptr back-links pays for
+ownership on every edge: a control block per object, an atomic increment
+and decrement per copied shared_ptr, two atomic operations per weak_ptr
+lock(), and every hop is a pointer into wherever the allocator put the
+node.
+
+A SlotMap owns all objects of its type and hands out Handle<T> instead:
+
+    SlotMap<Child> children;
+    Handle<Child> alice = children.emplace("Alice");
+    if (Child* c = children.get(alice)) { ... }     // nullptr once erased
+    children.erase(alice);                          // O(1)
+
+A handle is a slot index plus the generation the slot had when the object
+was inserted. Erasing an object bumps its slot's generation, so every
+handle to it - however many copies exist - stops resolving, the way a
+weak_ptr expires, without any reference counts. The slot is then reused
+for a later insert under the new generation. A slot whose generation would
+wrap around is retired instead, so an old handle can never come back to
+life.
+
+The objects themselves live in one dense vector, in no particular order:
+erase() moves the last object into the hole (O(1)), and each slot records
+where its object currently is. Iterating a SlotMap walks that vector
+linearly. The price is that pointers and references from get() are
+invalidated by any insert or erase - keep handles, not pointers.
+
+SlotMap<T, IndexBits> holds up to 2^IndexBits - 1 objects; the remaining
+bits of the handle are the generation. Handles from a different SlotMap
+are not detected. Not thread-safe.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+template<typename T>
+struct Handle {
+    uint32_t value = 0;     // 0 is never issued: the null handle
+
+    explicit operator bool() const { return value != 0; }
+    friend bool operator==(Handle, Handle) = default;
+};
+
+template<typename T, unsigned IndexBits = 20>
+class SlotMap {
+    static_assert(IndexBits > 0 && IndexBits < 32, "the generation needs some of the 32 bits");
+
+    static constexpr uint32_t kIndexMask = (uint32_t{1} << IndexBits) - 1;
+    static constexpr uint32_t kGenerationMask = UINT32_MAX >> IndexBits;
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+    struct Slot {
+        uint32_t index;         // live: position in m_values; free: next free slot
+        uint32_t generation;    // 1..kGenerationMask while usable, 0 once retired
+    };
+
+public:
+    using value_type = T;
+
+    static constexpr size_t max_size() { return kIndexMask; }
+
+    template<typename... Args>
+    Handle<T> emplace(Args&&... args) {
+        if (m_free_head == kNoSlot && m_slots.size() == kIndexMask) {
+            throw std::length_error("SlotMap: no free slot");
+        }
+        m_values.emplace_back(std::forward<Args>(args)...);
+        uint32_t slot = m_free_head;
+        if (slot != kNoSlot) {
+            m_free_head = m_slots[slot].index;
+        } else {
+            slot = static_cast<uint32_t>(m_slots.size());
+            m_slots.push_back(Slot{0, 1});
+        }
+        m_dense_slots.push_back(slot);
+        m_slots[slot].index = static_cast<uint32_t>(m_values.size() - 1);
+        return Handle<T>{(m_slots[slot].generation << IndexBits) | slot};
+    }
+
+    Handle<T> insert(T value) { return emplace(std::move(value)); }
+
+    // Destroys the object; false if the handle was already stale
+    bool erase(Handle<T> h) {
+        const uint32_t slot = h.value & kIndexMask;
+        if (!valid(h)) {
+            return false;
+        }
+        const uint32_t index = m_slots[slot].index;
+        const uint32_t last = static_cast<uint32_t>(m_values.size() - 1);
+        if (index != last) {
+            m_values[index] = std::move(m_values[last]);
+            m_dense_slots[index] = m_dense_slots[last];
+            m_slots[m_dense_slots[index]].index = index;
+        }
+        m_values.pop_back();
+        m_dense_slots.pop_back();
+
+        Slot& s = m_slots[slot];
+        s.generation = (s.generation + 1) & kGenerationMask;
+        if (s.generation != 0) {
+            s.index = m_free_head;
+            m_free_head = slot;
+        }
+        return true;
+    }
+
+    // The object, or nullptr if it has been erased
+    T* get(Handle<T> h) { return valid(h) ? &m_values[m_slots[h.value & kIndexMask].index] : nullptr; }
+    const T* get(Handle<T> h) const {
+        return valid(h) ? &m_values[m_slots[h.value & kIndexMask].index] : nullptr;
+    }
+
+    bool contains(Handle<T> h) const { return valid(h); }
+
+    // The handle of the object at position i of values()
+    Handle<T> handle_at(size_t i) const {
+        const uint32_t slot = m_dense_slots[i];
+        return Handle<T>{(m_slots[slot].generation << IndexBits) | slot};
+    }
+
+    // All objects, contiguous and in no particular order
+    std::span<T> values() { return m_values; }
+    std::span<const T> values() const { return m_values; }
+    auto begin() { return m_values.begin(); }
+    auto end() { return m_values.end(); }
+    auto begin() const { return m_values.begin(); }
+    auto end() const { return m_values.end(); }
+
+    size_t size() const { return m_values.size(); }
+    bool empty() const { return m_values.empty(); }
+
+    void reserve(size_t n) {
+        m_values.reserve(n);
+        m_dense_slots.reserve(n);
+        m_slots.reserve(n);
+    }
+
+    // Erases everything; every handle issued so far becomes stale
+    void clear() {
+        while (!m_values.empty()) {
+            erase(handle_at(m_values.size() - 1));
+        }
+    }
+
+private:
+    bool valid(Handle<T> h) const {
+        const uint32_t slot = h.value & kIndexMask;
+        const uint32_t generation = h.value >> IndexBits;
+        return generation != 0 && slot < m_slots.size() && m_slots[slot].generation == generation;
+    }
+
+    std::vector<T> m_values;
+    std::vector<uint32_t> m_dense_slots;    // slot of each value
+    std::vector<Slot> m_slots;
+    uint32_t m_free_head = kNoSlot;
+};
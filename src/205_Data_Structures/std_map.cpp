@@ -5,6 +5,10 @@ g++ -pthread --std=c++20 std_map.cpp -o app
 #include <map>
 #include <string>
 #include <iostream>
+#include <utility>
+#include <vector>
+
+#include "flat_string_map.hpp"
 
 int main() {
     // Creation (automatically sorted by key using std::less<std::string> by default)
@@ -56,6 +60,29 @@ int main() {
     // - Deletion: O(log n)
     // - Maintains sorted order
     // Compare with std::unordered_map: O(1) average for insert/lookup/delete, no ordering
+
+    // Cache-friendly alternative: FlatStringMap (flat_string_map.hpp) keeps the
+    // entries in one sorted array and the key text in an arena, so lookups and
+    // range scans walk contiguous memory instead of chasing tree nodes.
+    // Same interface for the calls above:
+    FlatStringMap<int> flat;
+    flat["Alice"] = 95;
+    flat["Charlie"] = 88;
+    flat.insert({"Bob", 92});
+    for (const auto& [name, score] : flat) {
+        std::cout << name << ": " << score << std::endl;
+    }
+    auto flat_it = flat.lower_bound("Bob");
+    std::cout << "First >= Bob: " << flat_it->first << std::endl;
+    auto [low, high] = flat.equal_range("Bob");
+    std::cout << "Entries == Bob: " << (high - low) << std::endl;
+
+    // A single insert is O(n) (it shifts the array), so grow it in batches:
+    // the batch is sorted and merged in one pass
+    std::vector<std::pair<std::string, int>> batch = {{"Eve", 87}, {"David", 90}, {"Frank", 85}};
+    flat.insert_batch(batch);
+    std::cout << "After batch insert: " << flat.size() << " entries, first " << flat.begin()->first << std::endl;
+    // Benchmarks against std::map: ordered_map_benchmarks.cpp
     
     return 0;
 }
\ No newline at end of file
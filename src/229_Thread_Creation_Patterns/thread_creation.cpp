@@ -1,5 +1,5 @@
 /*
-g++ -pthread --std=c++14 thread_creation.cpp -o app
+g++ -pthread --std=c++20 -O2 thread_creation.cpp -o app
 */
 
 #include <iostream>
@@ -9,6 +9,10 @@ g++ -pthread --std=c++14 thread_creation.cpp -o app
 #include <chrono>
 #include <future>
 #include <mutex>
+#include <numeric>
+#include <stdexcept>
+
+#include "../101_Threads_RAII/task_group.hpp"
 
 std::mutex mtx;
 
@@ -28,6 +32,67 @@ int calculate_sum(int start, int end) {
     return sum;
 }
 
+// Busy work for a given duration: a job of known size, independent of sleep granularity
+void spin_for(std::chrono::nanoseconds duration) {
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+// Divide and conquer: every level waits on a nested group from a pool worker
+long long parallel_sum(ThreadPoolRAII& pool, const std::vector<int>& data, size_t begin, size_t end) {
+    if (end - begin <= 4096) {
+        return std::accumulate(data.begin() + begin, data.begin() + end, 0LL);
+    }
+    const size_t mid = begin + (end - begin) / 2;
+    TaskGroup<long long> group(pool);
+    group.run([&] { return parallel_sum(pool, data, begin, mid); });
+    group.run([&] { return parallel_sum(pool, data, mid, end); });
+    const std::vector<long long> halves = group.wait();
+    return halves[0] + halves[1];
+}
+
+// Spawn-per-task vs TaskGroup on a pool, for jobs of 1 us .. 1 ms
+void benchmark_spawn_vs_group(ThreadPoolRAII& pool) {
+    std::cout << "\n=== Benchmark: thread per job vs TaskGroup (" << std::thread::hardware_concurrency()
+              << " hardware threads) ===" << std::endl;
+    struct Case {
+        std::chrono::nanoseconds job;
+        int jobs;
+    };
+    const Case cases[] = {{std::chrono::microseconds(1), 2000},
+                          {std::chrono::microseconds(10), 2000},
+                          {std::chrono::microseconds(100), 500},
+                          {std::chrono::milliseconds(1), 100}};
+    for (const Case& c : cases) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        threads.reserve(c.jobs);
+        for (int i = 0; i < c.jobs; ++i) {
+            threads.emplace_back(spin_for, c.job);
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        const double spawn_us =
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        TaskGroup<> group(pool);
+        for (int i = 0; i < c.jobs; ++i) {
+            group.run([job = c.job] { spin_for(job); });
+        }
+        group.wait();
+        const double group_us =
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        const double work_us = std::chrono::duration<double, std::micro>(c.job).count();
+        std::cout << c.jobs << " jobs of " << work_us << " us: thread per job " << spawn_us / c.jobs
+                  << " us/job, TaskGroup " << group_us / c.jobs << " us/job (" << spawn_us / group_us << "x)"
+                  << std::endl;
+    }
+}
+
 int main() {
     std::cout << "=== Basic Pattern with emplace_back ===" << std::endl;
     
@@ -97,5 +162,41 @@ int main() {
         }
     }
     
+    std::cout << "\n=== Pattern with a TaskGroup on a shared pool ===" << std::endl;
+
+    // Pattern 4: the return-value pattern without a thread, promise or join per job
+    {
+        ThreadPoolRAII pool(std::max(2u, std::thread::hardware_concurrency()));
+
+        TaskGroup<int> sums(pool);
+        for (int i = 0; i < 3; ++i) {
+            sums.run([i] { return calculate_sum(i * 10, (i + 1) * 10); });
+        }
+        const std::vector<int> results = sums.wait();     // in run() order
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::cout << "Sum " << i << ": " << results[i] << std::endl;
+        }
+
+        // Exceptions reach the waiting parent
+        TaskGroup<> failing(pool);
+        failing.run([] { throw std::runtime_error("child failed"); });
+        failing.run([] {});
+        try {
+            failing.wait();
+        } catch (const std::exception& e) {
+            std::cout << "wait() rethrew: " << e.what() << std::endl;
+        }
+
+        // Nested groups on every level: waiting parents run children inline
+        std::vector<int> data(1 << 20);
+        std::iota(data.begin(), data.end(), 0);
+        TaskGroup<long long> root(pool);
+        root.run([&] { return parallel_sum(pool, data, 0, data.size()); });
+        std::cout << "Nested parallel sum: " << root.wait()[0] << " (expected "
+                  << std::accumulate(data.begin(), data.end(), 0LL) << ")" << std::endl;
+
+        benchmark_spawn_vs_group(pool);
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,258 @@
+/*
+Concurrent string interning (header-only, just #include it).
+Used by string_interner_demo.cpp.
+
+A std::string_view avoids a copy, but something still has to own the
+characters. Code that keeps many keys - cache keys, command names, log
+tags - ends up owning each one in its own std::string, so the same text
+is stored once per occurrence, and every comparison and hash walks it.
+
+StringInterner stores each distinct string once and hands back a Symbol:
+a 32-bit id that compares, hashes and copies like an integer.
+
+    StringInterner& names = StringInterner::global();
+    Symbol a = names.intern("SEND");        // the first call copies "SEND"
+    Symbol b = names.intern(line.substr(0, 4));
+    if (a == b) { ... }                     // an integer compare
+    std::string_view text = names.view(a);  // valid for the interner's lifetime
+
+Characters go into StringArena blocks (see flat_string_map.hpp) that never
+move, so intern_view() returns string_views that stay valid, and two
+interned views are equal exactly when their data() pointers are.
+
+The table is split into 16 shards chosen by the top bits of the hash.
+Each shard has an open-addressing table of (hash tag, id) slots under a
+std::shared_mutex: interning a string that is already there takes the
+shared lock only, so concurrent lookups of known strings do not serialize;
+a new string takes its shard's exclusive lock. view() takes no lock: ids
+index a per-shard directory of chunks that are allocated once, never move
+and never shrink. Nothing is ever removed; memory grows with the number of
+distinct strings, not with the number of times they are interned.
+*/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "../205_Data_Structures/flat_string_map.hpp"
+
+// An interned string's id; the default value is "no string"
+struct Symbol {
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    uint32_t id = kNone;
+
+    explicit operator bool() const { return id != kNone; }
+    friend bool operator==(Symbol, Symbol) = default;
+};
+
+template<>
+struct std::hash<Symbol> {
+    size_t operator()(Symbol s) const noexcept {
+        return static_cast<size_t>(s.id) * 0x9E3779B97F4A7C15ull;   // ids are dense: spread them
+    }
+};
+
+class StringInterner {
+    static constexpr unsigned kShardBits = 4;
+    static constexpr size_t kShards = size_t{1} << kShardBits;
+
+    // Chunk c of a shard's directory holds kFirstChunk << c views; 20
+    // chunks hold just under the 2^28 ids a shard can encode
+    static constexpr size_t kFirstChunk = 256;
+    static constexpr size_t kChunks = 20;
+    static constexpr uint32_t kMaxPerShard = kFirstChunk * ((size_t{1} << kChunks) - 1);
+
+    struct Slot {
+        uint32_t tag = 0;       // high half of the hash
+        uint32_t local = 0;     // index in the shard + 1; 0 marks a free slot
+    };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        StringArena arena;
+        std::vector<Slot> slots;
+        uint32_t count = 0;
+        std::array<std::atomic<std::string_view*>, kChunks> chunks{};
+
+        ~Shard() {
+            for (auto& chunk : chunks) {
+                delete[] chunk.load(std::memory_order_relaxed);
+            }
+        }
+
+        static size_t chunk_of(uint32_t local, size_t& offset) {
+            const size_t v = local + kFirstChunk;
+            const size_t c = std::bit_width(v) - std::bit_width(kFirstChunk);
+            offset = v - (kFirstChunk << c);
+            return c;
+        }
+
+        std::string_view text(uint32_t local) const {
+            size_t offset;
+            const size_t c = chunk_of(local, offset);
+            return chunks[c].load(std::memory_order_acquire)[offset];
+        }
+
+        // Caller holds the shared or the exclusive lock; 0 if absent
+        uint32_t find(std::string_view s, uint64_t h) const {
+            if (slots.empty()) {
+                return 0;
+            }
+            const uint32_t tag = static_cast<uint32_t>(h >> 32);
+            const size_t mask = slots.size() - 1;
+            for (size_t i = h & mask;; i = (i + 1) & mask) {
+                const Slot& slot = slots[i];
+                if (slot.local == 0) {
+                    return 0;
+                }
+                if (slot.tag == tag && text(slot.local - 1) == s) {
+                    return slot.local;
+                }
+            }
+        }
+
+        // Caller holds the exclusive lock and has checked that s is absent
+        uint32_t insert(std::string_view s, uint64_t h) {
+            if (count == kMaxPerShard) {
+                throw std::length_error("StringInterner: shard is full");
+            }
+            if ((count + 1) * 2 > slots.size()) {
+                grow();
+            }
+            const uint32_t local = count;
+            size_t offset;
+            const size_t c = chunk_of(local, offset);
+            std::string_view* chunk = chunks[c].load(std::memory_order_relaxed);
+            if (chunk == nullptr) {
+                chunk = new std::string_view[kFirstChunk << c];
+            }
+            chunk[offset] = arena.store(s);
+            chunks[c].store(chunk, std::memory_order_release);
+            place(Slot{static_cast<uint32_t>(h >> 32), local + 1}, h);
+            ++count;
+            return local + 1;
+        }
+
+        void place(Slot slot, uint64_t h) {
+            const size_t mask = slots.size() - 1;
+            size_t i = h & mask;
+            while (slots[i].local != 0) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = slot;
+        }
+
+        void grow() {
+            std::vector<Slot> old(slots.empty() ? 64 : slots.size() * 2);
+            old.swap(slots);
+            for (const Slot& slot : old) {
+                if (slot.local != 0) {
+                    place(slot, hash(text(slot.local - 1)));
+                }
+            }
+        }
+    };
+
+public:
+    StringInterner() = default;
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // Process-wide interner, for symbols shared between components
+    static StringInterner& global() {
+        static StringInterner instance;
+        return instance;
+    }
+
+    /**
+     * Returns the symbol for s, storing a copy of s the first time it is seen.
+     * @throws std::length_error if s's shard is full (about 2^28 strings)
+     */
+    Symbol intern(std::string_view s) {
+        const uint64_t h = hash(s);
+        const size_t index = h >> (64 - kShardBits);
+        Shard& shard = m_shards[index];
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (const uint32_t local = shard.find(s, h)) {
+                return make_symbol(index, local);
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        uint32_t local = shard.find(s, h);      // another thread may have added it
+        if (local == 0) {
+            local = shard.insert(s, h);
+        }
+        return make_symbol(index, local);
+    }
+
+    // Interns s and returns the stored copy
+    std::string_view intern_view(std::string_view s) { return view(intern(s)); }
+
+    // The symbol for s if it has been interned, otherwise an empty Symbol
+    Symbol find(std::string_view s) const {
+        const uint64_t h = hash(s);
+        const size_t index = h >> (64 - kShardBits);
+        const Shard& shard = m_shards[index];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const uint32_t local = shard.find(s, h);
+        return local == 0 ? Symbol{} : make_symbol(index, local);
+    }
+
+    // The text of a symbol returned by this interner; no lock
+    std::string_view view(Symbol s) const {
+        return m_shards[s.id & (kShards - 1)].text((s.id >> kShardBits) - 1);
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (const Shard& shard : m_shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            n += shard.count;
+        }
+        return n;
+    }
+
+    // Bytes held: string text, hash tables and view directories
+    size_t bytes_used() const {
+        size_t bytes = sizeof(*this);
+        for (const Shard& shard : m_shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            bytes += shard.arena.bytes_used() + shard.slots.capacity() * sizeof(Slot);
+            for (size_t c = 0; c < kChunks; ++c) {
+                if (shard.chunks[c].load(std::memory_order_relaxed) != nullptr) {
+                    bytes += (kFirstChunk << c) * sizeof(std::string_view);
+                }
+            }
+        }
+        return bytes;
+    }
+
+private:
+    static uint64_t hash(std::string_view s) {
+        // std::hash may be the identity-ish on some platforms; mix it so the
+        // top bits (shard) and the low bits (slot) are both well spread
+        uint64_t h = std::hash<std::string_view>{}(s);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    static Symbol make_symbol(size_t shard, uint32_t local) {
+        return Symbol{(local << kShardBits) | static_cast<uint32_t>(shard)};
+    }
+
+    std::array<Shard, kShards> m_shards;
+};
@@ -0,0 +1,219 @@
+// g++ -std=c++20 -O2 -pthread string_interner_demo.cpp -o app
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "string_interner.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Live heap bytes (as requested; malloc's own overhead comes on top)
+std::atomic<int64_t> g_live_bytes{0};
+
+void* operator new(std::size_t size) {
+    auto* p = static_cast<std::size_t*>(std::malloc(size + 16));
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    *p = size;
+    g_live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    return reinterpret_cast<char*>(p) + 16;
+}
+
+void operator delete(void* p) noexcept {
+    if (p != nullptr) {
+        auto* header = reinterpret_cast<std::size_t*>(static_cast<char*>(p) - 16);
+        g_live_bytes.fetch_sub(static_cast<int64_t>(*header), std::memory_order_relaxed);
+        std::free(header);
+    }
+}
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+
+double mb(int64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+
+// Keys like cache keys: 100k distinct, most longer than the SSO buffer
+std::vector<std::string> make_keys(size_t distinct) {
+    std::vector<std::string> keys;
+    keys.reserve(distinct);
+    for (size_t i = 0; i < distinct; ++i) {
+        keys.push_back("user:" + std::to_string(i * 7919 % 1'000'003) + ":session:profile");
+    }
+    return keys;
+}
+
+// ============================================================================
+// 1. FOOTPRINT: 2M keys drawn from 100k distinct strings
+// ============================================================================
+void demonstrateFootprint(const std::vector<std::string>& keys, const std::vector<uint32_t>& stream) {
+    std::cout << "\n=== FOOTPRINT: " << stream.size() << " KEYS, " << keys.size() << " DISTINCT ===\n";
+    {
+        const int64_t before = g_live_bytes.load();
+        std::vector<std::string> owned;
+        owned.reserve(stream.size());
+        for (uint32_t k : stream) {
+            owned.push_back(keys[k]);
+        }
+        std::cout << "vector<std::string>, a copy per key:   " << mb(g_live_bytes.load() - before) << " MB\n";
+    }
+    {
+        const int64_t before = g_live_bytes.load();
+        std::unordered_set<std::string> set;
+        for (uint32_t k : stream) {
+            set.insert(keys[k]);
+        }
+        std::cout << "unordered_set<std::string>, distinct:   " << mb(g_live_bytes.load() - before) << " MB\n";
+    }
+    {
+        const int64_t before = g_live_bytes.load();
+        StringInterner interner;
+        std::vector<Symbol> symbols;
+        symbols.reserve(stream.size());
+        for (uint32_t k : stream) {
+            symbols.push_back(interner.intern(keys[k]));
+        }
+        const int64_t table = static_cast<int64_t>(interner.bytes_used());
+        std::cout << "StringInterner + vector<Symbol>:        " << mb(g_live_bytes.load() - before) << " MB ("
+                  << mb(table) << " MB of it the interner, " << interner.size() << " strings)\n";
+    }
+}
+
+// ============================================================================
+// 2. LOOKUP RATE: interning known strings vs unordered_set::find
+// ============================================================================
+template<typename Lookup>
+double mops(int threads, const std::vector<std::string>& keys, const std::vector<uint32_t>& stream, Lookup lookup) {
+    std::atomic<size_t> sink{0};
+    std::vector<std::thread> workers;
+    const auto start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            size_t local = 0;
+            for (size_t i = t; i < stream.size(); i += threads) {
+                local += lookup(keys[stream[i]]);
+            }
+            sink += local;
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(stream.size()) / seconds / 1e6;
+}
+
+void benchmarkLookups(const std::vector<std::string>& keys, const std::vector<uint32_t>& stream) {
+    std::cout << "\n=== LOOKUPS OF KNOWN KEYS, Mops/s (" << std::thread::hardware_concurrency()
+              << " hardware threads) ===\n";
+    StringInterner interner;
+    std::unordered_set<std::string> set;
+    std::shared_mutex set_mutex;
+    for (const auto& key : keys) {
+        interner.intern(key);
+        set.insert(key);
+    }
+    for (int threads : {1, 4, 8}) {
+        const double interned = mops(threads, keys, stream, [&](const std::string& k) {
+            return static_cast<size_t>(interner.intern(k).id);
+        });
+        const double hashed = mops(threads, keys, stream, [&](const std::string& k) {
+            std::shared_lock<std::shared_mutex> lock(set_mutex);
+            return set.find(k)->size();
+        });
+        std::cout << threads << " thread(s): StringInterner::intern " << interned
+                  << ", unordered_set::find under a shared_mutex " << hashed << "\n";
+    }
+}
+
+// ============================================================================
+// 3. KEYS IN A MAP: counting occurrences by string vs by Symbol
+// ============================================================================
+void benchmarkMapKeys(const std::vector<std::string>& keys, const std::vector<uint32_t>& stream) {
+    std::cout << "\n=== COUNTING 2M OCCURRENCES ===\n";
+    StringInterner interner;
+    std::vector<Symbol> symbols;
+    std::vector<std::string_view> views;
+    for (uint32_t k : stream) {
+        symbols.push_back(interner.intern(keys[k]));
+        views.push_back(interner.intern_view(keys[k]));
+    }
+
+    auto start = Clock::now();
+    std::unordered_map<std::string, int> by_string;
+    for (uint32_t k : stream) {
+        ++by_string[keys[k]];
+    }
+    const double string_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    std::unordered_map<Symbol, int> by_symbol;
+    for (Symbol s : symbols) {
+        ++by_symbol[s];
+    }
+    const double symbol_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    const std::string_view first = interner.intern_view(keys[0]);
+    size_t same_pointer = 0;
+    for (std::string_view v : views) {
+        same_pointer += v.data() == first.data();
+    }
+    std::cout << "unordered_map<std::string, int>: " << string_ms << " ms, unordered_map<Symbol, int>: "
+              << symbol_ms << " ms\n";
+    std::cout << "\"" << first << "\" occurs " << by_symbol[interner.find(keys[0])]
+              << " times; interned views with its data() pointer: " << same_pointer << "\n";
+}
+
+// ============================================================================
+// 4. CONCURRENT INTERNING OF NEW STRINGS
+// ============================================================================
+void demonstrateConcurrentInsert() {
+    std::cout << "\n=== 4 THREADS INTERNING OVERLAPPING NEW STRINGS ===\n";
+    StringInterner interner;
+    std::vector<std::vector<Symbol>> seen(4);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < 50'000; ++i) {
+                seen[t].push_back(interner.intern("cmd-" + std::to_string((i * (t + 1)) % 60'000)));
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    // Every thread must have got the same symbol for the same text
+    size_t mismatches = 0;
+    for (int t = 0; t < 4; ++t) {
+        for (int i = 0; i < 50'000; ++i) {
+            const std::string text = "cmd-" + std::to_string((i * (t + 1)) % 60'000);
+            mismatches += interner.find(text) != seen[t][i] || interner.view(seen[t][i]) != text;
+        }
+    }
+    std::cout << interner.size() << " distinct strings, " << mismatches << " mismatched symbols\n";
+}
+
+int main() {
+    const std::vector<std::string> keys = make_keys(100'000);
+    std::vector<uint32_t> stream(2'000'000);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(keys.size() - 1));
+    for (auto& k : stream) {
+        k = pick(rng);
+    }
+
+    demonstrateFootprint(keys, stream);
+    benchmarkLookups(keys, stream);
+    benchmarkMapKeys(keys, stream);
+    demonstrateConcurrentInsert();
+    return 0;
+}
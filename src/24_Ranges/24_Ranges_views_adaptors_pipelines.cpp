@@ -1,7 +1,7 @@
 /*
  * C++20 Ranges - Comprehensive Examples
- * Compile with: g++ -std=c++20 ranges_examples.cpp -o ranges_examples
- * or: clang++ -std=c++20 ranges_examples.cpp -o ranges_examples
+ * Compile with: g++ -std=c++20 -O2 -pthread 24_Ranges_views_adaptors_pipelines.cpp -o ranges_examples
+ * or: clang++ -std=c++20 -O2 -pthread 24_Ranges_views_adaptors_pipelines.cpp -o ranges_examples
  */
 
 #include <ranges>
@@ -13,6 +13,11 @@
 #include <algorithm>
 #include <numeric>
 #include <cctype>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include "parallel_pipeline.hpp"
 
 // Namespace alias for convenience
 namespace views = std::ranges::views;
@@ -476,6 +481,63 @@ void section12_pitfalls() {
     std::cout << "  - Need to store results permanently\n";
 }
 
+// ============================================================================
+// SECTION 13: PARALLEL PIPELINES
+// ============================================================================
+
+// Steps for n to reach 1 in the Collatz sequence: cheap to write, uneven
+// and not free to compute, like a real per-element transform
+int collatz_steps(long long n) {
+    int steps = 0;
+    while (n > 1) {
+        n = (n % 2 == 0) ? n / 2 : 3 * n + 1;
+        ++steps;
+    }
+    return steps;
+}
+
+void section13_parallel_pipelines() {
+    std::cout << "\n\n=== SECTION 13: PARALLEL PIPELINES ===\n";
+
+    // 13.1 The pipeline is written once, as an adaptor closure...
+    auto odd_collatz = views::filter([](long long x) { return x % 2 == 1; })
+                     | views::transform([](long long x) { return collatz_steps(x); });
+
+    const long long n = 4'000'000;
+    auto numbers = views::iota(1LL, n + 1);     // random-access and sized
+
+    // ...and run sequentially: the view is evaluated element by element
+    auto start = std::chrono::steady_clock::now();
+    long long sequential = 0;
+    for (int steps : numbers | odd_collatz) {
+        sequential += steps;
+    }
+    auto sequential_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "\n13.1 Sequential filter | transform, " << n << " numbers: sum of steps "
+              << sequential << " in " << sequential_ms << " ms\n";
+
+    // 13.2 ...or in parallel: each chunk of `numbers` runs the same closure
+    const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    ThreadPoolRAII pool(threads);
+    start = std::chrono::steady_clock::now();
+    long long parallel = numbers | par(pool, odd_collatz) | par_reduce(0LL, std::plus<>{});
+    auto parallel_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "13.2 par_reduce on " << threads << " worker(s): sum of steps " << parallel << " in "
+              << parallel_ms << " ms (" << (parallel == sequential ? "same result" : "MISMATCH") << ", "
+              << sequential_ms / parallel_ms << "x)\n";
+
+    // 13.3 par_to keeps the sequential order
+    std::vector<int> data(1'000'000);
+    std::iota(data.begin(), data.end(), 0);
+    auto evens_squared = views::filter([](int x) { return x % 2 == 0; })
+                       | views::transform([](int x) { return x / 2 * 3; });
+    std::vector<int> par_result = data | par(pool, evens_squared) | par_to<std::vector>();
+    std::vector<int> seq_result;
+    ranges::copy(data | evens_squared, std::back_inserter(seq_result));
+    std::cout << "13.3 par_to<std::vector>: " << par_result.size() << " elements, "
+              << (par_result == seq_result ? "same order as sequential" : "ORDER DIFFERS") << "\n";
+}
+
 // ============================================================================
 // MAIN FUNCTION
 // ============================================================================
@@ -497,6 +559,7 @@ int main() {
     section10_patterns();
     section11_conversion();
     section12_pitfalls();
+    section13_parallel_pipelines();
     
     std::cout << "\n\n╔══════════════════════════════════════════════════════╗\n";
     std::cout << "║   END OF EXAMPLES                                    ║\n";
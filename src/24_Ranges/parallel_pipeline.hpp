@@ -0,0 +1,174 @@
+/*
+Parallel terminals for lazy ranges pipelines (header-only, just #include it).
+Used by 24_Ranges_views_adaptors_pipelines.cpp and 73_views.cpp.
+
+A pipeline like
+
+    data | views::filter(is_even) | views::transform(square)
+
+is evaluated one element at a time by whoever iterates it. The std::execution
+algorithms in parallel_stl.cpp cannot help: filter_view is not random-access,
+so there is nothing to hand out to threads.
+
+But the *underlying* range usually is random-access and sized. So instead of
+parallelising the finished view, keep the pipeline as an adaptor closure and
+apply it to each chunk of the underlying range separately:
+
+    auto evens_squared = views::filter(is_even) | views::transform(square);
+
+    long long sum = data | par(pool, evens_squared) | par_reduce(0LL, std::plus<>{});
+    std::vector<int> v = data | par(pool, evens_squared) | par_to<std::vector>();
+
+par() cuts `data` into chunks, each chunk runs `chunk | evens_squared` on a
+ThreadPoolRAII worker (see 101_Threads_RAII/thread_pool.hpp), and the chunk
+results are merged in chunk order - so par_to keeps the sequential order and
+par_reduce only needs `op` to be associative, not commutative.
+
+The stages must be safe to run concurrently on different elements (no shared
+mutable state in the lambdas), and per-chunk views must not depend on
+elements of other chunks (so no views::adjacent, chunk_by... across the cut).
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include "../101_Threads_RAII/thread_pool.hpp"
+#include "../25_Chrono/trace.hpp"
+
+// A random-access, sized range with a pipeline and a pool attached; consumed
+// by par_reduce / par_to
+template<std::ranges::random_access_range Base, typename Pipeline>
+    requires std::ranges::sized_range<Base>
+class ParallelPipeline {
+public:
+    ParallelPipeline(Base base, Pipeline pipeline, ThreadPoolRAII& pool, size_t grain)
+        : base_(std::move(base)), pipeline_(std::move(pipeline)), pool_(pool), grain_(grain) {}
+
+    // Upper bound on chunks, so the merge step stays cheap
+    static constexpr size_t kMaxChunks = 256;
+
+    using Chunk = std::ranges::subrange<std::ranges::iterator_t<const Base>>;
+    using ChunkView = decltype(std::declval<Chunk>() | std::declval<const Pipeline&>());
+    using value_type = std::ranges::range_value_t<ChunkView>;
+
+    // The pipeline applied to elements [b, e) of the underlying range
+    ChunkView chunk_view(size_t b, size_t e) const {
+        auto first = std::ranges::begin(base_);
+        using Diff = std::ranges::range_difference_t<const Base>;
+        return Chunk(first + static_cast<Diff>(b), first + static_cast<Diff>(e)) | pipeline_;
+    }
+
+    // Runs fn(chunk_index, chunk_view) for every chunk on the pool and
+    // returns the number of chunks. Chunks are at least `grain` elements.
+    template<typename Fn>
+    size_t for_each_chunk(Fn&& fn) const {
+        const size_t n = std::ranges::size(base_);
+        const size_t chunks = std::clamp<size_t>(n / std::max<size_t>(grain_, 1), 1, kMaxChunks);
+        pool_.parallel_for(size_t{0}, chunks, size_t{1}, [&](size_t c) {
+            TRACE_SCOPE_CAT("pipeline chunk", "pipeline");
+            fn(c, chunk_view(n * c / chunks, n * (c + 1) / chunks));
+        });
+        return chunks;
+    }
+
+private:
+    Base base_;
+    Pipeline pipeline_;
+    ThreadPoolRAII& pool_;
+    size_t grain_;
+};
+
+// data | par(pool, pipeline [, grain])
+template<typename Pipeline>
+struct ParClosure {
+    ThreadPoolRAII& pool;
+    Pipeline pipeline;
+    size_t grain;
+
+    template<std::ranges::viewable_range R>
+    friend auto operator|(R&& r, ParClosure closure) {
+        using Base = std::views::all_t<R>;
+        return ParallelPipeline<Base, Pipeline>(std::views::all(std::forward<R>(r)),
+                                                std::move(closure.pipeline), closure.pool, closure.grain);
+    }
+};
+
+template<typename Pipeline>
+ParClosure<Pipeline> par(ThreadPoolRAII& pool, Pipeline pipeline, size_t grain = 16 * 1024) {
+    return ParClosure<Pipeline>{pool, std::move(pipeline), grain};
+}
+
+// | par_reduce(init, op): init op x0 op x1 ..., with op associative
+template<typename T, typename Op>
+struct ParReduce {
+    T init;
+    Op op;
+
+    template<typename Base, typename Pipeline>
+    friend T operator|(const ParallelPipeline<Base, Pipeline>& p, ParReduce r) {
+        // One partial per chunk; a chunk the filter emptied has none
+        std::vector<std::optional<T>> partials(ParallelPipeline<Base, Pipeline>::kMaxChunks);
+        const size_t chunks = p.for_each_chunk([&](size_t c, auto&& view) {
+            std::optional<T> acc;
+            for (auto&& x : view) {
+                if (acc) {
+                    acc = r.op(std::move(*acc), std::forward<decltype(x)>(x));
+                } else {
+                    acc.emplace(std::forward<decltype(x)>(x));
+                }
+            }
+            partials[c] = std::move(acc);
+        });
+        T result = std::move(r.init);
+        for (size_t c = 0; c < chunks; ++c) {
+            if (partials[c]) {
+                result = r.op(std::move(result), std::move(*partials[c]));
+            }
+        }
+        return result;
+    }
+};
+
+template<typename T, typename Op>
+ParReduce<T, Op> par_reduce(T init, Op op) {
+    return ParReduce<T, Op>{std::move(init), std::move(op)};
+}
+
+// | par_to<std::vector>(): the elements, in sequential order
+template<template<typename...> class Container>
+struct ParTo {
+    template<typename Base, typename Pipeline>
+    friend auto operator|(const ParallelPipeline<Base, Pipeline>& p, ParTo) {
+        using T = typename ParallelPipeline<Base, Pipeline>::value_type;
+        std::vector<std::vector<T>> parts(ParallelPipeline<Base, Pipeline>::kMaxChunks);
+        const size_t chunks = p.for_each_chunk([&](size_t c, auto&& view) {
+            for (auto&& x : view) {
+                parts[c].push_back(std::forward<decltype(x)>(x));
+            }
+        });
+        size_t total = 0;
+        for (size_t c = 0; c < chunks; ++c) {
+            total += parts[c].size();
+        }
+        Container<T> out;
+        if constexpr (requires { out.reserve(total); }) {
+            out.reserve(total);
+        }
+        for (size_t c = 0; c < chunks; ++c) {
+            out.insert(out.end(), std::make_move_iterator(parts[c].begin()),
+                       std::make_move_iterator(parts[c].end()));
+        }
+        return out;
+    }
+};
+
+template<template<typename...> class Container>
+ParTo<Container> par_to() {
+    return {};
+}
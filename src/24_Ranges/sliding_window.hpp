@@ -0,0 +1,322 @@
+/*
+Incremental sliding-window aggregates (header-only, just #include it).
+Used by sliding_window_demo.cpp and 73_views.cpp.
+
+Summing each window from scratch - views::slide(w) | transform(accumulate),
+or analyzeWindow's subspan loop - costs O(w) per output, O(n*w) in all:
+with w = 5000 samples that is 5000 adds per output instead of 2.
+
+Each aggregator here takes one sample at a time with push() and keeps the
+window's result up to date in amortized O(1), in O(w) memory:
+
+    SlidingSum<T>      running sum; a floating-point sum is recomputed from
+                       the samples once per w pushes, so rounding error does
+                       not pile up over a long stream
+    SlidingMin<T>      monotonic queue: only samples that can still become
+    SlidingMax<T>      the minimum (maximum) are kept, oldest first
+    SlidingFold<T, Op> any associative Op with an identity, commutative or
+                       not (two-stack queue: each sample is folded a bounded
+                       number of times)
+
+Push-based, for samples that arrive one by one:
+
+    SlidingMax<double> peak(1000);
+    for (;;) {
+        peak.push(read_sensor());
+        if (peak.full() && peak.value() > limit) { ... }
+    }
+
+Or as lazy range adaptors yielding one result per full window (n - w + 1
+results, like views::slide(w)):
+
+    for (double avg : samples | sliding_mean(1000)) { ... }
+    auto highs = samples | sliding_max(50) | std::ranges::to<std::vector>();   // C++23
+
+sliding_sum, sliding_mean, sliding_min, sliding_max and sliding_fold(w,
+op, identity) accept any input range; the result is an input view.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sliding_window_detail {
+
+inline size_t checked_window(size_t window) {
+    if (window == 0) {
+        throw std::invalid_argument("sliding window size must be at least 1");
+    }
+    return window;
+}
+
+} // namespace sliding_window_detail
+
+template<typename T>
+class SlidingSum {
+    static_assert(std::is_arithmetic_v<T>, "SlidingSum needs an arithmetic sample type");
+
+public:
+    // Integers sum exactly in 64 bits; floating point sums in at least double
+    using sum_type = std::conditional_t<std::is_floating_point_v<T>, std::common_type_t<T, double>,
+                                        std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+    explicit SlidingSum(size_t window)
+        : m_samples(sliding_window_detail::checked_window(window)) {}
+
+    void push(T x) {
+        if (m_count == m_samples.size()) {
+            m_sum -= static_cast<sum_type>(m_samples[m_next]);
+        } else {
+            ++m_count;
+        }
+        m_samples[m_next] = x;
+        m_sum += static_cast<sum_type>(x);
+        if (++m_next == m_samples.size()) {
+            m_next = 0;
+            if constexpr (std::is_floating_point_v<T>) {
+                rebase();
+            }
+        }
+    }
+
+    bool full() const { return m_count == m_samples.size(); }
+    size_t size() const { return m_count; }
+    size_t window() const { return m_samples.size(); }
+
+    sum_type value() const { return m_sum; }
+    sum_type sum() const { return m_sum; }
+    double mean() const { return m_count == 0 ? 0.0 : static_cast<double>(m_sum) / static_cast<double>(m_count); }
+
+private:
+    // Drop the rounding error accumulated by w adds and w subtracts
+    void rebase() {
+        sum_type exact{};
+        for (size_t i = 0; i < m_count; ++i) {
+            exact += static_cast<sum_type>(m_samples[i]);
+        }
+        m_sum = exact;
+    }
+
+    std::vector<T> m_samples;       // ring; m_next is the oldest once full
+    size_t m_next = 0;
+    size_t m_count = 0;
+    sum_type m_sum{};
+};
+
+// Minimum (Compare = less) or maximum (greater) of the window
+template<typename T, typename Compare>
+class SlidingExtremum {
+    struct Entry {
+        uint64_t seq;
+        T value;
+    };
+
+public:
+    explicit SlidingExtremum(size_t window, Compare comp = Compare{})
+        : m_queue(sliding_window_detail::checked_window(window)), m_comp(std::move(comp)) {}
+
+    void push(T x) {
+        // The oldest candidate leaves the window first, making room for x
+        if (m_size > 0 && m_queue[m_head].seq + m_queue.size() <= m_seq) {
+            m_head = wrap(m_head + 1);
+            --m_size;
+        }
+        // Samples no better than x can never be the answer again
+        while (m_size > 0 && !m_comp(back().value, x)) {
+            --m_size;
+        }
+        m_queue[wrap(m_head + m_size)] = Entry{m_seq, std::move(x)};
+        ++m_size;
+        ++m_seq;
+    }
+
+    bool full() const { return m_seq >= m_queue.size(); }
+    size_t size() const { return m_seq < m_queue.size() ? static_cast<size_t>(m_seq) : m_queue.size(); }
+    size_t window() const { return m_queue.size(); }
+
+    // Precondition: at least one sample pushed
+    const T& value() const { return m_queue[m_head].value; }
+
+private:
+    // i < 2w: a compare instead of a division
+    size_t wrap(size_t i) const { return i >= m_queue.size() ? i - m_queue.size() : i; }
+
+    const Entry& back() const { return m_queue[wrap(m_head + m_size - 1)]; }
+
+    std::vector<Entry> m_queue;     // ring of at most w candidates, oldest at m_head
+    size_t m_head = 0;
+    size_t m_size = 0;
+    uint64_t m_seq = 0;             // samples pushed so far
+    Compare m_comp;
+};
+
+template<typename T>
+using SlidingMin = SlidingExtremum<T, std::less<T>>;
+
+template<typename T>
+using SlidingMax = SlidingExtremum<T, std::greater<T>>;
+
+// op(...op(op(oldest, next), ...), newest) over the window, for an
+// associative op with op(identity, x) == op(x, identity) == x
+template<typename T, typename Op>
+class SlidingFold {
+public:
+    SlidingFold(size_t window, Op op, T identity)
+        : m_window(sliding_window_detail::checked_window(window)), m_op(std::move(op)),
+          m_identity(identity), m_back_fold(std::move(identity)) {
+        m_front.reserve(m_window + 1);
+        m_back.reserve(m_window + 1);
+    }
+
+    void push(T x) {
+        m_back_fold = m_op(std::move(m_back_fold), x);
+        m_back.push_back(std::move(x));
+        if (m_front.size() + m_back.size() > m_window) {
+            if (m_front.empty()) {
+                flip();
+            }
+            m_front.pop_back();     // the oldest sample
+        }
+    }
+
+    bool full() const { return m_front.size() + m_back.size() == m_window; }
+    size_t size() const { return m_front.size() + m_back.size(); }
+    size_t window() const { return m_window; }
+
+    T value() const { return m_front.empty() ? m_back_fold : m_op(m_front.back(), m_back_fold); }
+
+private:
+    // Move the back stack to the front one, where each entry holds the fold
+    // of itself and every newer front entry; the oldest ends on top
+    void flip() {
+        T fold = m_identity;
+        for (size_t i = m_back.size(); i-- > 0;) {
+            fold = m_op(std::move(m_back[i]), std::move(fold));
+            m_front.push_back(fold);
+        }
+        m_back.clear();
+        m_back_fold = m_identity;
+    }
+
+    size_t m_window;
+    Op m_op;
+    T m_identity;
+    std::vector<T> m_front;         // suffix folds, oldest sample's on top
+    std::vector<T> m_back;          // newer samples, in push order
+    T m_back_fold;                  // fold of m_back
+};
+
+// ============================================================================
+// Range adaptors
+// ============================================================================
+
+// An input view over Base yielding read(aggregator) after each full window
+template<std::ranges::input_range Base, typename Agg, typename Read>
+class SlidingAggregateView : public std::ranges::view_interface<SlidingAggregateView<Base, Agg, Read>> {
+public:
+    class iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = std::remove_cvref_t<std::invoke_result_t<Read&, const Agg&>>;
+
+        iterator(SlidingAggregateView& parent)
+            : m_parent(&parent), m_agg(parent.m_proto), m_it(std::ranges::begin(parent.m_base)) {
+            const auto end = std::ranges::end(m_parent->m_base);
+            while (!m_agg.full() && m_it != end) {
+                m_agg.push(*m_it);
+                ++m_it;
+            }
+            m_done = !m_agg.full();
+        }
+
+        value_type operator*() const { return std::invoke(m_parent->m_read, m_agg); }
+
+        iterator& operator++() {
+            if (m_it == std::ranges::end(m_parent->m_base)) {
+                m_done = true;
+            } else {
+                m_agg.push(*m_it);
+                ++m_it;
+            }
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) { return it.m_done; }
+
+    private:
+        SlidingAggregateView* m_parent;
+        Agg m_agg;
+        std::ranges::iterator_t<Base> m_it;
+        bool m_done = false;
+    };
+
+    SlidingAggregateView(Base base, Agg proto, Read read)
+        : m_base(std::move(base)), m_proto(std::move(proto)), m_read(std::move(read)) {}
+
+    iterator begin() { return iterator(*this); }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    Base m_base;
+    Agg m_proto;        // empty aggregator each iteration starts from
+    Read m_read;
+};
+
+// `range | closure`: Make builds the aggregator for the range's value type
+template<typename Make, typename Read>
+struct SlidingClosure {
+    Make make;
+    Read read;
+
+    template<std::ranges::viewable_range R>
+        requires std::ranges::input_range<R>
+    friend auto operator|(R&& r, SlidingClosure closure) {
+        using Base = std::views::all_t<R>;
+        auto proto = closure.make(std::type_identity<std::ranges::range_value_t<R>>{});
+        return SlidingAggregateView<Base, decltype(proto), Read>(std::views::all(std::forward<R>(r)),
+                                                                 std::move(proto), std::move(closure.read));
+    }
+};
+
+template<typename Make, typename Read>
+SlidingClosure<Make, Read> make_sliding_closure(Make make, Read read) {
+    return {std::move(make), std::move(read)};
+}
+
+inline auto sliding_sum(size_t window) {
+    return make_sliding_closure([window]<typename T>(std::type_identity<T>) { return SlidingSum<T>(window); },
+                                [](const auto& agg) { return agg.sum(); });
+}
+
+inline auto sliding_mean(size_t window) {
+    return make_sliding_closure([window]<typename T>(std::type_identity<T>) { return SlidingSum<T>(window); },
+                                [](const auto& agg) { return agg.mean(); });
+}
+
+inline auto sliding_min(size_t window) {
+    return make_sliding_closure([window]<typename T>(std::type_identity<T>) { return SlidingMin<T>(window); },
+                                [](const auto& agg) { return agg.value(); });
+}
+
+inline auto sliding_max(size_t window) {
+    return make_sliding_closure([window]<typename T>(std::type_identity<T>) { return SlidingMax<T>(window); },
+                                [](const auto& agg) { return agg.value(); });
+}
+
+// Folds windows of identity's type; samples are converted to it
+template<typename T, typename Op>
+auto sliding_fold(size_t window, Op op, T identity) {
+    return make_sliding_closure(
+        [window, op, identity](auto) { return SlidingFold<T, Op>(window, op, identity); },
+        [](const auto& agg) { return agg.value(); });
+}
@@ -0,0 +1,189 @@
+// g++ -std=c++20 -O2 sliding_window_demo.cpp -o app
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "sliding_window.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// A sensor stream: a slow random walk with noise
+std::vector<double> make_samples(size_t n) {
+    std::mt19937 rng(3);
+    std::normal_distribution<double> step(0.0, 0.05);
+    std::normal_distribution<double> noise(0.0, 0.5);
+    std::vector<double> samples(n);
+    double level = 20.0;
+    for (auto& s : samples) {
+        level += step(rng);
+        s = level + noise(rng);
+    }
+    return samples;
+}
+
+// The from-scratch version: every window is a separate range
+template<typename PerWindow>
+auto each_window(std::span<const double> data, size_t w, PerWindow per_window) {
+#if defined(__cpp_lib_ranges_slide)
+    return data | std::views::slide(w) | std::views::transform(per_window);
+#else
+    // No views::slide before GCC 13 / C++23: the same windows as subspans
+    return std::views::iota(size_t{0}, data.size() - w + 1)
+        | std::views::transform([data, w, per_window](size_t i) { return per_window(data.subspan(i, w)); });
+#endif
+}
+
+// ============================================================================
+// 1. SUM / MIN / MAX: from scratch vs incremental
+// ============================================================================
+void benchmarkAggregates(const std::vector<double>& samples) {
+    std::cout << "\n=== " << samples.size() << " SAMPLES: FROM SCRATCH vs INCREMENTAL, ms ===\n";
+#if defined(__cpp_lib_ranges_slide)
+    std::cout << "(from scratch: views::slide)\n";
+#else
+    std::cout << "(from scratch: subspan per window; this library has no views::slide)\n";
+#endif
+    const std::span<const double> data(samples);
+    for (size_t w : {10, 100, 1000, 5000}) {
+        double checksum_a = 0;
+        double checksum_b = 0;
+        double worst_sum_error = 0;
+
+        auto start = Clock::now();
+        std::vector<double> scratch_sums;
+        for (double s : each_window(data, w, [](auto win) { return std::accumulate(win.begin(), win.end(), 0.0); })) {
+            scratch_sums.push_back(s);
+        }
+        for (double m : each_window(data, w, [](auto win) { return *std::ranges::min_element(win); })) {
+            checksum_a += m;
+        }
+        for (double m : each_window(data, w, [](auto win) { return *std::ranges::max_element(win); })) {
+            checksum_a += m;
+        }
+        const double scratch_ms = ms_since(start);
+
+        start = Clock::now();
+        size_t i = 0;
+        for (double s : samples | sliding_sum(w)) {
+            worst_sum_error = std::max(worst_sum_error, std::abs(s - scratch_sums[i++]));
+        }
+        for (double m : samples | sliding_min(w)) {
+            checksum_b += m;
+        }
+        for (double m : samples | sliding_max(w)) {
+            checksum_b += m;
+        }
+        const double incremental_ms = ms_since(start);
+
+        std::cout << "w = " << w << ": from scratch " << scratch_ms << ", incremental " << incremental_ms
+                  << "  (min/max " << (checksum_a == checksum_b ? "identical" : "DIFFER")
+                  << ", largest sum difference " << worst_sum_error << ")\n";
+    }
+}
+
+// ============================================================================
+// 2. ROUNDING DRIFT: running sum with and without re-basing
+// ============================================================================
+void demonstrateDrift() {
+    std::cout << "\n=== DRIFT OVER 20M SAMPLES, w = 1000 ===\n";
+    constexpr size_t kWindow = 1000;
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<double> jitter(-1.0, 1.0);
+
+    SlidingSum<double> rebased(kWindow);
+    std::vector<double> ring(kWindow);
+    double naive = 0;
+    for (size_t i = 0; i < 20'000'000; ++i) {
+        // Large offsets then small values: each add/subtract rounds
+        const double x = (i < 10'000'000 ? 1e9 : 0.0) + jitter(rng);
+        naive += x - ring[i % kWindow];
+        ring[i % kWindow] = x;
+        rebased.push(x);
+    }
+    const double exact = std::accumulate(ring.begin(), ring.end(), 0.0);
+    std::cout << "exact " << exact << ", SlidingSum " << rebased.sum() << ", naive running sum " << naive << "\n";
+}
+
+// ============================================================================
+// 3. TWO-STACK FOLD: a windowed exponential moving average
+// ============================================================================
+// x -> a * x + b; composing the per-sample updates of a window gives the
+// EMA of that window alone, started from zero
+struct Affine {
+    double a = 1.0;
+    double b = 0.0;
+};
+
+void demonstrateFold(const std::vector<double>& samples) {
+    std::cout << "\n=== SLIDING FOLD: EMA OVER THE LAST 500 SAMPLES ===\n";
+    constexpr size_t kWindow = 500;
+    constexpr double kAlpha = 0.01;
+    // Apply f, then g: not commutative
+    auto then = [](Affine f, Affine g) { return Affine{g.a * f.a, g.a * f.b + g.b}; };
+    auto updates = samples | std::views::transform([](double s) { return Affine{1 - kAlpha, kAlpha * s}; });
+
+    auto start = Clock::now();
+    std::vector<double> folded;
+    for (Affine f : updates | sliding_fold(kWindow, then, Affine{})) {
+        folded.push_back(f.b);      // f(0)
+    }
+    const double fold_ms = ms_since(start);
+
+    start = Clock::now();
+    double worst = 0;
+    for (size_t i = 0; i + kWindow <= samples.size(); ++i) {
+        double ema = 0;
+        for (size_t k = i; k < i + kWindow; ++k) {
+            ema = (1 - kAlpha) * ema + kAlpha * samples[k];
+        }
+        worst = std::max(worst, std::abs(ema - folded[i]));
+    }
+    const double scratch_ms = ms_since(start);
+    std::cout << "SlidingFold " << fold_ms << " ms, from scratch " << scratch_ms << " ms, largest difference "
+              << worst << "\n";
+}
+
+// ============================================================================
+// 4. PUSH-BASED: an alarm on a live stream
+// ============================================================================
+void demonstrateStreaming(const std::vector<double>& samples) {
+    std::cout << "\n=== STREAMING: 1000-SAMPLE MEAN, PEAK AND TROUGH ===\n";
+    SlidingSum<double> mean(1000);
+    SlidingMax<double> peak(1000);
+    SlidingMin<double> trough(1000);
+    size_t alarms = 0;
+
+    const auto start = Clock::now();
+    for (double s : samples) {
+        mean.push(s);
+        peak.push(s);
+        trough.push(s);
+        if (mean.full() && peak.value() - trough.value() > 4.5) {
+            ++alarms;
+        }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / samples.size();
+    std::cout << ns << " ns per sample for three aggregates; last window mean " << mean.mean() << ", range ["
+              << trough.value() << ", " << peak.value() << "], " << alarms << " samples with a range above 4.5\n";
+}
+
+int main() {
+    const std::vector<double> samples = make_samples(1'000'000);
+    benchmarkAggregates(samples);
+    demonstrateDrift();
+    demonstrateFold(samples);
+    demonstrateStreaming(samples);
+    return 0;
+}
@@ -106,6 +106,8 @@ void measurePerformance() {
 // ============================================================================
 // 4. TIMER CLASS EXAMPLE
 // ============================================================================
+// Fine for a one-off measurement. To see where time goes across threads on a
+// timeline, use TRACE_SCOPE from trace.hpp (demo: trace_demo.cpp).
 class Timer {
 private:
     std::chrono::high_resolution_clock::time_point start_time;
@@ -158,6 +160,8 @@ void demonstrateTimer() {
 // ============================================================================
 // 5. TIMEOUT AND DEADLINE IMPLEMENTATION
 // ============================================================================
+// One deadline, polled with sleeps. Many concurrent timeouts belong on a
+// TimerWheel (101_Threads_RAII/timer_wheel.hpp): O(1) schedule and cancel.
 bool tryOperation(int& attempt) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
     attempt++;
@@ -247,6 +251,8 @@ void demonstrateSleepOperations() {
 // ============================================================================
 // 8. RATE LIMITING / THROTTLING
 // ============================================================================
+// Single-threaded, one call per interval. For many threads, bursts and
+// co_await, see TokenBucket in rate_limiter.hpp (demo: rate_limiter_demo.cpp).
 class RateLimiter {
 private:
     std::chrono::milliseconds min_interval;
@@ -0,0 +1,157 @@
+// g++ -std=c++20 -O2 -pthread rate_limiter_demo.cpp -o app
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rate_limiter.hpp"
+
+// ============================================================================
+// Baseline: the textbook token bucket - token count and refill time under a mutex
+// ============================================================================
+class MutexTokenBucket {
+public:
+    MutexTokenBucket(double permits_per_second, uint32_t burst)
+        : m_rate(permits_per_second), m_burst(burst), m_tokens(burst), m_last(std::chrono::steady_clock::now()) {}
+
+    bool try_acquire(uint32_t n = 1) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto now = std::chrono::steady_clock::now();
+        m_tokens = std::min<double>(m_burst, m_tokens + std::chrono::duration<double>(now - m_last).count() * m_rate);
+        m_last = now;
+        if (m_tokens < n) {
+            return false;
+        }
+        m_tokens -= n;
+        return true;
+    }
+
+private:
+    std::mutex m_mutex;
+    double m_rate;
+    uint32_t m_burst;
+    double m_tokens;
+    std::chrono::steady_clock::time_point m_last;
+};
+
+// ============================================================================
+// 1. BASICS
+// ============================================================================
+void demonstrateBasics() {
+    std::cout << "\n=== BURST, THEN SUSTAINED RATE ===\n";
+    TokenBucket limiter(1000, 10);      // 1000/s, bursts of 10
+    int granted = 0;
+    for (int i = 0; i < 20; ++i) {
+        granted += limiter.try_acquire();
+    }
+    std::cout << "20 back-to-back try_acquire(): " << granted << " granted (burst 10)\n";
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    std::cout << "after 5 ms: " << limiter.available() << " permits available (rate 1/ms)\n";
+    std::cout << "try_acquire(11) with burst 10: " << std::boolalpha << limiter.try_acquire(11) << "\n";
+}
+
+// ============================================================================
+// 2. BLOCKING ACQUIRE FROM MANY THREADS
+// ============================================================================
+void demonstrateBlockingAcquire() {
+    std::cout << "\n=== BLOCKING acquire() FROM 8 THREADS ===\n";
+    constexpr double kRate = 100'000;
+    constexpr int kPerThread = 2'500;
+    TokenBucket limiter(kRate, 16);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < kPerThread; ++i) {
+                limiter.acquire();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << 8 * kPerThread << " permits at " << kRate << "/s: " << seconds * 1000 << " ms (ideal "
+              << (8 * kPerThread - 16) / kRate * 1000 << " ms), achieved " << 8 * kPerThread / seconds << "/s\n";
+}
+
+// ============================================================================
+// 3. CONTENTION: 1..64 THREADS HAMMERING try_acquire()
+// ============================================================================
+template<typename Limiter>
+void hammer(Limiter& limiter, int threads, std::chrono::milliseconds duration, double& callsPerSecond,
+            double& grantedPerSecond) {
+    std::atomic<bool> go{false};
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> totalCalls{0};
+    std::atomic<uint64_t> totalGranted{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            uint64_t c = 0;
+            uint64_t g = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                g += limiter.try_acquire();
+                ++c;
+            }
+            totalCalls += c;
+            totalGranted += g;
+        });
+    }
+    // Timed until the last worker has stopped: with more threads than cores
+    // this thread may wake well after `duration`
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto& w : workers) {
+        w.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    callsPerSecond = totalCalls / seconds;
+    grantedPerSecond = totalGranted / seconds;
+}
+
+void benchmarkContention() {
+    std::cout << "\n=== CONTENTION (" << std::thread::hardware_concurrency() << " hardware threads) ===\n";
+    constexpr auto kDuration = std::chrono::milliseconds(200);
+
+    for (double rate : {500'000.0, 1e9}) {
+        std::cout << (rate < 1e9 ? "limit 500k/s: granted rate should stay at 500k/s"
+                                 : "limit 1e9/s (every call granted): raw acquire throughput")
+                  << "\n";
+        std::cout << std::setw(8) << "threads" << std::setw(22) << "CAS calls/s" << std::setw(14) << "granted/s"
+                  << std::setw(22) << "mutex calls/s" << std::setw(14) << "granted/s" << "\n";
+        for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+            double calls = 0, granted = 0, mutexCalls = 0, mutexGranted = 0;
+            {
+                TokenBucket limiter(rate, 64);
+                hammer(limiter, threads, kDuration, calls, granted);
+            }
+            {
+                MutexTokenBucket limiter(rate, 64);
+                hammer(limiter, threads, kDuration, mutexCalls, mutexGranted);
+            }
+            std::cout << std::fixed << std::setprecision(0) << std::setw(8) << threads << std::setw(22)
+                      << calls << std::setw(14) << granted << std::setw(22) << mutexCalls << std::setw(14)
+                      << mutexGranted << "\n";
+        }
+    }
+    std::cout.unsetf(std::ios::fixed);
+}
+
+int main() {
+    demonstrateBasics();
+    demonstrateBlockingAcquire();
+    benchmarkContention();
+    return 0;
+}
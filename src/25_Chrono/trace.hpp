@@ -0,0 +1,346 @@
+/*
+Scoped tracing with Chrome / Perfetto export (header-only, just #include it).
+Used by trace_demo.cpp, 101_Threads_RAII/thread_pool.hpp (every pool task),
+24_Ranges/parallel_pipeline.hpp (every pipeline chunk) and allocators1.hpp
+(TracingPoolPolicy).
+
+The Timer in 25_Chrono_time utilities.cpp reads the clock by hand and
+prints milliseconds to cout: the print costs more than most of what it
+measures, takes a lock, and says nothing about where on which thread the
+time went. Here an instrumented scope is one line,
+
+    void parse(Batch& b) {
+        TRACE_SCOPE("parse");                 // or TRACE_SCOPE_CAT("parse", "io")
+        ...
+    }
+
+and costs two timestamp reads and a handful of stores into a buffer that
+only the current thread writes:
+
+  - Timestamps are the TSC on x86 (rdtsc, ~7 ns) and steady_clock
+    nanoseconds elsewhere. Ticks become nanoseconds at export time, from
+    the tick rate measured between the first traced event and the export.
+  - Every thread records into its own ring of TRACE_BUFFER_EVENTS events
+    (default 16384, 40 bytes each). No locks and no read-modify-write: each
+    slot is a tiny seqlock, so the exporter can run while threads trace and
+    skips a slot it catches being rewritten. When a ring is full the oldest
+    events are overwritten - a trace shows the most recent window.
+  - Names and categories are stored as pointers: pass string literals (or
+    other strings that outlive the export).
+
+Export writes Chrome trace-event JSON ("X" complete events, "i" instants,
+thread_name metadata), which chrome://tracing and ui.perfetto.dev open
+directly, with timestamps printed to the nanosecond:
+
+    trace::export_chrome_trace("trace.json");
+
+Tracing is compiled in only with -DTRACE_ENABLED=1. Otherwise (the default)
+TRACE_SCOPE / TRACE_SCOPE_CAT / TRACE_INSTANT / TRACE_THREAD_NAME expand to
+nothing and their arguments are not evaluated, so the instrumented headers
+cost nothing; the trace:: functions still compile and export an empty trace.
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TRACE_HAS_TSC 1
+#else
+#define TRACE_HAS_TSC 0
+#endif
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS 16384
+#endif
+
+namespace trace {
+
+inline constexpr bool kEnabled = TRACE_ENABLED != 0;
+
+inline uint64_t now() noexcept {
+#if TRACE_HAS_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Marks an instant event in Slot::end
+inline constexpr uint64_t kInstant = ~uint64_t{0};
+
+// ----------------------------------------------------------------------------
+// Per-thread ring buffer
+// ----------------------------------------------------------------------------
+class ThreadBuffer {
+public:
+    static constexpr size_t kCapacity = TRACE_BUFFER_EVENTS;
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "TRACE_BUFFER_EVENTS must be a power of two");
+
+    struct Event {
+        const char* name;
+        const char* category;
+        uint64_t begin;
+        uint64_t end;                   // kInstant for instant events
+    };
+
+    explicit ThreadBuffer(uint32_t tid) : m_tid(tid), m_slots(new Slot[kCapacity]) {}
+
+    // Owner thread only
+    void record(const char* name, const char* category, uint64_t begin, uint64_t end) noexcept {
+        const uint64_t n = m_written.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[n & (kCapacity - 1)];
+        slot.sequence.store(2 * n + 1, std::memory_order_relaxed);        // odd: being written
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.category.store(category, std::memory_order_relaxed);
+        slot.begin.store(begin, std::memory_order_relaxed);
+        slot.end.store(end, std::memory_order_relaxed);
+        slot.sequence.store(2 * n + 2, std::memory_order_release);
+        m_written.store(n + 1, std::memory_order_release);
+    }
+
+    // Any thread. Calls emit(const Event&) for every event still in the ring
+    // and returns how many were lost (overwritten before or during the read).
+    template<typename Emit>
+    uint64_t snapshot(Emit&& emit) const {
+        const uint64_t written = m_written.load(std::memory_order_acquire);
+        const uint64_t first = written > kCapacity ? written - kCapacity : 0;
+        uint64_t lost = first;
+        for (uint64_t n = first; n < written; ++n) {
+            const Slot& slot = m_slots[n & (kCapacity - 1)];
+            const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            Event event{slot.name.load(std::memory_order_relaxed), slot.category.load(std::memory_order_relaxed),
+                        slot.begin.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed)};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (before != 2 * n + 2 || slot.sequence.load(std::memory_order_relaxed) != before) {
+                ++lost;
+                continue;
+            }
+            emit(event);
+        }
+        return lost;
+    }
+
+    uint32_t tid() const { return m_tid; }
+
+    void set_name(std::string name) {
+        std::lock_guard<std::mutex> lock(m_nameMutex);
+        m_name = std::move(name);
+    }
+
+    std::string name() const {
+        std::lock_guard<std::mutex> lock(m_nameMutex);
+        return m_name;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<const char*> category{nullptr};
+        std::atomic<uint64_t> begin{0};
+        std::atomic<uint64_t> end{0};
+    };
+
+    uint32_t m_tid;
+    std::atomic<uint64_t> m_written{0};
+    std::unique_ptr<Slot[]> m_slots;
+    mutable std::mutex m_nameMutex;
+    std::string m_name;
+};
+
+// ----------------------------------------------------------------------------
+// Registry - every thread's buffer, kept alive past thread exit
+// ----------------------------------------------------------------------------
+class Registry {
+public:
+    static Registry& instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    std::shared_ptr<ThreadBuffer> add() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffers.push_back(std::make_shared<ThreadBuffer>(static_cast<uint32_t>(m_buffers.size() + 1)));
+        return m_buffers.back();
+    }
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_buffers;
+    }
+
+    // Reference point for converting ticks to nanoseconds
+    uint64_t origin_ticks() const { return m_originTicks; }
+    std::chrono::steady_clock::time_point origin_time() const { return m_originTime; }
+
+private:
+    Registry() : m_originTicks(now()), m_originTime(std::chrono::steady_clock::now()) {}
+
+    uint64_t m_originTicks;
+    std::chrono::steady_clock::time_point m_originTime;
+    std::mutex m_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+};
+
+// The first call on a thread allocates its ring and registers it, so it can
+// throw std::bad_alloc; every later call only reads the thread_local
+inline ThreadBuffer& this_thread_buffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = Registry::instance().add();
+    return *buffer;
+}
+
+// ----------------------------------------------------------------------------
+// Recording
+// ----------------------------------------------------------------------------
+
+// RAII span: one complete event from construction to destruction
+class Span {
+public:
+    // Not noexcept: the thread's first span or instant allocates its buffer
+    explicit Span(const char* name, const char* category = "")
+        : m_name(name), m_category(category), m_buffer(this_thread_buffer()), m_begin(now()) {}
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    ~Span() { m_buffer.record(m_name, m_category, m_begin, now()); }
+
+private:
+    const char* m_name;
+    const char* m_category;
+    ThreadBuffer& m_buffer;
+    uint64_t m_begin;
+};
+
+inline void instant(const char* name, const char* category = "") {
+    this_thread_buffer().record(name, category, now(), kInstant);
+}
+
+inline void set_thread_name(std::string name) {
+    this_thread_buffer().set_name(std::move(name));
+}
+
+// ----------------------------------------------------------------------------
+// Chrome trace-event JSON export
+// ----------------------------------------------------------------------------
+struct ExportStats {
+    uint64_t events = 0;
+    uint64_t lost = 0;
+};
+
+namespace detail {
+
+inline void write_json_string(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* p = text ? text : ""; *p; ++p) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            out << '\\' << *p;
+        } else if (c < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                << std::dec << std::setfill(' ');
+        } else {
+            out << *p;
+        }
+    }
+    out << '"';
+}
+
+} // namespace detail
+
+inline ExportStats write_chrome_json(std::ostream& out) {
+    Registry& registry = Registry::instance();
+    const uint64_t origin = registry.origin_ticks();
+#if TRACE_HAS_TSC
+    const uint64_t ticksNow = now();
+    const double elapsedNs = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - registry.origin_time()).count();
+    const double nsPerTick = ticksNow > origin ? elapsedNs / static_cast<double>(ticksNow - origin) : 1.0;
+#else
+    const double nsPerTick = 1.0;
+#endif
+    // Microseconds with three decimals: nanosecond resolution
+    auto micros = [&](uint64_t ticks) {
+        return static_cast<double>(static_cast<int64_t>(ticks - origin)) * nsPerTick / 1000.0;
+    };
+
+    ExportStats stats;
+    const auto flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&] {
+        if (!first) {
+            out << ",\n";
+        }
+        first = false;
+    };
+
+    for (const auto& buffer : registry.buffers()) {
+        const std::string name = buffer->name();
+        if (!name.empty()) {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid()
+                << ",\"args\":{\"name\":";
+            detail::write_json_string(out, name.c_str());
+            out << "}}";
+        }
+        stats.lost += buffer->snapshot([&](const ThreadBuffer::Event& event) {
+            separator();
+            out << "{\"name\":";
+            detail::write_json_string(out, event.name);
+            out << ",\"cat\":";
+            detail::write_json_string(out, event.category);
+            if (event.end == kInstant) {
+                out << ",\"ph\":\"i\",\"s\":\"t\"";
+            } else {
+                out << ",\"ph\":\"X\",\"dur\":" << static_cast<double>(event.end - event.begin) * nsPerTick / 1000.0;
+            }
+            out << ",\"ts\":" << micros(event.begin) << ",\"pid\":1,\"tid\":" << buffer->tid() << "}";
+            ++stats.events;
+        });
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    return stats;
+}
+
+inline ExportStats export_chrome_trace(const std::string& path) {
+    std::ofstream out(path);
+    return write_chrome_json(out);
+}
+
+} // namespace trace
+
+#if TRACE_ENABLED
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ::trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+#define TRACE_SCOPE_CAT(name, category) ::trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name, category)
+#define TRACE_INSTANT(name, category) ::trace::instant(name, category)
+#define TRACE_THREAD_NAME(name) ::trace::set_thread_name(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_CAT(name, category) ((void)0)
+#define TRACE_INSTANT(name, category) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
@@ -0,0 +1,138 @@
+// g++ -std=c++20 -O2 -pthread -DTRACE_ENABLED=1 trace_demo.cpp -o app
+// (without -DTRACE_ENABLED=1 every TRACE_* macro compiles away and trace.json is empty)
+//
+// Open trace.json in ui.perfetto.dev or chrome://tracing.
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <list>
+#include <numeric>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+#include "trace.hpp"
+#include "../24_Ranges/parallel_pipeline.hpp"
+#include "../allocators1.hpp"
+
+// ============================================================================
+// 1. COST OF A SPAN
+// ============================================================================
+void measureSpanOverhead() {
+    std::cout << "\n=== SPAN OVERHEAD ===\n";
+    constexpr int kSpans = 1'000'000;
+    volatile int sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSpans; ++i) {
+        sink = sink + i;
+    }
+    const double empty = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kSpans; ++i) {
+        TRACE_SCOPE("overhead probe");
+        sink = sink + i;
+    }
+    const double traced = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Tracing " << (trace::kEnabled ? "enabled" : "compiled out") << ": "
+              << (traced - empty) / kSpans << " ns per span (" << kSpans << " spans, ring keeps the last "
+              << trace::ThreadBuffer::kCapacity << ")\n";
+}
+
+// ============================================================================
+// 2. THREAD POOL TASKS WITH NESTED STAGES
+// ============================================================================
+double simulateWork(int iterations) {
+    double x = 0;
+    for (int i = 1; i <= iterations; ++i) {
+        x += std::sqrt(static_cast<double>(i));
+    }
+    return x;
+}
+
+void tracePoolTasks(ThreadPoolRAII& pool) {
+    std::cout << "\n=== THREAD POOL TASKS ===\n";
+    std::vector<std::future<double>> results;
+    for (int task = 0; task < 32; ++task) {
+        results.push_back(pool.submit([task] {
+            double total = 0;
+            {
+                TRACE_SCOPE_CAT("decode", "stage");
+                total += simulateWork(20'000 + 5'000 * (task % 4));
+            }
+            {
+                TRACE_SCOPE_CAT("transform", "stage");
+                total += simulateWork(40'000);
+            }
+            {
+                TRACE_SCOPE_CAT("encode", "stage");
+                total += simulateWork(10'000);
+            }
+            return total;
+        }));
+    }
+    double sum = 0;
+    for (auto& result : results) {
+        sum += result.get();
+    }
+    std::cout << "32 tasks, 3 stages each, checksum " << sum << "\n";
+}
+
+// ============================================================================
+// 3. PARALLEL RANGES PIPELINE
+// ============================================================================
+void tracePipeline(ThreadPoolRAII& pool) {
+    std::cout << "\n=== PARALLEL PIPELINE ===\n";
+    std::vector<int> data(2'000'000);
+    std::iota(data.begin(), data.end(), 0);
+    auto evens_squared = std::views::filter([](int x) { return x % 2 == 0; }) |
+                         std::views::transform([](int x) { return static_cast<long long>(x) * x % 1000; });
+
+    TRACE_SCOPE_CAT("par_reduce", "pipeline");
+    const long long sum = data | par(pool, evens_squared) | par_reduce(0LL, std::plus<>{});
+    std::cout << "Sum of even squares mod 1000: " << sum << "\n";
+}
+
+// ============================================================================
+// 4. ALLOCATOR CALLS
+// ============================================================================
+void traceAllocator() {
+    std::cout << "\n=== POOL ALLOCATOR ===\n";
+    TRACE_SCOPE_CAT("list churn", "alloc");
+    std::list<int, PoolAllocator<int, 1024, TracingPoolPolicy>> values;
+    for (int i = 0; i < 3000; ++i) {
+        values.push_back(i);
+    }
+    for (int round = 0; round < 3; ++round) {
+        values.erase(values.begin(), std::next(values.begin(), 1000));
+        for (int i = 0; i < 1000; ++i) {
+            values.push_back(i);
+        }
+    }
+    std::cout << "List of " << values.size() << " nodes, every node allocation is an instant event\n";
+}
+
+int main() {
+    TRACE_THREAD_NAME("main");
+    measureSpanOverhead();
+
+    {
+        ThreadPoolRAII pool(4);
+        tracePoolTasks(pool);
+        tracePipeline(pool);
+    }
+    traceAllocator();
+
+    std::cout << "\n=== EXPORT ===\n";
+    const auto start = std::chrono::steady_clock::now();
+    const trace::ExportStats stats = trace::export_chrome_trace("trace.json");
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "trace.json: " << stats.events << " events, " << stats.lost
+              << " overwritten (ring full), written in " << ms << " ms\n";
+    return 0;
+}
@@ -208,6 +208,8 @@ void containerOwnershipExample() {
 // ============================================================================
 // 7. CIRCULAR REFERENCE PROBLEM AND SOLUTION
 // ============================================================================
+// With many nodes, a refcount per edge adds up: smart_pointers.cpp section 12
+// keeps the same graph in SlotMaps with generational handles instead.
 
 class Parent;
 class Child {
@@ -0,0 +1,409 @@
+/*
+Bounded coroutine channel and a generator that runs on a pool worker
+(header-only, just #include it). Used by executor.cpp.
+
+The generators in coroutines.cpp and ../85_Coroutines/fibonacci.cpp run on
+the consumer's thread: every next() resumes the producer in place, so a
+slow producer stalls the consumer and the two never overlap. Here the
+producer runs on a ThreadPoolRAII worker and co_yields into a bounded
+Channel; the consumer co_awaits items (or whole batches) from it:
+
+    coro::AsyncGenerator<Record> parse(ThreadPoolRAII& pool, std::vector<std::string> lines) {
+        for (auto& line : lines) co_yield parse_line(line);    // runs on a worker
+    }
+
+    coro::AsyncGenerator<Score> score(ThreadPoolRAII& pool, coro::ChannelCapacity,
+                                      coro::AsyncGenerator<Record> in) {
+        for (;;) {
+            std::vector<Record> batch = co_await in.next_batch(64);   // empty: done
+            if (batch.empty()) co_return;
+            for (auto& r : batch) co_yield score_record(r);
+        }
+    }
+
+- Backpressure: co_yield into a full channel (co_await send() too)
+  suspends the producer, and receiving into an empty one suspends the
+  consumer. Neither blocks a thread: the suspended side is resumed on the
+  pool once there is room (or an item).
+- A generator's first parameter is the pool it runs on (the promise takes
+  it, so the body may leave it unnamed); an optional ChannelCapacity second
+  parameter sets its buffer (default 64 items). It starts as soon as it is
+  called.
+- The end: next() returns nullopt and next_batch() an empty vector once the
+  producer has finished and everything it yielded was received. If the
+  producer threw, that exception is rethrown there instead.
+- Dropping an AsyncGenerator early closes its channel; the producer stops at
+  its next co_yield (which throws coro::ChannelClosed through its body, so
+  its destructors run). That may happen after the generator is gone, so a
+  generator should own its arguments (take them by value), like a thread.
+
+Channel<T> on its own is many-producer, many-consumer: send() is false once
+close() was called, receive() ends when it is closed and drained.
+*/
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../101_Threads_RAII/thread_pool.hpp"
+
+namespace coro {
+
+// Thrown out of co_yield once nobody will receive the value
+struct ChannelClosed : std::exception {
+    const char* what() const noexcept override { return "coro::Channel closed"; }
+};
+
+struct ChannelCapacity {
+    size_t items;
+};
+
+template<typename T>
+class Channel {
+    // Intrusive FIFO of suspended awaiters; each awaiter lives in the
+    // suspended coroutine's frame until it is resumed
+    template<typename Op>
+    struct WaitList {
+        Op* head = nullptr;
+        Op* tail = nullptr;
+
+        bool empty() const { return head == nullptr; }
+
+        void push(Op* op) {
+            op->next_ = nullptr;
+            (tail ? tail->next_ : head) = op;
+            tail = op;
+        }
+
+        Op* pop() {
+            Op* op = head;
+            head = op->next_;
+            if (!head) tail = nullptr;
+            return op;
+        }
+    };
+
+    using Wakeups = std::vector<std::coroutine_handle<>>;
+
+public:
+    class SendAwaiter {
+    public:
+        SendAwaiter(Channel& channel, T value) : channel_(channel), value_(std::move(value)) {}
+        SendAwaiter(const SendAwaiter&) = delete;
+        SendAwaiter& operator=(const SendAwaiter&) = delete;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) { return channel_.suspend_send(*this, h); }
+
+        // false: the channel was closed, the value was dropped
+        bool await_resume() const noexcept { return accepted_; }
+
+    protected:
+        friend class Channel;
+
+        Channel& channel_;
+        T value_;
+        bool accepted_ = false;
+        std::coroutine_handle<> handle_;
+        SendAwaiter* next_ = nullptr;
+    };
+
+    class ReceiveOp {
+    public:
+        ReceiveOp(Channel& channel, size_t max) : channel_(channel), max_(max) {}
+        ReceiveOp(const ReceiveOp&) = delete;
+        ReceiveOp& operator=(const ReceiveOp&) = delete;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h) { return channel_.suspend_receive(*this, h); }
+
+    protected:
+        friend class Channel;
+
+        // Empty only at the end of the stream
+        std::vector<T>& finish() {
+            if (batch_.empty() && error_) {
+                std::rethrow_exception(error_);
+            }
+            return batch_;
+        }
+
+        Channel& channel_;
+        size_t max_;
+        std::vector<T> batch_;
+        std::exception_ptr error_;
+        std::coroutine_handle<> handle_;
+        ReceiveOp* next_ = nullptr;
+    };
+
+    struct ReceiveAwaiter : ReceiveOp {
+        using ReceiveOp::ReceiveOp;
+
+        std::optional<T> await_resume() {
+            std::vector<T>& batch = this->finish();
+            if (batch.empty()) {
+                return std::nullopt;
+            }
+            return std::move(batch.front());
+        }
+    };
+
+    struct BatchAwaiter : ReceiveOp {
+        using ReceiveOp::ReceiveOp;
+
+        std::vector<T> await_resume() { return std::move(this->finish()); }
+    };
+
+    // Suspended coroutines are resumed as tasks on pool
+    Channel(ThreadPoolRAII& pool, size_t capacity) : pool_(pool), capacity_(capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("coro::Channel needs room for at least one item");
+        }
+    }
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    // co_await send(v): true once v is in the channel, false if it was closed
+    SendAwaiter send(T value) { return SendAwaiter(*this, std::move(value)); }
+
+    // co_await receive(): the next item, nullopt once closed and drained
+    ReceiveAwaiter receive() { return ReceiveAwaiter(*this, 1); }
+
+    // co_await receive_batch(max): 1..max items, whatever is buffered (after
+    // waiting for the first); empty once closed and drained
+    BatchAwaiter receive_batch(size_t max) { return BatchAwaiter(*this, max == 0 ? 1 : max); }
+
+    // Items already buffered can still be received; then receivers get the
+    // end of the stream, or error rethrown. Later calls do nothing.
+    void close(std::exception_ptr error = nullptr) {
+        Wakeups wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return;
+            }
+            closed_ = true;
+            error_ = error;
+            while (!senders_.empty()) {
+                SendAwaiter* s = senders_.pop();
+                s->accepted_ = false;
+                wake.push_back(s->handle_);
+            }
+            while (!receivers_.empty()) {
+                ReceiveOp* r = receivers_.pop();
+                r->error_ = error_;
+                wake.push_back(r->handle_);
+            }
+        }
+        resume_all(wake);
+    }
+
+    bool closed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    bool suspend_send(SendAwaiter& s, std::coroutine_handle<> h) {
+        Wakeups wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return false;
+            }
+            if (items_.size() == capacity_) {
+                s.handle_ = h;
+                senders_.push(&s);
+                return true;
+            }
+            items_.push_back(std::move(s.value_));
+            s.accepted_ = true;
+            settle(wake);
+        }
+        resume_all(wake);
+        return false;
+    }
+
+    bool suspend_receive(ReceiveOp& r, std::coroutine_handle<> h) {
+        Wakeups wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (items_.empty()) {
+                if (closed_) {
+                    r.error_ = error_;
+                    return false;
+                }
+                r.handle_ = h;
+                receivers_.push(&r);
+                return true;
+            }
+            take(r);
+            settle(wake);
+        }
+        resume_all(wake);
+        return false;
+    }
+
+    // Called with mutex_ held after items_ changed: moves parked senders'
+    // values in while there is room and hands items to parked receivers
+    // while there are any
+    void settle(Wakeups& wake) {
+        for (;;) {
+            while (!senders_.empty() && items_.size() < capacity_) {
+                SendAwaiter* s = senders_.pop();
+                items_.push_back(std::move(s->value_));
+                s->accepted_ = true;
+                wake.push_back(s->handle_);
+            }
+            if (receivers_.empty() || items_.empty()) {
+                return;
+            }
+            ReceiveOp* r = receivers_.pop();
+            take(*r);
+            wake.push_back(r->handle_);
+        }
+    }
+
+    void take(ReceiveOp& r) {
+        const size_t n = std::min(r.max_, items_.size());
+        r.batch_.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            r.batch_.push_back(std::move(items_.front()));
+            items_.pop_front();
+        }
+    }
+
+    // After the unlock, so a resumed coroutine never waits for our mutex
+    void resume_all(const Wakeups& wake) {
+        for (std::coroutine_handle<> h : wake) {
+            pool_.enqueue(::Task([h] { h.resume(); }));
+        }
+    }
+
+    ThreadPoolRAII& pool_;
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::deque<T> items_;               // guarded by mutex_, as is everything below
+    WaitList<SendAwaiter> senders_;     // parked while items_ is full
+    WaitList<ReceiveOp> receivers_;     // parked while items_ is empty
+    bool closed_ = false;
+    std::exception_ptr error_;
+};
+
+// A coroutine that co_yields Ts into its own Channel from a pool worker;
+// the consumer co_awaits next() or next_batch()
+template<typename T>
+class AsyncGenerator {
+public:
+    static constexpr size_t kDefaultCapacity = 64;
+
+    struct promise_type {
+        template<typename... Args>
+        promise_type(ThreadPoolRAII& pool, Args&&...)
+            : pool_(pool), channel_(std::make_shared<Channel<T>>(pool, kDefaultCapacity)) {}
+
+        template<typename... Args>
+        promise_type(ThreadPoolRAII& pool, ChannelCapacity capacity, Args&&...)
+            : pool_(pool), channel_(std::make_shared<Channel<T>>(pool, capacity.items)) {}
+
+        AsyncGenerator get_return_object() { return AsyncGenerator(channel_); }
+
+        // Start right away, on a worker
+        auto initial_suspend() noexcept {
+            struct StartOnPool {
+                ThreadPoolRAII& pool;
+
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> h) { pool.enqueue(::Task([h] { h.resume(); })); }
+                void await_resume() const noexcept {}
+            };
+            return StartOnPool{pool_};
+        }
+
+        // co_yield on a closed channel (the consumer is gone) ends the body
+        struct YieldAwaiter : Channel<T>::SendAwaiter {
+            using Channel<T>::SendAwaiter::SendAwaiter;
+
+            void await_resume() const {
+                if (!this->accepted_) {
+                    throw ChannelClosed{};
+                }
+            }
+        };
+
+        YieldAwaiter yield_value(T value) { return YieldAwaiter(*channel_, std::move(value)); }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+            try {
+                throw;
+            } catch (const ChannelClosed&) {
+                // stopped because nobody is listening: not an error
+            } catch (...) {
+                error_ = std::current_exception();
+            }
+        }
+
+        // The frame destroys itself; the channel lives on in the generator
+        std::suspend_never final_suspend() noexcept {
+            channel_->close(error_);
+            return {};
+        }
+
+        ThreadPoolRAII& pool_;
+        std::shared_ptr<Channel<T>> channel_;
+        std::exception_ptr error_;
+    };
+
+    AsyncGenerator(AsyncGenerator&&) noexcept = default;
+    AsyncGenerator& operator=(AsyncGenerator&& other) noexcept {
+        if (this != &other) {
+            stop();
+            channel_ = std::move(other.channel_);
+        }
+        return *this;
+    }
+    AsyncGenerator(const AsyncGenerator&) = delete;
+    AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+
+    ~AsyncGenerator() { stop(); }
+
+    // co_await next(): the next value, nullopt at the end
+    typename Channel<T>::ReceiveAwaiter next() { return channel_->receive(); }
+
+    // co_await next_batch(max): 1..max values, empty at the end
+    typename Channel<T>::BatchAwaiter next_batch(size_t max) { return channel_->receive_batch(max); }
+
+    // Values yielded but not yet received
+    size_t buffered() const { return channel_->size(); }
+
+private:
+    explicit AsyncGenerator(std::shared_ptr<Channel<T>> channel) : channel_(std::move(channel)) {}
+
+    void stop() {
+        if (channel_) {
+            channel_->close();
+        }
+    }
+
+    std::shared_ptr<Channel<T>> channel_;
+};
+
+}  // namespace coro
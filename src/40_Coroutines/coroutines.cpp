@@ -1,10 +1,16 @@
 /*
-g++ -std=c++20 -o coroutines coroutines.cpp
+g++ -std=c++20 -O2 -o coroutines coroutines.cpp
+(-O2 or higher for the full-size runs of example 3; see coro::Task<T>)
 */
 
 #include <coroutine>
 #include <iostream>
 #include <exception>
+#include <string>
+#include <chrono>
+#include <cstdint>
+
+#include "task.hpp"
 
 // ============================================================================
 // TASK - The return type for our coroutine
@@ -111,6 +117,7 @@ struct SimpleAwaitable {
     void await_suspend(std::coroutine_handle<> h) {
         std::cout << "    [Awaitable] await_suspend - coroutine suspended, could schedule resume\n";
         // In real async code, you'd schedule h.resume() to be called later
+        // (executor.cpp does exactly that, on ThreadPoolRAII workers)
         // For this example, we'll resume immediately in the caller
     }
 
@@ -166,6 +173,36 @@ struct Generator {
     }
 };
 
+// ============================================================================
+// LAZY TASK - coro::Task<T> (task.hpp) with symmetric transfer
+// ============================================================================
+// Task<T> above starts eagerly (suspend_never), copies its result into
+// value_, and nobody can co_await it - main has to resume() it by hand.
+//
+// coro::Task<T>, which executor.cpp also runs on a thread pool, is the
+// composable version:
+//   - Lazy: initial_suspend is suspend_always, so nothing runs until the
+//     task is awaited, and the awaiter is known before the body starts.
+//   - co_await a task stores the awaiting coroutine as its continuation and
+//     *returns* the task's handle from await_suspend.
+//   - final_suspend returns the continuation's handle in the same way.
+//
+// Returning a handle from await_suspend is symmetric transfer: the compiler
+// jumps to that coroutine as a tail call instead of calling resume() from
+// inside the current one. Calling resume() nests one native stack frame per
+// await, so a loop of a million awaits of synchronously-completing tasks
+// would overflow the stack. With symmetric transfer the stack stays flat,
+// and nothing is scheduled anywhere - an await costs the frame allocation
+// plus two indirect jumps.
+//
+// The jump is a real tail call only where the compiler emits one: GCC does
+// from -O2 up (sibling-call optimization), but at -O0/-O1, and with
+// AddressSanitizer at any level, every transfer keeps a native frame - and
+// no macro tells -O1 from -O2. So example 3 first checks whether two awaits
+// in a row run at the same stack depth (transfers_are_tail_calls() below),
+// and shrinks its ten-million-await loop and million-deep chain to a size
+// the default 8 MiB stack holds when they do not.
+
 // ============================================================================
 // COROUTINE FUNCTIONS
 // ============================================================================
@@ -194,6 +231,57 @@ Generator<int> generateNumbers(int count) {
     std::cout << "[Generator] Finished generating\n";
 }
 
+// Lazy tasks: leaf completes synchronously, so every await below transfers
+// straight in and straight back out
+coro::Task<long> leaf(long x) {
+    co_return x + 1;
+}
+
+// Where the native stack is when a coroutine body runs
+[[gnu::noinline]] std::uintptr_t stack_mark() {
+    volatile char here = 0;
+    return reinterpret_cast<std::uintptr_t>(&here);
+}
+
+coro::Task<std::uintptr_t> probe() {
+    co_return stack_mark();
+}
+
+// Without tail calls the second probe() runs nested inside the first one's
+// final transfer, deeper on the stack
+coro::Task<bool> transfers_are_tail_calls() {
+    const std::uintptr_t first = co_await probe();
+    const std::uintptr_t second = co_await probe();
+    co_return first == second;
+}
+
+coro::Task<long> await_in_loop(long count) {
+    long v = 0;
+    for (long i = 0; i < count; ++i) {
+        v = co_await leaf(v);
+    }
+    co_return v;
+}
+
+// A chain `depth` frames deep: each level awaits the next one. The frames
+// live on the heap; the native stack does not grow with depth.
+coro::Task<long> nested(long depth) {
+    if (depth == 0) co_return 0;
+    co_return 1 + co_await nested(depth - 1);
+}
+
+coro::Task<std::string> make_name(int id) {
+    std::string name = "request-" + std::to_string(id);
+    name.append(1000, '.');                          // big enough to notice a copy
+    co_return name;                                  // moved into the promise
+}
+
+coro::Task<> log_name(int id) {
+    std::string name = co_await make_name(id);      // moved out of the promise
+    std::cout << "[Task<void>] got a " << name.size() << "-char name starting \""
+              << name.substr(0, 10) << "\"\n";
+}
+
 // ============================================================================
 // MAIN - Demonstrates coroutine usage
 // ============================================================================
@@ -223,6 +311,32 @@ int main() {
     }
     
     std::cout << "\n[Main] Generator exhausted\n";
+
+    std::cout << "\n\n=== EXAMPLE 3: lazy coro::Task<T> with symmetric transfer ===\n";
+    auto greeting = log_name(42);
+    std::cout << "[Main] log_name created, done? " << (greeting.done() ? "yes" : "no")
+              << " (lazy: nothing has run yet)\n";
+    greeting.start();
+    std::cout << "[Main] after start(), done? " << (greeting.done() ? "yes" : "no") << "\n";
+
+    auto tail_calls = transfers_are_tail_calls();
+    tail_calls.start();
+    const bool flat = tail_calls.take_result();
+    std::cout << "[Main] symmetric transfer is " << (flat ? "" : "NOT ")
+              << "a tail call in this build" << (flat ? "\n" : " - shrinking the runs below\n");
+
+    const long awaits = flat ? 10'000'000 : 10'000;
+    auto start = std::chrono::steady_clock::now();
+    auto loop = await_in_loop(awaits);
+    loop.start();
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[Main] " << awaits << " sequential awaits -> " << loop.take_result() << ", "
+              << ns / awaits << " ns per await\n";
+
+    const long depth = flat ? 1'000'000 : 10'000;
+    auto deep = nested(depth);
+    deep.start();
+    std::cout << "[Main] chain " << depth << " frames deep -> " << deep.take_result() << "\n";
     
     std::cout << "\n=== Program ending (destructors will be called) ===\n";
     return 0;
@@ -252,5 +366,10 @@ Comprehensive example that demonstrates all the key components of C++20 coroutin
    - `co_return` - Returns final value and ends coroutine
    - `co_yield` - Suspends and produces a value (for generators)
 
+4. **Lazy coro::Task<T> and symmetric transfer**:
+   - `initial_suspend()` returning `suspend_always` - the body waits for its awaiter
+   - `await_suspend()` returning a `coroutine_handle` - jump to that coroutine
+     instead of nesting a `resume()` call, so await chains use constant stack
+
 The extensive logging shows you exactly when each method is called and the flow of execution. When you compile and run this, you'll see the coroutine suspend, return control to main, get resumed, and finally complete.
 */
\ No newline at end of file
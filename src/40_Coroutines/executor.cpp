@@ -0,0 +1,615 @@
+/*
+g++ -pthread -std=c++20 -O2 -o executor executor.cpp
+*/
+
+// Running coroutines on ThreadPoolRAII workers.
+//
+// The Task in coroutines.cpp is driven by hand, and SimpleAwaitable's
+// await_suspend only says "you'd schedule h.resume() here". This file is
+// that missing piece:
+//
+//   co_await coro::schedule_on(pool)   suspends and resumes on a pool worker
+//   coro::Task<T>                      lazy task that other tasks co_await
+//                                      (task.hpp)
+//   coro::when_all(pool, tasks)        runs tasks concurrently on the pool,
+//                                      resumes once the last one finishes
+//   coro::sync_wait(task)              blocks the calling (non-pool) thread
+//                                      for a top-level task
+//   co_await coro::sleep_for(wheel, d) suspends for d on a TimerWheel
+//                                      (101_Threads_RAII/timer_wheel.hpp),
+//                                      resumes on the wheel's pool
+//   co_await coro::acquire(pool, bucket, n)
+//                                      takes n permits from a TokenBucket
+//                                      (25_Chrono/rate_limiter.hpp), resuming
+//                                      on a pool worker once they are due
+//   coro::AsyncGenerator<T>            a producer that runs on a worker and
+//                                      co_yields into a bounded coro::Channel
+//                                      (channel.hpp); the consumer co_awaits
+//                                      next() / next_batch()
+//
+// A suspended coroutine holds no thread, so thousands of requests that fan
+// out to sub-requests share a handful of workers instead of one blocked
+// thread each.
+//
+// The types live in namespace coro because thread_pool.hpp already has a
+// (non-coroutine) Task.
+
+#include <coroutine>
+#include <iostream>
+#include <exception>
+#include <optional>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "../101_Threads_RAII/thread_pool.hpp"
+#include "../101_Threads_RAII/timer_wheel.hpp"
+#include "../25_Chrono/rate_limiter.hpp"
+#include "channel.hpp"
+#include "task.hpp"
+
+namespace coro {
+
+// ============================================================================
+// SCHEDULE_ON - resume the awaiting coroutine on a pool worker
+// ============================================================================
+struct ScheduleOnAwaitable {
+    ThreadPoolRAII& pool;
+
+    bool await_ready() const noexcept { return false; }
+
+    // Here we really do schedule h.resume(): as a task on the pool. The
+    // coroutine handle is a single pointer, so the task is stored inline.
+    void await_suspend(std::coroutine_handle<> h) {
+        pool.enqueue(::Task([h] { h.resume(); }));
+    }
+
+    void await_resume() const noexcept {}
+};
+
+inline ScheduleOnAwaitable schedule_on(ThreadPoolRAII& pool) {
+    return ScheduleOnAwaitable{pool};
+}
+
+// ============================================================================
+// SLEEP_FOR - a timeout that holds no thread
+// ============================================================================
+// The expiry callback runs on the wheel's pool, so the coroutine resumes on a
+// worker of that pool, d (rounded up to the wheel's tick) from now
+struct SleepAwaitable {
+    TimerWheel& wheel;
+    std::chrono::steady_clock::duration delay;
+
+    bool await_ready() const noexcept { return delay <= std::chrono::steady_clock::duration::zero(); }
+
+    void await_suspend(std::coroutine_handle<> h) {
+        wheel.schedule_after(delay, ::Task([h] { h.resume(); }));
+    }
+
+    void await_resume() const noexcept {}
+};
+
+inline SleepAwaitable sleep_for(TimerWheel& wheel, std::chrono::steady_clock::duration delay) {
+    return SleepAwaitable{wheel, delay};
+}
+
+// ============================================================================
+// ACQUIRE - rate limiting without holding a worker
+// ============================================================================
+// Carries on at once when the permits are available; otherwise the coroutine
+// is parked on the limiter's timer and rescheduled on the pool when they are due
+inline auto acquire(ThreadPoolRAII& pool, TokenBucket& bucket, uint32_t n = 1) {
+    return bucket.acquire_async(n, [&pool](std::coroutine_handle<> h) {
+        pool.enqueue(::Task([h] { h.resume(); }));
+    });
+}
+
+// ============================================================================
+// WHEN_ALL - fan-out / fan-in
+// ============================================================================
+namespace detail {
+
+struct WhenAllState {
+    std::atomic<size_t> remaining;
+    std::coroutine_handle<> parent;
+};
+
+// Runs one child on a worker, then counts down; the last child to finish
+// resumes the parent
+struct WhenAllChild {
+    struct promise_type {
+        WhenAllState* state = nullptr;
+
+        WhenAllChild get_return_object() {
+            return WhenAllChild{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                WhenAllState* s = h.promise().state;
+                if (s->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    return s->parent;
+                }
+                return std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }   // when_ready() never throws
+    };
+
+    std::coroutine_handle<promise_type> handle;
+
+    WhenAllChild(WhenAllChild&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    ~WhenAllChild() {
+        if (handle) handle.destroy();
+    }
+
+private:
+    explicit WhenAllChild(std::coroutine_handle<promise_type> h) : handle(h) {}
+};
+
+template<typename T>
+WhenAllChild run_child(Task<T>& task) {
+    co_await task.when_ready();
+}
+
+// Starts every child on the pool and suspends the parent until the last
+// one is done. The count starts at n + 1 so that the parent's own
+// decrement, after it has queued everything, decides whether it still
+// needs to suspend at all.
+struct WhenAllAwaiter {
+    ThreadPoolRAII& pool;
+    std::vector<WhenAllChild>& children;
+    WhenAllState& state;
+
+    bool await_ready() const noexcept { return children.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> parent) {
+        state.parent = parent;
+        state.remaining.store(children.size() + 1, std::memory_order_relaxed);
+        for (auto& child : children) {
+            child.handle.promise().state = &state;
+            auto h = child.handle;
+            pool.enqueue(::Task([h] { h.resume(); }));
+        }
+        return state.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+
+    void await_resume() const noexcept {}
+};
+
+}  // namespace detail
+
+// Results in input order. If any task threw, the first such exception (in
+// input order) is rethrown, after every task has finished.
+template<typename T>
+Task<std::vector<T>> when_all(ThreadPoolRAII& pool, std::vector<Task<T>> tasks) {
+    std::vector<detail::WhenAllChild> children;
+    children.reserve(tasks.size());
+    for (auto& task : tasks) {
+        children.push_back(detail::run_child(task));
+    }
+    detail::WhenAllState state{};
+    co_await detail::WhenAllAwaiter{pool, children, state};
+
+    std::vector<T> results;
+    results.reserve(tasks.size());
+    for (auto& task : tasks) {
+        results.push_back(task.take_result());
+    }
+    co_return results;
+}
+
+// ============================================================================
+// SYNC_WAIT - bridge from ordinary code to the top-level task
+// ============================================================================
+namespace detail {
+
+struct SyncWaitSignal {
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool done = false;
+
+    void set() {
+        std::lock_guard<std::mutex> lock(mtx);
+        done = true;
+        cv.notify_one();   // under the lock: the waiter cannot return (and
+                           // destroy us) before we are finished here
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&] { return done; });
+    }
+};
+
+// Awaits the task and then signals; its frame is destroyed by sync_wait
+struct SyncWaitDriver {
+    struct promise_type {
+        SyncWaitSignal* signal = nullptr;
+
+        SyncWaitDriver get_return_object() {
+            return SyncWaitDriver{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> h) noexcept { h.promise().signal->set(); }
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+
+    ~SyncWaitDriver() {
+        if (handle) handle.destroy();
+    }
+};
+
+template<typename T>
+SyncWaitDriver drive(Task<T>& task) {
+    co_await task.when_ready();
+}
+
+}  // namespace detail
+
+// Must not be called from a pool worker of a pool the task needs: that
+// worker would block instead of running the task
+template<typename T>
+T sync_wait(Task<T> task) {
+    detail::SyncWaitSignal signal;
+    detail::SyncWaitDriver driver = detail::drive(task);
+    driver.handle.promise().signal = &signal;
+    driver.handle.resume();
+    signal.wait();
+    return task.take_result();
+}
+
+}  // namespace coro
+
+// ============================================================================
+// EXAMPLE - fan-out / fan-in request handling
+// ============================================================================
+
+// Records which threads ran request code
+std::mutex threads_mutex;
+std::set<std::thread::id> threads_seen;
+
+void note_thread() {
+    std::lock_guard<std::mutex> lock(threads_mutex);
+    threads_seen.insert(std::this_thread::get_id());
+}
+
+// One "backend" call: some CPU work on a worker
+coro::Task<long> fetch_shard(ThreadPoolRAII& pool, int request, int shard) {
+    co_await coro::schedule_on(pool);
+    note_thread();
+    long sum = 0;
+    for (int i = 0; i < 20000; ++i) {
+        sum += (request * 31 + shard * 7 + i) % 97;
+    }
+    co_return sum;
+}
+
+coro::Task<long> handle_request(ThreadPoolRAII& pool, int request, int fan_out) {
+    co_await coro::schedule_on(pool);
+    note_thread();
+
+    std::vector<coro::Task<long>> shards;
+    for (int shard = 0; shard < fan_out; ++shard) {
+        shards.push_back(fetch_shard(pool, request, shard));
+    }
+    // The handler holds no thread while its shards run
+    std::vector<long> parts = co_await coro::when_all(pool, std::move(shards));
+
+    long total = 0;
+    for (long p : parts) {
+        total += p;
+    }
+    co_return total;
+}
+
+coro::Task<long> serve(ThreadPoolRAII& pool, int requests, int fan_out) {
+    std::vector<coro::Task<long>> handlers;
+    for (int r = 0; r < requests; ++r) {
+        handlers.push_back(handle_request(pool, r, fan_out));
+    }
+    std::vector<long> results = co_await coro::when_all(pool, std::move(handlers));
+    long checksum = 0;
+    for (long v : results) {
+        checksum += v;
+    }
+    co_return checksum;
+}
+
+// Waits for a (simulated) reply that takes `latency` without holding a worker
+coro::Task<int> slow_backend(TimerWheel& wheel, std::chrono::milliseconds latency) {
+    co_await coro::sleep_for(wheel, latency);
+    note_thread();
+    co_return 1;
+}
+
+coro::Task<int> many_sleepers(ThreadPoolRAII& pool, TimerWheel& wheel, int count) {
+    std::vector<coro::Task<int>> tasks;
+    for (int i = 0; i < count; ++i) {
+        tasks.push_back(slow_backend(wheel, std::chrono::milliseconds(50 + i % 50)));
+    }
+    std::vector<int> done = co_await coro::when_all(pool, std::move(tasks));
+    co_return static_cast<int>(done.size());
+}
+
+// One outbound call, at most `bucket.rate()` per second across all handlers
+coro::Task<int> rate_limited_call(ThreadPoolRAII& pool, TokenBucket& bucket) {
+    co_await coro::acquire(pool, bucket);
+    note_thread();
+    co_return 1;
+}
+
+coro::Task<int> rate_limited_calls(ThreadPoolRAII& pool, TokenBucket& bucket, int calls) {
+    std::vector<coro::Task<int>> tasks;
+    for (int i = 0; i < calls; ++i) {
+        tasks.push_back(rate_limited_call(pool, bucket));
+    }
+    std::vector<int> done = co_await coro::when_all(pool, std::move(tasks));
+    co_return static_cast<int>(done.size());
+}
+
+coro::Task<void> may_fail(ThreadPoolRAII& pool, bool fail) {
+    co_await coro::schedule_on(pool);
+    if (fail) {
+        throw std::runtime_error("shard unavailable");
+    }
+}
+
+// ============================================================================
+// EXAMPLE - parse -> score stages that overlap
+// ============================================================================
+
+struct Record {
+    int id;
+    long weight;
+};
+
+// Stands in for real parsing: a few microseconds of CPU per line
+Record parse_line(const std::string& line) {
+    long weight = 0;
+    for (int round = 0; round < 40; ++round) {
+        for (char c : line) {
+            weight = (weight * 31 + c + round) % 1000003;
+        }
+    }
+    return Record{static_cast<int>(line.size()), weight};
+}
+
+long score_record(const Record& r) {
+    long score = r.weight;
+    for (int i = 0; i < 2000; ++i) {
+        score = (score * 17 + r.id + i) % 1000003;
+    }
+    return score;
+}
+
+std::vector<std::string> make_lines(int count) {
+    std::vector<std::string> lines;
+    for (int i = 0; i < count; ++i) {
+        lines.push_back("record-" + std::to_string(i) + std::string(static_cast<size_t>(i % 64), 'x'));
+    }
+    return lines;
+}
+
+// Stage 1 on a worker; the lines are taken by value, the generator owns them
+coro::AsyncGenerator<Record> parse_stage(ThreadPoolRAII&, coro::ChannelCapacity,
+                                         std::vector<std::string> lines, std::atomic<int>& parsed) {
+    for (const std::string& line : lines) {
+        co_yield parse_line(line);
+        parsed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Stage 2 on a worker, consuming stage 1 in batches while it is still parsing
+coro::AsyncGenerator<long> score_stage(ThreadPoolRAII&, coro::AsyncGenerator<Record> records) {
+    for (;;) {
+        std::vector<Record> batch = co_await records.next_batch(32);
+        if (batch.empty()) {
+            co_return;
+        }
+        for (const Record& r : batch) {
+            co_yield score_record(r);
+        }
+    }
+}
+
+struct PipelineResult {
+    long checksum = 0;
+    int max_lead = 0;     // most lines parsed ahead of the consumer
+};
+
+// Straight-line consumer; the producer can run at most `capacity` records
+// ahead of stage 2 before co_yield suspends it
+coro::Task<PipelineResult> run_pipeline(ThreadPoolRAII& pool, std::vector<std::string> lines, size_t capacity) {
+    std::atomic<int> parsed{0};
+    int consumed = 0;
+    PipelineResult result;
+    coro::AsyncGenerator<long> scores =
+        score_stage(pool, parse_stage(pool, coro::ChannelCapacity{capacity}, std::move(lines), parsed));
+    while (std::optional<long> score = co_await scores.next()) {
+        result.checksum += *score;
+        ++consumed;
+        result.max_lead = std::max(result.max_lead, parsed.load(std::memory_order_relaxed) - consumed);
+    }
+    co_return result;
+}
+
+coro::AsyncGenerator<int> failing_stage(ThreadPoolRAII&) {
+    co_yield 1;
+    co_yield 2;
+    throw std::runtime_error("parse error on line 3");
+}
+
+coro::Task<int> drain_failing(ThreadPoolRAII& pool) {
+    coro::AsyncGenerator<int> gen = failing_stage(pool);
+    int received = 0;
+    try {
+        while (co_await gen.next()) {
+            ++received;
+        }
+    } catch (const std::exception& e) {
+        std::cout << "after " << received << " values next() rethrew: " << e.what() << "\n";
+    }
+    co_return received;
+}
+
+// Takes 3 values from an endless generator and drops it: the producer is
+// resumed, co_yield throws ChannelClosed and its frame unwinds
+coro::AsyncGenerator<int> endless(ThreadPoolRAII&, std::shared_ptr<std::atomic<bool>> unwound) {
+    struct OnExit {
+        std::shared_ptr<std::atomic<bool>> flag;
+        ~OnExit() { flag->store(true); }
+    } on_exit{unwound};
+    for (int i = 0;; ++i) {
+        co_yield i;
+    }
+}
+
+coro::Task<int> take_three(ThreadPoolRAII& pool, std::shared_ptr<std::atomic<bool>> unwound) {
+    coro::AsyncGenerator<int> gen = endless(pool, unwound);
+    int sum = 0;
+    for (int i = 0; i < 3; ++i) {
+        sum += *co_await gen.next();
+    }
+    co_return sum;
+}
+
+coro::Task<int> add_one(int x) {
+    co_return x + 1;
+}
+
+coro::Task<int> chain(int depth) {
+    int v = 0;
+    for (int i = 0; i < depth; ++i) {
+        v = co_await add_one(v);   // awaited inline, no scheduling
+    }
+    co_return v;
+}
+
+int main() {
+    const size_t workers = 4;
+    ThreadPoolRAII pool(workers);
+
+    std::cout << "=== Task awaiting Task (inline, no pool) ===\n";
+    std::cout << "chain(1000) = " << coro::sync_wait(chain(1000)) << "\n";
+
+    std::cout << "\n=== Fan-out / fan-in on " << workers << " workers ===\n";
+    const int requests = 2000;
+    const int fan_out = 8;
+    auto start = std::chrono::steady_clock::now();
+    const long checksum = coro::sync_wait(serve(pool, requests, fan_out));
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << requests << " requests x " << fan_out << " shards in " << ms << " ms, checksum "
+              << checksum << "\n";
+    std::cout << "distinct threads that ran request code: " << threads_seen.size()
+              << " (a thread per request would have needed " << requests << ")\n";
+
+    std::cout << "\n=== Sleeping coroutines (co_await coro::sleep_for) ===\n";
+    {
+        // 20000 coroutines each wait 50..99 ms: all in flight at once on 4 workers
+        TimerWheel wheel(pool);
+        start = std::chrono::steady_clock::now();
+        const int slept = coro::sync_wait(many_sleepers(pool, wheel, 20000));
+        const double sleep_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << slept << " coroutines slept 50..99 ms each, all done in " << sleep_ms << " ms\n";
+    }
+
+    std::cout << "\n=== Rate-limited calls (co_await coro::acquire) ===\n";
+    {
+        // 2000 calls/s with bursts of 50: 500 calls take ~225 ms, and the
+        // waiting calls are parked on a timer, not on the 4 workers
+        TokenBucket bucket(2000, 50);
+        start = std::chrono::steady_clock::now();
+        const int calls = coro::sync_wait(rate_limited_calls(pool, bucket, 500));
+        const double limited_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << calls << " calls in " << limited_ms << " ms (" << calls / limited_ms * 1000
+                  << "/s, limit 2000/s after a burst of 50)\n";
+    }
+
+    std::cout << "\n=== parse -> score stages (coro::AsyncGenerator) ===\n";
+    {
+        const int count = 20000;
+        const std::vector<std::string> lines = make_lines(count);
+
+        start = std::chrono::steady_clock::now();
+        long sequential = 0;
+        std::vector<Record> records;
+        for (const std::string& line : lines) {
+            records.push_back(parse_line(line));
+        }
+        for (const Record& r : records) {
+            sequential += score_record(r);
+        }
+        const double sequential_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        const PipelineResult piped = coro::sync_wait(run_pipeline(pool, lines, 256));
+        const double piped_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << count << " lines: parse all then score all " << sequential_ms << " ms, overlapped stages "
+                  << piped_ms << " ms (" << std::thread::hardware_concurrency() << " hardware threads); checksums "
+                  << (sequential == piped.checksum ? "match" : "DIFFER") << "\n";
+        std::cout << "parse ran at most " << piped.max_lead
+                  << " lines ahead of the consumer (channels of 256 + 64 records, plus in-flight batches)\n";
+
+        coro::sync_wait(drain_failing(pool));
+
+        auto unwound = std::make_shared<std::atomic<bool>>(false);
+        const int first_three = coro::sync_wait(take_three(pool, unwound));
+        for (int spin = 0; spin < 1000 && !unwound->load(); ++spin) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::cout << "took " << first_three << " from an endless generator and dropped it; producer unwound: "
+                  << (unwound->load() ? "yes" : "no") << "\n";
+    }
+
+    std::cout << "\n=== Exceptions cross when_all ===\n";
+    std::vector<coro::Task<void>> flaky;
+    for (int i = 0; i < 3; ++i) {
+        flaky.push_back(may_fail(pool, i == 1));
+    }
+    try {
+        auto wrapper = [](ThreadPoolRAII& p, std::vector<coro::Task<void>> tasks) -> coro::Task<int> {
+            std::vector<coro::Task<int>> counted;
+            for (auto& t : tasks) {
+                counted.push_back([](coro::Task<void> t) -> coro::Task<int> {
+                    co_await std::move(t);
+                    co_return 1;
+                }(std::move(t)));
+            }
+            auto done = co_await coro::when_all(p, std::move(counted));
+            co_return static_cast<int>(done.size());
+        };
+        coro::sync_wait(wrapper(pool, std::move(flaky)));
+        std::cout << "no exception?!\n";
+    } catch (const std::exception& e) {
+        std::cout << "caught: " << e.what() << "\n";
+    }
+    return 0;
+}
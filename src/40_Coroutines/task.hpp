@@ -0,0 +1,156 @@
+/*
+Lazy, awaitable coroutine result (header-only, just #include it). Used by
+executor.cpp and coroutines.cpp.
+
+    coro::Task<long> leaf(long x) { co_return x + 1; }
+
+    coro::Task<long> sum(long n) {
+        long v = 0;
+        for (long i = 0; i < n; ++i) v = co_await leaf(v);
+        co_return v;
+    }
+
+- Lazy: nothing runs until the task is awaited (or started), so the
+  awaiter is known before the body begins.
+- co_await records the awaiting coroutine as the continuation and returns
+  the task's handle from await_suspend; final_suspend returns the
+  continuation the same way. That is symmetric transfer: the compiler jumps
+  to the other coroutine instead of nesting a resume() call, so a long
+  chain of awaits that complete synchronously does not grow the stack
+  (where the compiler emits the jump as a tail call, see coroutines.cpp).
+- co_return moves the value into the promise and co_await moves it back
+  out; an exception from the body is rethrown to the awaiter.
+
+The type lives in namespace coro because ../101_Threads_RAII/thread_pool.hpp
+already has a (non-coroutine) Task.
+*/
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace coro {
+
+// The co_return half of the promise: a value, or nothing for Task<void>
+template<typename T>
+struct TaskResult {
+    std::optional<T> value_;
+    std::exception_ptr exception_;
+
+    void return_value(T value) { value_.emplace(std::move(value)); }
+
+    T take() {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+        return std::move(*value_);
+    }
+};
+
+template<>
+struct TaskResult<void> {
+    std::exception_ptr exception_;
+
+    void return_void() {}
+
+    void take() {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+};
+
+// Nothing runs until the task is awaited (or handed to when_all/sync_wait).
+// Awaiting it starts the body right away on the awaiting thread; when the
+// body finishes, final_suspend transfers straight back to the awaiter.
+template<typename T = void>
+class Task {
+public:
+    struct promise_type : TaskResult<T> {
+        std::coroutine_handle<> continuation_ = std::noop_coroutine();
+
+        Task get_return_object() {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        // Resume whoever awaited us, by returning its handle (symmetric
+        // transfer) rather than calling resume() from in here
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                return h.promise().continuation_;
+            }
+            void await_resume() const noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { this->exception_ = std::current_exception(); }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    // co_await task: start it, suspend until it is done, get its result
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation_ = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().take(); }
+        };
+        return Awaiter{handle_};
+    }
+
+    // Like co_await, but leaves the result (or exception) in the task
+    auto when_ready() noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation_ = awaiting;
+                return handle;
+            }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{handle_};
+    }
+
+    // For non-coroutine code at the top: run until the first real
+    // suspension (with only Task awaits inside, that is completion). A task
+    // that hops to a pool needs sync_wait() from executor.cpp instead
+    void start() { handle_.resume(); }
+
+    // Result of a finished task; rethrows its exception
+    T take_result() { return handle_.promise().take(); }
+
+    bool done() const { return handle_.done(); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle_(h) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+}  // namespace coro
@@ -4,6 +4,12 @@
 #include <iostream>
 #include <algorithm>
 #include <numeric>
+#include <cstdint>
+#include <fstream>
+#include <filesystem>
+
+#include "mapped_file.hpp"
+#include "span_expr.hpp"
 
 // ============================================================================
 // USE CASE 1: Replacing pointer + size pairs
@@ -29,8 +35,7 @@ void processArrayWithSpan(std::span<const int> data) {
 
 // Single function works with vector, array, C-array, etc.
 double calculateAverage(std::span<const double> values) {
-    if (values.empty()) return 0.0;
-    return std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    return span_expr::mean(span_expr::lazy(values));
 }
 
 // ============================================================================
@@ -44,7 +49,7 @@ void fillWithValue(std::span<int> data, int value) {
 
 // Read-only span - cannot modify elements
 int sumValues(std::span<const int> data) {
-    return std::accumulate(data.begin(), data.end(), 0);
+    return span_expr::sum(span_expr::lazy(data));
 }
 
 // ============================================================================
@@ -101,6 +106,17 @@ void processMatrix(std::span<const double> matrix, size_t rows, size_t cols) {
     }
 }
 
+// Whole-matrix arithmetic in one pass: the expression is evaluated element
+// by element, with no temporary matrix for (m * scale - offset)
+void scaledRowSums(std::span<const double> matrix, size_t rows, size_t cols, double scale, double offset) {
+    using span_expr::lazy;
+    std::vector<double> sums(rows);
+    row_sums(std::span<double>(sums), lazy(matrix) * scale - offset, cols);
+    std::cout << "Row sums of m * " << scale << " - " << offset << ": ";
+    for (double s : sums) std::cout << s << " ";
+    std::cout << "\n";
+}
+
 // ============================================================================
 // USE CASE 7: Interfacing with C APIs
 // ============================================================================
@@ -205,6 +221,42 @@ DataPartition splitData(std::span<const int> data) {
     };
 }
 
+// ============================================================================
+// USE CASE 14: Spans over a memory-mapped file
+// ============================================================================
+// A MappedFile (mapped_file.hpp) is just another contiguous byte range, so
+// every span function above works on a file of any size without reading it
+// into a buffer first. Here: FNV-1a over the bytes, and the same subspan
+// partitioning as splitData() to look at the header and the tail.
+
+uint64_t fnv1a(std::span<const std::byte> bytes) {
+    uint64_t hash = 14695981039346656037ull;
+    for (std::byte b : bytes) {
+        hash = (hash ^ std::to_integer<uint64_t>(b)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+void demonstrateMappedFile() {
+    const auto path = std::filesystem::temp_directory_path() / "50_std_span_data.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        for (int i = 0; i < 1 << 20; ++i) {
+            out.put(static_cast<char>(i * 7));
+        }
+    }
+
+    MappedFile file(path.string());
+    std::span<const std::byte> bytes = file.bytes();
+    std::cout << "Mapped " << bytes.size() << " bytes, FNV-1a " << std::hex << fnv1a(bytes)
+              << std::dec << "\n";
+    std::cout << "Header: ";
+    inspectBytes(bytes.first(4));
+    std::cout << "Tail:   ";
+    inspectBytes(bytes.last(4));
+    std::filesystem::remove(path);
+}
+
 // ============================================================================
 // MAIN: Demonstrating all use cases
 // ============================================================================
@@ -247,6 +299,7 @@ int main() {
         7.0, 8.0, 9.0
     };
     processMatrix(matrix, 3, 3);
+    scaledRowSums(matrix, 3, 3, 2.0, 1.0);
     std::cout << "\n";
     
     std::cout << "=== USE CASE 8: Byte-level access ===\n";
@@ -270,7 +323,10 @@ int main() {
     auto partitions = splitData(dataset);
     std::cout << "Training size: " << partitions.training.size() << "\n";
     std::cout << "Validation size: " << partitions.validation.size() << "\n";
-    std::cout << "Test size: " << partitions.test.size() << "\n";
+    std::cout << "Test size: " << partitions.test.size() << "\n\n";
+    
+    std::cout << "=== USE CASE 14: Memory-mapped file ===\n";
+    demonstrateMappedFile();
     
     return 0;
 }
@@ -13,6 +13,13 @@
 #include <span>
 #include <mdspan>
 #include <generator>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "101_Threads_RAII/thread_pool.hpp"
 
 // ============================================================================
 // 1. std::print and std::println - Modern Formatted Output
@@ -92,6 +99,185 @@ public:
     }
 };
 
+// Matrix above is fine for showing the syntax, but every row is its own
+// heap block and m[i, j] loads the row pointer before the element. A dense
+// matrix keeps one buffer and computes the offset: DenseMatrix stores
+// rows * cols elements row-major in a single 64-byte aligned allocation and
+// hands out std::mdspan views of it, so the same storage can be passed to
+// any code that takes an mdspan (no copies, no ownership).
+template<typename T>
+class DenseMatrix {
+    static_assert(std::is_arithmetic_v<T>, "DenseMatrix holds numbers");
+
+public:
+    using extents_type = std::dextents<size_t, 2>;
+    using view_type = std::mdspan<T, extents_type>;                // layout_right: row-major
+    using const_view_type = std::mdspan<const T, extents_type>;
+
+    static constexpr size_t kAlignment = 64;                     // one cache line, a full AVX-512 load
+
+    DenseMatrix(size_t rows, size_t cols)
+        : rows_(rows), cols_(cols), data_(allocate(rows * cols)) {
+        std::fill_n(data_.get(), rows * cols, T{});
+    }
+
+    DenseMatrix(const DenseMatrix& other)
+        : rows_(other.rows_), cols_(other.cols_), data_(allocate(other.size())) {
+        std::copy_n(other.data(), other.size(), data_.get());
+    }
+
+    DenseMatrix& operator=(const DenseMatrix& other) {
+        if (this != &other) {
+            DenseMatrix copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    DenseMatrix(DenseMatrix&&) noexcept = default;
+    DenseMatrix& operator=(DenseMatrix&&) noexcept = default;
+
+    // Same C++23 subscript as Matrix, one multiply-add instead of two loads
+    T& operator[](size_t row, size_t col) { return data_[row * cols_ + col]; }
+    const T& operator[](size_t row, size_t col) const { return data_[row * cols_ + col]; }
+
+    view_type view() { return view_type(data_.get(), rows_, cols_); }
+    const_view_type view() const { return const_view_type(data_.get(), rows_, cols_); }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t size() const { return rows_ * cols_; }
+    T* data() { return data_.get(); }
+    const T* data() const { return data_.get(); }
+
+private:
+    struct AlignedDelete {
+        void operator()(T* p) const { ::operator delete(p, std::align_val_t(kAlignment)); }
+    };
+
+    static std::unique_ptr<T[], AlignedDelete> allocate(size_t n) {
+        return std::unique_ptr<T[], AlignedDelete>(
+            static_cast<T*>(::operator new(std::max<size_t>(n, 1) * sizeof(T), std::align_val_t(kAlignment))));
+    }
+
+    size_t rows_;
+    size_t cols_;
+    std::unique_ptr<T[], AlignedDelete> data_;
+};
+
+// Tile sizes for the blocked kernels. A multiply tile keeps a
+// kBlockK x kBlockJ panel of b (64 KiB of ints) in L2 while kBlockI rows of
+// c are updated from it; inside, the j loop runs over contiguous elements
+// of b and c and is vectorized by the compiler.
+constexpr size_t kBlockI = 32;
+constexpr size_t kBlockK = 64;
+constexpr size_t kBlockJ = 256;
+constexpr size_t kTransposeTile = 32;
+
+// c = a * b on mdspan views. Row blocks of c are independent, so with a
+// pool they are spread over its workers (pool == nullptr: calling thread).
+template<typename T>
+void multiply_blocked(std::mdspan<const T, std::dextents<size_t, 2>> a,
+                      std::mdspan<const T, std::dextents<size_t, 2>> b,
+                      std::mdspan<T, std::dextents<size_t, 2>> c,
+                      ThreadPoolRAII* pool = nullptr) {
+    const size_t n = a.extent(0), inner = a.extent(1), m = b.extent(1);
+    if (n == 0 || m == 0) {
+        return;
+    }
+
+    auto row_block = [&](size_t i0) {
+        const size_t i1 = std::min(i0 + kBlockI, n);
+        for (size_t i = i0; i < i1; ++i) {
+            std::fill_n(&c[i, 0], m, T{});
+        }
+        for (size_t k0 = 0; k0 < inner; k0 += kBlockK) {
+            const size_t k1 = std::min(k0 + kBlockK, inner);
+            for (size_t j0 = 0; j0 < m; j0 += kBlockJ) {
+                const size_t j1 = std::min(j0 + kBlockJ, m);
+                for (size_t i = i0; i < i1; ++i) {
+                    T* __restrict c_row = &c[i, 0];
+                    for (size_t k = k0; k < k1; ++k) {
+                        const T a_ik = a[i, k];
+                        const T* __restrict b_row = &b[k, 0];
+                        for (size_t j = j0; j < j1; ++j) {
+                            c_row[j] += a_ik * b_row[j];
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    const size_t blocks = (n + kBlockI - 1) / kBlockI;
+    if (pool) {
+        pool->parallel_for(size_t{0}, blocks, size_t{1}, [&](size_t blk) { row_block(blk * kBlockI); });
+    } else {
+        for (size_t blk = 0; blk < blocks; ++blk) {
+            row_block(blk * kBlockI);
+        }
+    }
+}
+
+// out = transpose(in), tile by tile: every tile reads 32 rows and writes 32
+// rows, instead of one write per cache line when walking a whole column
+template<typename T>
+void transpose_blocked(std::mdspan<const T, std::dextents<size_t, 2>> in,
+                       std::mdspan<T, std::dextents<size_t, 2>> out,
+                       ThreadPoolRAII* pool = nullptr) {
+    const size_t rows = in.extent(0), cols = in.extent(1);
+
+    auto tile_row = [&](size_t i0) {
+        const size_t i1 = std::min(i0 + kTransposeTile, rows);
+        for (size_t j0 = 0; j0 < cols; j0 += kTransposeTile) {
+            const size_t j1 = std::min(j0 + kTransposeTile, cols);
+            for (size_t i = i0; i < i1; ++i) {
+                for (size_t j = j0; j < j1; ++j) {
+                    out[j, i] = in[i, j];
+                }
+            }
+        }
+    };
+
+    const size_t tiles = (rows + kTransposeTile - 1) / kTransposeTile;
+    if (pool) {
+        pool->parallel_for(size_t{0}, tiles, size_t{1}, [&](size_t t) { tile_row(t * kTransposeTile); });
+    } else {
+        for (size_t t = 0; t < tiles; ++t) {
+            tile_row(t * kTransposeTile);
+        }
+    }
+}
+
+template<typename T>
+DenseMatrix<T> operator*(const DenseMatrix<T>& a, const DenseMatrix<T>& b) {
+    DenseMatrix<T> c(a.rows(), b.cols());
+    multiply_blocked<T>(a.view(), b.view(), c.view());
+    return c;
+}
+
+template<typename T>
+DenseMatrix<T> transpose(const DenseMatrix<T>& m, ThreadPoolRAII* pool = nullptr) {
+    DenseMatrix<T> t(m.cols(), m.rows());
+    transpose_blocked<T>(m.view(), t.view(), pool);
+    return t;
+}
+
+// The textbook loop over the row-of-vectors Matrix
+Matrix multiply_naive(const Matrix& a, const Matrix& b, size_t n) {
+    Matrix c(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            int sum = 0;
+            for (size_t k = 0; k < n; ++k) {
+                sum += a[i, k] * b[k, j];
+            }
+            c[i, j] = sum;
+        }
+    }
+    return c;
+}
+
 void demo_multidim_subscript() {
     std::println("\n=== Multidimensional Subscript ===");
     
@@ -103,6 +289,65 @@ void demo_multidim_subscript() {
     m[2, 2] = 9;
     
     std::println("m[1, 1] = {}", m[1, 1]);
+
+    // The contiguous version: same syntax, plus an mdspan view of the buffer
+    DenseMatrix<int> d(3, 3);
+    d[0, 0] = 1;
+    d[1, 1] = 5;
+    d[2, 2] = 9;
+    auto v = d.view();
+    std::println("d[1, 1] = {}, via mdspan: {}", d[1, 1], v[1, 1]);
+
+    // Multiply: naive loop over vector<vector<int>> vs the blocked kernel
+    const size_t n = 512;
+    Matrix a(n, n), b(n, n);
+    DenseMatrix<int> da(n, n), db(n, n);
+    DenseMatrix<double> fa(n, n), fb(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            const int x = static_cast<int>((i * 31 + j * 17) % 7) - 3;
+            const int y = static_cast<int>((i * 13 + j * 7) % 5) - 2;
+            a[i, j] = da[i, j] = x;
+            b[i, j] = db[i, j] = y;
+            fa[i, j] = x;
+            fb[i, j] = y;
+        }
+    }
+
+    auto gops = [n](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        const double s = std::chrono::duration<double>(end - start).count();
+        return 2.0 * n * n * n / s / 1e9;
+    };
+
+    Matrix naive(n, n);
+    const double naive_rate = gops([&] { naive = multiply_naive(a, b, n); });
+
+    DenseMatrix<int> blocked(n, n);
+    const double blocked_rate = gops([&] { blocked = da * db; });
+
+    ThreadPoolRAII pool(std::max(1u, std::thread::hardware_concurrency()));
+    DenseMatrix<int> pooled(n, n);
+    const double pooled_rate = gops([&] { multiply_blocked<int>(da.view(), db.view(), pooled.view(), &pool); });
+
+    DenseMatrix<double> fc(n, n);
+    const double double_rate = gops([&] { multiply_blocked<double>(fa.view(), fb.view(), fc.view(), &pool); });
+
+    bool same = true;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            same &= naive[i, j] == blocked[i, j] && blocked[i, j] == pooled[i, j] &&
+                    static_cast<double>(blocked[i, j]) == fc[i, j];
+        }
+    }
+    std::println("{}x{} multiply: naive {:.2f}, blocked {:.2f}, blocked on pool {:.2f} GOP/s (int); "
+                 "double on pool {:.2f} GFLOP/s; results {}",
+                 n, n, naive_rate, blocked_rate, pooled_rate, double_rate, same ? "match" : "DIFFER");
+
+    DenseMatrix<int> t = transpose(da, &pool);
+    std::println("transpose: t[3, 5] == da[5, 3]: {}", t[3, 5] == da[5, 3]);
 }
 
 // ============================================================================
@@ -498,7 +743,8 @@ void demo_slide_views() {
     
     std::vector<int> data = {1, 2, 3, 4, 5, 6};
     
-    // Sliding window of size 3
+    // Sliding window of size 3; for rolling sums/min/max over long windows,
+    // see the O(1)-per-step aggregators in 24_Ranges/sliding_window.hpp
     std::println("Sliding window (size 3):");
     for (auto window : data | std::views::slide(3)) {
         std::print("  [");
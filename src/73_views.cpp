@@ -7,6 +7,23 @@
 #include <ranges>
 #include <algorithm>
 #include <numeric>
+#include <iterator>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <charconv>
+#include <functional>
+#include <thread>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "mapped_file.hpp"
+#include "24_Ranges/parallel_pipeline.hpp"
+#include "24_Ranges/sliding_window.hpp"
 
 // ============================================================================
 // std::string_view Examples
@@ -35,6 +52,149 @@ std::vector<std::string_view> split(std::string_view text, char delim) {
     return result;
 }
 
+// Example 2b: Lazy, SIMD-scanned split
+// split() above builds a vector (one allocation, plus regrowth) and finds
+// each delimiter with find(), one char at a time. LazySplitView produces the
+// same tokens one by one as it is iterated, and finds delimiters 64 bytes at
+// a time: the block is compared against the delimiter with SIMD and turned
+// into a 64-bit mask (bit i set = delimiter at block[i]). Walking the mask
+// with countr_zero gives every delimiter in the block without touching the
+// text again. AVX2 does a block in two compares (build with -mavx2), SSE2
+// in four.
+//
+// Same token rules as split(): empty fields between delimiters are kept,
+// a single trailing delimiter does not start a new token.
+//
+// It is a forward view of string_views, so it composes with the standard
+// adaptors: lazySplit(csv, ',') | std::views::filter(...) | ...
+class LazySplitView : public std::ranges::view_interface<LazySplitView> {
+public:
+    class iterator {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        // Positioned on the first token of [begin, end)
+        iterator(const char* begin, const char* end, char delim)
+            : stop_(end), block_(begin), delim_(delim), cur_(begin) {
+            if (begin == end) {
+                cur_ = nullptr;                 // empty text: no tokens
+                return;
+            }
+            mask_ = block_mask(block_);
+            next_ = find_delim(cur_);
+        }
+
+        std::string_view operator*() const {
+            return std::string_view(cur_, static_cast<size_t>(next_ - cur_));
+        }
+
+        iterator& operator++() {
+            if (next_ == stop_ || next_ + 1 == stop_) {
+                cur_ = nullptr;                 // past the last token
+            } else {
+                cur_ = next_ + 1;
+                next_ = find_delim(cur_);
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const iterator& other) const { return cur_ == other.cur_; }
+        bool operator==(std::default_sentinel_t) const { return cur_ == nullptr; }
+
+    private:
+        static constexpr size_t kBlock = 64;
+
+        const char* stop_ = nullptr;
+        const char* block_ = nullptr;           // start of the masked block
+        uint64_t mask_ = 0;                     // delimiters in that block
+        char delim_ = 0;
+        const char* cur_ = nullptr;             // token start, nullptr at end
+        const char* next_ = nullptr;            // delimiter ending the token
+
+        uint64_t block_mask(const char* block) const {
+            const size_t n = static_cast<size_t>(stop_ - block);
+            if (n < kBlock) {
+                uint64_t m = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    m |= static_cast<uint64_t>(block[i] == delim_) << i;
+                }
+                return m;
+            }
+#if defined(__AVX2__)
+            const __m256i d = _mm256_set1_epi8(delim_);
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+            return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, d)))
+                 | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, d)))) << 32;
+#elif defined(__SSE2__)
+            const __m128i d = _mm_set1_epi8(delim_);
+            uint64_t m = 0;
+            for (int k = 0; k < 4; ++k) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * k));
+                m |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, d)))) << (16 * k);
+            }
+            return m;
+#else
+            uint64_t m = 0;
+            for (size_t i = 0; i < kBlock; ++i) {
+                m |= static_cast<uint64_t>(block[i] == delim_) << i;
+            }
+            return m;
+#endif
+        }
+
+        // First delimiter at or after `from` (which is never before block_), or stop_
+        const char* find_delim(const char* from) {
+            while (true) {
+                const size_t offset = static_cast<size_t>(from - block_);
+                if (offset < kBlock) {
+                    const uint64_t pending = mask_ & (~uint64_t{0} << offset);
+                    if (pending) {
+                        return block_ + std::countr_zero(pending);
+                    }
+                }
+                block_ += kBlock;
+                if (block_ >= stop_) {
+                    block_ = stop_;
+                    mask_ = 0;
+                    return stop_;
+                }
+                mask_ = block_mask(block_);
+                from = block_;
+            }
+        }
+    };
+
+    LazySplitView() = default;
+    LazySplitView(std::string_view text, char delim) : text_(text), delim_(delim) {}
+
+    iterator begin() const { return iterator(text_.data(), text_.data() + text_.size(), delim_); }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    std::string_view text_;
+    char delim_ = ',';
+};
+
+// The tokens point into the text, not into the view
+template<>
+inline constexpr bool std::ranges::enable_borrowed_range<LazySplitView> = true;
+
+LazySplitView lazySplit(std::string_view text, char delim) {
+    return LazySplitView(text, delim);
+}
+
 // Example 3: String literal optimization
 constexpr bool startsWith(std::string_view text, std::string_view prefix) {
     return text.size() >= prefix.size() && 
@@ -60,6 +220,12 @@ void stringViewExamples() {
         std::cout << "[" << token << "] ";
     }
     std::cout << "\n";
+
+    std::cout << "Lazy tokens: ";
+    for (std::string_view token : lazySplit(csv, ',')) {
+        std::cout << "[" << token << "] ";
+    }
+    std::cout << "\n";
     
     // Compile-time operations
     constexpr std::string_view msg = "https://example.com";
@@ -98,12 +264,14 @@ void process3DPoint(std::span<float, 3> point) {
               << point[1] << ", " << point[2] << ")\n";
 }
 
-// Example 4: Subspan operations
+// Example 4: Moving window over a span
+// Summing data.subspan(i, windowSize) for every i costs O(n * windowSize);
+// sliding_sum (24_Ranges/sliding_window.hpp) adds the new sample and drops
+// the old one, O(n) for any window size
 void analyzeWindow(std::span<const int> data, size_t windowSize) {
-    for (size_t i = 0; i + windowSize <= data.size(); ++i) {
-        auto window = data.subspan(i, windowSize);
-        int sum = std::accumulate(window.begin(), window.end(), 0);
-        std::cout << "Window " << i << " sum: " << sum << "\n";
+    size_t i = 0;
+    for (auto sum : data | sliding_sum(windowSize)) {
+        std::cout << "Window " << i++ << " sum: " << sum << "\n";
     }
 }
 
@@ -156,6 +324,35 @@ void rangesFilterTransform() {
     std::cout << "\n\n";
 }
 
+void rangesParallelFilterTransform() {
+    std::cout << "=== Filter & Transform in Parallel ===\n";
+
+    // The pipeline of rangesFilterTransform as a reusable closure, run on
+    // chunks of a large input by a thread pool (24_Ranges/parallel_pipeline.hpp)
+    auto evenSquares = std::views::filter([](long long n) { return n % 2 == 0; })
+                     | std::views::transform([](long long n) { return n * n; });
+
+    std::vector<long long> numbers(2'000'000);
+    std::iota(numbers.begin(), numbers.end(), 1);
+
+    ThreadPoolRAII pool(std::max(1u, std::thread::hardware_concurrency()));
+    long long parallel = numbers | par(pool, evenSquares) | par_reduce(0LL, std::plus<>{});
+    long long sequential = 0;
+    for (long long n : numbers | evenSquares) {
+        sequential += n;
+    }
+    std::cout << "Sum of even squares up to 2e6: " << parallel
+              << (parallel == sequential ? " (matches sequential)" : " (MISMATCH)") << "\n";
+
+    std::vector<long long> firstSquares = std::vector<long long>(numbers.begin(), numbers.begin() + 10)
+        | par(pool, evenSquares, 1) | par_to<std::vector>();
+    std::cout << "par_to, first 10 inputs: ";
+    for (long long n : firstSquares) {
+        std::cout << n << " ";
+    }
+    std::cout << "\n\n";
+}
+
 void rangesTakeDropReverse() {
     std::cout << "=== Take, Drop, Reverse ===\n";
     
@@ -277,6 +474,180 @@ void rangesChunking() {
     std::cout << "\n";
 }
 
+void rangesLazySplit() {
+    std::cout << "=== Lazy SIMD Split ===\n";
+
+    // Same shape as rangesFilterTransform, fed by a lazy split: fields are
+    // produced, filtered and measured one at a time, no vector in between
+    std::string record = "id,,name,email,,created_at,updated_at";
+    auto lengths = lazySplit(record, ',')
+        | std::views::filter([](std::string_view f) { return !f.empty(); })
+        | std::views::transform([](std::string_view f) { return f.size(); });
+    std::cout << "Non-empty field lengths: ";
+    for (size_t n : lengths) {
+        std::cout << n << " ";
+    }
+    std::cout << "\n";
+
+    // ...and like rangesChunking, fields taken in groups
+    std::string pairs = "k1,v1,k2,v2,k3,v3";
+    for (auto pair : lazySplit(pairs, ',') | std::views::chunk(2)) {
+        auto it = pair.begin();
+        std::cout << *it << " = " << *std::next(it) << "\n";
+    }
+
+    // Throughput: 64 MiB of CSV-like text
+    std::string text;
+    text.reserve(64u << 20);
+    uint32_t x = 7;
+    while (text.size() < (64u << 20)) {
+        x = x * 1664525u + 1013904223u;
+        text.append(1 + (x >> 26) % 16, 'a' + (x >> 21) % 26);
+        text.push_back(',');
+    }
+
+    // Each returns {tokens, bytes in tokens}
+    auto time = [&](const char* label, auto&& count) {
+        auto start = std::chrono::steady_clock::now();
+        auto [tokens, bytes] = count();
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << label << tokens << " tokens (" << bytes << " bytes), "
+                  << text.size() / s / 1e9 << " GB/s\n";
+    };
+    time("  split() into a vector:  ", [&] {
+        size_t n = 0, bytes = 0;
+        for (std::string_view token : split(text, ',')) {
+            ++n;
+            bytes += token.size();
+        }
+        return std::pair{n, bytes};
+    });
+    time("  std::views::split:      ", [&] {
+        size_t n = 0, bytes = 0;
+        for (auto part : text | std::views::split(',')) {
+            ++n;
+            bytes += static_cast<size_t>(std::ranges::distance(part));
+        }
+        return std::pair{n, bytes};
+    });
+    time("  lazySplit:              ", [&] {
+        size_t n = 0, bytes = 0;
+        for (std::string_view token : lazySplit(text, ',')) {
+            ++n;
+            bytes += token.size();
+        }
+        return std::pair{n, bytes};
+    });
+    std::cout << "  (std::views::split also yields the empty field after the final comma)\n\n";
+}
+
+// The same kind of pipeline, fed from a file: lines(file.text()) is a lazy
+// view over the mapping, so filter/transform see string_views into the page
+// cache and the file is never copied into a std::string
+struct LogTotals {
+    size_t lines = 0;
+    size_t errors = 0;
+    size_t malformed = 0;       // lines without the two commas
+    long long error_bytes = 0;
+};
+
+// "id,status,bytes" -> counts 500s and their bytes. The commas are located
+// first: a short line (e.g. a truncated last line) has no third field to
+// step to, so it is only counted as malformed
+void tallyLine(std::string_view line, LogTotals& totals) {
+    ++totals.lines;
+    const size_t first = line.find(',');
+    const size_t second = first == line.npos ? line.npos : line.find(',', first + 1);
+    if (second == line.npos) {
+        ++totals.malformed;
+        return;
+    }
+    if (line.substr(first + 1, second - first - 1) == "500") {
+        ++totals.errors;
+        const std::string_view bytes = line.substr(second + 1);
+        long long n = 0;
+        std::from_chars(bytes.data(), bytes.data() + bytes.size(), n);
+        totals.error_bytes += n;
+    }
+}
+
+void rangesMappedFile() {
+    std::cout << "=== Memory-Mapped File Pipeline ===\n";
+
+    const auto path = std::filesystem::temp_directory_path() / "73_views_access.log";
+    {
+        std::ofstream out(path, std::ios::binary);
+        uint32_t x = 99;
+        std::string line;
+        for (int i = 0; i < 4'000'000; ++i) {
+            x = x * 1664525u + 1013904223u;
+            line = std::to_string(i);
+            line += (x >> 28) == 0 ? ",500," : ",200,";
+            line += std::to_string((x >> 8) % 100000);
+            line += '\n';
+            out << line;
+        }
+    }
+    const auto file_size = std::filesystem::file_size(path);
+
+    // Filter and transform straight off the mapping
+    MappedFile file(path.string());
+    long long first_errors = 0;
+    for (long long n : lines(file.text())
+             | std::views::filter([](std::string_view l) { return l.find(",500,") != l.npos; })
+             | std::views::take(5)
+             | std::views::transform([](std::string_view l) { return static_cast<long long>(l.size()); })) {
+        first_errors += n;
+    }
+    std::cout << "First 5 error lines: " << first_errors << " chars in total\n";
+
+    auto time = [&](const char* label, auto&& run) {
+        auto start = std::chrono::steady_clock::now();
+        LogTotals t = run();
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << label << t.lines << " lines, " << t.errors << " errors, " << t.error_bytes << " bytes";
+        if (t.malformed > 0) {
+            std::cout << ", " << t.malformed << " malformed";
+        }
+        std::cout << "; " << file_size / s / 1e9 << " GB/s\n";
+    };
+    time("  std::ifstream + getline: ", [&] {
+        LogTotals t;
+        std::ifstream in(path, std::ios::binary);
+        std::string line;
+        while (std::getline(in, line)) {
+            tallyLine(line, t);
+        }
+        return t;
+    });
+    time("  MappedFile + lines():    ", [&] {
+        LogTotals t;
+        MappedFile mapped(path.string(), MappedFile::Advice::Sequential);
+        for (std::string_view line : lines(mapped.text())) {
+            tallyLine(line, t);
+        }
+        return t;
+    });
+    // The source alone, no per-line work
+    time("  getline, count only:     ", [&] {
+        LogTotals t;
+        std::ifstream in(path, std::ios::binary);
+        std::string line;
+        while (std::getline(in, line)) {
+            ++t.lines;
+        }
+        return t;
+    });
+    time("  lines(), count only:     ", [&] {
+        LogTotals t;
+        MappedFile mapped(path.string(), MappedFile::Advice::Sequential);
+        t.lines = static_cast<size_t>(std::ranges::distance(lines(mapped.text())));
+        return t;
+    });
+    std::cout << "  (" << file_size / (1 << 20) << " MiB, already in the page cache)\n\n";
+    std::filesystem::remove(path);
+}
+
 void rangesPracticalExample() {
     std::cout << "=== Practical Example: Data Pipeline ===\n";
     
@@ -311,12 +682,15 @@ int main() {
     
     std::cout << "=== Ranges Views Examples ===\n\n";
     rangesFilterTransform();
+    rangesParallelFilterTransform();
     rangesTakeDropReverse();
     rangesComposition();
     rangesEnumerate();
     rangesJoin();
     rangesSplit();
     rangesChunking();
+    rangesLazySplit();
+    rangesMappedFile();
     rangesPracticalExample();
     
     return 0;
@@ -0,0 +1,602 @@
+/**
+ * @file async_comm.hpp
+ * @brief epoll-driven async comm backend with coroutine awaitables (Linux)
+ *
+ * IScriptInterpreterComm models one blocking send/recv pair with a timeout,
+ * so a script runs at one device round trip per command: with 1 ms device
+ * latency, 1000 queries take a second no matter how fast the link is. Most
+ * of those queries do not depend on each other. With several in flight the
+ * link stays busy and throughput is limited by bandwidth, not by latency.
+ *
+ *   EpollReactor     single-threaded event loop: fd readiness through
+ *                    epoll, deadlines through a timer heap, and a ready
+ *                    queue of coroutines to resume. run() returns once
+ *                    every spawn()ed task has finished.
+ *   AsyncTask<T>     lazy coroutine task, awaited with co_await (same shape
+ *                    as coro::Task in 40_Coroutines/task.hpp).
+ *   AsyncChannel     a non-blocking fd (serial tty, socket, pipe pair):
+ *                      co_await channel.send(bytes)    whole buffer, senders
+ *                                                      never interleave
+ *                      co_await channel.request(payload, timeout)
+ *                                                      tagged request frame,
+ *                                                      resumes with the reply
+ *                                                      carrying the same tag
+ *                    Replies are matched by tag as they arrive, in any
+ *                    order; a reply that misses its deadline completes the
+ *                    request with AsyncStatus::Timeout and is dropped if it
+ *                    shows up later.
+ *
+ * Frames are the FrameWriter frames of comm_buffers.hpp; a request/reply
+ * payload starts with a 16-bit little-endian tag. Outgoing frames and reply
+ * payloads live in BufferPool buffers.
+ */
+
+#pragma once
+
+#include "comm_buffers.hpp"
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fcntl.h>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <system_error>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//=============================================================================
+// AsyncTask<T> - lazy, awaitable; finishing resumes the awaiter directly
+//=============================================================================
+template<typename T>
+struct AsyncTaskResult {
+    std::optional<T> value;
+    std::exception_ptr exception;
+
+    void return_value(T v) { value.emplace(std::move(v)); }
+
+    T take() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+};
+
+template<>
+struct AsyncTaskResult<void> {
+    std::exception_ptr exception;
+
+    void return_void() {}
+
+    void take() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+template<typename T = void>
+class AsyncTask {
+public:
+    struct promise_type : AsyncTaskResult<T> {
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+
+        AsyncTask get_return_object() {
+            return AsyncTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                return h.promise().continuation;
+            }
+            void await_resume() const noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { this->exception = std::current_exception(); }
+    };
+
+    AsyncTask(AsyncTask&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    AsyncTask& operator=(AsyncTask&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+
+    ~AsyncTask() {
+        if (m_handle) m_handle.destroy();
+    }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().take(); }
+        };
+        return Awaiter{m_handle};
+    }
+
+private:
+    explicit AsyncTask(std::coroutine_handle<promise_type> h) : m_handle(h) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+//=============================================================================
+// EpollReactor - fd readiness, deadlines and a ready queue on one thread
+//=============================================================================
+class EpollReactor {
+public:
+    using Clock = std::chrono::steady_clock;
+    using IoCallback = void (*)(void* context, uint32_t events);
+    using TimerCallback = void (*)(void* context, uint64_t cookie);
+
+    EpollReactor() : m_epoll(::epoll_create1(EPOLL_CLOEXEC)) {
+        if (m_epoll < 0) {
+            throw std::system_error(errno, std::generic_category(), "epoll_create1");
+        }
+    }
+
+    EpollReactor(const EpollReactor&) = delete;
+    EpollReactor& operator=(const EpollReactor&) = delete;
+
+    ~EpollReactor() { ::close(m_epoll); }
+
+    /// Calls callback(context, events) whenever fd is ready for events (level-triggered)
+    void add(int fd, uint32_t events, IoCallback callback, void* context) {
+        auto registration = std::make_unique<Registration>(Registration{callback, context});
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.ptr = registration.get();
+        if (::epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            throw std::system_error(errno, std::generic_category(), "epoll_ctl(ADD)");
+        }
+        m_registrations[fd] = std::move(registration);
+    }
+
+    void modify(int fd, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.ptr = m_registrations.at(fd).get();
+        if (::epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &ev) != 0) {
+            throw std::system_error(errno, std::generic_category(), "epoll_ctl(MOD)");
+        }
+    }
+
+    void remove(int fd) {
+        ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+        m_registrations.erase(fd);
+    }
+
+    /// callback(context, cookie) once, at or after deadline. Single timers
+    /// cannot be cancelled; the callback checks whether it still matters.
+    void addTimer(Clock::time_point deadline, TimerCallback callback, void* context, uint64_t cookie) {
+        m_timers.push(Timer{deadline, callback, context, cookie});
+    }
+
+    /// Drops every pending timer for context (its owner is going away)
+    void cancelTimers(void* context) {
+        std::vector<Timer> keep;
+        while (!m_timers.empty()) {
+            if (m_timers.top().context != context) {
+                keep.push_back(m_timers.top());
+            }
+            m_timers.pop();
+        }
+        for (const Timer& timer : keep) {
+            m_timers.push(timer);
+        }
+    }
+
+    /// Resumes h from the run loop (never from inside the caller's stack)
+    void post(std::coroutine_handle<> h) { m_ready.push_back(h); }
+
+    /// Starts task now; run() keeps going until it has finished
+    void spawn(AsyncTask<void> task) {
+        ++m_live;
+        detach(*this, std::move(task));
+    }
+
+    /// Runs until every spawned task has finished; rethrows the first exception one threw
+    void run() {
+        std::array<epoll_event, 64> events;
+        while (m_live > 0) {
+            while (!m_ready.empty()) {
+                auto h = m_ready.front();
+                m_ready.pop_front();
+                h.resume();
+            }
+            if (m_live == 0) {
+                break;
+            }
+            fireTimers();
+            if (!m_ready.empty()) {
+                continue;
+            }
+            if (m_registrations.empty() && m_timers.empty()) {
+                throw std::logic_error("EpollReactor::run: tasks waiting on nothing");
+            }
+            int timeout = -1;
+            if (!m_timers.empty()) {
+                const auto wait = m_timers.top().deadline - Clock::now();
+                timeout = static_cast<int>(std::max<int64_t>(
+                    0, std::chrono::ceil<std::chrono::milliseconds>(wait).count()));
+            }
+            const int n = ::epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), timeout);
+            if (n < 0 && errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "epoll_wait");
+            }
+            for (int i = 0; i < n; ++i) {
+                auto* registration = static_cast<Registration*>(events[i].data.ptr);
+                registration->callback(registration->context, events[i].events);
+            }
+        }
+        if (m_error) {
+            std::rethrow_exception(std::exchange(m_error, nullptr));
+        }
+    }
+
+private:
+    struct Registration {
+        IoCallback callback;
+        void* context;
+    };
+
+    struct Timer {
+        Clock::time_point deadline;
+        TimerCallback callback;
+        void* context;
+        uint64_t cookie;
+
+        bool operator>(const Timer& other) const { return deadline > other.deadline; }
+    };
+
+    // Fire-and-forget wrapper: owns the task, counts it out when it ends
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    static Detached detach(EpollReactor& reactor, AsyncTask<void> task) {
+        try {
+            co_await std::move(task);
+        } catch (...) {
+            if (!reactor.m_error) {
+                reactor.m_error = std::current_exception();
+            }
+        }
+        --reactor.m_live;
+    }
+
+    void fireTimers() {
+        const auto now = Clock::now();
+        while (!m_timers.empty() && m_timers.top().deadline <= now) {
+            const Timer timer = m_timers.top();
+            m_timers.pop();
+            timer.callback(timer.context, timer.cookie);
+        }
+    }
+
+    int m_epoll;
+    size_t m_live = 0;
+    std::exception_ptr m_error;
+    std::deque<std::coroutine_handle<>> m_ready;
+    std::unordered_map<int, std::unique_ptr<Registration>> m_registrations;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_timers;
+};
+
+//=============================================================================
+// AsyncChannel - tagged request/reply over one non-blocking fd
+//=============================================================================
+enum class AsyncStatus {
+    Success,
+    Timeout,
+    Closed,
+    Error,
+};
+
+class AsyncChannel {
+public:
+    struct Reply {
+        AsyncStatus status;
+        PooledBuffer payload;       // reply payload after the tag; empty unless Success
+    };
+
+    /// Puts fd in non-blocking mode and watches it; fd stays owned by the caller
+    AsyncChannel(EpollReactor& reactor, int fd, BufferPool& pool, size_t rxCapacity = 64 * 1024)
+        : m_reactor(reactor), m_fd(fd), m_pool(pool), m_rx(rxCapacity)
+    {
+        ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+        m_reactor.add(m_fd, EPOLLIN, &AsyncChannel::onEvents, this);
+    }
+
+    AsyncChannel(const AsyncChannel&) = delete;
+    AsyncChannel& operator=(const AsyncChannel&) = delete;
+
+    ~AsyncChannel() {
+        m_reactor.cancelTimers(this);
+        if (m_watching) {
+            m_reactor.remove(m_fd);
+        }
+    }
+
+    /// Writes all of bytes. Concurrent senders are queued, so frames never interleave.
+    AsyncTask<AsyncStatus> send(std::span<const uint8_t> bytes) {
+        co_await WriteLock{*this};
+        AsyncStatus status = AsyncStatus::Success;
+        size_t offset = 0;
+        while (offset < bytes.size()) {
+            const ssize_t n = ::write(m_fd, bytes.data() + offset, bytes.size() - offset);
+            if (n > 0) {
+                offset += static_cast<size_t>(n);
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (!m_watching) {
+                    status = AsyncStatus::Closed;   // nothing will report EPOLLOUT any more
+                    break;
+                }
+                co_await Writable{*this};
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                status = AsyncStatus::Error;
+                break;
+            }
+        }
+        unlockWriter();
+        co_return status;
+    }
+
+    /// Sends payload as a tagged frame and resumes with the matching reply
+    AsyncTask<Reply> request(std::span<const uint8_t> payload, std::chrono::milliseconds timeout) {
+        if (!m_watching) {
+            co_return Reply{AsyncStatus::Closed, {}};   // no reply can arrive after EOF
+        }
+        PooledBuffer out = m_pool.acquire();
+        if (!out || payload.size() + FrameWriter::kOverhead + 2 > out.capacity()) {
+            co_return Reply{AsyncStatus::Error, {}};
+        }
+        const uint16_t tag = nextFreeTag();
+        FrameWriter frame(out);
+        const uint8_t tagBytes[2] = {static_cast<uint8_t>(tag & 0xFF), static_cast<uint8_t>(tag >> 8)};
+        frame.append(tagBytes);
+        frame.append(payload);
+        frame.finish();
+
+        // Registered before sending: the reply may beat send() back
+        Pending pending;
+        pending.sequence = ++m_sequence;
+        m_pending[tag] = &pending;
+        m_reactor.addTimer(EpollReactor::Clock::now() + timeout, &AsyncChannel::onTimeout, this,
+                           (pending.sequence << 16) | tag);
+
+        const AsyncStatus sent = co_await send(out.data());
+        if (sent != AsyncStatus::Success && !pending.done) {
+            m_pending.erase(tag);
+            co_return Reply{sent, {}};
+        }
+        if (!pending.done) {
+            co_await PendingAwaiter{pending};
+        }
+        co_return std::move(pending.reply);
+    }
+
+    size_t inFlight() const { return m_pending.size(); }
+
+private:
+    struct Pending {
+        uint64_t sequence = 0;
+        bool done = false;
+        std::coroutine_handle<> waiter;
+        Reply reply{AsyncStatus::Error, {}};
+    };
+
+    struct PendingAwaiter {
+        Pending& pending;
+        bool await_ready() const noexcept { return pending.done; }
+        void await_suspend(std::coroutine_handle<> h) noexcept { pending.waiter = h; }
+        void await_resume() const noexcept {}
+    };
+
+    struct WriteLock {
+        AsyncChannel& channel;
+        bool await_ready() noexcept {
+            if (!channel.m_writing) {
+                channel.m_writing = true;
+                return true;
+            }
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> h) { channel.m_writeQueue.push_back(h); }
+        void await_resume() const noexcept {}
+    };
+
+    struct Writable {
+        AsyncChannel& channel;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            channel.m_blockedWriter = h;
+            channel.m_reactor.modify(channel.m_fd, EPOLLIN | EPOLLOUT);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    void unlockWriter() {
+        if (m_writeQueue.empty()) {
+            m_writing = false;
+        } else {
+            // Ownership passes straight to the next sender
+            m_reactor.post(m_writeQueue.front());
+            m_writeQueue.pop_front();
+        }
+    }
+
+    uint16_t nextFreeTag() {
+        if (m_pending.size() > 0xFFFF) {
+            throw std::length_error("AsyncChannel: 65536 requests in flight");
+        }
+        while (m_pending.count(m_nextTag)) {
+            ++m_nextTag;
+        }
+        return m_nextTag++;
+    }
+
+    void complete(uint16_t tag, Reply reply) {
+        auto it = m_pending.find(tag);
+        if (it == m_pending.end()) {
+            return;                         // late reply to a timed-out request
+        }
+        Pending& pending = *it->second;
+        m_pending.erase(it);
+        pending.reply = std::move(reply);
+        pending.done = true;
+        if (pending.waiter) {
+            m_reactor.post(pending.waiter);
+        }
+    }
+
+    static void onTimeout(void* context, uint64_t cookie) {
+        auto& self = *static_cast<AsyncChannel*>(context);
+        const uint16_t tag = static_cast<uint16_t>(cookie & 0xFFFF);
+        auto it = self.m_pending.find(tag);
+        if (it != self.m_pending.end() && it->second->sequence == (cookie >> 16)) {
+            self.complete(tag, Reply{AsyncStatus::Timeout, {}});
+        }
+    }
+
+    static void onEvents(void* context, uint32_t events) {
+        auto& self = *static_cast<AsyncChannel*>(context);
+        if ((events & EPOLLOUT) && self.m_blockedWriter) {
+            self.m_reactor.modify(self.m_fd, EPOLLIN);
+            self.m_reactor.post(std::exchange(self.m_blockedWriter, {}));
+        }
+        if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            self.onReadable();
+        }
+    }
+
+    void onReadable() {
+        for (;;) {
+            if (m_rxSize == m_rx.size()) {
+                // A frame bigger than the buffer can never complete: drop it
+                m_rxSize = 0;
+            }
+            const ssize_t n = ::read(m_fd, m_rx.data() + m_rxSize, m_rx.size() - m_rxSize);
+            if (n > 0) {
+                m_rxSize += static_cast<size_t>(n);
+                parseFrames();
+            } else if (n == 0) {
+                failAll(AsyncStatus::Closed);
+                stopWatching();
+                return;
+            } else if (errno == EINTR) {
+                continue;
+            } else {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    failAll(AsyncStatus::Error);
+                }
+                return;
+            }
+        }
+    }
+
+    // After EOF. EPOLLHUP is reported whatever the event mask, so a
+    // level-triggered fd left registered would wake every epoll_wait: take it
+    // out instead, and let a writer blocked on EPOLLOUT retry (and fail)
+    void stopWatching() {
+        m_reactor.remove(m_fd);
+        m_watching = false;
+        if (m_blockedWriter) {
+            m_reactor.post(std::exchange(m_blockedWriter, {}));
+        }
+    }
+
+    void parseFrames() {
+        size_t pos = 0;
+        while (m_rxSize - pos >= FrameWriter::kOverhead) {
+            const uint8_t* frame = m_rx.data() + pos;
+            if (frame[0] != FrameWriter::kStart) {
+                ++pos;                      // resynchronize on the next start byte
+                continue;
+            }
+            const size_t length = frame[1] | (static_cast<size_t>(frame[2]) << 8);
+            if (m_rxSize - pos < FrameWriter::kOverhead + length) {
+                break;                      // incomplete, wait for more
+            }
+            uint8_t sum = 0;
+            for (size_t i = 0; i < length; ++i) {
+                sum = static_cast<uint8_t>(sum + frame[FrameWriter::kHeaderSize + i]);
+            }
+            if (sum != frame[FrameWriter::kHeaderSize + length] || length < 2) {
+                ++pos;
+                continue;
+            }
+            const uint8_t* body = frame + FrameWriter::kHeaderSize;
+            const uint16_t tag = static_cast<uint16_t>(body[0] | (body[1] << 8));
+            if (m_pending.count(tag)) {
+                PooledBuffer payload = m_pool.acquire();
+                if (payload && payload.capacity() >= length - 2) {
+                    std::memcpy(payload.tail().data(), body + 2, length - 2);
+                    payload.commit(length - 2);
+                    complete(tag, Reply{AsyncStatus::Success, std::move(payload)});
+                } else {
+                    complete(tag, Reply{AsyncStatus::Error, {}});
+                }
+            }
+            pos += FrameWriter::kOverhead + length;
+        }
+        std::memmove(m_rx.data(), m_rx.data() + pos, m_rxSize - pos);
+        m_rxSize -= pos;
+    }
+
+    void failAll(AsyncStatus status) {
+        while (!m_pending.empty()) {
+            complete(m_pending.begin()->first, Reply{status, {}});
+        }
+    }
+
+    EpollReactor& m_reactor;
+    int m_fd;
+    BufferPool& m_pool;
+
+    std::vector<uint8_t> m_rx;
+    size_t m_rxSize = 0;
+    bool m_watching = true;         // fd registered with the reactor; false after EOF
+
+    bool m_writing = false;
+    std::deque<std::coroutine_handle<>> m_writeQueue;
+    std::coroutine_handle<> m_blockedWriter;
+
+    uint16_t m_nextTag = 0;
+    uint64_t m_sequence = 0;
+    std::unordered_map<uint16_t, Pending*> m_pending;
+};
@@ -0,0 +1,263 @@
+/**
+ * @file comm_buffers.hpp
+ * @brief Registered pool of fixed-size aligned I/O buffers, in-place framing, vectored I/O signatures
+ *
+ * The SendFunc/RecvFunc pair of IScriptInterpreterComm moves one span per
+ * call and takes the driver as std::shared_ptr<const TDriver> by value, so
+ * every I/O pays an atomic increment and decrement on top of the syscall,
+ * and a frame built as header + payload + trailer is either copied into a
+ * temporary vector or sent in three calls.
+ *
+ * This header provides the pieces for the other way round:
+ *
+ *   BufferPool       one aligned allocation cut into N buffers of the same
+ *                    size, handed out and taken back through a free list.
+ *                    The block never moves, so it can be registered once
+ *                    with a driver (DMA, io_uring fixed buffers, mlock).
+ *   PooledBuffer     move-only handle to one buffer; returns it on
+ *                    destruction. Tracks how many bytes are filled.
+ *   FrameWriter      writes a frame straight into a PooledBuffer: header
+ *                    space is reserved first, the payload is written (or
+ *                    received) in place behind it, finish() fills in the
+ *                    length and checksum. No intermediate copy.
+ *   VectoredComm     send/recv signatures taking several spans per call
+ *                    and the driver by const reference.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+class BufferPool;
+
+//=============================================================================
+// PooledBuffer - one buffer on loan from a BufferPool
+//=============================================================================
+class PooledBuffer {
+public:
+    PooledBuffer() = default;
+    PooledBuffer(PooledBuffer&& other) noexcept
+        : m_pool(std::exchange(other.m_pool, nullptr)), m_data(other.m_data),
+          m_capacity(other.m_capacity), m_size(other.m_size) {}
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            m_pool = std::exchange(other.m_pool, nullptr);
+            m_data = other.m_data;
+            m_capacity = other.m_capacity;
+            m_size = other.m_size;
+        }
+        return *this;
+    }
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+    ~PooledBuffer() { release(); }
+
+    /// False when default-constructed, moved from, or the pool was exhausted
+    explicit operator bool() const { return m_pool != nullptr; }
+
+    size_t capacity() const { return m_capacity; }
+    size_t size() const { return m_size; }
+
+    /// Filled bytes - what a send should transmit
+    std::span<const uint8_t> data() const { return {m_data, m_size}; }
+    /// Unfilled bytes - where a recv or a writer should put data, then commit()
+    std::span<uint8_t> tail() { return {m_data + m_size, m_capacity - m_size}; }
+
+    void commit(size_t bytes) {
+        if (bytes > m_capacity - m_size) {
+            throw std::length_error("PooledBuffer::commit past capacity");
+        }
+        m_size += bytes;
+    }
+
+    void clear() { m_size = 0; }
+
+    /// Direct access for writers that patch earlier bytes (headers)
+    uint8_t* raw() { return m_data; }
+
+    inline void release();
+
+private:
+    friend class BufferPool;
+    PooledBuffer(BufferPool* pool, uint8_t* data, size_t capacity)
+        : m_pool(pool), m_data(data), m_capacity(capacity) {}
+
+    BufferPool* m_pool = nullptr;
+    uint8_t* m_data = nullptr;
+    size_t m_capacity = 0;
+    size_t m_size = 0;
+};
+
+//=============================================================================
+// BufferPool - fixed-size, aligned, reusable buffers in one block
+//=============================================================================
+class BufferPool {
+public:
+    /**
+     * @param count       number of buffers
+     * @param bufferSize  bytes per buffer, rounded up to a multiple of alignment
+     * @param alignment   alignment of every buffer (power of two, >= 64 keeps
+     *                    buffers off each other's cache lines)
+     */
+    BufferPool(size_t count, size_t bufferSize, size_t alignment = 64)
+        : m_alignment(alignment),
+          m_bufferSize((bufferSize + alignment - 1) / alignment * alignment),
+          m_count(count)
+    {
+        m_block = static_cast<uint8_t*>(::operator new(m_bufferSize * m_count, std::align_val_t(m_alignment)));
+        m_free.reserve(m_count);
+        for (size_t i = m_count; i-- > 0;) {
+            m_free.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /// All buffers must have been returned
+    ~BufferPool() { ::operator delete(m_block, std::align_val_t(m_alignment)); }
+
+    /// A buffer, or an empty handle when all are on loan (never allocates)
+    PooledBuffer acquire() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.empty()) {
+            return {};
+        }
+        const uint32_t index = m_free.back();
+        m_free.pop_back();
+        return PooledBuffer(this, m_block + static_cast<size_t>(index) * m_bufferSize, m_bufferSize);
+    }
+
+    size_t bufferSize() const { return m_bufferSize; }
+    size_t count() const { return m_count; }
+
+    size_t available() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_free.size();
+    }
+
+    /// The whole block, for one-time registration with a driver
+    std::span<uint8_t> region() { return {m_block, m_bufferSize * m_count}; }
+
+private:
+    friend class PooledBuffer;
+
+    void giveBack(uint8_t* data) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(static_cast<uint32_t>((data - m_block) / m_bufferSize));
+    }
+
+    size_t m_alignment;
+    size_t m_bufferSize;
+    size_t m_count;
+    uint8_t* m_block;
+    std::mutex m_mutex;
+    std::vector<uint32_t> m_free;
+};
+
+inline void PooledBuffer::release() {
+    if (m_pool) {
+        m_pool->giveBack(m_data);
+        m_pool = nullptr;
+        m_size = 0;
+    }
+}
+
+//=============================================================================
+// FrameWriter - [0x02][len lo][len hi] payload [sum8] built in place
+//=============================================================================
+class FrameWriter {
+public:
+    static constexpr uint8_t kStart = 0x02;
+    static constexpr size_t kHeaderSize = 3;
+    static constexpr size_t kTrailerSize = 1;
+    static constexpr size_t kOverhead = kHeaderSize + kTrailerSize;
+
+    /// Starts a frame at the end of buffer's filled bytes
+    /// @throws std::length_error if not even an empty frame fits
+    explicit FrameWriter(PooledBuffer& buffer) : m_buffer(buffer), m_start(buffer.size()) {
+        if (m_buffer.tail().size() < kOverhead) {
+            throw std::length_error("FrameWriter: no room for header and checksum");
+        }
+        m_buffer.commit(kHeaderSize);
+    }
+
+    /// Room left for payload (the trailer byte is held back)
+    std::span<uint8_t> payloadSpace() {
+        auto tail = m_buffer.tail();
+        return tail.first(tail.size() < kTrailerSize ? 0 : tail.size() - kTrailerSize);
+    }
+
+    /// Marks bytes written into payloadSpace() as payload
+    void commitPayload(size_t bytes) {
+        if (bytes > payloadSpace().size()) {
+            throw std::length_error("FrameWriter: payload exceeds buffer");
+        }
+        m_buffer.commit(bytes);
+    }
+
+    void append(std::span<const uint8_t> bytes) {
+        auto space = payloadSpace();
+        if (bytes.size() > space.size()) {
+            throw std::length_error("FrameWriter: payload exceeds buffer");
+        }
+        std::memcpy(space.data(), bytes.data(), bytes.size());
+        m_buffer.commit(bytes.size());
+    }
+
+    /// Fills in the header and appends the checksum; returns the frame size
+    size_t finish() {
+        uint8_t* frame = m_buffer.raw() + m_start;
+        const size_t payload = m_buffer.size() - m_start - kHeaderSize;
+        if (payload > 0xFFFF) {
+            throw std::length_error("FrameWriter: payload exceeds 16-bit length");
+        }
+        frame[0] = kStart;
+        frame[1] = static_cast<uint8_t>(payload & 0xFF);
+        frame[2] = static_cast<uint8_t>(payload >> 8);
+        uint8_t sum = 0;
+        for (size_t i = 0; i < payload; ++i) {
+            sum = static_cast<uint8_t>(sum + frame[kHeaderSize + i]);
+        }
+        // payloadSpace() holds the trailer byte back, but the buffer may have
+        // been filled past it directly
+        if (m_buffer.tail().size() < kTrailerSize) {
+            throw std::length_error("FrameWriter: no room for the checksum");
+        }
+        m_buffer.tail()[0] = sum;
+        m_buffer.commit(kTrailerSize);
+        return kOverhead + payload;
+    }
+
+private:
+    PooledBuffer& m_buffer;
+    size_t m_start;
+};
+
+//=============================================================================
+// VectoredComm - several spans per call, driver by reference
+//=============================================================================
+/**
+ * WriteResult/ReadResult/ReadOptions are the driver's own result types
+ * (ICommDriver's in the interpreter). The driver is borrowed for the call:
+ * whoever owns it keeps it alive, and no reference count is touched.
+ */
+template<typename TDriver, typename WriteResult, typename ReadResult, typename ReadOptions>
+struct VectoredComm {
+    using ConstBuffers = std::span<const std::span<const uint8_t>>;
+    using MutableBuffers = std::span<const std::span<uint8_t>>;
+
+    using SendVFunc = std::function<WriteResult(uint32_t timeout, ConstBuffers buffers, const TDriver& driver)>;
+    using RecvVFunc = std::function<ReadResult(uint32_t timeout, MutableBuffers buffers,
+                                               const ReadOptions& options, const TDriver& driver)>;
+};
@@ -4,10 +4,40 @@
  */
 
 #include "IScriptInterpreterShell.hpp"
+#include "script_compiler.hpp"
+#include "comm_buffers.hpp"
+#include "async_comm.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include <iostream>
+#include <new>
 #include <vector>
 #include <memory>
 
+// Counts every heap allocation, so the benchmark below can show that running
+// a compiled script allocates nothing
+static size_t g_allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
 // Example types
 struct ScriptEntry {
     std::string command;
@@ -24,6 +54,7 @@ class ConcreteInterpreter : public IScriptInterpreterShell<std::vector<ScriptEnt
 public:
     using SendFunc = IScriptInterpreterShell::SendFunc;
     using RecvFunc = IScriptInterpreterShell::RecvFunc;
+    using Commands = CommandTable<ConcreteInterpreter, 5>;
 
     ConcreteInterpreter(SendFunc send, RecvFunc recv)
         : IScriptInterpreterShell(send, recv, 100, 4096)
@@ -31,9 +62,16 @@ public:
         std::cout << "ConcreteInterpreter constructed\n";
     }
 
+    // One virtual call per script: compile, then run through the jump table
     bool interpretScript(std::vector<ScriptEntry>& entries) override {
         std::cout << "ConcreteInterpreter::interpretScript() called\n";
-        return true;
+        std::string error;
+        auto compiled = compileScript(commandTable(), entries, &error);
+        if (!compiled) {
+            std::cout << "  compile failed: " << error << "\n";
+            return false;
+        }
+        return run(*compiled);
     }
 
     bool listItems() override {
@@ -43,6 +81,9 @@ public:
 
     bool listCommands() override {
         std::cout << "ConcreteInterpreter::listCommands() called\n";
+        for (const auto& command : commandTable().commands()) {
+            std::cout << "  " << command.name << "\n";
+        }
         return true;
     }
 
@@ -51,12 +92,472 @@ public:
         return true;
     }
 
+    // Shell line "NAME params": same table, same handlers as compiled scripts
     bool executeCmd(const std::string& cmd) override {
         std::cout << "ConcreteInterpreter::executeCmd(" << cmd << ") called\n";
+        const std::string_view line(cmd);
+        const size_t space = line.find(' ');
+        const std::string_view name = line.substr(0, space);
+        const std::string_view params = space == std::string_view::npos ? std::string_view() : line.substr(space + 1);
+        const uint16_t opcode = commandTable().find(name);
+        if (opcode == Commands::kUnknown) {
+            std::cout << "  unknown command '" << name << "'\n";
+            return false;
+        }
+        return commandTable().handler(opcode)(*this, params);
+    }
+
+    // Non-virtual entry points for callers that compile once and run often
+    // Built at compile time: a duplicate command name does not compile
+    static const Commands& commandTable() {
+        static constexpr Commands table(kCommands);
+        return table;
+    }
+
+    bool run(const CompiledScript& script) {
+        return runScript(commandTable(), script, *this) == script.size();
+    }
+
+    /**
+     * Runs a script of independent commands with up to `window` QUERY
+     * requests in flight on channel; replies are matched as they arrive.
+     * Other commands run through their handlers when a worker reaches them,
+     * so their order relative to queries is not kept.
+     * @return number of entries that succeeded
+     */
+    size_t runPipelined(EpollReactor& reactor, AsyncChannel& channel, const CompiledScript& script, size_t window) {
+        PipelineState state{channel, script, commandTable().find("QUERY")};
+        for (size_t i = 0; i < std::max<size_t>(window, 1); ++i) {
+            reactor.spawn(pipelineWorker(state));
+        }
+        reactor.run();
+        return state.succeeded;
+    }
+
+    size_t bytesSent() const { return m_bytesSent; }
+    size_t bytesReceived() const { return m_bytesReceived; }
+    size_t checksRun() const { return m_checksRun; }
+    uint64_t delayMs() const { return m_delayMs; }
+
+private:
+    struct PipelineState {
+        AsyncChannel& channel;
+        const CompiledScript& script;
+        uint16_t queryOpcode;
+        size_t next = 0;
+        size_t succeeded = 0;
+    };
+
+    // One of `window` workers: claims the next entry until none are left.
+    // Workers only interleave at co_await, so the shared counters need no lock.
+    AsyncTask<void> pipelineWorker(PipelineState& state) {
+        const auto& entries = state.script.entries();
+        while (state.next < entries.size()) {
+            const auto& entry = entries[state.next++];
+            const std::string_view params = state.script.params(entry);
+            if (entry.opcode != state.queryOpcode) {
+                state.succeeded += commandTable().handler(entry.opcode)(*this, params);
+                continue;
+            }
+            auto reply = co_await state.channel.request(
+                {reinterpret_cast<const uint8_t*>(params.data()), params.size()}, std::chrono::milliseconds(500));
+            // The device answers "OK <request>": a reply matched to the wrong
+            // request would fail here
+            const std::string_view answer(reinterpret_cast<const char*>(reply.payload.data().data()),
+                                          reply.payload.size());
+            if (reply.status == AsyncStatus::Success && answer.substr(0, 3) == "OK " &&
+                answer.substr(3) == params && cmdQuery(*this, params)) {
+                ++state.succeeded;
+                m_bytesReceived += reply.payload.size();
+            }
+        }
+    }
+
+    // Handlers: no output and no allocation, they only account for the work
+    // a serial session would do
+    static bool cmdTest(ConcreteInterpreter& self, std::string_view) {
+        ++self.m_checksRun;
+        return true;
+    }
+
+    static bool cmdSend(ConcreteInterpreter& self, std::string_view params) {
+        self.m_bytesSent += params.size();
         return true;
     }
+
+    static bool cmdExpect(ConcreteInterpreter& self, std::string_view params) {
+        ++self.m_checksRun;
+        return !params.empty();
+    }
+
+    static bool cmdDelay(ConcreteInterpreter& self, std::string_view params) {
+        uint64_t ms = 0;
+        for (char c : params) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            ms = ms * 10 + static_cast<uint64_t>(c - '0');
+        }
+        self.m_delayMs += ms;
+        return true;
+    }
+
+    // Synchronous side of QUERY; runPipelined() sends the request itself
+    static bool cmdQuery(ConcreteInterpreter& self, std::string_view params) {
+        self.m_bytesSent += params.size();
+        return !params.empty();
+    }
+
+    static constexpr std::array<Commands::Command, 5> kCommands = {{
+        {"TEST", &ConcreteInterpreter::cmdTest},
+        {"SEND", &ConcreteInterpreter::cmdSend},
+        {"EXPECT", &ConcreteInterpreter::cmdExpect},
+        {"DELAY", &ConcreteInterpreter::cmdDelay},
+        {"QUERY", &ConcreteInterpreter::cmdQuery},
+    }};
+
+    size_t m_bytesSent = 0;
+    size_t m_bytesReceived = 0;
+    size_t m_checksRun = 0;
+    uint64_t m_delayMs = 0;
 };
 
+//=============================================================================
+// Compiled scripts: cost per entry of a 200000-entry script
+//=============================================================================
+void compiledScriptBenchmark(ConcreteInterpreter& interpreter)
+{
+    std::cout << "=== Compiled script benchmark ===\n";
+    const std::array<ScriptEntry, 4> pattern = {{
+        {"SEND", "AT+CGMI\r\n"},
+        {"EXPECT", "OK"},
+        {"DELAY", "5"},
+        {"TEST", ""},
+    }};
+    std::vector<ScriptEntry> script;
+    for (size_t i = 0; i < 200000; ++i) {
+        script.push_back(pattern[i % pattern.size()]);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto compiled = compileScript(ConcreteInterpreter::commandTable(), script);
+    auto t1 = std::chrono::steady_clock::now();
+    const size_t before = g_allocations;
+    const bool ok = compiled && interpreter.run(*compiled);
+    auto t2 = std::chrono::steady_clock::now();
+    const size_t runAllocations = g_allocations - before;
+
+    auto perEntry = [&](auto a, auto b) {
+        return std::chrono::duration<double, std::nano>(b - a).count() / static_cast<double>(script.size());
+    };
+    std::cout << "compile: " << perEntry(t0, t1) << " ns/entry\n";
+    std::cout << "run:     " << perEntry(t1, t2) << " ns/entry, " << runAllocations << " allocations, "
+              << (ok ? "all entries ok" : "FAILED") << "\n";
+    std::cout << "bytes sent " << interpreter.bytesSent() << ", checks " << interpreter.checksRun()
+              << ", delay " << interpreter.delayMs() << " ms\n";
+
+    std::vector<ScriptEntry> bad = {{"SEND", "x"}, {"SNED", "y"}};
+    std::string error;
+    if (!compileScript(ConcreteInterpreter::commandTable(), bad, &error)) {
+        std::cout << "typo caught at compile time: " << error << "\n";
+    }
+    std::cout << "\n";
+}
+
+//=============================================================================
+// Vectored I/O over pooled buffers: frames are built in place and a whole
+// batch goes out in one writev(); replies are scattered over several pooled
+// buffers by one readv(). The driver is passed by reference throughout.
+//=============================================================================
+struct FdDriver {
+    int fd;
+};
+
+using FdComm = VectoredComm<FdDriver, ICommDriver::WriteResult, ICommDriver::ReadResult, ICommDriver::ReadOptions>;
+
+static bool waitFd(int fd, short events, uint32_t timeout)
+{
+    pollfd pfd{fd, events, 0};
+    return ::poll(&pfd, 1, static_cast<int>(timeout)) == 1;
+}
+
+// writev()/readv() take at most kMaxIov spans per call here; longer lists
+// are worked through in chunks of that many
+constexpr size_t kMaxIov = 16;
+
+ICommDriver::WriteResult sendv(uint32_t timeout, FdComm::ConstBuffers buffers, const FdDriver& driver)
+{
+    std::array<iovec, kMaxIov> iov;
+    size_t written = 0;
+    for (size_t first = 0; first < buffers.size(); first += kMaxIov) {
+        const auto chunk = buffers.subspan(first, std::min(buffers.size() - first, kMaxIov));
+        size_t count = 0;
+        size_t total = 0;
+        for (auto buffer : chunk) {
+            iov[count++] = iovec{const_cast<uint8_t*>(buffer.data()), buffer.size()};
+            total += buffer.size();
+        }
+
+        size_t chunkWritten = 0;
+        iovec* next = iov.data();
+        while (chunkWritten < total) {
+            if (!waitFd(driver.fd, POLLOUT, timeout)) {
+                return ICommDriver::WriteResult{ICommDriver::Status::TIMEOUT, written + chunkWritten};
+            }
+            const ssize_t n = ::writev(driver.fd, next, static_cast<int>(count - (next - iov.data())));
+            if (n < 0) {
+                return ICommDriver::WriteResult{ICommDriver::Status::WRITE_ERROR, written + chunkWritten};
+            }
+            chunkWritten += static_cast<size_t>(n);
+            // Skip what was written; a partial write resumes mid-buffer
+            for (size_t left = static_cast<size_t>(n); left > 0;) {
+                const size_t step = std::min(left, next->iov_len);
+                next->iov_base = static_cast<uint8_t*>(next->iov_base) + step;
+                next->iov_len -= step;
+                left -= step;
+                if (next->iov_len == 0) {
+                    ++next;
+                }
+            }
+        }
+        written += chunkWritten;
+    }
+    return ICommDriver::WriteResult{ICommDriver::Status::SUCCESS, written};
+}
+
+// Like read(): returns what is available, waiting only for the first byte.
+// A chunk that comes back full moves on to the next one while more data is
+// already readable.
+ICommDriver::ReadResult recvv(uint32_t timeout, FdComm::MutableBuffers buffers,
+                              const ICommDriver::ReadOptions&, const FdDriver& driver)
+{
+    std::array<iovec, kMaxIov> iov;
+    size_t received = 0;
+    for (size_t first = 0; first < buffers.size(); first += kMaxIov) {
+        const auto chunk = buffers.subspan(first, std::min(buffers.size() - first, kMaxIov));
+        size_t count = 0;
+        size_t total = 0;
+        for (auto buffer : chunk) {
+            iov[count++] = iovec{buffer.data(), buffer.size()};
+            total += buffer.size();
+        }
+        if (!waitFd(driver.fd, POLLIN, first == 0 ? timeout : 0)) {
+            if (first == 0) {
+                return ICommDriver::ReadResult{ICommDriver::Status::TIMEOUT, 0, false};
+            }
+            break;
+        }
+        const ssize_t n = ::readv(driver.fd, iov.data(), static_cast<int>(count));
+        if (n < 0) {
+            return ICommDriver::ReadResult{ICommDriver::Status::READ_ERROR, received, false};
+        }
+        received += static_cast<size_t>(n);
+        if (static_cast<size_t>(n) < total) {
+            break;
+        }
+    }
+    return ICommDriver::ReadResult{ICommDriver::Status::SUCCESS, received, false};
+}
+
+void vectoredIoDemo()
+{
+    std::cout << "=== Vectored I/O over pooled buffers ===\n";
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        std::cout << "pipe() failed\n";
+        return;
+    }
+    const FdDriver writer{fds[1]};
+    const FdDriver reader{fds[0]};
+    FdComm::SendVFunc send = sendv;
+    FdComm::RecvVFunc recv = recvv;
+
+    BufferPool pool(8, 200);
+    std::cout << "pool: " << pool.count() << " x " << pool.bufferSize() << " bytes, block at "
+              << static_cast<const void*>(pool.region().data()) << "\n";
+
+    const std::array<std::string_view, 3> commands = {"AT+CGMI\r\n", "AT+CSQ\r\n", "AT+COPS?\r\n"};
+    const ICommDriver::ReadOptions options{};
+    size_t frameBytes = 0;
+    size_t frames = 0;
+
+    auto roundTrip = [&]() {
+        // One frame per buffer, payload written in place behind the header
+        std::array<PooledBuffer, 3> out;
+        std::array<std::span<const uint8_t>, 3> gather;
+        for (size_t i = 0; i < commands.size(); ++i) {
+            out[i] = pool.acquire();
+            FrameWriter frame(out[i]);
+            frame.append({reinterpret_cast<const uint8_t*>(commands[i].data()), commands[i].size()});
+            frame.finish();
+            gather[i] = out[i].data();
+        }
+        const auto sent = send(100, gather, writer);
+
+        // Scatter the reply over two buffers, then walk the frames
+        std::array<PooledBuffer, 2> in = {pool.acquire(), pool.acquire()};
+        const std::array<std::span<uint8_t>, 2> scatter = {in[0].tail().first(16), in[1].tail()};
+        size_t received = 0;
+        while (received < sent.bytes_written) {
+            std::array<std::span<uint8_t>, 2> rest = scatter;
+            size_t skip = received;
+            for (auto& part : rest) {
+                const size_t step = std::min(skip, part.size());
+                part = part.subspan(step);
+                skip -= step;
+            }
+            const auto got = recv(100, rest, options, reader);
+            if (got.status != ICommDriver::Status::SUCCESS) {
+                return false;
+            }
+            received += got.bytes_read;
+        }
+        in[0].commit(std::min<size_t>(received, 16));
+        in[1].commit(received - in[0].size());
+
+        // Frames may straddle the two buffers: read them through one index
+        auto byteAt = [&](size_t i) { return i < in[0].size() ? in[0].data()[i] : in[1].data()[i - in[0].size()]; };
+        for (size_t pos = 0; pos < received;) {
+            const size_t length = byteAt(pos + 1) | (static_cast<size_t>(byteAt(pos + 2)) << 8);
+            uint8_t sum = 0;
+            for (size_t i = 0; i < length; ++i) {
+                sum = static_cast<uint8_t>(sum + byteAt(pos + FrameWriter::kHeaderSize + i));
+            }
+            if (byteAt(pos) != FrameWriter::kStart || sum != byteAt(pos + FrameWriter::kHeaderSize + length)) {
+                return false;
+            }
+            pos += FrameWriter::kOverhead + length;
+            frameBytes += length;
+            ++frames;
+        }
+        return true;
+    };
+
+    bool ok = roundTrip();
+    std::cout << "first round trip: " << frames << " frames, " << frameBytes << " payload bytes, "
+              << (ok ? "checksums ok" : "FAILED") << "\n";
+
+    const size_t rounds = 20000;
+    const size_t before = g_allocations;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds && ok; ++r) {
+        ok = roundTrip();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    std::cout << rounds << " round trips of 3 frames: "
+              << std::chrono::duration<double, std::micro>(t1 - t0).count() / rounds << " us each, "
+              << g_allocations - before << " allocations, " << pool.available() << "/" << pool.count()
+              << " buffers back in the pool, " << (ok ? "ok" : "FAILED") << "\n\n";
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+//=============================================================================
+// Pipelined queries: a simulated device answers each request frame after a
+// fixed latency (+-50% jitter), working on many requests at once like a
+// modem with a command queue, so replies come back out of order.
+//=============================================================================
+void simulatedDevice(int fd, std::chrono::microseconds latency)
+{
+    using Clock = std::chrono::steady_clock;
+    struct Due {
+        Clock::time_point when;
+        std::vector<uint8_t> payload;       // tag + "OK " + request text
+        bool operator>(const Due& other) const { return when > other.when; }
+    };
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> due;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> jitter(0.5, 1.5);
+    BufferPool pool(1, 512);
+    std::vector<uint8_t> rx(64 * 1024);
+    size_t rxSize = 0;
+    bool open = true;
+
+    while (open || !due.empty()) {
+        // ppoll: poll()'s millisecond timeout would round every reply up
+        timespec wait{};
+        if (!due.empty()) {
+            const auto ns = std::max<int64_t>(0, std::chrono::nanoseconds(due.top().when - Clock::now()).count());
+            wait = timespec{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+        }
+        pollfd pfd{fd, static_cast<short>(open ? POLLIN : 0), 0};
+        if (::ppoll(&pfd, 1, due.empty() ? nullptr : &wait, nullptr) > 0 && (pfd.revents & (POLLIN | POLLHUP))) {
+            const ssize_t n = ::read(fd, rx.data() + rxSize, rx.size() - rxSize);
+            if (n <= 0) {
+                open = false;
+            } else {
+                rxSize += static_cast<size_t>(n);
+                size_t pos = 0;
+                while (rxSize - pos >= FrameWriter::kOverhead) {
+                    const size_t length = rx[pos + 1] | (static_cast<size_t>(rx[pos + 2]) << 8);
+                    if (rxSize - pos < FrameWriter::kOverhead + length) {
+                        break;
+                    }
+                    const uint8_t* body = rx.data() + pos + FrameWriter::kHeaderSize;
+                    Due reply{Clock::now() + std::chrono::duration_cast<std::chrono::microseconds>(latency * jitter(rng)), {}};
+                    reply.payload.assign(body, body + 2);
+                    reply.payload.insert(reply.payload.end(), {'O', 'K', ' '});
+                    reply.payload.insert(reply.payload.end(), body + 2, body + length);
+                    due.push(std::move(reply));
+                    pos += FrameWriter::kOverhead + length;
+                }
+                std::memmove(rx.data(), rx.data() + pos, rxSize - pos);
+                rxSize -= pos;
+            }
+        }
+        while (!due.empty() && due.top().when <= Clock::now()) {
+            PooledBuffer out = pool.acquire();
+            FrameWriter frame(out);
+            frame.append(due.top().payload);
+            frame.finish();
+            if (::write(fd, out.data().data(), out.size()) < 0) {
+                return;
+            }
+            due.pop();
+        }
+    }
+}
+
+void pipelinedQueryDemo(ConcreteInterpreter& interpreter)
+{
+    std::cout << "=== Pipelined queries over an async channel ===\n";
+    const auto latency = std::chrono::microseconds(500);
+    const size_t queries = 400;
+    std::vector<ScriptEntry> script;
+    for (size_t i = 0; i < queries; ++i) {
+        script.push_back({"QUERY", "AT+READ=" + std::to_string(i)});
+    }
+    auto compiled = compileScript(ConcreteInterpreter::commandTable(), script);
+
+    std::cout << queries << " independent queries, device latency " << latency.count() << " us\n";
+    for (size_t window : {1, 8, 64}) {
+        int fds[2];
+        if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            std::cout << "socketpair() failed\n";
+            return;
+        }
+        std::thread device(simulatedDevice, fds[1], latency);
+        size_t ok = 0;
+        double ms = 0;
+        {
+            EpollReactor reactor;
+            BufferPool pool(2 * window + 8, 256);
+            AsyncChannel channel(reactor, fds[0], pool);
+            auto t0 = std::chrono::steady_clock::now();
+            ok = interpreter.runPipelined(reactor, channel, *compiled, window);
+            ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        }
+        ::shutdown(fds[0], SHUT_WR);
+        device.join();
+        ::close(fds[0]);
+        ::close(fds[1]);
+        std::cout << "  " << window << " in flight: " << ms << " ms, " << ok << "/" << queries << " replies ok, "
+                  << static_cast<size_t>(queries / ms * 1000.0) << " queries/s\n";
+    }
+    std::cout << "\n";
+}
+
 //=============================================================================
 // Polymorphic usage demonstration
 //=============================================================================
@@ -196,6 +697,11 @@ int main()
     auto interpreter = createBasicInterpreter();
     interpreter->interpretScript(script);
     std::cout << "✓ Factory pattern works with Level 1 pointer\n";
+    std::cout << "\n";
+
+    compiledScriptBenchmark(*concrete);
+    vectoredIoDemo();
+    pipelinedQueryDemo(*concrete);
 
     return 0;
 }
@@ -0,0 +1,164 @@
+/**
+ * @file script_compiler.hpp
+ * @brief Compiles a script once into interned opcodes, then runs it through a flat jump table
+ *
+ * Interpreting a script entry by entry through executeCmd(const std::string&)
+ * costs a virtual call, a string compare chain and usually a temporary string
+ * per entry. For scripts with hundreds of thousands of entries that is most
+ * of the run time. Here the work is split in two:
+ *
+ *   compileScript()  once per script: every command name is looked up in the
+ *                    CommandTable, a perfect hash built at compile time
+ *                    (unknown names are reported with their entry index),
+ *                    all parameters are copied back to back into one
+ *                    std::string, and each entry becomes
+ *                    {opcode, offset, length}.
+ *   runScript()      per entry: handlers[opcode](context, parameters), where
+ *                    parameters is a string_view into that one buffer. No
+ *                    virtual call, no lookup, no allocation.
+ *
+ * Handlers are plain function pointers taking the context (usually the
+ * interpreter itself) by reference, so a command set is just a constexpr
+ * array of {name, handler} pairs.
+ */
+
+#pragma once
+
+#include "../perfect_hash.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//=============================================================================
+// CommandTable - name -> opcode, opcode -> handler
+//=============================================================================
+template<typename Context, size_t N>
+class CommandTable {
+public:
+    using Handler = bool (*)(Context& context, std::string_view params);
+
+    struct Command {
+        std::string_view name;
+        Handler handler;
+    };
+
+    static constexpr uint16_t kUnknown = 0xFFFF;
+
+    /**
+     * @param commands name/handler pairs; opcodes are their positions. Build
+     *                 the table as constexpr: a duplicate name is then a
+     *                 compile error.
+     */
+    constexpr explicit CommandTable(const std::array<Command, N>& commands)
+        : m_commands(commands), m_index(make_perfect_hash(names(commands))) {}
+
+    /// Opcode for name, or kUnknown: one hash, one compare
+    constexpr uint16_t find(std::string_view name) const {
+        const int index = m_index.find(name);
+        return index < 0 ? kUnknown : static_cast<uint16_t>(index);
+    }
+
+    Handler handler(uint16_t opcode) const { return m_commands[opcode].handler; }
+    constexpr std::string_view name(uint16_t opcode) const { return m_commands[opcode].name; }
+    constexpr const std::array<Command, N>& commands() const { return m_commands; }
+
+private:
+    static constexpr std::array<std::string_view, N> names(const std::array<Command, N>& commands) {
+        std::array<std::string_view, N> result{};
+        for (size_t i = 0; i < N; ++i) {
+            result[i] = commands[i].name;
+        }
+        return result;
+    }
+
+    std::array<Command, N> m_commands;
+    PerfectHashTable<N> m_index;
+};
+
+//=============================================================================
+// CompiledScript - opcodes plus one shared parameter buffer
+//=============================================================================
+class CompiledScript {
+public:
+    struct Entry {
+        uint16_t opcode;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    std::string_view params(const Entry& entry) const {
+        return std::string_view(m_text).substr(entry.offset, entry.length);
+    }
+
+    const std::vector<Entry>& entries() const { return m_entries; }
+    size_t size() const { return m_entries.size(); }
+
+    void reserve(size_t entries, size_t textSize) {
+        m_entries.reserve(entries);
+        m_text.reserve(textSize);
+    }
+
+    void append(uint16_t opcode, std::string_view params) {
+        m_entries.push_back({opcode, static_cast<uint32_t>(m_text.size()), static_cast<uint32_t>(params.size())});
+        m_text.append(params);
+    }
+
+private:
+    std::string m_text;
+    std::vector<Entry> m_entries;
+};
+
+/**
+ * @brief Compiles entries exposing .command and .parameters (strings or string_views)
+ * @param error receives "entry <i>: unknown command '<name>'" on failure, if not null
+ * @return the compiled script, or nullopt if a command is not in the table
+ */
+template<typename Context, size_t N, typename Script>
+std::optional<CompiledScript> compileScript(const CommandTable<Context, N>& table,
+                                            const Script& script, std::string* error = nullptr)
+{
+    CompiledScript compiled;
+    size_t textSize = 0;
+    size_t count = 0;
+    for (const auto& entry : script) {
+        textSize += std::string_view(entry.parameters).size();
+        ++count;
+    }
+    compiled.reserve(count, textSize);
+
+    size_t index = 0;
+    for (const auto& entry : script) {
+        const uint16_t opcode = table.find(entry.command);
+        if (opcode == CommandTable<Context, N>::kUnknown) {
+            if (error) {
+                *error = "entry " + std::to_string(index) + ": unknown command '" + std::string(entry.command) + "'";
+            }
+            return std::nullopt;
+        }
+        compiled.append(opcode, entry.parameters);
+        ++index;
+    }
+    return compiled;
+}
+
+/**
+ * @brief Runs a compiled script against context, stopping at the first handler that fails
+ * @return number of entries that succeeded (== script.size() on success)
+ */
+template<typename Context, size_t N>
+size_t runScript(const CommandTable<Context, N>& table, const CompiledScript& script, Context& context)
+{
+    size_t done = 0;
+    for (const auto& entry : script.entries()) {
+        if (!table.handler(entry.opcode)(context, script.params(entry))) {
+            break;
+        }
+        ++done;
+    }
+    return done;
+}
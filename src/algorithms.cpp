@@ -4,6 +4,10 @@
 #include <vector>
 #include <iostream>
 #include <string>
+#include <random>
+#include <cstdint>
+
+#include "radix_sort.hpp"
 
 // ============================================================================
 // SORTING ALGORITHMS
@@ -38,6 +42,30 @@ void sorting_examples() {
     
     // Parallel execution (C++17)
     std::sort(std::execution::par, v.begin(), v.end());
+
+    // radix_sort (radix_sort.hpp) - O(n * key bytes), no comparisons, stable.
+    // For integer and float keys; short inputs fall back to std::stable_sort
+    std::vector<float> f = {2.5f, -1.0f, 0.0f, -3.5f, 1.0f};
+    radix_sort(f);
+    // Result: {-3.5, -1.0, 0.0, 1.0, 2.5}
+
+    // Key + payload records, sorted by a projection onto the key
+    struct Order { uint32_t price; int id; };
+    std::vector<Order> orders(10000);
+    for (int i = 0; i < 10000; ++i) {
+        orders[i] = Order{static_cast<uint32_t>((i * 7919) % 100), i};
+    }
+    radix_sort(orders, &Order::price);
+    // Sorted by price; equal prices keep their id order
+
+    // Also below kRadixSortThreshold, where it hands off to std::stable_sort
+    orders.resize(100);
+    std::reverse(orders.begin(), orders.end());
+    radix_sort(orders, &Order::price);
+    // Sorted by price; equal prices in descending id order, as they came in
+
+    // With a ThreadPoolRAII the passes of a big sort are split across threads:
+    //   radix_sort(pool, orders, &Order::price);
 }
 
 // ============================================================================
@@ -0,0 +1,479 @@
+/*
+g++ -pthread --std=c++20 -O2 allocator_benchmarks.cpp -o app
+*/
+
+// Standard workloads against every allocator from allocators1.hpp and
+// allocators2.hpp, plus std::allocator and the std::pmr resources, so
+// allocators can be picked per container from data instead of folklore.
+//
+// Workloads:
+//   list churn      std::list push_back / erase / clear cycles
+//   map churn       random std::map insert / erase over a fixed key range
+//   vector growth   push_back from empty to 50000 ints, many times
+//   cross-thread    lists built on a producer thread, destroyed on a consumer
+//   bursty          requests holding a map of strings; 256 live at a time,
+//                   oldest destroyed as each new one arrives
+//
+// Per run: ns per container operation, peak RSS growth during the run, and
+// fragmentation = 1 - (peak live bytes requested / peak RSS growth), i.e.
+// the share of the memory the process grew by that held no live data.
+//
+// Every (allocator, workload) pair runs in its own forked child, so
+// singleton pools, arenas and the RSS high-water mark all start fresh. Not
+// thread-safe allocators skip the cross-thread workload ("-"). The logging
+// allocators run with stdout sent to /dev/null, so they still pay for
+// formatting and write calls, but not for a terminal.
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <list>
+#include <map>
+#include <string>
+#include <memory>
+#include <memory_resource>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "allocators1.hpp"
+#include "allocators2.hpp"
+
+// ===== Measurement =====
+
+// Live bytes requested through Measured<>, the same small overhead for
+// every backend
+struct LiveBytes {
+    static inline std::atomic<long long> live{0};
+    static inline std::atomic<long long> peak{0};
+
+    static void add(long long bytes) {
+        const long long now = live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        long long p = peak.load(std::memory_order_relaxed);
+        while (now > p && !peak.compare_exchange_weak(p, now, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void sub(long long bytes) { live.fetch_sub(bytes, std::memory_order_relaxed); }
+};
+
+template<typename Base>
+struct Measured : Base {
+    using value_type = typename Base::value_type;
+
+    template<typename U>
+    struct rebind {
+        using other = Measured<typename std::allocator_traits<Base>::template rebind_alloc<U>>;
+    };
+
+    Measured() = default;
+
+    template<typename Other>
+    Measured(const Measured<Other>& other) : Base(static_cast<const Other&>(other)) {}
+
+    value_type* allocate(std::size_t n) {
+        LiveBytes::add(static_cast<long long>(n * sizeof(value_type)));
+        return Base::allocate(n);
+    }
+
+    void deallocate(value_type* p, std::size_t n) {
+        LiveBytes::sub(static_cast<long long>(n * sizeof(value_type)));
+        Base::deallocate(p, n);
+    }
+
+    friend bool operator==(const Measured& a, const Measured& b) {
+        return static_cast<const Base&>(a) == static_cast<const Base&>(b);
+    }
+};
+
+// kB value of a /proc/self/status field such as "VmHWM:"
+long status_kb(const char* field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    const std::string key = field;
+    while (std::getline(status, line)) {
+        if (line.rfind(key, 0) == 0) {
+            return std::stol(line.substr(key.size()));
+        }
+    }
+    return -1;
+}
+
+// Lets VmHWM restart from the current RSS (Linux 4.0+)
+void reset_peak_rss() {
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+// ===== Backends =====
+
+// ArenaAllocator needs an arena; containers default-construct allocators,
+// so this one uses a per-process arena
+inline Arena* g_arena = nullptr;
+
+template<typename T>
+struct GlobalArenaAllocator : ArenaAllocator<T> {
+    GlobalArenaAllocator() noexcept : ArenaAllocator<T>(*g_arena) {}
+
+    template<typename U>
+    GlobalArenaAllocator(const GlobalArenaAllocator<U>& other) noexcept : ArenaAllocator<T>(other) {}
+};
+
+// pmr backends install their resource as the default one, which is what a
+// default-constructed polymorphic_allocator uses
+template<typename Resource>
+struct PmrSetup {
+    static inline Resource* resource = nullptr;
+
+    static void setup() {
+        resource = new Resource();
+        std::pmr::set_default_resource(resource);
+    }
+};
+
+struct NoSetup {
+    static void setup() {}
+};
+
+struct StdBackend : NoSetup {
+    template<typename T> using Alloc = std::allocator<T>;
+    static constexpr const char* name = "std::allocator";
+    static constexpr bool thread_safe = true;
+};
+
+struct PmrPoolBackend : PmrSetup<std::pmr::unsynchronized_pool_resource> {
+    template<typename T> using Alloc = std::pmr::polymorphic_allocator<T>;
+    static constexpr const char* name = "pmr unsync pool";
+    static constexpr bool thread_safe = false;
+};
+
+struct PmrSyncPoolBackend : PmrSetup<std::pmr::synchronized_pool_resource> {
+    template<typename T> using Alloc = std::pmr::polymorphic_allocator<T>;
+    static constexpr const char* name = "pmr sync pool";
+    static constexpr bool thread_safe = true;
+};
+
+struct PmrMonotonicBackend : PmrSetup<std::pmr::monotonic_buffer_resource> {
+    template<typename T> using Alloc = std::pmr::polymorphic_allocator<T>;
+    static constexpr const char* name = "pmr monotonic";
+    static constexpr bool thread_safe = false;
+};
+
+struct TrackingBackend : NoSetup {
+    template<typename T> using Alloc = TrackingAllocator<T>;
+    static constexpr const char* name = "TrackingAllocator";
+    static constexpr bool thread_safe = false;   // plain static counters
+};
+
+struct PoolBackend : NoSetup {
+    template<typename T> using Alloc = PoolAllocator<T>;
+    static constexpr const char* name = "PoolAllocator";
+    static constexpr bool thread_safe = false;
+};
+
+struct ArenaBackend {
+    template<typename T> using Alloc = GlobalArenaAllocator<T>;
+    static constexpr const char* name = "ArenaAllocator";
+    static constexpr bool thread_safe = false;
+    static void setup() { g_arena = new Arena(1 << 20); }
+};
+
+struct AlignedBackend : NoSetup {
+    template<typename T> using Alloc = AlignedAllocator<T, 64>;
+    static constexpr const char* name = "AlignedAllocator<64>";
+    static constexpr bool thread_safe = true;
+};
+
+struct MagazineBackend : NoSetup {
+    template<typename T> using Alloc = ThreadSafePoolAllocator<T>;
+    static constexpr const char* name = "ThreadSafePool";
+    static constexpr bool thread_safe = true;
+};
+
+struct DetailedBackend : NoSetup {
+    template<typename T> using Alloc = DetailedTrackingAllocator<T>;
+    static constexpr const char* name = "DetailedTracking";
+    static constexpr bool thread_safe = true;
+};
+
+struct SamplingBackend : NoSetup {
+    template<typename T> using Alloc = SamplingTrackingAllocator<T>;
+    static constexpr const char* name = "SamplingTracking";
+    static constexpr bool thread_safe = true;
+};
+
+// ===== Workloads =====
+// Each returns the number of container operations it performed
+
+template<typename B, typename T>
+using AllocOf = Measured<typename B::template Alloc<T>>;
+
+template<typename B>
+long long list_churn() {
+    long long ops = 0;
+    std::list<int, AllocOf<B, int>> list;
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 20000; ++i) {
+            list.push_back(i);
+        }
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            it = list.erase(it);   // every other element
+            if (it == list.end()) break;
+        }
+        for (int i = 0; i < 10000; ++i) {
+            list.push_front(i);
+        }
+        ops += 20000 + 10000 + 10000 + static_cast<long long>(list.size());
+        list.clear();
+    }
+    return ops;
+}
+
+template<typename B>
+long long map_churn() {
+    using Pair = std::pair<const int, int>;
+    std::map<int, int, std::less<int>, AllocOf<B, Pair>> map;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> key(0, 199999);
+    const long long ops = 300000;
+    for (long long i = 0; i < ops; ++i) {
+        const int k = key(rng);
+        if (i % 2 == 0) {
+            map.emplace(k, k);
+        } else {
+            map.erase(k);
+        }
+    }
+    return ops;
+}
+
+template<typename B>
+long long vector_growth() {
+    long long ops = 0;
+    for (int round = 0; round < 100; ++round) {
+        std::vector<int, AllocOf<B, int>> vec;
+        for (int i = 0; i < 50000; ++i) {
+            vec.push_back(i);
+        }
+        ops += static_cast<long long>(vec.size());
+    }
+    return ops;
+}
+
+template<typename B>
+long long cross_thread() {
+    using List = std::list<int, AllocOf<B, int>>;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<List> queue;
+    bool done = false;
+    const int lists = 200;
+    const int nodes = 1000;
+
+    std::thread consumer([&] {
+        for (;;) {
+            List list;
+            {
+                std::unique_lock lock(mtx);
+                cv.wait(lock, [&] { return !queue.empty() || done; });
+                if (queue.empty()) {
+                    return;
+                }
+                list = std::move(queue.front());
+                queue.pop_front();
+            }
+            // list and its nodes are freed here, on the consumer
+        }
+    });
+    for (int l = 0; l < lists; ++l) {
+        List list;
+        for (int i = 0; i < nodes; ++i) {
+            list.push_back(i);
+        }
+        {
+            std::lock_guard lock(mtx);
+            queue.push_back(std::move(list));
+        }
+        cv.notify_one();
+    }
+    {
+        std::lock_guard lock(mtx);
+        done = true;
+    }
+    cv.notify_one();
+    consumer.join();
+    return 2LL * lists * nodes;   // one allocation and one free per node
+}
+
+template<typename B>
+long long bursty() {
+    using String = std::basic_string<char, std::char_traits<char>, AllocOf<B, char>>;
+    using Pair = std::pair<const int, String>;
+    using Request = std::map<int, String, std::less<int>, AllocOf<B, Pair>>;
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> entries(5, 50);
+    std::uniform_int_distribution<int> length(20, 200);
+    std::deque<Request> live;
+    long long ops = 0;
+    for (int r = 0; r < 20000; ++r) {
+        Request request;
+        const int n = entries(rng);
+        for (int i = 0; i < n; ++i) {
+            request.emplace(i, String(static_cast<size_t>(length(rng)), 'x'));
+        }
+        ops += n;
+        live.push_back(std::move(request));
+        if (live.size() > 256) {
+            live.pop_front();
+        }
+    }
+    return ops;
+}
+
+// ===== Runner =====
+
+struct Result {
+    bool ran = false;
+    double ns_per_op = 0.0;
+    double peak_rss_mib = 0.0;
+    double fragmentation = 0.0;
+};
+
+// Runs one workload in a forked child and collects its Result through a pipe
+Result run_isolated(const std::function<long long()>& setup_and_run) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return {};
+    }
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        // The logging allocators keep formatting and writing, to /dev/null
+        const int devnull = open("/dev/null", O_WRONLY);
+        if (devnull >= 0) {
+            dup2(devnull, STDOUT_FILENO);
+            close(devnull);
+        }
+
+        reset_peak_rss();
+        const long rss_start = status_kb("VmRSS:");
+        auto t0 = std::chrono::steady_clock::now();
+        const long long ops = setup_and_run();
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+        const long growth_kb = status_kb("VmHWM:") - rss_start;
+
+        Result r;
+        r.ran = true;
+        r.ns_per_op = ns / static_cast<double>(ops);
+        r.peak_rss_mib = growth_kb / 1024.0;
+        const double live_kb = static_cast<double>(LiveBytes::peak.load()) / 1024.0;
+        r.fragmentation = growth_kb > 0 ? std::max(0.0, 1.0 - live_kb / static_cast<double>(growth_kb)) : 0.0;
+        [[maybe_unused]] auto written = write(fds[1], &r, sizeof(r));
+        close(fds[1]);
+        _exit(0);
+    }
+    close(fds[1]);
+    Result r;
+    if (read(fds[0], &r, sizeof(r)) != sizeof(r)) {
+        r = Result{};
+    }
+    close(fds[0]);
+    waitpid(pid, nullptr, 0);
+    return r;
+}
+
+struct Workload {
+    const char* name;
+    bool needs_thread_safety;
+};
+
+const Workload kWorkloads[] = {
+    {"list churn", false},
+    {"map churn", false},
+    {"vector growth", false},
+    {"cross-thread", true},
+    {"bursty", false},
+};
+
+template<typename B>
+std::vector<Result> run_backend() {
+    std::vector<Result> results;
+    for (size_t w = 0; w < std::size(kWorkloads); ++w) {
+        if (kWorkloads[w].needs_thread_safety && !B::thread_safe) {
+            results.push_back(Result{});
+            continue;
+        }
+        results.push_back(run_isolated([w]() -> long long {
+            B::setup();
+            switch (w) {
+                case 0: return list_churn<B>();
+                case 1: return map_churn<B>();
+                case 2: return vector_growth<B>();
+                case 3: return cross_thread<B>();
+                default: return bursty<B>();
+            }
+        }));
+    }
+    return results;
+}
+
+int main() {
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n";
+
+    std::vector<std::pair<const char*, std::vector<Result>>> table;
+    auto add = [&]<typename B>(B) {
+        std::cout << "running " << B::name << "...\n" << std::flush;
+        table.emplace_back(B::name, run_backend<B>());
+    };
+    add(StdBackend{});
+    add(PmrPoolBackend{});
+    add(PmrSyncPoolBackend{});
+    add(PmrMonotonicBackend{});
+    add(TrackingBackend{});
+    add(PoolBackend{});
+    add(ArenaBackend{});
+    add(AlignedBackend{});
+    add(MagazineBackend{});
+    add(DetailedBackend{});
+    add(SamplingBackend{});
+
+    for (size_t w = 0; w < std::size(kWorkloads); ++w) {
+        std::cout << "\n=== " << kWorkloads[w].name << " ===\n";
+        std::cout << std::left << std::setw(22) << "allocator" << std::right
+                  << std::setw(10) << "ns/op" << std::setw(14) << "peak RSS MiB"
+                  << std::setw(8) << "frag" << "\n";
+        const char* fastest = nullptr;
+        double best = 0.0;
+        for (const auto& [name, results] : table) {
+            const Result& r = results[w];
+            std::cout << std::left << std::setw(22) << name << std::right;
+            if (!r.ran) {
+                std::cout << std::setw(10) << "-" << std::setw(14) << "-" << std::setw(8) << "-" << "\n";
+                continue;
+            }
+            std::cout << std::fixed << std::setprecision(1)
+                      << std::setw(10) << r.ns_per_op
+                      << std::setw(14) << r.peak_rss_mib
+                      << std::setw(7) << std::setprecision(0) << 100.0 * r.fragmentation << "%\n";
+            if (!fastest || r.ns_per_op < best) {
+                fastest = name;
+                best = r.ns_per_op;
+            }
+        }
+        if (fastest) {
+            std::cout << "fastest: " << fastest << "\n";
+        }
+    }
+    return 0;
+}
@@ -2,256 +2,13 @@
 #include <vector>
 #include <list>
 #include <memory>
-#include <cstdlib>
-#include <limits>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory_resource>
 
-// =============================================================================
-// Example 1: Simple Tracking Allocator
-// Tracks the number of allocations and deallocations
-// =============================================================================
-
-template<typename T>
-class TrackingAllocator {
-public:
-    using value_type = T;
-
-    // Static counters to track allocations
-    static inline size_t allocation_count = 0;
-    static inline size_t deallocation_count = 0;
-    static inline size_t bytes_allocated = 0;
-
-    TrackingAllocator() noexcept = default;
-
-    // Required for rebinding to different types
-    template<typename U>
-    TrackingAllocator(const TrackingAllocator<U>&) noexcept {}
-
-    T* allocate(std::size_t n) {
-        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
-            throw std::bad_alloc();
-        }
-
-        void* p = std::malloc(n * sizeof(T));
-        if (!p) {
-            throw std::bad_alloc();
-        }
-
-        allocation_count++;
-        bytes_allocated += n * sizeof(T);
-
-        std::cout << "[TrackingAllocator] Allocated " << n * sizeof(T)
-                  << " bytes at " << p << std::endl;
-
-        return static_cast<T*>(p);
-    }
-
-    void deallocate(T* p, std::size_t n) noexcept {
-        deallocation_count++;
-        bytes_allocated -= n * sizeof(T);
-
-        std::cout << "[TrackingAllocator] Deallocated " << n * sizeof(T)
-                  << " bytes at " << p << std::endl;
-
-        std::free(p);
-    }
-
-    static void print_stats() {
-        std::cout << "\n=== Allocation Statistics ===" << std::endl;
-        std::cout << "Total allocations: " << allocation_count << std::endl;
-        std::cout << "Total deallocations: " << deallocation_count << std::endl;
-        std::cout << "Currently allocated: " << bytes_allocated << " bytes" << std::endl;
-        std::cout << "Leaked allocations: " << (allocation_count - deallocation_count) << std::endl;
-    }
-};
-
-// Allocators must define equality operators
-template<typename T, typename U>
-bool operator==(const TrackingAllocator<T>&, const TrackingAllocator<U>&) {
-    return true;
-}
-
-template<typename T, typename U>
-bool operator!=(const TrackingAllocator<T>&, const TrackingAllocator<U>&) {
-    return false;
-}
-
-// =============================================================================
-// Example 2: Memory Pool Allocator
-// Pre-allocates a pool of memory and reuses it
-// =============================================================================
-
-template<typename T, size_t PoolSize = 1024>
-class PoolAllocator {
-private:
-    // Simple free list node
-    struct FreeNode {
-        FreeNode* next;
-    };
-
-    // Pool storage
-    alignas(T) char pool[PoolSize * sizeof(T)];
-    FreeNode* free_list;
-    size_t allocated_count;
-
-public:
-    using value_type = T;
-
-    PoolAllocator() noexcept : free_list(nullptr), allocated_count(0) {
-        // Initialize free list
-        for (size_t i = 0; i < PoolSize; ++i) {
-            FreeNode* node = reinterpret_cast<FreeNode*>(pool + i * sizeof(T));
-            node->next = free_list;
-            free_list = node;
-        }
-        std::cout << "[PoolAllocator] Initialized pool with "
-                  << PoolSize << " slots" << std::endl;
-    }
-
-    template<typename U>
-    PoolAllocator(const PoolAllocator<U, PoolSize>&) noexcept
-        : PoolAllocator() {}
-
-    T* allocate(std::size_t n) {
-        if (n != 1) {
-            // Pool allocator only handles single object allocations efficiently
-            throw std::bad_alloc();
-        }
-
-        if (!free_list) {
-            std::cout << "[PoolAllocator] Pool exhausted! Falling back to malloc"
-                      << std::endl;
-            return static_cast<T*>(std::malloc(sizeof(T)));
-        }
-
-        FreeNode* node = free_list;
-        free_list = node->next;
-        allocated_count++;
-
-        std::cout << "[PoolAllocator] Allocated from pool (slot "
-                  << allocated_count << ")" << std::endl;
-
-        return reinterpret_cast<T*>(node);
-    }
-
-    void deallocate(T* p, std::size_t n) noexcept {
-        if (n != 1) return;
-
-        // Check if pointer is within our pool
-        char* ptr = reinterpret_cast<char*>(p);
-        if (ptr >= pool && ptr < pool + PoolSize * sizeof(T)) {
-            FreeNode* node = reinterpret_cast<FreeNode*>(p);
-            node->next = free_list;
-            free_list = node;
-            allocated_count--;
-            std::cout << "[PoolAllocator] Returned to pool" << std::endl;
-        } else {
-            std::cout << "[PoolAllocator] Freeing non-pool memory" << std::endl;
-            std::free(p);
-        }
-    }
-
-    size_t available() const {
-        size_t count = 0;
-        FreeNode* node = free_list;
-        while (node) {
-            count++;
-            node = node->next;
-        }
-        return count;
-    }
-};
-
-template<typename T, size_t PoolSize, typename U>
-bool operator==(const PoolAllocator<T, PoolSize>&, const PoolAllocator<U, PoolSize>&) {
-    return false; // Different pool instances cannot share memory
-}
-
-template<typename T, size_t PoolSize, typename U>
-bool operator!=(const PoolAllocator<T, PoolSize>&, const PoolAllocator<U, PoolSize>&) {
-    return true;
-}
-
-// =============================================================================
-// Example 3: Arena/Stack Allocator
-// Allocates from a fixed buffer, deallocates all at once
-// =============================================================================
-
-template<typename T>
-class ArenaAllocator {
-private:
-    struct Arena {
-        char* buffer;
-        size_t size;
-        size_t offset;
-
-        Arena(size_t sz) : size(sz), offset(0) {
-            buffer = static_cast<char*>(std::malloc(sz));
-            if (!buffer) throw std::bad_alloc();
-            std::cout << "[Arena] Created arena of " << sz << " bytes" << std::endl;
-        }
-
-        ~Arena() {
-            std::free(buffer);
-            std::cout << "[Arena] Destroyed arena" << std::endl;
-        }
-
-        void reset() {
-            offset = 0;
-            std::cout << "[Arena] Reset arena" << std::endl;
-        }
-    };
-
-    std::shared_ptr<Arena> arena;
-
-public:
-    using value_type = T;
-
-    explicit ArenaAllocator(size_t arena_size = 1024 * 1024) // 1MB default
-        : arena(std::make_shared<Arena>(arena_size)) {}
-
-    template<typename U>
-    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
-        : arena(other.arena) {}
-
-    T* allocate(std::size_t n) {
-        size_t bytes = n * sizeof(T);
-        size_t aligned_size = (bytes + alignof(T) - 1) & ~(alignof(T) - 1);
-
-        if (arena->offset + aligned_size > arena->size) {
-            std::cout << "[Arena] Out of space!" << std::endl;
-            throw std::bad_alloc();
-        }
-
-        void* p = arena->buffer + arena->offset;
-        arena->offset += aligned_size;
-
-        std::cout << "[Arena] Allocated " << bytes << " bytes (offset: "
-                  << arena->offset << "/" << arena->size << ")" << std::endl;
-
-        return static_cast<T*>(p);
-    }
-
-    void deallocate(T*, std::size_t) noexcept {
-        // Arena allocator doesn't deallocate individual allocations
-        // Memory is freed when arena is destroyed or reset
-    }
-
-    void reset() {
-        arena->reset();
-    }
-
-    template<typename U> friend class ArenaAllocator;
-};
-
-template<typename T, typename U>
-bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
-    return a.arena == b.arena;
-}
-
-template<typename T, typename U>
-bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
-    return !(a == b);
-}
+#include "allocators1.hpp"
 
 // =============================================================================
 // Usage Examples
@@ -281,30 +38,67 @@ void example_pool_allocator() {
     std::cout << "Example 2: Pool Allocator" << std::endl;
     std::cout << "========================================\n" << std::endl;
 
-    // Note: Pool allocator works best with lists since they allocate one node at a time
-    using IntList = std::list<int, PoolAllocator<int, 10>>;
+    // A small logging pool: 4 slots per slab, so it has to grow
+    using LoudPool = SizeClassPool<4, LoggingPoolPolicy>;
+    LoudPool loud_pool;
+    using IntList = std::list<int, PoolAllocator<int, 4, LoggingPoolPolicy>>;
 
-    IntList list;
+    {
+        IntList list{PoolAllocator<int, 4, LoggingPoolPolicy>(loud_pool)};
 
-    std::cout << "\nAdding 5 elements:" << std::endl;
-    for (int i = 0; i < 5; ++i) {
-        list.push_back(i * 10);
-    }
+        std::cout << "\nAdding 5 elements:" << std::endl;
+        for (int i = 0; i < 5; ++i) {
+            list.push_back(i * 10);
+        }
+
+        std::cout << "\nRemoving 2 elements:" << std::endl;
+        list.pop_front();
+        list.pop_front();
 
-    std::cout << "\nRemoving 2 elements:" << std::endl;
-    list.pop_front();
-    list.pop_front();
+        std::cout << "\nAdding 3 more elements:" << std::endl;
+        for (int i = 0; i < 3; ++i) {
+            list.push_back(i * 100);
+        }
 
-    std::cout << "\nAdding 3 more elements:" << std::endl;
-    for (int i = 0; i < 3; ++i) {
-        list.push_back(i * 100);
+        std::cout << "\nList contents: ";
+        for (int val : list) {
+            std::cout << val << " ";
+        }
+        std::cout << std::endl;
+        std::cout << "Slabs: " << loud_pool.slab_count()
+                  << ", free node slots: " << loud_pool.free_slots(sizeof(int) + 2 * sizeof(void*))
+                  << std::endl;
     }
 
-    std::cout << "\nList contents: ";
-    for (int val : list) {
-        std::cout << val << " ";
+    // Size classes let vector and string share a (silent) pool too
+    SizeClassPool<> pool;
+    {
+        std::vector<int, PoolAllocator<int>> vec{PoolAllocator<int>(pool)};
+        for (int i = 0; i < 100; ++i) {
+            vec.push_back(i);   // 100 ints = 400 bytes, still a pooled class
+        }
+        using PoolString = std::basic_string<char, std::char_traits<char>, PoolAllocator<char>>;
+        PoolString str("a string too long for the small-string buffer", PoolAllocator<char>(pool));
+        std::cout << "\nvector of " << vec.size() << " ints and a " << str.size()
+                  << "-char string from " << pool.slab_count() << " slabs" << std::endl;
     }
-    std::cout << std::endl;
+
+    // Node churn: silent pool vs std::allocator
+    auto churn = [](auto list) {
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < 200; ++round) {
+            for (int i = 0; i < 5000; ++i) {
+                list.push_back(i);
+            }
+            list.clear();
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+               (200.0 * 5000.0);
+    };
+    const double std_ns = churn(std::list<int>());
+    const double pool_ns = churn(std::list<int, PoolAllocator<int>>(PoolAllocator<int>(pool)));
+    std::cout << "\nlist push_back + clear: std::allocator " << std_ns << " ns/node, PoolAllocator "
+              << pool_ns << " ns/node" << std::endl;
 }
 
 void example_arena_allocator() {
@@ -312,30 +106,98 @@ void example_arena_allocator() {
     std::cout << "Example 3: Arena Allocator" << std::endl;
     std::cout << "========================================\n" << std::endl;
 
-    ArenaAllocator<int> arena_alloc(1024); // 1KB arena
+    Arena arena(1024); // 1KB first block; grows when full
+    ArenaAllocator<int> arena_alloc(arena);
 
     {
         std::vector<int, ArenaAllocator<int>> vec(arena_alloc);
-        vec.reserve(50);
-
-        for (int i = 0; i < 50; ++i) {
-            vec.push_back(i);
+        for (int i = 0; i < 500; ++i) {
+            vec.push_back(i);   // outgrows the first block
         }
 
-        std::cout << "\nVector sum: ";
         int sum = 0;
         for (int val : vec) {
             sum += val;
         }
-        std::cout << sum << std::endl;
+        std::cout << "Vector sum: " << sum << ", arena used " << arena.bytes_used()
+                  << " of " << arena.bytes_reserved() << " bytes in "
+                  << arena.block_count() << " blocks" << std::endl;
     }
 
-    std::cout << "\nResetting arena..." << std::endl;
-    arena_alloc.reset();
+    // Regression: a 1000-byte block is not a multiple of 16, so aligning the
+    // bump pointer of a nearly full block lands past its end. The request
+    // must go to a new block instead of being handed memory past the first
+    {
+        Arena odd(1000);
+        odd.allocate(993, 1);
+        char* q = static_cast<char*>(odd.allocate(1, 16));
+        *q = 1;
+        std::cout << "16-aligned byte after 993 of 1000 bytes: "
+                  << (reinterpret_cast<uintptr_t>(q) % 16 == 0 && odd.block_count() == 2 ? "new block, aligned"
+                                                                                          : "WRONG")
+                  << std::endl;
+    }
 
-    std::cout << "\nAllocating after reset:" << std::endl;
-    std::vector<double, ArenaAllocator<double>> vec2(arena_alloc);
-    vec2.reserve(20);
+    std::cout << "\nResetting arena..." << std::endl;
+    arena.reset();
+    std::cout << "Used after reset: " << arena.bytes_used() << " bytes, blocks kept: "
+              << arena.block_count() << std::endl;
+
+    // The same arena through std::pmr
+    ArenaResource resource(arena);
+    std::pmr::vector<std::pmr::string> words(&resource);
+    for (const char* w : {"arena", "backed", "strings", "long enough to leave the SSO buffer"}) {
+        words.emplace_back(w);
+    }
+    std::cout << "\npmr::vector of " << words.size() << " pmr::strings, last: \""
+              << words.back() << "\", arena used " << arena.bytes_used() << " bytes" << std::endl;
+
+    // Per-request scratch memory: everything a request allocates is dropped
+    // in O(1) when its scope ends, and the blocks are reused next time
+    const size_t before = arena.bytes_used();
+    for (int request = 0; request < 1000; ++request) {
+        ArenaScope scope(arena);
+        std::pmr::vector<int> scratch(&resource);
+        for (int i = 0; i < 200 + request % 50; ++i) {
+            scratch.push_back(i);
+        }
+    }
+    std::cout << "\n1000 requests with scoped scratch vectors: used " << arena.bytes_used()
+              << " bytes (was " << before << "), reserved " << arena.bytes_reserved()
+              << " bytes in " << arena.block_count() << " blocks" << std::endl;
+
+    words.clear();
+
+    // Scratch pattern: arena + ArenaScope vs new/delete
+    auto time_ns = [](auto&& per_request) {
+        const int requests = 20000;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < requests; ++r) {
+            per_request();
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+               requests;
+    };
+    auto work = [](auto& map) {
+        for (int i = 0; i < 64; ++i) {
+            map.emplace(i * 7919 % 1000, i);
+        }
+        return map.size();
+    };
+    size_t sink = 0;
+    const double heap_ns = time_ns([&] {
+        std::map<int, int> map;
+        sink += work(map);
+    });
+    Arena scratch_arena(64 * 1024);
+    ArenaResource scratch_resource(scratch_arena);
+    const double arena_ns = time_ns([&] {
+        ArenaScope scope(scratch_arena);
+        std::pmr::map<int, int> map(&scratch_resource);
+        sink += work(map);
+    });
+    std::cout << "\nPer request (64 map inserts): new/delete " << heap_ns << " ns, arena scope "
+              << arena_ns << " ns (checksum " << sink << ")" << std::endl;
 }
 
 int main() {
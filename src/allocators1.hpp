@@ -0,0 +1,539 @@
+/*
+Allocators from the first half of the allocator examples (header-only, just
+#include it): TrackingAllocator, PoolAllocator and ArenaAllocator.
+Used by allocators1.cpp (examples) and allocator_benchmarks.cpp.
+*/
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <cstdlib>
+#include <limits>
+#include <bit>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <memory_resource>
+
+#include "25_Chrono/trace.hpp"
+
+// =============================================================================
+// Example 1: Simple Tracking Allocator
+// Tracks the number of allocations and deallocations
+// =============================================================================
+
+template<typename T>
+class TrackingAllocator {
+public:
+    using value_type = T;
+
+    // Static counters to track allocations
+    static inline size_t allocation_count = 0;
+    static inline size_t deallocation_count = 0;
+    static inline size_t bytes_allocated = 0;
+
+    TrackingAllocator() noexcept = default;
+
+    // Required for rebinding to different types
+    template<typename U>
+    TrackingAllocator(const TrackingAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+
+        void* p = std::malloc(n * sizeof(T));
+        if (!p) {
+            throw std::bad_alloc();
+        }
+
+        allocation_count++;
+        bytes_allocated += n * sizeof(T);
+
+        std::cout << "[TrackingAllocator] Allocated " << n * sizeof(T)
+                  << " bytes at " << p << std::endl;
+
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        deallocation_count++;
+        bytes_allocated -= n * sizeof(T);
+
+        std::cout << "[TrackingAllocator] Deallocated " << n * sizeof(T)
+                  << " bytes at " << p << std::endl;
+
+        std::free(p);
+    }
+
+    static void print_stats() {
+        std::cout << "\n=== Allocation Statistics ===" << std::endl;
+        std::cout << "Total allocations: " << allocation_count << std::endl;
+        std::cout << "Total deallocations: " << deallocation_count << std::endl;
+        std::cout << "Currently allocated: " << bytes_allocated << " bytes" << std::endl;
+        std::cout << "Leaked allocations: " << (allocation_count - deallocation_count) << std::endl;
+    }
+};
+
+// Allocators must define equality operators
+template<typename T, typename U>
+bool operator==(const TrackingAllocator<T>&, const TrackingAllocator<U>&) {
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const TrackingAllocator<T>&, const TrackingAllocator<U>&) {
+    return false;
+}
+
+// =============================================================================
+// Example 2: Memory Pool Allocator
+// Pre-allocates slabs of fixed-size slots and reuses them
+// =============================================================================
+
+// Logging is a policy mixed in as an empty base class - the EBO trick from
+// PolicyContainer in small_obj_opt.cpp. The default policy's hooks are empty
+// inline functions, so a silent pool compiles to the same code as a pool
+// with no logging at all, and takes no extra space.
+struct SilentPoolPolicy {
+    void on_allocate(size_t, const void*) const {}
+    void on_deallocate(size_t, const void*) const {}
+    void on_grow(size_t, size_t) const {}
+};
+
+struct LoggingPoolPolicy {
+    void on_allocate(size_t bytes, const void* p) const {
+        std::cout << "[PoolAllocator] Allocated " << bytes << " bytes at " << p << std::endl;
+    }
+
+    void on_deallocate(size_t bytes, const void* p) const {
+        std::cout << "[PoolAllocator] Returned " << bytes << " bytes at " << p << std::endl;
+    }
+
+    void on_grow(size_t slot_bytes, size_t slots) const {
+        std::cout << "[PoolAllocator] New slab: " << slots << " slots of "
+                  << slot_bytes << " bytes" << std::endl;
+    }
+};
+
+// Allocator calls as instant events on the trace timeline (25_Chrono/trace.hpp);
+// compiles to SilentPoolPolicy unless built with -DTRACE_ENABLED=1
+struct TracingPoolPolicy {
+    void on_allocate(size_t, const void*) const { TRACE_INSTANT("pool allocate", "alloc"); }
+    void on_deallocate(size_t, const void*) const { TRACE_INSTANT("pool deallocate", "alloc"); }
+    void on_grow(size_t, size_t) const { TRACE_INSTANT("pool new slab", "alloc"); }
+};
+
+// The memory behind PoolAllocator. One bucket per size class (16, 32, ...,
+// 512 bytes), so list nodes, map nodes and the small buffers of vector and
+// string all come from the same pool.
+//
+// A bucket serves a request from its free list first, then from the unused
+// tail of its newest slab. When both are empty it chains on a new slab of
+// SlotsPerSlab slots - the pool grows instead of falling back to malloc.
+// Slabs are only released when the pool is destroyed. Requests bigger than
+// the largest class or over-aligned ones go straight to operator new.
+//
+// Not thread-safe: see ThreadSafePoolAllocator in allocators2.cpp.
+template<size_t SlotsPerSlab = 1024, typename Policy = SilentPoolPolicy>
+class SizeClassPool : private Policy {
+public:
+    static constexpr size_t kMinSlot = 16;
+    static constexpr size_t kClassCount = 6;
+    static constexpr size_t kMaxSlot = kMinSlot << (kClassCount - 1);
+
+    static_assert(SlotsPerSlab > 0, "a slab needs at least one slot");
+
+    SizeClassPool() noexcept = default;
+    SizeClassPool(const SizeClassPool&) = delete;
+    SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+    ~SizeClassPool() {
+        for (Bucket& bucket : buckets) {
+            while (bucket.slabs) {
+                Slab* next = bucket.slabs->next;
+                ::operator delete(bucket.slabs);
+                bucket.slabs = next;
+            }
+        }
+    }
+
+    // Pool used by default-constructed PoolAllocators with these parameters
+    static SizeClassPool& shared() {
+        static SizeClassPool pool;
+        return pool;
+    }
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        void* p;
+        if (!pooled(bytes, alignment)) {
+            p = ::operator new(bytes, std::align_val_t(alignment));
+        } else {
+            const size_t index = class_index(bytes);
+            Bucket& bucket = buckets[index];
+            if (bucket.free_list) {
+                p = bucket.free_list;
+                bucket.free_list = bucket.free_list->next;
+            } else {
+                if (bucket.tail == bucket.tail_end) {
+                    grow(bucket, slot_size(index));
+                }
+                p = bucket.tail;
+                bucket.tail += slot_size(index);
+            }
+            bucket.free_slots--;
+        }
+        this->on_allocate(bytes, p);
+        return p;
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment = alignof(std::max_align_t)) noexcept {
+        this->on_deallocate(bytes, p);
+        if (!pooled(bytes, alignment)) {
+            ::operator delete(p, std::align_val_t(alignment));
+            return;
+        }
+        Bucket& bucket = buckets[class_index(bytes)];
+        FreeNode* node = static_cast<FreeNode*>(p);
+        node->next = bucket.free_list;
+        bucket.free_list = node;
+        bucket.free_slots++;
+    }
+
+    // Free slots in the size class serving `bytes` - O(1), no list walk
+    size_t free_slots(size_t bytes) const {
+        return bytes <= kMaxSlot ? buckets[class_index(bytes)].free_slots : 0;
+    }
+
+    size_t slab_count() const {
+        size_t count = 0;
+        for (const Bucket& bucket : buckets) {
+            count += bucket.slab_count;
+        }
+        return count;
+    }
+
+    static constexpr size_t slot_size(size_t index) { return kMinSlot << index; }
+
+    static constexpr size_t class_index(size_t bytes) {
+        return bytes <= kMinSlot ? 0 : std::bit_width(bytes - 1) - std::bit_width(kMinSlot - 1);
+    }
+
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    // Slab header; the slots follow it, aligned like max_align_t
+    struct alignas(std::max_align_t) Slab {
+        Slab* next;
+    };
+
+    struct Bucket {
+        FreeNode* free_list = nullptr;
+        char* tail = nullptr;        // unused part of the newest slab
+        char* tail_end = nullptr;
+        Slab* slabs = nullptr;
+        size_t free_slots = 0;       // free list + tail
+        size_t slab_count = 0;
+    };
+
+    static bool pooled(size_t bytes, size_t alignment) {
+        return bytes <= kMaxSlot && alignment <= alignof(std::max_align_t);
+    }
+
+    void grow(Bucket& bucket, size_t slot_bytes) {
+        void* raw = ::operator new(sizeof(Slab) + SlotsPerSlab * slot_bytes);
+        Slab* slab = ::new (raw) Slab{bucket.slabs};
+        bucket.slabs = slab;
+        bucket.tail = reinterpret_cast<char*>(slab + 1);
+        bucket.tail_end = bucket.tail + SlotsPerSlab * slot_bytes;
+        bucket.free_slots += SlotsPerSlab;
+        bucket.slab_count++;
+        this->on_grow(slot_bytes, SlotsPerSlab);
+    }
+
+    Bucket buckets[kClassCount];
+};
+
+// The silent policy really is free
+static_assert(sizeof(SizeClassPool<1024, SilentPoolPolicy>) ==
+              sizeof(SizeClassPool<1024, LoggingPoolPolicy>));
+
+// The allocator itself is just a pointer to its pool, so copies and rebound
+// copies (std::list<int> allocates nodes, not ints) share one pool and can
+// free each other's memory, as the standard requires.
+template<typename T, size_t PoolSize = 1024, typename Policy = SilentPoolPolicy>
+class PoolAllocator {
+public:
+    using value_type = T;
+    using Pool = SizeClassPool<PoolSize, Policy>;
+
+    // Needed because PoolSize is not a type parameter, so
+    // std::allocator_traits cannot rebind PoolAllocator by itself
+    template<typename U>
+    struct rebind {
+        using other = PoolAllocator<U, PoolSize, Policy>;
+    };
+
+    PoolAllocator() noexcept : pool_(&Pool::shared()) {}
+
+    explicit PoolAllocator(Pool& pool) noexcept : pool_(&pool) {}
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U, PoolSize, Policy>& other) noexcept
+        : pool_(other.pool()) {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(pool_->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        pool_->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    // Free single-object slots, O(1)
+    size_t available() const {
+        return pool_->free_slots(sizeof(T));
+    }
+
+    Pool* pool() const noexcept { return pool_; }
+
+private:
+    Pool* pool_;
+};
+
+template<typename T, size_t PoolSize, typename Policy, typename U>
+bool operator==(const PoolAllocator<T, PoolSize, Policy>& a, const PoolAllocator<U, PoolSize, Policy>& b) {
+    return a.pool() == b.pool();
+}
+
+template<typename T, size_t PoolSize, typename Policy, typename U>
+bool operator!=(const PoolAllocator<T, PoolSize, Policy>& a, const PoolAllocator<U, PoolSize, Policy>& b) {
+    return !(a == b);
+}
+
+// =============================================================================
+// Example 3: Arena/Stack Allocator
+// Bump-allocates from a chain of blocks, frees everything at once
+// =============================================================================
+
+// The arena itself. Allocation bumps a pointer through the current block;
+// when a request does not fit, the next block in the chain is used, or a
+// new one - twice as big as the last - is chained in. Nothing is freed one
+// by one: rewind() and reset() hand memory back in O(1), and the blocks are
+// kept for reuse until the arena is destroyed.
+//
+// mark()/rewind() nest like a stack, so per-request scratch memory can be
+// dropped at the end of each request (see ArenaScope).
+//
+// Not thread-safe; use one arena per thread or per request.
+class Arena {
+public:
+    // A position in the arena, as returned by mark()
+    struct Mark {
+        void* block;
+        char* ptr;
+    };
+
+    explicit Arena(size_t initial_size = 1024 * 1024) : next_size(initial_size) {
+        add_block(initial_size, nullptr);
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        while (first) {
+            Block* next = first->next;
+            ::operator delete(first);
+            first = next;
+        }
+    }
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        char* p = align_up(ptr, alignment);
+        // Aligning can step past end when the block size is not a multiple
+        // of the alignment; end - p would then wrap around
+        if (p > end || bytes > static_cast<size_t>(end - p)) {
+            p = next_block(bytes, alignment);
+        }
+        ptr = p + bytes;
+        return p;
+    }
+
+    Mark mark() const { return Mark{current, ptr}; }
+
+    // Free everything allocated since `m`
+    void rewind(Mark m) {
+        current = static_cast<Block*>(m.block);
+        ptr = m.ptr;
+        end = current->data() + current->size;
+    }
+
+    // Free everything, keep the blocks
+    void reset() {
+        current = first;
+        ptr = first->data();
+        end = ptr + first->size;
+    }
+
+    // Bytes handed out since the last reset/rewind (padding included)
+    size_t bytes_used() const {
+        size_t used = static_cast<size_t>(ptr - current->data());
+        for (Block* b = first; b != current; b = b->next) {
+            used += b->size;
+        }
+        return used;
+    }
+
+    size_t bytes_reserved() const {
+        size_t reserved = 0;
+        for (Block* b = first; b; b = b->next) {
+            reserved += b->size;
+        }
+        return reserved;
+    }
+
+    size_t block_count() const {
+        size_t count = 0;
+        for (Block* b = first; b; b = b->next) {
+            count++;
+        }
+        return count;
+    }
+
+private:
+    struct alignas(std::max_align_t) Block {
+        Block* next;
+        size_t size;
+
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    Block* first = nullptr;
+    Block* current = nullptr;
+    char* ptr = nullptr;
+    char* end = nullptr;
+    size_t next_size;
+
+    static char* align_up(char* p, size_t alignment) {
+        const uintptr_t v = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<char*>((v + alignment - 1) & ~(alignment - 1));
+    }
+
+    // New block of at least `size` bytes, chained in after `after`
+    Block* add_block(size_t size, Block* after) {
+        void* raw = ::operator new(sizeof(Block) + size);
+        Block* block = ::new (raw) Block{after ? after->next : nullptr, size};
+        if (after) {
+            after->next = block;
+        } else {
+            first = block;
+        }
+        current = block;
+        ptr = block->data();
+        end = ptr + size;
+        return block;
+    }
+
+    // Slow path of allocate(): move on to a block the request fits in
+    char* next_block(size_t bytes, size_t alignment) {
+        // Reuse a block kept from before a rewind/reset if it is big enough
+        if (current->next && current->next->size >= bytes + alignment) {
+            current = current->next;
+            ptr = current->data();
+            end = ptr + current->size;
+        } else {
+            next_size *= 2;
+            add_block(std::max(next_size, bytes + alignment), current);
+        }
+        return align_up(ptr, alignment);
+    }
+};
+
+// Rewinds the arena to where it was when the scope was entered
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : arena(arena), saved(arena.mark()) {}
+    ~ArenaScope() { arena.rewind(saved); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena& arena;
+    Arena::Mark saved;
+};
+
+// std::pmr adapter, so pmr::vector, pmr::string, pmr::map... can use an arena
+class ArenaResource : public std::pmr::memory_resource {
+public:
+    explicit ArenaResource(Arena& arena) : arena(arena) {}
+
+private:
+    Arena& arena;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return arena.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {
+        // Freed in bulk by rewind/reset
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Classic allocator interface on top of an Arena. It only holds a raw
+// pointer: copies are free, no shared_ptr refcount to bump. The arena must
+// outlive every container using it.
+template<typename T>
+class ArenaAllocator {
+private:
+    Arena* arena;
+
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& a) noexcept : arena(&a) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena(other.arena) {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t) noexcept {
+        // Arena allocator doesn't deallocate individual allocations
+        // Memory is freed when arena is destroyed, reset or rewound
+    }
+
+    Arena& get_arena() const noexcept { return *arena; }
+
+    template<typename U> friend class ArenaAllocator;
+    template<typename U, typename V>
+    friend bool operator==(const ArenaAllocator<U>&, const ArenaAllocator<V>&);
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return a.arena == b.arena;
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {
+    return !(a == b);
+}
@@ -3,388 +3,235 @@
 #include <list>
 #include <memory>
 #include <cstdlib>
-#include <limits>
 #include <mutex>
 #include <thread>
 #include <chrono>
 #include <map>
 #include <iomanip>
 #include <sstream>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <array>
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "allocators2.hpp"
 
 // =============================================================================
-// Example 4: Aligned Allocator
-// Allocates memory with specific alignment requirements
+// Usage Examples
 // =============================================================================
 
-template<typename T, size_t Alignment = alignof(T)>
-class AlignedAllocator {
-public:
-    using value_type = T;
-
-    static_assert(Alignment >= alignof(T),
-                  "Alignment must be at least as strict as T's natural alignment");
-    static_assert((Alignment & (Alignment - 1)) == 0,
-                  "Alignment must be a power of 2");
-
-    AlignedAllocator() noexcept = default;
-
-    template<typename U>
-    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
-
-    T* allocate(std::size_t n) {
-        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
-            throw std::bad_alloc();
-        }
-
-        size_t bytes = n * sizeof(T);
-
-        // Use aligned_alloc (C++17) or platform-specific alternatives
-        #if defined(_WIN32)
-            void* p = _aligned_malloc(bytes, Alignment);
-        #else
-            void* p = std::aligned_alloc(Alignment, bytes);
-        #endif
-
-        if (!p) {
-            throw std::bad_alloc();
-        }
-
-        std::cout << "[AlignedAllocator] Allocated " << bytes
-                  << " bytes with " << Alignment << "-byte alignment at "
-                  << p << std::endl;
+void example_aligned_allocator() {
+    std::cout << "\n" << std::string(70, '=') << std::endl;
+    std::cout << "Example 4: Aligned Allocator" << std::endl;
+    std::cout << std::string(70, '=') << std::endl;
 
-        // Verify alignment
-        if (reinterpret_cast<uintptr_t>(p) % Alignment != 0) {
-            std::cerr << "ERROR: Memory not properly aligned!" << std::endl;
-        }
+    // Useful for SIMD operations that require specific alignment
+    struct alignas(32) SIMDVector {
+        float data[8];
+    };
 
-        return static_cast<T*>(p);
-    }
+    std::cout << "\nNatural alignment of SIMDVector: " << alignof(SIMDVector) << std::endl;
+    std::cout << "\nUsing 64-byte alignment:" << std::endl;
 
-    void deallocate(T* p, std::size_t n) noexcept {
-        std::cout << "[AlignedAllocator] Deallocating " << n * sizeof(T)
-                  << " bytes at " << p << std::endl;
+    using AlignedVec = std::vector<SIMDVector, AlignedAllocator<SIMDVector, 64>>;
+    AlignedVec vec;
 
-        #if defined(_WIN32)
-            _aligned_free(p);
-        #else
-            std::free(p);
-        #endif
+    vec.reserve(5);
+    for (int i = 0; i < 5; ++i) {
+        vec.push_back(SIMDVector{});
     }
-};
-
-template<typename T, size_t A1, typename U, size_t A2>
-bool operator==(const AlignedAllocator<T, A1>&, const AlignedAllocator<U, A2>&) {
-    return A1 == A2;
-}
 
-template<typename T, size_t A1, typename U, size_t A2>
-bool operator!=(const AlignedAllocator<T, A1>&, const AlignedAllocator<U, A2>&) {
-    return A1 != A2;
+    std::cout << "\nVector data pointer alignment check:" << std::endl;
+    std::cout << "  Address: " << static_cast<void*>(vec.data()) << std::endl;
+    std::cout << "  Aligned to 64 bytes: "
+              << (reinterpret_cast<uintptr_t>(vec.data()) % 64 == 0 ? "YES" : "NO")
+              << std::endl;
 }
 
-// =============================================================================
-// Example 5: Thread-Safe Pool Allocator
-// Pool allocator with mutex protection for concurrent access
-// =============================================================================
-
-template<typename T, size_t PoolSize = 1024>
-class ThreadSafePoolAllocator {
-private:
-    struct FreeNode {
-        FreeNode* next;
-    };
-
-    alignas(T) char pool[PoolSize * sizeof(T)];
-    FreeNode* free_list;
-    size_t allocated_count;
-    mutable std::mutex mutex;
-
+#if defined(__linux__)
+// Data-TLB load misses of the calling thread, through perf_event_open.
+// Unavailable in many VMs and containers (no PMU, or perf_event_paranoid),
+// in which case the benchmark prints n/a.
+class DtlbMissCounter {
 public:
-    using value_type = T;
-
-    ThreadSafePoolAllocator() noexcept : free_list(nullptr), allocated_count(0) {
-        std::lock_guard<std::mutex> lock(mutex);
-        for (size_t i = 0; i < PoolSize; ++i) {
-            FreeNode* node = reinterpret_cast<FreeNode*>(pool + i * sizeof(T));
-            node->next = free_list;
-            free_list = node;
-        }
-        std::cout << "[ThreadSafePool] Initialized pool with "
-                  << PoolSize << " slots" << std::endl;
+    DtlbMissCounter() {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
     }
 
-    // Prevent copying to avoid mutex issues
-    ThreadSafePoolAllocator(const ThreadSafePoolAllocator&) = delete;
-    ThreadSafePoolAllocator& operator=(const ThreadSafePoolAllocator&) = delete;
-
-    template<typename U>
-    struct rebind {
-        using other = ThreadSafePoolAllocator<U, PoolSize>;
-    };
-
-    T* allocate(std::size_t n) {
-        std::lock_guard<std::mutex> lock(mutex);
-
-        if (n != 1) {
-            throw std::bad_alloc();
-        }
-
-        if (!free_list) {
-            std::cout << "[ThreadSafePool] Pool exhausted on thread "
-                      << std::this_thread::get_id() << std::endl;
-            void* p = std::malloc(sizeof(T));
-            if (!p) throw std::bad_alloc();
-            return static_cast<T*>(p);
-        }
-
-        FreeNode* node = free_list;
-        free_list = node->next;
-        allocated_count++;
-
-        std::cout << "[ThreadSafePool] Thread " << std::this_thread::get_id()
-                  << " allocated (count: " << allocated_count << ")" << std::endl;
-
-        return reinterpret_cast<T*>(node);
+    ~DtlbMissCounter() {
+        if (fd >= 0) close(fd);
     }
 
-    void deallocate(T* p, std::size_t n) noexcept {
-        std::lock_guard<std::mutex> lock(mutex);
-
-        if (n != 1) return;
-
-        char* ptr = reinterpret_cast<char*>(p);
-        if (ptr >= pool && ptr < pool + PoolSize * sizeof(T)) {
-            FreeNode* node = reinterpret_cast<FreeNode*>(p);
-            node->next = free_list;
-            free_list = node;
-            allocated_count--;
-            std::cout << "[ThreadSafePool] Thread " << std::this_thread::get_id()
-                      << " deallocated (count: " << allocated_count << ")" << std::endl;
-        } else {
-            std::free(p);
-        }
-    }
+    bool available() const { return fd >= 0; }
 
-    size_t get_allocated_count() const {
-        std::lock_guard<std::mutex> lock(mutex);
-        return allocated_count;
+    void start() {
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
     }
-};
-
-// =============================================================================
-// Example 6: Sophisticated Memory Tracking Allocator
-// Tracks detailed allocation info including call stacks, sizes, and statistics
-// =============================================================================
-
-template<typename T>
-class DetailedTrackingAllocator {
-private:
-    struct AllocationInfo {
-        void* address;
-        size_t size;
-        size_t count;
-        std::chrono::steady_clock::time_point timestamp;
-
-        AllocationInfo(void* addr, size_t sz, size_t cnt)
-            : address(addr), size(sz), count(cnt),
-              timestamp(std::chrono::steady_clock::now()) {}
-    };
-
-    static inline std::map<void*, AllocationInfo> allocations;
-    static inline std::mutex allocations_mutex;
-
-    // Statistics
-    static inline size_t total_allocations = 0;
-    static inline size_t total_deallocations = 0;
-    static inline size_t peak_memory = 0;
-    static inline size_t current_memory = 0;
-    static inline size_t total_bytes_allocated = 0;
-    static inline size_t total_bytes_deallocated = 0;
-
-public:
-    using value_type = T;
-
-    DetailedTrackingAllocator() noexcept = default;
-
-    template<typename U>
-    DetailedTrackingAllocator(const DetailedTrackingAllocator<U>&) noexcept {}
-
-    T* allocate(std::size_t n) {
-        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
-            throw std::bad_alloc();
-        }
-
-        size_t bytes = n * sizeof(T);
-        void* p = std::malloc(bytes);
-
-        if (!p) {
-            throw std::bad_alloc();
-        }
-
-        // Record allocation
-        {
-            std::lock_guard<std::mutex> lock(allocations_mutex);
-
-            allocations.emplace(p, AllocationInfo(p, bytes, n));
-
-            total_allocations++;
-            current_memory += bytes;
-            total_bytes_allocated += bytes;
-
-            if (current_memory > peak_memory) {
-                peak_memory = current_memory;
-            }
-
-            std::cout << "[DetailedTracker] ALLOC: " << std::setw(10) << bytes
-                      << " bytes (" << std::setw(6) << n << " objects) at "
-                      << p << " | Current: " << current_memory
-                      << " bytes in " << allocations.size() << " blocks"
-                      << std::endl;
-        }
 
-        return static_cast<T*>(p);
+    long long stop() {
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) return -1;
+        return count;
     }
 
-    void deallocate(T* p, std::size_t n) noexcept {
-        size_t bytes = n * sizeof(T);
-
-        {
-            std::lock_guard<std::mutex> lock(allocations_mutex);
-
-            auto it = allocations.find(p);
-            if (it != allocations.end()) {
-                auto duration = std::chrono::steady_clock::now() - it->second.timestamp;
-                auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-
-                std::cout << "[DetailedTracker] DEALLOC: " << std::setw(10) << bytes
-                          << " bytes (" << std::setw(6) << n << " objects) at "
-                          << p << " | Lived: " << ms << " ms | Current: "
-                          << (current_memory - bytes) << " bytes" << std::endl;
-
-                current_memory -= bytes;
-                total_bytes_deallocated += bytes;
-                allocations.erase(it);
-            } else {
-                std::cerr << "[DetailedTracker] WARNING: Deallocating unknown pointer "
-                          << p << std::endl;
-            }
+private:
+    int fd = -1;
+};
 
-            total_deallocations++;
+// kB of this process's anonymous memory backed by transparent huge pages
+long anon_huge_kb() {
+    std::ifstream smaps("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(smaps, line)) {
+        if (line.rfind("AnonHugePages:", 0) == 0) {
+            return std::stol(line.substr(14));
         }
-
-        std::free(p);
     }
-
-    static void print_detailed_report() {
-        std::lock_guard<std::mutex> lock(allocations_mutex);
-
-        std::cout << "\n" << std::string(70, '=') << std::endl;
-        std::cout << "DETAILED MEMORY TRACKING REPORT" << std::endl;
-        std::cout << std::string(70, '=') << std::endl;
-
-        std::cout << "\nAllocation Statistics:" << std::endl;
-        std::cout << "  Total allocations:     " << total_allocations << std::endl;
-        std::cout << "  Total deallocations:   " << total_deallocations << std::endl;
-        std::cout << "  Leaked allocations:    " << (total_allocations - total_deallocations) << std::endl;
-        std::cout << "  Total bytes allocated: " << total_bytes_allocated << " bytes" << std::endl;
-        std::cout << "  Total bytes freed:     " << total_bytes_deallocated << " bytes" << std::endl;
-        std::cout << "  Peak memory usage:     " << peak_memory << " bytes" << std::endl;
-        std::cout << "  Current memory usage:  " << current_memory << " bytes" << std::endl;
-
-        if (!allocations.empty()) {
-            std::cout << "\nActive Allocations (" << allocations.size() << "):" << std::endl;
-            std::cout << std::string(70, '-') << std::endl;
-
-            for (const auto& [addr, info] : allocations) {
-                auto duration = std::chrono::steady_clock::now() - info.timestamp;
-                auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-
-                std::cout << "  Address: " << addr
-                          << " | Size: " << std::setw(8) << info.size << " bytes"
-                          << " | Count: " << std::setw(6) << info.count
-                          << " | Age: " << std::setw(6) << ms << " ms"
-                          << std::endl;
-            }
-        }
-
-        std::cout << std::string(70, '=') << std::endl;
-    }
-
-    static void reset_stats() {
-        std::lock_guard<std::mutex> lock(allocations_mutex);
-        total_allocations = 0;
-        total_deallocations = 0;
-        peak_memory = 0;
-        current_memory = 0;
-        total_bytes_allocated = 0;
-        total_bytes_deallocated = 0;
-        allocations.clear();
-    }
-};
-
-template<typename T, typename U>
-bool operator==(const DetailedTrackingAllocator<T>&, const DetailedTrackingAllocator<U>&) {
-    return true;
+    return -1;
 }
 
-template<typename T, typename U>
-bool operator!=(const DetailedTrackingAllocator<T>&, const DetailedTrackingAllocator<U>&) {
-    return false;
+std::string read_first_line(const char* path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line.empty() ? "n/a" : line;
 }
 
-// =============================================================================
-// Usage Examples
-// =============================================================================
-
-void example_aligned_allocator() {
+// Streaming kernels over a 256 MiB buffer with each page-backing option:
+//   stream  - sequential sum, GB/s (prefetchers hide most TLB misses)
+//   stride  - one load per 4 KiB page + 64 bytes, ns per load; every load
+//             needs a different 4 KiB TLB entry, but 512 of them share a 2 MiB one
+void benchmark_large_pages() {
     std::cout << "\n" << std::string(70, '=') << std::endl;
-    std::cout << "Example 4: Aligned Allocator" << std::endl;
+    std::cout << "Benchmark: 4 KiB vs 2 MiB pages on streaming kernels" << std::endl;
     std::cout << std::string(70, '=') << std::endl;
+    std::cout << "THP mode: " << read_first_line("/sys/kernel/mm/transparent_hugepage/enabled")
+              << ", reserved hugetlb pages: " << read_first_line("/proc/sys/vm/nr_hugepages") << "\n";
 
-    // Useful for SIMD operations that require specific alignment
-    struct alignas(32) SIMDVector {
-        float data[8];
+    using Opts = LargePageOptions;
+    struct Variant {
+        const char* name;
+        Opts options;
+    };
+    const Variant variants[] = {
+        {"4 KiB pages", Opts{}},
+        {"transparent", Opts{Opts::HugePages::Transparent}},
+        {"explicit", Opts{Opts::HugePages::Explicit}},
+        {"THP+prefault+node0", Opts{Opts::HugePages::Transparent, size_t{2} << 20, true, 0}},
     };
 
-    std::cout << "\nNatural alignment of SIMDVector: " << alignof(SIMDVector) << std::endl;
-    std::cout << "\nUsing 64-byte alignment:" << std::endl;
-
-    using AlignedVec = std::vector<SIMDVector, AlignedAllocator<SIMDVector, 64>>;
-    AlignedVec vec;
+    const size_t n = (size_t{256} << 20) / sizeof(float);
+    const size_t stride = (LargePageBacking::kSmallPage + 64) / sizeof(float);
+    DtlbMissCounter tlb;
+
+    std::vector<std::string> rows;
+    for (const Variant& v : variants) {
+        using FloatAlloc = AlignedAllocator<float, 64>;
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<float, FloatAlloc> data(n, 1.0f, FloatAlloc(v.options));
+        const double init_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        const long huge_kb = anon_huge_kb();
+
+        // Sequential
+        double best_gbps = 0.0;
+        float sum = 0.0f;
+        for (int rep = 0; rep < 3; ++rep) {
+            auto s0 = std::chrono::steady_clock::now();
+            float s = 0.0f;
+            for (size_t i = 0; i < n; ++i) {
+                s += data[i];
+            }
+            const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - s0).count();
+            best_gbps = std::max(best_gbps, n * sizeof(float) / sec / 1e9);
+            sum += s;
+        }
 
-    vec.reserve(5);
-    for (int i = 0; i < 5; ++i) {
-        vec.push_back(SIMDVector{});
+        // Page stride
+        const int passes = 16;
+        size_t loads = 0;
+        tlb.start();
+        auto s0 = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            for (size_t i = static_cast<size_t>(pass); i < n; i += stride) {
+                sum += data[i];
+                loads++;
+            }
+        }
+        const double stride_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - s0).count() / loads;
+        const long long misses = tlb.stop();
+
+        std::ostringstream row;
+        row << std::left << std::setw(20) << v.name << std::right << std::fixed
+            << std::setprecision(0) << std::setw(10) << init_ms
+            << std::setw(10) << (huge_kb >= 0 ? huge_kb / 1024 : -1)
+            << std::setprecision(2) << std::setw(10) << best_gbps
+            << std::setw(10) << stride_ns
+            << std::setw(16) << (misses >= 0 ? std::to_string(misses / passes) : std::string("n/a"))
+            << "   (checksum " << std::setprecision(0) << sum << ")";
+        rows.push_back(row.str());
     }
 
-    std::cout << "\nVector data pointer alignment check:" << std::endl;
-    std::cout << "  Address: " << static_cast<void*>(vec.data()) << std::endl;
-    std::cout << "  Aligned to 64 bytes: "
-              << (reinterpret_cast<uintptr_t>(vec.data()) % 64 == 0 ? "YES" : "NO")
-              << std::endl;
+    std::cout << "\n" << std::left << std::setw(20) << "backing" << std::right
+              << std::setw(10) << "init ms" << std::setw(10) << "THP MiB"
+              << std::setw(10) << "GB/s" << std::setw(10) << "ns/load"
+              << std::setw(16) << "dTLB miss/pass" << "\n";
+    for (const auto& row : rows) {
+        std::cout << row << "\n";
+    }
+    std::cout << "explicit: " << LargePageStats::explicit_huge << " hugetlb mappings, "
+              << LargePageStats::fallbacks << " fell back to THP; madvise accepted "
+              << LargePageStats::transparent << "x; NUMA bound " << LargePageStats::numa_bound
+              << ", failed " << LargePageStats::numa_failed << "\n";
 }
+#endif
 
 void example_thread_safe_pool() {
     std::cout << "\n" << std::string(70, '=') << std::endl;
     std::cout << "Example 5: Thread-Safe Pool Allocator" << std::endl;
     std::cout << std::string(70, '=') << std::endl;
 
-    // We'll simulate a shared pool being used by multiple threads
-    // Note: This is a simplified example; real usage would be more complex
+    using PoolList = std::list<int, ThreadSafePoolAllocator<int>>;
 
-    std::cout << "\nSpawning 3 threads to allocate from shared pool..." << std::endl;
+    std::cout << "\nSpawning 3 threads that allocate list nodes from the shared pool..." << std::endl;
 
     auto worker = [](int thread_id) {
-        std::cout << "\n[Thread " << thread_id << "] Starting work..." << std::endl;
-
-        // Each thread creates its own vector but could share allocator in real scenarios
-        for (int i = 0; i < 3; ++i) {
-            int* p = static_cast<int*>(std::malloc(sizeof(int)));
-            std::cout << "[Thread " << thread_id << "] Allocated at " << p << std::endl;
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            std::free(p);
+        long sum = 0;
+        for (int round = 0; round < 100; ++round) {
+            PoolList list;
+            for (int i = 0; i < 1000; ++i) {
+                list.push_back(i);
+            }
+            for (int v : list) {
+                sum += v;
+            }
         }
+        std::ostringstream out;
+        out << "[Thread " << thread_id << "] done, sum " << sum << "\n";
+        std::cout << out.str();
     };
 
     std::thread t1(worker, 1);
@@ -395,7 +242,152 @@ void example_thread_safe_pool() {
     t2.join();
     t3.join();
 
-    std::cout << "\nAll threads completed." << std::endl;
+    // Remote frees: nodes allocated on the producer, freed on the consumer
+    PoolList handoff;
+    std::thread producer([&] {
+        for (int i = 0; i < 10000; ++i) {
+            handoff.push_back(i);
+        }
+    });
+    producer.join();
+    std::thread consumer([&] { handoff.clear(); });
+    consumer.join();
+
+    std::cout << "\nAll threads completed. Depot visits: "
+              << MagazineDepotStats::depot_visits.load()
+              << " for 310000 node allocations, slabs: "
+              << MagazineDepotStats::slabs.load() << std::endl;
+}
+
+// Multi-threaded alloc/free throughput: malloc vs the single-mutex pool vs
+// the magazine pool, for 32-byte objects.
+//   local - every thread allocates a batch of 64 objects and frees them again
+//   cross - producer/consumer pairs; every object is freed by the other thread
+struct BenchObject {
+    char bytes[32];
+};
+
+template<typename Alloc, typename Free>
+double local_mops(int threads, Alloc alloc, Free release) {
+    const int rounds = 20000;
+    const int batch = 64;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            void* ptrs[batch];
+            for (int r = 0; r < rounds; ++r) {
+                for (int i = 0; i < batch; ++i) {
+                    ptrs[i] = alloc();
+                }
+                for (int i = 0; i < batch; ++i) {
+                    release(ptrs[i]);
+                }
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(threads) * rounds * batch / seconds / 1e6;
+}
+
+template<typename Alloc, typename Free>
+double cross_mops(int pairs, Alloc alloc, Free release) {
+    const int batches = 5000;
+    const size_t batch = 64;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int p = 0; p < pairs; ++p) {
+        workers.emplace_back([&] {
+            // Hand-off queue for this pair only
+            struct Channel {
+                std::mutex mtx;
+                std::vector<std::vector<void*>> batches;
+                bool done = false;
+            } channel;
+
+            std::thread consumer([&] {
+                for (;;) {
+                    std::vector<std::vector<void*>> taken;
+                    {
+                        std::lock_guard<std::mutex> lock(channel.mtx);
+                        taken.swap(channel.batches);
+                        if (taken.empty() && channel.done) {
+                            return;
+                        }
+                    }
+                    if (taken.empty()) {
+                        std::this_thread::yield();
+                    }
+                    for (auto& b : taken) {
+                        for (void* ptr : b) {
+                            release(ptr);
+                        }
+                    }
+                }
+            });
+
+            for (int b = 0; b < batches; ++b) {
+                std::vector<void*> ptrs(batch);
+                for (auto& ptr : ptrs) {
+                    ptr = alloc();
+                }
+                std::lock_guard<std::mutex> lock(channel.mtx);
+                channel.batches.push_back(std::move(ptrs));
+            }
+            {
+                std::lock_guard<std::mutex> lock(channel.mtx);
+                channel.done = true;
+            }
+            consumer.join();
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(pairs) * batches * batch / seconds / 1e6;
+}
+
+void benchmark_thread_safe_pools() {
+    std::cout << "\n" << std::string(70, '=') << std::endl;
+    std::cout << "Benchmark: thread-safe pools (alloc+free pairs, M/s)" << std::endl;
+    std::cout << std::string(70, '=') << std::endl;
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n\n";
+
+    // Big enough that it never falls back to malloc
+    auto mutex_pool = std::make_unique<MutexPoolAllocator<BenchObject, 1 << 16>>();
+    ThreadSafePoolAllocator<BenchObject> magazine_pool;
+
+    auto malloc_alloc = [] { return std::malloc(sizeof(BenchObject)); };
+    auto malloc_free = [](void* p) { std::free(p); };
+    auto mutex_alloc = [&] { return static_cast<void*>(mutex_pool->allocate(1)); };
+    auto mutex_free = [&](void* p) { mutex_pool->deallocate(static_cast<BenchObject*>(p), 1); };
+    auto magazine_alloc = [&] { return static_cast<void*>(magazine_pool.allocate(1)); };
+    auto magazine_free = [&](void* p) { magazine_pool.deallocate(static_cast<BenchObject*>(p), 1); };
+
+    std::cout << std::left << std::setw(16) << "workload" << std::right
+              << std::setw(12) << "malloc" << std::setw(12) << "mutex pool"
+              << std::setw(12) << "magazines" << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (int threads : {1, 2, 4, 8}) {
+        std::string name = "local x" + std::to_string(threads);
+        std::cout << std::left << std::setw(16) << name << std::right
+                  << std::setw(12) << local_mops(threads, malloc_alloc, malloc_free)
+                  << std::setw(12) << local_mops(threads, mutex_alloc, mutex_free)
+                  << std::setw(12) << local_mops(threads, magazine_alloc, magazine_free) << "\n";
+    }
+    for (int pairs : {1, 2, 4}) {
+        std::string name = "cross x" + std::to_string(pairs) + " pairs";
+        std::cout << std::left << std::setw(16) << name << std::right
+                  << std::setw(12) << cross_mops(pairs, malloc_alloc, malloc_free)
+                  << std::setw(12) << cross_mops(pairs, mutex_alloc, mutex_free)
+                  << std::setw(12) << cross_mops(pairs, magazine_alloc, magazine_free) << "\n";
+    }
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
 }
 
 void example_detailed_tracking() {
@@ -405,14 +397,17 @@ void example_detailed_tracking() {
 
     DetailedTrackingAllocator<int>::reset_stats();
 
-    std::cout << "\nCreating and manipulating vector..." << std::endl;
+    // The tracker's lines go through the AsyncLogger; narrate through it too,
+    // so they stay in order
+    AsyncLogger& trace = AsyncLogger::global();
+    trace.log("\nCreating and manipulating vector...\n");
     {
         std::vector<int, DetailedTrackingAllocator<int>> vec;
 
-        std::cout << "\n--- Reserve 10 elements ---" << std::endl;
+        trace.log("\n--- Reserve 10 elements ---\n");
         vec.reserve(10);
 
-        std::cout << "\n--- Push 15 elements (triggers reallocation) ---" << std::endl;
+        trace.log("\n--- Push 15 elements (triggers reallocation) ---\n");
         for (int i = 0; i < 15; ++i) {
             vec.push_back(i);
             if (i == 5) {
@@ -420,16 +415,16 @@ void example_detailed_tracking() {
             }
         }
 
-        std::cout << "\n--- Shrink to fit ---" << std::endl;
+        trace.log("\n--- Shrink to fit ---\n");
         vec.shrink_to_fit();
 
-        std::cout << "\n--- Vector still alive (sleeping for 200ms) ---" << std::endl;
+        trace.log("\n--- Vector still alive (sleeping for 200ms) ---\n");
         std::this_thread::sleep_for(std::chrono::milliseconds(200));
 
-        std::cout << "\n--- Vector about to be destroyed ---" << std::endl;
+        trace.log("\n--- Vector about to be destroyed ---\n");
     }
 
-    std::cout << "\n--- Vector destroyed ---" << std::endl;
+    trace.log("\n--- Vector destroyed ---\n");
 
     DetailedTrackingAllocator<int>::print_detailed_report();
 
@@ -445,15 +440,92 @@ void example_detailed_tracking() {
     auto* leaked = DetailedTrackingAllocator<char>().allocate(1024);
     (void)leaked; // Don't deallocate
 
-    std::cout << "\n(Intentionally leaked 1024 bytes for demonstration)" << std::endl;
+    trace.log("\n(Intentionally leaked 1024 bytes for demonstration)\n");
 
     DetailedTrackingAllocator<char>::print_detailed_report();
 }
 
+void example_sampling_profiler() {
+    std::cout << "\n" << std::string(70, '=') << std::endl;
+    std::cout << "Example 7: Sampling Heap Profiler" << std::endl;
+    std::cout << std::string(70, '=') << std::endl;
+
+    HeapProfiler::set_sample_interval(64 * 1024);
+
+    // A mixed workload on 4 threads: long-lived maps and lists, short-lived
+    // vectors, and one big buffer that outlives its thread
+    using Map = std::map<int, double, std::less<int>, SamplingTrackingAllocator<std::pair<const int, double>>>;
+    using List = std::list<std::array<char, 200>, SamplingTrackingAllocator<std::array<char, 200>>>;
+    using Vec = std::vector<float, SamplingTrackingAllocator<float>>;
+
+    std::vector<Map> maps(4);
+    std::vector<List> lists(4);
+    Vec big;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 20000; ++i) {
+                maps[t].emplace(i, i * 0.5);
+            }
+            for (int i = 0; i < 2000; ++i) {
+                lists[t].emplace_back();
+            }
+            for (int i = 0; i < 1000; ++i) {
+                Vec scratch(1000);
+                scratch[0] = static_cast<float>(i);
+            }
+            if (t == 0) {
+                big.resize(1 << 20);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    HeapProfiler::dump();
+
+    // Overhead: map node churn with std::allocator, the sampling profiler
+    // and DetailedTrackingAllocator (its per-call logging sent nowhere)
+    auto churn = [](auto map) {
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < 20; ++round) {
+            for (int i = 0; i < 10000; ++i) {
+                map.emplace(i, i);
+            }
+            map.clear();
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+               (20.0 * 10000.0);
+    };
+    HeapProfiler::set_sample_interval(512 * 1024);
+    const double plain_ns = churn(std::map<int, int>());
+    const double sampled_ns = churn(std::map<int, int, std::less<int>,
+                                             SamplingTrackingAllocator<std::pair<const int, int>>>());
+    // The tracker logs to file descriptor 1 (AsyncLogger): point it at /dev/null
+    AsyncLogger::global().flush();
+    std::fflush(stdout);
+    const int saved_stdout = dup(STDOUT_FILENO);
+    const int devnull = open("/dev/null", O_WRONLY);
+    dup2(devnull, STDOUT_FILENO);
+    const double detailed_ns = churn(std::map<int, int, std::less<int>,
+                                              DetailedTrackingAllocator<std::pair<const int, int>>>());
+    AsyncLogger::global().flush();
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    close(devnull);
+    std::cout << "\nmap insert + clear per node: std::allocator " << plain_ns << " ns, sampling "
+              << sampled_ns << " ns, detailed tracking " << detailed_ns << " ns" << std::endl;
+}
+
 int main() {
     example_aligned_allocator();
+#if defined(__linux__)
+    benchmark_large_pages();
+#endif
     example_thread_safe_pool();
+    benchmark_thread_safe_pools();
     example_detailed_tracking();
+    example_sampling_profiler();
 
     std::cout << "\n" << std::string(70, '=') << std::endl;
     std::cout << "All advanced examples completed!" << std::endl;
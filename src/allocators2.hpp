@@ -0,0 +1,1106 @@
+/*
+Allocators from the second half of the allocator examples (header-only,
+just #include it): AlignedAllocator (with huge-page backing),
+MutexPoolAllocator, ThreadSafePoolAllocator, DetailedTrackingAllocator and
+SamplingTrackingAllocator with its HeapProfiler.
+DetailedTrackingAllocator's statistics can be published to a
+metrics::Registry (metrics.hpp); its per-allocation trace lines go through
+the AsyncLogger (async_logger.hpp). ThreadSafePoolAllocator takes the
+type of its depot mutex, so ProfiledMutex (profiled_mutex.hpp) can report
+the depot's contention.
+Used by allocators2.cpp (examples), allocator_benchmarks.cpp and
+profiled_mutex_demo.cpp.
+*/
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <map>
+#include <iomanip>
+#include <atomic>
+#include <new>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <typeinfo>
+#include <version>
+
+#include "metrics.hpp"
+#include "async_logger.hpp"
+#include "profiled_mutex.hpp"
+
+#if defined(__cpp_lib_stacktrace)
+#include <stacktrace>
+#endif
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// =============================================================================
+// Example 4: Aligned Allocator
+// Allocates memory with specific alignment requirements, optionally backed
+// by 2 MiB huge pages and bound to a NUMA node
+// =============================================================================
+
+// How AlignedAllocator backs large allocations. Only used on Linux; on
+// other platforms the options are accepted and ignored.
+//
+// With 4 KiB pages a 1 GiB buffer needs 262144 TLB entries, so a streaming
+// kernel misses the TLB about once per page. A 2 MiB page covers 512 times
+// as much memory per entry.
+//   Transparent  mmap aligned to 2 MiB + madvise(MADV_HUGEPAGE): the kernel
+//                uses huge pages when it can find them (THP "madvise" or
+//                "always" mode) and 4 KiB pages otherwise
+//   Explicit     mmap(MAP_HUGETLB) from the reserved hugetlbfs pool
+//                (/proc/sys/vm/nr_hugepages); when the pool is empty it
+//                falls back to the transparent path
+// prefault touches every page up front, so the page faults happen at
+// allocation time rather than in the first pass of the kernel. numa_node
+// binds the pages to one node with mbind(MPOL_BIND), before they are
+// touched; if binding fails the memory stays where the kernel puts it.
+struct LargePageOptions {
+    enum class HugePages { Off, Transparent, Explicit };
+
+    HugePages huge_pages = HugePages::Off;
+    size_t threshold = size_t{2} << 20;   // smaller allocations take the normal path
+    bool prefault = false;
+    int numa_node = -1;                   // -1: no binding
+
+    bool operator==(const LargePageOptions&) const = default;
+};
+
+// What actually happened, over all AlignedAllocators
+struct LargePageStats {
+    static inline std::atomic<size_t> explicit_huge{0};    // MAP_HUGETLB succeeded
+    static inline std::atomic<size_t> transparent{0};      // madvise(MADV_HUGEPAGE) accepted
+    static inline std::atomic<size_t> fallbacks{0};        // Explicit requested, pool empty
+    static inline std::atomic<size_t> numa_bound{0};
+    static inline std::atomic<size_t> numa_failed{0};
+};
+
+// The mmap side of AlignedAllocator. Mappings are always a whole number of
+// 2 MiB pages starting on a 2 MiB boundary, so unmap() can recompute the
+// length from the allocation size alone.
+struct LargePageBacking {
+    static constexpr size_t kHugePage = size_t{2} << 20;
+    static constexpr size_t kSmallPage = 4096;
+
+    static size_t mapping_size(size_t bytes) {
+        return (bytes + kHugePage - 1) / kHugePage * kHugePage;
+    }
+
+#if defined(__linux__)
+    // nullptr if even a plain mapping fails
+    static void* map(size_t bytes, const LargePageOptions& options) {
+        const size_t len = mapping_size(bytes);
+        void* p = MAP_FAILED;
+
+        if (options.huge_pages == LargePageOptions::HugePages::Explicit) {
+            p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p == MAP_FAILED) {
+                LargePageStats::fallbacks++;
+            } else {
+                LargePageStats::explicit_huge++;
+            }
+        }
+
+        if (p == MAP_FAILED) {
+            // Over-map by one huge page, then trim to a 2 MiB-aligned window
+            void* raw = mmap(nullptr, len + kHugePage, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (raw == MAP_FAILED) {
+                return nullptr;
+            }
+            char* start = static_cast<char*>(raw);
+            char* aligned = reinterpret_cast<char*>(
+                (reinterpret_cast<uintptr_t>(start) + kHugePage - 1) & ~(kHugePage - 1));
+            if (aligned > start) {
+                munmap(start, static_cast<size_t>(aligned - start));
+            }
+            char* tail = aligned + len;
+            char* raw_end = start + len + kHugePage;
+            if (raw_end > tail) {
+                munmap(tail, static_cast<size_t>(raw_end - tail));
+            }
+            p = aligned;
+            if (madvise(p, len, MADV_HUGEPAGE) == 0) {
+                LargePageStats::transparent++;
+            }
+        }
+
+        if (options.numa_node >= 0) {
+            // mbind via syscall, so we need neither libnuma nor <numaif.h>
+            constexpr int kMpolBind = 2;
+            unsigned long nodemask[16] = {};
+            const auto node = static_cast<unsigned>(options.numa_node);
+            if (node < sizeof(nodemask) * 8) {
+                nodemask[node / (sizeof(unsigned long) * 8)] |= 1UL << (node % (sizeof(unsigned long) * 8));
+            }
+            if (node < sizeof(nodemask) * 8 &&
+                syscall(SYS_mbind, p, len, kMpolBind, nodemask, sizeof(nodemask) * 8, 0) == 0) {
+                LargePageStats::numa_bound++;
+            } else {
+                LargePageStats::numa_failed++;
+            }
+        }
+
+        if (options.prefault) {
+            volatile char* bytes_ptr = static_cast<volatile char*>(p);
+            for (size_t offset = 0; offset < len; offset += kSmallPage) {
+                bytes_ptr[offset] = 0;
+            }
+        }
+        return p;
+    }
+
+    static void unmap(void* p, size_t bytes) {
+        munmap(p, mapping_size(bytes));
+    }
+#endif
+};
+
+template<typename T, size_t Alignment = alignof(T)>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    static_assert(Alignment >= alignof(T),
+                  "Alignment must be at least as strict as T's natural alignment");
+    static_assert((Alignment & (Alignment - 1)) == 0,
+                  "Alignment must be a power of 2");
+
+    // Needed because Alignment is not a type parameter, so
+    // std::allocator_traits cannot rebind AlignedAllocator by itself
+    template<typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    explicit AlignedAllocator(const LargePageOptions& options) noexcept : options_(options) {}
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>& other) noexcept
+        : options_(other.options()) {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+
+        size_t bytes = n * sizeof(T);
+        void* p = nullptr;
+
+#if defined(__linux__)
+        if (use_large_pages(bytes)) {
+            p = LargePageBacking::map(bytes, options_);
+            if (!p) {
+                throw std::bad_alloc();
+            }
+            std::cout << "[AlignedAllocator] Mapped " << bytes
+                      << " bytes on 2 MiB boundaries at " << p << std::endl;
+            return static_cast<T*>(p);
+        }
+#endif
+
+        // Use aligned_alloc (C++17) or platform-specific alternatives
+        #if defined(_WIN32)
+            p = _aligned_malloc(bytes, Alignment);
+        #else
+            // aligned_alloc wants the size to be a multiple of the alignment
+            p = std::aligned_alloc(Alignment, (bytes + Alignment - 1) / Alignment * Alignment);
+        #endif
+
+        if (!p) {
+            throw std::bad_alloc();
+        }
+
+        std::cout << "[AlignedAllocator] Allocated " << bytes
+                  << " bytes with " << Alignment << "-byte alignment at "
+                  << p << std::endl;
+
+        // Verify alignment
+        if (reinterpret_cast<uintptr_t>(p) % Alignment != 0) {
+            std::cerr << "ERROR: Memory not properly aligned!" << std::endl;
+        }
+
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        std::cout << "[AlignedAllocator] Deallocating " << n * sizeof(T)
+                  << " bytes at " << p << std::endl;
+
+#if defined(__linux__)
+        if (use_large_pages(n * sizeof(T))) {
+            LargePageBacking::unmap(p, n * sizeof(T));
+            return;
+        }
+#endif
+
+        #if defined(_WIN32)
+            _aligned_free(p);
+        #else
+            std::free(p);
+        #endif
+    }
+
+    const LargePageOptions& options() const noexcept { return options_; }
+
+private:
+    LargePageOptions options_;
+
+    // Same answer in allocate() and deallocate() for the same size, which is
+    // how deallocate() knows to munmap
+    bool use_large_pages(size_t bytes) const {
+        return options_.huge_pages != LargePageOptions::HugePages::Off &&
+               bytes >= options_.threshold &&
+               Alignment <= LargePageBacking::kHugePage;
+    }
+};
+
+// Equal allocators must be able to free each other's memory, so the
+// large-page options have to match, not just the alignment
+template<typename T, size_t A1, typename U, size_t A2>
+bool operator==(const AlignedAllocator<T, A1>& a, const AlignedAllocator<U, A2>& b) {
+    return A1 == A2 && a.options() == b.options();
+}
+
+template<typename T, size_t A1, typename U, size_t A2>
+bool operator!=(const AlignedAllocator<T, A1>& a, const AlignedAllocator<U, A2>& b) {
+    return !(a == b);
+}
+
+// =============================================================================
+// Example 5: Thread-Safe Pool Allocator
+// Per-thread magazines of free slots in front of a shared, mutex-protected depot
+// =============================================================================
+
+// The original design: one pool, one mutex. Every allocate and deallocate
+// takes the lock, so all threads serialize on it. Kept (minus the logging)
+// as a baseline for benchmark_thread_safe_pools().
+template<typename T, size_t PoolSize = 1024>
+class MutexPoolAllocator {
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    alignas(T) char pool[PoolSize * sizeof(T)];
+    FreeNode* free_list;
+    size_t allocated_count;
+    mutable std::mutex mutex;
+
+public:
+    using value_type = T;
+
+    MutexPoolAllocator() noexcept : free_list(nullptr), allocated_count(0) {
+        for (size_t i = 0; i < PoolSize; ++i) {
+            FreeNode* node = reinterpret_cast<FreeNode*>(pool + i * sizeof(T));
+            node->next = free_list;
+            free_list = node;
+        }
+    }
+
+    MutexPoolAllocator(const MutexPoolAllocator&) = delete;
+    MutexPoolAllocator& operator=(const MutexPoolAllocator&) = delete;
+
+    T* allocate(std::size_t n) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (n != 1) {
+            throw std::bad_alloc();
+        }
+        if (!free_list) {
+            void* p = std::malloc(sizeof(T));
+            if (!p) throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+        FreeNode* node = free_list;
+        free_list = node->next;
+        allocated_count++;
+        return reinterpret_cast<T*>(node);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (n != 1) return;
+        char* ptr = reinterpret_cast<char*>(p);
+        if (ptr >= pool && ptr < pool + PoolSize * sizeof(T)) {
+            FreeNode* node = reinterpret_cast<FreeNode*>(p);
+            node->next = free_list;
+            free_list = node;
+            allocated_count--;
+        } else {
+            std::free(p);
+        }
+    }
+
+    size_t get_allocated_count() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return allocated_count;
+    }
+};
+
+// Slot store behind ThreadSafePoolAllocator, after Bonwick's magazine
+// allocator. A magazine is a batch of up to MagazineSize free slots,
+// linked through the slots themselves.
+//
+// Each thread has a `loaded` and a `previous` magazine. allocate() pops from
+// loaded and deallocate() pushes onto it - thread-local, no atomics, no lock.
+// Only when loaded runs empty (or full) does the thread swap in previous,
+// and only when both are empty (or full) does it visit the shared depot,
+// under its mutex, to exchange a whole magazine at once. Keeping two
+// magazines stops a thread that hovers around the boundary from hitting
+// the depot on every call.
+//
+// Remote frees - slot allocated on one thread, freed on another - need no
+// special path: slots are not owned by threads, only by the depot's slabs.
+// A consumer thread's magazines fill up with the producer's slots and flow
+// back through the depot as full magazines, which the producer picks up
+// again. When a thread exits its magazines go back to the depot.
+//
+// Slabs are released only when the depot is destroyed. There is one depot
+// per slot size and alignment (shared()), and it lives until program exit.
+// Counters summed over every MagazineDepot (one depot per slot size, and
+// containers rebind to their node type, so per-depot numbers are awkward)
+struct MagazineDepotStats {
+    static inline std::atomic<size_t> depot_visits{0};
+    static inline std::atomic<size_t> slabs{0};
+};
+
+// Mutex guards the depot (ProfiledMutex from profiled_mutex.hpp shows how
+// often threads queue up for it); it is taken once per magazine, not per slot
+template<size_t SlotSize, size_t SlotAlign, size_t SlabSlots = 1024, size_t MagazineSize = 64,
+         typename Mutex = std::mutex>
+class MagazineDepot {
+private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    static_assert(SlotSize >= sizeof(FreeNode) && SlotSize % SlotAlign == 0,
+                  "slots must hold a free-list link and keep their alignment");
+
+    struct Magazine {
+        FreeNode* head = nullptr;
+        size_t count = 0;
+
+        void push(void* p) {
+            FreeNode* node = static_cast<FreeNode*>(p);
+            node->next = head;
+            head = node;
+            count++;
+        }
+
+        void* pop() {
+            FreeNode* node = head;
+            head = node->next;
+            count--;
+            return node;
+        }
+    };
+
+    // Per-thread magazines; gives them back to the depot at thread exit
+    struct ThreadCache {
+        Magazine loaded;
+        Magazine previous;
+
+        ~ThreadCache() {
+            shared().give_back(loaded);
+            shared().give_back(previous);
+        }
+    };
+
+    Mutex mutex = mutex_profile::make_mutex<Mutex>("MagazineDepot");
+    std::vector<Magazine> full;        // magazines with free slots, guarded by mutex
+    std::vector<void*> slabs;          // guarded by mutex
+    char* tail = nullptr;              // carving point in the newest slab
+    char* tail_end = nullptr;
+
+    MagazineDepot() = default;
+
+    static ThreadCache& cache() {
+        static thread_local ThreadCache tc;
+        return tc;
+    }
+
+    // Refill an empty magazine: a full one from the depot, or fresh slots
+    // carved from a slab
+    void refill(Magazine& mag) {
+        MagazineDepotStats::depot_visits.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<Mutex> lock(mutex);
+        if (!full.empty()) {
+            mag = full.back();
+            full.pop_back();
+            return;
+        }
+        for (size_t i = 0; i < MagazineSize; ++i) {
+            if (tail == tail_end) {
+                void* slab = ::operator new(SlabSlots * SlotSize, std::align_val_t(SlotAlign));
+                slabs.push_back(slab);
+                MagazineDepotStats::slabs.fetch_add(1, std::memory_order_relaxed);
+                tail = static_cast<char*>(slab);
+                tail_end = tail + SlabSlots * SlotSize;
+            }
+            mag.push(tail);
+            tail += SlotSize;
+        }
+    }
+
+    void give_back(Magazine& mag) {
+        if (mag.count == 0) {
+            return;
+        }
+        MagazineDepotStats::depot_visits.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<Mutex> lock(mutex);
+        full.push_back(mag);
+        mag = Magazine{};
+    }
+
+public:
+    MagazineDepot(const MagazineDepot&) = delete;
+    MagazineDepot& operator=(const MagazineDepot&) = delete;
+
+    ~MagazineDepot() {
+        for (void* slab : slabs) {
+            ::operator delete(slab, std::align_val_t(SlotAlign));
+        }
+    }
+
+    static MagazineDepot& shared() {
+        static MagazineDepot depot;
+        return depot;
+    }
+
+    void* allocate() {
+        ThreadCache& tc = cache();
+        if (tc.loaded.count == 0) {
+            if (tc.previous.count > 0) {
+                std::swap(tc.loaded, tc.previous);
+            } else {
+                refill(tc.loaded);
+            }
+        }
+        return tc.loaded.pop();
+    }
+
+    void deallocate(void* p) noexcept {
+        ThreadCache& tc = cache();
+        if (tc.loaded.count == MagazineSize) {
+            if (tc.previous.count == 0) {
+                std::swap(tc.loaded, tc.previous);
+            } else {
+                give_back(tc.previous);
+                std::swap(tc.loaded, tc.previous);
+            }
+        }
+        tc.loaded.push(p);
+    }
+};
+
+// The allocator is stateless: all ThreadSafePoolAllocators for the same slot
+// size share one depot, so copies, rebound copies and different threads can
+// all free each other's memory. Single objects come from the depot; arrays
+// (n != 1, e.g. vector storage) go to operator new.
+template<typename T, size_t PoolSize = 1024, typename Mutex = std::mutex>
+class ThreadSafePoolAllocator {
+public:
+    using value_type = T;
+
+    // Slots hold a T or a free-list link, whichever is bigger, and stay
+    // aligned for T
+    static constexpr size_t kSlotAlign = alignof(T) > alignof(void*) ? alignof(T) : alignof(void*);
+    static constexpr size_t kSlotSize =
+        ((sizeof(T) > sizeof(void*) ? sizeof(T) : sizeof(void*)) + kSlotAlign - 1) / kSlotAlign * kSlotAlign;
+    using Depot = MagazineDepot<kSlotSize, kSlotAlign, PoolSize, 64, Mutex>;
+
+    template<typename U>
+    struct rebind {
+        using other = ThreadSafePoolAllocator<U, PoolSize, Mutex>;
+    };
+
+    ThreadSafePoolAllocator() noexcept = default;
+
+    template<typename U>
+    ThreadSafePoolAllocator(const ThreadSafePoolAllocator<U, PoolSize, Mutex>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n == 1) {
+            return static_cast<T*>(Depot::shared().allocate());
+        }
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (n == 1) {
+            Depot::shared().deallocate(p);
+        } else {
+            ::operator delete(p, std::align_val_t(alignof(T)));
+        }
+    }
+};
+
+template<typename T, size_t P1, typename U, size_t P2, typename M>
+bool operator==(const ThreadSafePoolAllocator<T, P1, M>&, const ThreadSafePoolAllocator<U, P2, M>&) {
+    return P1 == P2;
+}
+
+template<typename T, size_t P1, typename U, size_t P2, typename M>
+bool operator!=(const ThreadSafePoolAllocator<T, P1, M>&, const ThreadSafePoolAllocator<U, P2, M>&) {
+    return P1 != P2;
+}
+
+// =============================================================================
+// Example 6: Sophisticated Memory Tracking Allocator
+// Tracks detailed allocation info including call stacks, sizes, and statistics
+// =============================================================================
+
+template<typename T>
+class DetailedTrackingAllocator {
+private:
+    struct AllocationInfo {
+        void* address;
+        size_t size;
+        size_t count;
+        std::chrono::steady_clock::time_point timestamp;
+
+        AllocationInfo(void* addr, size_t sz, size_t cnt)
+            : address(addr), size(sz), count(cnt),
+              timestamp(std::chrono::steady_clock::now()) {}
+    };
+
+    static inline std::map<void*, AllocationInfo> allocations;
+    static inline std::mutex allocations_mutex;
+
+    // Statistics: written under allocations_mutex, atomic so that
+    // register_metrics() can read them without taking it
+    static inline std::atomic<size_t> total_allocations{0};
+    static inline std::atomic<size_t> total_deallocations{0};
+    static inline std::atomic<size_t> peak_memory{0};
+    static inline std::atomic<size_t> current_memory{0};
+    static inline std::atomic<size_t> total_bytes_allocated{0};
+    static inline std::atomic<size_t> total_bytes_deallocated{0};
+
+public:
+    using value_type = T;
+
+    DetailedTrackingAllocator() noexcept = default;
+
+    template<typename U>
+    DetailedTrackingAllocator(const DetailedTrackingAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+
+        size_t bytes = n * sizeof(T);
+        void* p = std::malloc(bytes);
+
+        if (!p) {
+            throw std::bad_alloc();
+        }
+
+        // Record allocation
+        {
+            std::lock_guard<std::mutex> lock(allocations_mutex);
+
+            allocations.emplace(p, AllocationInfo(p, bytes, n));
+
+            total_allocations.fetch_add(1, std::memory_order_relaxed);
+            const size_t current = current_memory.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            total_bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+
+            if (current > peak_memory.load(std::memory_order_relaxed)) {
+                peak_memory.store(current, std::memory_order_relaxed);
+            }
+
+            // Logged, not printed: a console write per allocation under
+            // allocations_mutex would serialize every allocating thread
+            AsyncLogger::global().log("[DetailedTracker] ALLOC: ", padded(bytes, 10),
+                                      " bytes (", padded(n, 6), " objects) at ",
+                                      p, " | Current: ", current,
+                                      " bytes in ", allocations.size(), " blocks\n");
+        }
+
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        size_t bytes = n * sizeof(T);
+
+        {
+            std::lock_guard<std::mutex> lock(allocations_mutex);
+
+            auto it = allocations.find(p);
+            if (it != allocations.end()) {
+                auto duration = std::chrono::steady_clock::now() - it->second.timestamp;
+                auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+
+                AsyncLogger::global().log("[DetailedTracker] DEALLOC: ", padded(bytes, 10),
+                                          " bytes (", padded(n, 6), " objects) at ",
+                                          p, " | Lived: ", ms, " ms | Current: ",
+                                          current_memory.load(std::memory_order_relaxed) - bytes, " bytes\n");
+
+                current_memory.fetch_sub(bytes, std::memory_order_relaxed);
+                total_bytes_deallocated.fetch_add(bytes, std::memory_order_relaxed);
+                allocations.erase(it);
+            } else {
+                std::cerr << "[DetailedTracker] WARNING: Deallocating unknown pointer "
+                          << p << std::endl;
+            }
+
+            total_deallocations.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::free(p);
+    }
+
+    static void print_detailed_report() {
+        AsyncLogger::global().flush();      // the ALLOC/DEALLOC lines come first
+        std::lock_guard<std::mutex> lock(allocations_mutex);
+
+        std::cout << "\n" << std::string(70, '=') << std::endl;
+        std::cout << "DETAILED MEMORY TRACKING REPORT" << std::endl;
+        std::cout << std::string(70, '=') << std::endl;
+
+        std::cout << "\nAllocation Statistics:" << std::endl;
+        std::cout << "  Total allocations:     " << total_allocations << std::endl;
+        std::cout << "  Total deallocations:   " << total_deallocations << std::endl;
+        std::cout << "  Leaked allocations:    " << (total_allocations - total_deallocations) << std::endl;
+        std::cout << "  Total bytes allocated: " << total_bytes_allocated << " bytes" << std::endl;
+        std::cout << "  Total bytes freed:     " << total_bytes_deallocated << " bytes" << std::endl;
+        std::cout << "  Peak memory usage:     " << peak_memory << " bytes" << std::endl;
+        std::cout << "  Current memory usage:  " << current_memory << " bytes" << std::endl;
+
+        if (!allocations.empty()) {
+            std::cout << "\nActive Allocations (" << allocations.size() << "):" << std::endl;
+            std::cout << std::string(70, '-') << std::endl;
+
+            for (const auto& [addr, info] : allocations) {
+                auto duration = std::chrono::steady_clock::now() - info.timestamp;
+                auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+
+                std::cout << "  Address: " << addr
+                          << " | Size: " << std::setw(8) << info.size << " bytes"
+                          << " | Count: " << std::setw(6) << info.count
+                          << " | Age: " << std::setw(6) << ms << " ms"
+                          << std::endl;
+            }
+        }
+
+        std::cout << std::string(70, '=') << std::endl;
+    }
+
+    /**
+     * Publishes the statistics of this allocator type under `name` (e.g.
+     * "vector_int"); keep the Registration alive as long as they should be scraped
+     */
+    static metrics::Registration register_metrics(metrics::Registry& registry, std::string name) {
+        return registry.add_collector([name = std::move(name)](metrics::Exposition& out) {
+            const std::string labels = "allocator=\"" + name + "\"";
+            out.counter("allocator_allocations_total", "Allocations", labels,
+                        static_cast<double>(total_allocations.load(std::memory_order_relaxed)));
+            out.counter("allocator_deallocations_total", "Deallocations", labels,
+                        static_cast<double>(total_deallocations.load(std::memory_order_relaxed)));
+            out.counter("allocator_allocated_bytes_total", "Bytes allocated", labels,
+                        static_cast<double>(total_bytes_allocated.load(std::memory_order_relaxed)));
+            out.counter("allocator_freed_bytes_total", "Bytes freed", labels,
+                        static_cast<double>(total_bytes_deallocated.load(std::memory_order_relaxed)));
+            out.gauge("allocator_live_bytes", "Bytes currently allocated", labels,
+                      static_cast<double>(current_memory.load(std::memory_order_relaxed)));
+            out.gauge("allocator_peak_bytes", "Highest live bytes since the last reset", labels,
+                      static_cast<double>(peak_memory.load(std::memory_order_relaxed)));
+        });
+    }
+
+    static void reset_stats() {
+        std::lock_guard<std::mutex> lock(allocations_mutex);
+        total_allocations = 0;
+        total_deallocations = 0;
+        peak_memory = 0;
+        current_memory = 0;
+        total_bytes_allocated = 0;
+        total_bytes_deallocated = 0;
+        allocations.clear();
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const DetailedTrackingAllocator<T>&, const DetailedTrackingAllocator<U>&) {
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const DetailedTrackingAllocator<T>&, const DetailedTrackingAllocator<U>&) {
+    return false;
+}
+
+// =============================================================================
+// Example 7: Sampling Heap Profiler
+// Always-on alternative to DetailedTrackingAllocator: records roughly one
+// allocation per sample_interval bytes instead of every allocation
+// =============================================================================
+
+// Process-wide profiler behind SamplingTrackingAllocator.
+//
+// Per allocation the cost is a malloc, a few relaxed atomic adds for the
+// statistics and a thread-local countdown. Only when a thread's countdown
+// of allocated bytes runs out is the allocation sampled. Countdowns are
+// drawn from an exponential distribution with mean sample_interval (as
+// tcmalloc does), so every byte is equally likely to be sampled whatever
+// the allocation sizes, and each sample stands for 1 / (1 - e^(-size/N))
+// allocations of its size.
+//
+// Samples live in per-thread buffers. Only the owning thread fills a
+// buffer, and frees from any thread just flip the sample's state, so there
+// is no shared lock on any path. The small per-buffer flag is contended
+// only while dump() copies that buffer out.
+//
+// To find its sample on free, every block carries a small header with the
+// sample pointer (null for the unsampled majority), so deallocate() needs no
+// lookup. That costs one max_align_t of memory per block.
+class HeapProfiler {
+public:
+    struct Totals {
+        size_t current_bytes;
+        size_t peak_bytes;
+        size_t total_bytes;
+        size_t total_allocations;
+        size_t samples;
+        size_t live_samples;
+    };
+
+    static void set_sample_interval(size_t bytes) {
+        sample_interval.store(bytes > 0 ? bytes : 1, std::memory_order_relaxed);
+    }
+
+    static Totals totals() {
+        size_t live = 0;
+        for_each_live([&](const Sample&) { live++; });
+        Totals t;
+        t.current_bytes = current_bytes.load(std::memory_order_relaxed);
+        t.peak_bytes = peak_bytes.load(std::memory_order_relaxed);
+        t.total_bytes = total_bytes.load(std::memory_order_relaxed);
+        t.total_allocations = total_allocations.load(std::memory_order_relaxed);
+        t.samples = samples_taken.load(std::memory_order_relaxed);
+        t.live_samples = live;
+        return t;
+    }
+
+    // Live sampled allocations grouped by type and size, with estimated
+    // totals, largest first
+    static void dump(std::ostream& out = std::cout) {
+        struct Group {
+            size_t samples = 0;
+            double estimated_count = 0.0;
+            std::vector<const void*> call_sites;
+        };
+        std::map<std::pair<std::string, size_t>, Group> groups;
+        for_each_live([&](const Sample& s) {
+            Group& g = groups[{type_name(*s.type), s.size}];
+            g.samples++;
+            g.estimated_count += s.weight;
+            if (g.call_sites.size() < 3) {
+                g.call_sites.push_back(s.call_site);
+            }
+        });
+
+        std::vector<std::pair<const std::pair<std::string, size_t>*, const Group*>> sorted;
+        for (const auto& [key, group] : groups) {
+            sorted.emplace_back(&key, &group);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+            return a.second->estimated_count * a.first->second > b.second->estimated_count * b.first->second;
+        });
+
+        const Totals t = totals();
+        out << "\n" << std::string(70, '=') << "\n";
+        out << "SAMPLED HEAP PROFILE (1 sample per ~" << sample_interval.load() << " bytes)\n";
+        out << std::string(70, '=') << "\n";
+        out << "  Current: " << t.current_bytes << " bytes, peak: " << t.peak_bytes
+            << " bytes, total: " << t.total_bytes << " bytes in " << t.total_allocations
+            << " allocations\n";
+        out << "  Samples: " << t.samples << " taken, " << t.live_samples << " live\n\n";
+        out << std::left << std::setw(32) << "  type" << std::right << std::setw(10) << "size"
+            << std::setw(9) << "samples" << std::setw(12) << "~count" << std::setw(14) << "~bytes"
+            << "  call sites\n";
+        for (const auto& [key, group] : sorted) {
+            std::string name = key->first;
+            if (name.size() > 29) {
+                name = name.substr(0, 26) + "...";
+            }
+            out << "  " << std::left << std::setw(30) << name << std::right
+                << std::setw(10) << key->second << std::setw(9) << group->samples
+                << std::setw(12) << static_cast<size_t>(group->estimated_count)
+                << std::setw(14) << static_cast<size_t>(group->estimated_count * key->second) << " ";
+            for (const void* site : group->call_sites) {
+                out << " " << site;
+            }
+            out << "\n";
+        }
+#if defined(__cpp_lib_stacktrace)
+        // One stack of the top group: for_each_live() cannot stop early, so
+        // the callback skips every match after the first
+        if (!sorted.empty()) {
+            bool printed = false;
+            for_each_live([&](const Sample& s) {
+                if (!printed && s.size == sorted.front().first->second) {
+                    out << "\n  Stack of one " << s.size << "-byte sample:\n" << s.trace << "\n";
+                    printed = true;
+                }
+            });
+        }
+#endif
+        out << std::string(70, '=') << "\n";
+    }
+
+    // Used by SamplingTrackingAllocator
+    static constexpr size_t kHeader = alignof(std::max_align_t);
+
+    static void* allocate(size_t bytes, const std::type_info& type, const void* call_site) {
+        void* raw = std::malloc(kHeader + bytes);
+        if (!raw) {
+            throw std::bad_alloc();
+        }
+        const size_t now = current_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = peak_bytes.load(std::memory_order_relaxed);
+        while (now > peak && !peak_bytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+        }
+        total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        total_allocations.fetch_add(1, std::memory_order_relaxed);
+
+        Sample* sample = nullptr;
+        if (static_cast<int64_t>(bytes) >= bytes_until_sample) {
+            sample = sample_slow_path(bytes, type, call_site);
+        } else {
+            bytes_until_sample -= static_cast<int64_t>(bytes);
+        }
+        *static_cast<Sample**>(raw) = sample;
+        return static_cast<char*>(raw) + kHeader;
+    }
+
+    static void deallocate(void* p, size_t bytes) noexcept {
+        void* raw = static_cast<char*>(p) - kHeader;
+        if (Sample* sample = *static_cast<Sample**>(raw)) {
+            sample->live.store(false, std::memory_order_release);
+        }
+        current_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        std::free(raw);
+    }
+
+private:
+    struct Sample {
+        std::atomic<bool> live{false};
+        size_t size = 0;
+        double weight = 0.0;   // allocations this sample stands for
+        const std::type_info* type = nullptr;
+        const void* call_site = nullptr;
+#if defined(__cpp_lib_stacktrace)
+        std::stacktrace trace;
+#endif
+    };
+
+    // Fixed-size block of samples; threads own one at a time
+    struct SampleBuffer {
+        static constexpr size_t kSamples = 256;
+
+        std::atomic_flag busy = ATOMIC_FLAG_INIT;   // owner writing / dump reading
+        std::atomic<bool> owned{true};
+        Sample samples[kSamples];
+        size_t cursor = 0;
+        SampleBuffer* next = nullptr;               // registry link, set once
+
+        void lock() {
+            while (busy.test_and_set(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+        void unlock() { busy.clear(std::memory_order_release); }
+    };
+
+    // Slow-path state; the countdown itself is a separate, trivially
+    // initialized thread_local so the fast path needs no TLS init guard
+    struct ThreadState {
+        std::minstd_rand rng;
+        SampleBuffer* buffer = nullptr;
+        bool started = false;
+
+        ThreadState()
+            : rng(static_cast<unsigned>(std::hash<std::thread::id>{}(std::this_thread::get_id()))) {}
+
+        // The buffer's live samples stay visible to dump(); another thread
+        // may take the buffer over once they are freed
+        ~ThreadState() {
+            if (buffer) {
+                buffer->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    static inline std::atomic<size_t> sample_interval{512 * 1024};
+    static inline std::atomic<size_t> current_bytes{0};
+    static inline std::atomic<size_t> peak_bytes{0};
+    static inline std::atomic<size_t> total_bytes{0};
+    static inline std::atomic<size_t> total_allocations{0};
+    static inline std::atomic<size_t> samples_taken{0};
+    static inline std::atomic<SampleBuffer*> buffers{nullptr};   // lock-free push-only registry
+
+    static inline thread_local int64_t bytes_until_sample = 0;
+
+    static ThreadState& thread_state() {
+        static thread_local ThreadState ts;
+        return ts;
+    }
+
+    // Countdown ran out: sample this allocation and draw the next countdown.
+    // A thread's first allocation only starts its countdown.
+    static Sample* sample_slow_path(size_t bytes, const std::type_info& type, const void* call_site) {
+        ThreadState& ts = thread_state();
+        Sample* sample = nullptr;
+        if (ts.started) {
+            sample = take_sample(ts, bytes, type, call_site);
+        }
+        ts.started = true;
+        bytes_until_sample = next_countdown(ts);
+        return sample;
+    }
+
+    static int64_t next_countdown(ThreadState& ts) {
+        const double u = (static_cast<double>(ts.rng() - ts.rng.min()) + 1.0) /
+                         (static_cast<double>(ts.rng.max() - ts.rng.min()) + 2.0);
+        return static_cast<int64_t>(-std::log(u) * static_cast<double>(sample_interval.load(std::memory_order_relaxed))) + 1;
+    }
+
+    // An unowned buffer from an exited thread, or a new one
+    static SampleBuffer* acquire_buffer() {
+        for (SampleBuffer* b = buffers.load(std::memory_order_acquire); b; b = b->next) {
+            bool expected = false;
+            if (!b->owned.load(std::memory_order_relaxed) &&
+                b->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return b;
+            }
+        }
+        SampleBuffer* b = new SampleBuffer;
+        SampleBuffer* head = buffers.load(std::memory_order_relaxed);
+        do {
+            b->next = head;
+        } while (!buffers.compare_exchange_weak(head, b, std::memory_order_release, std::memory_order_relaxed));
+        return b;
+    }
+
+    static Sample* take_sample(ThreadState& ts, size_t bytes, const std::type_info& type, const void* call_site) {
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            if (!ts.buffer) {
+                ts.buffer = acquire_buffer();
+            }
+            SampleBuffer& buf = *ts.buffer;
+            // Next free record, starting where the last search stopped
+            for (size_t i = 0; i < SampleBuffer::kSamples; ++i) {
+                Sample& s = buf.samples[(buf.cursor + i) % SampleBuffer::kSamples];
+                if (!s.live.load(std::memory_order_acquire)) {
+                    buf.cursor = (buf.cursor + i + 1) % SampleBuffer::kSamples;
+                    buf.lock();
+                    s.size = bytes;
+                    s.weight = 1.0 / (1.0 - std::exp(-static_cast<double>(bytes) /
+                                                     static_cast<double>(sample_interval.load(std::memory_order_relaxed))));
+                    s.type = &type;
+                    s.call_site = call_site;
+#if defined(__cpp_lib_stacktrace)
+                    s.trace = std::stacktrace::current(2, 8);
+#endif
+                    s.live.store(true, std::memory_order_release);
+                    buf.unlock();
+                    samples_taken.fetch_add(1, std::memory_order_relaxed);
+                    return &s;
+                }
+            }
+            // Full of live samples: hand it back and try another buffer
+            buf.owned.store(false, std::memory_order_release);
+            ts.buffer = nullptr;
+        }
+        return nullptr;
+    }
+
+    template<typename F>
+    static void for_each_live(F&& f) {
+        for (SampleBuffer* b = buffers.load(std::memory_order_acquire); b; b = b->next) {
+            b->lock();
+            for (const Sample& s : b->samples) {
+                if (s.live.load(std::memory_order_acquire)) {
+                    f(s);
+                }
+            }
+            b->unlock();
+        }
+    }
+
+    static std::string type_name(const std::type_info& type) {
+#if defined(__GNUG__)
+        int status = 0;
+        std::unique_ptr<char, void (*)(void*)> demangled(
+            abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), std::free);
+        if (status == 0 && demangled) {
+            return demangled.get();
+        }
+#endif
+        return type.name();
+    }
+};
+
+template<typename T>
+class SamplingTrackingAllocator {
+public:
+    using value_type = T;
+
+    static_assert(alignof(T) <= HeapProfiler::kHeader,
+                  "over-aligned types would need a bigger header");
+
+    SamplingTrackingAllocator() noexcept = default;
+
+    template<typename U>
+    SamplingTrackingAllocator(const SamplingTrackingAllocator<U>&) noexcept {}
+
+    // noinline keeps __builtin_return_address pointing at the caller
+    [[gnu::noinline]] T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(HeapProfiler::allocate(n * sizeof(T), typeid(T), __builtin_return_address(0)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        HeapProfiler::deallocate(p, n * sizeof(T));
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const SamplingTrackingAllocator<T>&, const SamplingTrackingAllocator<U>&) {
+    return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const SamplingTrackingAllocator<T>&, const SamplingTrackingAllocator<U>&) {
+    return false;
+}
@@ -0,0 +1,472 @@
+/*
+Asynchronous batched logging (header-only, just #include it).
+Used by async_logger_demo.cpp, 101_Threads_RAII/thread_pool.hpp (safe_print),
+allocators2.hpp (DetailedTrackingAllocator) and
+137_Barriers/parallel_matrix_calculation.cpp.
+
+Printing from many threads through one mutex around std::cout makes every
+log line a critical section that holds the lock for the whole formatting
+and write, often a syscall: threads that log queue up behind each other, and
+the console becomes the bottleneck of the program being observed.
+
+AsyncLogger splits a log line into two halves:
+
+    logging thread:   format into a thread_local string, copy it with a
+                      timestamp into this thread's own byte ring, publish
+                      it with one release store - no lock, no syscall, no
+                      shared cache line
+    writer thread:    every flush interval (1 ms by default), or when asked,
+                      merge all rings by timestamp into one batch and
+                      write() it to the file descriptor - one syscall for
+                      many lines
+
+    AsyncLogger& log = AsyncLogger::global();       // stdout
+    log.log("Thread ", id, " computed sum: ", sum, "\n");
+    log.logf("{} items in {:.2f} ms\n", n, ms);     // where <format> exists
+    log.flush();                                    // everything logged so far is written
+
+log() concatenates its arguments like `(std::cout << ... << args)` does:
+strings and chars as is, numbers through std::to_chars (floating point like
+cout's default %g with 6 digits), padded(value, width) right-aligned like
+std::setw, and anything else through its operator<<. Nothing adds a
+newline. Each call is published whole, so lines never tear; lines from one
+thread stay in order, and lines from different threads come out in the
+order they were logged, except that a line published after its batch was
+taken goes into the next one.
+
+When a thread's ring is full the LogOverflow policy decides: Block waits
+for the writer to make room (no line is lost), Drop discards the line and
+counts it (the logging thread never waits). Lines longer than the ring are
+truncated. The destructor writes out everything still buffered; the
+global() logger is never destroyed, but is flushed at exit. Writing to
+stdout flushes C stdio first, so std::cout output made before a log() call
+is not overtaken by it. The writer thread does not survive fork(): a child
+process must not use a logger created before the fork.
+*/
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __has_include(<format>)
+#include <format>
+#endif
+#include <unistd.h>
+
+enum class LogOverflow {
+    Block,      // wait for room
+    Drop        // discard the line
+};
+
+// log(padded(x, 8)): x right-aligned in 8 columns, like std::setw(8) << x
+template<typename T>
+struct LogPadded {
+    const T& value;
+    size_t width;
+};
+
+template<typename T>
+LogPadded<T> padded(const T& value, size_t width) {
+    return {value, width};
+}
+
+namespace async_logger_detail {
+
+template<typename T>
+struct is_padded : std::false_type {};
+
+template<typename T>
+struct is_padded<LogPadded<T>> : std::true_type {};
+
+template<typename T>
+void append(std::string& out, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out.push_back(value ? '1' : '0');
+    } else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                         std::is_same_v<T, unsigned char>) {
+        out.push_back(static_cast<char>(value));
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        out.append(std::string_view(value));
+    } else if constexpr (std::is_integral_v<T>) {
+        char buf[24];
+        out.append(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        char buf[32];
+        out.append(buf, std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::general, 6).ptr);
+    } else if constexpr (is_padded<T>::value) {
+        const size_t start = out.size();
+        append(out, value.value);
+        if (out.size() - start < value.width) {
+            out.insert(start, value.width - (out.size() - start), ' ');
+        }
+    } else {
+        thread_local std::ostringstream os;
+        os.str({});
+        os.clear();
+        os << value;
+        out.append(os.view());
+    }
+}
+
+} // namespace async_logger_detail
+
+class AsyncLogger {
+    // One producer (the owning thread), one consumer (the writer thread)
+    struct Ring {
+        explicit Ring(size_t bytes) : data(std::make_unique<char[]>(bytes)), mask(bytes - 1) {}
+
+        std::unique_ptr<char[]> data;
+        size_t mask;
+        alignas(64) std::atomic<uint64_t> head{0};      // written by the producer
+        uint64_t cached_tail = 0;                       // producer's last view of tail
+        std::atomic<uint64_t> lines{0};
+        std::atomic<uint64_t> dropped{0};
+        alignas(64) std::atomic<uint64_t> tail{0};      // written by the consumer
+        std::atomic<bool> retired{false};               // owning thread has exited
+    };
+
+    // This thread's rings, one per logger it has used
+    struct ThreadRings {
+        std::vector<std::pair<uint64_t, std::shared_ptr<Ring>>> rings;
+
+        ~ThreadRings() {
+            for (auto& [id, ring] : rings) {
+                ring->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+public:
+    struct Stats {
+        uint64_t lines = 0;         // published by log()/logf()
+        uint64_t dropped = 0;       // discarded under LogOverflow::Drop
+        uint64_t bytes = 0;         // written to the file descriptor
+        uint64_t batches = 0;       // write() batches
+    };
+
+    explicit AsyncLogger(int fd = STDOUT_FILENO, LogOverflow overflow = LogOverflow::Block,
+                         size_t ring_bytes = 64 * 1024,
+                         std::chrono::microseconds flush_interval = std::chrono::milliseconds(1))
+        : m_fd(fd), m_overflow(overflow), m_ring_bytes(std::bit_ceil(std::max<size_t>(ring_bytes, 256))),
+          m_flush_interval(flush_interval), m_id(next_id()) {
+        m_batch.reserve(kBatchBytes + m_ring_bytes);
+        m_writer = std::thread([this] { run(); });
+    }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Writes out what is buffered; no thread may still be logging to it
+    ~AsyncLogger() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_writer.join();
+    }
+
+    // Logs to stdout; lives until the process exits, flushed by atexit
+    static AsyncLogger& global() {
+        static AsyncLogger* instance = [] {
+            auto* logger = new AsyncLogger();
+            std::atexit([] { global().flush(); });
+            return logger;
+        }();
+        return *instance;
+    }
+
+    // Appends the arguments, as (std::cout << ... << args) would print them
+    // @return false if the line was dropped (LogOverflow::Drop, ring full)
+    template<typename... Args>
+    bool log(const Args&... args) {
+        std::string& line = scratch();
+        line.clear();
+        (async_logger_detail::append(line, args), ...);
+        return publish(line);
+    }
+
+#if defined(__cpp_lib_format)
+    template<typename... Args>
+    bool logf(std::format_string<Args...> fmt, Args&&... args) {
+        std::string& line = scratch();
+        line.clear();
+        std::format_to(std::back_inserter(line), fmt, std::forward<Args>(args)...);
+        return publish(line);
+    }
+#endif
+
+    // Returns once everything logged before the call has been written
+    void flush() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const uint64_t ticket = ++m_flush_requested;
+        m_wake.notify_one();
+        m_flushed.wait(lock, [&] { return m_flush_done >= ticket; });
+    }
+
+    Stats stats() const {
+        Stats s;
+        {
+            std::lock_guard<std::mutex> lock(m_rings_mutex);
+            s.lines = m_retired_lines;
+            s.dropped = m_retired_dropped;
+            for (const auto& ring : m_rings) {
+                s.lines += ring->lines.load(std::memory_order_relaxed);
+                s.dropped += ring->dropped.load(std::memory_order_relaxed);
+            }
+        }
+        s.bytes = m_bytes_written.load(std::memory_order_relaxed);
+        s.batches = m_batches.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    static constexpr size_t kBatchBytes = 64 * 1024;
+
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> id{0};
+        return id.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    static std::string& scratch() {
+        thread_local std::string line = [] {
+            std::string s;
+            s.reserve(256);
+            return s;
+        }();
+        return line;
+    }
+
+    Ring& my_ring() {
+        thread_local ThreadRings mine;
+        for (auto& [id, ring] : mine.rings) {
+            if (id == m_id) {
+                return *ring;
+            }
+        }
+        auto ring = std::make_shared<Ring>(m_ring_bytes);
+        {
+            std::lock_guard<std::mutex> lock(m_rings_mutex);
+            m_rings.push_back(ring);
+        }
+        mine.rings.emplace_back(m_id, ring);
+        return *ring;
+    }
+
+    // A record in a ring: the stamp, the size, then the text
+    static constexpr size_t kHeaderBytes = sizeof(int64_t) + sizeof(uint32_t);
+
+    static void copy_in(Ring& ring, uint64_t pos, const void* src, size_t n) {
+        const size_t offset = pos & ring.mask;
+        const size_t first = std::min(n, ring.mask + 1 - offset);
+        std::memcpy(ring.data.get() + offset, src, first);
+        std::memcpy(ring.data.get(), static_cast<const char*>(src) + first, n - first);
+    }
+
+    static void copy_out(const Ring& ring, uint64_t pos, void* dst, size_t n) {
+        const size_t offset = pos & ring.mask;
+        const size_t first = std::min(n, ring.mask + 1 - offset);
+        std::memcpy(dst, ring.data.get() + offset, first);
+        std::memcpy(static_cast<char*>(dst) + first, ring.data.get(), n - first);
+    }
+
+    bool publish(std::string_view line) {
+        Ring& ring = my_ring();
+        const size_t capacity = ring.mask + 1;
+        const auto size = static_cast<uint32_t>(std::min(line.size(), capacity - kHeaderBytes));
+        const size_t need = kHeaderBytes + size;
+        const int64_t stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        const uint64_t head = ring.head.load(std::memory_order_relaxed);
+        while (capacity - (head - ring.cached_tail) < need) {
+            ring.cached_tail = ring.tail.load(std::memory_order_acquire);
+            if (capacity - (head - ring.cached_tail) >= need) {
+                break;
+            }
+            if (m_overflow == LogOverflow::Drop) {
+                ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+            // Full: have the writer drain now rather than at its next interval
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_kick = true;
+            }
+            m_wake.notify_one();
+            ring.tail.wait(ring.cached_tail, std::memory_order_acquire);
+        }
+        copy_in(ring, head, &stamp, sizeof(stamp));
+        copy_in(ring, head + sizeof(stamp), &size, sizeof(size));
+        copy_in(ring, head + kHeaderBytes, line.data(), size);
+        ring.head.store(head + need, std::memory_order_release);
+        ring.lines.store(ring.lines.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            const uint64_t ticket = m_flush_requested;
+            const bool stopping = m_stop;
+            m_kick = false;
+            lock.unlock();
+            const size_t drained = drain();
+            lock.lock();
+            m_flush_done = ticket;
+            m_flushed.notify_all();
+            if (stopping && drained == 0) {
+                return;
+            }
+            if (drained == 0) {
+                m_wake.wait_for(lock, m_flush_interval,
+                                [&] { return m_stop || m_kick || m_flush_requested != ticket; });
+            }
+        }
+    }
+
+    // The unread part of one ring during a drain
+    struct Cursor {
+        Ring* ring;
+        uint64_t pos;
+        uint64_t end;
+        int64_t stamp = 0;
+        uint32_t size = 0;
+
+        void read_header() {
+            copy_out(*ring, pos, &stamp, sizeof(stamp));
+            copy_out(*ring, pos + sizeof(stamp), &size, sizeof(size));
+        }
+    };
+
+    // Merges every ring's published records into batches by timestamp;
+    // returns the bytes consumed
+    size_t drain() {
+        {
+            std::lock_guard<std::mutex> lock(m_rings_mutex);
+            m_snapshot = m_rings;
+        }
+        bool any_retired = false;
+        for (const auto& ring : m_snapshot) {
+            const uint64_t head = ring->head.load(std::memory_order_acquire);
+            const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            if (head != tail) {
+                m_cursors.push_back(Cursor{ring.get(), tail, head});
+                m_cursors.back().read_header();
+            }
+            any_retired |= ring->retired.load(std::memory_order_acquire);
+        }
+
+        size_t total = 0;
+        while (!m_cursors.empty()) {
+            // Few rings, so a linear scan for the oldest record
+            size_t oldest = 0;
+            for (size_t i = 1; i < m_cursors.size(); ++i) {
+                if (m_cursors[i].stamp < m_cursors[oldest].stamp) {
+                    oldest = i;
+                }
+            }
+            Cursor& c = m_cursors[oldest];
+            const size_t at = m_batch.size();
+            m_batch.resize(at + c.size);
+            copy_out(*c.ring, c.pos + kHeaderBytes, m_batch.data() + at, c.size);
+            c.pos += kHeaderBytes + c.size;
+            total += kHeaderBytes + c.size;
+            if (m_batch.size() >= kBatchBytes) {
+                write_batch();
+            }
+            if (c.pos == c.end) {
+                c.ring->tail.store(c.end, std::memory_order_release);
+                c.ring->tail.notify_all();
+                c = m_cursors.back();
+                m_cursors.pop_back();
+            } else {
+                c.read_header();
+            }
+        }
+        write_batch();
+        if (any_retired) {
+            // Forget rings whose thread has exited and that are now empty
+            std::lock_guard<std::mutex> lock(m_rings_mutex);
+            std::erase_if(m_rings, [&](const std::shared_ptr<Ring>& ring) {
+                if (!ring->retired.load(std::memory_order_acquire) ||
+                    ring->head.load(std::memory_order_acquire) != ring->tail.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+                m_retired_lines += ring->lines.load(std::memory_order_relaxed);
+                m_retired_dropped += ring->dropped.load(std::memory_order_relaxed);
+                return true;
+            });
+        }
+        m_snapshot.clear();
+        return total;
+    }
+
+    void write_batch() {
+        if (m_batch.empty()) {
+            return;
+        }
+        if (m_fd == STDOUT_FILENO) {
+            std::fflush(stdout);
+        }
+        const char* p = m_batch.data();
+        size_t left = m_batch.size();
+        while (left > 0) {
+            const ssize_t written = ::write(m_fd, p, left);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;      // nowhere to report it: the sink is the report
+            }
+            p += written;
+            left -= static_cast<size_t>(written);
+        }
+        m_bytes_written.fetch_add(m_batch.size() - left, std::memory_order_relaxed);
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+        m_batch.clear();
+    }
+
+    const int m_fd;
+    const LogOverflow m_overflow;
+    const size_t m_ring_bytes;
+    const std::chrono::microseconds m_flush_interval;
+    const uint64_t m_id;
+
+    mutable std::mutex m_rings_mutex;
+    std::vector<std::shared_ptr<Ring>> m_rings;
+    uint64_t m_retired_lines = 0;
+    uint64_t m_retired_dropped = 0;
+
+    std::mutex m_mutex;             // writer wake-ups and flush tickets
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    uint64_t m_flush_requested = 0;
+    uint64_t m_flush_done = 0;
+    bool m_kick = false;
+    bool m_stop = false;
+
+    // Writer thread only
+    std::vector<std::shared_ptr<Ring>> m_snapshot;
+    std::vector<Cursor> m_cursors;
+    std::string m_batch;
+    std::atomic<uint64_t> m_bytes_written{0};
+    std::atomic<uint64_t> m_batches{0};
+
+    std::thread m_writer;
+};
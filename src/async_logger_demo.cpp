@@ -0,0 +1,154 @@
+// g++ -std=c++20 -O2 -pthread async_logger_demo.cpp -o app
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "async_logger.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// ns per line, averaged over all threads
+template<typename LogLine>
+double ns_per_line(int threads, int lines, LogLine log_line) {
+    std::vector<std::thread> workers;
+    std::vector<double> ns(threads);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            const auto start = Clock::now();
+            for (int i = 0; i < lines; ++i) {
+                log_line(t, i);
+            }
+            ns[t] = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / lines;
+        });
+    }
+    double sum = 0;
+    for (int t = 0; t < threads; ++t) {
+        workers[t].join();
+        sum += ns[t];
+    }
+    return sum / threads;
+}
+
+// ============================================================================
+// 1. COST PER LINE ON THE LOGGING THREAD (all sinks are /dev/null)
+// ============================================================================
+void benchmarkLogging() {
+    std::cout << "\n=== ns PER LOG LINE ON THE LOGGING THREAD (" << std::thread::hardware_concurrency()
+              << " hardware threads) ===\n";
+    constexpr int kLines = 200'000;
+    std::ofstream null_stream("/dev/null");
+    std::mutex out_mutex;
+    const int null_fd = ::open("/dev/null", O_WRONLY);
+
+    for (int threads : {1, 4, 8}) {
+        const double mutex_newline = ns_per_line(threads, kLines, [&](int t, int i) {
+            std::lock_guard<std::mutex> lock(out_mutex);
+            null_stream << "worker " << t << " item " << i << " value " << i * 0.5 << "\n";
+        });
+        const double mutex_endl = ns_per_line(threads, kLines / 10, [&](int t, int i) {
+            std::lock_guard<std::mutex> lock(out_mutex);
+            null_stream << "worker " << t << " item " << i << " value " << i * 0.5 << std::endl;
+        });
+
+        double async_ns;
+        AsyncLogger::Stats stats;
+        {
+            AsyncLogger logger(null_fd, LogOverflow::Block, 256 * 1024);
+            async_ns = ns_per_line(threads, kLines, [&](int t, int i) {
+                logger.log("worker ", t, " item ", i, " value ", i * 0.5, "\n");
+            });
+            logger.flush();
+            stats = logger.stats();
+        }
+        std::cout << threads << " thread(s): mutex + ostream '\\n' " << mutex_newline << ", mutex + std::endl "
+                  << mutex_endl << ", AsyncLogger " << async_ns << "  (" << stats.lines << " lines in "
+                  << stats.batches << " write() calls)\n";
+    }
+    ::close(null_fd);
+}
+
+// ============================================================================
+// 2. OVERFLOW POLICY: a burst into a 4 KiB ring
+// ============================================================================
+void demonstrateOverflow() {
+    std::cout << "\n=== BURST OF 4 x 50k LINES INTO 4 KiB RINGS ===\n";
+    const int null_fd = ::open("/dev/null", O_WRONLY);
+    for (LogOverflow policy : {LogOverflow::Drop, LogOverflow::Block}) {
+        AsyncLogger logger(null_fd, policy, 4 * 1024);
+        const double ns = ns_per_line(4, 50'000, [&](int t, int i) {
+            logger.log("burst ", t, ' ', i, " ........................................\n");
+        });
+        logger.flush();
+        const AsyncLogger::Stats stats = logger.stats();
+        std::cout << (policy == LogOverflow::Drop ? "Drop:  " : "Block: ") << ns << " ns per line, "
+                  << stats.lines << " written, " << stats.dropped << " dropped\n";
+    }
+    ::close(null_fd);
+}
+
+// ============================================================================
+// 3. LINES STAY WHOLE AND IN ORDER PER THREAD
+// ============================================================================
+void verifyOrdering() {
+    std::cout << "\n=== 4 THREADS x 100k LINES TO A FILE ===\n";
+    const std::string path = "async_logger_demo.log";
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    {
+        AsyncLogger logger(fd, LogOverflow::Block, 16 * 1024);
+        ns_per_line(4, 100'000, [&](int t, int i) { logger.log("T", t, " #", i, " ", padded(i % 1000, 6), "\n"); });
+    }   // the destructor writes the rest
+    ::close(fd);
+
+    std::ifstream in(path);
+    std::string line;
+    std::vector<int> next(4, 0);
+    size_t lines = 0;
+    size_t bad = 0;
+    while (std::getline(in, line)) {
+        ++lines;
+        int t = -1;
+        int i = -1;
+        int tail = -1;
+        if (std::sscanf(line.c_str(), "T%d #%d %d", &t, &i, &tail) != 3 || t < 0 || t > 3 || i != next[t] ||
+            tail != i % 1000 || line.size() != line.find('#') + 1 + std::to_string(i).size() + 7) {
+            ++bad;
+            continue;
+        }
+        ++next[t];
+    }
+    std::remove(path.c_str());
+    std::cout << lines << " lines read back, " << bad << " torn or out of order\n";
+}
+
+int main() {
+    benchmarkLogging();
+    demonstrateOverflow();
+    verifyOrdering();
+
+    std::cout << "\n=== GLOBAL LOGGER ON STDOUT ===\n";
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 3; ++t) {
+        workers.emplace_back([t] {
+            AsyncLogger::global().log("worker ", t, " on thread ", std::this_thread::get_id(), ": ",
+                                      padded(t * 12.5, 8), " ms\n");
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+#if defined(__cpp_lib_format)
+    AsyncLogger::global().logf("{} workers done\n", workers.size());
+#endif
+    AsyncLogger::global().flush();
+    std::cout << "after flush()\n";
+    return 0;
+}
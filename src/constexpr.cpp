@@ -1,8 +1,18 @@
+/*
+g++ -std=c++20 -O2 constexpr.cpp -o app
+*/
+
 #include <iostream>
 #include <array>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <cmath>
 
+#include "microbench.hpp"
+#include "perfect_hash.hpp"
+
 // ============================================================================
 // C++11: INTRODUCTION OF CONSTEXPR
 // ============================================================================
@@ -126,6 +136,7 @@ class Rectangle : public Shape {
     int width_, height_;
 public:
     constexpr Rectangle(int w, int h) : width_(w), height_(h) {}
+    constexpr ~Rectangle() override {}  // user-provided: GCC rejects the defaulted one in constexpr rect below
     constexpr int area() const override { return width_ * height_; }
 };
 
@@ -173,6 +184,78 @@ void process_command(const char* cmd) {
     }
 }
 
+// process_command() trusts the hash: "stpO" has the same djb2 value as
+// "stop", so process_command("stpO") stops. Checked at compile time:
+static_assert(hash_string("stpO") == HASH_STOP);
+
+// A perfect hash over the whole keyword list, built and verified at compile
+// time (perfect_hash.hpp); find() compares the one candidate keyword
+constexpr auto COMMANDS = make_perfect_hash<3>({"start", "stop", "pause"});
+static_assert(COMMANDS.find("stop") == 1);
+static_assert(COMMANDS.find("stpO") == -1);
+
+void process_command_checked(std::string_view cmd) {
+    switch (COMMANDS.find(cmd)) {
+        case 0: std::cout << "Starting...\n"; break;
+        case 1: std::cout << "Stopping...\n"; break;
+        case 2: std::cout << "Pausing...\n"; break;
+        default: std::cout << "Unknown command\n";
+    }
+}
+
+// Shell-sized keyword set: perfect hash + handler array against the usual
+// unordered_map<string, fn> (with heterogeneous lookup, so neither side
+// builds a std::string per query). One input in eight is unknown.
+void count_hit(long& n) { ++n; }
+
+struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+constexpr std::array<std::string_view, 16> SHELL_KEYWORDS = {
+    "help", "list", "load", "unload", "send", "recv", "expect", "delay",
+    "open", "close", "baud", "flush", "reset", "status", "echo", "quit"};
+constexpr auto SHELL_COMMANDS = make_perfect_hash(SHELL_KEYWORDS);
+
+void benchmark_command_lookup() {
+    std::vector<std::string> inputs;
+    for (size_t i = 0; i < 1024; ++i) {
+        inputs.push_back(i % 8 == 7 ? "sned" + std::to_string(i) : std::string(SHELL_KEYWORDS[i % 16]));
+    }
+
+    std::array<void (*)(long&), SHELL_KEYWORDS.size()> handlers;
+    handlers.fill(&count_hit);
+    std::unordered_map<std::string, void (*)(long&), StringHash, std::equal_to<>> map;
+    for (auto keyword : SHELL_KEYWORDS) {
+        map.emplace(keyword, &count_hit);
+    }
+
+    auto perfect = microbench::run("perfect hash", inputs.size(), [&] {
+        long hits = 0;
+        for (const auto& input : inputs) {
+            const int index = SHELL_COMMANDS.find(input);
+            if (index >= 0) {
+                handlers[index](hits);
+            }
+        }
+        microbench::do_not_optimize(hits);
+    });
+    auto hashed = microbench::run("unordered_map<string, fn>", inputs.size(), [&] {
+        long hits = 0;
+        for (const auto& input : inputs) {
+            auto it = map.find(std::string_view(input));
+            if (it != map.end()) {
+                it->second(hits);
+            }
+        }
+        microbench::do_not_optimize(hits);
+    });
+    microbench::report(perfect);
+    microbench::report(hashed);
+    microbench::compare(hashed, perfect);
+}
+
 // Compile-time computation for lookup tables
 constexpr auto generate_squares() {
     std::array<int, 10> squares{};
@@ -222,6 +305,12 @@ int main() {
     std::cout << "Practical:\n";
     std::cout << "  Hash('start') = " << HASH_START << "\n";
     process_command("start");
+    std::cout << "  process_command(\"stpO\"): ";
+    process_command("stpO");
+    std::cout << "  process_command_checked(\"stpO\"): ";
+    process_command_checked("stpO");
+    std::cout << "  Perfect hash seed for 16 shell keywords: " << SHELL_COMMANDS.seed << "\n";
+    benchmark_command_lookup();
 
     std::cout << "  Squares lookup: SQUARES[5] = " << SQUARES[5] << "\n\n";
 
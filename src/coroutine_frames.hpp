@@ -0,0 +1,187 @@
+/*
+Pooled coroutine frame allocation (header-only, just #include it).
+Used by coroutines.cpp and 85_Coroutines/fibonacci.cpp.
+
+Every call to a coroutine allocates its frame with ::operator new, unless
+the compiler can prove the frame does not outlive the caller (HALO, which
+GCC does not do). For short-lived generators in a hot loop that allocation
+is most of the cost. A promise_type can take over by declaring its own
+operator new/delete; inheriting PooledFrame does that:
+
+    struct promise_type : PooledFrame { ... };
+
+Frames then come from one of two places:
+
+  - A thread-local pool of size buckets (64-byte steps up to 1 KiB). A
+    freed frame goes back on its bucket's free list, so a loop that makes
+    and drops the same generator reuses one block without touching malloc.
+    Bigger frames go straight to ::operator new.
+
+  - A caller-supplied allocator, by the leading-allocator convention: if a
+    coroutine's first two parameters are std::allocator_arg and an
+    allocator, the frame is allocated from that allocator, e.g.
+
+        Generator<int> counter(std::allocator_arg_t, ArenaAllocator<char>, int n);
+        counter(std::allocator_arg, ArenaAllocator<char>(arena), 10);
+
+    With the ArenaAllocator from allocators1.hpp a frame is a pointer bump,
+    and the frames of a whole request go away with one ArenaScope rewind.
+    The allocator is copied into the frame header, so it must be trivially
+    copyable and no bigger than a pointer (ArenaAllocator is one Arena*).
+
+operator delete only gets the pointer and size, so every frame starts with a
+16-byte header saying how to release it. A frame may be destroyed on another
+thread than the one that made it; it then joins that thread's pool.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace frame_detail {
+
+// In front of every frame; keeps the frame itself max_align_t-aligned
+struct alignas(std::max_align_t) FrameHeader {
+    void (*release)(FrameHeader* header, std::size_t total);
+    void* context;
+};
+
+constexpr std::size_t kBucketStep = 64;
+constexpr std::size_t kBucketCount = 16;           // frames up to 1 KiB
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+// Thread-local counters for the examples
+struct FramePoolStats {
+    std::size_t reused = 0;       // served from a free list
+    std::size_t fresh = 0;        // had to go to ::operator new
+};
+
+// Blocks cached for reuse, by size class. Everything touched on the fast
+// path is trivially constructible and destructible, so a thread_local
+// access is a plain TLS load with no init guard.
+inline thread_local FreeBlock* free_lists[kBucketCount];
+inline thread_local FramePoolStats thread_stats;
+// Set once the free lists have been released at thread exit: frames freed
+// after that go straight back to ::operator delete
+inline thread_local bool pool_gone;
+
+// Frees the cached blocks at thread exit. Only instantiated on the slow path
+// (the first fresh block of a thread), keeping the guard off the fast path.
+struct FramePoolReaper {
+    ~FramePoolReaper() {
+        pool_gone = true;
+        for (FreeBlock*& head : free_lists) {
+            while (head) {
+                FreeBlock* next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+        }
+    }
+};
+
+inline void arm_reaper() {
+    thread_local FramePoolReaper reaper;
+    (void)reaper;
+}
+
+inline std::size_t bucket_of(std::size_t total) {
+    return (total - 1) / kBucketStep;
+}
+
+inline void release_to_pool(FrameHeader* header, std::size_t total) {
+    const std::size_t bucket = bucket_of(total);
+    if (bucket >= kBucketCount || pool_gone) {
+        ::operator delete(header);
+        return;
+    }
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(header);
+    block->next = free_lists[bucket];
+    free_lists[bucket] = block;
+}
+
+inline void* allocate_from_pool(std::size_t size) {
+    const std::size_t total = sizeof(FrameHeader) + size;
+    const std::size_t bucket = bucket_of(total);
+    void* raw;
+    if (bucket < kBucketCount && free_lists[bucket]) {
+        FreeBlock* block = free_lists[bucket];
+        free_lists[bucket] = block->next;
+        raw = block;
+        ++thread_stats.reused;
+    } else {
+        // Round up to the bucket size so the block fits any frame of its class
+        raw = ::operator new(bucket < kBucketCount ? (bucket + 1) * kBucketStep : total);
+        ++thread_stats.fresh;
+        if (!pool_gone) {
+            arm_reaper();
+        }
+    }
+    FrameHeader* header = ::new (raw) FrameHeader{&release_to_pool, nullptr};
+    return header + 1;
+}
+
+// Frames are allocated in header-sized units, so a caller's allocator hands
+// out memory aligned for the frame (ArenaAllocator<T> aligns to alignof(T))
+inline std::size_t units_for(std::size_t total) {
+    return (total + sizeof(FrameHeader) - 1) / sizeof(FrameHeader);
+}
+
+template<typename UnitAlloc>
+void release_to_allocator(FrameHeader* header, std::size_t total) {
+    UnitAlloc alloc = [&] {
+        alignas(UnitAlloc) unsigned char storage[sizeof(UnitAlloc)];
+        std::memcpy(storage, &header->context, sizeof(UnitAlloc));
+        return *std::launder(reinterpret_cast<UnitAlloc*>(storage));
+    }();
+    std::allocator_traits<UnitAlloc>::deallocate(alloc, header, units_for(total));
+}
+
+template<typename Alloc>
+void* allocate_from_allocator(std::size_t size, const Alloc& alloc) {
+    using UnitAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<FrameHeader>;
+    static_assert(std::is_trivially_copyable_v<UnitAlloc> && sizeof(UnitAlloc) <= sizeof(void*),
+                  "frame allocators are stored in the frame header: keep them pointer-sized");
+
+    UnitAlloc unit_alloc(alloc);
+    const std::size_t total = sizeof(FrameHeader) + size;
+    FrameHeader* raw = std::allocator_traits<UnitAlloc>::allocate(unit_alloc, units_for(total));
+    FrameHeader* header = ::new (static_cast<void*>(raw)) FrameHeader{&release_to_allocator<UnitAlloc>, nullptr};
+    std::memcpy(&header->context, &unit_alloc, sizeof(UnitAlloc));
+    return header + 1;
+}
+
+}  // namespace frame_detail
+
+// Base class for a promise_type whose frames should be pooled
+struct PooledFrame {
+    static void* operator new(std::size_t size) {
+        return frame_detail::allocate_from_pool(size);
+    }
+
+    // Leading-allocator convention: f(std::allocator_arg, alloc, args...)
+    template<typename Alloc, typename... Args>
+    static void* operator new(std::size_t size, std::allocator_arg_t, const Alloc& alloc, const Args&...) {
+        return frame_detail::allocate_from_allocator(size, alloc);
+    }
+
+    static void operator delete(void* frame, std::size_t size) noexcept {
+        auto* header = static_cast<frame_detail::FrameHeader*>(frame) - 1;
+        header->release(header, sizeof(frame_detail::FrameHeader) + size);
+    }
+};
+
+// Base class for a promise_type that keeps the default ::operator new
+// (used as the baseline in the benchmarks)
+struct DefaultFrame {};
+
+// Frames served from this thread's pool so far
+inline const frame_detail::FramePoolStats& frame_pool_stats() {
+    return frame_detail::thread_stats;
+}
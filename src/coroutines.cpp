@@ -17,16 +17,31 @@
 #include <iostream>
 #include <exception>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <cstring>
+#include <bit>
+#include <vector>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "coroutine_frames.hpp"
+#include "allocators1.hpp"
 
 // ============================================================================
 // EXAMPLE 1: BASIC GENERATOR - Simple Coroutine
 // ============================================================================
 
 // The promise_type defines the coroutine's behavior
-template<typename T>
+// FrameAlloc decides where coroutine frames come from: PooledFrame reuses
+// them from a thread-local pool (see coroutine_frames.hpp and example 6),
+// DefaultFrame leaves every frame to ::operator new
+template<typename T, typename FrameAlloc = PooledFrame>
 struct Generator {
     // Promise type is required for all coroutines
-    struct promise_type {
+    struct promise_type : FrameAlloc {
         T current_value;
         std::exception_ptr exception;
 
@@ -136,11 +151,11 @@ Task async_example() {
 // EXAMPLE 4: GENERATOR WITH RETURN VALUE
 // ============================================================================
 
-template<typename T>
+template<typename T, typename FrameAlloc = PooledFrame>
 struct GeneratorWithReturn {
-    struct promise_type {
+    struct promise_type : FrameAlloc {
         T current_value;
-        std::optional<T> return_value;
+        std::optional<T> final_value;
         
         GeneratorWithReturn get_return_object() {
             return GeneratorWithReturn{
@@ -157,7 +172,7 @@ struct GeneratorWithReturn {
         }
         
         void return_value(T value) {
-            return_value = value;
+            final_value = value;
         }
         
         void unhandled_exception() { std::terminate(); }
@@ -180,7 +195,7 @@ struct GeneratorWithReturn {
     }
     
     std::optional<T> get_return() {
-        return handle.promise().return_value;
+        return handle.promise().final_value;
     }
 };
 
@@ -199,7 +214,11 @@ GeneratorWithReturn<int> squares_with_sum(int n) {
 // EXAMPLE 5: PRACTICAL USE CASE - String Tokenizer
 // ============================================================================
 
-Generator<std::string> tokenize(const std::string& str, char delimiter) {
+// Takes the string by value: the generator runs lazily, after the caller's
+// full expression is over, so a reference to a temporary would dangle.
+// Builds every token char by char and yields a copy - an allocation per
+// token. tokenize_view below is the zero-copy version.
+Generator<std::string> tokenize(std::string str, char delimiter) {
     std::string token;
     for (char c : str) {
         if (c == delimiter) {
@@ -216,6 +235,204 @@ Generator<std::string> tokenize(const std::string& str, char delimiter) {
     }
 }
 
+// Zero-copy version: yields string_views into the input, and finds each
+// delimiter with a vectorized scan instead of looking at one char at a time.
+//
+// DelimiterSet picks the scan:
+//   one delimiter       memchr (glibc's is SIMD and runs at memory bandwidth)
+//   up to 4 delimiters  SSE2: compare 16 bytes against each delimiter, OR the
+//                       masks, take the first set bit
+//   more                a 256-entry lookup table, one byte at a time
+class DelimiterSet {
+public:
+    static constexpr size_t kVectorDelimiters = 4;
+
+    explicit DelimiterSet(std::string_view delimiters) : count_(delimiters.size()) {
+        for (unsigned char c : delimiters) {
+            table_[c] = true;
+        }
+        for (size_t i = 0; i < count_ && i < kVectorDelimiters; ++i) {
+            chars_[i] = delimiters[i];
+        }
+    }
+
+    // First delimiter in [p, end), or end (always, for an empty set)
+    const char* find(const char* p, const char* end) const {
+        if (count_ == 0) {
+            return end;             // the SSE2 path would compare against unset lanes
+        }
+        if (count_ == 1) {
+            const void* hit = std::memchr(p, chars_[0], static_cast<size_t>(end - p));
+            return hit ? static_cast<const char*>(hit) : end;
+        }
+#if defined(__SSE2__)
+        if (count_ <= kVectorDelimiters) {
+            __m128i delims[kVectorDelimiters];
+            for (size_t k = 0; k < count_; ++k) {
+                delims[k] = _mm_set1_epi8(chars_[k]);
+            }
+            for (; p + 16 <= end; p += 16) {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i hit = _mm_cmpeq_epi8(chunk, delims[0]);
+                for (size_t k = 1; k < count_; ++k) {
+                    hit = _mm_or_si128(hit, _mm_cmpeq_epi8(chunk, delims[k]));
+                }
+                const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+                if (mask) {
+                    return p + std::countr_zero(mask);
+                }
+            }
+        }
+#endif
+        for (; p < end; ++p) {
+            if (table_[static_cast<unsigned char>(*p)]) {
+                return p;
+            }
+        }
+        return end;
+    }
+
+private:
+    size_t count_;
+    char chars_[kVectorDelimiters] = {};
+    bool table_[256] = {};
+};
+
+// The views point into `input`: it must outlive the generator.
+// Empty tokens (runs of delimiters) are skipped, as in tokenize().
+Generator<std::string_view> tokenize_view(std::string_view input, DelimiterSet delimiters) {
+    const char* p = input.data();
+    const char* const end = p + input.size();
+    while (p < end) {
+        const char* d = delimiters.find(p, end);
+        if (d != p) {
+            co_yield std::string_view(p, static_cast<size_t>(d - p));
+        }
+        if (d == end) {
+            break;
+        }
+        p = d + 1;
+    }
+}
+
+Generator<std::string_view> tokenize_view(std::string_view input, char delimiter) {
+    return tokenize_view(input, DelimiterSet(std::string_view(&delimiter, 1)));
+}
+
+// A log-like buffer: words of 3-12 chars, separated mostly by spaces, with
+// the occasional comma, semicolon and newline
+std::string make_log(size_t bytes) {
+    std::string log;
+    log.reserve(bytes + 16);
+    uint32_t x = 12345;
+    while (log.size() < bytes) {
+        x = x * 1664525u + 1013904223u;
+        log.append(3 + (x >> 28) % 10, static_cast<char>('a' + (x >> 20) % 26));
+        const uint32_t r = (x >> 8) % 16;
+        log.push_back(r == 0 ? '\n' : r == 1 ? ',' : r == 2 ? ';' : ' ');
+    }
+    return log;
+}
+
+template<typename MakeGenerator>
+void time_tokenizer(const char* label, size_t bytes, MakeGenerator&& make) {
+    size_t tokens = 0, token_bytes = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    auto gen = make();
+    while (gen.next()) {
+        ++tokens;
+        token_bytes += gen.value().size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "   " << label << tokens << " tokens (" << token_bytes << " bytes), "
+              << bytes / seconds / 1e9 << " GB/s\n";
+}
+
+void benchmark_tokenizers() {
+    const size_t bytes = 64 * 1024 * 1024;
+    const std::string log = make_log(bytes);
+    std::cout << "   64 MiB of log text:\n";
+    time_tokenizer("tokenize (std::string), ' ':      ", bytes, [&] { return tokenize(log, ' '); });
+    time_tokenizer("tokenize_view, ' ':               ", bytes, [&] { return tokenize_view(log, ' '); });
+    time_tokenizer("tokenize_view, \" ,;\\n\" (SSE2):    ", bytes,
+                   [&] { return tokenize_view(log, DelimiterSet(" ,;\n")); });
+    time_tokenizer("tokenize_view, 5 delims (table):  ", bytes,
+                   [&] { return tokenize_view(log, DelimiterSet(" ,;\n\t")); });
+}
+
+// ============================================================================
+// EXAMPLE 6: WHERE COROUTINE FRAMES COME FROM
+// ============================================================================
+// Each call to a coroutine allocates a frame for its locals and suspend
+// state. A short generator made and dropped in a hot loop spends most of
+// its time in that allocation, so the promise_type's operator new decides:
+//   DefaultFrame  - ::operator new / delete every time
+//   PooledFrame   - thread-local size buckets; the loop reuses one block
+//   allocator_arg - frames from the caller's allocator, here an arena
+
+template<typename FrameAlloc>
+Generator<int, FrameAlloc> short_counter(int n) {
+    for (int i = 0; i < n; ++i) {
+        co_yield i;
+    }
+}
+
+// Leading-allocator convention: the frame comes from `alloc`
+Generator<int> short_counter(std::allocator_arg_t, ArenaAllocator<char> alloc, int n) {
+    (void)alloc;
+    for (int i = 0; i < n; ++i) {
+        co_yield i;
+    }
+}
+
+template<typename MakeGenerator>
+double frames_per_second(int frames, MakeGenerator&& make) {
+    long checksum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        auto gen = make();
+        while (gen.next()) {
+            checksum += gen.value();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    if (checksum < 0) std::cout << checksum;   // keep the loop alive
+    return frames / std::chrono::duration<double>(end - start).count();
+}
+
+void benchmark_frame_allocation() {
+    const int frames = 2'000'000;
+    const int yields = 4;
+
+    double plain = frames_per_second(frames, [] { return short_counter<DefaultFrame>(yields); });
+
+    const auto before = frame_pool_stats();
+    double pooled = frames_per_second(frames, [] { return short_counter<PooledFrame>(yields); });
+    const auto after = frame_pool_stats();
+
+    // One "request" per 1000 generators: the arena is rewound at the end of
+    // each, not freed frame by frame
+    Arena arena(64 * 1024);
+    ArenaAllocator<char> alloc(arena);
+    const Arena::Mark request_start = arena.mark();
+    int made = 0;
+    double arena_rate = frames_per_second(frames, [&] {
+        if (++made == 1000) {
+            arena.rewind(request_start);
+            made = 0;
+        }
+        return short_counter(std::allocator_arg, alloc, yields);
+    });
+
+    std::cout << "   " << frames << " generators of " << yields << " values each:\n";
+    std::cout << "   ::operator new frames: " << plain / 1e6 << " M frames/s\n";
+    std::cout << "   pooled frames:         " << pooled / 1e6 << " M frames/s (" << (after.reused - before.reused)
+              << " reused, " << (after.fresh - before.fresh) << " fresh)\n";
+    std::cout << "   arena frames:          " << arena_rate / 1e6 << " M frames/s (arena holds "
+              << arena.bytes_reserved() / 1024 << " KiB)\n";
+}
+
 // ============================================================================
 // MAIN - DEMONSTRATING ALL EXAMPLES
 // ============================================================================
@@ -258,7 +475,25 @@ int main() {
     while (tokens.next()) {
         std::cout << "\"" << tokens.value() << "\" ";
     }
-    std::cout << "\n\n";
+    std::cout << "\n   Views, delimiters \" ,;\": ";
+    const std::string line = "GET /index.html, 200; 512 bytes";
+    auto views = tokenize_view(line, DelimiterSet(" ,;"));
+    while (views.next()) {
+        std::cout << "\"" << views.value() << "\" ";
+    }
+    std::cout << "\n   No delimiters at all: ";
+    auto whole = tokenize_view(line, DelimiterSet(""));
+    while (whole.next()) {
+        std::cout << "\"" << whole.value() << "\" ";
+    }
+    std::cout << "\n";
+    benchmark_tokenizers();
+    std::cout << "\n";
+    
+    // Example 6: Frame allocation
+    std::cout << "6. FRAME ALLOCATION:\n";
+    benchmark_frame_allocation();
+    std::cout << "\n";
     
     std::cout << "=== KEY CONCEPTS ===\n";
     std::cout << "• co_yield: Suspend and produce a value\n";
@@ -301,7 +536,12 @@ int main() {
  *    - Better memory efficiency than callbacks
  *    - State machine generated by compiler
  * 
- * 6. COMPILE WITH:
+ * 6. FRAME ALLOCATION:
+ *    - promise_type::operator new/delete replace the frame allocation
+ *    - An operator new(size, std::allocator_arg_t, Alloc, Args...) overload
+ *      picks up an allocator passed as the coroutine's leading arguments
+ * 
+ * 7. COMPILE WITH:
  *    g++ -std=c++20 -fcoroutines filename.cpp
  *    clang++ -std=c++20 -stdlib=libc++ filename.cpp
  *    MSVC: /std:c++20
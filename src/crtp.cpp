@@ -1,11 +1,17 @@
 /*
  * CRTP (Curiously Recurring Template Pattern)
  * A comprehensive guide with examples
+ *
+ * g++ -std=c++20 -O2 crtp.cpp -o app
  */
 
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "microbench.hpp"
 
 // ============================================================================
 // 1. BASIC CRTP PATTERN
@@ -221,13 +227,13 @@ public:
 // Virtual function approach
 class VirtualBase {
 public:
-    virtual int compute(int x) const = 0;
+    virtual unsigned compute(unsigned x) const = 0;
     virtual ~VirtualBase() = default;
 };
 
 class VirtualDerived : public VirtualBase {
 public:
-    int compute(int x) const override {
+    unsigned compute(unsigned x) const override {
         return x * x;
     }
 };
@@ -236,18 +242,54 @@ public:
 template <typename T>
 class CRTPBase {
 public:
-    int compute(int x) const {
+    unsigned compute(unsigned x) const {
         return static_cast<const T*>(this)->computeImpl(x);
     }
 };
 
 class CRTPDerived : public CRTPBase<CRTPDerived> {
 public:
-    int computeImpl(int x) const {
+    unsigned computeImpl(unsigned x) const {
         return x * x;
     }
 };
 
+// Sum of compute(i) over n calls, in unsigned arithmetic: i * i and the
+// running sum pass INT_MAX long before n, and unsigned wraps where int
+// overflow is undefined behaviour. Both sums go through do_not_optimize(),
+// so neither loop can be removed; the virtual object's pointer does too, so
+// the call cannot be devirtualized. What remains is the real difference:
+// the CRTP call inlines into the loop, and the virtual one stays an indirect
+// call per element. (With the call inlined, GCC 12 also vectorizes the
+// integer sum at -O3, though not at -O2.)
+void performanceComparison() {
+    const size_t n = 1000000;
+
+    std::unique_ptr<VirtualBase> owner = std::make_unique<VirtualDerived>();
+    const VirtualBase* vobj = owner.get();
+    microbench::do_not_optimize(vobj);
+    auto virtualResult = microbench::run("virtual compute()", n, [&] {
+        std::uint64_t sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += vobj->compute(static_cast<unsigned>(i));
+        }
+        microbench::do_not_optimize(sum);
+    });
+
+    CRTPDerived cobj;
+    auto crtpResult = microbench::run("CRTP compute()", n, [&] {
+        std::uint64_t sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += cobj.compute(static_cast<unsigned>(i));
+        }
+        microbench::do_not_optimize(sum);
+    });
+
+    microbench::report(virtualResult);
+    microbench::report(crtpResult);
+    microbench::compare(virtualResult, crtpResult);
+}
+
 // ============================================================================
 // DEMONSTRATION
 // ============================================================================
@@ -295,9 +337,10 @@ int main() {
     std::cout << "n1 < n2: " << (n1 < n2) << std::endl;
     std::cout << "n1 >= n3: " << (n1 >= n3) << std::endl;
     
-    std::cout << "\n=== 7. Performance Note ===" << std::endl;
+    std::cout << "\n=== 7. Performance Comparison ===" << std::endl;
     std::cout << "CRTP: No vtable lookup, resolved at compile-time" << std::endl;
     std::cout << "Virtual: Runtime dispatch through vtable" << std::endl;
+    performanceComparison();
     
     return 0;
 }
@@ -0,0 +1,258 @@
+/*
+Fixed-capacity type erasure (header-only, just #include it): inplace_any
+and inplace_function.
+Used by std_optional_variant_any.cpp, lambdas_closures.cpp and
+101_Threads_RAII/thread_pool.hpp (BasicTask).
+
+std::any and std::function keep small objects in an implementation-defined
+buffer (libstdc++: 16 bytes for std::function, one pointer for std::any)
+and heap-allocate everything else. A lambda capturing a std::string and an
+int is already past that, so every one of them costs a new and a delete.
+
+The two types here take their capacity as a template argument instead:
+
+    inplace_any<64> a = Payload{...};                  // up to 64 bytes
+    inplace_function<void(int), 48> f = [s, n](int) {...};
+
+The object always lives in the buffer; nothing ever allocates. Something
+that does not fit is a compile error naming the capacity to raise, not a
+silent heap fallback. Both are move-only - like std::move_only_function -
+so they can hold move-only contents (unique_ptr captures, promises, ...).
+In exchange the contents must be nothrow-movable, which keeps every move of
+the wrapper noexcept (std::vector then moves them when it grows).
+
+Dispatch goes through one constexpr table of function pointers per stored
+type, built by hand: the object holds the buffer and one pointer to that
+table. An empty object points at a table of its own, so the call path never
+tests for empty; the empty table's invoke throws std::bad_function_call.
+*/
+#pragma once
+
+#include <any>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace inplace_detail {
+
+template<typename T, size_t Size, size_t Align>
+constexpr bool fits() {
+    static_assert(sizeof(T) <= Size, "object does not fit the inline buffer: raise the Size parameter");
+    static_assert(Align % alignof(T) == 0, "object is over-aligned for the inline buffer: raise the Align parameter");
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "inline storage needs a nothrow move constructor (moves of the wrapper are noexcept)");
+    return true;
+}
+
+}  // namespace inplace_detail
+
+// =============================================================================
+// inplace_any<Size, Align>
+// =============================================================================
+
+template<size_t Size = 64, size_t Align = alignof(std::max_align_t)>
+class inplace_any {
+private:
+    struct VTable {
+        const std::type_info& (*type)() noexcept;
+        void (*relocate)(void* dst, void* src) noexcept;  // move into dst, destroy src
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename T>
+    static constexpr VTable vtable_for{
+        []() noexcept -> const std::type_info& { return typeid(T); },
+        [](void* dst, void* src) noexcept {
+            ::new (dst) T(std::move(*static_cast<T*>(src)));
+            static_cast<T*>(src)->~T();
+        },
+        [](void* storage) noexcept { static_cast<T*>(storage)->~T(); },
+    };
+
+    alignas(Align) unsigned char storage_[Size];
+    const VTable* vtable_ = nullptr;
+
+    template<typename T, size_t S, size_t A>
+    friend T* inplace_any_cast(inplace_any<S, A>* any) noexcept;
+
+public:
+    static constexpr size_t capacity = Size;
+
+    inplace_any() noexcept = default;
+
+    template<typename T>
+        requires (!std::is_same_v<std::decay_t<T>, inplace_any>)
+    inplace_any(T&& value) {
+        emplace<std::decay_t<T>>(std::forward<T>(value));
+    }
+
+    inplace_any(inplace_any&& other) noexcept : vtable_(other.vtable_) {
+        if (vtable_) {
+            vtable_->relocate(storage_, other.storage_);
+            other.vtable_ = nullptr;
+        }
+    }
+
+    inplace_any& operator=(inplace_any&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.vtable_) {
+                other.vtable_->relocate(storage_, other.storage_);
+                vtable_ = std::exchange(other.vtable_, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    inplace_any(const inplace_any&) = delete;
+    inplace_any& operator=(const inplace_any&) = delete;
+
+    ~inplace_any() { reset(); }
+
+    // Destroys the current contents and constructs a T in place
+    template<typename T, typename... Args>
+    T& emplace(Args&&... args) {
+        static_assert(inplace_detail::fits<T, Size, Align>());
+        reset();
+        T* object = ::new (static_cast<void*>(storage_)) T(std::forward<Args>(args)...);
+        vtable_ = &vtable_for<T>;
+        return *object;
+    }
+
+    void reset() noexcept {
+        if (vtable_) {
+            vtable_->destroy(storage_);
+            vtable_ = nullptr;
+        }
+    }
+
+    bool has_value() const noexcept { return vtable_ != nullptr; }
+
+    const std::type_info& type() const noexcept { return vtable_ ? vtable_->type() : typeid(void); }
+};
+
+// Pointer to the contents if they are a T, else nullptr. The check compares
+// vtable pointers: one table per stored type, so no typeid comparison
+template<typename T, size_t Size, size_t Align>
+T* inplace_any_cast(inplace_any<Size, Align>* any) noexcept {
+    using Stored = std::remove_cv_t<T>;
+    if (any && any->vtable_ == &inplace_any<Size, Align>::template vtable_for<Stored>) {
+        return std::launder(reinterpret_cast<T*>(any->storage_));
+    }
+    return nullptr;
+}
+
+template<typename T, size_t Size, size_t Align>
+const T* inplace_any_cast(const inplace_any<Size, Align>* any) noexcept {
+    return inplace_any_cast<const T>(const_cast<inplace_any<Size, Align>*>(any));
+}
+
+// Reference to the contents; throws std::bad_any_cast if they are not a T
+template<typename T, size_t Size, size_t Align>
+T& inplace_any_cast(inplace_any<Size, Align>& any) {
+    if (T* value = inplace_any_cast<T>(&any)) {
+        return *value;
+    }
+    throw std::bad_any_cast();
+}
+
+template<typename T, size_t Size, size_t Align>
+const T& inplace_any_cast(const inplace_any<Size, Align>& any) {
+    if (const T* value = inplace_any_cast<T>(&any)) {
+        return *value;
+    }
+    throw std::bad_any_cast();
+}
+
+// =============================================================================
+// inplace_function<R(Args...), Size, Align>
+// =============================================================================
+
+template<typename Signature, size_t Size = 32, size_t Align = alignof(std::max_align_t)>
+class inplace_function;
+
+template<typename R, typename... Args, size_t Size, size_t Align>
+class inplace_function<R(Args...), Size, Align> {
+private:
+    struct VTable {
+        R (*invoke)(void* storage, Args&&... args);
+        void (*relocate)(void* dst, void* src) noexcept;  // move into dst, destroy src
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template<typename F>
+    static constexpr VTable vtable_for{
+        [](void* storage, Args&&... args) -> R {
+            return std::invoke(*static_cast<F*>(storage), std::forward<Args>(args)...);
+        },
+        [](void* dst, void* src) noexcept {
+            ::new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        },
+        [](void* storage) noexcept { static_cast<F*>(storage)->~F(); },
+    };
+
+    // The empty state: calling it throws, moving or destroying it is a no-op
+    static constexpr VTable empty_vtable{
+        [](void*, Args&&...) -> R { throw std::bad_function_call(); },
+        [](void*, void*) noexcept {},
+        [](void*) noexcept {},
+    };
+
+    // mutable: like std::function, operator() is const but calls the
+    // target as a non-const lvalue, so mutable lambdas work
+    alignas(Align) mutable unsigned char storage_[Size];
+    const VTable* vtable_ = &empty_vtable;
+
+public:
+    using result_type = R;
+    static constexpr size_t capacity = Size;
+
+    inplace_function() noexcept = default;
+    inplace_function(std::nullptr_t) noexcept {}
+
+    template<typename F>
+        requires (!std::is_same_v<std::decay_t<F>, inplace_function> &&
+                  std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+    inplace_function(F&& f) {
+        using Fn = std::decay_t<F>;
+        static_assert(inplace_detail::fits<Fn, Size, Align>());
+        ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+        vtable_ = &vtable_for<Fn>;
+    }
+
+    inplace_function(inplace_function&& other) noexcept : vtable_(std::exchange(other.vtable_, &empty_vtable)) {
+        vtable_->relocate(storage_, other.storage_);
+    }
+
+    inplace_function& operator=(inplace_function&& other) noexcept {
+        if (this != &other) {
+            vtable_->destroy(storage_);
+            vtable_ = std::exchange(other.vtable_, &empty_vtable);
+            vtable_->relocate(storage_, other.storage_);
+        }
+        return *this;
+    }
+
+    inplace_function& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    inplace_function(const inplace_function&) = delete;
+    inplace_function& operator=(const inplace_function&) = delete;
+
+    ~inplace_function() { vtable_->destroy(storage_); }
+
+    void reset() noexcept {
+        vtable_->destroy(storage_);
+        vtable_ = &empty_vtable;
+    }
+
+    explicit operator bool() const noexcept { return vtable_ != &empty_vtable; }
+
+    R operator()(Args... args) const { return vtable_->invoke(storage_, std::forward<Args>(args)...); }
+};
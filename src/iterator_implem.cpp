@@ -1,23 +1,118 @@
+/*
+g++ -std=c++20 -O2 iterator_implem.cpp -o app
+*/
+
 #include <iostream>
 #include <iterator>
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Types whose objects can be moved to a new address with memcpy, leaving
+// nothing to destroy at the old one. Trivially copyable types always can;
+// many others can too (a struct holding a unique_ptr, most handles) and
+// may opt in by specializing this. std::string in libstdc++ may not: its
+// short-string buffer points into the object itself.
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
 
-// A simple dynamic array container with custom iterators
 template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// An allocator may offer reallocate(p, old_n, new_n) -> T*, which grows a
+// block in place when it can (realloc). MyVector uses it for trivially
+// relocatable elements.
+template<typename A, typename T>
+concept Reallocating = requires(A& a, T* p, size_t n) {
+    { a.reallocate(p, n, n) } -> std::same_as<T*>;
+};
+
+// A simple dynamic array container with custom iterators.
+//
+// Storage is raw memory from Alloc; only the first `length` slots hold
+// objects. Growing allocates a bigger block and relocates the elements:
+//   - trivially relocatable T: one memcpy, or a realloc() that may not move
+//     at all if the allocator supports it
+//   - otherwise: move-construct each element if T's move constructor is
+//     noexcept, copy otherwise (so a throwing copy leaves the old buffer
+//     untouched), then destroy the old ones
+template<typename T, typename Alloc = std::allocator<T>>
 class MyVector {
 private:
+    using Traits = std::allocator_traits<Alloc>;
+
+    [[no_unique_address]] Alloc alloc;
     T* data;
     size_t capacity;
     size_t length;
 
-    void resize() {
-        capacity = capacity == 0 ? 1 : capacity * 2;
-        T* newData = new T[capacity];
-        for (size_t i = 0; i < length; ++i) {
-            newData[i] = data[i];
+    // Moves the elements into a block of new_capacity slots
+    void reallocate(size_t new_capacity) {
+        if constexpr (is_trivially_relocatable_v<T> && Reallocating<Alloc, T>) {
+            data = alloc.reallocate(data, capacity, new_capacity);
+        } else {
+            T* newData = Traits::allocate(alloc, new_capacity);
+            try {
+                relocate(data, length, newData);
+            } catch (...) {
+                Traits::deallocate(alloc, newData, new_capacity);
+                throw;
+            }
+            if (data) {
+                Traits::deallocate(alloc, data, capacity);
+            }
+            data = newData;
+        }
+        capacity = new_capacity;
+    }
+
+    // Moves n elements from src to uninitialized dst and ends their lifetime
+    // at src. Strong guarantee: if a copy throws, src is left as it was and
+    // dst holds no objects.
+    void relocate(T* src, size_t n, T* dst) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (n) {
+                std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+            }
+        } else {
+            size_t built = 0;
+            try {
+                for (; built < n; ++built) {
+                    Traits::construct(alloc, dst + built, std::move_if_noexcept(src[built]));
+                }
+            } catch (...) {
+                destroy(dst, built);
+                throw;
+            }
+            destroy(src, n);
         }
-        delete[] data;
-        data = newData;
+    }
+
+    void destroy(T* p, size_t n) {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < n; ++i) {
+                Traits::destroy(alloc, p + i);
+            }
+        }
+    }
+
+    // Doubling keeps push_back amortized O(1)
+    size_t capacity_for_growth() const { return capacity == 0 ? 1 : capacity * 2; }
+
+    void release() {
+        destroy(data, length);
+        if (data) {
+            Traits::deallocate(alloc, data, capacity);
+        }
+        data = nullptr;
+        capacity = length = 0;
     }
 
 public:
@@ -66,15 +161,99 @@ public:
         bool operator>=(const Iterator& other) const { return ptr >= other.ptr; }
     };
 
-    // Constructor and destructor
-    MyVector() : data(nullptr), capacity(0), length(0) {}
+    // Constructors and destructor
+    MyVector() : alloc(), data(nullptr), capacity(0), length(0) {}
+    explicit MyVector(const Alloc& a) : alloc(a), data(nullptr), capacity(0), length(0) {}
 
-    ~MyVector() { delete[] data; }
+    MyVector(const MyVector& other)
+        : alloc(Traits::select_on_container_copy_construction(other.alloc)),
+          data(nullptr), capacity(0), length(0) {
+        reserve(other.length);
+        for (size_t i = 0; i < other.length; ++i) {
+            emplace_back(other.data[i]);
+        }
+    }
+
+    MyVector(MyVector&& other) noexcept
+        : alloc(std::move(other.alloc)), data(std::exchange(other.data, nullptr)),
+          capacity(std::exchange(other.capacity, 0)), length(std::exchange(other.length, 0)) {}
+
+    // Copy-and-swap; assumes equal (e.g. stateless) allocators
+    MyVector& operator=(MyVector other) noexcept {
+        std::swap(alloc, other.alloc);
+        std::swap(data, other.data);
+        std::swap(capacity, other.capacity);
+        std::swap(length, other.length);
+        return *this;
+    }
+
+    ~MyVector() { release(); }
+
+    // Makes room for n elements without further reallocation
+    void reserve(size_t n) {
+        if (n > capacity) {
+            reallocate(n);
+        }
+    }
+
+    // Constructs the element in place. It is built in its final slot before
+    // the old elements are relocated, so v.emplace_back(v[0]) is safe.
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (length < capacity) {
+            Traits::construct(alloc, data + length, std::forward<Args>(args)...);
+            return data[length++];
+        }
+        const size_t new_capacity = capacity_for_growth();
+        if constexpr (is_trivially_relocatable_v<T> && Reallocating<Alloc, T>) {
+            // realloc() may free the old block, so build the value on the
+            // side first, then relocate its bytes into the vector. The
+            // buffer is raw storage: no destructor runs for it afterwards.
+            alignas(T) unsigned char staged[sizeof(T)];
+            ::new (static_cast<void*>(staged)) T(std::forward<Args>(args)...);
+            try {
+                reallocate(new_capacity);
+            } catch (...) {
+                std::launder(reinterpret_cast<T*>(staged))->~T();
+                throw;
+            }
+            std::memcpy(static_cast<void*>(data + length), staged, sizeof(T));
+        } else {
+            T* newData = Traits::allocate(alloc, new_capacity);
+            try {
+                Traits::construct(alloc, newData + length, std::forward<Args>(args)...);
+            } catch (...) {
+                Traits::deallocate(alloc, newData, new_capacity);
+                throw;
+            }
+            try {
+                relocate(data, length, newData);
+            } catch (...) {
+                Traits::destroy(alloc, newData + length);
+                Traits::deallocate(alloc, newData, new_capacity);
+                throw;
+            }
+            if (data) {
+                Traits::deallocate(alloc, data, capacity);
+            }
+            data = newData;
+            capacity = new_capacity;
+        }
+        return data[length++];
+    }
 
     // Add element
-    void push_back(const T& value) {
-        if (length >= capacity) resize();
-        data[length++] = value;
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() {
+        --length;
+        Traits::destroy(alloc, data + length);
+    }
+
+    void clear() {
+        destroy(data, length);
+        length = 0;
     }
 
     // Access elements
@@ -82,12 +261,128 @@ public:
     const T& operator[](size_t index) const { return data[index]; }
 
     size_t size() const { return length; }
+    size_t getCapacity() const { return capacity; }
 
     // Iterator functions
     Iterator begin() { return Iterator(data); }
     Iterator end() { return Iterator(data + length); }
 };
 
+// ===== Growth benchmark =====
+
+// Counts allocation calls made through the allocators below
+struct AllocCounter {
+    static inline size_t allocations = 0;
+    static inline size_t moved = 0;      // realloc() calls that had to move the block
+
+    static void reset() { allocations = moved = 0; }
+};
+
+// std::allocator with a counter
+template<typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        ++AllocCounter::allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* p, size_t n) noexcept { std::allocator<T>{}.deallocate(p, n); }
+
+    bool operator==(const CountingAllocator&) const = default;
+};
+
+// malloc/free, plus reallocate() on top of realloc(), which can extend a
+// block in place (and for large blocks glibc uses mremap, moving pages
+// instead of bytes)
+template<typename T>
+struct MallocAllocator {
+    using value_type = T;
+
+    MallocAllocator() = default;
+    template<typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        ++AllocCounter::allocations;
+        void* p = std::malloc(n * sizeof(T));
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) noexcept { std::free(p); }
+
+    T* reallocate(T* p, size_t, size_t n) {
+        ++AllocCounter::allocations;
+        void* q = std::realloc(static_cast<void*>(p), n * sizeof(T));
+        if (!q) {
+            throw std::bad_alloc();
+        }
+        if (p && q != static_cast<void*>(p)) {
+            ++AllocCounter::moved;
+        }
+        return static_cast<T*>(q);
+    }
+
+    bool operator==(const MallocAllocator&) const = default;
+};
+
+// Owns a heap object, so it is not trivially copyable - but moving its
+// bytes and forgetting the source is a valid move, so it opts in
+struct Handle {
+    std::unique_ptr<int> p;
+    explicit Handle(int v) : p(std::make_unique<int>(v)) {}
+};
+
+template<>
+struct is_trivially_relocatable<Handle> : std::true_type {};
+
+template<typename Vector, typename Make>
+void benchPushBack(const char* label, size_t n, Make make) {
+    AllocCounter::reset();
+    auto start = std::chrono::steady_clock::now();
+    {
+        Vector v;
+        for (size_t i = 0; i < n; ++i) {
+            v.push_back(make(i));
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(n);
+    std::cout << "  " << label << ": " << ns << " ns/push_back, " << AllocCounter::allocations
+              << " allocation calls";
+    if (AllocCounter::moved) {
+        std::cout << " (" << AllocCounter::moved << " moved the block)";
+    }
+    std::cout << "\n";
+}
+
+void benchmarkGrowth() {
+    const size_t n = 10'000'000;
+    auto make_int = [](size_t i) { return static_cast<int>(i); };
+    std::cout << "push_back of " << n << " ints:\n";
+    benchPushBack<std::vector<int, CountingAllocator<int>>>("std::vector         ", n, make_int);
+    benchPushBack<MyVector<int, CountingAllocator<int>>>("MyVector            ", n, make_int);
+    benchPushBack<MyVector<int, MallocAllocator<int>>>("MyVector + realloc  ", n, make_int);
+
+    // Heap-allocated strings: relocated by (noexcept) move
+    const size_t m = 1'000'000;
+    auto make_string = [](size_t i) { return "a string past the SSO buffer #" + std::to_string(i); };
+    std::cout << "push_back of " << m << " std::strings:\n";
+    benchPushBack<std::vector<std::string, CountingAllocator<std::string>>>("std::vector         ", m, make_string);
+    benchPushBack<MyVector<std::string, CountingAllocator<std::string>>>("MyVector            ", m, make_string);
+
+    auto make_handle = [](size_t i) { return Handle(static_cast<int>(i)); };
+    std::cout << "push_back of " << m << " Handles (opted in as trivially relocatable):\n";
+    benchPushBack<std::vector<Handle, CountingAllocator<Handle>>>("std::vector         ", m, make_handle);
+    benchPushBack<MyVector<Handle, MallocAllocator<Handle>>>("MyVector + realloc  ", m, make_handle);
+}
+
 int main() {
     MyVector<int> vec;
 
@@ -112,7 +407,7 @@ int main() {
 
     // Using STL algorithms
     std::cout << "Reversed: ";
-    std::for_each(vec.end() - 1, vec.begin() - 1, [](int n) {
+    std::for_each(std::make_reverse_iterator(vec.end()), std::make_reverse_iterator(vec.begin()), [](int n) {
         std::cout << n << " ";
     });
     std::cout << "\n";
@@ -122,5 +417,19 @@ int main() {
     std::cout << "Third element: " << *(it + 2) << "\n";
     std::cout << "Using subscript: " << it[4] << "\n";
 
+    // reserve + emplace_back: one allocation, elements built in place
+    MyVector<std::string> words;
+    words.reserve(2);
+    words.emplace_back("iterators");
+    words.emplace_back(5, '!');
+    words.emplace_back(words[0]);     // full: grows, and the argument still refers to the old buffer
+    std::cout << "Words: ";
+    for (const auto& w : words) {
+        std::cout << w << " ";
+    }
+    std::cout << "(capacity " << words.getCapacity() << ")\n\n";
+
+    benchmarkGrowth();
+
     return 0;
 }
\ No newline at end of file
@@ -1,9 +1,31 @@
+/*
+g++ -std=c++20 -O2 lambdas_closures.cpp -o app
+*/
 #include <iostream>
 #include <vector>
 #include <algorithm>
 #include <functional>
 #include <string>
 #include <memory>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "inplace_function.hpp"
+
+// Counts global allocations, so section 14 can show which wrappers allocate
+size_t g_allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
 
 // ============================================================================
 // 1. BASIC FUNCTION OBJECTS (FUNCTORS)
@@ -346,12 +368,15 @@ void demonstrateStdFunction() {
 // 11. PRACTICAL EXAMPLE: Event System
 // ============================================================================
 
-class Button {
+// The handler type is a parameter: std::function by default, or an
+// inplace_function when registering handlers must not allocate (section 14)
+template<typename Handler = std::function<void()>>
+class BasicButton {
 private:
-    std::vector<std::function<void()>> clickHandlers;
+    std::vector<Handler> clickHandlers;
 public:
-    void onClick(std::function<void()> handler) {
-        clickHandlers.push_back(handler);
+    void onClick(Handler handler) {
+        clickHandlers.push_back(std::move(handler));
     }
     
     void click() {
@@ -362,6 +387,8 @@ public:
     }
 };
 
+using Button = BasicButton<>;
+
 void demonstrateEventSystem() {
     std::cout << "\n=== Event System Example ===\n";
     
@@ -455,6 +482,99 @@ void demonstrateStatefulComparison() {
     }
 }
 
+// ============================================================================
+// 14. inplace_function - TYPE ERASURE WITHOUT THE HEAP
+// ============================================================================
+
+// std::function<void()> is 32 bytes here and keeps only 16 of them for the
+// callable; anything bigger - a lambda capturing one std::string already is -
+// goes to the heap. inplace_function<Sig, Size> (inplace_function.hpp) stores
+// up to Size bytes inline and refuses bigger callables at compile time:
+//
+//     inplace_function<void(), 16> f = [message] {};  // error: raise Size
+//
+// It is move-only, so it also holds callables std::function cannot, like a
+// lambda that owns a unique_ptr.
+
+// A handler with 48 bytes of state: a string, a pointer and a counter
+struct LogHandler {
+    std::string prefix;
+    int* total;
+    long long calls = 0;
+    void operator()() { *total += static_cast<int>(++calls); }
+};
+
+template<typename Fn>
+double nsPerIteration(int iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+void demonstrateInplaceFunction() {
+    std::cout << "\n=== inplace_function ===\n";
+    std::cout << "sizeof(std::function<void()>): " << sizeof(std::function<void()>) << "\n";
+    std::cout << "sizeof(inplace_function<void(), 64>): " << sizeof(inplace_function<void(), 64>) << "\n";
+    std::cout << "sizeof(LogHandler): " << sizeof(LogHandler) << "\n";
+
+    // The event system from section 11 with inline handlers
+    BasicButton<inplace_function<void(), 64>> button;
+    int total = 0;
+    button.onClick(LogHandler{"log", &total});
+    auto owned = std::make_unique<std::string>("owned by the handler");
+    button.onClick([text = std::move(owned)] {  // move-only: std::function rejects this
+        std::cout << "Handler 2: " << *text << "\n";
+    });
+    button.click();
+    std::cout << "total after one click: " << total << "\n";
+
+    // Register-and-fire 100k handlers: every std::function allocates for the
+    // 48-byte LogHandler, the inplace_function never does (the prefix is
+    // short enough for the string's own small buffer)
+    const int kHandlers = 100000;
+    std::vector<std::function<void()>> std_handlers;
+    std::vector<inplace_function<void(), 64>> inplace_handlers;
+    std_handlers.reserve(kHandlers);
+    inplace_handlers.reserve(kHandlers);
+
+    size_t before = g_allocations;
+    const double std_ns = nsPerIteration(kHandlers, [&] {
+        for (int i = 0; i < kHandlers; ++i) {
+            std_handlers.emplace_back(LogHandler{"log", &total});
+        }
+        for (auto& handler : std_handlers) {
+            handler();
+        }
+        std_handlers.clear();
+    });
+    const size_t std_allocations = g_allocations - before;
+
+    before = g_allocations;
+    const double inplace_ns = nsPerIteration(kHandlers, [&] {
+        for (int i = 0; i < kHandlers; ++i) {
+            inplace_handlers.emplace_back(LogHandler{"log", &total});
+        }
+        for (auto& handler : inplace_handlers) {
+            handler();
+        }
+        inplace_handlers.clear();
+    });
+    const size_t inplace_allocations = g_allocations - before;
+
+    std::cout << "register + call + destroy, " << kHandlers << " handlers:\n";
+    std::cout << "  std::function        " << std_ns << " ns each, " << std_allocations << " allocations\n";
+    std::cout << "  inplace_function<64> " << inplace_ns << " ns each, " << inplace_allocations << " allocations\n";
+
+    // Empty wrappers throw, like std::function
+    inplace_function<int(int)> empty;
+    try {
+        empty(1);
+    } catch (const std::bad_function_call&) {
+        std::cout << "calling an empty inplace_function throws std::bad_function_call\n";
+    }
+}
+
 // ============================================================================
 // MAIN FUNCTION
 // ============================================================================
@@ -482,6 +602,7 @@ int main() {
     demonstrateEventSystem();
     demonstrateRecursiveLambdas();
     demonstrateStatefulComparison();
+    demonstrateInplaceFunction();
     
     return 0;
 }
\ No newline at end of file
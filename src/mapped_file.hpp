@@ -0,0 +1,190 @@
+/*
+Read-only memory-mapped files (header-only, just #include it; POSIX).
+Used by 73_views.cpp, 50_std_span.cpp and 106_Shared_Mutex/cache_snapshot.hpp.
+
+MappedFile maps a whole file and hands it out as std::span<const std::byte>
+or std::string_view, so the span/string_view/ranges code that works on
+in-memory data runs unchanged over a multi-GB file: nothing is read into a
+std::string, pages are faulted in straight from the page cache as the view
+is walked.
+
+    MappedFile file("access.log");
+    for (std::string_view line : lines(file.text())) { ... }
+
+The hints go to madvise():
+    Sequential  read-ahead aggressively, drop pages behind the reader
+    WillNeed    start reading the whole file in now
+    Random      no read-ahead (index lookups, binary search)
+
+Every view into the file dangles once the MappedFile is destroyed.
+*/
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class MappedFile {
+public:
+    enum class Advice { Normal, Sequential, WillNeed, Random };
+
+    explicit MappedFile(const std::string& path, Advice advice = Advice::Sequential) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            const int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "fstat " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        // mmap() refuses length 0; an empty file is just an empty view
+        if (size_ > 0) {
+            void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                const int err = errno;
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "mmap " + path);
+            }
+            data_ = static_cast<const std::byte*>(p);
+        }
+        // The mapping keeps the file alive on its own
+        ::close(fd);
+        advise(advice);
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { unmap(); }
+
+    // Only a hint: a kernel that ignores it is not an error
+    void advise(Advice advice) const {
+        if (!data_) {
+            return;
+        }
+        int flag = MADV_NORMAL;
+        switch (advice) {
+            case Advice::Normal:     flag = MADV_NORMAL; break;
+            case Advice::Sequential: flag = MADV_SEQUENTIAL; break;
+            case Advice::WillNeed:   flag = MADV_WILLNEED; break;
+            case Advice::Random:     flag = MADV_RANDOM; break;
+        }
+        ::madvise(const_cast<std::byte*>(data_), size_, flag);
+    }
+
+    std::span<const std::byte> bytes() const { return {data_, size_}; }
+
+    std::string_view text() const {
+        return {reinterpret_cast<const char*>(data_), size_};
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    const std::byte* data_ = nullptr;
+    size_t size_ = 0;
+
+    void unmap() {
+        if (data_) {
+            ::munmap(const_cast<std::byte*>(data_), size_);
+            data_ = nullptr;
+        }
+    }
+};
+
+// Lines of a text as string_views into it, without the '\n' (and without
+// a '\r' before it). A last line without a newline is still a line; a final
+// newline does not start an empty one - the same lines std::getline gives.
+// Newlines are found with memchr, which glibc vectorizes.
+class LineView : public std::ranges::view_interface<LineView> {
+public:
+    class iterator {
+    public:
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        iterator(const char* p, const char* end) : cur_(p), stop_(end) { find_end(); }
+
+        std::string_view operator*() const {
+            const char* e = eol_;
+            if (e != cur_ && e[-1] == '\r') {
+                --e;
+            }
+            return {cur_, static_cast<size_t>(e - cur_)};
+        }
+
+        iterator& operator++() {
+            cur_ = eol_ == stop_ ? stop_ : eol_ + 1;
+            find_end();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const iterator& other) const { return cur_ == other.cur_; }
+        bool operator==(std::default_sentinel_t) const { return cur_ == stop_; }
+
+    private:
+        const char* cur_ = nullptr;     // start of the current line
+        const char* stop_ = nullptr;
+        const char* eol_ = nullptr;     // its '\n', or stop_
+
+        void find_end() {
+            const void* nl = cur_ == stop_ ? nullptr
+                : std::memchr(cur_, '\n', static_cast<size_t>(stop_ - cur_));
+            eol_ = nl ? static_cast<const char*>(nl) : stop_;
+        }
+    };
+
+    LineView() = default;
+    explicit LineView(std::string_view text) : text_(text) {}
+
+    iterator begin() const { return iterator(text_.data(), text_.data() + text_.size()); }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    std::string_view text_;
+};
+
+// The lines point into the text, not into the view
+template<>
+inline constexpr bool std::ranges::enable_borrowed_range<LineView> = true;
+
+inline LineView lines(std::string_view text) {
+    return LineView(text);
+}
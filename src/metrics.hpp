@@ -0,0 +1,433 @@
+/*
+Process-wide metrics: counters, gauges and log-linear latency histograms
+with Prometheus text export (header-only, just #include it).
+Used by metrics_demo.cpp, 101_Threads_RAII/thread_pool.hpp (register_metrics),
+allocators2.hpp (DetailedTrackingAllocator::register_metrics) and
+106_Shared_Mutex/reader_writer_pattern.cpp (BoundedThreadSafeCache).
+
+Until now each component kept its own counters - the pool's WorkerStats,
+the allocators' statics behind a mutex, the caches' CacheStats - and
+printed them to cout in its own format. Here there is one place to scrape:
+
+    auto& requests = metrics::Registry::global().counter("requests_total", "Requests served");
+    auto& latency  = metrics::Registry::global().histogram("request_seconds", "Request latency", "", 1e-9);
+    requests.inc();
+    latency.record(elapsed_ns);
+    metrics::Registry::global().write_prometheus(std::cout);
+
+  - Counter: kShards cache-line-sized cells; a thread always adds to the
+    same cell (relaxed fetch_add), so threads on different cells never
+    share a line. Reading sums the cells.
+  - Gauge: one relaxed atomic int64 - a level has to be settable, which
+    rules out sharding.
+  - Histogram: HDR-style log-linear buckets for non-negative integers
+    (nanoseconds, bytes): exact below 8, then 8 buckets per power of two,
+    so any value is within 12.5% of its bucket bound, up to 2^41. Larger
+    values share an open-ended last bucket (le="+Inf").
+    Sharded like Counter: a record is three relaxed adds on the thread's
+    own shard.
+  - Collectors: components that already keep lock-free statistics
+    register a callback that reads them at scrape time, instead of
+    double-counting on the hot path. The returned Registration removes
+    the callback when destroyed, so it is tied to the component's lifetime.
+
+No update ever takes a lock. A scrape takes the registry mutex (which only
+registration also takes) and reads every cell with relaxed loads, so it
+never blocks writers; the price is that a scrape is not an atomic snapshot
+across metrics - a counter read early may lag one read later.
+
+Export follows the Prometheus text format (HELP/TYPE per family, metrics
+sorted by family). Histograms emit cumulative _bucket lines only for
+buckets that hold samples, plus le="+Inf", _sum and _count.
+*/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace metrics {
+
+inline constexpr size_t kShards = 8;
+
+// A thread's shard, the same for every metric
+inline size_t shard_index() {
+    static std::atomic<size_t> next{0};
+    thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) & (kShards - 1);
+    return index;
+}
+
+// ----------------------------------------------------------------------------
+// Counter, Gauge
+// ----------------------------------------------------------------------------
+class Counter {
+public:
+    void inc(uint64_t n = 1) { m_cells[shard_index()].value.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const {
+        uint64_t total = 0;
+        for (const Cell& cell : m_cells) {
+            total += cell.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Cell, kShards> m_cells{};
+};
+
+class Gauge {
+public:
+    void set(int64_t v) { m_value.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    void sub(int64_t n) { m_value.fetch_sub(n, std::memory_order_relaxed); }
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value{0};
+};
+
+// ----------------------------------------------------------------------------
+// Histogram
+// ----------------------------------------------------------------------------
+class Histogram {
+public:
+    static constexpr unsigned kSubBits = 3;
+    static constexpr uint64_t kSub = uint64_t{1} << kSubBits;
+    static constexpr unsigned kMaxExponent = 40;     // values >= 2^41 share the last bucket
+    static constexpr size_t kBuckets = kSub + (kMaxExponent - kSubBits + 1) * kSub;
+
+    static constexpr size_t bucket_of(uint64_t v) {
+        if (v < kSub) {
+            return static_cast<size_t>(v);
+        }
+        const unsigned exponent = static_cast<unsigned>(std::bit_width(v)) - 1;
+        if (exponent > kMaxExponent) {
+            return kBuckets - 1;
+        }
+        const uint64_t mantissa = (v >> (exponent - kSubBits)) - kSub;
+        return static_cast<size_t>(kSub + (exponent - kSubBits) * kSub + mantissa);
+    }
+
+    // Largest value that lands in bucket b. The last bucket also takes
+    // everything from 2^41 up, so it has no finite bound: UINT64_MAX, and
+    // le="+Inf" in the Prometheus export
+    static constexpr uint64_t upper_bound(size_t b) {
+        if (b < kSub) {
+            return b;
+        }
+        if (b == kBuckets - 1) {
+            return UINT64_MAX;
+        }
+        const unsigned exponent = static_cast<unsigned>((b - kSub) / kSub) + kSubBits;
+        const uint64_t mantissa = kSub + (b - kSub) % kSub;
+        return ((mantissa + 1) << (exponent - kSubBits)) - 1;
+    }
+
+    void record(uint64_t v) {
+        Shard& shard = m_shards[shard_index()];
+        shard.buckets[bucket_of(v)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(v, std::memory_order_relaxed);
+    }
+
+    struct Snapshot {
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(kBuckets);
+        uint64_t count = 0;
+        uint64_t sum = 0;
+
+        // Upper bound of the bucket holding the q-th quantile (0 < q <= 1)
+        uint64_t percentile(double q) const {
+            const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(count) + 0.5));
+            uint64_t seen = 0;
+            for (size_t b = 0; b < kBuckets; ++b) {
+                seen += buckets[b];
+                if (seen >= target) {
+                    return upper_bound(b);
+                }
+            }
+            return count ? upper_bound(kBuckets - 1) : 0;
+        }
+    };
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        for (const Shard& shard : m_shards) {
+            for (size_t b = 0; b < kBuckets; ++b) {
+                s.buckets[b] += shard.buckets[b].load(std::memory_order_relaxed);
+            }
+            s.count += shard.count.load(std::memory_order_relaxed);
+            s.sum += shard.sum.load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+    };
+    std::array<Shard, kShards> m_shards{};
+};
+
+// ----------------------------------------------------------------------------
+// Exposition - what a scrape writes into; collectors get one too
+// ----------------------------------------------------------------------------
+class Exposition {
+public:
+    void counter(std::string_view name, std::string_view help, std::string_view labels, double value) {
+        sample(family(name, help, "counter"), name, labels, value);
+    }
+
+    void gauge(std::string_view name, std::string_view help, std::string_view labels, double value) {
+        sample(family(name, help, "gauge"), name, labels, value);
+    }
+
+    /**
+     * @param bounds_counts (inclusive upper bound, samples in that bucket) in
+     *                      ascending order; empty buckets may be left out, and
+     *                      an infinite bound is covered by the le="+Inf" line
+     * @param scale         multiplies bounds and sum (1e-9: ns to seconds)
+     */
+    void histogram(std::string_view name, std::string_view help, std::string_view labels,
+                   const std::vector<std::pair<double, uint64_t>>& bounds_counts, double sum, uint64_t count,
+                   double scale = 1.0) {
+        Family& f = family(name, help, "histogram");
+        const std::string bucket = std::string(name) + "_bucket";
+        uint64_t cumulative = 0;
+        for (const auto& [bound, n] : bounds_counts) {
+            if (n == 0 || std::isinf(bound)) {
+                continue;
+            }
+            cumulative += n;
+            sample(f, bucket, join(labels, "le=\"" + number(bound * scale) + "\""), static_cast<double>(cumulative));
+        }
+        sample(f, bucket, join(labels, "le=\"+Inf\""), static_cast<double>(count));
+        sample(f, std::string(name) + "_sum", labels, sum * scale);
+        sample(f, std::string(name) + "_count", labels, static_cast<double>(count));
+    }
+
+    void histogram(std::string_view name, std::string_view help, std::string_view labels,
+                   const Histogram::Snapshot& s, double scale = 1.0) {
+        std::vector<std::pair<double, uint64_t>> bounds_counts;
+        for (size_t b = 0; b < Histogram::kBuckets; ++b) {
+            if (s.buckets[b] != 0) {
+                const double bound = b == Histogram::kBuckets - 1 ? std::numeric_limits<double>::infinity()
+                                                                 : static_cast<double>(Histogram::upper_bound(b));
+                bounds_counts.emplace_back(bound, s.buckets[b]);
+            }
+        }
+        histogram(name, help, labels, bounds_counts, static_cast<double>(s.sum), s.count, scale);
+    }
+
+    void write(std::ostream& out) const {
+        for (const auto& [name, f] : m_families) {
+            out << "# HELP " << name << ' ' << f.help << "\n# TYPE " << name << ' ' << f.type << '\n' << f.lines;
+        }
+    }
+
+private:
+    struct Family {
+        std::string help;
+        std::string type;
+        std::string lines;
+    };
+
+    Family& family(std::string_view name, std::string_view help, std::string_view type) {
+        Family& f = m_families[std::string(name)];
+        if (f.type.empty()) {
+            f.help = help;
+            f.type = type;
+        }
+        return f;
+    }
+
+    static std::string join(std::string_view labels, const std::string& more) {
+        return labels.empty() ? more : std::string(labels) + "," + more;
+    }
+
+    static std::string number(double v) {
+        std::ostringstream s;
+        s.precision(12);
+        s << v;
+        return s.str();
+    }
+
+    static void sample(Family& f, std::string_view name, std::string_view labels, double value) {
+        f.lines += name;
+        if (!labels.empty()) {
+            f.lines += '{';
+            f.lines += labels;
+            f.lines += '}';
+        }
+        f.lines += ' ';
+        f.lines += number(value);
+        f.lines += '\n';
+    }
+
+    std::map<std::string, Family, std::less<>> m_families;
+};
+
+// ----------------------------------------------------------------------------
+// Registry
+// ----------------------------------------------------------------------------
+class Registry;
+
+// Keeps a collector registered; unregisters it on destruction
+class Registration {
+public:
+    Registration() = default;
+    Registration(Registration&& other) noexcept
+        : m_registry(std::exchange(other.m_registry, nullptr)), m_id(other.m_id) {}
+    Registration& operator=(Registration&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_registry = std::exchange(other.m_registry, nullptr);
+            m_id = other.m_id;
+        }
+        return *this;
+    }
+    ~Registration() { reset(); }
+
+    inline void reset();
+
+private:
+    friend class Registry;
+    Registration(Registry* registry, uint64_t id) : m_registry(registry), m_id(id) {}
+
+    Registry* m_registry = nullptr;
+    uint64_t m_id = 0;
+};
+
+class Registry {
+public:
+    using Collector = std::function<void(Exposition&)>;
+
+    static Registry& global() {
+        static Registry registry;
+        return registry;
+    }
+
+    // Get-or-create by (name, labels); the reference stays valid for the
+    // registry's lifetime. labels is Prometheus label syntax: pool="io",worker="3"
+    Counter& counter(std::string_view name, std::string_view help, std::string_view labels = "") {
+        return get<Counter>(name, help, labels, Kind::Counter, 1.0);
+    }
+
+    Gauge& gauge(std::string_view name, std::string_view help, std::string_view labels = "") {
+        return get<Gauge>(name, help, labels, Kind::Gauge, 1.0);
+    }
+
+    // scale converts recorded units on export, e.g. 1e-9 for ns -> seconds
+    Histogram& histogram(std::string_view name, std::string_view help, std::string_view labels = "",
+                         double scale = 1.0) {
+        return get<Histogram>(name, help, labels, Kind::Histogram, scale);
+    }
+
+    [[nodiscard]] Registration add_collector(Collector collector) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const uint64_t id = ++m_nextCollector;
+        m_collectors.emplace(id, std::move(collector));
+        return Registration(this, id);
+    }
+
+    void write_prometheus(std::ostream& out) const {
+        Exposition exposition;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& [key, entry] : m_metrics) {
+                switch (entry.kind) {
+                case Kind::Counter:
+                    exposition.counter(entry.name, entry.help, entry.labels,
+                                       static_cast<double>(static_cast<const Counter*>(entry.metric.get())->value()));
+                    break;
+                case Kind::Gauge:
+                    exposition.gauge(entry.name, entry.help, entry.labels,
+                                     static_cast<double>(static_cast<const Gauge*>(entry.metric.get())->value()));
+                    break;
+                case Kind::Histogram:
+                    exposition.histogram(entry.name, entry.help, entry.labels,
+                                         static_cast<const Histogram*>(entry.metric.get())->snapshot(), entry.scale);
+                    break;
+                }
+            }
+            for (const auto& [id, collector] : m_collectors) {
+                collector(exposition);
+            }
+        }
+        exposition.write(out);
+    }
+
+    std::string scrape() const {
+        std::ostringstream out;
+        write_prometheus(out);
+        return out.str();
+    }
+
+private:
+    friend class Registration;
+
+    enum class Kind { Counter, Gauge, Histogram };
+
+    struct Entry {
+        std::string name;
+        std::string help;
+        std::string labels;
+        Kind kind;
+        double scale;
+        std::shared_ptr<void> metric;
+    };
+
+    template<typename Metric>
+    Metric& get(std::string_view name, std::string_view help, std::string_view labels, Kind kind, double scale) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string key = std::string(name) + '{' + std::string(labels) + '}';
+        auto it = m_metrics.find(key);
+        if (it == m_metrics.end()) {
+            it = m_metrics.emplace(std::move(key), Entry{std::string(name), std::string(help), std::string(labels),
+                                                         kind, scale, std::make_shared<Metric>()}).first;
+        } else if (it->second.kind != kind) {
+            throw std::logic_error("metrics: '" + std::string(name) + "' already registered as another type");
+        }
+        return *static_cast<Metric*>(it->second.metric.get());
+    }
+
+    void remove(uint64_t id) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_collectors.erase(id);
+    }
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, Entry> m_metrics;
+    std::map<uint64_t, Collector> m_collectors;
+    uint64_t m_nextCollector = 0;
+};
+
+inline void Registration::reset() {
+    if (m_registry) {
+        m_registry->remove(m_id);
+        m_registry = nullptr;
+    }
+}
+
+} // namespace metrics
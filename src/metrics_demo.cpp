@@ -0,0 +1,141 @@
+// g++ -std=c++20 -O2 -pthread metrics_demo.cpp -o app
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "metrics.hpp"
+#include "allocators2.hpp"
+#include "101_Threads_RAII/thread_pool.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// ============================================================================
+// 1. UPDATE COST: sharded Counter vs one atomic vs a mutex
+// ============================================================================
+template<typename Inc>
+double ns_per_update(int threads, int per_thread, Inc inc) {
+    std::vector<std::thread> workers;
+    const auto start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (int i = 0; i < per_thread; ++i) {
+                inc();
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double(threads) * per_thread);
+}
+
+void benchmarkUpdates() {
+    std::cout << "\n=== UPDATE COST, ns per update (" << std::thread::hardware_concurrency()
+              << " hardware threads) ===\n";
+    constexpr int kPerThread = 2'000'000;
+    for (int threads : {1, 4, 8}) {
+        metrics::Counter counter;
+        metrics::Histogram histogram;
+        std::atomic<uint64_t> single{0};
+        std::mutex mutex;
+        uint64_t locked = 0;
+        uint64_t v = 0;
+
+        const double sharded = ns_per_update(threads, kPerThread, [&] { counter.inc(); });
+        const double atomic = ns_per_update(threads, kPerThread, [&] { single.fetch_add(1, std::memory_order_relaxed); });
+        const double mutexed = ns_per_update(threads, kPerThread, [&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++locked;
+        });
+        const double recorded = ns_per_update(threads, kPerThread, [&] { histogram.record(++v & 0xFFFFF); });
+        std::cout << threads << " thread(s): Counter " << sharded << ", one atomic " << atomic << ", mutex "
+                  << mutexed << ", Histogram::record " << recorded << "  (counted "
+                  << (counter.value() == uint64_t(threads) * kPerThread ? "exactly" : "WRONG") << ")\n";
+    }
+}
+
+// ============================================================================
+// 2. HISTOGRAM PRECISION
+// ============================================================================
+void demonstrateHistogram() {
+    std::cout << "\n=== LOG-LINEAR HISTOGRAM ===\n";
+    metrics::Histogram h;
+    for (uint64_t v = 1; v <= 100'000; ++v) {
+        h.record(v);            // uniform 1..100000: p50 = 50000, p99 = 99000
+    }
+    const auto s = h.snapshot();
+    std::cout << metrics::Histogram::kBuckets << " buckets; uniform 1..100000: p50 <= " << s.percentile(0.5)
+              << ", p99 <= " << s.percentile(0.99) << ", mean " << s.sum / s.count << "\n";
+}
+
+// ============================================================================
+// 3. ONE SCRAPE FOR THE POOL, AN ALLOCATOR AND APPLICATION METRICS
+// ============================================================================
+void demonstrateScrape() {
+    std::cout << "\n=== SCRAPE ===\n";
+    metrics::Registry& registry = metrics::Registry::global();
+    auto& requests = registry.counter("app_requests_total", "Requests handled", "route=\"/work\"");
+    auto& in_flight = registry.gauge("app_requests_in_flight", "Requests being handled");
+    auto& latency = registry.histogram("app_request_seconds", "Request latency", "route=\"/work\"", 1e-9);
+
+    ThreadPoolRAII pool(4);
+    metrics::Registration pool_metrics = pool.register_metrics(registry, "workers");
+    metrics::Registration alloc_metrics =
+        DetailedTrackingAllocator<int>::register_metrics(registry, "detailed_int");
+
+    // Scrapes while the pool is busy: writers never wait for them
+    std::atomic<bool> done{false};
+    std::atomic<int> scrapes{0};
+    std::thread scraper([&] {
+        while (!done.load()) {
+            static_cast<void>(registry.scrape());
+            ++scrapes;
+        }
+    });
+
+    std::vector<std::future<void>> results;
+    for (int i = 0; i < 2000; ++i) {
+        results.push_back(pool.submit([&, i] {
+            in_flight.add(1);
+            const auto start = Clock::now();
+            volatile double x = 0;
+            for (int k = 0; k < 200 + (i % 10) * 100; ++k) {
+                x = x + k * 0.5;
+            }
+            latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - start).count()));
+            requests.inc();
+            in_flight.sub(1);
+        }));
+    }
+    for (auto& r : results) {
+        r.get();
+    }
+    done = true;
+    scraper.join();
+
+    {
+        std::vector<int, DetailedTrackingAllocator<int>> v;
+        v.reserve(256);
+        v.push_back(1);
+    }
+
+    const auto start = Clock::now();
+    const std::string text = registry.scrape();
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "\n" << scrapes << " concurrent scrapes while 2000 tasks ran; final scrape " << text.size()
+              << " bytes in " << ms << " ms:\n\n" << text;
+}
+
+int main() {
+    benchmarkUpdates();
+    demonstrateHistogram();
+    demonstrateScrape();
+    return 0;
+}
@@ -0,0 +1,208 @@
+/*
+Microbenchmark harness (header-only, just #include it).
+Used by crtp.cpp, 62_Static_Polymorphism/5_Comparison/test.cpp and
+profiled_mutex_demo.cpp.
+
+A timed loop whose results nobody reads measures nothing: the optimizer
+is allowed to delete it, and for inlined (static) dispatch it usually
+does. The comparison then divides a real number by ~0.
+
+    auto r = microbench::run("virtual", n, [&] {
+        for (...) sum += obj->compute(i);
+        microbench::do_not_optimize(sum);
+    });
+    microbench::report(r);
+    microbench::compare(baseline, r);
+
+  - do_not_optimize(v) makes v look read by unknown code, so whatever
+    computed it has to run; clobber_memory() makes every earlier store
+    look read. Both are empty inline asm: they cost no instruction.
+  - run() calls the body `warmup` times untimed (page faults, caches,
+    branch predictors, CPU frequency ramp), then `repetitions` times
+    timed, and reports per-operation min / median / mean / stddev.
+    The median is the number to quote; a stddev above a few percent of
+    it means the machine was busy.
+  - Time comes from the TSC on x86 (rdtscp, fenced) and steady_clock
+    elsewhere. The TSC ticks at a constant reference rate, not at the
+    core's current clock, so "cycles" are reference cycles; ns are
+    derived from a TSC rate calibrated against steady_clock once.
+
+Build with -O2 at least; unoptimized numbers compare nothing.
+*/
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MICROBENCH_HAS_TSC 1
+#else
+#define MICROBENCH_HAS_TSC 0
+#endif
+
+namespace microbench {
+
+// ----------------------------------------------------------------------------
+// Optimization barriers
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+template<typename T>
+inline void do_not_optimize(T& value) {
+#if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#elif defined(__GNUC__)
+    // Not "+m,r": GCC 12 may pick the register alternative for a double and
+    // never store the result back, leaving value unchanged
+    asm volatile("" : "+m"(value) : : "memory");
+#else
+    static volatile void* sink;
+    sink = &value;
+#endif
+}
+
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Clock
+// ----------------------------------------------------------------------------
+
+inline uint64_t ticks() {
+#if MICROBENCH_HAS_TSC
+    unsigned aux;
+    const uint64_t t = __rdtscp(&aux);     // waits for earlier instructions
+    _mm_lfence();                          // keeps later ones from starting
+    return t;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Ticks per nanosecond, measured once over ~20 ms
+inline double ticks_per_ns() {
+#if MICROBENCH_HAS_TSC
+    static const double rate = [] {
+        const auto t0 = std::chrono::steady_clock::now();
+        const uint64_t c0 = ticks();
+        while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(20)) {
+        }
+        const uint64_t c1 = ticks();
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+        return static_cast<double>(c1 - c0) / ns;
+    }();
+    return rate;
+#else
+    return 1.0;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Runner
+// ----------------------------------------------------------------------------
+
+struct Config {
+    int warmup = 3;
+    int repetitions = 15;
+};
+
+// All figures are per operation
+struct Result {
+    std::string name;
+    size_t ops = 0;
+    double min_ns = 0;
+    double median_ns = 0;
+    double mean_ns = 0;
+    double stddev_ns = 0;
+    double median_cycles = 0;
+};
+
+// body() performs `ops` operations per call and must feed what it computes
+// to do_not_optimize()
+template<typename F>
+Result run(std::string name, size_t ops, F&& body, Config config = {}) {
+    for (int i = 0; i < config.warmup; ++i) {
+        body();
+    }
+    std::vector<double> cycles(static_cast<size_t>(config.repetitions));
+    for (auto& c : cycles) {
+        clobber_memory();
+        const uint64_t start = ticks();
+        body();
+        const uint64_t end = ticks();
+        clobber_memory();
+        c = static_cast<double>(end - start) / static_cast<double>(ops);
+    }
+    std::sort(cycles.begin(), cycles.end());
+
+    const double rate = ticks_per_ns();
+    const size_t n = cycles.size();
+    double mean = 0;
+    for (double c : cycles) {
+        mean += c;
+    }
+    mean /= static_cast<double>(n);
+    double var = 0;
+    for (double c : cycles) {
+        var += (c - mean) * (c - mean);
+    }
+    const double median = n % 2 ? cycles[n / 2] : (cycles[n / 2 - 1] + cycles[n / 2]) / 2;
+
+    Result r;
+    r.name = std::move(name);
+    r.ops = ops;
+    r.min_ns = cycles.front() / rate;
+    r.median_ns = median / rate;
+    r.mean_ns = mean / rate;
+    r.stddev_ns = (n > 1 ? std::sqrt(var / static_cast<double>(n - 1)) : 0.0) / rate;
+    r.median_cycles = median;
+    return r;
+}
+
+inline void report(const Result& r) {
+    std::cout << "  " << std::left << std::setw(32) << r.name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(9) << r.median_ns << " ns/op (min " << r.min_ns << ", mean " << r.mean_ns
+              << " +- " << r.stddev_ns << ")  " << std::setprecision(2) << r.median_cycles
+#if MICROBENCH_HAS_TSC
+              << " ref cycles/op\n";
+#else
+              << " ns/op (no cycle counter)\n";
+#endif
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
+// Ratio of medians; a candidate that rounds to zero is reported, not divided by
+inline void compare(const Result& baseline, const Result& candidate) {
+    std::cout << "  " << candidate.name << " vs " << baseline.name << ": ";
+    if (candidate.median_ns <= 0.0) {
+        std::cout << "candidate below timer resolution\n";
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(2) << baseline.median_ns / candidate.median_ns << "x\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
+} // namespace microbench
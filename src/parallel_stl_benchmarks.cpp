@@ -0,0 +1,246 @@
+/*
+g++ -std=c++20 -O2 -pthread parallel_stl_benchmarks.cpp -o app -ltbb
+./app > scaling.csv            # full sweep, progress on stderr
+./app --quick > scaling.csv    # sizes up to L2, fewer repetitions
+*/
+
+// Scaling sweep for the algorithms shown in parallel_stl.cpp, to find out
+// where the parallel policies start paying for themselves on a given machine.
+//
+// Sweeps
+//   algorithm   sort, transform, reduce, transform_reduce, find, for_each
+//   size        16 KiB (L1), 256 KiB (L2), 4 MiB (L3), 64 MiB (DRAM) of doubles
+//   policy      seq, par, par_unseq
+//   workers     1, 2, 4, ... up to hardware_concurrency() (par / par_unseq)
+//
+// The worker count is capped with tbb::global_control, which is what the
+// libstdc++ parallel backend runs on. Without TBB the policies run serially
+// and only the 1-worker rows are produced.
+//
+// Every configuration is warmed up, then repeated until it has both a
+// minimum sample count and a minimum total time (so microsecond runs get
+// hundreds of samples and 64 MiB sorts a handful). Inputs are reset outside
+// the timed region, so sort always sorts the same shuffled data.
+//
+// CSV on stdout, one row per configuration:
+//   algorithm,policy,workers,elements,bytes,samples,median_us,p99_us,speedup,efficiency
+// speedup is median(seq) / median at the same size, efficiency is
+// speedup / workers. A speedup below 1 means the policy costs more than it
+// saves at that size.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if __has_include(<tbb/global_control.h>)
+#include <tbb/global_control.h>
+#define HAVE_TBB_CONTROL 1
+#else
+#define HAVE_TBB_CONTROL 0
+#endif
+
+// ===== Measurement =====
+
+// Keeps results observable so the optimizer cannot drop the work
+volatile double g_sink;
+
+inline void doNotOptimize(double value) {
+    g_sink = value;
+}
+
+struct Samples {
+    std::vector<double> us;
+
+    // Nearest-rank percentile, p in [0, 100]
+    double percentile(double p) {
+        std::sort(us.begin(), us.end());
+        const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * us.size()));
+        return us[std::clamp<size_t>(rank, 1, us.size()) - 1];
+    }
+};
+
+struct RunConfig {
+    int warmup = 3;
+    size_t min_samples = 21;
+    double min_total_ms = 200.0;
+    size_t max_samples = 2001;
+};
+
+// setup() runs untimed before every sample, run() is the timed part
+template<typename Setup, typename Run>
+Samples measure(const RunConfig& config, Setup&& setup, Run&& run) {
+    using Clock = std::chrono::steady_clock;
+    for (int i = 0; i < config.warmup; ++i) {
+        setup();
+        run();
+    }
+    Samples samples;
+    double total_ms = 0.0;
+    while (samples.us.size() < config.max_samples &&
+           (samples.us.size() < config.min_samples || total_ms < config.min_total_ms)) {
+        setup();
+        const auto start = Clock::now();
+        run();
+        const auto end = Clock::now();
+        const double us = std::chrono::duration<double, std::micro>(end - start).count();
+        samples.us.push_back(us);
+        total_ms += us / 1000.0;
+    }
+    return samples;
+}
+
+// ===== Workloads =====
+
+// The data every algorithm starts from; `work` is reset to `input` before
+// each sample where the algorithm modifies it
+struct Buffers {
+    std::vector<double> input;
+    std::vector<double> work;
+    std::vector<double> out;
+
+    explicit Buffers(size_t n) : input(n), work(n), out(n) {
+        std::mt19937_64 gen(12345);
+        std::uniform_real_distribution<double> dist(0.0, 1000.0);
+        for (double& x : input) {
+            x = dist(gen);
+        }
+    }
+
+    void reset() { std::copy(input.begin(), input.end(), work.begin()); }
+};
+
+void noSetup() {}
+
+// Runs one algorithm under `policy`; returns its samples
+template<typename Policy>
+Samples runAlgorithm(const std::string& algorithm, Policy&& policy, Buffers& b, const RunConfig& config) {
+    if (algorithm == "sort") {
+        return measure(config, [&] { b.reset(); },
+                       [&] { std::sort(policy, b.work.begin(), b.work.end()); doNotOptimize(b.work[0]); });
+    }
+    if (algorithm == "transform") {
+        return measure(config, noSetup, [&] {
+            std::transform(policy, b.input.begin(), b.input.end(), b.out.begin(),
+                           [](double x) { return std::sqrt(x) * 2.0 + 1.0; });
+            doNotOptimize(b.out[b.out.size() / 2]);
+        });
+    }
+    if (algorithm == "reduce") {
+        return measure(config, noSetup,
+                       [&] { doNotOptimize(std::reduce(policy, b.input.begin(), b.input.end(), 0.0)); });
+    }
+    if (algorithm == "transform_reduce") {
+        // Sum of squares: the dot-product shape
+        return measure(config, noSetup, [&] {
+            doNotOptimize(std::transform_reduce(policy, b.input.begin(), b.input.end(), 0.0, std::plus<>{},
+                                                [](double x) { return x * x; }));
+        });
+    }
+    if (algorithm == "find") {
+        // A value that is not there: the worst case, a full scan
+        return measure(config, noSetup, [&] {
+            auto it = std::find(policy, b.input.begin(), b.input.end(), -1.0);
+            doNotOptimize(static_cast<double>(it - b.input.begin()));
+        });
+    }
+    // for_each, in place on a copy that is reset each sample
+    return measure(config, [&] { b.reset(); }, [&] {
+        std::for_each(policy, b.work.begin(), b.work.end(), [](double& x) { x = x * 1.0001 + 0.5; });
+        doNotOptimize(b.work[b.work.size() / 2]);
+    });
+}
+
+// ===== Sweep =====
+
+struct Row {
+    std::string algorithm;
+    std::string policy;
+    unsigned workers;
+    size_t elements;
+    size_t samples;
+    double median_us;
+    double p99_us;
+};
+
+void printRow(const Row& row, double seq_median_us) {
+    const double speedup = seq_median_us / row.median_us;
+    std::cout << row.algorithm << ',' << row.policy << ',' << row.workers << ',' << row.elements << ','
+              << row.elements * sizeof(double) << ',' << row.samples << ',' << row.median_us << ','
+              << row.p99_us << ',' << speedup << ',' << speedup / row.workers << '\n';
+}
+
+// 1, 2, 4, ... and the machine's own count if it is not a power of two
+std::vector<unsigned> workerCounts() {
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+#if HAVE_TBB_CONTROL
+    std::vector<unsigned> counts;
+    for (unsigned w = 1; w < hw; w *= 2) {
+        counts.push_back(w);
+    }
+    counts.push_back(hw);
+    return counts;
+#else
+    (void)hw;
+    return {1};
+#endif
+}
+
+template<typename Policy>
+Row runWithWorkers(const std::string& algorithm, const char* policy_name, Policy&& policy, unsigned workers,
+                   Buffers& buffers, const RunConfig& config) {
+#if HAVE_TBB_CONTROL
+    // Caps the TBB arena the parallel algorithms run in, for this scope
+    tbb::global_control limit(tbb::global_control::max_allowed_parallelism, workers);
+#endif
+    Samples samples = runAlgorithm(algorithm, policy, buffers, config);
+    return Row{algorithm, policy_name, workers, buffers.input.size(), samples.us.size(),
+               samples.percentile(50), samples.percentile(99)};
+}
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+
+    RunConfig config;
+    std::vector<size_t> sizes_bytes = {16 << 10, 256 << 10, 4 << 20, 64 << 20};
+    if (quick) {
+        config.min_samples = 11;
+        config.min_total_ms = 20.0;
+        sizes_bytes = {16 << 10, 256 << 10};
+    }
+    const std::vector<std::string> algorithms = {"sort", "transform", "reduce",
+                                                 "transform_reduce", "find", "for_each"};
+    const std::vector<unsigned> workers = workerCounts();
+
+    std::cerr << "hardware_concurrency: " << std::thread::hardware_concurrency()
+              << (HAVE_TBB_CONTROL ? "" : " (no TBB: 1-worker rows only)") << "\n";
+    std::cout << "algorithm,policy,workers,elements,bytes,samples,median_us,p99_us,speedup,efficiency\n";
+
+    for (size_t bytes : sizes_bytes) {
+        Buffers buffers(bytes / sizeof(double));
+        for (const std::string& algorithm : algorithms) {
+            std::cerr << algorithm << " @ " << (bytes >> 10) << " KiB\n";
+
+            // seq ignores the worker count; it is the baseline for the rest
+            const Row seq = runWithWorkers(algorithm, "seq", std::execution::seq, 1, buffers, config);
+            printRow(seq, seq.median_us);
+
+            for (unsigned w : workers) {
+                printRow(runWithWorkers(algorithm, "par", std::execution::par, w, buffers, config),
+                         seq.median_us);
+                printRow(runWithWorkers(algorithm, "par_unseq", std::execution::par_unseq, w, buffers, config),
+                         seq.median_us);
+            }
+            std::cout.flush();
+        }
+    }
+    return 0;
+}
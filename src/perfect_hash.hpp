@@ -0,0 +1,213 @@
+/*
+Compile-time perfect hashing for fixed keyword sets (header-only, just
+#include it). Used by constexpr.cpp and 86/script_compiler.hpp.
+
+Switching on hash_string(cmd) (constexpr.cpp) never checks the key: any
+input whose djb2 hash equals HASH_STOP runs the stop branch. Such inputs
+are easy to find - "stpO" is one - and two keywords that hash alike only
+show up as a duplicate case label if someone happens to write both.
+
+make_perfect_hash() takes the whole keyword list and builds, at compile
+time, a hash-and-displace table (Pagh; the CHD family): one 64-bit hash
+per key (a few word loads, no per-byte loop), whose high half picks a bucket and whose low half plus that
+bucket's displacement picks a slot in a power-of-two table with 2 slots per
+key. Buckets are placed largest first, each with the smallest displacement
+that lands all of its keys on free slots; if some bucket cannot be placed
+the hash seed changes and the build starts over. Single-level seed search
+stops scaling at a few dozen keys; this builds hundreds in a few tries.
+
+    constexpr auto COMMANDS = make_perfect_hash<3>({"start", "stop", "pause"});
+    static_assert(COMMANDS.find("stop") == 1);
+
+    switch (COMMANDS.find(input)) {      // index into the list, or -1
+        case 0: ...
+
+Lookup is one hash of the input, a displacement and a slot load, and one
+string compare against the only keyword that can match - so "stpO" is -1, not "stop".
+Duplicate keywords, or a set with no collision-free seed, fail the
+constant evaluation: a compile error, never a silent collision.
+*/
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace perfect_hash_detail {
+
+// Fixed-width little-endian loads: byte by byte in constant evaluation,
+// one unaligned load (memcpy) at run time on little-endian targets
+template<size_t Bytes>
+constexpr uint64_t load_le(const char* p) {
+    uint64_t word = 0;
+    if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+        std::memcpy(&word, p, Bytes);
+        return word;
+    }
+    for (size_t i = 0; i < Bytes; ++i) {
+        word |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return word;
+}
+
+constexpr uint64_t step(uint64_t h, uint64_t word) {
+    h = (h ^ word) * 0xFF51AFD7ED558CCDull;
+    return h ^ (h >> 32);
+}
+
+// Reads every byte through at most ceil(n / 8) + 1 fixed-width loads, with
+// no per-byte loop: short keys use two overlapping 4-byte loads (or three
+// single bytes), the tail of a long key an overlapping 8-byte load
+constexpr uint64_t hash(std::string_view key, uint64_t seed) {
+    const char* p = key.data();
+    const size_t n = key.size();
+    uint64_t h = (14695981039346656037ull ^ seed) + n * 0x9E3779B97F4A7C15ull;
+    if (n >= 8) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            h = step(h, load_le<8>(p + i));
+        }
+        if (i < n) {
+            h = step(h, load_le<8>(p + n - 8));
+        }
+    } else if (n >= 4) {
+        h = step(h, load_le<4>(p) | (load_le<4>(p + n - 4) << 32));
+    } else if (n > 0) {
+        h = step(h, load_le<1>(p) | (load_le<1>(p + n / 2) << 8) | (load_le<1>(p + n - 1) << 16));
+    }
+    // Finalizer (from murmur3 fmix64): the slot and bucket use the low and high bits
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+constexpr size_t pow2_at_least(size_t n) {
+    size_t size = 1;
+    while (size < n) {
+        size *= 2;
+    }
+    return size;
+}
+
+constexpr size_t slot_count(size_t keys) { return pow2_at_least(2 * keys); }
+constexpr size_t bucket_count(size_t keys) { return pow2_at_least((keys + 1) / 2); }
+
+} // namespace perfect_hash_detail
+
+template<size_t N>
+class PerfectHashTable {
+    static_assert(N > 0 && N < 0xFFFF, "1 to 65534 keys");
+
+public:
+    static constexpr size_t kSlots = perfect_hash_detail::slot_count(N);
+    static constexpr size_t kBuckets = perfect_hash_detail::bucket_count(N);
+    static constexpr uint16_t kEmpty = 0xFFFF;
+
+    std::array<std::string_view, N> keys{};
+    std::array<uint32_t, kBuckets> displacement{};
+    std::array<uint16_t, kSlots> slots{};
+    uint64_t seed = 0;
+
+    static constexpr size_t slotFor(uint64_t h, uint32_t displacement) {
+        return (static_cast<uint32_t>(h) + displacement) & (kSlots - 1);
+    }
+
+    static constexpr size_t bucketFor(uint64_t h) { return (h >> 32) & (kBuckets - 1); }
+
+    /// Index of key in the original list, or -1
+    constexpr int find(std::string_view key) const {
+        const uint64_t h = perfect_hash_detail::hash(key, seed);
+        const uint16_t index = slots[slotFor(h, displacement[bucketFor(h)])];
+        return index != kEmpty && keys[index] == key ? index : -1;
+    }
+
+    static constexpr size_t size() { return N; }
+};
+
+/// Builds the table; call it in a constexpr context so failures are compile errors
+template<size_t N>
+constexpr PerfectHashTable<N> make_perfect_hash(const std::array<std::string_view, N>& keys) {
+    using Table = PerfectHashTable<N>;
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = i + 1; j < N; ++j) {
+            if (keys[i] == keys[j]) {
+                throw std::logic_error("make_perfect_hash: duplicate key");
+            }
+        }
+    }
+
+    Table table;
+    table.keys = keys;
+    std::array<uint64_t, N> hashes{};
+    std::array<size_t, Table::kBuckets> bucketSize{};
+    std::array<size_t, Table::kBuckets> order{};
+
+    for (uint64_t seed = 0; seed < 1000; ++seed) {
+        table.seed = seed;
+        bucketSize.fill(0);
+        for (size_t i = 0; i < N; ++i) {
+            hashes[i] = perfect_hash_detail::hash(keys[i], seed);
+            ++bucketSize[Table::bucketFor(hashes[i])];
+        }
+        // Largest buckets first, while the table is still empty
+        for (size_t b = 0; b < Table::kBuckets; ++b) {
+            order[b] = b;
+        }
+        for (size_t i = 1; i < Table::kBuckets; ++i) {
+            for (size_t j = i; j > 0 && bucketSize[order[j]] > bucketSize[order[j - 1]]; --j) {
+                const size_t tmp = order[j];
+                order[j] = order[j - 1];
+                order[j - 1] = tmp;
+            }
+        }
+
+        table.slots.fill(Table::kEmpty);
+        table.displacement.fill(0);
+        bool placedAll = true;
+        for (size_t b : order) {
+            if (bucketSize[b] == 0) {
+                break;
+            }
+            bool placed = false;
+            for (uint32_t d = 0; d < Table::kSlots && !placed; ++d) {
+                placed = true;
+                for (size_t i = 0; i < N && placed; ++i) {
+                    if (Table::bucketFor(hashes[i]) != b) {
+                        continue;
+                    }
+                    const size_t slot = Table::slotFor(hashes[i], d);
+                    if (table.slots[slot] != Table::kEmpty) {
+                        placed = false;
+                    } else {
+                        table.slots[slot] = static_cast<uint16_t>(i);
+                    }
+                }
+                if (placed) {
+                    table.displacement[b] = d;
+                } else {
+                    // Undo this bucket's partial placement
+                    for (size_t i = 0; i < N; ++i) {
+                        const size_t slot = Table::slotFor(hashes[i], d);
+                        if (Table::bucketFor(hashes[i]) == b && table.slots[slot] == i) {
+                            table.slots[slot] = Table::kEmpty;
+                        }
+                    }
+                }
+            }
+            if (!placed) {
+                placedAll = false;
+                break;
+            }
+        }
+        if (placedAll) {
+            return table;
+        }
+    }
+    throw std::logic_error("make_perfect_hash: no collision-free seed found");
+}
@@ -0,0 +1,481 @@
+/*
+ProfiledMutex: a drop-in std::mutex that records who waits for it, how
+long, and for how long it is then held (header-only, just #include it).
+Used by profiled_mutex_demo.cpp, and as the Mutex parameter of
+ThreadSafeQueue (105_Lock_Guards/thread_safe_queue.cpp),
+BasicThreadSafeCounter (102_Threads_Args/thread_safe_counter.cpp),
+ThreadSafePoolAllocator (allocators2.hpp) and BasicThreadPool
+(101_Threads_RAII/thread_pool.hpp).
+
+A std::mutex says nothing about contention: a convoy shows up only as
+threads that are mysteriously slow. Swap the type where you suspect one:
+
+    ThreadSafeQueue<Job, ProfiledMutex> jobs;           // was ThreadSafeQueue<Job>
+    ProfiledMutex table_mutex{"routing table"};         // named in the report
+    ...
+    mutex_profile::set_enabled(true);                   // or MUTEX_PROFILE=1 in the environment
+    mutex_profile::collect().print(std::cout);
+
+For every acquisition, lock() records:
+  - contended or not (a try_lock() first; only a failed one is timed)
+  - the wait time and, at unlock(), the hold time, each into a
+    power-of-two nanosecond histogram (bucket b: [2^(b-1), 2^b) ns, as in
+    the thread pool's queue-wait histogram)
+  - the call site: lock()'s return address. With std::lock_guard inlined
+    that is the function that took the lock; sites print as `function+0x1c`
+    when the executable is linked with -rdynamic, `file+0x1234` otherwise
+    (addr2line -e file 0x1234 gives the line).
+
+Records go to a per-thread table keyed by (mutex name, site): no shared
+counter is written on the lock path. Tables of exited threads are kept
+(and reused by new threads), so collect() sees every acquisition since
+start. Mutexes with the same name - every ThreadSafeQueue, say - are
+reported together.
+
+Compile-time: -DMUTEX_PROFILING=0 turns ProfiledMutex into a plain
+std::mutex. Run time: while disabled (the default unless MUTEX_PROFILE is
+set and not "0"), lock() costs one relaxed load more than std::mutex;
+while enabled, two clock reads and a table update per acquisition.
+*/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<dlfcn.h>) && __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#define MUTEX_PROFILE_HAS_DLADDR 1
+#else
+#define MUTEX_PROFILE_HAS_DLADDR 0
+#endif
+
+#ifndef MUTEX_PROFILING
+#define MUTEX_PROFILING 1
+#endif
+
+namespace mutex_profile {
+
+// Bucket 0 holds 0 ns, bucket b holds [2^(b-1), 2^b) ns; 40 reach ~9 minutes
+constexpr size_t kBuckets = 40;
+
+using Histogram = std::array<uint64_t, kBuckets>;
+
+inline size_t bucket_of(uint64_t ns) { return std::min<size_t>(std::bit_width(ns), kBuckets - 1); }
+
+// Upper bound of the bucket holding the q-th quantile (0 < q <= 1)
+inline uint64_t percentile_ns(const Histogram& h, double q) {
+    uint64_t total = 0;
+    for (uint64_t n : h) {
+        total += n;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const uint64_t target = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kBuckets; ++b) {
+        seen += h[b];
+        if (seen >= target) {
+            return b == 0 ? 0 : (uint64_t{1} << b);
+        }
+    }
+    return uint64_t{1} << (kBuckets - 1);
+}
+
+struct Stats {
+    uint64_t acquisitions = 0;
+    uint64_t contended = 0;
+    uint64_t wait_ns = 0;           // total, contended acquisitions only
+    uint64_t hold_ns = 0;           // total
+    Histogram wait{};               // contended acquisitions only
+    Histogram hold{};
+
+    void add(const Stats& o) {
+        acquisitions += o.acquisitions;
+        contended += o.contended;
+        wait_ns += o.wait_ns;
+        hold_ns += o.hold_ns;
+        for (size_t b = 0; b < kBuckets; ++b) {
+            wait[b] += o.wait[b];
+            hold[b] += o.hold[b];
+        }
+    }
+};
+
+struct SiteReport {
+    std::string mutex;
+    std::string site;
+    Stats stats;
+};
+
+struct MutexReport {
+    std::string mutex;
+    Stats stats;
+};
+
+struct Report {
+    std::vector<MutexReport> mutexes;   // most total wait first
+    std::vector<SiteReport> sites;      // most total wait first
+
+    void print(std::ostream& os, size_t top_sites = 10) const;
+};
+
+namespace detail {
+
+inline std::atomic<bool>& enabled_flag() {
+    static std::atomic<bool> flag = [] {
+        const char* env = std::getenv("MUTEX_PROFILE");
+        return env != nullptr && std::strcmp(env, "0") != 0;
+    }();
+    return flag;
+}
+
+inline uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+// Written by its owning thread only (relaxed load + store, no locked RMW);
+// collect() reads it at any time and sees stale but never torn values
+struct Slot {
+    std::atomic<const char*> name{nullptr};     // published last: a set name means a valid key
+    std::atomic<const void*> site{nullptr};
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contended{0};
+    std::atomic<uint64_t> wait_ns{0};
+    std::atomic<uint64_t> hold_ns{0};
+    std::array<std::atomic<uint64_t>, kBuckets> wait{};
+    std::array<std::atomic<uint64_t>, kBuckets> hold{};
+};
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t by) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+class ThreadTable {
+public:
+    // Power of two; sites beyond it are counted in one overflow slot per table
+    static constexpr size_t kSlots = 128;
+
+    void record(const char* name, const void* site, bool contended, uint64_t wait_ns, uint64_t hold_ns) {
+        Slot& s = slot_for(name, site);
+        bump(s.acquisitions, 1);
+        if (contended) {
+            bump(s.contended, 1);
+            bump(s.wait_ns, wait_ns);
+            bump(s.wait[bucket_of(wait_ns)], 1);
+        }
+        bump(s.hold_ns, hold_ns);
+        bump(s.hold[bucket_of(hold_ns)], 1);
+    }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const Slot& s : m_slots) {
+            if (const char* name = s.name.load(std::memory_order_acquire)) {
+                fn(name, s.site.load(std::memory_order_relaxed), s);
+            }
+        }
+    }
+
+    std::atomic<bool> in_use{true};
+
+private:
+    Slot& slot_for(const char* name, const void* site) {
+        size_t h = std::hash<const void*>{}(site) ^ (std::hash<const void*>{}(name) * 0x9E3779B97F4A7C15ull);
+        for (size_t probe = 0; probe < kSlots; ++probe, ++h) {
+            Slot& s = m_slots[h & (kSlots - 1)];
+            const char* owner = s.name.load(std::memory_order_relaxed);
+            if (owner == name && s.site.load(std::memory_order_relaxed) == site) {
+                return s;
+            }
+            if (owner == nullptr) {
+                s.site.store(site, std::memory_order_relaxed);
+                s.name.store(name, std::memory_order_release);
+                return s;
+            }
+        }
+        Slot& overflow = m_slots[kSlots];
+        if (overflow.name.load(std::memory_order_relaxed) == nullptr) {
+            overflow.name.store("(sites beyond the per-thread table)", std::memory_order_release);
+        }
+        return overflow;
+    }
+
+    std::array<Slot, kSlots + 1> m_slots;
+};
+
+// Owns every table ever handed out; never destroyed, since threads may
+// still lock a ProfiledMutex during static destruction
+class Tables {
+public:
+    static Tables& instance() {
+        static Tables* tables = new Tables;
+        return *tables;
+    }
+
+    ThreadTable* acquire() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& t : m_tables) {
+            bool expected = false;
+            if (t->in_use.compare_exchange_strong(expected, true)) {
+                return t.get();
+            }
+        }
+        m_tables.push_back(std::make_unique<ThreadTable>());
+        return m_tables.back().get();
+    }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& t : m_tables) {
+            fn(*t);
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadTable>> m_tables;
+};
+
+// The calling thread's table, handed back for reuse when the thread exits.
+// Null once handed back: locks taken by thread_local destructors that run
+// after that go unrecorded rather than into a table another thread owns
+inline ThreadTable* this_thread_table() {
+    thread_local bool released = false;
+    struct Lease {
+        ThreadTable* table;
+        bool& released_flag;
+        ~Lease() {
+            released_flag = true;
+            table->in_use.store(false, std::memory_order_release);
+        }
+    };
+    if (released) {
+        return nullptr;
+    }
+    thread_local Lease lease{Tables::instance().acquire(), released};
+    return lease.table;
+}
+
+inline std::string describe_site(const void* site) {
+    if (site == nullptr) {
+        return "(other)";
+    }
+    char buffer[32];
+#if MUTEX_PROFILE_HAS_DLADDR
+    Dl_info info{};
+    if (dladdr(site, &info) != 0) {
+        if (info.dli_sname != nullptr) {
+            int status = 0;
+            std::unique_ptr<char, decltype(&std::free)> demangled(
+                abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free);
+            std::snprintf(buffer, sizeof(buffer), "+0x%zx",
+                          static_cast<size_t>(static_cast<const char*>(site) - static_cast<const char*>(info.dli_saddr)));
+            return std::string(status == 0 ? demangled.get() : info.dli_sname) + buffer;
+        }
+        if (info.dli_fname != nullptr) {
+            std::snprintf(buffer, sizeof(buffer), "+0x%zx",
+                          static_cast<size_t>(static_cast<const char*>(site) - static_cast<const char*>(info.dli_fbase)));
+            const char* slash = std::strrchr(info.dli_fname, '/');
+            return std::string(slash ? slash + 1 : info.dli_fname) + buffer;
+        }
+    }
+#endif
+    std::snprintf(buffer, sizeof(buffer), "%p", site);
+    return buffer;
+}
+
+} // namespace detail
+
+#if MUTEX_PROFILING
+inline bool enabled() { return detail::enabled_flag().load(std::memory_order_relaxed); }
+inline void set_enabled(bool on) { detail::enabled_flag().store(on, std::memory_order_relaxed); }
+#else
+constexpr bool enabled() { return false; }
+inline void set_enabled(bool) {}
+#endif
+
+// For a container's member initializer: a Mutex named `name` if it takes
+// one (ProfiledMutex), a default-constructed one otherwise (std::mutex)
+template<typename Mutex>
+Mutex make_mutex(const char* name) {
+    if constexpr (std::is_constructible_v<Mutex, const char*>) {
+        return Mutex(name);
+    } else {
+        return Mutex();
+    }
+}
+
+// Merges every thread's table: per mutex name and per (name, site)
+inline Report collect() {
+    std::map<std::pair<std::string, const void*>, Stats> by_site;
+    detail::Tables::instance().for_each([&](const detail::ThreadTable& table) {
+        table.for_each([&](const char* name, const void* site, const detail::Slot& s) {
+            Stats st;
+            st.acquisitions = s.acquisitions.load(std::memory_order_relaxed);
+            st.contended = s.contended.load(std::memory_order_relaxed);
+            st.wait_ns = s.wait_ns.load(std::memory_order_relaxed);
+            st.hold_ns = s.hold_ns.load(std::memory_order_relaxed);
+            for (size_t b = 0; b < kBuckets; ++b) {
+                st.wait[b] = s.wait[b].load(std::memory_order_relaxed);
+                st.hold[b] = s.hold[b].load(std::memory_order_relaxed);
+            }
+            by_site[{name, site}].add(st);
+        });
+    });
+
+    Report report;
+    std::map<std::string, Stats> by_mutex;
+    for (const auto& [key, stats] : by_site) {
+        by_mutex[key.first].add(stats);
+        report.sites.push_back(SiteReport{key.first, detail::describe_site(key.second), stats});
+    }
+    for (const auto& [name, stats] : by_mutex) {
+        report.mutexes.push_back(MutexReport{name, stats});
+    }
+    auto more_wait = [](const auto& a, const auto& b) { return a.stats.wait_ns > b.stats.wait_ns; };
+    std::stable_sort(report.mutexes.begin(), report.mutexes.end(), more_wait);
+    std::stable_sort(report.sites.begin(), report.sites.end(), more_wait);
+    return report;
+}
+
+inline void Report::print(std::ostream& os, size_t top_sites) const {
+    const auto flags = os.flags();
+    const auto precision = os.precision();
+    os << std::fixed << std::setprecision(1);
+    os << std::left << std::setw(28) << "mutex" << std::right << std::setw(12) << "acquired" << std::setw(20)
+       << "contended" << std::setw(12) << "wait ms" << std::setw(11) << "wait p50" << std::setw(11) << "wait p99"
+       << std::setw(11) << "hold p50" << std::setw(11) << "hold p99" << "   (percentiles: ns bucket bounds)\n";
+    for (const MutexReport& m : mutexes) {
+        const Stats& s = m.stats;
+        // The count, and the share to two significant digits: a handful of
+        // long waits among 100k acquisitions must not print as 0.00%
+        std::ostringstream contended;
+        contended << s.contended << " (" << std::setprecision(2)
+                  << (s.acquisitions ? 100.0 * static_cast<double>(s.contended) / static_cast<double>(s.acquisitions) : 0.0)
+                  << "%)";
+        os << std::left << std::setw(28) << m.mutex.substr(0, 27) << std::right << std::setw(12) << s.acquisitions
+           << std::setw(20) << contended.str() << std::setw(12) << s.wait_ns / 1e6 << std::setw(11) << percentile_ns(s.wait, 0.5) << std::setw(11)
+           << percentile_ns(s.wait, 0.99) << std::setw(11) << percentile_ns(s.hold, 0.5) << std::setw(11)
+           << percentile_ns(s.hold, 0.99) << "\n";
+    }
+    os << "top contending sites:\n";
+    for (size_t i = 0; i < sites.size() && i < top_sites; ++i) {
+        const SiteReport& site = sites[i];
+        if (site.stats.contended == 0) {
+            break;
+        }
+        os << "  " << std::setw(10) << site.stats.wait_ns / 1e6 << " ms over " << site.stats.contended
+           << " waits  " << site.mutex << "  at " << site.site << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+} // namespace mutex_profile
+
+class ProfiledMutex {
+public:
+    // name must outlive the mutex (a string literal); mutexes sharing a
+    // name are reported together
+    explicit ProfiledMutex(const char* name = "unnamed ProfiledMutex") noexcept : m_name(name) {}
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+#if MUTEX_PROFILING
+    // Not inlined, so the return address is the caller's (lock_guard's
+    // constructor inlines into it)
+    [[gnu::noinline]] void lock() {
+        if (!mutex_profile::enabled()) {
+            m_mutex.lock();
+            m_timed = false;
+            return;
+        }
+        const void* site = __builtin_return_address(0);
+        uint64_t wait_ns = 0;
+        const bool contended = !m_mutex.try_lock();
+        if (contended) {
+            const uint64_t t0 = mutex_profile::detail::now_ns();
+            m_mutex.lock();
+            wait_ns = mutex_profile::detail::now_ns() - t0;
+        }
+        begin_hold(site, contended, wait_ns);
+    }
+
+    [[gnu::noinline]] bool try_lock() {
+        if (!m_mutex.try_lock()) {
+            return false;
+        }
+        m_timed = mutex_profile::enabled();
+        if (m_timed) {
+            begin_hold(__builtin_return_address(0), false, 0);
+        }
+        return true;
+    }
+
+    // Recorded after the unlock, so profiling does not lengthen the
+    // critical section it measures
+    void unlock() {
+        if (!m_timed) {
+            m_mutex.unlock();
+            return;
+        }
+        m_timed = false;
+        const uint64_t hold_ns = mutex_profile::detail::now_ns() - m_locked_at;
+        const void* site = m_site;
+        const bool contended = m_contended;
+        const uint64_t wait_ns = m_wait_ns;
+        m_mutex.unlock();
+        if (mutex_profile::detail::ThreadTable* table = mutex_profile::detail::this_thread_table()) {
+            table->record(m_name, site, contended, wait_ns, hold_ns);
+        }
+    }
+#else
+    void lock() { m_mutex.lock(); }
+    bool try_lock() { return m_mutex.try_lock(); }
+    void unlock() { m_mutex.unlock(); }
+#endif
+
+    const char* name() const { return m_name; }
+
+private:
+#if MUTEX_PROFILING
+    // Owner-only state, written and read while the mutex is held
+    void begin_hold(const void* site, bool contended, uint64_t wait_ns) {
+        m_site = site;
+        m_contended = contended;
+        m_wait_ns = wait_ns;
+        m_timed = true;
+        m_locked_at = mutex_profile::detail::now_ns();
+    }
+
+    const void* m_site = nullptr;
+    uint64_t m_locked_at = 0;
+    uint64_t m_wait_ns = 0;
+    bool m_contended = false;
+    bool m_timed = false;
+#endif
+    std::mutex m_mutex;
+    const char* m_name;
+};
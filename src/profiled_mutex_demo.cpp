@@ -0,0 +1,105 @@
+// g++ -std=c++20 -O2 -pthread -rdynamic profiled_mutex_demo.cpp -o app
+
+#include <atomic>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "101_Threads_RAII/thread_pool.hpp"
+#include "allocators2.hpp"
+#include "microbench.hpp"
+#include "profiled_mutex.hpp"
+
+// ============================================================================
+// 1. WHAT IT COSTS: uncontended lock + unlock
+// ============================================================================
+template<typename Mutex>
+microbench::Result lock_unlock(const char* name, Mutex& m) {
+    constexpr size_t kOps = 1 << 20;
+    int guarded = 0;
+    return microbench::run(name, kOps, [&] {
+        for (size_t i = 0; i < kOps; ++i) {
+            std::lock_guard<Mutex> lock(m);
+            ++guarded;
+        }
+        microbench::do_not_optimize(guarded);
+    }, {1, 7});
+}
+
+void benchmarkOverhead() {
+    std::cout << "\n=== UNCONTENDED lock() + unlock() ===\n";
+    std::mutex plain;
+    ProfiledMutex profiled{"overhead probe"};
+
+    const auto baseline = lock_unlock("std::mutex", plain);
+    microbench::report(baseline);
+    mutex_profile::set_enabled(false);
+    const auto disabled = lock_unlock("ProfiledMutex, profiling off", profiled);
+    microbench::report(disabled);
+    mutex_profile::set_enabled(true);
+    const auto enabled = lock_unlock("ProfiledMutex, profiling on", profiled);
+    microbench::report(enabled);
+    mutex_profile::set_enabled(false);
+
+    microbench::compare(baseline, disabled);
+    microbench::compare(baseline, enabled);
+}
+
+// ============================================================================
+// 2. A THREAD POOL FED FROM SEVERAL THREADS, AND A SHARED POOL ALLOCATOR
+// ============================================================================
+void profileContainers() {
+    constexpr int kSubmitters = 4;
+    constexpr int kTasksEach = 20000;
+    std::cout << "\n=== " << kSubmitters << " THREADS SUBMIT " << kTasksEach
+              << " TINY TASKS EACH; LISTS ON A PROFILED POOL ALLOCATOR ===\n";
+    mutex_profile::set_enabled(true);
+
+    std::atomic<int> done{0};
+    {
+        BasicThreadPool<ProfiledMutex> pool(4);
+        std::vector<std::thread> submitters;
+        for (int s = 0; s < kSubmitters; ++s) {
+            submitters.emplace_back([&] {
+                for (int i = 0; i < kTasksEach; ++i) {
+                    pool.enqueue([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+                }
+            });
+        }
+        for (auto& t : submitters) {
+            t.join();
+        }
+    }
+
+    // Every thread builds and frees lists: the depot is visited once per
+    // magazine of 64 nodes
+    using ProfiledList = std::list<int, ThreadSafePoolAllocator<int, 1024, ProfiledMutex>>;
+    std::vector<std::thread> builders;
+    for (int t = 0; t < 4; ++t) {
+        builders.emplace_back([] {
+            for (int round = 0; round < 200; ++round) {
+                ProfiledList list;
+                for (int i = 0; i < 1000; ++i) {
+                    list.push_back(i);
+                }
+            }
+        });
+    }
+    for (auto& t : builders) {
+        t.join();
+    }
+    mutex_profile::set_enabled(false);
+
+    std::cout << done.load() << " tasks ran\n";
+    mutex_profile::collect().print(std::cout, 6);
+}
+
+int main() {
+    std::cout << "MUTEX_PROFILING=" << MUTEX_PROFILING << ", " << std::thread::hardware_concurrency()
+              << " hardware threads\n";
+    benchmarkOverhead();
+    profileContainers();
+    return 0;
+}
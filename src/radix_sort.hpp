@@ -0,0 +1,178 @@
+/*
+LSD radix sort for integer and floating-point keys (header-only, just
+#include it). Used by parallel_stl.cpp and algorithms.cpp.
+
+std::sort compares: O(n log n) comparisons, each a hard-to-predict branch.
+When the key is a 32/64-bit number, a radix sort never compares. It makes
+one counting pass plus one scatter pass per byte of the key, whatever the
+input looks like, so it is O(n * sizeof(key)):
+
+    radix_sort(keys);                                  // vector<uint32_t>, ...
+    radix_sort(records, &Record::key);                 // key + payload
+    radix_sort(pool, prices, [](const Order& o) { return o.price; });
+
+The projection picks the key out of each element (std::identity by default;
+anything std::invoke accepts). One pass per byte, least significant first:
+
+  1. histogram  the input is cut into blocks, each block counts its digits
+  2. offsets    a prefix sum over (digit, block) gives every block its own
+                output position for every digit
+  3. scatter    each block moves its elements to those positions
+
+Steps 1 and 3 touch disjoint blocks, so with a ThreadPoolRAII they run in
+parallel without atomics; each block writes only the slots step 2 reserved
+for it. Blocks are processed in order within a digit, so every pass is
+stable and so is the whole sort. A pass where all keys share the digit
+(e.g. the high bytes of small ints) is skipped.
+
+Signed and floating-point keys are mapped to unsigned integers that sort
+the same way: flip the sign bit of a signed int; for an IEEE float flip all
+bits of a negative value and only the sign bit of a positive one. -0.0 then
+sorts just before +0.0, and NaNs go to the ends by sign.
+
+Inputs under kRadixSortThreshold go to std::stable_sort on the mapped keys,
+where the per-pass overhead would dominate; so every size sorts stably.
+
+Needs a scratch buffer of n elements; elements are moved, not copied.
+*/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "101_Threads_RAII/thread_pool.hpp"
+
+// Below this, std::stable_sort wins
+inline constexpr size_t kRadixSortThreshold = 2048;
+
+template<typename K>
+concept RadixKey = (std::integral<K> && !std::same_as<K, bool>) ||
+                   std::same_as<K, float> || std::same_as<K, double>;
+
+namespace radix_detail {
+
+// The unsigned integer of the same size as K, ordered like K
+template<RadixKey K>
+auto ordered_bits(K key) {
+    if constexpr (std::is_floating_point_v<K>) {
+        using U = std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>;
+        constexpr U sign = U(1) << (sizeof(U) * 8 - 1);
+        const U bits = std::bit_cast<U>(key);
+        return (bits & sign) ? U(~bits) : U(bits | sign);
+    } else if constexpr (std::is_signed_v<K>) {
+        using U = std::make_unsigned_t<K>;
+        constexpr U sign = U(1) << (sizeof(U) * 8 - 1);
+        return U(static_cast<U>(key) ^ sign);
+    } else {
+        return key;
+    }
+}
+
+constexpr size_t kRadix = 256;
+
+// Blocks of at least this many elements, at most kMaxBlocks of them: enough
+// to spread over the pool, few enough that the histograms (2 KiB each) and
+// the prefix sum stay small
+constexpr size_t kMinBlockElements = 16 * 1024;
+constexpr size_t kMaxBlocks = 64;
+
+// for_blocks(blocks, fn) calls fn(block) for every block in [0, blocks),
+// in any order and possibly concurrently
+template<typename T, typename Proj, typename ForBlocks>
+void lsd_sort(T* data, size_t n, Proj& proj, ForBlocks&& for_blocks) {
+    using Key = std::remove_cvref_t<std::invoke_result_t<Proj&, const T&>>;
+    using Bits = decltype(ordered_bits(std::declval<Key>()));
+
+    auto bits_of = [&proj](const T& x) { return ordered_bits(std::invoke(proj, x)); };
+
+    if (n < kRadixSortThreshold) {
+        std::stable_sort(data, data + n, [&](const T& a, const T& b) { return bits_of(a) < bits_of(b); });
+        return;
+    }
+
+    const size_t blocks = std::clamp<size_t>(n / kMinBlockElements, 1, kMaxBlocks);
+    auto block_begin = [n, blocks](size_t b) { return n * b / blocks; };
+
+    std::vector<T> scratch(n);
+    T* src = data;
+    T* dst = scratch.data();
+    std::vector<std::array<size_t, kRadix>> counts(blocks);
+
+    for (unsigned shift = 0; shift < sizeof(Bits) * 8; shift += 8) {
+        auto digit = [&bits_of, shift](const T& x) { return static_cast<size_t>((bits_of(x) >> shift) & 0xFF); };
+
+        for_blocks(blocks, [&](size_t b) {
+            std::array<size_t, kRadix>& count = counts[b];
+            count.fill(0);
+            for (size_t i = block_begin(b), e = block_begin(b + 1); i < e; ++i) {
+                ++count[digit(src[i])];
+            }
+        });
+
+        // Digit-major, block-minor: all of block 0's zeros, then block 1's
+        // zeros, ... then block 0's ones - which is what keeps it stable
+        size_t total = 0;
+        bool all_one_digit = false;
+        for (size_t d = 0; d < kRadix; ++d) {
+            size_t digit_total = 0;
+            for (size_t b = 0; b < blocks; ++b) {
+                const size_t c = counts[b][d];
+                counts[b][d] = total + digit_total;
+                digit_total += c;
+            }
+            all_one_digit |= digit_total == n;
+            total += digit_total;
+        }
+        if (all_one_digit) {
+            // Every key has the same byte here: the pass would be a copy
+            continue;
+        }
+
+        for_blocks(blocks, [&](size_t b) {
+            std::array<size_t, kRadix>& next = counts[b];
+            for (size_t i = block_begin(b), e = block_begin(b + 1); i < e; ++i) {
+                dst[next[digit(src[i])]++] = std::move(src[i]);
+            }
+        });
+        std::swap(src, dst);
+    }
+
+    if (src != data) {
+        std::move(src, src + n, data);
+    }
+}
+
+}  // namespace radix_detail
+
+// Sorts a contiguous range by proj(element), on the calling thread
+template<std::ranges::contiguous_range R, typename Proj = std::identity>
+    requires RadixKey<std::remove_cvref_t<std::invoke_result_t<Proj&, std::ranges::range_reference_t<R>>>>
+void radix_sort(R&& range, Proj proj = {}) {
+    radix_detail::lsd_sort(std::ranges::data(range), std::ranges::size(range), proj,
+                           [](size_t blocks, auto&& fn) {
+                               for (size_t b = 0; b < blocks; ++b) {
+                                   fn(b);
+                               }
+                           });
+}
+
+// The same, with the histogram and scatter steps of every pass spread over
+// the pool's workers (the calling thread helps)
+template<std::ranges::contiguous_range R, typename Proj = std::identity>
+    requires RadixKey<std::remove_cvref_t<std::invoke_result_t<Proj&, std::ranges::range_reference_t<R>>>>
+void radix_sort(ThreadPoolRAII& pool, R&& range, Proj proj = {}) {
+    radix_detail::lsd_sort(std::ranges::data(range), std::ranges::size(range), proj,
+                           [&pool](size_t blocks, auto&& fn) {
+                               pool.parallel_for(size_t{0}, blocks, size_t{1}, [&fn](size_t b) { fn(b); });
+                           });
+}
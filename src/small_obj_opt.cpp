@@ -1,6 +1,19 @@
+/*
+g++ -std=c++20 -O2 small_obj_opt.cpp -o app
+*/
+
 #include <iostream>
 #include <memory>
 #include <type_traits>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "allocators1.hpp"
 
 // Empty classes still have size >= 1
 struct EmptyClass {};
@@ -170,6 +183,293 @@ public:
     const T2& second() const { return second_; }
 };
 
+// small_vector: up to N elements live inside the object itself, so a vector
+// that stays small never touches the heap. Past N it moves everything to a
+// block from the allocator and grows like std::vector.
+//
+// The allocator and the data pointer share a CompressedPair, so a stateless
+// allocator (std::allocator, TrackingAllocator) adds no bytes; a stateful
+// one (PoolAllocator, ArenaAllocator: one pointer each) costs exactly its
+// own size. Iterators are plain pointers (contiguous, like std::vector's),
+// and they are invalidated by growth and by moving an inline small_vector.
+template<typename T, size_t N, typename Alloc = std::allocator<T>>
+class small_vector {
+    static_assert(N > 0, "use std::vector for N == 0");
+    using Traits = std::allocator_traits<Alloc>;
+
+    CompressedPair<Alloc, T*> storage_;     // allocator, data pointer
+    size_t size_ = 0;
+    size_t capacity_ = N;
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+
+    Alloc& alloc() { return storage_.first(); }
+    T*& ptr() { return storage_.second(); }
+    T* ptr() const { return storage_.second(); }
+    T* inline_data() { return std::launder(reinterpret_cast<T*>(inline_)); }
+
+    void destroy_all() {
+        for (size_t i = 0; i < size_; ++i) {
+            Traits::destroy(alloc(), ptr() + i);
+        }
+        size_ = 0;
+    }
+
+    void free_heap() {
+        if (!is_inline()) {
+            Traits::deallocate(alloc(), ptr(), capacity_);
+            ptr() = inline_data();
+            capacity_ = N;
+        }
+    }
+
+    // Moves the elements into a heap block of new_capacity, with the element
+    // built from args (if any) first, so an argument referring into the
+    // vector stays valid
+    template<typename... Args>
+    void grow(size_t new_capacity, Args&&... args) {
+        T* block = Traits::allocate(alloc(), new_capacity);
+        size_t built = 0;
+        try {
+            if constexpr (sizeof...(Args) > 0) {
+                Traits::construct(alloc(), block + size_, std::forward<Args>(args)...);
+            }
+            for (; built < size_; ++built) {
+                Traits::construct(alloc(), block + built, std::move_if_noexcept(ptr()[built]));
+            }
+        } catch (...) {
+            for (size_t i = 0; i < built; ++i) {
+                Traits::destroy(alloc(), block + i);
+            }
+            if constexpr (sizeof...(Args) > 0) {
+                Traits::destroy(alloc(), block + size_);
+            }
+            Traits::deallocate(alloc(), block, new_capacity);
+            throw;
+        }
+        const size_t n = size_;
+        destroy_all();
+        free_heap();
+        ptr() = block;
+        capacity_ = new_capacity;
+        size_ = n;
+    }
+
+    // Takes other's elements: its heap block if it has one, else moves
+    // them one by one out of its inline buffer
+    void steal(small_vector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (other.is_inline()) {
+            for (size_t i = 0; i < other.size_; ++i) {
+                Traits::construct(alloc(), ptr() + i, std::move(other.ptr()[i]));
+            }
+            size_ = other.size_;
+            other.destroy_all();
+        } else {
+            ptr() = other.ptr();
+            capacity_ = other.capacity_;
+            size_ = other.size_;
+            other.ptr() = other.inline_data();
+            other.capacity_ = N;
+            other.size_ = 0;
+        }
+    }
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    small_vector() : storage_(Alloc(), nullptr) { ptr() = inline_data(); }
+    explicit small_vector(const Alloc& a) : storage_(a, nullptr) { ptr() = inline_data(); }
+
+    small_vector(std::initializer_list<T> init, const Alloc& a = Alloc()) : small_vector(a) {
+        reserve(init.size());
+        for (const T& x : init) {
+            emplace_back(x);
+        }
+    }
+
+    small_vector(const small_vector& other)
+        : small_vector(Traits::select_on_container_copy_construction(other.storage_.first())) {
+        reserve(other.size_);
+        for (const T& x : other) {
+            emplace_back(x);
+        }
+    }
+
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : small_vector(other.storage_.first()) {
+        steal(other);
+    }
+
+    // Both assume equal allocators (true for all the ones above when they
+    // share a pool or arena)
+    small_vector& operator=(const small_vector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size_);
+            for (const T& x : other) {
+                emplace_back(x);
+            }
+        }
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &other) {
+            destroy_all();
+            free_heap();
+            steal(other);
+        }
+        return *this;
+    }
+
+    ~small_vector() {
+        destroy_all();
+        free_heap();
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ < capacity_) {
+            Traits::construct(alloc(), ptr() + size_, std::forward<Args>(args)...);
+        } else {
+            grow(capacity_ * 2, std::forward<Args>(args)...);
+        }
+        return ptr()[size_++];
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() {
+        --size_;
+        Traits::destroy(alloc(), ptr() + size_);
+    }
+
+    void reserve(size_t n) {
+        if (n > capacity_) {
+            grow(n);
+        }
+    }
+
+    void resize(size_t n) {
+        reserve(n);
+        while (size_ > n) {
+            pop_back();
+        }
+        while (size_ < n) {
+            emplace_back();
+        }
+    }
+
+    // Keeps the heap block, if any, like std::vector::clear
+    void clear() { destroy_all(); }
+
+    T& operator[](size_t i) { return ptr()[i]; }
+    const T& operator[](size_t i) const { return ptr()[i]; }
+    T& front() { return ptr()[0]; }
+    T& back() { return ptr()[size_ - 1]; }
+
+    T* data() { return ptr(); }
+    const T* data() const { return ptr(); }
+    iterator begin() { return ptr(); }
+    iterator end() { return ptr() + size_; }
+    const_iterator begin() const { return ptr(); }
+    const_iterator end() const { return ptr() + size_; }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    bool is_inline() const { return capacity_ == N; }
+    static constexpr size_t inline_capacity() { return N; }
+
+    allocator_type get_allocator() const { return storage_.first(); }
+};
+
+// Counts heap allocations without printing them (TrackingAllocator logs
+// every call, which would swamp the benchmark)
+struct AllocationCount {
+    static inline size_t count = 0;
+};
+
+template<typename T>
+struct CountingAllocator {
+    using value_type = T;
+    CountingAllocator() = default;
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+    T* allocate(size_t n) {
+        ++AllocationCount::count;
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* p, size_t n) noexcept { std::allocator<T>{}.deallocate(p, n); }
+    bool operator==(const CountingAllocator&) const = default;
+};
+
+volatile long long benchmark_sink;
+
+// Builds `rounds` vectors of `len` ints, the pattern of a function that
+// collects a few results into a local vector
+template<typename Vec>
+void benchSmallVectors(const char* label, size_t len, size_t rounds) {
+    AllocationCount::count = 0;
+    long long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        Vec v;
+        for (size_t i = 0; i < len; ++i) {
+            v.push_back(static_cast<int>(r + i));
+        }
+        for (int x : v) {
+            sum += x;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(rounds);
+    std::cout << "  " << label << " len " << len << ": " << ns << " ns/vector, "
+              << AllocationCount::count << " allocations\n";
+    benchmark_sink = sum;
+}
+
+void demoSmallVector() {
+    std::cout << "\n=== small_vector ===\n";
+    std::cout << "sizeof(small_vector<int, 8>): " << sizeof(small_vector<int, 8>) << " bytes (32 inline + 24)\n";
+    std::cout << "sizeof(small_vector<int, 8, PoolAllocator<int>>): "
+              << sizeof(small_vector<int, 8, PoolAllocator<int>>) << " bytes (+ the pool pointer)\n";
+
+    // TrackingAllocator (allocators1.hpp) prints every call: nothing until
+    // the 9th element
+    {
+        small_vector<int, 8, TrackingAllocator<int>> v;
+        for (int i = 0; i < 8; ++i) {
+            v.push_back(i);
+        }
+        std::cout << "8 elements, inline: " << std::boolalpha << v.is_inline() << "\n";
+        v.push_back(8);
+        std::cout << "9 elements, inline: " << v.is_inline() << ", capacity " << v.capacity() << "\n";
+    }
+
+    // Spilled blocks can come from a pool or an arena just as well
+    small_vector<int, 4, PoolAllocator<int>> pooled = {1, 2, 3, 4, 5, 6};
+    Arena arena(4096);
+    small_vector<int, 4, ArenaAllocator<int>> in_arena{ArenaAllocator<int>(arena)};
+    for (int i = 0; i < 10; ++i) {
+        in_arena.push_back(i * i);
+    }
+    std::cout << "pooled back(): " << pooled.back() << ", arena back(): " << in_arena.back()
+              << ", sorted with std::sort: ";
+    std::sort(in_arena.begin(), in_arena.end(), std::greater<>());
+    std::cout << in_arena.front() << "...\n";
+
+    std::cout << "Benchmark (1M vectors each):\n";
+    for (size_t len : {4u, 8u, 16u}) {
+        benchSmallVectors<std::vector<int, CountingAllocator<int>>>("std::vector        ", len, 1'000'000);
+        benchSmallVectors<small_vector<int, 8, CountingAllocator<int>>>("small_vector<int,8>", len, 1'000'000);
+    }
+}
+
 int main() {
     std::cout << "=== Empty Base Optimization Demo ===\n\n";
     
@@ -218,6 +518,8 @@ int main() {
     
     CompressedPair<int, EmptyClass> cp(42, EmptyClass{});
     std::cout << "First: " << cp.first() << "\n";
+
+    demoSmallVector();
     
     return 0;
 }
\ No newline at end of file
@@ -1,8 +1,26 @@
+/*
+g++ -std=c++20 -O2 smart_pointers.cpp -o app -pthread
+*/
+
 #include <iostream>
 #include <memory>
 #include <vector>
 #include <string>
 #include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <random>
+#include <unordered_map>
+#include <utility>
+
+#include "205_Data_Structures/slot_map.hpp"
 
 // ============================================================================
 // 1. BASIC UNIQUE_PTR USAGE
@@ -65,8 +83,10 @@ void customDeleterExample() {
         }
     };
 
+    // Under the temp directory, so running the demo leaves nothing in the tree
+    const std::string path = (std::filesystem::temp_directory_path() / "smart_pointers_demo.txt").string();
     std::unique_ptr<FILE, decltype(fileDeleter)> file(
-        fopen("test.txt", "w"),
+        fopen(path.c_str(), "w"),
         fileDeleter
     );
 
@@ -348,35 +368,159 @@ public:
     int getId() const { return id; }
 };
 
+// WeakCache: id -> weak_ptr in a hash map, so a lookup is one hash probe
+// and one lock() instead of a lock() per entry.
+//
+// The map is split into ShardCount shards, each with its own mutex; threads
+// asking for different ids rarely touch the same lock. A miss constructs the
+// object with make_shared (object and control block in one allocation) while
+// holding the shard lock, so two threads asking for the same id get the same
+// object, never two.
+//
+// Expired entries are not removed on every call. A shard sweeps itself when
+// an insert brings it to twice the size it had after its last sweep, which
+// keeps cleanup amortized O(1) per insert. Until then a dead entry's weak_ptr
+// still pins its make_shared block (the object is destroyed, the storage is
+// not), so the sweep also bounds that memory.
+template<typename Key, typename T, size_t ShardCount = 16, typename Hash = std::hash<Key>>
+class WeakCache {
+    static_assert((ShardCount & (ShardCount - 1)) == 0, "ShardCount must be a power of two");
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::unordered_map<Key, std::weak_ptr<T>, Hash> entries;
+        size_t sweep_at = 8;
+    };
+
+    std::array<Shard, ShardCount> shards_;
+
+    Shard& shard_for(const Key& key) {
+        // std::hash<int> is the identity: mix before taking the top bits
+        const uint64_t h = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+        return shards_[ShardCount == 1 ? 0 : h >> (64 - std::countr_zero(ShardCount))];
+    }
+
+    static void sweep(Shard& shard) {
+        std::erase_if(shard.entries, [](const auto& entry) { return entry.second.expired(); });
+        shard.sweep_at = std::max<size_t>(8, 2 * shard.entries.size());
+    }
+
+public:
+    // Returns the cached object for key, or constructs one from args.
+    // The bool is true when the object was created, like map::try_emplace.
+    template<typename... Args>
+    std::pair<std::shared_ptr<T>, bool> acquire(const Key& key, Args&&... args) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto [it, inserted] = shard.entries.try_emplace(key);
+        if (!inserted) {
+            if (auto obj = it->second.lock()) {
+                return {std::move(obj), false};
+            }
+        }
+        // If make_shared throws, the entry stays behind expired and the next
+        // sweep drops it
+        auto obj = std::make_shared<T>(std::forward<Args>(args)...);
+        it->second = obj;
+        if (inserted && shard.entries.size() >= shard.sweep_at) {
+            sweep(shard);
+        }
+        return {std::move(obj), true};
+    }
+
+    // Cached object for key, or nullptr; never constructs
+    std::shared_ptr<T> find(const Key& key) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        return it == shard.entries.end() ? nullptr : it->second.lock();
+    }
+
+    // Entries including expired ones not swept yet
+    size_t size() {
+        size_t total = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.entries.size();
+        }
+        return total;
+    }
+
+    void purge() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            sweep(shard);
+        }
+    }
+};
+
 class Cache {
-    std::vector<std::weak_ptr<ExpensiveObject>> cache;
+    WeakCache<int, ExpensiveObject> objects;
 public:
     std::shared_ptr<ExpensiveObject> get(int id) {
-        // Clean expired entries
+        auto [obj, created] = objects.acquire(id, id);
+        std::cout << (created ? "Cache miss for " : "Cache hit for ") << id << "\n";
+        return obj;
+    }
+};
+
+// The previous Cache, kept for the comparison below: every get() sweeps the
+// whole vector and then lock()s entries until the id matches - O(n) atomic
+// read-modify-writes per lookup
+template<typename T>
+class LinearScanCache {
+    std::vector<std::weak_ptr<T>> cache;
+public:
+    std::shared_ptr<T> get(int id) {
         cache.erase(
             std::remove_if(cache.begin(), cache.end(),
                 [](const auto& weak) { return weak.expired(); }),
             cache.end()
         );
-
-        // Check if object exists in cache
         for (auto& weak : cache) {
             if (auto obj = weak.lock()) {
                 if (obj->getId() == id) {
-                    std::cout << "Cache hit for " << id << "\n";
                     return obj;
                 }
             }
         }
-
-        // Cache miss - create new
-        std::cout << "Cache miss for " << id << "\n";
-        auto obj = std::make_shared<ExpensiveObject>(id);
+        auto obj = std::make_shared<T>(id);
         cache.push_back(obj);
         return obj;
     }
 };
 
+struct QuietObject {
+    int id;
+    std::array<char, 56> payload{};
+    explicit QuietObject(int i) : id(i) {}
+    int getId() const { return id; }
+};
+
+volatile long long cache_sink;
+
+template<typename CacheT>
+double benchCacheLookups(CacheT& cache, int live, int lookups) {
+    std::vector<std::shared_ptr<QuietObject>> holders;
+    for (int id = 0; id < live; ++id) {
+        holders.push_back(cache.get(id));
+    }
+    long long sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; ++i) {
+        sum += cache.get((i * 7919) % live)->getId();
+    }
+    auto end = std::chrono::steady_clock::now();
+    cache_sink = sum;
+    return std::chrono::duration<double, std::nano>(end - start).count() / lookups;
+}
+
+struct QuietWeakCache {
+    WeakCache<int, QuietObject> objects;
+    std::shared_ptr<QuietObject> get(int id) { return objects.acquire(id, id).first; }
+};
+
 void cachePatternExample() {
     std::cout << "\n=== CACHE PATTERN ===\n";
 
@@ -392,6 +536,41 @@ void cachePatternExample() {
 
     std::cout << "After scope, trying to get object 1:\n";
     auto obj1_later = cache.get(1); // Cache miss (expired)
+
+    // Lookup cost against the old linear scan, small and large cache
+    for (int live : {100, 2000}) {
+        LinearScanCache<QuietObject> linear;
+        QuietWeakCache hashed;
+        const double linear_ns = benchCacheLookups(linear, live, 20000);
+        const double hashed_ns = benchCacheLookups(hashed, live, 20000);
+        std::cout << live << " live objects: linear scan " << linear_ns
+                  << " ns/lookup, WeakCache " << hashed_ns << " ns/lookup\n";
+    }
+
+    // Four threads sharing one cache: every thread sees the same object per
+    // id, and short-lived objects get swept instead of piling up
+    WeakCache<int, QuietObject> shared_cache;
+    auto keep = shared_cache.acquire(42, 42).first;
+    std::vector<std::thread> threads;
+    std::array<bool, 4> same{};
+    for (size_t t = 0; t < same.size(); ++t) {
+        threads.emplace_back([&shared_cache, &same, &keep, t] {
+            bool all_same = true;
+            for (int i = 0; i < 100000; ++i) {
+                shared_cache.acquire(i % 4096, i % 4096);
+                all_same &= shared_cache.acquire(42, 42).first == keep;
+            }
+            same[t] = all_same;
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    std::cout << "Threads saw one object for id 42: " << std::boolalpha
+              << std::all_of(same.begin(), same.end(), [](bool b) { return b; })
+              << ", entries left before purge: " << shared_cache.size();
+    shared_cache.purge();
+    std::cout << ", after: " << shared_cache.size() << "\n";
 }
 
 // ============================================================================
@@ -438,6 +617,162 @@ void sizeComparison() {
     std::cout << "weak_ptr:      " << sizeof(std::weak_ptr<int>) << " bytes\n";
 }
 
+// ============================================================================
+// 12. HANDLES INSTEAD OF SHARED_PTR / WEAK_PTR EDGES
+// ============================================================================
+// The Parent/Child graph of section 7 again, with the owners being two
+// SlotMaps (205_Data_Structures/slot_map.hpp): edges are 4-byte generational
+// handles, a dead parent is detected like an expired weak_ptr, and no edge
+// touches a reference count.
+
+struct SharedChild;
+
+struct SharedParent {
+    std::vector<std::shared_ptr<SharedChild>> children;
+    int value = 0;
+};
+
+struct SharedChild {
+    std::weak_ptr<SharedParent> parent;
+    int value = 0;
+};
+
+struct SlotChild;
+
+struct SlotParent {
+    std::vector<Handle<SlotChild>> children;
+    int value = 0;
+};
+
+struct SlotChild {
+    Handle<SlotParent> parent;
+    int value = 0;
+};
+
+void handleGraphExample() {
+    std::cout << "\n=== HANDLES INSTEAD OF SHARED_PTR / WEAK_PTR ===\n";
+
+    // Same API shape as section 7, stale back-link included
+    {
+        SlotMap<SlotParent> parents;
+        SlotMap<SlotChild> children;
+        Handle<SlotParent> dad = parents.emplace();
+        Handle<SlotChild> alice = children.emplace(SlotChild{dad, 1});
+        parents.get(dad)->children.push_back(alice);
+
+        std::cout << "Alice's parent alive: " << std::boolalpha << (parents.get(children.get(alice)->parent) != nullptr);
+        parents.erase(dad);
+        std::cout << ", after erasing it: " << (parents.get(children.get(alice)->parent) != nullptr)
+                  << " (handle " << sizeof(Handle<SlotParent>) << " bytes, shared_ptr "
+                  << sizeof(std::shared_ptr<SharedParent>) << ", weak_ptr " << sizeof(std::weak_ptr<SharedParent>)
+                  << ")\n";
+    }
+
+    // 20k parents x 10 children, created in shuffled order so the heap
+    // layout is what a long-running program ends up with
+    constexpr int kParents = 20000;
+    constexpr int kChildrenEach = 10;
+    std::vector<std::pair<int, int>> order;
+    for (int p = 0; p < kParents; ++p) {
+        for (int c = 0; c < kChildrenEach; ++c) {
+            order.emplace_back(p, c);
+        }
+    }
+    std::mt19937 rng(5);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    std::vector<std::shared_ptr<SharedParent>> shared_parents;
+    for (int p = 0; p < kParents; ++p) {
+        shared_parents.push_back(std::make_shared<SharedParent>(SharedParent{{}, p}));
+    }
+    for (auto [p, c] : order) {
+        auto child = std::make_shared<SharedChild>(SharedChild{shared_parents[p], c});
+        shared_parents[p]->children.push_back(std::move(child));
+    }
+
+    SlotMap<SlotParent> parents;
+    SlotMap<SlotChild> children;
+    std::vector<Handle<SlotParent>> parent_handles;
+    for (int p = 0; p < kParents; ++p) {
+        parent_handles.push_back(parents.emplace(SlotParent{{}, p}));
+    }
+    for (auto [p, c] : order) {
+        Handle<SlotChild> child = children.emplace(SlotChild{parent_handles[p], c});
+        parents.get(parent_handles[p])->children.push_back(child);
+    }
+
+    auto time_ns = [](auto&& fn, double per) {
+        const auto start = std::chrono::steady_clock::now();
+        const long long result = fn();
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        return std::pair<double, long long>{ns / per, result};
+    };
+    constexpr double kEdges = double(kParents) * kChildrenEach;
+
+    // Parent -> children -> back to the parent, the way section 7 walks it
+    auto [shared_walk, shared_sum] = time_ns([&] {
+        long long sum = 0;
+        for (const auto& parent : shared_parents) {
+            for (const auto& child : parent->children) {
+                if (auto p = child->parent.lock()) {
+                    sum += child->value + p->value;
+                }
+            }
+        }
+        return sum;
+    }, kEdges);
+    auto [slot_walk, slot_sum] = time_ns([&] {
+        long long sum = 0;
+        for (const SlotParent& parent : parents) {
+            for (Handle<SlotChild> h : parent.children) {
+                const SlotChild* child = children.get(h);
+                if (const SlotParent* p = parents.get(child->parent)) {
+                    sum += child->value + p->value;
+                }
+            }
+        }
+        return sum;
+    }, kEdges);
+    // Every child, no graph needed: a linear scan of one array
+    auto [slot_scan, scan_sum] = time_ns([&] {
+        long long sum = 0;
+        for (const SlotChild& child : children) {
+            sum += child.value;
+        }
+        return sum;
+    }, kEdges);
+
+    // Churn: replace a random child of a random parent, 200k times
+    std::uniform_int_distribution<int> pick_parent(0, kParents - 1);
+    std::uniform_int_distribution<int> pick_child(0, kChildrenEach - 1);
+    std::mt19937 churn_rng(9);
+    auto [shared_churn, shared_left] = time_ns([&] {
+        for (int i = 0; i < 200000; ++i) {
+            auto& parent = shared_parents[pick_parent(churn_rng)];
+            auto& slot = parent->children[pick_child(churn_rng)];
+            slot = std::make_shared<SharedChild>(SharedChild{parent, i});
+        }
+        return static_cast<long long>(shared_parents.size());
+    }, 200000);
+    churn_rng.seed(9);
+    auto [slot_churn, slot_left] = time_ns([&] {
+        for (int i = 0; i < 200000; ++i) {
+            const Handle<SlotParent> ph = parent_handles[pick_parent(churn_rng)];
+            Handle<SlotChild>& slot = parents.get(ph)->children[pick_child(churn_rng)];
+            children.erase(slot);
+            slot = children.emplace(SlotChild{ph, i});
+        }
+        return static_cast<long long>(children.size());
+    }, 200000);
+
+    std::cout << kParents << " parents x " << kChildrenEach << " children, ns per edge:\n"
+              << "  walk parent -> child -> parent: shared_ptr/weak_ptr " << shared_walk << ", SlotMap handles "
+              << slot_walk << (shared_sum == slot_sum ? "" : " (SUMS DIFFER)") << "\n"
+              << "  scan all children:              SlotMap " << slot_scan << " (sum " << scan_sum << ")\n"
+              << "replace a child, ns per replacement: make_shared " << shared_churn << ", SlotMap erase + emplace "
+              << slot_churn << " (" << shared_left << " parents, " << slot_left << " children)\n";
+}
+
 // ============================================================================
 // MAIN
 // ============================================================================
@@ -455,6 +790,7 @@ int main() {
     cachePatternExample();
     commonPitfalls();
     sizeComparison();
+    handleGraphExample();
 
     std::cout << "\n=== PROGRAM END ===\n";
     return 0;
@@ -0,0 +1,340 @@
+/*
+Lazy element-wise arithmetic over std::span, fused into one loop
+(header-only, just #include it). Used by span_expr_demo.cpp,
+50_std_span.cpp and parallel_stl.cpp.
+
+Chaining span helpers or std::transform calls makes one pass over memory
+per operation and materializes every intermediate:
+
+    transform(a, t1, x * 2); transform(t1, b, t2, +); transform(t2, c, out, -);
+    total = accumulate(out);
+
+reads and writes 9 arrays' worth of memory to compute what needs 3 reads
+(and one write, if `out` is wanted at all). Here the operators build an
+expression tree instead of computing anything, and assign() / sum()
+evaluate the whole tree element by element in a single loop:
+
+    using span_expr::lazy;
+    auto e = lazy(a) * 2.0 + lazy(b) - lazy(c);     // nothing computed yet
+    assign(out, e);                                 // one pass, no temporaries
+    double total = sum(e);                          // one pass, nothing written
+    assign(out, map(lazy(x), [](double v) { return std::sqrt(v); }));
+
+Operands are lazy(span), lazy(vector) or plain numbers (broadcast to every
+element); + - * / and unary - are supported, map(e, f) applies any
+callable. The tree holds pointers and sizes only: the spans must outlive
+the expression. Operands of different sizes throw std::invalid_argument.
+
+assign(out, e) may write into one of its own operands (out = out * 2 + b),
+but not into a shifted overlap of one (out = subspan(1) of an operand):
+that case is detected and evaluated through a temporary instead.
+
+sum(e) adds fixed blocks of kBlock elements with kLanes independent
+accumulators, so the loop vectorizes without -ffast-math, and then adds
+the block sums in order. assign(pool, out, e) and sum(pool, e) split the
+same blocks over a ThreadPoolRAII; the sum is bit-identical to the
+serial one whatever the number of workers.
+
+There is no std::mdspan before GCC 14, so matrices are a span over
+row-major storage: element-wise work is the same as for a vector, and
+row_sums(out, e, cols) fuses one reduction per row.
+*/
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "101_Threads_RAII/thread_pool.hpp"
+
+// The loops below only ever read and write index i together (assign()
+// rules out shifted overlaps first), so there is no loop-carried
+// dependency for the compiler to prove absent
+#if defined(__clang__)
+#define SPAN_EXPR_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define SPAN_EXPR_IVDEP _Pragma("GCC ivdep")
+#else
+#define SPAN_EXPR_IVDEP
+#endif
+
+namespace span_expr {
+
+// size() of an operand that fits any length (a scalar)
+inline constexpr size_t kBroadcast = SIZE_MAX;
+
+// Elements per block of sum() and per chunk of the pool versions
+inline constexpr size_t kBlock = 4096;
+
+struct ExprTag {};
+
+template<typename E>
+concept Expression = std::derived_from<E, ExprTag>;
+
+template<typename T>
+concept Operand = Expression<T> || std::is_arithmetic_v<T>;
+
+template<Expression E>
+using value_t = std::remove_cvref_t<decltype(std::declval<const E&>()[size_t{0}])>;
+
+template<typename T>
+struct Terminal : ExprTag {
+    const T* data;
+    size_t n;
+
+    T operator[](size_t i) const { return data[i]; }
+    size_t size() const { return n; }
+
+    template<typename F>
+    void for_each_terminal(F&& f) const { f(static_cast<const void*>(data), n * sizeof(T)); }
+};
+
+template<typename T>
+struct Scalar : ExprTag {
+    T value;
+
+    T operator[](size_t) const { return value; }
+    size_t size() const { return kBroadcast; }
+
+    template<typename F>
+    void for_each_terminal(F&&) const {}
+};
+
+template<Expression L, Expression R, typename Op>
+struct Binary : ExprTag {
+    L lhs;
+    R rhs;
+    Op op;
+    size_t n;
+
+    Binary(L l, R r, Op o)
+        : lhs(std::move(l)), rhs(std::move(r)), op(std::move(o)), n(std::min(lhs.size(), rhs.size())) {
+        if (lhs.size() != rhs.size() && lhs.size() != kBroadcast && rhs.size() != kBroadcast) {
+            throw std::invalid_argument("span_expr: operands of different sizes");
+        }
+    }
+
+    auto operator[](size_t i) const { return op(lhs[i], rhs[i]); }
+    size_t size() const { return n; }
+
+    template<typename F>
+    void for_each_terminal(F&& f) const {
+        lhs.for_each_terminal(f);
+        rhs.for_each_terminal(f);
+    }
+};
+
+template<Expression E, typename F>
+struct Map : ExprTag {
+    E arg;
+    F fn;
+
+    auto operator[](size_t i) const { return fn(arg[i]); }
+    size_t size() const { return arg.size(); }
+
+    template<typename G>
+    void for_each_terminal(G&& g) const { arg.for_each_terminal(g); }
+};
+
+template<typename T>
+Terminal<T> lazy(std::span<const T> s) { return {{}, s.data(), s.size()}; }
+
+template<typename T>
+Terminal<T> lazy(std::span<T> s) { return {{}, s.data(), s.size()}; }
+
+template<typename T, typename A>
+Terminal<T> lazy(const std::vector<T, A>& v) { return {{}, v.data(), v.size()}; }
+
+template<Expression E>
+const E& as_expr(const E& e) { return e; }
+
+template<typename T>
+    requires std::is_arithmetic_v<T>
+Scalar<T> as_expr(T value) { return {{}, value}; }
+
+template<Operand L, Operand R, typename Op>
+    requires(Expression<L> || Expression<R>)
+auto make_binary(const L& l, const R& r, Op op) {
+    using LE = std::remove_cvref_t<decltype(as_expr(l))>;
+    using RE = std::remove_cvref_t<decltype(as_expr(r))>;
+    return Binary<LE, RE, Op>(as_expr(l), as_expr(r), op);
+}
+
+template<Operand L, Operand R>
+    requires(Expression<L> || Expression<R>)
+auto operator+(const L& l, const R& r) { return make_binary(l, r, std::plus<>{}); }
+
+template<Operand L, Operand R>
+    requires(Expression<L> || Expression<R>)
+auto operator-(const L& l, const R& r) { return make_binary(l, r, std::minus<>{}); }
+
+template<Operand L, Operand R>
+    requires(Expression<L> || Expression<R>)
+auto operator*(const L& l, const R& r) { return make_binary(l, r, std::multiplies<>{}); }
+
+template<Operand L, Operand R>
+    requires(Expression<L> || Expression<R>)
+auto operator/(const L& l, const R& r) { return make_binary(l, r, std::divides<>{}); }
+
+template<Expression E>
+Map<E, std::negate<>> operator-(const E& e) { return {{}, e, {}}; }
+
+template<Expression E, typename F>
+Map<E, F> map(const E& e, F fn) { return {{}, e, std::move(fn)}; }
+
+// ============================================================================
+// Evaluation
+// ============================================================================
+
+namespace detail {
+
+template<typename T, Expression E>
+void check_size(std::span<T> out, const E& e) {
+    if (e.size() != kBroadcast && e.size() != out.size()) {
+        throw std::invalid_argument("span_expr: output and expression sizes differ");
+    }
+}
+
+// True if some operand overlaps out without starting at the same address
+template<typename T, Expression E>
+bool shifted_overlap(std::span<T> out, const E& e) {
+    const auto* dst = reinterpret_cast<const std::byte*>(out.data());
+    const auto* dst_end = dst + out.size_bytes();
+    bool shifted = false;
+    e.for_each_terminal([&](const void* data, size_t bytes) {
+        const auto* src = static_cast<const std::byte*>(data);
+        if (src != dst && src < dst_end && dst < src + bytes) {
+            shifted = true;
+        }
+    });
+    return shifted;
+}
+
+// Fixed-width inner loops: GCC's -O2 cost model vectorizes those, but not
+// a loop that needs a scalar epilogue
+inline constexpr size_t kLanes = 8;
+
+template<typename T, Expression E>
+void assign_range(T* out, const E& e, size_t begin, size_t end) {
+    size_t i = begin;
+    for (; i + kLanes <= end; i += kLanes) {
+        SPAN_EXPR_IVDEP
+        for (size_t k = 0; k < kLanes; ++k) {
+            out[i + k] = static_cast<T>(e[i + k]);
+        }
+    }
+    for (; i < end; ++i) {
+        out[i] = static_cast<T>(e[i]);
+    }
+}
+
+template<Expression E>
+value_t<E> sum_range(const E& e, size_t begin, size_t end) {
+    value_t<E> acc[kLanes] = {};
+    size_t i = begin;
+    for (; i + kLanes <= end; i += kLanes) {
+        for (size_t k = 0; k < kLanes; ++k) {
+            acc[k] += e[i + k];
+        }
+    }
+    for (; i < end; ++i) {
+        acc[0] += e[i];
+    }
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+template<Expression E>
+size_t checked_length(const E& e) {
+    if (e.size() == kBroadcast) {
+        throw std::invalid_argument("span_expr: cannot reduce an expression of scalars only");
+    }
+    return e.size();
+}
+
+} // namespace detail
+
+// out[i] = e[i] for every i, in one pass
+template<typename T, Expression E>
+void assign(std::span<T> out, const E& e) {
+    detail::check_size(out, e);
+    if (detail::shifted_overlap(out, e)) {
+        std::vector<T> tmp(out.size());
+        detail::assign_range(tmp.data(), e, 0, tmp.size());
+        std::copy(tmp.begin(), tmp.end(), out.begin());
+        return;
+    }
+    detail::assign_range(out.data(), e, 0, out.size());
+}
+
+template<typename T, typename A, Expression E>
+void assign(std::vector<T, A>& out, const E& e) { assign(std::span<T>(out), e); }
+
+template<typename T, Expression E>
+void assign(ThreadPoolRAII& pool, std::span<T> out, const E& e) {
+    detail::check_size(out, e);
+    if (detail::shifted_overlap(out, e)) {
+        assign(out, e);
+        return;
+    }
+    T* dst = out.data();
+    pool.parallel_for(size_t{0}, out.size(), kBlock,
+                      [dst, &e](size_t begin, size_t end) { detail::assign_range(dst, e, begin, end); });
+}
+
+template<typename T, typename A, Expression E>
+void assign(ThreadPoolRAII& pool, std::vector<T, A>& out, const E& e) { assign(pool, std::span<T>(out), e); }
+
+// Sum of all elements, without materializing any of them
+template<Expression E>
+value_t<E> sum(const E& e) {
+    const size_t n = detail::checked_length(e);
+    value_t<E> total{};
+    for (size_t begin = 0; begin < n; begin += kBlock) {
+        total += detail::sum_range(e, begin, std::min(n, begin + kBlock));
+    }
+    return total;
+}
+
+// Same blocks, same order of the final adds: same result as sum(e)
+template<Expression E>
+value_t<E> sum(ThreadPoolRAII& pool, const E& e) {
+    const size_t n = detail::checked_length(e);
+    const size_t blocks = (n + kBlock - 1) / kBlock;
+    std::vector<value_t<E>> partials(blocks);
+    pool.parallel_for(size_t{0}, blocks, size_t{4}, [&](size_t block) {
+        const size_t begin = block * kBlock;
+        partials[block] = detail::sum_range(e, begin, std::min(n, begin + kBlock));
+    });
+    value_t<E> total{};
+    for (const auto& p : partials) {
+        total += p;
+    }
+    return total;
+}
+
+template<Expression E>
+double mean(const E& e) {
+    const size_t n = detail::checked_length(e);
+    return n == 0 ? 0.0 : static_cast<double>(sum(e)) / static_cast<double>(n);
+}
+
+// out[r] = sum of row r of e, read as a row-major matrix of `cols` columns
+template<typename T, Expression E>
+void row_sums(std::span<T> out, const E& e, size_t cols) {
+    const size_t n = detail::checked_length(e);
+    if (cols == 0 || n != out.size() * cols) {
+        throw std::invalid_argument("span_expr: expression is not out.size() rows of cols elements");
+    }
+    for (size_t r = 0; r < out.size(); ++r) {
+        out[r] = static_cast<T>(detail::sum_range(e, r * cols, r * cols + cols));
+    }
+}
+
+} // namespace span_expr
@@ -0,0 +1,186 @@
+// g++ -std=c++20 -O2 -march=native -pthread span_expr_demo.cpp -o app
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "microbench.hpp"
+#include "span_expr.hpp"
+
+using span_expr::lazy;
+
+std::vector<double> make_data(size_t n, unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> v(n);
+    for (double& x : v) {
+        x = dist(rng);
+    }
+    return v;
+}
+
+// GB/s if each run moved `bytes`
+void report_traffic(const microbench::Result& r, double bytes) {
+    microbench::report(r);
+    std::cout << "    " << bytes / (1 << 20) << " MiB moved, " << bytes / r.median_ns << " GB/s\n";
+}
+
+// ============================================================================
+// 1. a * 2 + b - c, AND ITS SUM: ONE PASS PER OPERATION vs ONE PASS
+// ============================================================================
+void benchmarkFusion() {
+    constexpr size_t kN = 4 << 20;      // 32 MiB per array: well past the caches
+    constexpr double kArray = kN * sizeof(double);
+    std::cout << "\n=== out = a * 2 + b - c; total = sum(out), " << kN << " doubles ("
+              << std::thread::hardware_concurrency() << " hardware threads) ===\n";
+    const std::vector<double> a = make_data(kN, 1);
+    const std::vector<double> b = make_data(kN, 2);
+    const std::vector<double> c = make_data(kN, 3);
+    std::vector<double> t1(kN);
+    std::vector<double> t2(kN);
+    std::vector<double> out(kN);
+    std::vector<double> fused(kN);
+    double multi_total = 0;
+    double fused_total = 0;
+
+    // One std::transform per operator, like chaining span helpers; the
+    // traffic counts each array read or written once per pass
+    auto multi = microbench::run("3 transforms + accumulate", 1, [&] {
+        std::transform(a.begin(), a.end(), t1.begin(), [](double x) { return x * 2; });
+        std::transform(t1.begin(), t1.end(), b.begin(), t2.begin(), std::plus<>{});
+        std::transform(t2.begin(), t2.end(), c.begin(), out.begin(), std::minus<>{});
+        multi_total = std::accumulate(out.begin(), out.end(), 0.0);
+        microbench::do_not_optimize(multi_total);
+    }, {1, 7});
+    report_traffic(multi, 9 * kArray);
+
+    const auto e = lazy(a) * 2.0 + lazy(b) - lazy(c);
+    auto assigned = microbench::run("assign(out, e); sum(out)", 1, [&] {
+        assign(fused, e);
+        fused_total = sum(lazy(fused));
+        microbench::do_not_optimize(fused_total);
+    }, {1, 7});
+    report_traffic(assigned, 5 * kArray);
+
+    double reduced = 0;
+    auto reduce_only = microbench::run("sum(e), nothing written", 1, [&] {
+        reduced = sum(e);
+        microbench::do_not_optimize(reduced);
+    }, {1, 7});
+    report_traffic(reduce_only, 3 * kArray);
+
+    ThreadPoolRAII pool(std::max(1u, std::thread::hardware_concurrency()));
+    double pooled = 0;
+    auto pool_run = microbench::run("sum(pool, e)", 1, [&] {
+        pooled = sum(pool, e);
+        microbench::do_not_optimize(pooled);
+    }, {1, 7});
+    report_traffic(pool_run, 3 * kArray);
+
+    microbench::compare(multi, assigned);
+    microbench::compare(multi, reduce_only);
+    std::cout << "  out " << (out == fused ? "identical" : "DIFFERS") << "; sums: multi-pass " << multi_total
+              << ", fused " << fused_total << ", sum(e) " << reduced << ", pool "
+              << (pooled == reduced ? "bit-identical to serial" : "DIFFERS from serial") << "\n";
+}
+
+// ============================================================================
+// 2. A LONGER CHAIN: temporaries grow with the expression, fused stays 1 pass
+// ============================================================================
+void benchmarkChain() {
+    constexpr size_t kN = 4 << 20;
+    std::cout << "\n=== out = sqrt(a * a + b * b) / (c + 2) - a * 0.5, " << kN << " doubles ===\n";
+    const std::vector<double> a = make_data(kN, 4);
+    const std::vector<double> b = make_data(kN, 5);
+    const std::vector<double> c = make_data(kN, 6);
+    std::vector<double> t1(kN);
+    std::vector<double> t2(kN);
+    std::vector<double> out(kN);
+    std::vector<double> fused(kN);
+
+    auto multi = microbench::run("7 transforms", 1, [&] {
+        std::transform(a.begin(), a.end(), t1.begin(), [](double x) { return x * x; });
+        std::transform(b.begin(), b.end(), t2.begin(), [](double x) { return x * x; });
+        std::transform(t1.begin(), t1.end(), t2.begin(), t1.begin(), std::plus<>{});
+        std::transform(t1.begin(), t1.end(), t1.begin(), [](double x) { return std::sqrt(x); });
+        std::transform(c.begin(), c.end(), t2.begin(), [](double x) { return x + 2; });
+        std::transform(t1.begin(), t1.end(), t2.begin(), t1.begin(), std::divides<>{});
+        std::transform(t1.begin(), t1.end(), a.begin(), out.begin(), [](double t, double x) { return t - x * 0.5; });
+        microbench::do_not_optimize(out.data());
+    }, {1, 7});
+    report_traffic(multi, (2 + 2 + 3 + 2 + 2 + 3 + 3) * kN * sizeof(double));
+
+    auto sqrt_of = [](double x) { return std::sqrt(x); };
+    const auto e = map(lazy(a) * lazy(a) + lazy(b) * lazy(b), sqrt_of) / (lazy(c) + 2.0) - lazy(a) * 0.5;
+    auto one_pass = microbench::run("assign(out, e)", 1, [&] {
+        assign(fused, e);
+        microbench::do_not_optimize(fused.data());
+    }, {1, 7});
+    report_traffic(one_pass, 4.0 * kN * sizeof(double));
+
+    microbench::compare(multi, one_pass);
+    // With FMA the fused loop may contract a * a + b * b: same to ~1 ulp
+    double worst = 0;
+    for (size_t i = 0; i < kN; ++i) {
+        worst = std::max(worst, std::abs(out[i] - fused[i]));
+    }
+    std::cout << "  largest difference " << worst << "\n";
+}
+
+// ============================================================================
+// 3. WRITING INTO AN OPERAND
+// ============================================================================
+void demonstrateAliasing() {
+    std::cout << "\n=== ASSIGNING INTO AN OPERAND ===\n";
+    std::vector<double> v = {1, 2, 3, 4, 5, 6};
+    const std::vector<double> ones(v.size(), 1.0);
+
+    assign(v, lazy(v) * 2.0 + lazy(ones));                 // same start: evaluated in place
+    std::cout << "v = v * 2 + 1:            ";
+    for (double x : v) std::cout << x << " ";
+
+    // v[i] = v[i + 1] - v[i]: the shifted read is detected and goes through
+    // a temporary, so every element sees the old values
+    std::span<double> all(v);
+    assign(all.first(5), lazy(all.subspan(1)) - lazy(all.first(5)));
+    std::cout << "\nv[i] = v[i + 1] - v[i]:   ";
+    for (double x : v) std::cout << x << " ";
+
+    try {
+        assign(v, lazy(v) + lazy(all.first(3)));
+    } catch (const std::invalid_argument& ex) {
+        std::cout << "\nsize mismatch:            " << ex.what();
+    }
+    std::cout << "\n";
+}
+
+// ============================================================================
+// 4. MATRIX ROWS: centre and sum every row without a copy
+// ============================================================================
+void demonstrateRows() {
+    std::cout << "\n=== 3 x 4 MATRIX, ROW SUMS OF (m - mean(m)) ^ 2 ===\n";
+    const std::vector<double> m = {1, 2, 3, 4,
+                                   2, 4, 6, 8,
+                                   0, 5, 0, 5};
+    const double centre = mean(lazy(m));
+    const auto d = lazy(m) - centre;
+    std::vector<double> rows(3);
+    row_sums(std::span<double>(rows), d * d, 4);
+    std::cout << "mean " << centre << ", row sums:";
+    for (double r : rows) std::cout << " " << r;
+    std::cout << "\n";
+}
+
+int main() {
+    benchmarkFusion();
+    benchmarkChain();
+    demonstrateAliasing();
+    demonstrateRows();
+    return 0;
+}